@@ -64,6 +64,15 @@ const char * const content_status_name[] = {
  * - If the conversion fails, CONTENT_MSG_ERROR is sent. The content will soon
  *   be destroyed and must no longer be used.
  */
+/** Number of completed conversion timing records retained */
+#define CONTENT_TIMING_LOG 32
+
+/** Ring of recently completed conversion timings */
+static struct content_timings content_timing_log[CONTENT_TIMING_LOG];
+
+/** Total conversions logged; next slot is this modulo the log size */
+static unsigned int content_timing_count = 0;
+
 static void content_convert(struct content *c)
 {
 	assert(c);
@@ -79,6 +88,9 @@ static void content_convert(struct content *c)
 	NSLOG(netsurf, INFO, "content "URL_FMT_SPC" (%p)",
 	      nsurl_access_log(llcache_handle_get_url(c->llcache)), c);
 
+	nsu_getmonotonic_ms(&c->time_parse_done);
+	c->time_parse_done -= c->time;
+
 	if (c->handler->data_complete != NULL) {
 		c->locked = true;
 		if (c->handler->data_complete(c) == false) {
@@ -116,6 +128,11 @@ content_llcache_callback(llcache_handle *llcache,
 		/* Will never happen: handled in hlcache */
 		break;
 	case LLCACHE_EVENT_HAD_DATA:
+		if (c->time_first_data == 0) {
+			uint64_t now_ms;
+			nsu_getmonotonic_ms(&now_ms);
+			c->time_first_data = now_ms - c->time;
+		}
 		if (c->handler->process_data != NULL) {
 			if (c->handler->process_data(c,
 						     (const char *) event->data.data.buf,
@@ -179,8 +196,12 @@ static void content_update_status(struct content *c)
 			 c->sub_status);
 	} else {
 		snprintf(c->status_message, sizeof (c->status_message),
-			 "%s (%.1fs)", messages_get("Done"),
-			 (float) c->time / 1000);
+			 "%s (%.1fs; data %.1fs parsed %.1fs converted %.1fs)",
+			 messages_get("Done"),
+			 (float) c->time / 1000,
+			 (float) c->time_first_data / 1000,
+			 (float) c->time_parse_done / 1000,
+			 (float) c->time_convert_done / 1000);
 	}
 }
 
@@ -225,6 +246,9 @@ content__init(struct content *c,
 	c->quirks = quirks;
 	c->refresh = 0;
 	nsu_getmonotonic_ms(&c->time);
+	c->time_first_data = 0;
+	c->time_parse_done = 0;
+	c->time_convert_done = 0;
 	c->size = 0;
 	c->title = NULL;
 	c->active = 0;
@@ -290,6 +314,10 @@ void content_set_ready(struct content *c)
 	c->locked = false;
 
 	c->status = CONTENT_STATUS_READY;
+
+	nsu_getmonotonic_ms(&c->time_convert_done);
+	c->time_convert_done -= c->time;
+
 	content_update_status(c);
 	content_broadcast(c, CONTENT_MSG_READY, NULL);
 }
@@ -299,11 +327,30 @@ void content_set_ready(struct content *c)
 void content_set_done(struct content *c)
 {
 	uint64_t now_ms;
+	struct content_timings *timings;
 
 	nsu_getmonotonic_ms(&now_ms);
 
+	if (c->time_convert_done == 0) {
+		/* content went straight to done */
+		c->time_convert_done = now_ms - c->time;
+	}
+
 	c->status = CONTENT_STATUS_DONE;
 	c->time = now_ms - c->time;
+
+	/* log the completed conversion for about:timings */
+	timings = &content_timing_log[content_timing_count %
+				      CONTENT_TIMING_LOG];
+	strncpy(timings->mime_type, lwc_string_data(c->mime_type),
+		sizeof(timings->mime_type) - 1);
+	timings->mime_type[sizeof(timings->mime_type) - 1] = '\0';
+	timings->first_data = c->time_first_data;
+	timings->parse = c->time_parse_done;
+	timings->convert = c->time_convert_done;
+	timings->total = c->time;
+	content_timing_count++;
+
 	content_update_status(c);
 	content_broadcast(c, CONTENT_MSG_DONE, NULL);
 }
@@ -1120,6 +1167,31 @@ const char *content__get_title(struct content *c)
 }
 
 
+/* exported interface documented in content/content.h */
+nserror content_get_timings(unsigned int index, struct content_timings *timings)
+{
+	unsigned int retained;
+
+	if (timings == NULL) {
+		return NSERROR_BAD_PARAMETER;
+	}
+
+	retained = content_timing_count;
+	if (retained > CONTENT_TIMING_LOG) {
+		retained = CONTENT_TIMING_LOG;
+	}
+
+	if (index >= retained) {
+		return NSERROR_NOT_FOUND;
+	}
+
+	*timings = content_timing_log[(content_timing_count - 1 - index) %
+				      CONTENT_TIMING_LOG];
+
+	return NSERROR_OK;
+}
+
+
 /* exported interface documented in content/content.h */
 content_status content_get_status(hlcache_handle *h)
 {
@@ -1284,6 +1356,35 @@ struct bitmap *content__get_bitmap(struct content *c)
 }
 
 
+/* exported interface documented in content/content.h */
+struct bitmap *content_get_bitmap_sized(hlcache_handle *h, int width, int height)
+{
+	return content__get_bitmap_sized(hlcache_handle_get_content(h),
+			width, height);
+}
+
+
+/* exported interface documented in content/content_protected.h */
+struct bitmap *content__get_bitmap_sized(struct content *c, int width, int height)
+{
+	struct content_bitmap_size_hint size_hint = {
+		.width = width,
+		.height = height,
+	};
+	struct bitmap *bitmap = NULL;
+
+	if ((c != NULL) &&
+	    (c->handler != NULL) &&
+	    (c->handler->type != NULL) &&
+	    (c->handler->type() == CONTENT_IMAGE) &&
+	    (c->handler->get_internal != NULL) ) {
+		bitmap = c->handler->get_internal(c, &size_hint);
+	}
+
+	return bitmap;
+}
+
+
 /* exported interface documented in content/content.h */
 bool content_get_opaque(hlcache_handle *h)
 {
@@ -1364,6 +1465,16 @@ const llcache_handle *content_get_llcache_handle(struct content *c)
 }
 
 
+/* exported interface documented in content/content_protected.h */
+void content_set_fetch_paused(struct content *c, bool paused)
+{
+	if ((c == NULL) || (c->llcache == NULL))
+		return;
+
+	llcache_handle_pause(c->llcache, paused);
+}
+
+
 /* exported interface documented in content/protected.h */
 struct content *content_clone(struct content *c)
 {
@@ -1416,6 +1527,9 @@ nserror content__clone(const struct content *c, struct content *nc)
 	}
 
 	nc->time = c->time;
+	nc->time_first_data = c->time_first_data;
+	nc->time_parse_done = c->time_parse_done;
+	nc->time_convert_done = c->time_convert_done;
 	nc->reformat_time = c->reformat_time;
 	nc->size = c->size;
 
@@ -468,6 +468,28 @@ content_status content__get_status(struct content *c);
 const char *content_get_status_message(struct hlcache_handle *h);
 
 
+/**
+ * Timing breakdown of a completed content conversion
+ */
+struct content_timings {
+	char mime_type[64]; /**< the content's mime type */
+	uint64_t first_data; /**< ms from creation to first data */
+	uint64_t parse; /**< ms from creation to all data processed */
+	uint64_t convert; /**< ms from creation to conversion complete */
+	uint64_t total; /**< ms from creation to completion */
+};
+
+/**
+ * Retrieve the timing breakdown of a recently completed conversion.
+ *
+ * \param index Which record to retrieve; 0 is the most recent.
+ * \param timings Updated with the requested record.
+ * \return NSERROR_OK on success, NSERROR_NOT_FOUND past the end of
+ *	   the retained records.
+ */
+nserror content_get_timings(unsigned int index, struct content_timings *timings);
+
+
 /**
  * Retrieve available width of content
  *
@@ -51,6 +51,18 @@ struct selection_string;
 
 typedef struct content_handler content_handler;
 
+/**
+ * Display size hint for an image content bitmap lookup.
+ *
+ * Passed as the get_internal context by content__get_bitmap_sized()
+ * so handlers holding several resolutions of an image (e.g. ico) can
+ * decode only the one nearest the size the caller will display.
+ */
+struct content_bitmap_size_hint {
+	int width;
+	int height;
+};
+
 /**
  * Content operation function table
  *
@@ -107,6 +119,19 @@ struct content_handler {
 	 */
 	nserror (*textsearch_find)(struct content *c, struct textsearch_context *context, const char *pattern, int p_len, bool case_sens);
 
+	/**
+	 * content specific free text search refinement
+	 *
+	 * Optional operation invoked when a search pattern extends the
+	 *   previous one, so every new match must start at a previous
+	 *   match. The box and start index locate the first previous
+	 *   match in a region; the handler rescans that region from
+	 *   there, adding matches with content_textsearch_add_match(),
+	 *   and places the content byte offset of the region's end in
+	 *   scanned_to so further matches within it can be skipped.
+	 */
+	nserror (*textsearch_refind)(struct content *c, struct textsearch_context *context, const char *pattern, int p_len, bool case_sens, struct box *box, unsigned int start_idx, unsigned int *scanned_to);
+
 	/**
 	 * get bounds of free text search match
 	 */
@@ -141,6 +166,9 @@ struct content_handler {
 
         /**
 	 * handler dependant content sensitive internal data interface.
+	 *
+	 * For image contents the context may be a pointer to a
+	 * struct content_bitmap_size_hint or NULL.
 	 */
 	void *(*get_internal)(const struct content *c, void *context);
 
@@ -240,6 +268,23 @@ struct content {
 	 */
 	uint64_t time;
 
+	/**
+	 * Time in ms from creation to the first data arriving, 0
+	 * until data has been seen.
+	 */
+	uint64_t time_first_data;
+
+	/**
+	 * Time in ms from creation to all source data having been
+	 * processed.
+	 */
+	uint64_t time_parse_done;
+
+	/**
+	 * Time in ms from creation to conversion completing.
+	 */
+	uint64_t time_convert_done;
+
 	/**
 	 * Earliest time to attempt a period reflow while fetching a
 	 * page's objects.
@@ -495,6 +540,16 @@ struct nsurl *content__get_refresh_url(struct content *c);
  */
 struct bitmap *content__get_bitmap(struct content *c);
 
+/**
+ * Retrieve the bitmap contained in an image content at a given size
+ *
+ * \param c Content to retrieve bitmap from
+ * \param width The width the caller will display the bitmap at
+ * \param height The height the caller will display the bitmap at
+ * \return Pointer to bitmap or NULL if none.
+ */
+struct bitmap *content__get_bitmap_sized(struct content *c, int width, int height);
+
 /**
  * Determine if a content is opaque
  *
@@ -601,6 +656,18 @@ bool content_is_shareable(struct content *c);
  */
 const struct llcache_handle *content_get_llcache_handle(struct content *c);
 
+/**
+ * Pause or resume delivery of source data to a content
+ *
+ * Lets a content handler apply backpressure to the underlying fetch
+ * while it is unable to keep up with arriving data.  Each pause must
+ * be paired with a resume.
+ *
+ * \param c Content to alter
+ * \param paused true to suspend source data delivery, false to resume
+ */
+void content_set_fetch_paused(struct content *c, bool paused);
+
 /**
  * Retrieve URL associated with content
  *
@@ -39,16 +39,21 @@
 #include <strings.h>
 #include <time.h>
 #include <libwapcaplet/libwapcaplet.h>
+#include <nsutils/time.h>
 
+#include "netsurf/inttypes.h"
 #include "utils/config.h"
 #include "utils/corestrings.h"
+#include "utils/file.h"
 #include "utils/nsoption.h"
 #include "utils/log.h"
 #include "utils/messages.h"
 #include "utils/nsurl.h"
 #include "utils/ring.h"
 #include "netsurf/misc.h"
+#include "desktop/frame_budget.h"
 #include "desktop/gui_internal.h"
+#include "desktop/perf_log.h"
 
 #include "content/fetch.h"
 #include "content/fetchers.h"
@@ -57,6 +62,7 @@
 #include "content/fetchers/curl.h"
 #include "content/fetchers/data.h"
 #include "content/fetchers/file/file.h"
+#include "content/fetchers/replay.h"
 #include "javascript/fetcher.h"
 #include "content/urldb.h"
 
@@ -97,7 +103,11 @@ struct fetch {
 	int fetcherd;           /**< Fetcher descriptor for this fetch */
 	void *fetcher_handle;	/**< The handle for the fetcher. */
 	bool fetch_is_active;	/**< This fetch is active. */
+	fetch_priority priority;/**< Resource class priority when queued. */
 	fetch_msg_type last_msg;/**< The last message sent for this fetch */
+	FILE *record;		/**< Replay archive entry being written, or NULL */
+	char *record_path;	/**< Path of the archive entry being written */
+	uint64_t record_start;	/**< Monotonic ms the recorded fetch started */
 	struct fetch *r_prev;	/**< Previous active fetch in ::fetch_ring. */
 	struct fetch *r_next;	/**< Next active fetch in ::fetch_ring. */
 };
@@ -142,11 +152,124 @@ static int get_fetcher_for_scheme(lwc_string *scheme)
 	return -1;
 }
 
+/**
+ * Begin recording a fetch into the replay archive.
+ *
+ * Only http and https responses are captured as those are the ones a
+ * later replay session serves back; recording starts when the fetch
+ * is dispatched so the elapsed time includes connection setup.
+ */
+static void fetch_record_begin(struct fetch *fetch)
+{
+	char leaf[16];
+	bool match;
+
+	if (nsoption_charp(fetch_record_path) == NULL) {
+		return;
+	}
+
+	if (((lwc_string_isequal(fetchers[fetch->fetcherd].scheme,
+				 corestring_lwc_http,
+				 &match) != lwc_error_ok) ||
+	     (match == false)) &&
+	    ((lwc_string_isequal(fetchers[fetch->fetcherd].scheme,
+				 corestring_lwc_https,
+				 &match) != lwc_error_ok) ||
+	     (match == false))) {
+		return;
+	}
+
+	snprintf(leaf, sizeof(leaf), "%08x.rec", nsurl_hash(fetch->url));
+	if (netsurf_mkpath(&fetch->record_path, NULL, 2,
+			   nsoption_charp(fetch_record_path),
+			   leaf) != NSERROR_OK) {
+		return;
+	}
+
+	fetch->record = fopen(fetch->record_path, "wb");
+	if (fetch->record == NULL) {
+		NSLOG(fetch, WARNING, "Unable to record fetch to %s",
+		      fetch->record_path);
+		free(fetch->record_path);
+		fetch->record_path = NULL;
+		return;
+	}
+
+	fprintf(fetch->record, "NSREPLAY 1\nu %s\n",
+		nsurl_access(fetch->url));
+	nsu_getmonotonic_ms(&fetch->record_start);
+}
+
+/**
+ * Discard a partial replay archive entry.
+ */
+static void fetch_record_discard(struct fetch *fetch)
+{
+	fclose(fetch->record);
+	fetch->record = NULL;
+	remove(fetch->record_path);
+	free(fetch->record_path);
+	fetch->record_path = NULL;
+}
+
+/**
+ * Capture a fetch message into the replay archive entry.
+ */
+static void fetch_record_msg(const fetch_msg *msg, struct fetch *fetch)
+{
+	uint64_t now;
+
+	switch (msg->type) {
+	case FETCH_HEADER:
+		fprintf(fetch->record, "h %"PRIsizet"\n",
+			msg->data.header_or_data.len);
+		fwrite(msg->data.header_or_data.buf, 1,
+		       msg->data.header_or_data.len, fetch->record);
+		break;
+
+	case FETCH_DATA:
+		fprintf(fetch->record, "d %"PRIsizet"\n",
+			msg->data.header_or_data.len);
+		fwrite(msg->data.header_or_data.buf, 1,
+		       msg->data.header_or_data.len, fetch->record);
+		break;
+
+	case FETCH_REDIRECT:
+		fprintf(fetch->record, "r %"PRIsizet"\n%s",
+			strlen(msg->data.redirect),
+			msg->data.redirect);
+		/* fallthrough; a redirect completes the fetch */
+
+	case FETCH_FINISHED:
+		nsu_getmonotonic_ms(&now);
+		fprintf(fetch->record, "e %"PRIu64"\nc %ld\n",
+			now - fetch->record_start,
+			fetch->http_code);
+		fclose(fetch->record);
+		fetch->record = NULL;
+		free(fetch->record_path);
+		fetch->record_path = NULL;
+		break;
+
+	case FETCH_PROGRESS:
+	case FETCH_CERTS:
+		/* not part of the response, ignored */
+		break;
+
+	default:
+		/* a fetch which did not complete is useless to replay */
+		fetch_record_discard(fetch);
+		break;
+	}
+}
+
 /**
  * Dispatch a single job
  */
 static bool fetch_dispatch_job(struct fetch *fetch)
 {
+	int active = 0;
+
 	RING_REMOVE(queue_ring, fetch);
 	NSLOG(fetch, DEBUG,
 	      "Attempting to start fetch %p, fetcher %p, url %s", fetch,
@@ -159,6 +282,9 @@ static bool fetch_dispatch_job(struct fetch *fetch)
 	} else {
 		RING_INSERT(fetch_ring, fetch);
 		fetch->fetch_is_active = true;
+		fetch_record_begin(fetch);
+		RING_GETSIZE(struct fetch, fetch_ring, active);
+		perf_log_sample(PERF_LOG_FETCH_ACTIVE, active);
 		return true;
 	}
 }
@@ -172,34 +298,99 @@ static bool fetch_dispatch_job(struct fetch *fetch)
  */
 static bool fetch_choose_and_dispatch(void)
 {
-	bool same_host;
 	struct fetch *queueitem;
+	struct fetch *best = NULL;
+	int best_active = 0;
+	int countbyhost;
+
+	/* Select the most urgent dispatchable queue entry.  The scan
+	 * follows queue insertion order so equal priority items are
+	 * still dispatched first-in first-out.  Among entries of equal
+	 * priority the host with the fewest active fetches wins, so a
+	 * single busy site cannot monopolise the fetch ring.
+	 */
 	queueitem = queue_ring;
 	do {
-		/* We can dispatch the selected item if there is room in the
-		 * fetch ring
-		 */
-		int countbyhost;
-		RING_COUNTBYLWCHOST(struct fetch, fetch_ring, countbyhost,
-				    queueitem->host);
-		if (countbyhost < nsoption_int(max_fetchers_per_host)) {
-			/* We can dispatch this item in theory */
-			return fetch_dispatch_job(queueitem);
-		}
-		/* skip over other items with the same host */
-		same_host = true;
-		while (same_host == true && queueitem->r_next != queue_ring) {
-			if (lwc_string_isequal(queueitem->host,
-					       queueitem->r_next->host, &same_host) ==
-			    lwc_error_ok && same_host == true) {
-				queueitem = queueitem->r_next;
+		RING_COUNTBYLWCHOST(struct fetch, fetch_ring,
+				    countbyhost, queueitem->host);
+		if (countbyhost >= nsoption_int(max_fetchers_per_host)) {
+			/* No room for this entry's host */
+		} else if ((best == NULL) ||
+			   (queueitem->priority < best->priority) ||
+			   ((queueitem->priority == best->priority) &&
+			    (countbyhost < best_active))) {
+			best = queueitem;
+			best_active = countbyhost;
+			if ((best->priority == FETCH_PRIORITY_HTML) &&
+			    (best_active == 0)) {
+				/* Nothing can beat this */
+				break;
 			}
 		}
 		queueitem = queueitem->r_next;
 	} while (queueitem != queue_ring);
+
+	if (best != NULL) {
+		return fetch_dispatch_job(best);
+	}
 	return false;
 }
 
+/** Fetch starts the dispatch rate limiter currently permits */
+static int fetch_dispatch_tokens;
+
+/** Monotonic ms the dispatch rate limiter bucket was last refilled */
+static uint64_t fetch_dispatch_refilled;
+
+/**
+ * Take a token from the dispatch rate limiter bucket.
+ *
+ * The bucket earns max_fetch_rate tokens a second up to a capacity of
+ * max_fetch_burst and each fetch start consumes one, smoothing bursts
+ * of queued fetches into a steady dispatch rate.
+ *
+ * \return true if dispatching may proceed else false.
+ */
+static bool fetch_dispatch_take_token(void)
+{
+	uint64_t now;
+	int rate = nsoption_int(max_fetch_rate);
+	int burst = nsoption_int(max_fetch_burst);
+
+	if (rate <= 0) {
+		/* limiter disabled */
+		return true;
+	}
+
+	if (burst < 1) {
+		burst = 1;
+	}
+
+	nsu_getmonotonic_ms(&now);
+	if (fetch_dispatch_refilled == 0) {
+		/* first use starts with a full bucket */
+		fetch_dispatch_tokens = burst;
+		fetch_dispatch_refilled = now;
+	} else {
+		uint64_t earned;
+		earned = ((now - fetch_dispatch_refilled) * rate) / 1000;
+		if (earned > 0) {
+			fetch_dispatch_tokens += earned;
+			if (fetch_dispatch_tokens > burst) {
+				fetch_dispatch_tokens = burst;
+			}
+			/* only account for whole tokens earned */
+			fetch_dispatch_refilled += (earned * 1000) / rate;
+		}
+	}
+
+	if (fetch_dispatch_tokens == 0) {
+		return false;
+	}
+	fetch_dispatch_tokens--;
+	return true;
+}
+
 static void dump_rings(void)
 {
 	struct fetch *q;
@@ -232,6 +423,7 @@ static bool fetch_dispatch_jobs(void)
 {
 	int all_active;
 	int all_queued;
+	bool rate_limited = false;
 
 	RING_GETSIZE(struct fetch, queue_ring, all_queued);
 	RING_GETSIZE(struct fetch, fetch_ring, all_active);
@@ -243,20 +435,27 @@ static bool fetch_dispatch_jobs(void)
 	dump_rings();
 
 	while ((all_queued != 0) &&
-	       (all_active < nsoption_int(max_fetchers)) &&
-	       fetch_choose_and_dispatch()) {
-			all_queued--;
-			all_active++;
-			NSLOG(fetch, DEBUG,
-			      "%d queued, %d fetching",
-			      all_queued,
-			      all_active);
+	       (all_active < nsoption_int(max_fetchers))) {
+		if (!fetch_dispatch_take_token()) {
+			/* out of tokens; the poll schedule retries */
+			rate_limited = true;
+			break;
+		}
+		if (!fetch_choose_and_dispatch()) {
+			break;
+		}
+		all_queued--;
+		all_active++;
+		NSLOG(fetch, DEBUG,
+		      "%d queued, %d fetching",
+		      all_queued,
+		      all_active);
 	}
 
 	NSLOG(fetch, DEBUG, "Fetch ring is now %d elements.", all_active);
 	NSLOG(fetch, DEBUG, "Queue ring is now %d elements.", all_queued);
 
-	return (all_active > 0);
+	return (all_active > 0) || rate_limited;
 }
 
 static void fetcher_poll(void *unused)
@@ -265,12 +464,14 @@ static void fetcher_poll(void *unused)
 
 	if (fetch_dispatch_jobs()) {
 		NSLOG(fetch, DEBUG, "Polling fetchers");
+		frame_budget_enter(FRAME_BUDGET_FETCH);
 		for (fetcherd = 0; fetcherd < MAX_FETCHERS; fetcherd++) {
 			if (fetchers[fetcherd].refcount > 0) {
 				/* fetcher present */
 				fetchers[fetcherd].ops.poll(fetchers[fetcherd].scheme);
 			}
 		}
+		frame_budget_leave(FRAME_BUDGET_FETCH);
 
 		/* schedule active fetchers to run again in 10ms */
 		guit->misc->schedule(SCHEDULE_TIME, fetcher_poll, NULL);
@@ -286,6 +487,16 @@ nserror fetcher_init(void)
 {
 	nserror ret;
 
+	/* when replaying, the archive handler claims http(s) ahead of
+	 * any network fetcher as the first registered scheme match wins
+	 */
+	if (nsoption_charp(fetch_replay_path) != NULL) {
+		ret = fetch_replay_register();
+		if (ret != NSERROR_OK) {
+			return ret;
+		}
+	}
+
 #ifdef WITH_CURL
 	ret = fetch_curl_register();
 	if (ret != NSERROR_OK) {
@@ -544,6 +755,16 @@ void fetch_abort(struct fetch *f)
 	fetchers[f->fetcherd].ops.abort(f->fetcher_handle);
 }
 
+/* exported interface documented in content/fetch.h */
+void fetch_pause(struct fetch *fetch, bool pause)
+{
+	assert(fetch);
+	if (fetchers[fetch->fetcherd].ops.pause != NULL) {
+		fetchers[fetch->fetcherd].ops.pause(fetch->fetcher_handle,
+						    pause);
+	}
+}
+
 /* exported interface documented in content/fetch.h */
 void fetch_free(struct fetch *f)
 {
@@ -566,6 +787,13 @@ void fetch_free(struct fetch *f)
 	      f,
 	      f->fetcher_handle);
 
+	if (f->record != NULL) {
+		/* the fetch ended without completing; discard the
+		 * partial archive entry
+		 */
+		fetch_record_discard(f);
+	}
+
 	fetchers[f->fetcherd].ops.free(f->fetcher_handle);
 
 	fetch_unref_fetcher(f->fetcherd);
@@ -598,6 +826,30 @@ bool fetch_can_fetch(const nsurl *url)
 	return fetchers[fetcherd].ops.acceptable(url);
 }
 
+/* exported interface documented in content/fetch.h */
+void fetch_dns_prefetch(nsurl *url)
+{
+	lwc_string *scheme;
+	lwc_string *host;
+	int fetcherd;
+
+	host = nsurl_get_component(url, NSURL_HOST);
+	if (host == NULL) {
+		return;
+	}
+
+	scheme = nsurl_get_component(url, NSURL_SCHEME);
+	fetcherd = get_fetcher_for_scheme(scheme);
+	lwc_string_unref(scheme);
+
+	if ((fetcherd != -1) &&
+	    (fetchers[fetcherd].ops.dns_prefetch != NULL)) {
+		fetchers[fetcherd].ops.dns_prefetch(host);
+	}
+
+	lwc_string_unref(host);
+}
+
 /* exported interface documented in content/fetch.h */
 void fetch_change_callback(struct fetch *fetch,
 			   fetch_callback callback,
@@ -608,6 +860,13 @@ void fetch_change_callback(struct fetch *fetch,
 	fetch->p = p;
 }
 
+/* exported interface documented in content/fetch.h */
+void fetch_set_priority(struct fetch *fetch, fetch_priority priority)
+{
+	assert(fetch);
+	fetch->priority = priority;
+}
+
 /* exported interface documented in content/fetch.h */
 long fetch_http_code(struct fetch *fetch)
 {
@@ -759,6 +1018,11 @@ fetch_send_callback(const fetch_msg *msg, struct fetch *fetch)
 	/* Bump the last_msg to the greatest seen msg */
 	if (msg->type > fetch->last_msg)
 		fetch->last_msg = msg->type;
+
+	if (fetch->record != NULL) {
+		fetch_record_msg(msg, fetch);
+	}
+
 	fetch->callback(msg, fetch->p);
 }
 
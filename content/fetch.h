@@ -130,6 +130,21 @@ struct fetch_postdata {
 };
 
 
+/**
+ * Fetch priority classes, most urgent first.
+ *
+ * Queued fetches are dispatched in priority order so a late
+ * discovered stylesheet does not wait behind a page of images.
+ */
+typedef enum {
+	FETCH_PRIORITY_HTML = 0, /**< Root documents */
+	FETCH_PRIORITY_CSS,	 /**< Stylesheets */
+	FETCH_PRIORITY_FONT,	 /**< Web fonts */
+	FETCH_PRIORITY_SCRIPT,	 /**< Scripts */
+	FETCH_PRIORITY_IMG,	 /**< Images and other media */
+	FETCH_PRIORITY_FAVICON	 /**< Favicons and other cosmetics */
+} fetch_priority;
+
 typedef void (*fetch_callback)(const fetch_msg *msg, void *p);
 
 /**
@@ -174,6 +189,19 @@ nserror fetch_start(nsurl *url, nsurl *referer, fetch_callback callback,
  */
 void fetch_abort(struct fetch *f);
 
+/**
+ * Pause or resume data delivery for a fetch.
+ *
+ * While paused the fetcher stops delivering FETCH_DATA messages,
+ * applying flow control to the connection instead of buffering, so a
+ * fast server cannot balloon memory while the consumer lags.  Fetchers
+ * without pause support deliver as normal.
+ *
+ * \param fetch fetch to alter.
+ * \param pause true to suspend delivery, false to resume it.
+ */
+void fetch_pause(struct fetch *fetch, bool pause);
+
 
 /**
  * Check if a URL's scheme can be fetched.
@@ -183,11 +211,34 @@ void fetch_abort(struct fetch *f);
  */
 bool fetch_can_fetch(const nsurl *url);
 
+/**
+ * Hint that a URL's host is likely to be fetched from soon.
+ *
+ * Passes the host to the scheme's fetcher so the name resolution (and
+ * possibly connection setup) cost can be paid before the first real
+ * fetch.  Fetchers without prefetch support ignore the hint.
+ *
+ * \param url URL whose host may be fetched from soon.
+ */
+void fetch_dns_prefetch(nsurl *url);
+
 /**
  * Change the callback function for a fetch.
  */
 void fetch_change_callback(struct fetch *fetch, fetch_callback callback, void *p);
 
+/**
+ * Set the resource class priority of a fetch.
+ *
+ * Fetches default to FETCH_PRIORITY_HTML; callers that know they are
+ * requesting a subresource should lower the priority appropriately.
+ * Only affects fetches still waiting in the dispatch queue.
+ *
+ * \param fetch fetch to alter.
+ * \param priority the priority class of the resource being fetched.
+ */
+void fetch_set_priority(struct fetch *fetch, fetch_priority priority);
+
 /**
  * Get the HTTP response code.
  */
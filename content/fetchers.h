@@ -96,6 +96,16 @@ struct fetcher_operation_table {
 	int (*fdset)(lwc_string *scheme, fd_set *read_set, fd_set *write_set,
 		     fd_set *error_set);
 
+	/**
+	 * speculatively resolve a host likely to be fetched soon (optional)
+	 */
+	void (*dns_prefetch)(lwc_string *host);
+
+	/**
+	 * pause or resume data delivery for an active fetch (optional)
+	 */
+	void (*pause)(void *fetch, bool pause);
+
 	/**
 	 * Finalise the fetcher.
 	 */
@@ -47,17 +47,21 @@
 #include "private.h"
 #include "about.h"
 #include "blank.h"
+#include "cache.h"
 #include "certificate.h"
 #include "config.h"
 #include "chart.h"
 #include "choices.h"
 #include "imagecache.h"
+#include "memory.h"
 #include "nscolours.h"
+#include "perf.h"
 #include "query.h"
 #include "query_auth.h"
 #include "query_fetcherror.h"
 #include "query_privacy.h"
 #include "query_timeout.h"
+#include "timings.h"
 #include "atestament.h"
 
 typedef bool (*fetch_about_handler)(struct fetch_about_context *);
@@ -418,6 +422,14 @@ struct about_handlers about_handler_list[] = {
 		fetch_about_logo_handler,
 		true
 	},
+	{
+		/* details about the source data and content caches */
+		"cache",
+		SLEN("cache"),
+		NULL,
+		fetch_about_cache_handler,
+		true
+	},
 	{
 		/* details about the image cache */
 		"imagecache",
@@ -426,6 +438,30 @@ struct about_handlers about_handler_list[] = {
 		fetch_about_imagecache_handler,
 		true
 	},
+	{
+		/* per subsystem heap usage */
+		"memory",
+		SLEN("memory"),
+		NULL,
+		fetch_about_memory_handler,
+		true
+	},
+	{
+		/* page load phase timings */
+		"timings",
+		SLEN("timings"),
+		NULL,
+		fetch_about_timings_handler,
+		true
+	},
+	{
+		/* rolling performance metric timelines */
+		"perf",
+		SLEN("perf"),
+		NULL,
+		fetch_about_perf_handler,
+		true
+	},
 	{
 		/* The default blank page */
 		"blank",
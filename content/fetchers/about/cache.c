@@ -0,0 +1,150 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf.
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * content generator for the about scheme cache page
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "netsurf/types.h"
+
+#include "utils/errors.h"
+
+#include "content/hlcache.h"
+#include "content/llcache.h"
+
+#include "private.h"
+#include "cache.h"
+
+/**
+ * Compute an integer percentage guarding against a zero total
+ */
+static unsigned int cache_percent(uint64_t part, uint64_t total)
+{
+	if (total == 0) {
+		return 0;
+	}
+	return (unsigned int)((part * 100) / total);
+}
+
+/* exported interface documented in about/cache.h */
+bool fetch_about_cache_handler(struct fetch_about_context *ctx)
+{
+	struct llcache_stats llstats;
+	struct hlcache_stats hlstats;
+	uint64_t retrievals;
+	int code = 200;
+	nserror res;
+
+	res = llcache_get_stats(&llstats);
+	if (res == NSERROR_OK) {
+		res = hlcache_get_stats(&hlstats);
+	}
+	if (res != NSERROR_OK) {
+		return fetch_about_srverror(ctx);
+	}
+
+	/* content is going to return ok */
+	fetch_about_set_http_code(ctx, code);
+
+	/* content type */
+	if (fetch_about_send_header(ctx, "Content-Type: text/html"))
+		goto fetch_about_cache_handler_aborted;
+
+	/* page head */
+	res = fetch_about_ssenddataf(ctx,
+		"<html>\n<head>\n"
+		"<title>Cache Status</title>\n"
+		"<link rel=\"stylesheet\" type=\"text/css\" "
+		"href=\"resource:internal.css\">\n"
+		"</head>\n"
+		"<body id =\"cache\" class=\"ns-even-bg ns-even-fg ns-border\">\n"
+		"<h1 class=\"ns-border\">Cache Status</h1>\n");
+	if (res != NSERROR_OK) {
+		goto fetch_about_cache_handler_aborted;
+	}
+
+	/* low level cache summary */
+	retrievals = llstats.hit_ram + llstats.hit_disk + llstats.miss;
+
+	res = fetch_about_ssenddataf(ctx,
+		"<h2 class=\"ns-border\">Low-level (source data) cache</h2>\n"
+		"<p>Configured limit of %"PRIu32" bytes; "
+		"currently %"PRIu32" bytes in %"PRIu32" objects</p>\n"
+		"<p>Retrievals RAM/disc/network %"PRIu64"/%"PRIu64"/%"PRIu64
+		" (%u%%/%u%%/%u%%)</p>\n"
+		"<p>Revalidations issued %"PRIu64" of which %"PRIu64
+		" (%u%%) answered not modified</p>\n"
+		"<p>Objects evicted for space %"PRIu64"</p>\n",
+		llstats.limit,
+		llstats.size,
+		llstats.object_count,
+		llstats.hit_ram,
+		llstats.hit_disk,
+		llstats.miss,
+		cache_percent(llstats.hit_ram, retrievals),
+		cache_percent(llstats.hit_disk, retrievals),
+		cache_percent(llstats.miss, retrievals),
+		llstats.revalidate,
+		llstats.not_modified,
+		cache_percent(llstats.not_modified, llstats.revalidate),
+		llstats.evicted);
+	if (res != NSERROR_OK) {
+		goto fetch_about_cache_handler_aborted;
+	}
+
+	/* bytes fetched by scheme */
+	res = fetch_about_ssenddataf(ctx,
+		"<p>Bytes fetched http/https/file/other "
+		"%"PRIu64"/%"PRIu64"/%"PRIu64"/%"PRIu64"</p>\n",
+		llstats.http_bytes,
+		llstats.https_bytes,
+		llstats.file_bytes,
+		llstats.other_bytes);
+	if (res != NSERROR_OK) {
+		goto fetch_about_cache_handler_aborted;
+	}
+
+	/* high level cache summary */
+	res = fetch_about_ssenddataf(ctx,
+		"<h2 class=\"ns-border\">High-level (content) cache</h2>\n"
+		"<p>Currently %u contents</p>\n"
+		"<p>Retrievals reused/created %u/%u (%u%%/%u%%)</p>\n"
+		"</body>\n</html>\n",
+		hlstats.content_count,
+		hlstats.hit_count,
+		hlstats.miss_count,
+		cache_percent(hlstats.hit_count,
+			      hlstats.hit_count + hlstats.miss_count),
+		cache_percent(hlstats.miss_count,
+			      hlstats.hit_count + hlstats.miss_count));
+	if (res != NSERROR_OK) {
+		goto fetch_about_cache_handler_aborted;
+	}
+
+	fetch_about_send_finished(ctx);
+
+	return true;
+
+fetch_about_cache_handler_aborted:
+	return false;
+}
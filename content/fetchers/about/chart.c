@@ -50,6 +50,7 @@
 enum chart_type {
 		 CHART_TYPE_UNKNOWN,
 		 CHART_TYPE_PIE,
+		 CHART_TYPE_LINE,
 };
 
 /* type of chart key */
@@ -320,6 +321,8 @@ process_query_section(const char *str, size_t len, struct chart_param *chart)
 	    (strncmp(str, "type=", 5) == 0)) {
 		if (strncmp(str + 5, "pie", len - 5) == 0) {
 			chart->type = CHART_TYPE_PIE;
+		} else if (strncmp(str + 5, "line", len - 5) == 0) {
+			chart->type = CHART_TYPE_LINE;
 		} else {
 			chart->type = CHART_TYPE_UNKNOWN;
 		}
@@ -595,6 +598,211 @@ pie_chart(struct fetch_about_context *ctx, struct chart_param *chart)
 
 }
 
+/**
+ * compute the largest value across every series
+ */
+static float compute_series_max(struct chart_param *chart)
+{
+	float vmax;
+	float value;
+	unsigned int curseries;
+	unsigned int curdata;
+
+	for (vmax = 0, curseries = 0;
+	     curseries < chart->data.series_len;
+	     curseries++) {
+		for (curdata = 0;
+		     curdata < chart->data.series[curseries].len;
+		     curdata++) {
+			value = chart->data.series[curseries].value[curdata];
+			if (value > vmax) {
+				vmax = value;
+			}
+		}
+	}
+	return vmax;
+}
+
+
+static nserror
+output_line_legend(struct fetch_about_context *ctx, struct chart_param *chart)
+{
+	nserror res;
+	unsigned int sidx;
+	unsigned int legend_width;
+	unsigned int vertical_spacing;
+
+	switch (chart->key) {
+
+	case CHART_KEY_NONE:
+		break;
+	case CHART_KEY_RIGHT:
+		legend_width = chart->width - chart->area.width - chart->area.x;
+		legend_width -= 10; /* margin */
+		vertical_spacing = chart->height / (chart->data.series_len + 1);
+
+		/* one legend entry per series */
+		for (sidx = 0; sidx < chart->data.series_len; sidx++) {
+			res = fetch_about_ssenddataf(ctx,
+				"<rect  x=\"%d\" y=\"%d\" width=\"%d\" height=\"%d\" fill=\"#%06x\" />",
+				chart->width - legend_width,
+				(vertical_spacing * sidx) + (vertical_spacing/2),
+				vertical_spacing * 2 / 3,
+				vertical_spacing * 2 / 3,
+				colour_series[sidx % DEF_COLOUR_NUM]);
+			if (res != NSERROR_OK) {
+				return res;
+			}
+			res = fetch_about_ssenddataf(ctx,
+				"<text x=\"%d\" y=\"%d\" fill=\"#%06x\" >%s</text>",
+				chart->width - legend_width + vertical_spacing,
+				vertical_spacing * (sidx+1),
+				colour_series[sidx % DEF_COLOUR_NUM],
+				(sidx < chart->data.label_len) ?
+					chart->data.label[sidx].title : "");
+			if (res != NSERROR_OK) {
+				return res;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * render the data as a line chart svg
+ *
+ * each series is plotted as a polyline over a zero baseline with the
+ * vertical axis scaled to the largest value present
+ */
+static bool
+line_chart(struct fetch_about_context *ctx, struct chart_param *chart)
+{
+	nserror res;
+	float vmax; /* value scaled to the full chart area height */
+	float point_x, point_y;
+	unsigned int curseries;
+	unsigned int curdata; /* current data point index */
+	struct chart_series *series;
+
+	/* ensure there is data to render */
+	if ((chart->data.series_len < 1) || (chart->data.series[0].len < 2)) {
+		return false;
+	}
+
+	vmax = compute_series_max(chart);
+	if (vmax <= 0) {
+		/* all zero data still plots along the baseline */
+		vmax = 1;
+	}
+
+	/*
+	 * need to ensure the chart area is setup correctly
+	 *
+	 * line chart defaults to the figure width less room for the
+	 *  key on the right
+	 */
+	if ((chart->area.width == 0) || (chart->area.height == 0)) {
+		if (chart->key == CHART_KEY_NONE) {
+			chart->area.width = chart->width - chart->area.x - 10;
+		} else {
+			chart->area.width = ((chart->width * 3) / 4) - chart->area.x;
+		}
+		chart->area.height = chart->height - chart->area.y - 10;
+	}
+
+	/* content is going to return ok */
+	fetch_about_set_http_code(ctx, 200);
+
+	/* content type */
+	if (fetch_about_send_header(ctx,
+			"Content-Type: image/svg; charset=utf-8")) {
+		goto aborted;
+	}
+
+	/* svg header */
+	res = fetch_about_ssenddataf(ctx,
+			"<svg width=\"%u\" height=\"%u\" "
+			"xmlns=\"http://www.w3.org/2000/svg\">\n",
+			chart->width, chart->height);
+	if (res != NSERROR_OK) {
+		goto aborted;
+	}
+
+	/* generate the legend */
+	res = output_line_legend(ctx, chart);
+	if (res != NSERROR_OK) {
+		goto aborted;
+	}
+
+	/* axes along the left and bottom of the chart area */
+	res = fetch_about_ssenddataf(ctx,
+		"<polyline fill=\"none\" stroke=\"#777777\" "
+		"points=\"%u,%u %u,%u %u,%u\" />\n",
+		chart->area.x, chart->area.y,
+		chart->area.x, chart->area.y + chart->area.height,
+		chart->area.x + chart->area.width,
+		chart->area.y + chart->area.height);
+	if (res != NSERROR_OK) {
+		goto aborted;
+	}
+
+	/* plot each series as a polyline */
+	for (curseries = 0;
+	     curseries < chart->data.series_len;
+	     curseries++) {
+		series = chart->data.series + curseries;
+		if (series->len < 2) {
+			continue;
+		}
+
+		res = fetch_about_ssenddataf(ctx,
+			"<polyline fill=\"none\" stroke=\"#%06x\" points=\"",
+			colour_series[curseries % DEF_COLOUR_NUM]);
+		if (res != NSERROR_OK) {
+			goto aborted;
+		}
+
+		for (curdata = 0; curdata < series->len; curdata++) {
+			point_x = chart->area.x +
+				(((float)chart->area.width * curdata) /
+				 (series->len - 1));
+			point_y = chart->area.y + chart->area.height -
+				((series->value[curdata] / vmax) *
+				 chart->area.height);
+
+			res = fetch_about_ssenddataf(ctx,
+					"%g,%g ", point_x, point_y);
+			if (res != NSERROR_OK) {
+				goto aborted;
+			}
+		}
+
+		res = fetch_about_ssenddataf(ctx, "\" />\n");
+		if (res != NSERROR_OK) {
+			goto aborted;
+		}
+	}
+
+	res = fetch_about_ssenddataf(ctx, "</svg>\n");
+	if (res != NSERROR_OK) {
+		goto aborted;
+	}
+
+	fetch_about_send_finished(ctx);
+
+	return true;
+
+ aborted:
+
+	return false;
+
+}
+
 /**
  * Handler to generate about scheme chart page.
  *
@@ -618,6 +826,8 @@ bool fetch_about_chart_handler(struct fetch_about_context *ctx)
 	case CHART_TYPE_PIE:
 		return pie_chart(ctx, &chart);
 
+	case CHART_TYPE_LINE:
+		return line_chart(ctx, &chart);
 
 	default:
 		break;
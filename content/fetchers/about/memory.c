@@ -0,0 +1,122 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf.
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * content generator for the about scheme memory page
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "netsurf/types.h"
+
+#include "utils/errors.h"
+#include "utils/memreport.h"
+
+#include "private.h"
+#include "memory.h"
+
+/**
+ * Totals accumulated while emitting the usage table
+ */
+struct memory_totals {
+	struct fetch_about_context *ctx; /**< about fetch being generated */
+	size_t current; /**< sum of current usage over all entries */
+	size_t peak; /**< sum of peak usage over all entries */
+};
+
+/**
+ * Emit one registered usage counter as a table row
+ */
+static nserror
+memory_handler_entry(const char *name, size_t current, size_t peak, void *pw)
+{
+	struct memory_totals *totals = pw;
+
+	totals->current += current;
+	totals->peak += peak;
+
+	return fetch_about_ssenddataf(totals->ctx,
+		"<tr><td>%s</td>"
+		"<td>%zu kB</td>"
+		"<td>%zu kB</td></tr>\n",
+		name,
+		current / 1024,
+		peak / 1024);
+}
+
+/* exported interface documented in about/memory.h */
+bool fetch_about_memory_handler(struct fetch_about_context *ctx)
+{
+	struct memory_totals totals = { .ctx = ctx };
+	int code = 200;
+	nserror res;
+
+	/* content is going to return ok */
+	fetch_about_set_http_code(ctx, code);
+
+	/* content type */
+	if (fetch_about_send_header(ctx, "Content-Type: text/html"))
+		goto fetch_about_memory_handler_aborted;
+
+	/* page head */
+	res = fetch_about_ssenddataf(ctx,
+		"<html>\n<head>\n"
+		"<title>Memory Usage</title>\n"
+		"<link rel=\"stylesheet\" type=\"text/css\" "
+		"href=\"resource:internal.css\">\n"
+		"</head>\n"
+		"<body id =\"memory\" class=\"ns-even-bg ns-even-fg ns-border\">\n"
+		"<h1 class=\"ns-border\">Memory Usage</h1>\n"
+		"<table class=\"config\">\n"
+		"<tr><th>Subsystem</th>"
+		"<th>Current</th>"
+		"<th>Peak</th></tr>\n");
+	if (res != NSERROR_OK) {
+		goto fetch_about_memory_handler_aborted;
+	}
+
+	/* registered usage counters */
+	res = memreport_iterate(memory_handler_entry, &totals);
+	if (res != NSERROR_OK) {
+		goto fetch_about_memory_handler_aborted;
+	}
+
+	/* totals and page foot */
+	res = fetch_about_ssenddataf(ctx,
+		"<tr><td>Total</td>"
+		"<td>%zu kB</td>"
+		"<td>%zu kB</td></tr>\n"
+		"</table>\n"
+		"<p>Peak values are the highest usage observed at any "
+		"generation of this page.</p>\n"
+		"</body>\n</html>\n",
+		totals.current / 1024,
+		totals.peak / 1024);
+	if (res != NSERROR_OK) {
+		goto fetch_about_memory_handler_aborted;
+	}
+
+	fetch_about_send_finished(ctx);
+
+	return true;
+
+fetch_about_memory_handler_aborted:
+	return false;
+}
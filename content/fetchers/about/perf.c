@@ -0,0 +1,145 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf.
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * content generator for the about scheme perf page
+ *
+ * Renders a timeline per retained metric as an embedded about:chart
+ * line figure built from the ring buffer samples. The page refreshes
+ * itself so leaving it open in a window gives a live dashboard with
+ * no external tooling.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "netsurf/types.h"
+
+#include "utils/errors.h"
+
+#include "desktop/perf_log.h"
+
+#include "private.h"
+#include "perf.h"
+
+/** Seconds between automatic dashboard refreshes */
+#define PERF_REFRESH_INTERVAL 5
+
+/**
+ * output the timeline figure for a single metric
+ *
+ * \param ctx The fetcher context
+ * \param metric The metric to chart
+ * \return NSERROR_OK on success else error code
+ */
+static nserror
+perf_output_metric(struct fetch_about_context *ctx,
+		   enum perf_log_metric metric)
+{
+	nserror res;
+	float values[PERF_LOG_DEPTH];
+	unsigned int count;
+	unsigned int idx;
+
+	count = perf_log_series(metric, values, PERF_LOG_DEPTH);
+
+	res = fetch_about_ssenddataf(ctx,
+		"<h2 class=\"ns-border\">%s</h2>\n",
+		perf_log_metric_name(metric));
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	if (count < 2) {
+		return fetch_about_ssenddataf(ctx,
+			"<p>Not enough samples recorded yet.</p>\n");
+	}
+
+	res = fetch_about_ssenddataf(ctx,
+		"<p>%u samples, latest %g</p>\n"
+		"<p><img src=\"about:chart?type=line"
+		"&amp;width=600&amp;height=160&amp;key=1&amp;values=",
+		count,
+		values[count - 1]);
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	for (idx = 0; idx < count; idx++) {
+		res = fetch_about_ssenddataf(ctx,
+			(idx == 0) ? "%g" : ",%g", values[idx]);
+		if (res != NSERROR_OK) {
+			return res;
+		}
+	}
+
+	return fetch_about_ssenddataf(ctx, "\"></p>\n");
+}
+
+/* exported interface documented in about/perf.h */
+bool fetch_about_perf_handler(struct fetch_about_context *ctx)
+{
+	unsigned int metric;
+	int code = 200;
+	nserror res;
+
+	/* content is going to return ok */
+	fetch_about_set_http_code(ctx, code);
+
+	/* content type */
+	if (fetch_about_send_header(ctx, "Content-Type: text/html"))
+		goto fetch_about_perf_handler_aborted;
+
+	/* page head */
+	res = fetch_about_ssenddataf(ctx,
+		"<html>\n<head>\n"
+		"<title>Performance Dashboard</title>\n"
+		"<meta http-equiv=\"refresh\" content=\"%d\">\n"
+		"<link rel=\"stylesheet\" type=\"text/css\" "
+		"href=\"resource:internal.css\">\n"
+		"</head>\n"
+		"<body id =\"perf\" class=\"ns-even-bg ns-even-fg ns-border\">\n"
+		"<h1 class=\"ns-border\">Performance Dashboard</h1>\n"
+		"<p>Newest %d samples per metric; refreshes every %d seconds.</p>\n",
+		PERF_REFRESH_INTERVAL,
+		PERF_LOG_DEPTH,
+		PERF_REFRESH_INTERVAL);
+	if (res != NSERROR_OK) {
+		goto fetch_about_perf_handler_aborted;
+	}
+
+	for (metric = 0; metric < PERF_LOG_METRIC_COUNT; metric++) {
+		res = perf_output_metric(ctx, metric);
+		if (res != NSERROR_OK) {
+			goto fetch_about_perf_handler_aborted;
+		}
+	}
+
+	res = fetch_about_ssenddataf(ctx, "</body>\n</html>\n");
+	if (res != NSERROR_OK) {
+		goto fetch_about_perf_handler_aborted;
+	}
+
+	fetch_about_send_finished(ctx);
+
+	return true;
+
+fetch_about_perf_handler_aborted:
+	return false;
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf.
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * content generator for the about scheme timings page
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "netsurf/types.h"
+
+#include "utils/errors.h"
+
+#include "content/content.h"
+#include "content/page_timings.h"
+
+#include "private.h"
+#include "timings.h"
+
+/* exported interface documented in about/timings.h */
+bool fetch_about_timings_handler(struct fetch_about_context *ctx)
+{
+	struct page_timings_stats stats;
+	struct content_timings timings;
+	unsigned int phase;
+	unsigned int index;
+	int code = 200;
+	nserror res;
+
+	/* content is going to return ok */
+	fetch_about_set_http_code(ctx, code);
+
+	/* content type */
+	if (fetch_about_send_header(ctx, "Content-Type: text/html"))
+		goto fetch_about_timings_handler_aborted;
+
+	/* page head */
+	res = fetch_about_ssenddataf(ctx,
+		"<html>\n<head>\n"
+		"<title>Page Load Timings</title>\n"
+		"<link rel=\"stylesheet\" type=\"text/css\" "
+		"href=\"resource:internal.css\">\n"
+		"</head>\n"
+		"<body id =\"timings\" class=\"ns-even-bg ns-even-fg ns-border\">\n"
+		"<h1 class=\"ns-border\">Page Load Timings</h1>\n");
+	if (res != NSERROR_OK) {
+		goto fetch_about_timings_handler_aborted;
+	}
+
+	res = fetch_about_ssenddataf(ctx,
+		"<p>Navigations recorded: %u</p>\n",
+		page_timings_count());
+	if (res != NSERROR_OK) {
+		goto fetch_about_timings_handler_aborted;
+	}
+
+	/* per phase aggregate table */
+	res = fetch_about_ssenddataf(ctx,
+		"<table class=\"config\">\n"
+		"<tr class=\"ns-border\">"
+		"<th>Phase</th>"
+		"<th>Samples</th>"
+		"<th>Min</th>"
+		"<th>Mean</th>"
+		"<th>p50</th>"
+		"<th>p90</th>"
+		"<th>p99</th>"
+		"<th>Max</th>"
+		"</tr>\n");
+	if (res != NSERROR_OK) {
+		goto fetch_about_timings_handler_aborted;
+	}
+
+	for (phase = 0; phase < PAGE_TIMINGS_PHASE_COUNT; phase++) {
+		res = page_timings_phase_stats(phase, &stats);
+		if (res == NSERROR_NOT_FOUND) {
+			break; /* nothing committed yet */
+		}
+		if (res != NSERROR_OK) {
+			goto fetch_about_timings_handler_aborted;
+		}
+
+		res = fetch_about_ssenddataf(ctx,
+			"<tr class=\"ns-border\">"
+			"<th>%s</th>"
+			"<td>%u</td>"
+			"<td>%"PRIu64"ms</td>"
+			"<td>%"PRIu64"ms</td>"
+			"<td>%"PRIu64"ms</td>"
+			"<td>%"PRIu64"ms</td>"
+			"<td>%"PRIu64"ms</td>"
+			"<td>%"PRIu64"ms</td>"
+			"</tr>\n",
+			page_timings_phase_name(phase),
+			stats.count,
+			stats.min,
+			stats.mean,
+			stats.p50,
+			stats.p90,
+			stats.p99,
+			stats.max);
+		if (res != NSERROR_OK) {
+			goto fetch_about_timings_handler_aborted;
+		}
+	}
+
+	res = fetch_about_ssenddataf(ctx, "</table>\n");
+	if (res != NSERROR_OK) {
+		goto fetch_about_timings_handler_aborted;
+	}
+
+	/* recently completed content conversions */
+	res = fetch_about_ssenddataf(ctx,
+		"<h2 class=\"ns-border\">Recent conversions</h2>\n"
+		"<table class=\"config\">\n"
+		"<tr class=\"ns-border\">"
+		"<th>Type</th>"
+		"<th>First data</th>"
+		"<th>Parsed</th>"
+		"<th>Converted</th>"
+		"<th>Total</th>"
+		"</tr>\n");
+	if (res != NSERROR_OK) {
+		goto fetch_about_timings_handler_aborted;
+	}
+
+	for (index = 0;; index++) {
+		res = content_get_timings(index, &timings);
+		if (res == NSERROR_NOT_FOUND) {
+			break; /* ran out of retained records */
+		}
+		if (res != NSERROR_OK) {
+			goto fetch_about_timings_handler_aborted;
+		}
+
+		res = fetch_about_ssenddataf(ctx,
+			"<tr class=\"ns-border\">"
+			"<th>%s</th>"
+			"<td>%"PRIu64"ms</td>"
+			"<td>%"PRIu64"ms</td>"
+			"<td>%"PRIu64"ms</td>"
+			"<td>%"PRIu64"ms</td>"
+			"</tr>\n",
+			timings.mime_type,
+			timings.first_data,
+			timings.parse,
+			timings.convert,
+			timings.total);
+		if (res != NSERROR_OK) {
+			goto fetch_about_timings_handler_aborted;
+		}
+	}
+
+	res = fetch_about_ssenddataf(ctx, "</table>\n</body>\n</html>\n");
+	if (res != NSERROR_OK) {
+		goto fetch_about_timings_handler_aborted;
+	}
+
+	fetch_about_send_finished(ctx);
+
+	return true;
+
+fetch_about_timings_handler_aborted:
+	return false;
+}
@@ -34,6 +34,7 @@
 #include <errno.h>
 #include <inttypes.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 #include <strings.h>
 #include <time.h>
@@ -49,6 +50,7 @@
 #include "utils/messages.h"
 #include "utils/utils.h"
 #include "utils/ring.h"
+#include "utils/trace.h"
 #include "utils/useragent.h"
 #include "utils/file.h"
 #include "utils/string.h"
@@ -239,6 +241,7 @@ struct curl_fetch_info {
 	bool had_headers;	/**< Headers have been processed. */
 	bool abort;		/**< Abort requested. */
 	bool stopped;		/**< Download stopped on purpose. */
+	bool paused;		/**< Data delivery suspended by consumer. */
 	bool only_2xx;		/**< Only HTTP 2xx responses acceptable. */
 	bool downgrade_tls;	/**< Downgrade to TLS 1.2 */
 	nsurl *url;		/**< URL of this fetch. */
@@ -291,6 +294,33 @@ static char fetch_proxy_userpwd[100];
 /** Interlock to prevent initiation during callbacks */
 static bool inside_curl = false;
 
+/** A socket cURL has asked to be monitored for activity */
+struct curl_socket_watch {
+	curl_socket_t sockfd; /**< The socket descriptor */
+	int what; /**< Events of interest (CURL_POLL_IN/OUT/INOUT) */
+};
+
+/** Table of sockets registered through CURLMOPT_SOCKETFUNCTION */
+static struct curl_socket_watch *fetch_curl_sockets;
+
+/** Number of entries used in fetch_curl_sockets */
+static size_t fetch_curl_sockets_count;
+
+/** Number of entries allocated in fetch_curl_sockets */
+static size_t fetch_curl_sockets_alloc;
+
+/** Share handle used to share the DNS resolution cache between handles */
+static CURLSH *fetch_curl_share;
+
+/** Number of hosts remembered to suppress duplicate DNS prefetches */
+#define DNS_PREFETCH_RECENT 16
+
+/** Hosts recently submitted for DNS prefetch */
+static lwc_string *fetch_curl_prefetched[DNS_PREFETCH_RECENT];
+
+/** Next table slot to reuse for a prefetched host */
+static unsigned int fetch_curl_prefetched_idx;
+
 
 /**
  * Initialise a cURL fetcher.
@@ -312,6 +342,7 @@ static bool fetch_curl_initialise(lwc_string *scheme)
 static void fetch_curl_finalise(lwc_string *scheme)
 {
 	struct cache_handle *h;
+	unsigned int prefetchd;
 
 	curl_fetchers_registered--;
 	NSLOG(netsurf, INFO, "Finalise cURL fetcher %s",
@@ -329,11 +360,33 @@ static void fetch_curl_finalise(lwc_string *scheme)
 			NSLOG(netsurf, INFO,
 			      "curl_multi_cleanup failed: ignoring");
 
+		if (fetch_curl_share != NULL) {
+			curl_share_cleanup(fetch_curl_share);
+			fetch_curl_share = NULL;
+		}
+
 		curl_global_cleanup();
 
 		NSLOG(netsurf, DEBUG, "Cleaning up SSL cert chain hashmap");
 		hashmap_destroy(curl_fetch_ssl_hashmap);
 		curl_fetch_ssl_hashmap = NULL;
+
+		/* Discard the watched socket table used in event mode */
+		free(fetch_curl_sockets);
+		fetch_curl_sockets = NULL;
+		fetch_curl_sockets_count = 0;
+		fetch_curl_sockets_alloc = 0;
+
+		/* Release the hosts remembered for prefetch dedup */
+		for (prefetchd = 0;
+		     prefetchd != DNS_PREFETCH_RECENT;
+		     prefetchd++) {
+			if (fetch_curl_prefetched[prefetchd] != NULL) {
+				lwc_string_unref(
+					fetch_curl_prefetched[prefetchd]);
+				fetch_curl_prefetched[prefetchd] = NULL;
+			}
+		}
 	}
 
 	/* Free anything remaining in the cached curl handle ring */
@@ -359,6 +412,95 @@ static bool fetch_curl_can_fetch(const nsurl *url)
 }
 
 
+/**
+ * Issue a connect-only probe handle for a URL.
+ *
+ * The probe performs name lookup, TCP connect and, for https URLs,
+ * the TLS handshake; the results land in the shared DNS and TLS
+ * session caches where subsequent real fetches find them.  A NULL
+ * private pointer distinguishes probes from real fetches when the
+ * multi handle reports them done.
+ *
+ * \param urlstr The URL to probe.
+ * \return NSERROR_OK if the probe was started else appropriate error.
+ */
+static nserror fetch_curl_probe(const char *urlstr)
+{
+	CURL *probe;
+	CURLcode code;
+	CURLMcode codem;
+
+	probe = curl_easy_duphandle(fetch_blank_curl);
+	if (probe == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	code = curl_easy_setopt(probe, CURLOPT_URL, urlstr);
+	if (code == CURLE_OK)
+		code = curl_easy_setopt(probe, CURLOPT_CONNECT_ONLY, 1L);
+	if (code == CURLE_OK)
+		code = curl_easy_setopt(probe, CURLOPT_PRIVATE, NULL);
+	if (code == CURLE_OK)
+		code = curl_easy_setopt(probe, CURLOPT_NOPROGRESS, 1L);
+	if (code != CURLE_OK) {
+		curl_easy_cleanup(probe);
+		return NSERROR_INIT_FAILED;
+	}
+
+	codem = curl_multi_add_handle(fetch_curl_multi, probe);
+	if (codem != CURLM_OK) {
+		curl_easy_cleanup(probe);
+		return NSERROR_INIT_FAILED;
+	}
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Speculatively resolve a host likely to be fetched from soon.
+ *
+ * cURL offers no resolve-only primitive so a connect-only probe is
+ * used; recently probed hosts are remembered so repeated hints for
+ * the same host are free.
+ *
+ * \param host The host to resolve.
+ */
+static void fetch_curl_dns_prefetch(lwc_string *host)
+{
+	char urlbuf[256];
+	unsigned int i;
+	bool match;
+
+	/* ignore hosts we have prefetched recently */
+	for (i = 0; i != DNS_PREFETCH_RECENT; i++) {
+		if ((fetch_curl_prefetched[i] != NULL) &&
+		    (lwc_string_isequal(fetch_curl_prefetched[i], host,
+					&match) == lwc_error_ok) &&
+		    (match == true)) {
+			return;
+		}
+	}
+
+	i = fetch_curl_prefetched_idx;
+	if (fetch_curl_prefetched[i] != NULL) {
+		lwc_string_unref(fetch_curl_prefetched[i]);
+	}
+	fetch_curl_prefetched[i] = lwc_string_ref(host);
+	fetch_curl_prefetched_idx = (i + 1) % DNS_PREFETCH_RECENT;
+
+	if (snprintf(urlbuf, sizeof(urlbuf), "http://%s/",
+		     lwc_string_data(host)) >= (int)sizeof(urlbuf)) {
+		return;
+	}
+
+	if (fetch_curl_probe(urlbuf) == NSERROR_OK) {
+		NSLOG(netsurf, DEBUG, "prefetching %s",
+		      lwc_string_data(host));
+	}
+}
+
+
 
 /**
  * allocate postdata
@@ -1431,6 +1573,47 @@ static void fetch_curl_abort(void *vf)
 }
 
 
+/**
+ * Scheduler callback to apply a deferred unpause.
+ */
+static void fetch_curl_resume(void *vf)
+{
+	struct curl_fetch_info *f = (struct curl_fetch_info *)vf;
+
+	if ((f->paused == false) && (f->curl_handle != NULL)) {
+		curl_easy_pause(f->curl_handle, CURLPAUSE_CONT);
+	}
+}
+
+
+/**
+ * Pause or resume data delivery for a fetch.
+ *
+ * Pausing takes effect when the write callback next runs and makes
+ * cURL hold the data (and ultimately stop reading the socket) rather
+ * than NetSurf buffering it.  Unpausing inside a cURL callback is
+ * deferred to the scheduler as curl_easy_pause() cannot be re-entered.
+ */
+static void fetch_curl_pause(void *vf, bool pause)
+{
+	struct curl_fetch_info *f = (struct curl_fetch_info *)vf;
+	assert(f);
+
+	if (f->paused == pause) {
+		return;
+	}
+	f->paused = pause;
+
+	if ((pause == false) && (f->curl_handle != NULL)) {
+		if (inside_curl) {
+			guit->misc->schedule(0, fetch_curl_resume, f);
+		} else {
+			curl_easy_pause(f->curl_handle, CURLPAUSE_CONT);
+		}
+	}
+}
+
+
 /**
  * Free a fetch structure and associated resources.
  */
@@ -1439,6 +1622,9 @@ static void fetch_curl_free(void *vf)
 	struct curl_fetch_info *f = (struct curl_fetch_info *)vf;
 	int i;
 
+	/* discard any pending deferred unpause */
+	guit->misc->schedule(-1, fetch_curl_resume, f);
+
 	if (f->curl_handle) {
 		curl_easy_cleanup(f->curl_handle);
 	}
@@ -1547,6 +1733,13 @@ static void fetch_curl_done(CURL *curl_handle, CURLcode result)
 	code = curl_easy_getinfo(curl_handle, CURLINFO_PRIVATE, _hideous_hack);
 	assert(code == CURLE_OK);
 
+	if (f == NULL) {
+		/* DNS prefetch probe completing; simply dispose of it */
+		curl_multi_remove_handle(fetch_curl_multi, curl_handle);
+		curl_easy_cleanup(curl_handle);
+		return;
+	}
+
 	abort_fetch = f->abort;
 	NSLOG(netsurf, INFO, "done %s", nsurl_access(f->url));
 
@@ -1636,6 +1829,206 @@ static void fetch_curl_done(CURL *curl_handle, CURLcode result)
 }
 
 
+/**
+ * Process any completed transfers reported by the multi handle.
+ */
+static void fetch_curl_process_results(void)
+{
+	CURLMsg *curl_msg;
+	int queue;
+
+	curl_msg = curl_multi_info_read(fetch_curl_multi, &queue);
+	while (curl_msg) {
+		switch (curl_msg->msg) {
+			case CURLMSG_DONE:
+				fetch_curl_done(curl_msg->easy_handle,
+						curl_msg->data.result);
+				break;
+			default:
+				break;
+		}
+		curl_msg = curl_multi_info_read(fetch_curl_multi, &queue);
+	}
+}
+
+
+/**
+ * Callback for CURLMOPT_SOCKETFUNCTION to maintain the watched socket table.
+ *
+ * cURL tells us exactly which sockets it is interested in so the poll
+ * only has to consider those instead of rescanning every descriptor.
+ */
+static int
+fetch_curl_socket_event(CURL *easy,
+			curl_socket_t s,
+			int what,
+			void *userp,
+			void *socketp)
+{
+	size_t i;
+
+	for (i = 0; i < fetch_curl_sockets_count; i++) {
+		if (fetch_curl_sockets[i].sockfd == s) {
+			break;
+		}
+	}
+
+	if (what == CURL_POLL_REMOVE) {
+		if (i < fetch_curl_sockets_count) {
+			fetch_curl_sockets[i] =
+				fetch_curl_sockets[--fetch_curl_sockets_count];
+		}
+		return 0;
+	}
+
+	if (i == fetch_curl_sockets_count) {
+		/* not previously seen; extend the table as required */
+		if (fetch_curl_sockets_count == fetch_curl_sockets_alloc) {
+			struct curl_socket_watch *nsockets;
+			size_t nalloc = (fetch_curl_sockets_alloc == 0) ?
+					16 : (fetch_curl_sockets_alloc * 2);
+
+			nsockets = realloc(fetch_curl_sockets,
+					   nalloc * sizeof(*nsockets));
+			if (nsockets == NULL) {
+				return 0;
+			}
+			fetch_curl_sockets = nsockets;
+			fetch_curl_sockets_alloc = nalloc;
+		}
+		fetch_curl_sockets_count++;
+	}
+
+	fetch_curl_sockets[i].sockfd = s;
+	fetch_curl_sockets[i].what = what;
+
+	return 0;
+}
+
+
+/**
+ * Scheduler callback to drive timeouts in socket event mode.
+ */
+static void fetch_curl_timeout_kick(void *p)
+{
+	int running;
+	CURLMcode codem;
+
+	inside_curl = true;
+	codem = curl_multi_socket_action(fetch_curl_multi,
+					 CURL_SOCKET_TIMEOUT, 0, &running);
+	if (codem != CURLM_OK) {
+		NSLOG(netsurf, WARNING,
+		      "curl_multi_socket_action: %i %s",
+		      codem, curl_multi_strerror(codem));
+	}
+	fetch_curl_process_results();
+	inside_curl = false;
+}
+
+
+/**
+ * Callback for CURLMOPT_TIMERFUNCTION.
+ *
+ * Registers the timeout cURL requires with the frontend scheduler so
+ * the multi handle is kicked when it wants to run even if no socket
+ * becomes ready.
+ */
+static int fetch_curl_timer_event(CURLM *multi, long timeout_ms, void *userp)
+{
+	if (timeout_ms < 0) {
+		/* cancel any pending kick */
+		guit->misc->schedule(-1, fetch_curl_timeout_kick, NULL);
+	} else {
+		guit->misc->schedule((int)timeout_ms,
+				     fetch_curl_timeout_kick, NULL);
+	}
+	return 0;
+}
+
+
+/**
+ * Progress fetches using the watched socket table.
+ *
+ * Only sockets cURL has registered interest in are examined and only
+ * those with activity are serviced via curl_multi_socket_action().
+ */
+static void fetch_curl_poll_socket_events(void)
+{
+	fd_set read_fd_set, write_fd_set, exc_fd_set;
+	struct timeval tv;
+	curl_socket_t maxfd = -1;
+	int running;
+	size_t i;
+	CURLMcode codem;
+
+	if (fetch_curl_sockets_count == 0) {
+		return;
+	}
+
+	FD_ZERO(&read_fd_set);
+	FD_ZERO(&write_fd_set);
+	FD_ZERO(&exc_fd_set);
+
+	for (i = 0; i < fetch_curl_sockets_count; i++) {
+		curl_socket_t s = fetch_curl_sockets[i].sockfd;
+
+		if (fetch_curl_sockets[i].what != CURL_POLL_OUT) {
+			FD_SET(s, &read_fd_set);
+		}
+		if (fetch_curl_sockets[i].what != CURL_POLL_IN) {
+			FD_SET(s, &write_fd_set);
+		}
+		FD_SET(s, &exc_fd_set);
+		if (s > maxfd) {
+			maxfd = s;
+		}
+	}
+
+	tv.tv_sec = 0;
+	tv.tv_usec = 0;
+	if (select(maxfd + 1, &read_fd_set, &write_fd_set, &exc_fd_set,
+		   &tv) <= 0) {
+		return;
+	}
+
+	inside_curl = true;
+	for (i = 0; i < fetch_curl_sockets_count; i++) {
+		curl_socket_t s = fetch_curl_sockets[i].sockfd;
+		int ev_bitmask = 0;
+
+		if (FD_ISSET(s, &read_fd_set)) {
+			ev_bitmask |= CURL_CSELECT_IN;
+		}
+		if (FD_ISSET(s, &write_fd_set)) {
+			ev_bitmask |= CURL_CSELECT_OUT;
+		}
+		if (FD_ISSET(s, &exc_fd_set)) {
+			ev_bitmask |= CURL_CSELECT_ERR;
+		}
+		if (ev_bitmask == 0) {
+			continue;
+		}
+
+		codem = curl_multi_socket_action(fetch_curl_multi, s,
+						 ev_bitmask, &running);
+		if (codem != CURLM_OK) {
+			NSLOG(netsurf, WARNING,
+			      "curl_multi_socket_action: %i %s",
+			      codem, curl_multi_strerror(codem));
+			break;
+		}
+		/* servicing a socket may have altered the table; restart */
+		i = (size_t)-1;
+		FD_CLR(s, &read_fd_set);
+		FD_CLR(s, &write_fd_set);
+		FD_CLR(s, &exc_fd_set);
+	}
+	fetch_curl_process_results();
+	inside_curl = false;
+}
+
+
 /**
  * Do some work on current fetches.
  *
@@ -1643,9 +2036,13 @@ static void fetch_curl_done(CURL *curl_handle, CURLcode result)
  */
 static void fetch_curl_poll(lwc_string *scheme_ignored)
 {
-	int running, queue;
+	int running;
 	CURLMcode codem;
-	CURLMsg *curl_msg;
+
+	if (nsoption_bool(curl_socket_events)) {
+		fetch_curl_poll_socket_events();
+		return;
+	}
 
 	if (nsoption_bool(suppress_curl_debug) == false) {
 		fd_set read_fd_set, write_fd_set, exc_fd_set;
@@ -1699,18 +2096,7 @@ static void fetch_curl_poll(lwc_string *scheme_ignored)
 	} while (codem == CURLM_CALL_MULTI_PERFORM);
 
 	/* process curl results */
-	curl_msg = curl_multi_info_read(fetch_curl_multi, &queue);
-	while (curl_msg) {
-		switch (curl_msg->msg) {
-			case CURLMSG_DONE:
-				fetch_curl_done(curl_msg->easy_handle,
-						curl_msg->data.result);
-				break;
-			default:
-				break;
-		}
-		curl_msg = curl_multi_info_read(fetch_curl_multi, &queue);
-	}
+	fetch_curl_process_results();
 	inside_curl = false;
 }
 
@@ -1819,6 +2205,8 @@ static size_t fetch_curl_data(char *data, size_t size, size_t nmemb, void *_f)
 	CURLcode code;
 	fetch_msg msg;
 
+	NSTRACE(NSTRACE_FETCH, "fetch_curl_data", size * nmemb);
+
 	/* ensure we only have to get this information once */
 	if (!f->http_code) {
 		code = curl_easy_getinfo(f->curl_handle, CURLINFO_HTTP_CODE,
@@ -1840,6 +2228,13 @@ static size_t fetch_curl_data(char *data, size_t size, size_t nmemb, void *_f)
 		return 0;
 	}
 
+	if (f->paused) {
+		/* consumer has requested flow control; cURL retains
+		 * this buffer and redelivers it once unpaused
+		 */
+		return CURL_WRITEFUNC_PAUSE;
+	}
+
 	/* send data to the caller */
 	msg.type = FETCH_DATA;
 	msg.data.header_or_data.buf = (const uint8_t *) data;
@@ -1961,6 +2356,55 @@ static int fetch_curl_fdset(lwc_string *scheme, fd_set *read_set,
 
 
 
+/**
+ * Determine the content encodings to advertise to servers.
+ *
+ * cURL decompresses whatever encoding it negotiates on the fly and
+ * hands the decoded bytes to fetch_curl_data, so anything the linked
+ * library can decode may be accepted.  Brotli and zstd encoded
+ * responses are typically 20-30% smaller than their gzip equivalents
+ * but the decoders only exist in newer libraries, and being built
+ * against recent headers does not guarantee the runtime library has
+ * them compiled in, so the feature bits are checked as well.
+ *
+ * \return comma separated encoding list for CURLOPT_ENCODING
+ */
+static const char *fetch_curl_accept_encoding(void)
+{
+	static const char *encodings = NULL;
+
+	if (encodings == NULL) {
+		curl_version_info_data *data;
+		bool brotli = false;
+		bool zstd = false;
+
+		data = curl_version_info(CURLVERSION_NOW);
+		(void) data;
+
+#if LIBCURL_VERSION_NUM >= 0x073900
+		/* version 7.57.0 or later may decode brotli */
+		brotli = (data->features & CURL_VERSION_BROTLI) != 0;
+#endif
+#if LIBCURL_VERSION_NUM >= 0x074800
+		/* version 7.72.0 or later may decode zstd */
+		zstd = (data->features & CURL_VERSION_ZSTD) != 0;
+#endif
+
+		if (brotli && zstd) {
+			encodings = "gzip, deflate, br, zstd";
+		} else if (brotli) {
+			encodings = "gzip, deflate, br";
+		} else if (zstd) {
+			encodings = "gzip, deflate, zstd";
+		} else {
+			encodings = "gzip, deflate";
+		}
+	}
+
+	return encodings;
+}
+
+
 /* exported function documented in content/fetchers/curl.h */
 nserror fetch_curl_register(void)
 {
@@ -1977,6 +2421,8 @@ nserror fetch_curl_register(void)
 		.free = fetch_curl_free,
 		.poll = fetch_curl_poll,
 		.fdset = fetch_curl_fdset,
+		.dns_prefetch = fetch_curl_dns_prefetch,
+		.pause = fetch_curl_pause,
 		.finalise = fetch_curl_finalise
 	};
 
@@ -2006,6 +2452,20 @@ nserror fetch_curl_register(void)
 		return NSERROR_INIT_FAILED;
 	}
 
+	/* Share DNS resolutions and negotiated TLS sessions between
+	 * all handles, including the connect-only probes used for DNS
+	 * prefetch and preconnect.  Failure here just loses the
+	 * sharing so is not fatal.
+	 */
+	fetch_curl_share = curl_share_init();
+	if (fetch_curl_share != NULL) {
+		curl_share_setopt(fetch_curl_share,
+				  CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt(fetch_curl_share,
+				  CURLSHOPT_SHARE,
+				  CURL_LOCK_DATA_SSL_SESSION);
+	}
+
 #if LIBCURL_VERSION_NUM >= 0x071e00
 	/* built against 7.30.0 or later: configure caching */
 	{
@@ -2024,6 +2484,23 @@ nserror fetch_curl_register(void)
 		SETOPT(CURLMOPT_MAXCONNECTS, maxconnects);
 		SETOPT(CURLMOPT_MAX_TOTAL_CONNECTIONS, maxconnects);
 		SETOPT(CURLMOPT_MAX_HOST_CONNECTIONS, nsoption_int(max_fetchers_per_host));
+
+		if (nsoption_bool(curl_socket_events)) {
+			SETOPT(CURLMOPT_SOCKETFUNCTION, fetch_curl_socket_event);
+			SETOPT(CURLMOPT_TIMERFUNCTION, fetch_curl_timer_event);
+		}
+
+#if LIBCURL_VERSION_NUM >= 0x072b00
+		/* version 7.43.0 or later: multiplex over shared connections */
+		if (nsoption_bool(http2_multiplexing)) {
+			SETOPT(CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#if LIBCURL_VERSION_NUM >= 0x074300
+			/* version 7.67.0 or later can cap stream count */
+			SETOPT(CURLMOPT_MAX_CONCURRENT_STREAMS,
+			       (long)nsoption_uint(http2_max_concurrent_streams));
+#endif
+		}
+#endif
 	}
 #endif
 
@@ -2052,15 +2529,23 @@ nserror fetch_curl_register(void)
 		SETOPT(CURLOPT_VERBOSE, 1);
 	}
 
-	/* Currently we explode if curl uses HTTP2, so force 1.1. */
+#if LIBCURL_VERSION_NUM >= 0x072f00
+	/* version 7.47.0 or later: can request HTTP/2 over TLS only */
+	if (nsoption_bool(http2_multiplexing)) {
+		SETOPT(CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+	} else {
+		SETOPT(CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+	}
+#else
 	SETOPT(CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+#endif
 
 	SETOPT(CURLOPT_WRITEFUNCTION, fetch_curl_data);
 	SETOPT(CURLOPT_HEADERFUNCTION, fetch_curl_header);
 	SETOPT(NSCURLOPT_PROGRESS_FUNCTION, fetch_curl_progress);
 	SETOPT(CURLOPT_NOPROGRESS, 0);
 	SETOPT(CURLOPT_USERAGENT, user_agent_string());
-	SETOPT(CURLOPT_ENCODING, "gzip");
+	SETOPT(CURLOPT_ENCODING, fetch_curl_accept_encoding());
 	SETOPT(CURLOPT_LOW_SPEED_LIMIT, 1L);
 	SETOPT(CURLOPT_LOW_SPEED_TIME, 180L);
 	SETOPT(CURLOPT_NOSIGNAL, 1L);
@@ -2068,6 +2553,12 @@ nserror fetch_curl_register(void)
 	SETOPT(CURLOPT_OPENSOCKETFUNCTION, fetch_curl_socket_open);
 	SETOPT(CURLOPT_CLOSESOCKETFUNCTION, fetch_curl_socket_close);
 
+	if (fetch_curl_share != NULL) {
+		SETOPT(CURLOPT_SHARE, fetch_curl_share);
+		/* resolutions stay useful for the lifetime of a page visit */
+		SETOPT(CURLOPT_DNS_CACHE_TIMEOUT, 300L);
+	}
+
 	if (nsoption_charp(ca_bundle) &&
 	    strcmp(nsoption_charp(ca_bundle), "")) {
 		NSLOG(netsurf, INFO, "ca_bundle: '%s'",
@@ -2139,6 +2630,24 @@ nserror fetch_curl_register(void)
 		}
 	}
 
+	/* Warm the connection to the configured homepage so the first
+	 * navigation after startup overlaps its DNS lookup, TCP
+	 * connect and TLS handshake with browser initialisation
+	 * instead of serialising behind it.
+	 */
+	if ((nsoption_charp(homepage_url) != NULL) &&
+	    (nsoption_charp(homepage_url)[0] != '\0')) {
+		nsurl *home;
+
+		if (nsurl_create(nsoption_charp(homepage_url),
+				 &home) == NSERROR_OK) {
+			if (fetch_curl_can_fetch(home)) {
+				fetch_curl_probe(nsurl_access(home));
+			}
+			nsurl_unref(home);
+		}
+	}
+
 	return NSERROR_OK;
 
 curl_easy_setopt_failed:
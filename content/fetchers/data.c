@@ -26,9 +26,9 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <libwapcaplet/libwapcaplet.h>
-#include <nsutils/base64.h>
 
 #include "netsurf/inttypes.h"
+#include "utils/base64.h"
 #include "utils/url.h"
 #include "utils/nsurl.h"
 #include "utils/corestrings.h"
@@ -220,10 +220,10 @@ static bool fetch_data_process(struct fetch_data_context *c)
 	}
 	
 	if (c->base64) {
-		if ((nsu_base64_decode_alloc((uint8_t *)unescaped,
-					     unescaped_len,
-					     (uint8_t **)&c->data,
-					     &c->datalen) != NSUERROR_OK) ||
+		if ((base64_decode_alloc((uint8_t *)unescaped,
+					 unescaped_len,
+					 (uint8_t **)&c->data,
+					 &c->datalen) != NSERROR_OK) ||
 		    (c->data == NULL)) {
 			msg.type = FETCH_ERROR;
 			msg.data.error = "Unable to Base64 decode data: URL";
@@ -308,6 +308,15 @@ static void fetch_file_process_plain(struct fetch_file_context *ctx,
 			close(fd);
 			return;
 		}
+
+#ifdef POSIX_MADV_SEQUENTIAL
+		/* The mapping is consumed once, in order, so ask the
+		 * kernel to read ahead aggressively rather than
+		 * faulting each page in on first touch.
+		 */
+		(void)posix_madvise(buf, buf_size, POSIX_MADV_SEQUENTIAL);
+		(void)posix_madvise(buf, buf_size, POSIX_MADV_WILLNEED);
+#endif
 	}
 
 	/* fetch is going to be successful */
@@ -0,0 +1,453 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf.
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * replay archive scheme handling.
+ *
+ * Serves http and https fetches back from an archive recorded by a
+ * previous session, making page loads reproducible and network
+ * independent for benchmarking.
+ *
+ * An archive entry is a single file named by the hash of its URL
+ * holding a "NSREPLAY 1" signature line, a "u " line carrying the
+ * URL, then length prefixed records in the order the original fetch
+ * produced them: "h <len>" header lines, "d <len>" data chunks and
+ * optionally "r <len>" for a redirect, followed by an "e <ms>"
+ * elapsed time trailer and a "c <code>" HTTP response code.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libwapcaplet/libwapcaplet.h>
+#include <nsutils/time.h>
+
+#include "netsurf/inttypes.h"
+#include "utils/corestrings.h"
+#include "utils/file.h"
+#include "utils/log.h"
+#include "utils/nsoption.h"
+#include "utils/nsurl.h"
+#include "utils/ring.h"
+#include "utils/utils.h"
+
+#include "content/fetch.h"
+#include "content/fetchers.h"
+#include "content/fetchers/replay.h"
+
+/** Context for a replayed fetch */
+struct fetch_replay_context {
+	struct fetch *parent_fetch;
+	nsurl *url;
+
+	char *buf; /**< the loaded archive entry */
+	size_t buflen; /**< length of the archive entry */
+	uint64_t elapsed; /**< recorded fetch duration in ms */
+	long http_code; /**< recorded HTTP response code */
+	uint64_t start; /**< monotonic ms the replay started */
+	bool loaded; /**< the archive entry has been read and scanned */
+
+	bool aborted;
+	bool locked;
+
+	struct fetch_replay_context *r_next, *r_prev;
+};
+
+static struct fetch_replay_context *ring = NULL;
+
+static bool fetch_replay_initialise(lwc_string *scheme)
+{
+	NSLOG(netsurf, INFO, "fetch_replay_initialise called for %s",
+	      lwc_string_data(scheme));
+
+	return true;
+}
+
+static void fetch_replay_finalise(lwc_string *scheme)
+{
+	NSLOG(netsurf, INFO, "fetch_replay_finalise called for %s",
+	      lwc_string_data(scheme));
+}
+
+static bool fetch_replay_can_fetch(const nsurl *url)
+{
+	return true;
+}
+
+static void fetch_replay_send_callback(const fetch_msg *msg,
+		struct fetch_replay_context *c)
+{
+	c->locked = true;
+	fetch_send_callback(msg, c->parent_fetch);
+	c->locked = false;
+}
+
+static void fetch_replay_send_error(struct fetch_replay_context *c,
+		const char *error)
+{
+	fetch_msg msg;
+
+	msg.type = FETCH_ERROR;
+	msg.data.error = error;
+	fetch_replay_send_callback(&msg, c);
+}
+
+static void *fetch_replay_setup(struct fetch *parent_fetch, nsurl *url,
+		 bool only_2xx, bool downgrade_tls, const char *post_urlenc,
+		 const struct fetch_multipart_data *post_multipart,
+		 const char **headers)
+{
+	struct fetch_replay_context *ctx = calloc(1, sizeof(*ctx));
+
+	if (ctx == NULL)
+		return NULL;
+
+	ctx->parent_fetch = parent_fetch;
+	ctx->url = nsurl_ref(url);
+
+	nsu_getmonotonic_ms(&ctx->start);
+
+	RING_INSERT(ring, ctx);
+
+	return ctx;
+}
+
+static bool fetch_replay_start(void *ctx)
+{
+	return true;
+}
+
+static void fetch_replay_free(void *ctx)
+{
+	struct fetch_replay_context *c = ctx;
+
+	nsurl_unref(c->url);
+	free(c->buf);
+	free(ctx);
+}
+
+static void fetch_replay_abort(void *ctx)
+{
+	struct fetch_replay_context *c = ctx;
+
+	/* To avoid the poll loop having to deal with the fetch context
+	 * disappearing from under it, we simply flag the abort here.
+	 * The poll loop itself will perform the appropriate cleanup.
+	 */
+	c->aborted = true;
+}
+
+/**
+ * Read a length prefixed record header.
+ *
+ * \param pos Current scan position, updated past the record payload
+ * \param end End of the archive entry
+ * \param len Updated to the record payload length
+ * \param payload Updated to the record payload start
+ * \return true if a well formed record was read
+ */
+static bool fetch_replay_record(const char **pos, const char *end,
+		size_t *len, const char **payload)
+{
+	const char *nl;
+	unsigned long length;
+	char *lenend;
+
+	nl = memchr(*pos, '\n', end - *pos);
+	if (nl == NULL) {
+		return false;
+	}
+
+	length = strtoul(*pos + 2, &lenend, 10);
+	if (lenend != nl) {
+		return false;
+	}
+
+	if ((size_t)(end - (nl + 1)) < length) {
+		return false;
+	}
+
+	*payload = nl + 1;
+	*len = length;
+	*pos = nl + 1 + length;
+
+	return true;
+}
+
+/**
+ * Load and scan the archive entry for a context's URL.
+ *
+ * Reads the whole entry into memory and validates its structure,
+ * capturing the recorded elapsed time and HTTP code so replay pacing
+ * can be decided before anything is sent.
+ *
+ * \param c The fetch context to load
+ * \return true on success, false with the error already sent otherwise
+ */
+static bool fetch_replay_load(struct fetch_replay_context *c)
+{
+	char leaf[16];
+	char *path = NULL;
+	FILE *stream;
+	long flen;
+	const char *pos;
+	const char *end;
+	const char *payload;
+	size_t len;
+	nserror res;
+
+	snprintf(leaf, sizeof(leaf), "%08x.rec", nsurl_hash(c->url));
+	res = netsurf_mkpath(&path, NULL, 2,
+			     nsoption_charp(fetch_replay_path), leaf);
+	if (res != NSERROR_OK) {
+		fetch_replay_send_error(c, "Unable to build replay path");
+		return false;
+	}
+
+	stream = fopen(path, "rb");
+	if (stream == NULL) {
+		NSLOG(fetch, WARNING, "No replay entry %s for %s",
+		      path, nsurl_access(c->url));
+		free(path);
+		fetch_replay_send_error(c, "Resource not in replay archive");
+		return false;
+	}
+	free(path);
+
+	if ((fseek(stream, 0, SEEK_END) != 0) ||
+	    ((flen = ftell(stream)) < 0) ||
+	    (fseek(stream, 0, SEEK_SET) != 0)) {
+		fclose(stream);
+		fetch_replay_send_error(c, "Unable to size replay entry");
+		return false;
+	}
+
+	c->buf = malloc(flen);
+	if (c->buf == NULL) {
+		fclose(stream);
+		fetch_replay_send_error(c, "Insufficient memory for replay entry");
+		return false;
+	}
+
+	if (fread(c->buf, 1, flen, stream) != (size_t)flen) {
+		fclose(stream);
+		fetch_replay_send_error(c, "Unable to read replay entry");
+		return false;
+	}
+	fclose(stream);
+	c->buflen = flen;
+
+	/* validate structure and capture the trailer */
+	pos = c->buf;
+	end = c->buf + c->buflen;
+
+	if (((size_t)(end - pos) < SLEN("NSREPLAY 1\n")) ||
+	    (memcmp(pos, "NSREPLAY 1\n", SLEN("NSREPLAY 1\n")) != 0)) {
+		fetch_replay_send_error(c, "Malformed replay entry");
+		return false;
+	}
+	pos += SLEN("NSREPLAY 1\n");
+
+	while (pos < end) {
+		switch (*pos) {
+		case 'u': /* recorded URL, informational */
+			payload = memchr(pos, '\n', end - pos);
+			if (payload == NULL) {
+				fetch_replay_send_error(c,
+						"Malformed replay entry");
+				return false;
+			}
+			pos = payload + 1;
+			break;
+
+		case 'h':
+		case 'd':
+		case 'r':
+			if (fetch_replay_record(&pos, end,
+						&len, &payload) == false) {
+				fetch_replay_send_error(c,
+						"Malformed replay entry");
+				return false;
+			}
+			break;
+
+		case 'e':
+			c->elapsed = strtoull(pos + 2, NULL, 10);
+			payload = memchr(pos, '\n', end - pos);
+			pos = (payload != NULL) ? payload + 1 : end;
+			break;
+
+		case 'c':
+			c->http_code = strtol(pos + 2, NULL, 10);
+			payload = memchr(pos, '\n', end - pos);
+			pos = (payload != NULL) ? payload + 1 : end;
+			break;
+
+		default:
+			fetch_replay_send_error(c, "Malformed replay entry");
+			return false;
+		}
+	}
+
+	c->loaded = true;
+	return true;
+}
+
+/**
+ * Emit the loaded archive entry to the parent fetch.
+ */
+static void fetch_replay_emit(struct fetch_replay_context *c)
+{
+	fetch_msg msg;
+	const char *pos = c->buf;
+	const char *end = c->buf + c->buflen;
+	const char *payload;
+	size_t len;
+	char *location;
+
+	fetch_set_http_code(c->parent_fetch,
+			    (c->http_code != 0) ? c->http_code : 200);
+
+	pos += SLEN("NSREPLAY 1\n");
+
+	while ((pos < end) && (c->aborted == false)) {
+		switch (*pos) {
+		case 'h':
+			fetch_replay_record(&pos, end, &len, &payload);
+			msg.type = FETCH_HEADER;
+			msg.data.header_or_data.buf = (const uint8_t *)payload;
+			msg.data.header_or_data.len = len;
+			fetch_replay_send_callback(&msg, c);
+			break;
+
+		case 'd':
+			fetch_replay_record(&pos, end, &len, &payload);
+			msg.type = FETCH_DATA;
+			msg.data.header_or_data.buf = (const uint8_t *)payload;
+			msg.data.header_or_data.len = len;
+			fetch_replay_send_callback(&msg, c);
+			break;
+
+		case 'r':
+			fetch_replay_record(&pos, end, &len, &payload);
+			/* redirect target needs terminating */
+			location = strndup(payload, len);
+			if (location == NULL) {
+				fetch_replay_send_error(c,
+					"Insufficient memory for redirect");
+				return;
+			}
+			msg.type = FETCH_REDIRECT;
+			msg.data.redirect = location;
+			fetch_replay_send_callback(&msg, c);
+			free(location);
+			return;
+
+		default: /* u, e and c lines carry no payload to emit */
+			payload = memchr(pos, '\n', end - pos);
+			pos = (payload != NULL) ? payload + 1 : end;
+			break;
+		}
+	}
+
+	if (c->aborted == false) {
+		msg.type = FETCH_FINISHED;
+		fetch_replay_send_callback(&msg, c);
+	}
+}
+
+static void fetch_replay_poll(lwc_string *scheme)
+{
+	struct fetch_replay_context *c, *save_ring = NULL;
+	uint64_t now;
+
+	/* Iterate over ring, processing each pending fetch */
+	while (ring != NULL) {
+		/* Take the first entry from the ring */
+		c = ring;
+		RING_REMOVE(ring, c);
+
+		/* Ignore fetches that have been flagged as locked.
+		 * This allows safe re-entrant calls to this function.
+		 */
+		if (c->locked == true) {
+			RING_INSERT(save_ring, c);
+			continue;
+		}
+
+		if (c->aborted == false) {
+			if ((c->loaded == false) &&
+			    (fetch_replay_load(c) == false)) {
+				/* error already delivered */
+				fetch_remove_from_queues(c->parent_fetch);
+				fetch_free(c->parent_fetch);
+				continue;
+			}
+
+			/* honour the recorded duration when asked to */
+			if (nsoption_bool(fetch_replay_timing)) {
+				nsu_getmonotonic_ms(&now);
+				if (now < (c->start + c->elapsed)) {
+					/* not due yet, revisit next poll */
+					RING_INSERT(save_ring, c);
+					continue;
+				}
+			}
+
+			fetch_replay_emit(c);
+		}
+
+		/* And now finish */
+		fetch_remove_from_queues(c->parent_fetch);
+		fetch_free(c->parent_fetch);
+	}
+
+	/* Finally, if we saved any fetches which were locked or not
+	 * yet due, put them back into the ring for next time
+	 */
+	ring = save_ring;
+}
+
+/* exported interface documented in content/fetchers/replay.h */
+nserror fetch_replay_register(void)
+{
+	nserror res;
+	const struct fetcher_operation_table fetcher_ops = {
+		.initialise = fetch_replay_initialise,
+		.acceptable = fetch_replay_can_fetch,
+		.setup = fetch_replay_setup,
+		.start = fetch_replay_start,
+		.abort = fetch_replay_abort,
+		.free = fetch_replay_free,
+		.poll = fetch_replay_poll,
+		.finalise = fetch_replay_finalise
+	};
+
+	NSLOG(fetch, INFO, "Replaying http(s) fetches from %s",
+	      nsoption_charp(fetch_replay_path));
+
+	res = fetcher_add(lwc_string_ref(corestring_lwc_http), &fetcher_ops);
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	return fetcher_add(lwc_string_ref(corestring_lwc_https), &fetcher_ops);
+}
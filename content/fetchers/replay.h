@@ -0,0 +1,38 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf.
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * replay archive fetch handler interface.
+ */
+
+#ifndef NETSURF_CONTENT_FETCHERS_FETCH_REPLAY_H
+#define NETSURF_CONTENT_FETCHERS_FETCH_REPLAY_H
+
+/**
+ * Register replay archive handler for the http and https schemes.
+ *
+ * Once registered these schemes are served from the archive recorded
+ * by a previous session instead of the network, making page loads
+ * reproducible.
+ *
+ * \return NSERROR_OK on successful registration or error code on failure.
+ */
+nserror fetch_replay_register(void);
+
+#endif
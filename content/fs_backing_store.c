@@ -25,14 +25,14 @@
  * \todo Consider improving eviction sorting to include objects size
  *         and remaining lifetime and other cost metrics.
  *
- * \todo Implement mmap retrieval where supported.
- *
  * \todo Implement static retrieval for metadata objects as their heap
  *         lifetime is typically very short, though this may be obsoleted
  *         by a small object storage strategy.
  *
  */
 
+#include "utils/config.h"
+
 #include <unistd.h>
 #include <string.h>
 #include <sys/stat.h>
@@ -41,7 +41,12 @@
 #include <errno.h>
 #include <time.h>
 #include <stdlib.h>
+#include <zlib.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
 #include <nsutils/unistd.h>
+#include <nsutils/time.h>
 
 #include "netsurf/inttypes.h"
 #include "utils/filepath.h"
@@ -49,6 +54,7 @@
 #include "utils/nsurl.h"
 #include "utils/log.h"
 #include "utils/messages.h"
+#include "utils/nsoption.h"
 #include "utils/hashmap.h"
 #include "desktop/gui_internal.h"
 #include "netsurf/misc.h"
@@ -56,7 +62,7 @@
 #include "content/backing_store.h"
 
 /** Backing store file format version */
-#define CONTROL_VERSION 202
+#define CONTROL_VERSION 204
 
 /**
  * Number of milliseconds after a update before control data
@@ -64,9 +70,49 @@
  */
 #define CONTROL_MAINT_TIME 10000
 
-/** Filename of serialised entries */
+/**
+ * Maximum number of entry element writes which may be queued for
+ * deferred writeout to storage.
+ */
+#define DEFER_WRITE_QUEUE_SIZE 32
+
+/**
+ * Number of milliseconds between deferred writeout scheduler callbacks.
+ */
+#define DEFER_WRITE_TIME 10
+
+/**
+ * Number of milliseconds the deferred writer may spend writing in a
+ * single scheduler callback.
+ */
+#define DEFER_WRITE_BUDGET_MS 20
+
+/**
+ * Minimum element size to attempt compressing; objects smaller than
+ * this cannot usefully shrink below their storage block.
+ */
+#define COMPRESS_MIN_SIZE 256
+
+/**
+ * Number of milliseconds between background index shard replays.
+ */
+#define ENTRIES_REPLAY_TIME 100
+
+/** Filename stem of the serialised entry shard journals */
 #define ENTRIES_FNAME "entries"
 
+/** log2 number of index shard journals */
+#define INDEX_SHARD_BITS 3
+
+/** number of shard journals the entry index is distributed over */
+#define INDEX_SHARD_COUNT (1 << INDEX_SHARD_BITS)
+
+/** journal record count below which shard compaction is never worthwhile */
+#define INDEX_COMPACT_MIN 512
+
+/** ratio of journal records to live entries that triggers compaction */
+#define INDEX_COMPACT_RATIO 2
+
 /** Filename of block file index */
 #define BLOCKS_FNAME "blocks"
 
@@ -125,6 +171,10 @@ enum store_entry_elem_flags {
 	ENTRY_ELEM_FLAG_MMAP = 0x2,
 	/** entry data allocation is in small object pool */
 	ENTRY_ELEM_FLAG_SMALL = 0x4,
+	/** entry data write to storage is pending */
+	ENTRY_ELEM_FLAG_DIRTY = 0x8,
+	/** entry data is deflate compressed on disc */
+	ENTRY_ELEM_FLAG_COMPRESSED = 0x10,
 };
 
 
@@ -133,6 +183,18 @@ enum store_entry_flags {
 	ENTRY_FLAGS_NONE = 0,
 	/** entry has been invalidated but something still holding a reference */
 	ENTRY_FLAGS_INVALID = 1,
+	/** entry has changed since it was last journaled */
+	ENTRY_FLAGS_DIRTY = 2,
+};
+
+/**
+ * Index shard journal record operations.
+ */
+enum index_journal_op {
+	/** record carries a complete entry for the url */
+	INDEX_JOURNAL_SET = 1,
+	/** the entry for the url has been removed */
+	INDEX_JOURNAL_REMOVE = 2,
 };
 
 /**
@@ -148,7 +210,9 @@ enum store_entry_flags {
  */
 struct store_entry_element {
 	uint8_t* data; /**< data allocated */
+	uint8_t* cdata; /**< compressed data awaiting writeout, or NULL */
 	uint32_t size; /**< size of entry element on disc */
+	uint32_t usize; /**< uncompressed size of entry element */
 	block_index_t block; /**< small object data block */
 	uint8_t ref; /**< element data reference count */
 	uint8_t flags; /**< entry flags */
@@ -173,6 +237,24 @@ struct store_entry {
 	struct store_entry_element elem[ENTRY_ELEM_COUNT];
 };
 
+/**
+ * Index shard journal state.
+ *
+ * Entries are distributed over several append-only journal files by
+ * url hash so the index can be persisted and compacted a piece at a
+ * time.
+ */
+struct index_shard {
+	/** append descriptor for the shard journal or -1 */
+	int fd;
+	/** journal records currently on disc */
+	unsigned int records;
+	/** live entries hashed to this shard */
+	unsigned int live;
+	/** the shard journal has been replayed into the entries map */
+	bool replayed;
+};
+
 /**
  * Small block file.
  */
@@ -210,6 +292,9 @@ struct store_state {
 	 */
 	bool entries_dirty;
 
+	/** entry index shard journals */
+	struct index_shard shards[INDEX_SHARD_COUNT];
+
 	/** small block indexes */
 	struct block_file blocks[ENTRY_ELEM_COUNT][BLOCK_FILE_COUNT];
 
@@ -224,6 +309,21 @@ struct store_state {
 	bool blocks_opened;
 
 
+	/* deferred writeout queue */
+
+	/** entries with writes awaiting the deferred writer */
+	struct store_entry *defer_queue[DEFER_WRITE_QUEUE_SIZE];
+
+	/** element index for each deferred writeout queue slot */
+	uint8_t defer_elem[DEFER_WRITE_QUEUE_SIZE];
+
+	/** index of the oldest occupied queue slot */
+	unsigned int defer_head;
+
+	/** number of occupied queue slots */
+	unsigned int defer_count;
+
+
 	/* stats */
 	uint64_t total_alloc; /**< total size of all allocated storage. */
 
@@ -241,6 +341,20 @@ struct store_state {
  */
 struct store_state *storestate;
 
+/* forward referenced deferred writeout functions */
+static nserror defer_write_queue(struct store_state *state,
+		struct store_entry *bse, int elem_idx);
+static void defer_write_pop(struct store_state *state);
+static void defer_write_run(void *s);
+
+/* forward referenced control maintenance callback */
+static void control_maintenance(void *s);
+
+/* forward referenced lazy index shard replay */
+static nserror ensure_shard_entries(struct store_state *state,
+		unsigned int shard);
+static void replay_entries_cb(void *s);
+
 /* Entries hashmap parameters
  *
  * Our hashmap has nsurl keys and store_entry values
@@ -280,6 +394,137 @@ static hashmap_parameters_t entries_hashmap_parameters = {
 	.value_destroy = entries_hashmap_value_destroy,
 };
 
+
+/**
+ * Compute the index shard an entry url belongs to.
+ *
+ * \param url The url of the entry.
+ * \return The shard number.
+ */
+static unsigned int index_shard_of(const nsurl *url)
+{
+	return nsurl_hash(url) & (INDEX_SHARD_COUNT - 1);
+}
+
+/**
+ * Generate the filename of an index shard journal.
+ *
+ * \param state The backing store state.
+ * \param shard The shard number.
+ * \param temp Whether to generate the temporary compaction name.
+ * \return The filename string or NULL on allocation error.
+ */
+static char *
+index_shard_fname(struct store_state *state, unsigned int shard, bool temp)
+{
+	char fleaf[16];
+	char *fname = NULL;
+	nserror ret;
+
+	snprintf(fleaf, sizeof(fleaf), "%s%s%d",
+		 temp ? "t" : "", ENTRIES_FNAME, shard);
+
+	ret = netsurf_mkpath(&fname, NULL, 2, state->path, fleaf);
+	if (ret != NSERROR_OK) {
+		return NULL;
+	}
+
+	return fname;
+}
+
+/**
+ * Write a single index journal record to a descriptor.
+ *
+ * A record is an operation byte, a 32bit url length, that many bytes
+ * of url and, for set operations, the full store entry struct as-is,
+ * which includes a useless nsurl pointer.
+ *
+ * \param fd The descriptor to write to.
+ * \param op The journal operation the record describes.
+ * \param ent The entry the record describes.
+ * \return NSERROR_OK on success or error code on failure.
+ */
+static nserror
+index_journal_write(int fd, enum index_journal_op op, struct store_entry *ent)
+{
+	uint8_t opb = op;
+	uint32_t len = strlen(nsurl_access(ent->url));
+
+	if (write(fd, &opb, sizeof(opb)) != sizeof(opb))
+		return NSERROR_SAVE_FAILED;
+	if (write(fd, &len, sizeof(len)) != sizeof(len))
+		return NSERROR_SAVE_FAILED;
+	if (write(fd, nsurl_access(ent->url), len) != (ssize_t)len)
+		return NSERROR_SAVE_FAILED;
+	if (op == INDEX_JOURNAL_SET) {
+		if (write(fd, ent, sizeof(*ent)) != sizeof(*ent))
+			return NSERROR_SAVE_FAILED;
+	}
+
+	return NSERROR_OK;
+}
+
+/**
+ * Append a record to an entry's index shard journal.
+ *
+ * \param state The backing store state.
+ * \param op The journal operation to append.
+ * \param ent The entry the record describes.
+ * \return NSERROR_OK on success or error code on failure.
+ */
+static nserror
+index_journal_append(struct store_state *state,
+		     enum index_journal_op op,
+		     struct store_entry *ent)
+{
+	struct index_shard *shd = &state->shards[index_shard_of(ent->url)];
+	nserror ret;
+
+	/* ensure the shard journal fd is good */
+	if (shd->fd == -1) {
+		char *fname;
+
+		fname = index_shard_fname(state,
+					  index_shard_of(ent->url),
+					  false);
+		if (fname == NULL) {
+			return NSERROR_NOMEM;
+		}
+
+		shd->fd = open(fname, O_WRONLY | O_CREAT | O_APPEND,
+			       S_IRUSR | S_IWUSR);
+		free(fname);
+		if (shd->fd == -1) {
+			NSLOG(netsurf, ERROR,
+			      "shard journal open failed errno %d", errno);
+			return NSERROR_SAVE_FAILED;
+		}
+	}
+
+	ret = index_journal_write(shd->fd, op, ent);
+	if (ret != NSERROR_OK) {
+		return ret;
+	}
+
+	shd->records++;
+
+	return NSERROR_OK;
+}
+
+/**
+ * Mark an entry as needing journaling and schedule maintenance.
+ *
+ * \param state The backing store state.
+ * \param ent The entry which has changed.
+ */
+static void index_mark_dirty(struct store_state *state, struct store_entry *ent)
+{
+	ent->flags |= ENTRY_FLAGS_DIRTY;
+	state->entries_dirty = true;
+	guit->misc->schedule(CONTROL_MAINT_TIME, control_maintenance, state);
+}
+
+
 /**
  * Generate a filename for an object.
  *
@@ -490,6 +735,10 @@ invalidate_entry(struct store_state *state, struct store_entry *bse)
 		NSLOG(netsurf, ERROR, "Error invalidating data element");
 	}
 
+	/* journal the removal so it survives a restart */
+	index_journal_append(state, INDEX_JOURNAL_REMOVE, bse);
+	state->shards[index_shard_of(bse->url)].live--;
+
 	/* As our final act we remove bse from the cache */
 	hashmap_remove(state->entries, bse->url);
 	/* From now, bse is invalid memory */
@@ -642,95 +891,166 @@ static nserror store_evict(struct store_state *state)
 	return ret;
 }
 
-/**
- * Write a single store entry to disk
- *
- * To serialise a single store entry for now we write out a 32bit int
- * which is the length of the url, then that many bytes of the url.
- * Then we write out the full store entry struct as-is, which includes
- * a useless nsurl pointer.
- */
-static nserror
-write_entry(struct store_entry *ent, int fd)
-{
-	uint32_t len = strlen(nsurl_access(ent->url));
-	if (write(fd, &len, sizeof(len)) != sizeof(len))
-		return NSERROR_SAVE_FAILED;
-	if (write(fd, nsurl_access(ent->url), len) != (ssize_t)len)
-		return NSERROR_SAVE_FAILED;
-	if (write(fd, ent, sizeof(*ent)) != sizeof(*ent))
-		return NSERROR_SAVE_FAILED;
-
-	return NSERROR_OK;
-}
-
 typedef struct {
-	int fd;
+	struct store_state *state;
 	size_t written;
+	nserror res;
 } write_entry_iteration_state;
 
 /**
  * Callback for iterating the entries hashmap
+ *
+ * Appends a journal record for each entry changed since it was last
+ * journaled. The dirty flag is cleared before the record is written
+ * so it is never persisted.
  */
 static bool
 write_entry_iterator(void *key, void *value, void *ctx)
 {
 	/* We ignore the key */
 	struct store_entry *ent = value;
-	write_entry_iteration_state *state = ctx;
-	state->written++;
-	/* We stop early if we fail to write this entry */
-	return write_entry(ent, state->fd) != NSERROR_OK;
+	write_entry_iteration_state *weistate = ctx;
+
+	if ((ent->flags & ENTRY_FLAGS_DIRTY) == 0) {
+		return false;
+	}
+	ent->flags &= ~ENTRY_FLAGS_DIRTY;
+
+	weistate->written++;
+	weistate->res = index_journal_append(weistate->state,
+					     INDEX_JOURNAL_SET,
+					     ent);
+	if (weistate->res != NSERROR_OK) {
+		/* the entry was not journaled so remains dirty */
+		ent->flags |= ENTRY_FLAGS_DIRTY;
+		/* We stop early if we fail to write an entry */
+		return true;
+	}
+	return false;
 }
 
 /**
- * Write filesystem entries to file.
+ * Write changed filesystem entries to the shard journals.
  *
- * Serialise entry index out to storage.
+ * Appends a record for each changed entry to its shard journal making
+ * the serialisation cost proportional to the number of changed
+ * entries rather than the index size.
  *
  * @param state The backing store state to serialise.
  * @return NSERROR_OK on success or error code on failure.
  */
 static nserror write_entries(struct store_state *state)
 {
-	char *tname = NULL; /* temporary file name for atomic replace */
-	char *fname = NULL; /* target filename */
 	write_entry_iteration_state weistate;
-	nserror ret;
-
-	memset(&weistate, 0, sizeof(weistate));
 
 	if (state->entries_dirty == false) {
 		/* entries have not been updated since last write */
 		return NSERROR_OK;
 	}
 
-	ret = netsurf_mkpath(&tname, NULL, 2, state->path, "t"ENTRIES_FNAME);
-	if (ret != NSERROR_OK) {
-		return ret;
+	weistate.state = state;
+	weistate.written = 0;
+	weistate.res = NSERROR_OK;
+
+	if (hashmap_iterate(state->entries, write_entry_iterator, &weistate)) {
+		/* The iteration ended early, so we failed */
+		return weistate.res;
 	}
 
-	weistate.fd = open(tname, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
-	if (weistate.fd == -1) {
+	state->entries_dirty = false;
+
+	NSLOG(netsurf, INFO, "Journaled %"PRIsizet" entries", weistate.written);
+
+	return NSERROR_OK;
+}
+
+typedef struct {
+	struct store_state *state;
+	unsigned int shard;
+	int fd;
+	unsigned int written;
+	nserror res;
+} compact_iteration_state;
+
+/**
+ * Callback for iterating the entries hashmap during compaction.
+ *
+ * Writes set records for live entries belonging to the shard being
+ * compacted. Runs after write_entries() so no dirty flags remain to
+ * be persisted.
+ */
+static bool
+compact_shard_iterator(void *key, void *value, void *ctx)
+{
+	struct store_entry *ent = value;
+	compact_iteration_state *cistate = ctx;
+
+	if (index_shard_of(ent->url) != cistate->shard) {
+		return false;
+	}
+
+	cistate->written++;
+	cistate->res = index_journal_write(cistate->fd,
+					   INDEX_JOURNAL_SET,
+					   ent);
+	return cistate->res != NSERROR_OK;
+}
+
+/**
+ * Compact a single index shard journal.
+ *
+ * Rewrites the journal with one set record per live entry, dropping
+ * superseded and removed records, and atomically replaces it.
+ *
+ * \param state The backing store state.
+ * \param shard The shard to compact.
+ * \return NSERROR_OK on success or error code on failure.
+ */
+static nserror index_compact_shard(struct store_state *state, unsigned int shard)
+{
+	struct index_shard *shd = &state->shards[shard];
+	compact_iteration_state cistate;
+	char *tname; /* temporary file name for atomic replace */
+	char *fname; /* target filename */
+
+	tname = index_shard_fname(state, shard, true);
+	if (tname == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	cistate.state = state;
+	cistate.shard = shard;
+	cistate.written = 0;
+	cistate.res = NSERROR_OK;
+
+	cistate.fd = open(tname, O_WRONLY | O_CREAT | O_TRUNC,
+			  S_IRUSR | S_IWUSR);
+	if (cistate.fd == -1) {
 		free(tname);
 		return NSERROR_SAVE_FAILED;
 	}
 
-	if (hashmap_iterate(state->entries, write_entry_iterator, &weistate)) {
+	if (hashmap_iterate(state->entries, compact_shard_iterator, &cistate)) {
 		/* The iteration ended early, so we failed */
-		close(weistate.fd);
+		close(cistate.fd);
 		unlink(tname);
 		free(tname);
-		return NSERROR_SAVE_FAILED;
+		return cistate.res;
 	}
 
-	close(weistate.fd);
+	close(cistate.fd);
 
-	ret = netsurf_mkpath(&fname, NULL, 2, state->path, ENTRIES_FNAME);
-	if (ret != NSERROR_OK) {
+	fname = index_shard_fname(state, shard, false);
+	if (fname == NULL) {
 		unlink(tname);
 		free(tname);
-		return ret;
+		return NSERROR_NOMEM;
+	}
+
+	/* the append descriptor refers to the journal being replaced */
+	if (shd->fd != -1) {
+		close(shd->fd);
+		shd->fd = -1;
 	}
 
 	/* remove() call is to handle non-POSIX rename() implementations */
@@ -742,11 +1062,54 @@ static nserror write_entries(struct store_state *state)
 		return NSERROR_SAVE_FAILED;
 	}
 
-	NSLOG(netsurf, INFO, "Wrote out %"PRIsizet" entries", weistate.written);
+	free(tname);
+	free(fname);
+
+	shd->records = cistate.written;
+
+	NSLOG(netsurf, INFO,
+	      "Compacted shard %d to %d entries", shard, cistate.written);
 
 	return NSERROR_OK;
 }
 
+/**
+ * Compact the most overgrown index shard journal, if any.
+ *
+ * At most one shard is compacted per maintenance callback so the
+ * cost of keeping journals bounded is spread over time.
+ *
+ * \param state The backing store state.
+ */
+static void index_compact(struct store_state *state)
+{
+	unsigned int shard;
+	unsigned int worst = INDEX_SHARD_COUNT;
+	unsigned int worst_excess = 0;
+
+	for (shard = 0; shard < INDEX_SHARD_COUNT; shard++) {
+		struct index_shard *shd = &state->shards[shard];
+
+		if (!shd->replayed) {
+			/* compacting writes the in-memory entries, so
+			 * an unreplayed shard must be left alone
+			 */
+			continue;
+		}
+
+		if ((shd->records >= INDEX_COMPACT_MIN) &&
+		    (shd->records > (shd->live * INDEX_COMPACT_RATIO)) &&
+		    ((shd->records - shd->live) > worst_excess)) {
+			worst = shard;
+			worst_excess = shd->records - shd->live;
+		}
+	}
+
+	if (worst < INDEX_SHARD_COUNT) {
+		index_compact_shard(state, worst);
+	}
+}
+
 /**
  * Write block file use map to file.
  *
@@ -885,6 +1248,7 @@ static void control_maintenance(void *s)
 	struct store_state *state = s;
 
 	write_entries(state);
+	index_compact(state);
 	write_blocks(state);
 	set_block_extents(state);
 }
@@ -908,6 +1272,8 @@ get_store_entry(struct store_state *state, nsurl *url, struct store_entry **bse)
 {
 	struct store_entry *ent;
 
+	ensure_shard_entries(state, index_shard_of(url));
+
 	ent = hashmap_lookup(state->entries, url);
 
 	if (ent == NULL) {
@@ -919,9 +1285,7 @@ get_store_entry(struct store_state *state, nsurl *url, struct store_entry **bse)
 	ent->last_used = time(NULL);
 	ent->use_count++;
 
-	state->entries_dirty = true;
-
-	guit->misc->schedule(CONTROL_MAINT_TIME, control_maintenance, state);
+	index_mark_dirty(state, ent);
 
 	return NSERROR_OK;
 }
@@ -967,6 +1331,8 @@ static block_index_t alloc_block(struct store_state *state, int elem_idx)
  * @param elem_idx The index of the entry element to use.
  * @param data The data to store
  * @param datalen The length of data in \a data
+ * @param cdata Compressed copy of \a data to write to storage or NULL.
+ * @param clen The length of data in \a cdata.
  * @param bse Pointer used to return value.
  * @return NSERROR_OK and \a bse updated on success or NSERROR_NOT_FOUND
  *         if no entry corresponds to the url.
@@ -977,6 +1343,8 @@ set_store_entry(struct store_state *state,
 		int elem_idx,
 		uint8_t *data,
 		const size_t datalen,
+		uint8_t *cdata,
+		const size_t clen,
 		struct store_entry **bse)
 {
 	struct store_entry *se;
@@ -985,6 +1353,8 @@ set_store_entry(struct store_state *state,
 
 	NSLOG(netsurf, DEBUG, "url:%s", nsurl_access(url));
 
+	ensure_shard_entries(state, index_shard_of(url));
+
 	/* evict entries as required and ensure there is at least one
 	 * new entry available.
 	 */
@@ -996,6 +1366,9 @@ set_store_entry(struct store_state *state,
 	se = hashmap_lookup(state->entries, url);
 	if (se == NULL) {
 		se = hashmap_insert(state->entries, url);
+		if (se != NULL) {
+			state->shards[index_shard_of(url)].live++;
+		}
 	}
 	if (se == NULL) {
 		return NSERROR_NOMEM;
@@ -1022,10 +1395,19 @@ set_store_entry(struct store_state *state,
 	elem->flags |= ENTRY_ELEM_FLAG_HEAP;
 	elem->data = data;
 	elem->ref = 1;
+	elem->usize = datalen;
+
+	/* compressed copy, if present, is what reaches storage */
+	elem->cdata = cdata;
+	if (cdata != NULL) {
+		elem->flags |= ENTRY_ELEM_FLAG_COMPRESSED;
+	} else {
+		elem->flags &= ~ENTRY_ELEM_FLAG_COMPRESSED;
+	}
 
-	/* account for size of entry element */
+	/* account for size of entry element on disc */
 	state->total_alloc -= elem->size;
-	elem->size = datalen;
+	elem->size = (cdata != NULL) ? clen : datalen;
 	state->total_alloc += elem->size;
 
 	/* if the element will fit in a small block attempt to allocate one */
@@ -1033,9 +1415,8 @@ set_store_entry(struct store_state *state,
 		elem->block = alloc_block(state, elem_idx);
 	}
 
-	/* ensure control maintenance scheduled. */
-	state->entries_dirty = true;
-	guit->misc->schedule(CONTROL_MAINT_TIME, control_maintenance, state);
+	/* ensure the change is journaled and maintenance scheduled. */
+	index_mark_dirty(state, se);
 
 	*bse = se;
 
@@ -1093,7 +1474,7 @@ store_open(struct store_state *state,
 
 
 /**
- * Unlink entries file
+ * Unlink the index shard journals
  *
  * @param state The backing store state.
  * @return NSERROR_OK on success or error code on failure.
@@ -1102,106 +1483,258 @@ static nserror
 unlink_entries(struct store_state *state)
 {
 	char *fname = NULL;
-	nserror ret;
+	unsigned int shard;
 
-	ret = netsurf_mkpath(&fname, NULL, 2, state->path, ENTRIES_FNAME);
-	if (ret != NSERROR_OK) {
-		return ret;
-	}
+	for (shard = 0; shard < INDEX_SHARD_COUNT; shard++) {
+		fname = index_shard_fname(state, shard, false);
+		if (fname == NULL) {
+			return NSERROR_NOMEM;
+		}
+
+		unlink(fname);
 
-	unlink(fname);
+		free(fname);
+	}
 
-	free(fname);
 	return NSERROR_OK;
 }
 
 /**
- * Read description entries into memory.
+ * Replay a single index shard journal into the entries hashmap.
  *
- * @param state The backing store state to put the loaded entries in.
+ * Records are applied in order so later set records supersede earlier
+ * ones and remove records drop the entry. A short read is treated as
+ * a truncated tail and ends the replay of the shard; records already
+ * applied remain valid.
+ *
+ * @param state The backing store state to replay the journal into.
+ * @param shard The shard to replay.
  * @return NSERROR_OK on success or error code on faliure.
  */
 static nserror
-read_entries(struct store_state *state)
+read_entries_shard(struct store_state *state, unsigned int shard)
 {
-	char *fname = NULL;
+	char *fname;
 	char *url;
 	nsurl *nsurl;
 	nserror ret;
-	size_t read_entries = 0;
 	struct store_entry *ent;
+	uint8_t op;
+	uint32_t urllen;
 	int fd;
 
-	ret = netsurf_mkpath(&fname, NULL, 2, state->path, ENTRIES_FNAME);
+	fname = index_shard_fname(state, shard, false);
+	if (fname == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	fd = open(fname, O_RDONLY);
+	free(fname);
+	if (fd == -1) {
+		/* a missing shard journal is simply empty */
+		return NSERROR_OK;
+	}
+
+	while (read(fd, &op, sizeof(op)) == sizeof(op)) {
+		if ((op != INDEX_JOURNAL_SET) && (op != INDEX_JOURNAL_REMOVE)) {
+			NSLOG(netsurf, WARNING,
+			      "Unknown journal operation %d in shard %d",
+			      op, shard);
+			break;
+		}
+		if (read(fd, &urllen, sizeof(urllen)) != sizeof(urllen)) {
+			break;
+		}
+		url = calloc(1, urllen+1);
+		if (url == NULL) {
+			close(fd);
+			return NSERROR_NOMEM;
+		}
+		if (read(fd, url, urllen) != (ssize_t)urllen) {
+			free(url);
+			break;
+		}
+		ret = nsurl_create(url, &nsurl);
+		free(url);
+		if (ret != NSERROR_OK) {
+			close(fd);
+			return ret;
+		}
+
+		if (op == INDEX_JOURNAL_REMOVE) {
+			hashmap_remove(state->entries, nsurl);
+			nsurl_unref(nsurl);
+			state->shards[shard].records++;
+			continue;
+		}
+
+		/* We have to be careful here about nsurl refs */
+		ent = hashmap_insert(state->entries, nsurl);
+		if (ent == NULL) {
+			nsurl_unref(nsurl);
+			close(fd);
+			return NSERROR_NOMEM;
+		}
+		/* At this point, ent actually owns a ref of nsurl */
+		if (read(fd, ent, sizeof(*ent)) != sizeof(*ent)) {
+			/* The read failed, so reset the ptr and drop
+			 * the truncated entry.
+			 */
+			ent->url = nsurl; /* It already had a ref */
+			hashmap_remove(state->entries, nsurl);
+			nsurl_unref(nsurl);
+			break;
+		}
+		ent->url = nsurl; /* It already owns a ref */
+		nsurl_unref(nsurl);
+		NSLOG(netsurf, DEBUG, "Successfully read entry for %s",
+		      nsurl_access(ent->url));
+		state->shards[shard].records++;
+	}
+	close(fd);
+
+	return NSERROR_OK;
+}
+
+typedef struct {
+	struct store_state *state;
+	unsigned int shard;
+	size_t entries;
+} read_entries_iteration_state;
+
+/**
+ * Callback for iterating the entries hashmap after journal replay.
+ *
+ * Resets transient allocation state which is meaningless from a
+ * previous run and accounts the storage and shard sizes. Only the
+ * entries belonging to the shard just replayed are touched.
+ */
+static bool
+read_entries_iterator(void *key, void *value, void *ctx)
+{
+	struct store_entry *ent = value;
+	read_entries_iteration_state *restate = ctx;
+	struct store_state *state = restate->state;
+
+	if (index_shard_of(ent->url) != restate->shard) {
+		return false;
+	}
+
+	restate->entries++;
+
+	/* Note the size allocation */
+	state->total_alloc += ent->elem[ENTRY_ELEM_DATA].size;
+	state->total_alloc += ent->elem[ENTRY_ELEM_META].size;
+
+	state->shards[index_shard_of(ent->url)].live++;
+
+	/* And ensure we don't pretend to have this in memory yet */
+	ent->flags &= ~ENTRY_FLAGS_DIRTY;
+	ent->elem[ENTRY_ELEM_DATA].flags &= ~(ENTRY_ELEM_FLAG_HEAP | ENTRY_ELEM_FLAG_MMAP | ENTRY_ELEM_FLAG_DIRTY);
+	ent->elem[ENTRY_ELEM_META].flags &= ~(ENTRY_ELEM_FLAG_HEAP | ENTRY_ELEM_FLAG_MMAP | ENTRY_ELEM_FLAG_DIRTY);
+	/* pointers in the file are from a previous run */
+	ent->elem[ENTRY_ELEM_DATA].cdata = NULL;
+	ent->elem[ENTRY_ELEM_META].cdata = NULL;
+
+	return false;
+}
+
+/**
+ * Ensure an index shard has been replayed into the entries map.
+ *
+ * Shard journals are not read at initialisation; each is replayed on
+ * first access to a url hashing to it, or by the background replay
+ * callback, whichever comes first.
+ *
+ * @param state The backing store state to replay the shard into.
+ * @param shard The shard to replay.
+ * @return NSERROR_OK on success or error code on faliure.
+ */
+static nserror
+ensure_shard_entries(struct store_state *state, unsigned int shard)
+{
+	read_entries_iteration_state restate;
+	nserror ret;
+
+	if (state->shards[shard].replayed) {
+		return NSERROR_OK;
+	}
+	state->shards[shard].replayed = true;
+
+	ret = read_entries_shard(state, shard);
 	if (ret != NSERROR_OK) {
 		return ret;
 	}
 
+	/* account for the shard's entries that survived replay */
+	restate.state = state;
+	restate.shard = shard;
+	restate.entries = 0;
+	hashmap_iterate(state->entries, read_entries_iterator, &restate);
+
+	NSLOG(netsurf, DEBUG, "Read %"PRIsizet" entries for shard %u",
+	      restate.entries, shard);
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Scheduler callback replaying index shards in the background.
+ *
+ * Replays one shard not already pulled in by a lookup, then
+ * reschedules itself until every shard has been replayed, so loading
+ * the index is spread over time instead of delaying initialisation.
+ *
+ * @param s The backing store state.
+ */
+static void replay_entries_cb(void *s)
+{
+	struct store_state *state = s;
+	unsigned int shard = 0;
+
+	while ((shard < INDEX_SHARD_COUNT) &&
+	       (state->shards[shard].replayed)) {
+		shard++;
+	}
+
+	if (shard == INDEX_SHARD_COUNT) {
+		/* every shard has been replayed */
+		return;
+	}
+
+	ensure_shard_entries(state, shard);
+
+	guit->misc->schedule(ENTRIES_REPLAY_TIME, replay_entries_cb, state);
+}
+
+
+/**
+ * Read description entries into memory.
+ *
+ * Creates the entries map and schedules the shard journal replays;
+ * the journals themselves are read lazily.
+ *
+ * @param state The backing store state to put the loaded entries in.
+ * @return NSERROR_OK on success or error code on faliure.
+ */
+static nserror
+read_entries(struct store_state *state)
+{
+	unsigned int shard;
+
 	state->entries = hashmap_create(&entries_hashmap_parameters);
 	if (state->entries == NULL) {
-		free(fname);
 		return NSERROR_NOMEM;
 	}
 
-	fd = open(fname, O_RDWR);
-	if (fd != -1) {
-		uint32_t urllen;
-		while (read(fd, &urllen, sizeof(urllen)) == sizeof(urllen)) {
-			url = calloc(1, urllen+1);
-			if (url == NULL) {
-				close(fd);
-				free(fname);
-				return NSERROR_NOMEM;
-			}
-			if (read(fd, url, urllen) != (ssize_t)urllen) {
-				free(url);
-				close(fd);
-				free(fname);
-				return NSERROR_INIT_FAILED;
-			}
-			ret = nsurl_create(url, &nsurl);
-			if (ret != NSERROR_OK) {
-				free(url);
-				close(fd);
-				free(fname);
-				return ret;
-			}
-			free(url);
-			/* We have to be careful here about nsurl refs */
-			ent = hashmap_insert(state->entries, nsurl);
-			if (ent == NULL) {
-				nsurl_unref(nsurl);
-				close(fd);
-				free(fname);
-				return NSERROR_NOMEM;
-			}
-			/* At this point, ent actually owns a ref of nsurl */
-			if (read(fd, ent, sizeof(*ent)) != sizeof(*ent)) {
-				/* The read failed, so reset the ptr */
-				ent->url = nsurl; /* It already had a ref */
-				nsurl_unref(nsurl);
-				close(fd);
-				free(fname);
-				return NSERROR_INIT_FAILED;
-			}
-			ent->url = nsurl; /* It already owns a ref */
-			nsurl_unref(nsurl);
-			NSLOG(netsurf, DEBUG, "Successfully read entry for %s", nsurl_access(ent->url));
-			read_entries++;
-			/* Note the size allocation */
-			state->total_alloc += ent->elem[ENTRY_ELEM_DATA].size;
-			state->total_alloc += ent->elem[ENTRY_ELEM_META].size;
-			/* And ensure we don't pretend to have this in memory yet */
-			ent->elem[ENTRY_ELEM_DATA].flags &= ~(ENTRY_ELEM_FLAG_HEAP | ENTRY_ELEM_FLAG_MMAP);
-			ent->elem[ENTRY_ELEM_META].flags &= ~(ENTRY_ELEM_FLAG_HEAP | ENTRY_ELEM_FLAG_MMAP);
-
-		}
-		close(fd);
+	for (shard = 0; shard < INDEX_SHARD_COUNT; shard++) {
+		state->shards[shard].fd = -1;
+		state->shards[shard].replayed = false;
 	}
 
-	NSLOG(netsurf, INFO, "Read %"PRIsizet" entries from cache", read_entries);
+	guit->misc->schedule(ENTRIES_REPLAY_TIME, replay_entries_cb, state);
 
-	free(fname);
 	return NSERROR_OK;
 }
 
@@ -1529,10 +2062,25 @@ finalise(void)
 	unsigned int op_count;
 
 	if (storestate != NULL) {
+		guit->misc->schedule(-1, defer_write_run, storestate);
 		guit->misc->schedule(-1, control_maintenance, storestate);
+		guit->misc->schedule(-1, replay_entries_cb, storestate);
+
+		/* flush any writes still queued */
+		while (storestate->defer_count > 0) {
+			defer_write_pop(storestate);
+		}
+
 		write_entries(storestate);
 		write_blocks(storestate);
 
+		/* ensure all shard journals are closed */
+		for (bf = 0; bf < INDEX_SHARD_COUNT; bf++) {
+			if (storestate->shards[bf].fd != -1) {
+				close(storestate->shards[bf].fd);
+			}
+		}
+
 		/* ensure all block files are closed */
 		for (bf = 0; bf < BLOCK_FILE_COUNT; bf++) {
 			if (storestate->blocks[ENTRY_ELEM_DATA][bf].fd != -1) {
@@ -1582,6 +2130,7 @@ static nserror store_write_block(struct store_state *state,
 	block_index_t bf = (bse->elem[elem_idx].block >> BLOCK_ENTRY_COUNT) &
 		((1 << BLOCK_FILE_COUNT) - 1); /* block file block resides in */
 	block_index_t bi = bse->elem[elem_idx].block & ((1U << BLOCK_ENTRY_COUNT) -1); /* block index in file */
+	uint8_t *wdata;
 	ssize_t wr;
 	off_t offst;
 
@@ -1600,8 +2149,15 @@ static nserror store_write_block(struct store_state *state,
 
 	offst = (unsigned int)bi << log2_block_size[elem_idx];
 
+	/* write the compressed copy if one was produced */
+	if (bse->elem[elem_idx].cdata != NULL) {
+		wdata = bse->elem[elem_idx].cdata;
+	} else {
+		wdata = bse->elem[elem_idx].data;
+	}
+
 	wr = nsu_pwrite(state->blocks[elem_idx][bf].fd,
-			bse->elem[elem_idx].data,
+			wdata,
 			bse->elem[elem_idx].size,
 			offst);
 	if (wr != (ssize_t)bse->elem[elem_idx].size) {
@@ -1609,7 +2165,7 @@ static nserror store_write_block(struct store_state *state,
 		      "Write failed %"PRIssizet" of %"PRId32" bytes from %p at %"PRIsizet" block %"PRIu16" errno %d",
 		      wr,
 		      bse->elem[elem_idx].size,
-		      bse->elem[elem_idx].data,
+		      wdata,
 		      (size_t)offst,
 		      bse->elem[elem_idx].block,
 		      errno);
@@ -1618,7 +2174,7 @@ static nserror store_write_block(struct store_state *state,
 
 	NSLOG(netsurf, INFO,
 	      "Wrote %"PRIssizet" bytes from %p at %"PRIsizet" block %d", wr,
-	      bse->elem[elem_idx].data, (size_t)offst,
+	      wdata, (size_t)offst,
 	      bse->elem[elem_idx].block);
 
 	return NSERROR_OK;
@@ -1636,6 +2192,7 @@ static nserror store_write_file(struct store_state *state,
 			 struct store_entry *bse,
 			 int elem_idx)
 {
+	uint8_t *wdata;
 	ssize_t wr;
 	int fd;
 	int err;
@@ -1647,7 +2204,14 @@ static nserror store_write_file(struct store_state *state,
 		return NSERROR_SAVE_FAILED;
 	}
 
-	wr = write(fd, bse->elem[elem_idx].data, bse->elem[elem_idx].size);
+	/* write the compressed copy if one was produced */
+	if (bse->elem[elem_idx].cdata != NULL) {
+		wdata = bse->elem[elem_idx].cdata;
+	} else {
+		wdata = bse->elem[elem_idx].data;
+	}
+
+	wr = write(fd, wdata, bse->elem[elem_idx].size);
 	err = errno; /* close can change errno */
 
 	close(fd);
@@ -1656,7 +2220,7 @@ static nserror store_write_file(struct store_state *state,
 		      "Write failed %"PRIssizet" of %"PRId32" bytes from %p errno %d",
 		      wr,
 		      bse->elem[elem_idx].size,
-		      bse->elem[elem_idx].data,
+		      wdata,
 		      err);
 
 		/** @todo Delete the file? */
@@ -1664,7 +2228,7 @@ static nserror store_write_file(struct store_state *state,
 	}
 
 	NSLOG(netsurf, VERBOSE, "Wrote %"PRIssizet" bytes from %p", wr,
-	      bse->elem[elem_idx].data);
+	      wdata);
 
 	return NSERROR_OK;
 }
@@ -1689,6 +2253,9 @@ store(nsurl *url,
 	nserror ret;
 	struct store_entry *bse;
 	int elem_idx;
+	uint8_t *cdata;
+	uLongf clen;
+	unsigned int level;
 
 	/* check backing store is initialised */
 	if (storestate == NULL) {
@@ -1702,22 +2269,42 @@ store(nsurl *url,
 		elem_idx = ENTRY_ELEM_DATA;
 	}
 
+	/* compress the data for storage if enabled and worthwhile */
+	cdata = NULL;
+	clen = 0;
+	level = nsoption_uint(disc_cache_compression);
+	if ((level > 0) && (datalen >= COMPRESS_MIN_SIZE)) {
+		uLongf bound = compressBound(datalen);
+
+		if (level > 9) {
+			level = 9;
+		}
+
+		cdata = malloc(bound);
+		if (cdata != NULL) {
+			if ((compress2(cdata, &bound, data, datalen,
+				       level) != Z_OK) ||
+			    (bound >= datalen)) {
+				/* incompressible; store as-is */
+				free(cdata);
+				cdata = NULL;
+			} else {
+				clen = bound;
+			}
+		}
+	}
+
 	/* set the store entry up */
-	ret = set_store_entry(storestate, url, elem_idx, data, datalen, &bse);
+	ret = set_store_entry(storestate, url, elem_idx, data, datalen,
+			      cdata, clen, &bse);
 	if (ret != NSERROR_OK) {
 		NSLOG(netsurf, ERROR, "store entry setting failed");
+		free(cdata);
 		return ret;
 	}
 
-	if (bse->elem[elem_idx].block != 0) {
-		/* small block storage */
-		ret = store_write_block(storestate, bse, elem_idx);
-	} else {
-		/* separate file in backing store */
-		ret = store_write_file(storestate, bse, elem_idx);
-	}
-
-	return ret;
+	/* queue the object so the write happens off the critical path */
+	return defer_write_queue(storestate, bse, elem_idx);
 }
 
 /**
@@ -1732,7 +2319,167 @@ static nserror entry_release_alloc(struct store_entry_element *elem)
 			free(elem->data);
 			elem->flags &= ~ENTRY_ELEM_FLAG_HEAP;
 		}
+#ifdef HAVE_MMAP
+	} else if ((elem->flags & ENTRY_ELEM_FLAG_MMAP) != 0) {
+		elem->ref--;
+		if (elem->ref == 0) {
+			NSLOG(netsurf, DEEPDEBUG, "unmapping %p", elem->data);
+			munmap(elem->data, elem->size);
+			elem->flags &= ~ENTRY_ELEM_FLAG_MMAP;
+		}
+#endif
+	}
+	return NSERROR_OK;
+}
+
+
+/**
+ * Write a single queued entry element to storage.
+ *
+ * Performs the physical write for an element previously queued with
+ * defer_write_queue() and drops the queue's reference on the element
+ * allocation. The write is skipped for entries invalidated while they
+ * waited in the queue.
+ *
+ * \param state The backing store state to use.
+ * \param bse The entry to write.
+ * \param elem_idx The element index within the entry.
+ */
+static void
+defer_write_entry(struct store_state *state,
+		  struct store_entry *bse,
+		  int elem_idx)
+{
+	struct store_entry_element *elem = &bse->elem[elem_idx];
+	nserror ret = NSERROR_OK;
+
+	elem->flags &= ~ENTRY_ELEM_FLAG_DIRTY;
+
+	if ((bse->flags & ENTRY_FLAGS_INVALID) == 0) {
+		if (elem->block != 0) {
+			/* small block storage */
+			ret = store_write_block(state, bse, elem_idx);
+		} else {
+			/* separate file in backing store */
+			ret = store_write_file(state, bse, elem_idx);
+		}
+		if (ret != NSERROR_OK) {
+			/* the entry cannot be used without its data */
+			invalidate_entry(state, bse);
+		}
+	}
+
+	/* the compressed copy is only needed for the write */
+	if (elem->cdata != NULL) {
+		free(elem->cdata);
+		elem->cdata = NULL;
+	}
+
+	/* drop the reference held by the queue */
+	entry_release_alloc(elem);
+
+	/* if the entry was invalidated while queued and the queue held
+	 * the last allocation reference complete the invalidation now.
+	 */
+	if ((bse->flags & ENTRY_FLAGS_INVALID) != 0) {
+		invalidate_entry(state, bse);
+	}
+}
+
+/**
+ * Remove the oldest queued write from the queue and perform it.
+ *
+ * \param state The backing store state to use.
+ */
+static void defer_write_pop(struct store_state *state)
+{
+	struct store_entry *bse = state->defer_queue[state->defer_head];
+	int elem_idx = state->defer_elem[state->defer_head];
+
+	state->defer_head = (state->defer_head + 1) % DEFER_WRITE_QUEUE_SIZE;
+	state->defer_count--;
+
+	defer_write_entry(state, bse, elem_idx);
+}
+
+/**
+ * Scheduler callback draining the deferred writeout queue.
+ *
+ * Queued writes are performed until the queue empties or the time
+ * budget for a single callback is exhausted, which keeps writeout to
+ * slow media from stalling the browser schedule in one large lump.
+ *
+ * \param s The backing store state.
+ */
+static void defer_write_run(void *s)
+{
+	struct store_state *state = s;
+	uint64_t startms = 0;
+	uint64_t nowms;
+
+	nsu_getmonotonic_ms(&startms);
+
+	while (state->defer_count > 0) {
+		defer_write_pop(state);
+
+		nsu_getmonotonic_ms(&nowms);
+		if ((nowms - startms) >= DEFER_WRITE_BUDGET_MS) {
+			break;
+		}
+	}
+
+	if (state->defer_count > 0) {
+		/* out of budget; finish the remainder in a later slice */
+		guit->misc->schedule(DEFER_WRITE_TIME, defer_write_run,
+				     state);
+	}
+}
+
+/**
+ * Queue an entry element for deferred writeout.
+ *
+ * The queue takes its own reference on the element allocation so the
+ * data remains valid until the write completes even if the owner
+ * releases it in the meantime. When the queue is full the oldest
+ * pending write is performed immediately to make room.
+ *
+ * \param state The backing store state to use.
+ * \param bse The entry to queue.
+ * \param elem_idx The element index within the entry.
+ * \return NSERROR_OK on success or error code on failure.
+ */
+static nserror
+defer_write_queue(struct store_state *state,
+		  struct store_entry *bse,
+		  int elem_idx)
+{
+	struct store_entry_element *elem = &bse->elem[elem_idx];
+	unsigned int slot;
+
+	if ((elem->flags & ENTRY_ELEM_FLAG_DIRTY) != 0) {
+		/* already queued */
+		return NSERROR_OK;
+	}
+
+	if (state->defer_count == DEFER_WRITE_QUEUE_SIZE) {
+		/* queue full; bounded by writing the oldest entry now */
+		defer_write_pop(state);
+	}
+
+	elem->flags |= ENTRY_ELEM_FLAG_DIRTY;
+	elem->ref++;
+
+	slot = (state->defer_head + state->defer_count) %
+		DEFER_WRITE_QUEUE_SIZE;
+	state->defer_queue[slot] = bse;
+	state->defer_elem[slot] = elem_idx;
+
+	state->defer_count++;
+	if (state->defer_count == 1) {
+		guit->misc->schedule(DEFER_WRITE_TIME, defer_write_run,
+				     state);
 	}
+
 	return NSERROR_OK;
 }
 
@@ -1842,6 +2589,89 @@ static nserror store_read_file(struct store_state *state,
 	return ret;
 }
 
+#ifdef HAVE_MMAP
+/**
+ * Map an element of an entry stored as an individual file.
+ *
+ * Pages the element in on demand instead of copying it into a fresh
+ * heap allocation, which avoids the read latency and transient RSS
+ * spike of large objects such as images.
+ *
+ * \param state The backing store state to use.
+ * \param bse The entry to map.
+ * \param elem_idx The element index within the entry.
+ * \return NSERROR_OK on success or error code.
+ */
+static nserror store_map_file(struct store_state *state,
+			 struct store_entry *bse,
+			 int elem_idx)
+{
+	struct store_entry_element *elem = &bse->elem[elem_idx];
+	void *map;
+	int fd;
+
+	fd = store_open(state, nsurl_hash(bse->url), elem_idx, O_RDONLY);
+	if (fd < 0) {
+		NSLOG(netsurf, ERROR, "Open failed %d errno %d", fd, errno);
+		return NSERROR_NOT_FOUND;
+	}
+
+	map = mmap(NULL, elem->size, PROT_READ, MAP_SHARED, fd, 0);
+
+	/* the mapping persists over the close */
+	close(fd);
+
+	if (map == MAP_FAILED) {
+		NSLOG(netsurf, ERROR, "mapping failed errno %d", errno);
+		return NSERROR_NOMEM;
+	}
+
+	elem->data = map;
+	elem->flags |= ENTRY_ELEM_FLAG_MMAP;
+	elem->ref = 1;
+
+	NSLOG(netsurf, DEEPDEBUG, "Mapped %"PRId32" bytes at %p",
+	      elem->size, elem->data);
+
+	return NSERROR_OK;
+}
+#endif
+
+/**
+ * Expand a compressed element read from storage to its original form.
+ *
+ * The element's allocation holds the compressed on-disc representation
+ * on entry; on success it is replaced with the inflated data.
+ *
+ * \param elem The entry element to inflate.
+ * \return NSERROR_OK on success or error code.
+ */
+static nserror entry_inflate(struct store_entry_element *elem)
+{
+	uint8_t *udata;
+	uLongf ulen = elem->usize;
+
+	udata = malloc(elem->usize);
+	if (udata == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	if ((uncompress(udata, &ulen, elem->data, elem->size) != Z_OK) ||
+	    (ulen != elem->usize)) {
+		NSLOG(netsurf, ERROR,
+		      "Failed inflating %"PRId32" bytes to %"PRId32,
+		      elem->size,
+		      elem->usize);
+		free(udata);
+		return NSERROR_INVALID;
+	}
+
+	free(elem->data);
+	elem->data = udata;
+
+	return NSERROR_OK;
+}
+
 /**
  * Retrieve an object from the backing store.
  *
@@ -1888,7 +2718,7 @@ fetch(nsurl *url,
 	elem = &bse->elem[elem_idx];
 
 	/* if an allocation already exists return it */
-	if ((elem->flags & ENTRY_ELEM_FLAG_HEAP) != 0) {
+	if ((elem->flags & (ENTRY_ELEM_FLAG_HEAP | ENTRY_ELEM_FLAG_MMAP)) != 0) {
 		/* use the existing allocation and bump the ref count. */
 		elem->ref++;
 
@@ -1896,6 +2726,15 @@ fetch(nsurl *url,
 		      "Using existing entry (%p) allocation %p refs:%d", bse,
 		      elem->data, elem->ref);
 
+#ifdef HAVE_MMAP
+	} else if ((elem->block == 0) &&
+		   ((elem->flags & ENTRY_ELEM_FLAG_COMPRESSED) == 0)) {
+		/* uncompressed individual files are mapped rather than
+		 * copied onto the heap; compressed and small block
+		 * elements must still be read and expanded.
+		 */
+		ret = store_map_file(storestate, bse, elem_idx);
+#endif
 	} else {
 		/* allocate from the heap */
 		elem->data = malloc(elem->size);
@@ -1917,6 +2756,12 @@ fetch(nsurl *url,
 		} else {
 			ret = store_read_file(storestate, bse, elem_idx);
 		}
+
+		/* expand compressed entries to their original form */
+		if ((ret == NSERROR_OK) &&
+		    ((elem->flags & ENTRY_ELEM_FLAG_COMPRESSED) != 0)) {
+			ret = entry_inflate(elem);
+		}
 	}
 
 	/* free the allocation if there is a read error */
@@ -1924,10 +2769,10 @@ fetch(nsurl *url,
 		entry_release_alloc(elem);
 	} else {
 		/* update stats and setup return pointers */
-		storestate->hit_size += elem->size;
+		storestate->hit_size += elem->usize;
 
 		*data_out = elem->data;
-		*datalen_out = elem->size;
+		*datalen_out = elem->usize;
 	}
 
 	return ret;
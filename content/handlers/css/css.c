@@ -20,6 +20,7 @@
 #include <assert.h>
 #include <libwapcaplet/libwapcaplet.h>
 #include <dom/dom.h>
+#include <nsutils/time.h>
 
 #include "utils/errors.h"
 #include "utils/corestrings.h"
@@ -31,7 +32,9 @@
 #include "content/content_factory.h"
 #include "content/fetch.h"
 #include "content/hlcache.h"
+#include "netsurf/misc.h"
 #include "desktop/system_colour.h"
+#include "desktop/gui_internal.h"
 
 #include "css/css.h"
 #include "css/hints.h"
@@ -65,6 +68,9 @@ struct content_css_data
 	uint32_t next_to_register;	/**< Index of next import to register */
 	nscss_done_callback done;	/**< Completion callback */
 	void *pw;			/**< Client data */
+	uint32_t checksum;		/**< Checksum of the source bytes */
+	size_t source_length;		/**< Number of source bytes */
+	bool parse_complete;		/**< Sheet fully parsed and usable */
 };
 
 /**
@@ -75,6 +81,10 @@ typedef struct nscss_content
 	struct content base;		/**< Underlying content object */
 
 	struct content_css_data data;	/**< CSS data */
+
+	/** Number of source bytes fed to the parser so far, when the
+	 * sheet is large enough to be parsed in scheduler slices. */
+	size_t convert_offset;
 } nscss_content;
 
 /**
@@ -97,7 +107,9 @@ static nserror nscss_create_css_data(struct content_css_data *c,
 		nscss_done_callback done, void *pw);
 static css_error nscss_process_css_data(struct content_css_data *c, const char *data,
 		unsigned int size);
-static css_error nscss_convert_css_data(struct content_css_data *c);
+static css_error nscss_convert_css_data(struct content_css_data *c,
+		const uint8_t *data, size_t size);
+static void nscss_convert_slice(void *p);
 static void nscss_destroy_css_data(struct content_css_data *c);
 
 static void nscss_content_done(struct content_css_data *css, void *pw);
@@ -115,6 +127,185 @@ static css_error nscss_register_import(struct content_css_data *c,
 static css_stylesheet *blank_import;
 
 
+/** Number of parsed stylesheets retained after their content is gone */
+#define SHEET_CACHE_ENTRIES 4
+
+/** Source bytes fed to the parser per append; sheets no larger than
+ * this are parsed synchronously during conversion. */
+#define PARSE_CHUNK_SIZE (32 * 1024)
+
+/** Maximum time one parse slice may occupy the event loop, in ms */
+#define PARSE_SLICE_MS 20
+
+/**
+ * A parsed stylesheet retained for reuse.
+ *
+ * Navigating within a site fetches the same sheets over and over; the
+ * llcache keeps the bytes but the parsed representation dies with the
+ * content object. Fully converted sheets without imports are parked
+ * here on destruction and handed back, without a re-parse, to the next
+ * content whose source URL, charset, quirks mode and source bytes all
+ * match. Sheets with imports are not retained because the imported
+ * stylesheet objects they refer to die with their own contents.
+ */
+struct nscss_cached_sheet {
+	char *url;		/**< Sheet's base URL, or NULL if unused */
+	char *charset;		/**< Sheet's charset, or NULL */
+	bool quirks;		/**< Whether quirks were allowed */
+	uint32_t checksum;	/**< Checksum of the source bytes */
+	size_t length;		/**< Number of source bytes */
+	css_stylesheet *sheet;	/**< The parsed stylesheet */
+};
+
+static struct nscss_cached_sheet sheet_cache[SHEET_CACHE_ENTRIES];
+static unsigned int sheet_cache_next;
+
+
+/**
+ * Compute a checksum over stylesheet source bytes.
+ *
+ * \param data  Source bytes
+ * \param len   Number of bytes
+ * \return 32bit FNV-1a fold of the data
+ */
+static uint32_t nscss_source_checksum(const uint8_t *data, size_t len)
+{
+	uint32_t hash = 0x811c9dc5;
+
+	while (len-- > 0) {
+		hash ^= *data++;
+		hash *= 0x01000193;
+	}
+
+	return hash;
+}
+
+
+/**
+ * Take a retained stylesheet matching the given key, if there is one.
+ *
+ * The URL, charset and quirks mode components of the key are taken
+ * from \a tmpl, the freshly created, empty sheet the caller would
+ * otherwise parse into, since it was created with exactly the
+ * parameters a match must share.
+ *
+ * \param tmpl      Empty stylesheet carrying the key parameters
+ * \param charset   Charset the sheet was created with, or NULL
+ * \param checksum  Checksum of the source bytes
+ * \param length    Number of source bytes
+ * \return a parsed stylesheet now owned by the caller, or NULL
+ */
+static css_stylesheet *nscss_cache_take(css_stylesheet *tmpl,
+		const char *charset, uint32_t checksum, size_t length)
+{
+	const char *url;
+	bool quirks;
+	unsigned int i;
+
+	if (css_stylesheet_get_url(tmpl, &url) != CSS_OK)
+		return NULL;
+
+	if (css_stylesheet_quirks_allowed(tmpl, &quirks) != CSS_OK)
+		return NULL;
+
+	for (i = 0; i < SHEET_CACHE_ENTRIES; i++) {
+		struct nscss_cached_sheet *entry = &sheet_cache[i];
+		css_stylesheet *sheet;
+
+		if (entry->sheet == NULL ||
+				entry->checksum != checksum ||
+				entry->length != length ||
+				entry->quirks != quirks)
+			continue;
+
+		if (strcmp(entry->url, url) != 0)
+			continue;
+
+		if ((entry->charset == NULL) != (charset == NULL))
+			continue;
+
+		if (charset != NULL &&
+				strcmp(entry->charset, charset) != 0)
+			continue;
+
+		sheet = entry->sheet;
+		entry->sheet = NULL;
+
+		free(entry->url);
+		entry->url = NULL;
+		free(entry->charset);
+		entry->charset = NULL;
+
+		return sheet;
+	}
+
+	return NULL;
+}
+
+
+/**
+ * Retain a parsed stylesheet for later reuse.
+ *
+ * Takes ownership of \a sheet; if it cannot be retained it is
+ * destroyed. The entry replaced is simply the oldest.
+ *
+ * \param sheet     Fully converted stylesheet with no imports
+ * \param charset   Charset the sheet was created with, or NULL
+ * \param checksum  Checksum of the source bytes
+ * \param length    Number of source bytes
+ */
+static void nscss_cache_put(css_stylesheet *sheet, const char *charset,
+		uint32_t checksum, size_t length)
+{
+	struct nscss_cached_sheet *entry;
+	const char *url;
+	bool quirks;
+
+	if (css_stylesheet_get_url(sheet, &url) != CSS_OK ||
+			css_stylesheet_quirks_allowed(sheet,
+					&quirks) != CSS_OK) {
+		css_stylesheet_destroy(sheet);
+		return;
+	}
+
+	entry = &sheet_cache[sheet_cache_next];
+
+	if (entry->sheet != NULL) {
+		css_stylesheet_destroy(entry->sheet);
+		entry->sheet = NULL;
+	}
+	free(entry->url);
+	entry->url = NULL;
+	free(entry->charset);
+	entry->charset = NULL;
+
+	entry->url = strdup(url);
+	if (entry->url == NULL) {
+		css_stylesheet_destroy(sheet);
+		return;
+	}
+
+	if (charset != NULL) {
+		entry->charset = strdup(charset);
+		if (entry->charset == NULL) {
+			free(entry->url);
+			entry->url = NULL;
+			css_stylesheet_destroy(sheet);
+			return;
+		}
+	} else {
+		entry->charset = NULL;
+	}
+
+	entry->quirks = quirks;
+	entry->checksum = checksum;
+	entry->length = length;
+	entry->sheet = sheet;
+
+	sheet_cache_next = (sheet_cache_next + 1) % SHEET_CACHE_ENTRIES;
+}
+
+
 /**
  * Initialise a CSS content
  *
@@ -212,6 +403,9 @@ static nserror nscss_create_css_data(struct content_css_data *c,
 	c->next_to_register = (uint32_t) -1;
 	c->import_count = 0;
 	c->imports = NULL;
+	c->checksum = 0;
+	c->source_length = 0;
+	c->parse_complete = false;
 	if (charset != NULL)
 		c->charset = strdup(charset);
 	else
@@ -274,8 +468,10 @@ nscss_process_data(struct content *c, const char *data, unsigned int size)
 static css_error nscss_process_css_data(struct content_css_data *c,
 		const char *data, unsigned int size)
 {
-	return css_stylesheet_append_data(c->sheet,
-			(const uint8_t *) data, size);
+	/* Parsing is deferred until the fetch completes, so that a
+	 * retained sheet with identical source can be adopted in place
+	 * of a re-parse. The source is kept by the llcache meanwhile. */
+	return CSS_NEEDDATA;
 }
 
 /**
@@ -287,9 +483,40 @@ static css_error nscss_process_css_data(struct content_css_data *c,
 bool nscss_convert(struct content *c)
 {
 	nscss_content *css = (nscss_content *) c;
+	css_stylesheet *adopted;
+	const uint8_t *data;
+	size_t size;
 	css_error error;
 
-	error = nscss_convert_css_data(&css->data);
+	data = content__get_source_data(c, &size);
+
+	css->data.checksum = nscss_source_checksum(data, size);
+	css->data.source_length = size;
+
+	/* Adopt a previously parsed sheet with identical source,
+	 * if one is retained */
+	adopted = nscss_cache_take(css->data.sheet, css->data.charset,
+			css->data.checksum, size);
+	if (adopted != NULL) {
+		css_stylesheet_destroy(css->data.sheet);
+		css->data.sheet = adopted;
+		css->data.parse_complete = true;
+
+		css->data.done(&css->data, css->data.pw);
+
+		return true;
+	}
+
+	if (size > PARSE_CHUNK_SIZE) {
+		/* Parse large sheets in scheduler slices so the event
+		 * loop keeps running; completion is signalled through
+		 * the done callback, as for pending imports. */
+		css->convert_offset = 0;
+		guit->misc->schedule(0, nscss_convert_slice, css);
+		return true;
+	}
+
+	error = nscss_convert_css_data(&css->data, data, size);
 	if (error != CSS_OK) {
 		content_broadcast_error(c, NSERROR_CSS, NULL);
 		return false;
@@ -299,12 +526,15 @@ bool nscss_convert(struct content *c)
 }
 
 /**
- * Convert CSS data ready for use
+ * Complete the parse of a CSS data's stylesheet
  *
- * \param c  CSS data to convert
+ * Called once all source bytes have been appended; finishes the parse
+ * and begins fetching any imported sheets.
+ *
+ * \param c  CSS data to complete
  * \return CSS error
  */
-static css_error nscss_convert_css_data(struct content_css_data *c)
+static css_error nscss_convert_css_done(struct content_css_data *c)
 {
 	css_error error;
 
@@ -321,6 +551,7 @@ static css_error nscss_convert_css_data(struct content_css_data *c)
 		error = nscss_register_imports(c);
 	} else if (error == CSS_OK) {
 		/* No imports, and no errors, so complete conversion */
+		c->parse_complete = true;
 		c->done(c, c->pw);
 	} else {
 		const char *url;
@@ -337,6 +568,87 @@ static css_error nscss_convert_css_data(struct content_css_data *c)
 	return error;
 }
 
+/**
+ * Convert CSS data ready for use
+ *
+ * \param c     CSS data to convert
+ * \param data  Source bytes of the stylesheet
+ * \param size  Number of source bytes
+ * \return CSS error
+ */
+static css_error nscss_convert_css_data(struct content_css_data *c,
+		const uint8_t *data, size_t size)
+{
+	css_error error;
+
+	error = css_stylesheet_append_data(c->sheet, data, size);
+	if (error != CSS_OK && error != CSS_NEEDDATA) {
+		return error;
+	}
+
+	return nscss_convert_css_done(c);
+}
+
+/**
+ * Scheduler callback parsing one slice of a large stylesheet
+ *
+ * Feeds the parser for at most PARSE_SLICE_MS before yielding back to
+ * the event loop, so a large sheet cannot hold up input handling for
+ * the whole parse. Completion, including import fetching, is signalled
+ * through the data's done callback exactly as for the synchronous
+ * path.
+ *
+ * \param p  CSS content object being converted
+ */
+static void nscss_convert_slice(void *p)
+{
+	nscss_content *css = p;
+	const uint8_t *data;
+	size_t size;
+	css_error error;
+	uint64_t slice_start_ms;
+	uint64_t now_ms;
+
+	data = content__get_source_data(&css->base, &size);
+
+	nsu_getmonotonic_ms(&slice_start_ms);
+	now_ms = slice_start_ms;
+
+	while (css->convert_offset < size &&
+			now_ms < slice_start_ms + PARSE_SLICE_MS) {
+		size_t chunk = size - css->convert_offset;
+
+		if (chunk > PARSE_CHUNK_SIZE) {
+			chunk = PARSE_CHUNK_SIZE;
+		}
+
+		error = css_stylesheet_append_data(css->data.sheet,
+				data + css->convert_offset, chunk);
+		if (error != CSS_OK && error != CSS_NEEDDATA) {
+			content_broadcast_error(&css->base,
+					NSERROR_CSS, NULL);
+			content_set_error(&css->base);
+			return;
+		}
+
+		css->convert_offset += chunk;
+
+		nsu_getmonotonic_ms(&now_ms);
+	}
+
+	if (css->convert_offset < size) {
+		/* More source remains; let the event loop run */
+		guit->misc->schedule(0, nscss_convert_slice, css);
+		return;
+	}
+
+	error = nscss_convert_css_done(&css->data);
+	if (error != CSS_OK) {
+		content_broadcast_error(&css->base, NSERROR_CSS, NULL);
+		content_set_error(&css->base);
+	}
+}
+
 /**
  * Clean up a CSS content
  *
@@ -346,6 +658,8 @@ void nscss_destroy(struct content *c)
 {
 	nscss_content *css = (nscss_content *) c;
 
+	guit->misc->schedule(-1, nscss_convert_slice, css);
+
 	nscss_destroy_css_data(&css->data);
 }
 
@@ -368,7 +682,14 @@ static void nscss_destroy_css_data(struct content_css_data *c)
 	free(c->imports);
 
 	if (c->sheet != NULL) {
-		css_stylesheet_destroy(c->sheet);
+		if (c->parse_complete && c->import_count == 0) {
+			/* Retain the parsed sheet for the next content
+			 * with identical source */
+			nscss_cache_put(c->sheet, c->charset,
+					c->checksum, c->source_length);
+		} else {
+			css_stylesheet_destroy(c->sheet);
+		}
 		c->sheet = NULL;
 	}
 
@@ -592,7 +913,8 @@ css_error nscss_handle_import(void *pw, css_stylesheet *parent,
 		ctx = NULL;
 	} else {
 		nerror = hlcache_handle_retrieve(ns_url,
-				0, ns_ref, NULL, nscss_import, ctx,
+				LLCACHE_RETRIEVE_PRIORITY(FETCH_PRIORITY_CSS),
+				ns_ref, NULL, nscss_import, ctx,
 				&child, accept,
 				&c->imports[c->import_count].c);
 		if (nerror != NSERROR_OK) {
@@ -793,6 +1115,19 @@ css_error nscss_register_import(struct content_css_data *c,
  */
 static void nscss_fini(void)
 {
+	unsigned int i;
+
+	for (i = 0; i < SHEET_CACHE_ENTRIES; i++) {
+		if (sheet_cache[i].sheet != NULL) {
+			css_stylesheet_destroy(sheet_cache[i].sheet);
+			sheet_cache[i].sheet = NULL;
+		}
+		free(sheet_cache[i].url);
+		sheet_cache[i].url = NULL;
+		free(sheet_cache[i].charset);
+		sheet_cache[i].charset = NULL;
+	}
+
 	if (blank_import != NULL) {
 		css_stylesheet_destroy(blank_import);
 		blank_import = NULL;
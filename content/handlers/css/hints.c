@@ -622,6 +622,187 @@ static void css_hint_get_hints(struct css_hint **hints, uint32_t *nhints)
 }
 
 
+/******************************************************************************
+ * Hint caching                                                               *
+ ******************************************************************************/
+
+/**
+ * Parsed hints for an element.
+ *
+ * Stored as libdom node user data, so that repeated selection passes
+ * (e.g. media re-selection or a restyle elsewhere in the document) need
+ * not re-parse the element's attributes.
+ */
+struct css_hint_cache {
+	uint32_t len;
+	struct css_hint hints[];
+};
+
+/**
+ * Release any string references held by cached hints and free the cache
+ *
+ * \param cache  Cache to destroy
+ */
+static void css_hint_cache_destroy(struct css_hint_cache *cache)
+{
+	uint32_t i;
+
+	for (i = 0; i < cache->len; i++) {
+		if (cache->hints[i].prop == CSS_PROP_BACKGROUND_IMAGE &&
+				cache->hints[i].status ==
+						CSS_BACKGROUND_IMAGE_IMAGE) {
+			lwc_string_unref(cache->hints[i].data.string);
+		}
+	}
+
+	free(cache);
+}
+
+/* Handler for hint cache, stored as libdom node user data */
+static void css_hint_user_data_handler(dom_node_operation operation,
+		dom_string *key, void *data, struct dom_node *src,
+		struct dom_node *dst)
+{
+	if (dom_string_isequal(corestring_dom___ns_key_hint_node_data,
+			key) == false || data == NULL) {
+		return;
+	}
+
+	switch (operation) {
+	case DOM_NODE_CLONED:
+		/* Cache stays with the source; the clone re-parses */
+		break;
+
+	case DOM_NODE_RENAMED:
+	case DOM_NODE_IMPORTED:
+	case DOM_NODE_ADOPTED:
+	case DOM_NODE_DELETED:
+		css_hint_cache_destroy(data);
+		break;
+
+	default:
+		NSLOG(netsurf, INFO, "User data operation not handled.");
+		assert(0);
+	}
+}
+
+/**
+ * Copy an element's cached hints, if any, into the hint context
+ *
+ * \param node  Element to look up
+ * \return true if cached hints were found, false otherwise
+ */
+static bool css_hint_cache_lookup(dom_node *node)
+{
+	struct css_hint_cache *cache = NULL;
+	dom_exception exc;
+	uint32_t i;
+
+	exc = dom_node_get_user_data(node,
+			corestring_dom___ns_key_hint_node_data,
+			(void *) &cache);
+	if (exc != DOM_NO_ERR || cache == NULL) {
+		return false;
+	}
+
+	for (i = 0; i < cache->len; i++) {
+		hint_ctx.hints[i] = cache->hints[i];
+
+		/* Selection consumes a reference to string hints */
+		if (cache->hints[i].prop == CSS_PROP_BACKGROUND_IMAGE &&
+				cache->hints[i].status ==
+						CSS_BACKGROUND_IMAGE_IMAGE) {
+			(void) lwc_string_ref(cache->hints[i].data.string);
+		}
+	}
+	hint_ctx.len = cache->len;
+
+	return true;
+}
+
+/**
+ * Record the hint context's contents as an element's cached hints
+ *
+ * Failure to cache is not an error: the element's attributes will
+ * simply be re-parsed by the next selection pass.
+ *
+ * \param node  Element the hints were parsed from
+ */
+static void css_hint_cache_store(dom_node *node)
+{
+	struct css_hint_cache *cache, *old = NULL;
+	dom_exception exc;
+	uint32_t i;
+
+	cache = malloc(sizeof(*cache) +
+			hint_ctx.len * sizeof(struct css_hint));
+	if (cache == NULL) {
+		return;
+	}
+
+	cache->len = hint_ctx.len;
+	memcpy(cache->hints, hint_ctx.hints,
+			hint_ctx.len * sizeof(struct css_hint));
+
+	for (i = 0; i < cache->len; i++) {
+		if (cache->hints[i].prop == CSS_PROP_BACKGROUND_IMAGE &&
+				cache->hints[i].status ==
+						CSS_BACKGROUND_IMAGE_IMAGE) {
+			(void) lwc_string_ref(cache->hints[i].data.string);
+		}
+	}
+
+	exc = dom_node_set_user_data(node,
+			corestring_dom___ns_key_hint_node_data,
+			cache, css_hint_user_data_handler, (void *) &old);
+	if (exc != DOM_NO_ERR) {
+		css_hint_cache_destroy(cache);
+		return;
+	}
+
+	if (old != NULL) {
+		css_hint_cache_destroy(old);
+	}
+}
+
+/* Exported function, documented in css/hints.h */
+void css_hint_subtree_modified(struct dom_node *node)
+{
+	dom_node *child = NULL, *next;
+	dom_node_type type;
+	dom_exception exc;
+	void *old = NULL;
+
+	exc = dom_node_get_node_type(node, &type);
+	if (exc != DOM_NO_ERR || type != DOM_ELEMENT_NODE) {
+		return;
+	}
+
+	exc = dom_node_set_user_data(node,
+			corestring_dom___ns_key_hint_node_data,
+			NULL, NULL, &old);
+	if (exc == DOM_NO_ERR && old != NULL) {
+		css_hint_cache_destroy(old);
+	}
+
+	exc = dom_node_get_first_child(node, &child);
+	if (exc != DOM_NO_ERR) {
+		return;
+	}
+
+	while (child != NULL) {
+		css_hint_subtree_modified(child);
+
+		exc = dom_node_get_next_sibling(child, &next);
+		dom_node_unref(child);
+		if (exc != DOM_NO_ERR) {
+			break;
+		}
+		child = next;
+	}
+}
+
+
 /******************************************************************************
  * Presentational hint handlers                                               *
  ******************************************************************************/
@@ -1639,6 +1820,11 @@ css_error node_presentational_hint(void *pw, void *node,
 
 	css_hint_clean();
 
+	if (css_hint_cache_lookup(node)) {
+		css_hint_get_hints(hints, nhints);
+		return CSS_OK;
+	}
+
 	exc = dom_html_element_get_tag_type(node, &tag_type);
 	if (exc != DOM_NO_ERR) {
 		tag_type = DOM_HTML_ELEMENT_TYPE__UNKNOWN;
@@ -1734,6 +1920,13 @@ css_error node_presentational_hint(void *pw, void *node,
 		css_hint_bg_image(pw, node);
 	}
 
+	/* Anchor colours depend on whether the link has been visited,
+	 * which may change between selection passes, so they are never
+	 * cached. */
+	if (tag_type != DOM_HTML_ELEMENT_TYPE_A) {
+		css_hint_cache_store(node);
+	}
+
 #ifdef LOG_STATS
 	NSLOG(netsurf, INFO, "Properties with hints: %i", hint_ctx.len);
 #endif
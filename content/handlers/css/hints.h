@@ -23,9 +23,23 @@
 
 #include <libcss/libcss.h>
 
+struct dom_node;
+
 nserror css_hint_init(void);
 void css_hint_fini(void);
 
+/**
+ * Discard cached presentational hints for an element and its descendants
+ *
+ * Hints are parsed once per element and cached on the DOM node; the
+ * cache must be dropped when an attribute changes. The whole subtree is
+ * purged because some hints (table cell borders, body link colours) are
+ * parsed from an ancestor's attributes.
+ *
+ * \param[in] node  Root of the modified subtree
+ */
+void css_hint_subtree_modified(struct dom_node *node);
+
 /**
  * Callback to retrieve presentational hints for a node
  *
@@ -21,9 +21,11 @@
 #include <strings.h>
 
 #include "utils/nsoption.h"
+#include "utils/bloom.h"
 #include "utils/corestrings.h"
 #include "utils/log.h"
 #include "utils/nsurl.h"
+#include "utils/trace.h"
 #include "netsurf/plot_style.h"
 #include "netsurf/url_db.h"
 #include "desktop/system_colour.h"
@@ -260,6 +262,8 @@ css_select_results *nscss_get_style(nscss_select_ctx *ctx, dom_node *n,
 	int pseudo_element;
 	css_error error;
 
+	NSTRACE(NSTRACE_STYLE, "nscss_get_style", n);
+
 	/* Select style for node */
 	error = css_select_style(ctx->ctx, n, unit_len_ctx, media, inline_style,
 			&selection_handler, ctx, &styles);
@@ -471,6 +475,19 @@ css_error node_id(void *pw, void *node, lwc_string **id)
 css_error named_ancestor_node(void *pw, void *node,
 		const css_qname *qname, void **ancestor)
 {
+	nscss_select_ctx *ctx = pw;
+
+	/* The ancestor filter covers every element above the element
+	 * being selected for, so a name it rejects cannot be found by
+	 * walking the tree */
+	if (ctx->ancestor_bloom != NULL &&
+			bloom_search_hash(ctx->ancestor_bloom,
+				lwc_string_caseless_hash_value(
+					qname->name)) == false) {
+		*ancestor = NULL;
+		return CSS_OK;
+	}
+
 	dom_element_named_ancestor_node(node, qname->name,
 			(struct dom_element **)ancestor);
 	dom_node_unref(*ancestor);
@@ -492,6 +509,18 @@ css_error named_ancestor_node(void *pw, void *node,
 css_error named_parent_node(void *pw, void *node,
 		const css_qname *qname, void **parent)
 {
+	nscss_select_ctx *ctx = pw;
+
+	/* A parent is also an ancestor, so the ancestor filter
+	 * applies here too */
+	if (ctx->ancestor_bloom != NULL &&
+			bloom_search_hash(ctx->ancestor_bloom,
+				lwc_string_caseless_hash_value(
+					qname->name)) == false) {
+		*parent = NULL;
+		return CSS_OK;
+	}
+
 	dom_element_named_parent_node(node, qname->name,
 			(struct dom_element **)parent);
 	dom_node_unref(*parent);
@@ -519,6 +548,9 @@ css_error named_sibling_node(void *pw, void *node,
 
 	*sibling = NULL;
 
+	/* answer depends on siblings; results cannot be shared */
+	((nscss_select_ctx *)pw)->shareable = false;
+
 	/* Find sibling element */
 	err = dom_node_get_previous_sibling(n, &n);
 	if (err != DOM_NO_ERR)
@@ -587,6 +619,9 @@ css_error named_generic_sibling_node(void *pw, void *node,
 
 	*sibling = NULL;
 
+	/* answer depends on siblings; results cannot be shared */
+	((nscss_select_ctx *)pw)->shareable = false;
+
 	err = dom_node_get_previous_sibling(n, &n);
 	if (err != DOM_NO_ERR)
 		return CSS_OK;
@@ -667,6 +702,9 @@ css_error sibling_node(void *pw, void *node, void **sibling)
 
 	*sibling = NULL;
 
+	/* answer depends on siblings; results cannot be shared */
+	((nscss_select_ctx *)pw)->shareable = false;
+
 	/* Find sibling element */
 	err = dom_node_get_previous_sibling(n, &n);
 	if (err != DOM_NO_ERR)
@@ -1323,6 +1361,9 @@ css_error node_count_siblings(void *pw, void *n, bool same_name,
 	dom_exception exc;
 	dom_string *node_name = NULL;
 
+	/* answer depends on siblings; results cannot be shared */
+	((nscss_select_ctx *)pw)->shareable = false;
+
 	if (same_name) {
 		dom_node *node = n;
 		exc = dom_node_get_node_name(node, &node_name);
@@ -1382,6 +1423,9 @@ css_error node_count_siblings(void *pw, void *n, bool same_name,
  */
 css_error node_is_empty(void *pw, void *node, bool *match)
 {
+	/* answer depends on the node's children; results cannot be shared */
+	((nscss_select_ctx *)pw)->shareable = false;
+
 	dom_node *n = node, *next;
 	dom_exception err;
 
@@ -1539,10 +1583,41 @@ css_error node_is_visited(void *pw, void *node, bool *match)
  */
 css_error node_is_hover(void *pw, void *node, bool *match)
 {
-	/** \todo Support hovering */
+	nscss_select_ctx *ctx = pw;
+	dom_node *cur;
 
 	*match = false;
 
+	if (ctx->hover_node == NULL)
+		return CSS_OK;
+
+	/* The hovered element and all of its ancestors are hovered */
+	cur = dom_node_ref(ctx->hover_node);
+	while (cur != NULL) {
+		dom_node *parent;
+		dom_exception err;
+
+		if (cur == (dom_node *) node) {
+			*match = true;
+			break;
+		}
+
+		err = dom_node_get_parent_node(cur, &parent);
+		if (err != DOM_NO_ERR)
+			break;
+
+		dom_node_unref(cur);
+		cur = parent;
+	}
+	if (cur != NULL)
+		dom_node_unref(cur);
+
+	if (*match) {
+		/* hover state is particular to this element; results
+		 * which depend on it cannot be shared */
+		ctx->shareable = false;
+	}
+
 	return CSS_OK;
 }
 
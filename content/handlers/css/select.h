@@ -25,6 +25,7 @@
 
 #include <libcss/libcss.h>
 
+struct bloom_filter;
 struct content;
 struct nsurl;
 
@@ -39,6 +40,20 @@ typedef struct nscss_select_ctx
 	lwc_string *universal;
 	const css_computed_style *root_style;
 	const css_computed_style *parent_style;
+	/** Filter over the caseless hashes of the names of the
+	 * element's ancestors, or NULL. Lets ancestor combinators be
+	 * rejected without walking the tree; false positives merely
+	 * fall back to the walk. */
+	struct bloom_filter *ancestor_bloom;
+	/** The element the pointer is currently over, or NULL. The
+	 * hovered element and its ancestors match :hover. */
+	dom_node *hover_node;
+	/** Cleared by selection callbacks whose answers depend on the
+	 * node's position among its siblings or on its children, to
+	 * show the results cannot be shared with an equivalent element
+	 * elsewhere in the document. Callers which do not care need
+	 * not initialise it. */
+	bool shareable;
 } nscss_select_ctx;
 
 css_stylesheet *nscss_create_inline_style(const uint8_t *data, size_t len,
@@ -88,7 +88,14 @@ typedef enum {
 	REPLACE_DIM = 1 << 9,	/* replaced element has given dimensions */
 	IFRAME      = 1 << 10,	/* box contains an iframe */
 	CONVERT_CHILDREN = 1 << 11,  /* wanted children converting */
-	IS_REPLACED = 1 << 12	/* box is a replaced element */
+	IS_REPLACED = 1 << 12,	/* box is a replaced element */
+	LAYOUT_VALID = 1 << 13,	/* block context layout is up to date */
+	LAYOUT_REUSED = 1 << 14,  /* subtree geometry kept from previous layout */
+	MIN_MEASURED = 1 << 15,	/* text box minimum width has been measured */
+	RELEASED    = 1 << 16,	/* box resources have already been released */
+	BREAK_SCANNED = 1 << 17, /* text scanned for break opportunities */
+	HAS_BREAK   = 1 << 18,	/* text contains a break opportunity */
+	STYLES_SHARED = 1 << 19	/* styles are owned by the html content */
 } box_flags;
 
 
@@ -271,6 +278,20 @@ struct box {
 	 */
 	int cached_place_below_level;
 
+	/**
+	 * Available width at the last layout of this box. Only
+	 * maintained for formatting context roots which cache their
+	 * layout (currently tables).
+	 */
+	int cached_avail_width;
+
+	/**
+	 * Retained flex layout context, or NULL. Only used for flex
+	 * container boxes; keeps the item and line arrays alive
+	 * between reflows.
+	 */
+	void *flex_ctx;
+
 
 	/**
 	 * Coordinate of left padding edge relative to parent box, or
@@ -283,6 +304,16 @@ struct box {
 	 */
 	int y;
 
+	/**
+	 * Cached absolute coordinates last computed by box_coords(),
+	 * valid while cached_coords_gen matches the current coordinate
+	 * generation.
+	 */
+	int cached_abs_x;
+	int cached_abs_y;
+	/** Generation the cached absolute coordinates belong to */
+	unsigned int cached_coords_gen;
+
 	/**
 	 * Width of content box (excluding padding etc.).
 	 */
@@ -27,8 +27,10 @@
 
 #include <string.h>
 #include <dom/dom.h>
+#include <nsutils/time.h>
 
 #include "utils/errors.h"
+#include "utils/bloom.h"
 #include "utils/nsoption.h"
 #include "utils/corestrings.h"
 #include "utils/talloc.h"
@@ -49,6 +51,11 @@
 #include "html/box_normalise.h"
 #include "html/form_internal.h"
 
+/**
+ * Size, in bytes, of the filter over ancestor element names.
+ */
+#define ANCESTOR_BLOOM_SIZE 64
+
 /**
  * Context for box tree construction
  */
@@ -61,7 +68,14 @@ struct box_construct_ctx {
 
 	box_construct_complete_cb cb;	/**< Callback to invoke on completion */
 
-	int *bctx;			/**< talloc context */
+	void *bctx;			/**< arena talloc context */
+
+	/** Filter over the names of the current node's ancestors, used
+	 * to short-circuit descendant selector matching, or NULL. */
+	struct bloom_filter *ancestor_bloom;
+	/** Parent node the ancestor filter was built for (referenced),
+	 * or NULL. The filter is reused for runs of siblings. */
+	dom_node *ancestor_bloom_parent;
 };
 
 /**
@@ -235,6 +249,337 @@ box_extract_properties(dom_node *n, struct box_construct_props *props)
 }
 
 
+/**
+ * Discard the cached ancestor name filter, if any.
+ *
+ * \param ctx  Tree construction context
+ */
+static void box_ancestor_bloom_reset(struct box_construct_ctx *ctx)
+{
+	if (ctx->ancestor_bloom != NULL) {
+		bloom_destroy(ctx->ancestor_bloom);
+		ctx->ancestor_bloom = NULL;
+	}
+
+	if (ctx->ancestor_bloom_parent != NULL) {
+		dom_node_unref(ctx->ancestor_bloom_parent);
+		ctx->ancestor_bloom_parent = NULL;
+	}
+}
+
+
+/**
+ * Get a filter over the names of the current node's ancestors.
+ *
+ * The filter folds in the caseless hash of the name of every element
+ * above the current node, so that style selection can reject ancestor
+ * combinators naming an element which certainly does not appear on the
+ * chain without walking it. The filter is cached against the node's
+ * parent, so a run of siblings shares a single filter.
+ *
+ * \param ctx  Tree construction context
+ * \return the filter, or NULL if one could not be built
+ */
+static struct bloom_filter *
+box_ancestor_bloom_get(struct box_construct_ctx *ctx)
+{
+	dom_node *parent = NULL;
+	dom_node *cur;
+	dom_exception err;
+
+	err = dom_node_get_parent_node(ctx->n, &parent);
+	if (err != DOM_NO_ERR || parent == NULL)
+		return NULL;
+
+	if (ctx->ancestor_bloom_parent == parent) {
+		/* Current node is a sibling of the filter's subject */
+		dom_node_unref(parent);
+		return ctx->ancestor_bloom;
+	}
+
+	box_ancestor_bloom_reset(ctx);
+
+	ctx->ancestor_bloom = bloom_create(ANCESTOR_BLOOM_SIZE);
+	if (ctx->ancestor_bloom == NULL) {
+		dom_node_unref(parent);
+		return NULL;
+	}
+
+	/* Fold in the name of each element from the parent to the root */
+	cur = dom_node_ref(parent);
+	while (cur != NULL) {
+		dom_node *above;
+		dom_node_type type;
+
+		err = dom_node_get_node_type(cur, &type);
+		if (err != DOM_NO_ERR)
+			break;
+
+		if (type == DOM_ELEMENT_NODE) {
+			dom_string *name;
+			lwc_string *iname;
+
+			err = dom_node_get_node_name(cur, &name);
+			if (err != DOM_NO_ERR || name == NULL)
+				break;
+
+			err = dom_string_intern(name, &iname);
+			dom_string_unref(name);
+			if (err != DOM_NO_ERR)
+				break;
+
+			bloom_insert_hash(ctx->ancestor_bloom,
+					lwc_string_caseless_hash_value(iname));
+			lwc_string_unref(iname);
+		}
+
+		err = dom_node_get_parent_node(cur, &above);
+		if (err != DOM_NO_ERR)
+			break;
+
+		dom_node_unref(cur);
+		cur = above;
+	}
+
+	if (cur != NULL) {
+		/* Walk failed part way; an incomplete filter would
+		 * reject names which are present */
+		dom_node_unref(cur);
+		box_ancestor_bloom_reset(ctx);
+		dom_node_unref(parent);
+		return NULL;
+	}
+
+	/* Cache against the parent node, which keeps this reference */
+	ctx->ancestor_bloom_parent = parent;
+
+	return ctx->ancestor_bloom;
+}
+
+
+/**
+ * Test whether two elements are equivalent for style sharing purposes.
+ *
+ * Elements are equivalent if their names are caselessly equal and
+ * their attribute sets are identical. Selection results computed for
+ * one can then be reused for the other, provided their parents'
+ * computed styles are the same, neither has an inline style attribute,
+ * and no selector matched against the first element examined its
+ * siblings or children.
+ *
+ * \param n  Element with existing selection results
+ * \param m  Element being styled
+ * \return true iff the elements are equivalent
+ */
+static bool box_style_share_match(dom_node *n, dom_node *m)
+{
+	dom_namednodemap *attrs, *other_attrs;
+	dom_string *name, *other_name;
+	uint32_t num_attrs = 0, other_num_attrs = 0;
+	unsigned long idx;
+	dom_exception err;
+	bool match;
+
+	/* Element names must match */
+	err = dom_node_get_node_name(n, &name);
+	if (err != DOM_NO_ERR || name == NULL)
+		return false;
+
+	err = dom_node_get_node_name(m, &other_name);
+	if (err != DOM_NO_ERR || other_name == NULL) {
+		dom_string_unref(name);
+		return false;
+	}
+
+	match = dom_string_caseless_isequal(name, other_name);
+
+	dom_string_unref(other_name);
+	dom_string_unref(name);
+
+	if (match == false)
+		return false;
+
+	/* Attribute sets must be identical */
+	err = dom_node_get_attributes(n, &attrs);
+	if (err != DOM_NO_ERR)
+		return false;
+
+	err = dom_node_get_attributes(m, &other_attrs);
+	if (err != DOM_NO_ERR) {
+		if (attrs != NULL)
+			dom_namednodemap_unref(attrs);
+		return false;
+	}
+
+	if (attrs != NULL) {
+		err = dom_namednodemap_get_length(attrs, &num_attrs);
+		if (err != DOM_NO_ERR)
+			goto mismatch;
+	}
+
+	if (other_attrs != NULL) {
+		err = dom_namednodemap_get_length(other_attrs,
+				&other_num_attrs);
+		if (err != DOM_NO_ERR)
+			goto mismatch;
+	}
+
+	if (num_attrs != other_num_attrs)
+		goto mismatch;
+
+	/* The counts are equal and attribute names are unique within an
+	 * element, so comparing one way round is sufficient */
+	for (idx = 0; idx < num_attrs; idx++) {
+		dom_attr *attr;
+		dom_string *value, *other_value;
+
+		err = dom_namednodemap_item(attrs, idx, (void *) &attr);
+		if (err != DOM_NO_ERR)
+			goto mismatch;
+
+		err = dom_attr_get_name(attr, &name);
+		if (err != DOM_NO_ERR || name == NULL) {
+			dom_node_unref(attr);
+			goto mismatch;
+		}
+
+		err = dom_attr_get_value(attr, &value);
+		dom_node_unref(attr);
+		if (err != DOM_NO_ERR) {
+			dom_string_unref(name);
+			goto mismatch;
+		}
+
+		err = dom_element_get_attribute(m, name, &other_value);
+		dom_string_unref(name);
+		if (err != DOM_NO_ERR) {
+			if (value != NULL)
+				dom_string_unref(value);
+			goto mismatch;
+		}
+
+		if (other_value == NULL) {
+			match = false;
+		} else {
+			match = dom_string_isequal(value, other_value);
+			dom_string_unref(other_value);
+		}
+
+		if (value != NULL)
+			dom_string_unref(value);
+
+		if (match == false)
+			goto mismatch;
+	}
+
+	if (attrs != NULL)
+		dom_namednodemap_unref(attrs);
+	if (other_attrs != NULL)
+		dom_namednodemap_unref(other_attrs);
+
+	return true;
+
+mismatch:
+	if (attrs != NULL)
+		dom_namednodemap_unref(attrs);
+	if (other_attrs != NULL)
+		dom_namednodemap_unref(other_attrs);
+
+	return false;
+}
+
+
+/**
+ * Pick the style share table slot for an element.
+ *
+ * Slots are chosen from the parent's computed style and the element's
+ * name, so an element being styled need only probe the one slot where
+ * an equivalent element would have been recorded.
+ *
+ * \param  parent_style  computed style of the element's parent
+ * \param  n             the element
+ * \param  slot          updated to the element's slot on success
+ * \return true on success, false if the element's name is unobtainable
+ */
+static bool
+box_style_share_slot(const css_computed_style *parent_style,
+		     dom_node *n,
+		     unsigned int *slot)
+{
+	dom_string *name;
+	lwc_string *iname;
+	uint32_t hash;
+	dom_exception err;
+
+	err = dom_node_get_node_name(n, &name);
+	if (err != DOM_NO_ERR || name == NULL)
+		return false;
+
+	err = dom_string_intern(name, &iname);
+	dom_string_unref(name);
+	if (err != DOM_NO_ERR)
+		return false;
+
+	hash = lwc_string_caseless_hash_value(iname);
+	lwc_string_unref(iname);
+
+	/* The low pointer bits carry no information due to alignment */
+	*slot = (hash ^ (uint32_t) ((uintptr_t) parent_style >> 4)) %
+			STYLE_SHARE_CACHE_SIZE;
+
+	return true;
+}
+
+
+/**
+ * Record freshly selected styles as a candidate for style sharing.
+ *
+ * Appends the results to the content's list of shared selection
+ * results, transferring ownership to the content, and remembers the
+ * element in the share table. On failure the results are left owned by
+ * the caller.
+ *
+ * \param  c             content of type CONTENT_HTML that is being processed
+ * \param  parent_style  computed style of the element's parent
+ * \param  n             the element the styles were selected for
+ * \param  styles        the element's selection results
+ * \param  slot          the element's share table slot
+ * \return true if ownership of \a styles passed to the content
+ */
+static bool
+box_style_share_record(html_content *c,
+		       const css_computed_style *parent_style,
+		       dom_node *n,
+		       css_select_results *styles,
+		       unsigned int slot)
+{
+	if (c->shared_styles_count == c->shared_styles_alloc) {
+		css_select_results **temp;
+		unsigned int alloc = (c->shared_styles_alloc == 0) ?
+				64 : c->shared_styles_alloc * 2;
+
+		temp = realloc(c->shared_styles, alloc * sizeof(*temp));
+		if (temp == NULL)
+			return false;
+
+		c->shared_styles = temp;
+		c->shared_styles_alloc = alloc;
+	}
+
+	c->shared_styles[c->shared_styles_count++] = styles;
+
+	if (c->style_share_cache[slot].node != NULL) {
+		dom_node_unref(c->style_share_cache[slot].node);
+	}
+
+	c->style_share_cache[slot].parent_style = parent_style;
+	c->style_share_cache[slot].node = dom_node_ref(n);
+	c->style_share_cache[slot].styles = styles;
+
+	return true;
+}
+
+
 /**
  * Get the style for an element.
  *
@@ -242,18 +587,27 @@ box_extract_properties(dom_node *n, struct box_construct_props *props)
  * \param  parent_style    style at this point in xml tree, or NULL for root
  * \param  root_style      root node's style, or NULL for root
  * \param  n               node in xml tree
+ * \param  ancestor_bloom  filter over ancestor element names, or NULL
+ * \param  shared          updated to true if the returned results are
+ *                         owned by the content rather than the caller
  * \return  the new style, or NULL on memory exhaustion
  */
 static css_select_results *
 box_get_style(html_content *c,
 	      const css_computed_style *parent_style,
 	      const css_computed_style *root_style,
-	      dom_node *n)
+	      dom_node *n,
+	      struct bloom_filter *ancestor_bloom,
+	      bool *shared)
 {
 	dom_string *s = NULL;
 	css_stylesheet *inline_style = NULL;
 	css_select_results *styles;
 	nscss_select_ctx ctx;
+	unsigned int share_slot = 0;
+	bool have_share_slot = false;
+
+	*shared = false;
 
 	/* Firstly, construct inline stylesheet, if any */
 	if (nsoption_bool(author_level_css)) {
@@ -278,6 +632,26 @@ box_get_style(html_content *c,
 			return NULL;
 	}
 
+	/* Reuse the results of an equivalent, already styled element,
+	 * if there is one. Only elements without an inline style are
+	 * considered, and only against elements whose parents computed
+	 * to the same style, so that the inputs to selection are known
+	 * to be identical. */
+	if (parent_style != NULL && inline_style == NULL &&
+			box_style_share_slot(parent_style, n, &share_slot)) {
+		have_share_slot = true;
+
+		if (c->style_share_cache[share_slot].styles != NULL &&
+				c->style_share_cache[share_slot].parent_style
+						== parent_style &&
+				box_style_share_match(
+					c->style_share_cache[share_slot].node,
+					n)) {
+			*shared = true;
+			return c->style_share_cache[share_slot].styles;
+		}
+	}
+
 	/* Populate selection context */
 	ctx.ctx = c->select_ctx;
 	ctx.quirks = (c->quirks == DOM_DOCUMENT_QUIRKS_MODE_FULL);
@@ -285,14 +659,25 @@ box_get_style(html_content *c,
 	ctx.universal = c->universal;
 	ctx.root_style = root_style;
 	ctx.parent_style = parent_style;
+	ctx.ancestor_bloom = ancestor_bloom;
+	ctx.hover_node = c->hover_node;
+	ctx.shareable = true;
 
 	/* Select style for element */
 	styles = nscss_get_style(&ctx, n, &c->media, &c->unit_len_ctx,
 			inline_style);
 
-	/* No longer need inline style */
-	if (inline_style != NULL)
+	if (inline_style != NULL) {
+		/* No longer need inline style */
 		css_stylesheet_destroy(inline_style);
+	} else if (styles != NULL && ctx.shareable && have_share_slot) {
+		/* Offer the results for sharing with equivalent
+		 * elements, unless a selector consulted this element's
+		 * siblings or children, whose answers other elements
+		 * may not repeat. */
+		*shared = box_style_share_record(c, parent_style, n, styles,
+				share_slot);
+	}
 
 	return styles;
 }
@@ -480,6 +865,7 @@ box_construct_element(struct box_construct_ctx *ctx, bool *convert_children)
 	dom_exception err;
 	struct box_construct_props props;
 	const css_computed_style *root_style = NULL;
+	bool styles_shared = false;
 
 	assert(ctx->n != NULL);
 
@@ -497,7 +883,7 @@ box_construct_element(struct box_construct_ctx *ctx, bool *convert_children)
 	}
 
 	styles = box_get_style(ctx->content, props.parent_style, root_style,
-			ctx->n);
+			ctx->n, box_ancestor_bloom_get(ctx), &styles_shared);
 	if (styles == NULL)
 		return false;
 
@@ -541,6 +927,11 @@ box_construct_element(struct box_construct_ctx *ctx, bool *convert_children)
 	if (box == NULL)
 		return false;
 
+	/* Content-owned selection results must not be destroyed with
+	 * the box */
+	if (styles_shared)
+		box->flags |= STYLES_SHARED;
+
 	/* If this is the root box, add it to the context */
 	if (props.node_is_root)
 		ctx->root_box = box;
@@ -984,9 +1375,125 @@ box_text_transform(char *s, unsigned int len, enum css_text_transform_e tt)
 }
 
 
+/**
+ * Fetch the text of a text node, coalescing any following sibling text nodes.
+ *
+ * The DOM is not normalized: the parser and scripts can leave runs of
+ * adjacent text nodes, each of which would otherwise be whitespace
+ * processed separately and become its own inline box.  The whole run is
+ * gathered into a single pre-sized buffer so it is squashed and boxed
+ * as a unit, and ctx->n is advanced to the last node consumed so the
+ * caller resumes traversal after the run.
+ *
+ * A DOM error part way along the run stops the gathering early rather
+ * than failing; the remaining nodes are simply processed on their own.
+ *
+ * \param  ctx      Tree construction context; ctx->n is a text node
+ * \param  len_out  Updated to the length in bytes of the returned text
+ * \return  malloc()ed NUL terminated text, or NULL on memory exhaustion
+ */
+static char *box_construct_text_data(struct box_construct_ctx *ctx,
+		size_t *len_out)
+{
+	dom_string *parts_fixed[16];
+	dom_string **parts = parts_fixed;
+	size_t nparts = 0;
+	size_t alloc = sizeof(parts_fixed) / sizeof(parts_fixed[0]);
+	size_t total = 0;
+	dom_string *data;
+	dom_exception err;
+	char *buf = NULL;
+	size_t i;
+
+	err = dom_characterdata_get_data(ctx->n, &data);
+	if (err != DOM_NO_ERR || data == NULL)
+		return NULL;
+
+	parts[nparts++] = data;
+
+	do {
+		dom_node *sibling = NULL;
+		dom_node_type type;
+
+		err = dom_node_get_next_sibling(ctx->n, &sibling);
+		if (err != DOM_NO_ERR || sibling == NULL)
+			break;
+
+		err = dom_node_get_node_type(sibling, &type);
+		if (err != DOM_NO_ERR || type != DOM_TEXT_NODE) {
+			dom_node_unref(sibling);
+			break;
+		}
+
+		err = dom_characterdata_get_data(sibling, &data);
+		if (err != DOM_NO_ERR || data == NULL) {
+			dom_node_unref(sibling);
+			break;
+		}
+
+		if (nparts == alloc) {
+			dom_string **tmp;
+
+			if (parts == parts_fixed) {
+				tmp = malloc(2 * alloc * sizeof(*parts));
+				if (tmp != NULL)
+					memcpy(tmp, parts,
+							alloc * sizeof(*parts));
+			} else {
+				tmp = realloc(parts,
+						2 * alloc * sizeof(*parts));
+			}
+			if (tmp == NULL) {
+				/* can't grow the run; box what we have */
+				dom_string_unref(data);
+				dom_node_unref(sibling);
+				break;
+			}
+
+			parts = tmp;
+			alloc *= 2;
+		}
+
+		parts[nparts++] = data;
+
+		/* the sibling is now part of this run; continue from it */
+		dom_node_unref(ctx->n);
+		ctx->n = sibling;
+	} while (true);
+
+	for (i = 0; i < nparts; i++)
+		total += dom_string_byte_length(parts[i]);
+
+	buf = malloc(total + 1);
+	if (buf != NULL) {
+		size_t used = 0;
+
+		for (i = 0; i < nparts; i++) {
+			size_t len = dom_string_byte_length(parts[i]);
+
+			memcpy(buf + used, dom_string_data(parts[i]), len);
+			used += len;
+		}
+		buf[total] = '\0';
+
+		*len_out = total;
+	}
+
+	for (i = 0; i < nparts; i++)
+		dom_string_unref(parts[i]);
+
+	if (parts != parts_fixed)
+		free(parts);
+
+	return buf;
+}
+
 /**
  * Construct the box tree for an XML text node.
  *
+ * Runs of adjacent text nodes are consumed in one go; on return ctx->n
+ * is the last text node converted.
+ *
  * \param  ctx  Tree construction context
  * \return  true on success, false on memory exhaustion
  */
@@ -994,8 +1501,8 @@ static bool box_construct_text(struct box_construct_ctx *ctx)
 {
 	struct box_construct_props props;
 	struct box *box = NULL;
-	dom_string *content;
-	dom_exception err;
+	size_t merged_len = 0;
+	char *merged;
 
 	assert(ctx->n != NULL);
 
@@ -1003,8 +1510,8 @@ static bool box_construct_text(struct box_construct_ctx *ctx)
 
 	assert(props.containing_block != NULL);
 
-	err = dom_characterdata_get_data(ctx->n, &content);
-	if (err != DOM_NO_ERR || content == NULL)
+	merged = box_construct_text_data(ctx, &merged_len);
+	if (merged == NULL)
 		return false;
 
 	if (css_computed_white_space(props.parent_style) ==
@@ -1013,9 +1520,9 @@ static bool box_construct_text(struct box_construct_ctx *ctx)
 			CSS_WHITE_SPACE_NOWRAP) {
 		char *text;
 
-		text = squash_whitespace(dom_string_data(content));
+		text = squash_whitespace(merged);
 
-		dom_string_unref(content);
+		free(merged);
 
 		if (text == NULL)
 			return false;
@@ -1095,8 +1602,8 @@ static bool box_construct_text(struct box_construct_ctx *ctx)
 		}
 	} else {
 		/* white-space: pre */
-		char *text;
-		size_t text_len = dom_string_byte_length(content);
+		char *text = merged;
+		size_t text_len = merged_len;
 		size_t i;
 		char *current;
 		enum css_white_space_e white_space =
@@ -1107,15 +1614,6 @@ static bool box_construct_text(struct box_construct_ctx *ctx)
 				white_space == CSS_WHITE_SPACE_PRE_LINE ||
 				white_space == CSS_WHITE_SPACE_PRE_WRAP);
 
-		text = malloc(text_len + 1);
-		dom_string_unref(content);
-
-		if (text == NULL)
-			return false;
-
-		memcpy(text, dom_string_data(content), text_len);
-		text[text_len] = '\0';
-
 		/* TODO: Handle tabs properly */
 		for (i = 0; i < text_len; i++)
 			if (text[i] == '\t')
@@ -1228,15 +1726,23 @@ static bool box_construct_text(struct box_construct_ctx *ctx)
 
 
 /**
- * Convert an ELEMENT node to a box tree fragment,
- * then schedule conversion of the next ELEMENT node
+ * Convert ELEMENT nodes to box tree fragments for a bounded time slice,
+ * then schedule conversion of the remaining nodes
  */
 static void convert_xml_to_box(struct box_construct_ctx *ctx)
 {
 	dom_node *next;
 	bool convert_children;
 	uint32_t num_processed = 0;
-	const uint32_t max_processed_before_yield = 10;
+	/* elements to convert between checks of the slice clock */
+	const uint32_t time_check_interval = 64;
+	/* longest slice before yielding so fetch progress and UI
+	 * events continue to be serviced during the conversion */
+	const uint64_t max_slice_ms = 20;
+	uint64_t slice_start_ms = 0;
+	uint64_t now_ms;
+
+	nsu_getmonotonic_ms(&slice_start_ms);
 
 	do {
 		convert_children = true;
@@ -1246,6 +1752,7 @@ static void convert_xml_to_box(struct box_construct_ctx *ctx)
 		if (box_construct_element(ctx, &convert_children) == false) {
 			ctx->cb(ctx->content, false);
 			dom_node_unref(ctx->n);
+			box_ancestor_bloom_reset(ctx);
 			free(ctx);
 			return;
 		}
@@ -1260,6 +1767,7 @@ static void convert_xml_to_box(struct box_construct_ctx *ctx)
 			if (err != DOM_NO_ERR) {
 				ctx->cb(ctx->content, false);
 				dom_node_unref(next);
+				box_ancestor_bloom_reset(ctx);
 				free(ctx);
 				return;
 			}
@@ -1272,9 +1780,13 @@ static void convert_xml_to_box(struct box_construct_ctx *ctx)
 				if (box_construct_text(ctx) == false) {
 					ctx->cb(ctx->content, false);
 					dom_node_unref(ctx->n);
+					box_ancestor_bloom_reset(ctx);
 					free(ctx);
 					return;
 				}
+				/* adjacent text nodes were consumed as one
+				 * run; resume after the last of them */
+				next = ctx->n;
 			}
 
 			next = next_node(next, ctx->content, true);
@@ -1305,10 +1817,17 @@ static void convert_xml_to_box(struct box_construct_ctx *ctx)
 
 			assert(ctx->n == NULL);
 
+			box_ancestor_bloom_reset(ctx);
 			free(ctx);
 			return;
 		}
-	} while (++num_processed < max_processed_before_yield);
+		if (++num_processed == time_check_interval) {
+			num_processed = 0;
+			nsu_getmonotonic_ms(&now_ms);
+			if (now_ms - slice_start_ms >= max_slice_ms)
+				break;
+		}
+	} while (true);
 
 	/* More work to do: schedule a continuation */
 	guit->misc->schedule(0, (void *)convert_xml_to_box, ctx);
@@ -1327,8 +1846,8 @@ dom_to_box(dom_node *n,
 	assert(box_conversion_context != NULL);
 
 	if (c->bctx == NULL) {
-		/* create a context allocation for this box tree */
-		c->bctx = talloc_zero(0, int);
+		/* create an arena allocation for this box tree */
+		c->bctx = box_arena_create();
 		if (c->bctx == NULL) {
 			return NSERROR_NOMEM;
 		}
@@ -1344,6 +1863,8 @@ dom_to_box(dom_node *n,
 	ctx->root_box = NULL;
 	ctx->cb = cb;
 	ctx->bctx = c->bctx;
+	ctx->ancestor_bloom = NULL;
+	ctx->ancestor_bloom_parent = NULL;
 
 	*box_conversion_context = ctx;
 
@@ -1363,6 +1884,7 @@ nserror cancel_dom_to_box(void *box_conversion_context)
 	}
 
 	dom_node_unref(ctx->n);
+	box_ancestor_bloom_reset(ctx);
 	free(ctx);
 
 	return NSERROR_OK;
@@ -1383,6 +1905,531 @@ struct box *box_for_node(dom_node *n)
 	return box;
 }
 
+/**
+ * Styles replaced at one element during a restyle.
+ *
+ * Boxes which do not run selection themselves (text boxes, inline end
+ * boxes, clones made when wrapping) borrow the style pointer of the
+ * element box they belong to, so when an element's styles are replaced
+ * the old and new pointers are remembered for the rest of the walk and
+ * borrowed pointers are redirected as they are encountered.
+ */
+struct box_restyle_scope {
+	/** Selection results replaced at this element, or NULL */
+	const css_select_results *old_styles;
+	/** Their replacement, or NULL */
+	css_select_results *new_styles;
+	/** Computed style replaced at this element, or NULL */
+	const css_computed_style *old_style;
+	/** Its replacement, or NULL */
+	css_computed_style *new_style;
+	/** Enclosing scope, or NULL */
+	struct box_restyle_scope *up;
+};
+
+
+/**
+ * Redirect a box's borrowed style pointers after a restyle.
+ *
+ * \param b  The box to patch
+ * \param s  Innermost restyle scope
+ */
+static void
+box_restyle_patch(struct box *b, const struct box_restyle_scope *s)
+{
+	for (; s != NULL; s = s->up) {
+		if (b->styles != NULL && b->styles == s->old_styles) {
+			/* a clone sharing the element's selection results */
+			b->styles = s->new_styles;
+			b->style = s->new_style;
+			return;
+		}
+
+		if (b->styles == NULL && b->style == s->old_style) {
+			b->style = s->new_style;
+			return;
+		}
+	}
+}
+
+
+/**
+ * Recompute styles for a box and its subtree.
+ *
+ * \param c             content of type CONTENT_HTML
+ * \param box           root of the subtree to restyle
+ * \param parent_style  style of the nearest ancestor element, or NULL
+ * \param root_style    root element's style, or NULL if box is the root
+ * \param up            enclosing restyle scope, or NULL
+ * \return true on success, false on memory exhaustion
+ */
+static bool
+box_restyle_box(html_content *c,
+		struct box *box,
+		const css_computed_style *parent_style,
+		const css_computed_style *root_style,
+		struct box_restyle_scope *up)
+{
+	struct box_restyle_scope scope;
+	const css_computed_style *child_parent_style = parent_style;
+	css_select_results *old_styles = NULL;
+	bool old_shared = false;
+	struct box *child;
+
+	scope.old_styles = NULL;
+	scope.new_styles = NULL;
+	scope.old_style = NULL;
+	scope.new_style = NULL;
+	scope.up = up;
+
+	if (box->node != NULL && box->styles != NULL &&
+			(box->flags & CLONE) == 0) {
+		/* An element box: select fresh styles for it */
+		css_select_results *styles;
+		bool shared = false;
+
+		styles = box_get_style(c, parent_style, root_style,
+				box->node, NULL, &shared);
+		if (styles == NULL)
+			return false;
+
+		scope.old_styles = box->styles;
+		scope.new_styles = styles;
+		scope.old_style = box->style;
+		scope.new_style = styles->styles[CSS_PSEUDO_ELEMENT_NONE];
+
+		old_styles = box->styles;
+		old_shared = (box->flags & STYLES_SHARED) != 0;
+
+		box->styles = styles;
+		box->style = scope.new_style;
+		if (shared)
+			box->flags |= STYLES_SHARED;
+		else
+			box->flags &= ~STYLES_SHARED;
+
+		/* The inline end box borrows the style directly */
+		if (box->inline_end != NULL)
+			box->inline_end->style = scope.new_style;
+
+		/* Clones made when wrapping directly follow their
+		 * original and share its selection results */
+		for (child = box->next;
+				child != NULL && (child->flags & CLONE) != 0;
+				child = child->next) {
+			if (child->styles == scope.old_styles) {
+				child->styles = styles;
+				child->style = scope.new_style;
+			}
+		}
+
+		child_parent_style = scope.new_style;
+	} else if ((box->flags & STYLE_OWNED) == 0) {
+		box_restyle_patch(box, &scope);
+	}
+
+	/* Force measurement and layout of the subtree to be redone */
+	box->max_width = UNKNOWN_MAX_WIDTH;
+	box->flags &= ~LAYOUT_VALID;
+	if (box->type == BOX_TEXT)
+		box->flags &= ~(MEASURED | MIN_MEASURED);
+
+	if (box->list_marker != NULL) {
+		if (!box_restyle_box(c, box->list_marker,
+				child_parent_style, root_style, &scope))
+			return false;
+	}
+
+	for (child = box->children; child != NULL; child = child->next) {
+		if (!box_restyle_box(c, child, child_parent_style,
+				root_style, &scope))
+			return false;
+	}
+
+	/* Safe to drop the old styles now nothing in the subtree
+	 * refers to them; shared results belong to the content */
+	if (old_styles != NULL && old_shared == false)
+		css_select_results_destroy(old_styles);
+
+	return true;
+}
+
+
+/* exported function documented in html/box_construct.h */
+bool box_restyle(html_content *c, dom_node *n)
+{
+	const css_computed_style *parent_style = NULL;
+	const css_computed_style *root_style = NULL;
+	struct box *box;
+	struct box *b;
+	unsigned int i;
+
+	if (c->layout == NULL || c->select_ctx == NULL)
+		return true;
+
+	box = box_for_node(n);
+	if (box == NULL || box->styles == NULL) {
+		/* The element generated no box; a restyle cannot
+		 * introduce one */
+		return true;
+	}
+
+	/* Boxes for an inline element's children are attached as
+	 * siblings of the inline's own box, so restyle inline runs
+	 * from their containing block */
+	while (box->parent != NULL && (box->type == BOX_INLINE ||
+			box->type == BOX_INLINE_END ||
+			box->type == BOX_BR ||
+			box->type == BOX_TEXT ||
+			box->type == BOX_INLINE_CONTAINER)) {
+		box = box->parent;
+	}
+
+	if (box != c->layout) {
+		root_style = c->layout->style;
+
+		for (b = box->parent; b != NULL; b = b->parent) {
+			if (b->style != NULL) {
+				parent_style = b->style;
+				break;
+			}
+		}
+	}
+
+	/* Flush the style share table first: it keys on parent style
+	 * pointers, and styles about to be destroyed could otherwise
+	 * be mistaken for live keys once their storage is reused */
+	for (i = 0; i != STYLE_SHARE_CACHE_SIZE; i++) {
+		if (c->style_share_cache[i].node != NULL) {
+			dom_node_unref(c->style_share_cache[i].node);
+			c->style_share_cache[i].node = NULL;
+		}
+		c->style_share_cache[i].parent_style = NULL;
+		c->style_share_cache[i].styles = NULL;
+	}
+
+	if (box_restyle_box(c, box, parent_style, root_style, NULL) == false)
+		return false;
+
+	/* Invalidate cached widths and layout up to the root */
+	for (b = box; b != NULL; b = b->parent) {
+		b->max_width = UNKNOWN_MAX_WIDTH;
+		b->flags &= ~LAYOUT_VALID;
+	}
+
+	return true;
+}
+
+
+/**
+ * Find the next node within an inserted subtree, completing element
+ * construction where appropriate.
+ *
+ * Behaves as next_node(), but never walks out of the subtree rooted
+ * at \a root: completing \a root finishes the walk.
+ *
+ * \param n                 Current node
+ * \param root              Root of the subtree being converted
+ * \param content           Containing content
+ * \param convert_children  Whether to consider children of \a n
+ * \return Next node to process, or NULL if complete
+ *
+ * \note \a n will be unreferenced
+ */
+static dom_node *
+box_patch_next_node(dom_node *n,
+		    dom_node *root,
+		    html_content *content,
+		    bool convert_children)
+{
+	dom_node *next = NULL;
+	bool has_children;
+	dom_exception err;
+
+	err = dom_node_has_child_nodes(n, &has_children);
+	if (err != DOM_NO_ERR) {
+		dom_node_unref(n);
+		return NULL;
+	}
+
+	if (convert_children && has_children) {
+		err = dom_node_get_first_child(n, &next);
+		if (err != DOM_NO_ERR) {
+			dom_node_unref(n);
+			return NULL;
+		}
+
+		dom_node_unref(n);
+		return next;
+	}
+
+	for (;;) {
+		dom_node *parent = NULL;
+
+		/* Leaving this node: complete its construction */
+		if (box_for_node(n) != NULL)
+			box_construct_element_after(n, content);
+
+		if (n == root) {
+			dom_node_unref(n);
+			return NULL;
+		}
+
+		err = dom_node_get_next_sibling(n, &next);
+		if (err != DOM_NO_ERR) {
+			dom_node_unref(n);
+			return NULL;
+		}
+
+		if (next != NULL) {
+			dom_node_unref(n);
+			return next;
+		}
+
+		err = dom_node_get_parent_node(n, &parent);
+		if (err != DOM_NO_ERR || parent == NULL) {
+			dom_node_unref(n);
+			return NULL;
+		}
+
+		dom_node_unref(n);
+		n = parent;
+	}
+}
+
+
+/* exported function documented in html/box_construct.h */
+bool box_patch_inserted(html_content *c, dom_node *n)
+{
+	struct box_construct_ctx ctx;
+	struct box_construct_props props;
+	struct box *normalise;
+	struct box *b;
+	dom_node *sibling = NULL;
+	dom_node *parent = NULL;
+	struct box *parent_box;
+	dom_node_type type;
+	dom_exception err;
+	bool ok = true;
+
+	if (c->layout == NULL || c->select_ctx == NULL || c->bctx == NULL)
+		return false;
+
+	if (box_for_node(n) != NULL) {
+		/* Node already has a box */
+		return false;
+	}
+
+	err = dom_node_get_node_type(n, &type);
+	if (err != DOM_NO_ERR ||
+			(type != DOM_ELEMENT_NODE && type != DOM_TEXT_NODE))
+		return false;
+
+	/* Construction appends boxes to the end of their containers,
+	 * so only a node inserted after all its siblings can be
+	 * patched in; insertions elsewhere leave the tree untouched */
+	err = dom_node_get_next_sibling(n, &sibling);
+	if (err != DOM_NO_ERR)
+		return false;
+
+	if (sibling != NULL) {
+		dom_node_unref(sibling);
+		return false;
+	}
+
+	/* The parent element must have generated a box which wanted
+	 * its children converted; an unboxed parent means the subtree
+	 * is not rendered (display:none, or itself unconverted) and a
+	 * replaced parent keeps its children boxless */
+	err = dom_node_get_parent_node(n, &parent);
+	if (err != DOM_NO_ERR || parent == NULL)
+		return false;
+
+	parent_box = box_for_node(parent);
+	dom_node_unref(parent);
+
+	if (parent_box == NULL || (parent_box->flags & CONVERT_CHILDREN) == 0)
+		return false;
+
+	box_extract_properties(n, &props);
+	if (props.containing_block == NULL)
+		return false;
+
+	ctx.content = c;
+	ctx.n = dom_node_ref(n);
+	ctx.root_box = c->layout;
+	ctx.cb = NULL;
+	ctx.bctx = c->bctx;
+	ctx.ancestor_bloom = NULL;
+	ctx.ancestor_bloom_parent = NULL;
+
+	if (type == DOM_TEXT_NODE) {
+		ok = box_construct_text(&ctx);
+		dom_node_unref(ctx.n);
+	} else {
+		/* Walk the inserted subtree as the full conversion
+		 * would, constructing boxes for elements and text */
+		do {
+			bool convert_children = true;
+			dom_node *next;
+
+			if (box_construct_element(&ctx,
+					&convert_children) == false) {
+				dom_node_unref(ctx.n);
+				ok = false;
+				break;
+			}
+
+			next = box_patch_next_node(ctx.n, n, c,
+					convert_children);
+			while (next != NULL) {
+				err = dom_node_get_node_type(next, &type);
+				if (err != DOM_NO_ERR) {
+					dom_node_unref(next);
+					next = NULL;
+					ok = false;
+					break;
+				}
+
+				if (type == DOM_ELEMENT_NODE)
+					break;
+
+				if (type == DOM_TEXT_NODE) {
+					ctx.n = next;
+					if (box_construct_text(&ctx) == false) {
+						dom_node_unref(ctx.n);
+						next = NULL;
+						ok = false;
+						break;
+					}
+					/* resume after any coalesced run of
+					 * sibling text nodes */
+					next = ctx.n;
+				}
+
+				next = box_patch_next_node(next, n, c, true);
+			}
+
+			ctx.n = next;
+		} while (ctx.n != NULL && ok);
+	}
+
+	box_ancestor_bloom_reset(&ctx);
+
+	/* Restore the invariants construction relies upon (implied
+	 * table boxes and the like), even after a partial failure */
+	normalise = props.containing_block;
+	while (normalise->parent != NULL &&
+			normalise->type != BOX_BLOCK &&
+			normalise->type != BOX_INLINE_BLOCK &&
+			normalise->type != BOX_TABLE_CELL) {
+		normalise = normalise->parent;
+	}
+
+	if (box_normalise_block(normalise, c->layout, c) == false)
+		ok = false;
+
+	/* Invalidate cached widths and layout up to the root */
+	for (b = props.containing_block; b != NULL; b = b->parent) {
+		b->max_width = UNKNOWN_MAX_WIDTH;
+		b->flags &= ~LAYOUT_VALID;
+	}
+
+	return ok;
+}
+
+
+/**
+ * Detach a box from its parent and siblings without freeing it.
+ *
+ * \param box  The box to detach
+ */
+static void box_patch_detach(struct box *box)
+{
+	struct box *parent = box->parent;
+	struct box *next = box->next;
+	struct box *prev = box->prev;
+
+	if (parent != NULL) {
+		if (parent->children == box)
+			parent->children = next;
+		if (parent->last == box)
+			parent->last = next ? next : prev;
+	}
+
+	if (prev != NULL)
+		prev->next = next;
+	if (next != NULL)
+		next->prev = prev;
+
+	box->parent = NULL;
+	box->next = NULL;
+	box->prev = NULL;
+}
+
+
+/* exported function documented in html/box_construct.h */
+bool box_patch_removed(html_content *c, dom_node *n)
+{
+	struct box *box;
+	struct box *b;
+	struct box *parent;
+	void *old_box;
+
+	if (c->layout == NULL)
+		return false;
+
+	box = box_for_node(n);
+	if (box == NULL || box == c->layout)
+		return false;
+
+	/* Floated boxes are wrapped in a float box */
+	if (box->parent != NULL &&
+			(box->parent->type == BOX_FLOAT_LEFT ||
+			 box->parent->type == BOX_FLOAT_RIGHT))
+		box = box->parent;
+
+	parent = box->parent;
+	if (parent == NULL)
+		return false;
+
+	if (box->inline_end != NULL) {
+		/* Boxes for an inline element's children are attached
+		 * as its siblings: detach everything from the inline
+		 * box through its end box */
+		struct box *end = box->inline_end;
+
+		b = box;
+		while (b != NULL) {
+			struct box *next = b->next;
+
+			box_patch_detach(b);
+			if (b == end)
+				break;
+			b = next;
+		}
+	} else {
+		box_patch_detach(box);
+	}
+
+	/* Forget the association so the node grows a fresh box if it
+	 * is reinserted. The detached boxes stay in the arena until
+	 * the tree is destroyed, as fetches and form gadgets may
+	 * still hold pointers to them. */
+	(void) dom_node_set_user_data(n,
+			corestring_dom___ns_key_box_node_data, NULL, NULL,
+			&old_box);
+
+	/* Invalidate cached widths and layout up to the root */
+	for (b = parent; b != NULL; b = b->parent) {
+		b->max_width = UNKNOWN_MAX_WIDTH;
+		b->flags &= ~LAYOUT_VALID;
+	}
+
+	return true;
+}
+
+
 /* exported function documented in html/box_construct.h */
 bool
 box_extract_link(const html_content *content,
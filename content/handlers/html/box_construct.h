@@ -98,6 +98,55 @@ nserror cancel_dom_to_box(void *box_conversion_context);
  */
 struct box *box_for_node(struct dom_node *node);
 
+/**
+ * Recompute styles for the box subtree generated by a DOM element.
+ *
+ * Re-runs style selection for the element's box and every box below
+ * it, in place, so changes to class or other attributes made from
+ * script take effect without rebuilding the box tree. Boxes are kept
+ * as they are: changes to the display property which would require
+ * different boxes are not honoured, and elements which generated no
+ * box stay boxless. Cached widths and layout along the affected chain
+ * are invalidated; the caller is expected to schedule a reflow.
+ *
+ * \param c The html content the element belongs to
+ * \param n The DOM element which changed
+ * \return true on success, false on memory exhaustion
+ */
+bool box_restyle(struct html_content *c, struct dom_node *n);
+
+/**
+ * Patch the box tree after a DOM node was inserted.
+ *
+ * Constructs boxes for the inserted subtree and attaches them below
+ * the box generated by the node's parent, renormalising the enclosing
+ * block, so content appended from script appears without rebuilding
+ * the whole box tree. Construction appends boxes to the end of their
+ * containers, so only a node inserted after all its siblings can be
+ * patched in; other insertions leave the tree untouched. The caller
+ * should schedule a reflow when this returns true.
+ *
+ * \param c The html content the node belongs to
+ * \param n The DOM node which was inserted
+ * \return true iff the box tree was modified
+ */
+bool box_patch_inserted(struct html_content *c, struct dom_node *n);
+
+/**
+ * Patch the box tree after a DOM node was removed.
+ *
+ * Detaches the boxes the node generated from the tree so they are no
+ * longer laid out or rendered. The boxes themselves stay in the arena
+ * until the tree is destroyed, as object fetches and form gadgets may
+ * still refer to them. The caller should schedule a reflow when this
+ * returns true.
+ *
+ * \param c The html content the node belongs to
+ * \param n The DOM node being removed
+ * \return true iff the box tree was modified
+ */
+bool box_patch_removed(struct html_content *c, struct dom_node *n);
+
 /**
  * Extract a URL from a relative link, handling junk like whitespace and
  * attempting to read a real URL from "javascript:" links.
@@ -54,6 +54,15 @@ enum box_walk_dir {
 #define box_is_float(box) (box->type == BOX_FLOAT_LEFT ||	\
 			   box->type == BOX_FLOAT_RIGHT)
 
+/**
+ * Generation of the cached absolute coordinates held on boxes.
+ *
+ * Bumped whenever box positions or scroll offsets may have changed;
+ * starts above the value boxes are created with so fresh boxes never
+ * appear cached.
+ */
+static unsigned int box_coords_generation = 1;
+
 /**
  * Determine if a point lies within a box.
  *
@@ -545,21 +554,49 @@ box_nearest_text_box(struct box *box,
 }
 
 
+/* Exported function documented in html/box.h */
+void box_coords_invalidate(void)
+{
+	box_coords_generation++;
+}
+
+
 /* Exported function documented in html/box.h */
 void box_coords(struct box *box, int *x, int *y)
 {
-	*x = box->x;
-	*y = box->y;
-	while (box->parent) {
-		if (box_is_float(box)) {
-			assert(box->float_container);
-			box = box->float_container;
+	struct box *b = box;
+
+	if (box->cached_coords_gen == box_coords_generation) {
+		*x = box->cached_abs_x;
+		*y = box->cached_abs_y;
+		return;
+	}
+
+	*x = b->x;
+	*y = b->y;
+	while (b->parent) {
+		if (box_is_float(b)) {
+			assert(b->float_container);
+			b = b->float_container;
 		} else {
-			box = box->parent;
+			b = b->parent;
 		}
-		*x += box->x - scrollbar_get_offset(box->scroll_x);
-		*y += box->y - scrollbar_get_offset(box->scroll_y);
+		if (b->cached_coords_gen == box_coords_generation) {
+			/* The ancestor's absolute position is known;
+			 * it covers the rest of the chain. */
+			*x += b->cached_abs_x -
+					scrollbar_get_offset(b->scroll_x);
+			*y += b->cached_abs_y -
+					scrollbar_get_offset(b->scroll_y);
+			break;
+		}
+		*x += b->x - scrollbar_get_offset(b->scroll_x);
+		*y += b->y - scrollbar_get_offset(b->scroll_y);
 	}
+
+	box->cached_abs_x = *x;
+	box->cached_abs_y = *y;
+	box->cached_coords_gen = box_coords_generation;
 }
 
 
@@ -24,6 +24,15 @@
 #ifndef NETSURF_HTML_BOX_INSPECT_H
 #define NETSURF_HTML_BOX_INSPECT_H
 
+/**
+ * Invalidate all cached absolute box coordinates.
+ *
+ * Must be called whenever box positions or scroll offsets may have
+ * changed, such as around a layout or when a box scrollbar moves.
+ */
+void box_coords_invalidate(void);
+
+
 /**
  * Find the absolute coordinates of a box.
  *
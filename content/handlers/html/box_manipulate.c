@@ -27,8 +27,10 @@
 
 
 #include "utils/errors.h"
+#include "utils/log.h"
 #include "utils/talloc.h"
 #include "utils/nsurl.h"
+#include "netsurf/inttypes.h"
 #include "netsurf/types.h"
 #include "netsurf/mouse.h"
 #include "desktop/scrollbar.h"
@@ -38,15 +40,44 @@
 #include "html/interaction.h"
 #include "html/box.h"
 #include "html/box_manipulate.h"
+#include "html/layout.h"
 
 
+/** Number of boxes bump-allocated from each arena slab */
+#define BOX_ARENA_SLAB_BOXES 128
+
 /**
- * Destructor for box nodes which own styles
+ * A slab of boxes handed out in construction order.
  *
- * \param b The box being destroyed.
- * \return 0 to allow talloc to continue destroying the tree.
+ * Slabs are talloc children of the arena, so freeing the arena frees
+ * every box in bulk, with the slab destructor releasing the resources
+ * the boxes hold.
+ */
+struct box_slab {
+	unsigned int used;	/**< Number of boxes handed out so far */
+	struct box boxes[BOX_ARENA_SLAB_BOXES];
+};
+
+/**
+ * Per-document bump allocator for the box tree.
+ *
+ * Boxes are laid out sequentially in slabs in the order they are
+ * constructed, so tree traversals during layout touch memory mostly in
+ * order instead of chasing individually allocated nodes.
+ */
+struct box_arena {
+	struct box_slab *slab;	/**< Slab currently being filled, or NULL */
+};
+
+
+/**
+ * Release the resources held by a box.
+ *
+ * Safe to call more than once; the box is flagged RELEASED afterwards.
+ *
+ * \param b The box to release.
  */
-static int box_talloc_destructor(struct box *b)
+static void box_release_resources(struct box *b)
 {
 	struct html_scrollbar_data *data;
 
@@ -56,37 +87,116 @@ static int box_talloc_destructor(struct box *b)
 	}
 
 	if (b->styles != NULL) {
-		css_select_results_destroy(b->styles);
+		/* shared selection results are owned by the html content */
+		if ((b->flags & STYLES_SHARED) == 0)
+			css_select_results_destroy(b->styles);
 		b->styles = NULL;
 	}
 
-	if (b->href != NULL)
+	if (b->href != NULL) {
 		nsurl_unref(b->href);
+		b->href = NULL;
+	}
 
 	if (b->id != NULL) {
 		lwc_string_unref(b->id);
+		b->id = NULL;
 	}
 
 	if (b->node != NULL) {
 		dom_node_unref(b->node);
+		b->node = NULL;
 	}
 
 	if (b->scroll_x != NULL) {
 		data = scrollbar_get_data(b->scroll_x);
 		scrollbar_destroy(b->scroll_x);
 		free(data);
+		b->scroll_x = NULL;
 	}
 
 	if (b->scroll_y != NULL) {
 		data = scrollbar_get_data(b->scroll_y);
 		scrollbar_destroy(b->scroll_y);
 		free(data);
+		b->scroll_y = NULL;
+	}
+
+	if (b->flex_ctx != NULL) {
+		layout_flex_ctx_destroy(b->flex_ctx);
+		b->flex_ctx = NULL;
+	}
+
+	b->flags |= RELEASED;
+}
+
+
+/**
+ * Destructor for arena slabs; releases every box still holding resources.
+ *
+ * \param slab The slab being destroyed.
+ * \return 0 to allow talloc to continue destroying the tree.
+ */
+static int box_slab_talloc_destructor(struct box_slab *slab)
+{
+	unsigned int i;
+
+	for (i = 0; i != slab->used; i++) {
+		if (!(slab->boxes[i].flags & RELEASED)) {
+			box_release_resources(&slab->boxes[i]);
+		}
 	}
 
 	return 0;
 }
 
 
+/** Size of the talloc pool slab backing each arena */
+#define BOX_ARENA_POOL_SIZE (64 * 1024)
+
+/* Exported function documented in html/box_manipulate.h */
+void *box_arena_create(void)
+{
+	void *pool;
+	struct box_arena *arena;
+
+	/* The arena is allocated from a talloc pool, so everything
+	 * allocated against it -- box slabs, text, titles, object
+	 * parameters -- is bump allocated from the pool's slab until
+	 * it fills, and spills to the heap after that. */
+	pool = talloc_pool(0, BOX_ARENA_POOL_SIZE);
+	if (pool == NULL) {
+		return NULL;
+	}
+
+	arena = talloc_zero(pool, struct box_arena);
+	if (arena == NULL) {
+		talloc_free(pool);
+		return NULL;
+	}
+
+	return arena;
+}
+
+
+/* Exported function documented in html/box_manipulate.h */
+void box_arena_destroy(void *arena)
+{
+	struct talloc_pool_stats stats;
+	void *pool = talloc_parent(arena);
+
+	if (talloc_pool_usage(pool, &stats) == 0) {
+		NSLOG(netsurf, DEBUG,
+		      "box arena: %"PRIsizet"/%"PRIsizet" slab bytes, "
+		      "%"PRIsizet" pooled, %"PRIsizet" spilled",
+		      stats.used, stats.size,
+		      stats.alloc_count, stats.overflow_count);
+	}
+
+	talloc_free(pool);
+}
+
+
 /* Exported function documented in html/box.h */
 struct box *
 box_create(css_select_results *styles,
@@ -100,13 +210,20 @@ box_create(css_select_results *styles,
 {
 	unsigned int i;
 	struct box *box;
+	struct box_arena *arena = context;
 
-	box = talloc(context, struct box);
-	if (!box) {
-		return 0;
+	if (arena->slab == NULL ||
+			arena->slab->used == BOX_ARENA_SLAB_BOXES) {
+		struct box_slab *slab = talloc(arena, struct box_slab);
+		if (slab == NULL) {
+			return 0;
+		}
+		slab->used = 0;
+		talloc_set_destructor(slab, box_slab_talloc_destructor);
+		arena->slab = slab;
 	}
 
-	talloc_set_destructor(box, box_talloc_destructor);
+	box = &arena->slab->boxes[arena->slab->used++];
 
 	box->type = BOX_INLINE;
 	box->flags = 0;
@@ -114,6 +231,8 @@ box_create(css_select_results *styles,
 	box->styles = styles;
 	box->style = style;
 	box->x = box->y = 0;
+	box->cached_abs_x = box->cached_abs_y = 0;
+	box->cached_coords_gen = 0;
 	box->width = UNKNOWN_WIDTH;
 	box->height = 0;
 	box->descendant_x0 = box->descendant_y0 = 0;
@@ -143,6 +262,8 @@ box_create(css_select_results *styles,
 	box->float_container = NULL;
 	box->next_float = NULL;
 	box->cached_place_below_level = 0;
+	box->cached_avail_width = UNKNOWN_WIDTH;
+	box->flex_ctx = NULL;
 	box->list_value = 1;
 	box->list_marker = NULL;
 	box->col = NULL;
@@ -234,18 +355,19 @@ void box_free(struct box *box)
 /* Exported function documented in html/box.h */
 void box_free_box(struct box *box)
 {
-	if (!(box->flags & CLONE)) {
-		if (box->gadget)
-			form_free_control(box->gadget);
-		if (box->scroll_x != NULL)
-			scrollbar_destroy(box->scroll_x);
-		if (box->scroll_y != NULL)
-			scrollbar_destroy(box->scroll_y);
-		if (box->styles != NULL)
-			css_select_results_destroy(box->styles);
+	if (box->flags & CLONE) {
+		/* Clones share their resources with the original box and
+		 * are ordinary talloc allocations, not arena boxes. */
+		talloc_free(box);
+		return;
 	}
 
-	talloc_free(box);
+	if (box->gadget)
+		form_free_control(box->gadget);
+
+	/* The box memory itself stays in the arena until the box tree is
+	 * destroyed. */
+	box_release_resources(box);
 }
 
 
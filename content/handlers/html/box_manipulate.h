@@ -26,6 +26,27 @@
 #define NETSURF_HTML_BOX_MANIPULATE_H
 
 
+/**
+ * Create an allocation arena for a box tree.
+ *
+ * The returned arena is a talloc context backed by a talloc pool;
+ * boxes are bump-allocated from slabs within it in construction
+ * order, and allocations made on the context come from the pool
+ * while it has room.  Destroy with box_arena_destroy().
+ *
+ * \return allocated arena, or NULL on memory exhaustion
+ */
+void *box_arena_create(void);
+
+
+/**
+ * Destroy a box tree arena and everything allocated within it.
+ *
+ * \param arena arena returned by box_arena_create()
+ */
+void box_arena_destroy(void *arena);
+
+
 /**
  * Create a box tree node.
  *
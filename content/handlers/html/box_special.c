@@ -42,6 +42,7 @@
 #include "css/hints.h"
 #include "desktop/frame_types.h"
 #include "content/content_factory.h"
+#include "content/fetch.h"
 
 #include "html/html.h"
 #include "html/private.h"
@@ -700,6 +701,13 @@ box_a(dom_node *n,
 			if (box->href != NULL)
 				nsurl_unref(box->href);
 			box->href = url;
+
+			/* optionally resolve the link host ahead of
+			 * any click
+			 */
+			if (nsoption_bool(dns_prefetch_anchors)) {
+				fetch_dns_prefetch(url);
+			}
 		}
 	}
 
@@ -36,6 +36,7 @@
 #include "netsurf/inttypes.h"
 #include "netsurf/misc.h"
 #include "netsurf/content.h"
+#include "content/fetch.h"
 #include "content/hlcache.h"
 #include "css/css.h"
 #include "desktop/gui_internal.h"
@@ -86,6 +87,222 @@ static nserror css_error_to_nserror(css_error error)
 }
 
 
+/**
+ * Append one media query breakpoint to a content's record.
+ *
+ * \param htmlc   The html content the breakpoint was found for
+ * \param value   The boundary, in css pixels
+ * \param height  Whether the boundary applies to the viewport height
+ */
+static void
+html_css_add_breakpoint(html_content *htmlc, css_fixed value, bool height)
+{
+	struct html_media_breakpoint *bp;
+
+	if (htmlc->media_breakpoints_count ==
+			htmlc->media_breakpoints_alloc) {
+		unsigned int alloc = (htmlc->media_breakpoints_alloc == 0) ?
+				8 : htmlc->media_breakpoints_alloc * 2;
+
+		bp = realloc(htmlc->media_breakpoints, alloc * sizeof(*bp));
+		if (bp == NULL) {
+			/* Without a complete record, every viewport
+			 * size change must re-select */
+			htmlc->media_breakpoints_unknown = true;
+			return;
+		}
+		htmlc->media_breakpoints = bp;
+		htmlc->media_breakpoints_alloc = alloc;
+	}
+
+	bp = &htmlc->media_breakpoints[htmlc->media_breakpoints_count++];
+	bp->value = value;
+	bp->height = height;
+}
+
+
+/**
+ * Scan a stylesheet's source for viewport-dependent media features.
+ *
+ * Records the lengths at which width and height media queries change
+ * state, so that html_css_viewport_crossed_breakpoint() can tell
+ * whether a viewport size change can alter which rules apply. The
+ * scan is deliberately superficial: values it finds in comments or
+ * strings merely record a breakpoint that is never crossed usefully,
+ * while anything it cannot resolve to a length (viewport-relative
+ * features, unresolvable units, imported sheets whose source never
+ * passes this way) makes the content fall back to re-selecting on
+ * every viewport size change. The same pass notes whether :hover is
+ * used anywhere, which gates interaction-driven restyles.
+ *
+ * \param htmlc  The html content the stylesheet belongs to
+ * \param css    Handle for the stylesheet content
+ */
+static void
+html_css_record_breakpoints(html_content *htmlc, hlcache_handle *css)
+{
+	const uint8_t *data;
+	const char *cdata;
+	size_t size;
+	size_t i;
+
+	data = content_get_source_data(css, &size);
+	if (data == NULL) {
+		return;
+	}
+	cdata = (const char *) data;
+
+	for (i = 0; i + 6 < size; i++) {
+		bool height;
+		double value;
+		bool has_digits;
+		css_fixed len;
+
+		if (data[i] == '@' &&
+				strncasecmp(cdata + i + 1, "import", 6) == 0) {
+			/* The imported sheet's queries are not seen */
+			htmlc->media_breakpoints_unknown = true;
+			continue;
+		}
+
+		if (data[i] == ':' &&
+				strncasecmp(cdata + i + 1, "hover", 5) == 0) {
+			/* Pointer movement must restyle the elements
+			 * whose hover state changes */
+			htmlc->styles_use_hover = true;
+			continue;
+		}
+
+		if (strncasecmp(cdata + i, "orientation", 11) == 0 ||
+				strncasecmp(cdata + i, "aspect-ratio",
+						12) == 0) {
+			/* These change state at ratios of the viewport
+			 * dimensions, which this record cannot express */
+			htmlc->media_breakpoints_unknown = true;
+			continue;
+		}
+
+		if (strncasecmp(cdata + i, "width", 5) == 0) {
+			height = false;
+		} else if (strncasecmp(cdata + i, "height", 6) == 0) {
+			height = true;
+		} else {
+			continue;
+		}
+
+		/* Accept bare and min-/max- prefixed features only;
+		 * device-width and the like do not change on resize */
+		if (i > 0) {
+			if (data[i - 1] == '-') {
+				if (i < 4 || (strncasecmp(cdata + i - 4,
+						"min", 3) != 0 &&
+						strncasecmp(cdata + i - 4,
+						"max", 3) != 0)) {
+					continue;
+				}
+			} else if (isalnum(data[i - 1])) {
+				continue;
+			}
+		}
+
+		i += height ? 6 : 5;
+
+		while (i < size && isspace(data[i]))
+			i++;
+		if (i == size || data[i] != ':') {
+			/* A valueless feature tests against zero */
+			continue;
+		}
+		i++;
+		while (i < size && isspace(data[i]))
+			i++;
+
+		value = 0;
+		has_digits = false;
+		while (i < size && isdigit(data[i])) {
+			value = value * 10 + (data[i] - '0');
+			has_digits = true;
+			i++;
+		}
+		if (i < size && data[i] == '.') {
+			double scale = 0.1;
+
+			i++;
+			while (i < size && isdigit(data[i])) {
+				value += (data[i] - '0') * scale;
+				scale /= 10;
+				has_digits = true;
+				i++;
+			}
+		}
+
+		if (has_digits == false) {
+			htmlc->media_breakpoints_unknown = true;
+			continue;
+		}
+
+		if (size - i >= 2 &&
+				strncasecmp(cdata + i, "px", 2) == 0) {
+			len = FLTTOFIX(value);
+		} else if ((size - i >= 2 &&
+				strncasecmp(cdata + i, "em", 2) == 0) ||
+				(size - i >= 3 &&
+				strncasecmp(cdata + i, "rem", 3) == 0)) {
+			/* Query lengths are relative to the default
+			 * font size, not the element's */
+			len = FMUL(FLTTOFIX(value),
+					FDIV(FMUL(F_96, FDIV(INTTOFIX(
+						nsoption_int(font_size)),
+						F_10)), F_72));
+		} else if (value == 0) {
+			len = 0;
+		} else {
+			/* A unit this scan cannot resolve */
+			htmlc->media_breakpoints_unknown = true;
+			continue;
+		}
+
+		html_css_add_breakpoint(htmlc, len, height);
+	}
+}
+
+
+/* exported function documented in html/css.h */
+bool
+html_css_viewport_crossed_breakpoint(html_content *htmlc,
+				     css_fixed width,
+				     css_fixed height)
+{
+	unsigned int i;
+
+	if (width == htmlc->media.width && height == htmlc->media.height) {
+		return false;
+	}
+
+	if (htmlc->media_breakpoints_unknown) {
+		return true;
+	}
+
+	for (i = 0; i < htmlc->media_breakpoints_count; i++) {
+		const struct html_media_breakpoint *bp =
+				&htmlc->media_breakpoints[i];
+		css_fixed from = bp->height ?
+				htmlc->media.height : htmlc->media.width;
+		css_fixed to = bp->height ? height : width;
+
+		/* Check both the min- (>=) and max- (<=) senses of the
+		 * boundary */
+		if (((from < bp->value) != (to < bp->value)) ||
+				((from <= bp->value) !=
+						(to <= bp->value))) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
 /**
  * Callback for fetchcache() for stylesheets.
  */
@@ -113,6 +330,7 @@ html_convert_css_callback(hlcache_handle *css,
 	case CONTENT_MSG_DONE:
 		NSLOG(netsurf, INFO, "done stylesheet slot %d '%s'", i,
 		      nsurl_access(hlcache_handle_get_url(css)));
+		html_css_record_breakpoints(parent, css);
 		parent->base.active--;
 		NSLOG(netsurf, INFO, "%d fetches active", parent->base.active);
 		break;
@@ -181,7 +399,8 @@ html_stylesheet_from_domnode(html_content *c,
 		return error;
 	}
 
-	error = hlcache_handle_retrieve(url, 0,
+	error = hlcache_handle_retrieve(url,
+			LLCACHE_RETRIEVE_PRIORITY(FETCH_PRIORITY_CSS),
 			content_get_url(&c->base), NULL,
 			html_convert_css_callback, c, &child, CONTENT_CSS,
 			sheet);
@@ -470,7 +689,8 @@ bool html_css_process_link(html_content *htmlc, dom_node *node)
 	child.charset = htmlc->encoding;
 	child.quirks = htmlc->base.quirks;
 
-	ns_error = hlcache_handle_retrieve(joined, 0,
+	ns_error = hlcache_handle_retrieve(joined,
+			LLCACHE_RETRIEVE_PRIORITY(FETCH_PRIORITY_CSS),
 			content_get_url(&htmlc->base),
 			NULL, html_convert_css_callback,
 			htmlc, &child, CONTENT_CSS,
@@ -712,6 +932,99 @@ html_css_new_selection_context(html_content *c, css_select_ctx **ret_select_ctx)
 }
 
 
+/** Pinned handles for the user agent stylesheets, or NULL. */
+static hlcache_handle *html_ua_sheets[STYLESHEET_START];
+
+/**
+ * Callback for the user agent stylesheet warm-up fetches.
+ */
+static nserror
+html_css_preload_callback(hlcache_handle *sheet,
+			  const hlcache_event *event,
+			  void *pw)
+{
+	unsigned int i;
+
+	switch (event->type) {
+	case CONTENT_MSG_DONE:
+		NSLOG(netsurf, INFO, "warmed stylesheet '%s'",
+		      nsurl_access(hlcache_handle_get_url(sheet)));
+		break;
+
+	case CONTENT_MSG_ERROR:
+		/* Give the handle up; contents will simply fetch and
+		 * parse the sheet themselves */
+		for (i = 0; i != STYLESHEET_START; i++) {
+			if (html_ua_sheets[i] == sheet) {
+				hlcache_handle_release(sheet);
+				html_ua_sheets[i] = NULL;
+				break;
+			}
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	return NSERROR_OK;
+}
+
+/**
+ * Fetch, parse and pin the user agent stylesheets.
+ *
+ * Each html content fetches the user agent sheets through the high
+ * level cache, so they are parsed once and shared while cached, but
+ * nothing stops the cache discarding them between pages. Holding our
+ * own handles keeps the parsed sheets alive for the life of the
+ * process, so only the first page ever pays for parsing them.
+ *
+ * Scheduled from html_css_init because the cache is not up yet when
+ * that runs; failures are not fatal for the same reason the pin is
+ * only an optimisation.
+ */
+static void html_css_preload(void *pw)
+{
+	hlcache_child_context child;
+
+	child.charset = NULL;
+	child.quirks = false;
+
+	if (hlcache_handle_retrieve(html_default_stylesheet_url, 0,
+			NULL, NULL, html_css_preload_callback, NULL, &child,
+			CONTENT_CSS,
+			&html_ua_sheets[STYLESHEET_BASE]) != NSERROR_OK) {
+		html_ua_sheets[STYLESHEET_BASE] = NULL;
+	}
+
+	if (nsoption_bool(block_advertisements)) {
+		if (hlcache_handle_retrieve(html_adblock_stylesheet_url, 0,
+				NULL, NULL, html_css_preload_callback, NULL,
+				&child, CONTENT_CSS,
+				&html_ua_sheets[STYLESHEET_ADBLOCK]) !=
+						NSERROR_OK) {
+			html_ua_sheets[STYLESHEET_ADBLOCK] = NULL;
+		}
+	}
+
+	if (hlcache_handle_retrieve(html_user_stylesheet_url, 0,
+			NULL, NULL, html_css_preload_callback, NULL, &child,
+			CONTENT_CSS,
+			&html_ua_sheets[STYLESHEET_USER]) != NSERROR_OK) {
+		html_ua_sheets[STYLESHEET_USER] = NULL;
+	}
+
+	/* quirks documents request the quirks sheet in quirks mode */
+	child.quirks = true;
+
+	if (hlcache_handle_retrieve(html_quirks_stylesheet_url, 0,
+			NULL, NULL, html_css_preload_callback, NULL, &child,
+			CONTENT_CSS,
+			&html_ua_sheets[STYLESHEET_QUIRKS]) != NSERROR_OK) {
+		html_ua_sheets[STYLESHEET_QUIRKS] = NULL;
+	}
+}
+
 /* exported function documented in html/css.h */
 nserror html_css_init(void)
 {
@@ -738,14 +1051,29 @@ nserror html_css_init(void)
 
 	error = nsurl_create("resource:user.css",
 			&html_user_stylesheet_url);
+	if (error != NSERROR_OK)
+		return error;
 
-	return error;
+	/* Warm and pin the user agent sheets once the core, including
+	 * the cache, has finished initialising */
+	return guit->misc->schedule(0, html_css_preload, NULL);
 }
 
 
 /* exported function documented in html/css.h */
 void html_css_fini(void)
 {
+	unsigned int i;
+
+	guit->misc->schedule(-1, html_css_preload, NULL);
+
+	for (i = 0; i != STYLESHEET_START; i++) {
+		if (html_ua_sheets[i] != NULL) {
+			hlcache_handle_release(html_ua_sheets[i]);
+			html_ua_sheets[i] = NULL;
+		}
+	}
+
 	if (html_user_stylesheet_url != NULL) {
 		nsurl_unref(html_user_stylesheet_url);
 		html_user_stylesheet_url = NULL;
@@ -77,6 +77,21 @@ nserror html_css_free_stylesheets(struct html_content *html);
  */
 bool html_css_saw_insecure_stylesheets(struct html_content *htmlc);
 
+/**
+ * Determine whether a viewport size change requires re-selection.
+ *
+ * Compares the new viewport size against the size the document's
+ * styles were last selected for. Only a change which crosses one of
+ * the media query breakpoints recorded when the stylesheets were
+ * fetched can alter which rules apply.
+ *
+ * \param htmlc  The HTML content to check
+ * \param width  New viewport width, in css pixels
+ * \param height New viewport height, in css pixels
+ * \return true if styles must be re-selected for the new size
+ */
+bool html_css_viewport_crossed_breakpoint(struct html_content *htmlc, css_fixed width, css_fixed height);
+
 /**
  * process a css stylesheet dom LINK node 
  *
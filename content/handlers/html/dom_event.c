@@ -33,10 +33,14 @@
 #include "utils/string.h"
 #include "utils/nsurl.h"
 #include "content/content.h"
+#include "content/fetch.h"
 #include "javascript/js.h"
+#include "netsurf/misc.h"
+#include "desktop/gui_internal.h"
 
 #include "netsurf/bitmap.h"
 
+#include "css/hints.h"
 #include "html/private.h"
 #include "html/object.h"
 #include "html/css.h"
@@ -200,6 +204,12 @@ static bool html_process_inserted_link(html_content *c, dom_node *node)
 		return false;
 	}
 
+	/* act on resource hints which only require the host */
+	if ((strcasestr(lwc_string_data(link.rel), "dns-prefetch") != NULL) ||
+	    (strcasestr(lwc_string_data(link.rel), "preconnect") != NULL)) {
+		fetch_dns_prefetch(link.href);
+	}
+
 	/* look for optional properties -- we don't care if internment fails */
 
 	exc = dom_element_get_attribute(node,
@@ -578,6 +588,60 @@ static void html_texty_element_update(html_content *htmlc, dom_node *node)
 }
 
 
+/**
+ * Scheduler callback for a reflow after a restyle.
+ */
+static void html_dom_restyle_reflow(void *p)
+{
+	html_content *htmlc = p;
+
+	if (htmlc->base.status == CONTENT_STATUS_READY ||
+			htmlc->base.status == CONTENT_STATUS_DONE) {
+		content__reformat(&htmlc->base, false,
+				  htmlc->base.available_width,
+				  htmlc->base.available_height);
+	}
+}
+
+
+/**
+ * callback for DOMAttrModified end type
+ */
+static void
+dom_default_action_DOMAttrModified_cb(struct dom_event *evt, void *pw)
+{
+	dom_event_target *node;
+	dom_node_type type;
+	dom_exception exc;
+	html_content *htmlc = pw;
+
+	exc = dom_event_get_target(evt, &node);
+	if ((exc != DOM_NO_ERR) || (node == NULL)) {
+		return;
+	}
+
+	exc = dom_node_get_node_type(node, &type);
+	if ((exc == DOM_NO_ERR) && (type == DOM_ELEMENT_NODE)) {
+		/* Any presentational hints cached below this element
+		 * were parsed from the old attribute values */
+		css_hint_subtree_modified((dom_node *)node);
+
+		/* Recompute styles for the affected subtree in place
+		 * and let a coalesced reflow pick up any geometry
+		 * changes. Scripts which toggle classes rapidly thus
+		 * pay for one reflow per batch, not per mutation.
+		 * Before the box tree exists there is nothing to do:
+		 * construction selects from the current values. */
+		if (htmlc->layout != NULL &&
+				box_restyle(htmlc, (dom_node *)node)) {
+			html_schedule_restyle_reflow(htmlc);
+		}
+	}
+
+	dom_node_unref(node);
+}
+
+
 /**
  * callback for DOMNodeInserted end type
  */
@@ -661,6 +725,42 @@ dom_default_action_DOMNodeInserted_cb(struct dom_event *evt, void *pw)
 			}
 		}
 	}
+
+	if ((exc == DOM_NO_ERR) &&
+			(type == DOM_ELEMENT_NODE || type == DOM_TEXT_NODE) &&
+			(htmlc->layout != NULL)) {
+		/* Patch the inserted subtree into the existing box
+		 * tree and let a coalesced reflow lay it out, rather
+		 * than reconverting the whole document */
+		if (box_patch_inserted(htmlc, (dom_node *)node)) {
+			html_schedule_restyle_reflow(htmlc);
+		}
+	}
+
+	dom_node_unref(node);
+}
+
+
+/**
+ * callback for DOMNodeRemoved end type
+ */
+static void
+dom_default_action_DOMNodeRemoved_cb(struct dom_event *evt, void *pw)
+{
+	dom_event_target *node;
+	dom_exception exc;
+	html_content *htmlc = pw;
+
+	exc = dom_event_get_target(evt, &node);
+	if ((exc != DOM_NO_ERR) || (node == NULL)) {
+		return;
+	}
+
+	if (htmlc->layout != NULL &&
+			box_patch_removed(htmlc, (dom_node *)node)) {
+		html_schedule_restyle_reflow(htmlc);
+	}
+
 	dom_node_unref(node);
 }
 
@@ -765,25 +865,88 @@ dom_default_action_finished_cb(struct dom_event *evt, void *pw)
 }
 
 
+/* exported interface documented in html/dom_event.h */
+void html_schedule_restyle_reflow(html_content *htmlc)
+{
+	guit->misc->schedule(20, html_dom_restyle_reflow, htmlc);
+}
+
+
+/* exported interface documented in html/dom_event.h */
+void html_dom_event_fini(html_content *htmlc)
+{
+	guit->misc->schedule(-1, html_dom_restyle_reflow, htmlc);
+}
+
+
+/**
+ * Mapping of a DOM event type to its default action callback.
+ */
+struct dom_event_handler {
+	/** Interned name of the event type (address of a corestring,
+	 * which is not yet initialised at static-init time) */
+	dom_string **type;
+	/** Callback for the event's END phase */
+	dom_default_action_callback cb;
+};
+
+/**
+ * Dispatch table for the END phase default action callbacks.
+ *
+ * Every event type with a handler is a "DOM*" mutation event, which
+ * the dispatch below relies on to reject high-frequency UI events
+ * (mousemove and friends) without any string comparisons.
+ */
+static const struct dom_event_handler dom_event_handlers[] = {
+	{ &corestring_dom_DOMNodeInserted,
+			dom_default_action_DOMNodeInserted_cb },
+	{ &corestring_dom_DOMNodeInsertedIntoDocument,
+			dom_default_action_DOMNodeInsertedIntoDocument_cb },
+	{ &corestring_dom_DOMNodeRemoved,
+			dom_default_action_DOMNodeRemoved_cb },
+	{ &corestring_dom_DOMSubtreeModified,
+			dom_default_action_DOMSubtreeModified_cb },
+	{ &corestring_dom_DOMAttrModified,
+			dom_default_action_DOMAttrModified_cb },
+};
+
+
 /* exported interface documented in html/dom_event.c */
 dom_default_action_callback
 html_dom_event_fetcher(dom_string *type,
 		  dom_default_action_phase phase,
 		  void **pw)
 {
+	const char *data;
+	unsigned int i;
+
 	NSLOG(netsurf, DEEPDEBUG,
 	      "phase:%d type:%s", phase, dom_string_data(type));
 
-	if (phase == DOM_DEFAULT_ACTION_END) {
-		if (dom_string_isequal(type, corestring_dom_DOMNodeInserted)) {
-			return dom_default_action_DOMNodeInserted_cb;
-		} else if (dom_string_isequal(type, corestring_dom_DOMNodeInsertedIntoDocument)) {
-			return dom_default_action_DOMNodeInsertedIntoDocument_cb;
-		} else if (dom_string_isequal(type, corestring_dom_DOMSubtreeModified)) {
-			return dom_default_action_DOMSubtreeModified_cb;
-		}
-	} else if (phase == DOM_DEFAULT_ACTION_FINISHED) {
+	if (phase == DOM_DEFAULT_ACTION_FINISHED) {
 		return dom_default_action_finished_cb;
 	}
+
+	if (phase != DOM_DEFAULT_ACTION_END) {
+		return NULL;
+	}
+
+	/* Only DOM* mutation events have END phase handlers, so any
+	 * type not starting "DOM" has no default action; this rejects
+	 * the high-frequency input events without a string compare */
+	data = dom_string_data(type);
+	if (dom_string_byte_length(type) < SLEN("DOMxxx") ||
+			data[0] != 'D' || data[1] != 'O' || data[2] != 'M') {
+		return NULL;
+	}
+
+	/* The corestrings and the types of events raised with them
+	 * are interned, making each comparison pointer-sized */
+	for (i = 0; i < NOF_ELEMENTS(dom_event_handlers); i++) {
+		if (dom_string_isequal(type, *dom_event_handlers[i].type)) {
+			return dom_event_handlers[i].cb;
+		}
+	}
+
 	return NULL;
 }
@@ -24,6 +24,25 @@
 #ifndef NETSURF_HTML_DOM_EVENT_H
 #define NETSURF_HTML_DOM_EVENT_H
 
+struct html_content;
+
+/**
+ * Schedule a coalesced reflow of a content whose styles have changed.
+ *
+ * Repeated calls within the coalescing window are folded into a
+ * single reflow, so rapid restyles pay for one layout per batch.
+ *
+ * \param htmlc The html content to reflow
+ */
+void html_schedule_restyle_reflow(struct html_content *htmlc);
+
+/**
+ * Cancel any pending work scheduled by DOM event handling.
+ *
+ * \param htmlc The html content being destroyed
+ */
+void html_dom_event_fini(struct html_content *htmlc);
+
 /**
  * html content DOM action callback function selector
  *
@@ -22,12 +22,94 @@
  * HTML internal font handling implementation.
  */
 
+#include <stdint.h>
+#include <string.h>
+
 #include "utils/nsoption.h"
 #include "netsurf/plot_style.h"
+#include "netsurf/layout.h"
 #include "css/utils.h"
 
 #include "html/font.h"
 
+/** Number of independent shards in the measurement cache */
+#define FONT_CACHE_SHARDS 32
+/** Direct mapped measurement slots per shard */
+#define FONT_CACHE_SHARD_SLOTS 16
+/** Longest string, in bytes, which will be cached */
+#define FONT_CACHE_TEXT_MAX 48
+
+/**
+ * A single cached string measurement.
+ *
+ * The font style is recorded as a hash of the values which affect
+ * glyph selection; family names are folded in by their interned
+ * string hashes so the key never refers back to the style's storage.
+ */
+struct font_width_entry {
+	uint32_t generation; /**< Cache generation the width was measured in */
+	uint32_t style_hash; /**< Hash of the measuring font style */
+	uint32_t text_hash; /**< Hash of the measured bytes */
+	uint16_t length; /**< Number of measured bytes */
+	int width; /**< Measured advance width */
+	char text[FONT_CACHE_TEXT_MAX]; /**< The measured bytes */
+};
+
+/** String measurement cache, shared by every html content */
+static struct font_width_entry font_cache[FONT_CACHE_SHARDS][FONT_CACHE_SHARD_SLOTS];
+
+/** Current cache generation. Slots are zeroed, so starting from one
+ * makes every slot initially stale. */
+static uint32_t font_cache_generation = 1;
+
+/**
+ * Fold a buffer into a hash value
+ *
+ * \param hash Hash value to fold into (FNV-1a)
+ * \param data Buffer to fold
+ * \param len Length of buffer in bytes
+ * \return Updated hash value
+ */
+static uint32_t font_hash_fold(uint32_t hash, const void *data, size_t len)
+{
+	const uint8_t *bytes = data;
+
+	while (len-- > 0) {
+		hash ^= *bytes++;
+		hash *= 0x01000193;
+	}
+
+	return hash;
+}
+
+/**
+ * Compute the hash of the font style values which affect measurement
+ *
+ * \param fstyle Font style to hash
+ * \return Hash value
+ */
+static uint32_t font_style_hash(const plot_font_style_t *fstyle)
+{
+	uint32_t hash = 0x811c9dc5;
+	lwc_string * const *families;
+
+	hash = font_hash_fold(hash, &fstyle->family, sizeof(fstyle->family));
+	hash = font_hash_fold(hash, &fstyle->size, sizeof(fstyle->size));
+	hash = font_hash_fold(hash, &fstyle->weight, sizeof(fstyle->weight));
+	hash = font_hash_fold(hash, &fstyle->flags, sizeof(fstyle->flags));
+
+	for (families = fstyle->families;
+	     families != NULL && *families != NULL;
+	     families++) {
+		lwc_hash family_hash = lwc_string_hash_value(*families);
+
+		hash = font_hash_fold(hash, &family_hash,
+				sizeof(family_hash));
+	}
+
+	return hash;
+}
+
 /**
  * Map a generic CSS font family to a generic plot font family
  *
@@ -163,3 +245,65 @@ void font_plot_style_from_css(
 	fstyle->foreground = nscss_color_to_ns(col);
 	fstyle->background = 0;
 }
+
+
+/* exported function documented in html/font.h */
+nserror
+font_width_measure(const struct gui_layout_table *font_func,
+		   const plot_font_style_t *fstyle,
+		   const char *string,
+		   size_t length,
+		   int *width)
+{
+	uint32_t style_hash, text_hash, combined;
+	struct font_width_entry *entry;
+	nserror res;
+
+	if (length == 0) {
+		*width = 0;
+		return NSERROR_OK;
+	}
+
+	if (length > FONT_CACHE_TEXT_MAX) {
+		/* Too long to cache; measure directly */
+		return font_func->width(fstyle, string, length, width);
+	}
+
+	style_hash = font_style_hash(fstyle);
+	text_hash = font_hash_fold(0x811c9dc5, string, length);
+	combined = style_hash ^ text_hash;
+
+	entry = &font_cache[(combined >> 16) % FONT_CACHE_SHARDS]
+			[combined % FONT_CACHE_SHARD_SLOTS];
+
+	if (entry->generation == font_cache_generation &&
+	    entry->style_hash == style_hash &&
+	    entry->text_hash == text_hash &&
+	    entry->length == length &&
+	    memcmp(entry->text, string, length) == 0) {
+		*width = entry->width;
+		return NSERROR_OK;
+	}
+
+	res = font_func->width(fstyle, string, length, width);
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	/* Direct mapped: simply displace whatever was here before */
+	entry->generation = font_cache_generation;
+	entry->style_hash = style_hash;
+	entry->text_hash = text_hash;
+	entry->length = length;
+	entry->width = *width;
+	memcpy(entry->text, string, length);
+
+	return NSERROR_OK;
+}
+
+
+/* exported function documented in html/font.h */
+void font_cache_invalidate(void)
+{
+	font_cache_generation++;
+}
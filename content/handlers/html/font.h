@@ -28,6 +28,7 @@
 #define NETSURF_HTML_FONT_H
 
 struct plot_font_style;
+struct gui_layout_table;
 
 /**
  * Populate a font style using data from a computed CSS style
@@ -40,4 +41,33 @@ void font_plot_style_from_css(const css_unit_ctx *unit_len_ctx,
 			      const css_computed_style *css,
 			      struct plot_font_style *fstyle);
 
+/**
+ * Measure the width of a string, caching the result
+ *
+ * Measurements are kept in a small cache keyed on the font style and
+ * string, so repeated measurement of the same words during layout
+ * avoids calls into the frontend font system.
+ *
+ * \param font_func Font operations table to measure with
+ * \param fstyle    Font style to measure with
+ * \param string    UTF-8 string to measure
+ * \param length    Length of string, in bytes
+ * \param[out] width Updated to the width of string[0..length)
+ * \return NSERROR_OK and width updated or appropriate error
+ */
+nserror font_width_measure(const struct gui_layout_table *font_func,
+			   const struct plot_font_style *fstyle,
+			   const char *string,
+			   size_t length,
+			   int *width);
+
+/**
+ * Discard all cached string measurements
+ *
+ * Call when the font configuration changes in a way which alters
+ * rendering without altering the font styles themselves, for example
+ * a change to the configured font faces.
+ */
+void font_cache_invalidate(void);
+
 #endif
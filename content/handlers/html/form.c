@@ -37,7 +37,6 @@
 #include "utils/log.h"
 #include "utils/messages.h"
 #include "utils/talloc.h"
-#include "utils/url.h"
 #include "utils/utf8.h"
 #include "utils/ascii.h"
 #include "netsurf/browser_window.h"
@@ -74,6 +73,8 @@ struct form_select_menu {
 	select_menu_redraw_callback callback;
 	void *client_data;
 	struct content *c;
+	struct form_option **option_index; /**< options by row, or NULL */
+	int option_index_count; /**< number of entries in option_index */
 };
 
 static plot_style_t plot_style_fill_selected = {
@@ -1185,9 +1186,78 @@ form_dom_to_data_error:
 	return res;
 }
 
+/**
+ * Determine whether a byte survives form url encoding unescaped.
+ *
+ * This is the unreserved set used by url_escape(); every other byte
+ * is percent encoded, except space which becomes '+'.
+ *
+ * \param[in] c byte to classify
+ * \return true iff \a c is emitted as itself
+ */
+static inline bool form_url_encode_unreserved(char c)
+{
+	return (c >= 'A' && c <= 'Z') ||
+		(c >= 'a' && c <= 'z') ||
+		(c >= '0' && c <= '9') ||
+		c == '-' || c == '.' || c == '_';
+}
+
+/**
+ * Compute the url encoded length of a string.
+ *
+ * \param[in] s string to measure
+ * \return number of bytes \a s occupies once encoded, excluding terminator
+ */
+static size_t form_url_encoded_length(const char *s)
+{
+	size_t len = 0;
+
+	for (; *s != '\0'; s++) {
+		if (form_url_encode_unreserved(*s) || *s == 0x20) {
+			len++;
+		} else {
+			len += 3;
+		}
+	}
+
+	return len;
+}
+
+/**
+ * URL encode a string into an output buffer.
+ *
+ * The buffer must have room for the length computed by
+ * form_url_encoded_length().
+ *
+ * \param[in] pos position in output buffer to write at
+ * \param[in] s string to encode
+ * \return position in output buffer after the encoded string
+ */
+static char *form_url_encode_string(char *pos, const char *s)
+{
+	for (; *s != '\0'; s++) {
+		if (form_url_encode_unreserved(*s)) {
+			*pos++ = *s;
+		} else if (*s == 0x20) {
+			*pos++ = '+';
+		} else {
+			*pos++ = '%';
+			*pos++ = "0123456789ABCDEF"[(*s >> 4) & 0xf];
+			*pos++ = "0123456789ABCDEF"[*s & 0xf];
+		}
+	}
+
+	return pos;
+}
+
 /**
  * Encode controls using application/x-www-form-urlencoded.
  *
+ * Uses two passes over the controls, one to size the output and one
+ * to encode into a single allocation, so large text area values are
+ * not repeatedly reallocated and copied.
+ *
  * \param[in] form form to which successful controls relate
  * \param[in] control linked list of fetch_multipart_data
  * \param[out] encoded_out URL-encoded form data
@@ -1198,57 +1268,35 @@ form_url_encode(struct form *form,
 		struct fetch_multipart_data *control,
 		char **encoded_out)
 {
-	char *name, *value;
-	char *s, *s2;
-	unsigned int len, len1, len_init;
-	nserror res;
+	struct fetch_multipart_data *c;
+	char *s, *pos;
+	size_t len;
 
-	s = malloc(1);
+	/* encoded key/value pair, equals and amphersand per control */
+	len = 0;
+	for (c = control; c != NULL; c = c->next) {
+		len += form_url_encoded_length(c->name) +
+			form_url_encoded_length(c->value) + 2;
+	}
 
+	s = malloc(len + 1);
 	if (s == NULL) {
 		return NSERROR_NOMEM;
 	}
 
-	s[0] = '\0';
-	len_init = len = 0;
-
-	for (; control; control = control->next) {
-		res = url_escape(control->name, true, NULL, &name);
-		if (res != NSERROR_OK) {
-			free(s);
-			return res;
-		}
-
-		res = url_escape(control->value, true, NULL, &value);
-		if (res != NSERROR_OK) {
-			free(name);
-			free(s);
-			return res;
-		}
-
-		/* resize string to allow for new key/value pair,
-		 *  equals, amphersand and terminator
-		 */
-		len1 = len + strlen(name) + strlen(value) + 2;
-		s2 = realloc(s, len1 + 1);
-		if (s2 == NULL) {
-			free(value);
-			free(name);
-			free(s);
-			return NSERROR_NOMEM;
-		}
-		s = s2;
-
-		snprintf(s + len, (len1 + 1) - len, "%s=%s&", name, value);
-		len = len1;
-		free(name);
-		free(value);
+	pos = s;
+	for (c = control; c != NULL; c = c->next) {
+		pos = form_url_encode_string(pos, c->name);
+		*pos++ = '=';
+		pos = form_url_encode_string(pos, c->value);
+		*pos++ = '&';
 	}
 
-	if (len > len_init) {
+	if (pos > s) {
 		/* Replace trailing '&' */
-		s[len - 1] = '\0';
+		pos--;
 	}
+	*pos = '\0';
 
 	*encoded_out = s;
 
@@ -1390,6 +1438,50 @@ form__select_process_selection(html_content *html,
 }
 
 
+/**
+ * Ensure the opened select menu has an index of its options by row.
+ *
+ * Every row in a select menu has the same height, so the row number
+ * for a given vertical offset can be computed directly; the index
+ * array turns that row number into its option without walking the
+ * option list from the head.  The index is rebuilt lazily whenever
+ * options have been added since it was last built.
+ *
+ * \param control the select menu's form control
+ * \return the index array, or NULL on memory exhaustion
+ */
+static struct form_option **form_select_menu_index(
+		struct form_control *control)
+{
+	struct form_select_menu *menu = control->data.select.menu;
+	struct form_option *option;
+	struct form_option **index;
+	int i;
+
+	if (menu->option_index != NULL && menu->option_index_count ==
+			control->data.select.num_items) {
+		return menu->option_index;
+	}
+
+	index = realloc(menu->option_index,
+			control->data.select.num_items * sizeof(*index));
+	if (index == NULL) {
+		return NULL;
+	}
+
+	i = 0;
+	for (option = control->data.select.items; option != NULL;
+			option = option->next) {
+		index[i++] = option;
+	}
+
+	menu->option_index = index;
+	menu->option_index_count = i;
+
+	return index;
+}
+
+
 /**
  * Handle a click on the area of the currently opened select menu.
  *
@@ -1401,6 +1493,7 @@ static void form_select_menu_clicked(struct form_control *control, int x, int y)
 {
 	struct form_select_menu *menu = control->data.select.menu;
 	struct form_option *option;
+	struct form_option **index;
 	html_content *html = (html_content *)menu->c;
 	int line_height, line_height_with_spacing;
 	int item_bottom_y;
@@ -1412,13 +1505,23 @@ static void form_select_menu_clicked(struct form_control *control, int x, int y)
 	line_height_with_spacing = line_height +
 			line_height * SELECT_LINE_SPACING;
 
-	option = control->data.select.items;
-	item_bottom_y = line_height_with_spacing;
-	i = 0;
-	while (option && item_bottom_y < scroll + y) {
-		item_bottom_y += line_height_with_spacing;
-		option = option->next;
-		i++;
+	index = form_select_menu_index(control);
+	if (index != NULL) {
+		/* fixed row height makes the clicked row directly
+		 * computable */
+		i = scroll + y < 1 ? 0 :
+				(scroll + y - 1) / line_height_with_spacing;
+		option = i < control->data.select.num_items ?
+				index[i] : NULL;
+	} else {
+		option = control->data.select.items;
+		item_bottom_y = line_height_with_spacing;
+		i = 0;
+		while (option && item_bottom_y < scroll + y) {
+			item_bottom_y += line_height_with_spacing;
+			option = option->next;
+			i++;
+		}
 	}
 
 	if (option != NULL) {
@@ -1646,6 +1749,7 @@ void form_free_select_menu(struct form_control *control)
 {
 	if (control->data.select.menu->scrollbar != NULL)
 		scrollbar_destroy(control->data.select.menu->scrollbar);
+	free(control->data.select.menu->option_index);
 	free(control->data.select.menu);
 	control->data.select.menu = NULL;
 }
@@ -1662,6 +1766,7 @@ form_redraw_select_menu(struct form_control *control,
 	struct box *box;
 	struct form_select_menu *menu = control->data.select.menu;
 	struct form_option *option;
+	struct form_option **index;
 	int line_height, line_height_with_spacing;
 	int width, height;
 	int x0, y0, x1, scrollbar_x, y1, y2, y3;
@@ -1747,14 +1852,24 @@ form_redraw_select_menu(struct form_control *control,
 		return false;
 	}
 
-	option = control->data.select.items;
-	item_y = line_height_with_spacing;
+	index = form_select_menu_index(control);
+	if (index != NULL) {
+		/* fixed row height makes the first visible row
+		 * directly computable */
+		i = scroll < 1 ? 0 : (scroll - 1) / line_height_with_spacing;
+		option = i < control->data.select.num_items ?
+				index[i] : NULL;
+		item_y = i * line_height_with_spacing;
+	} else {
+		option = control->data.select.items;
+		item_y = line_height_with_spacing;
 
-	while (item_y < scroll) {
-		option = option->next;
-		item_y += line_height_with_spacing;
+		while (item_y < scroll) {
+			option = option->next;
+			item_y += line_height_with_spacing;
+		}
+		item_y -= line_height_with_spacing;
 	}
-	item_y -= line_height_with_spacing;
 	text_pos_offset = y - scroll +
 			(int) (line_height * (0.75 + SELECT_LINE_SPACING));
 	text_x = x + (box->border[LEFT].width + box->padding[LEFT]) * scale;
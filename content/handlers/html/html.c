@@ -46,10 +46,13 @@
 #include "netsurf/utf8.h"
 #include "netsurf/keypress.h"
 #include "netsurf/layout.h"
+#include "netsurf/plot_style.h"
 #include "netsurf/misc.h"
 #include "content/hlcache.h"
 #include "content/content_factory.h"
+#include "content/page_timings.h"
 #include "content/textsearch.h"
+#include "desktop/frame_budget.h"
 #include "desktop/selection.h"
 #include "desktop/scrollbar.h"
 #include "desktop/textarea.h"
@@ -62,10 +65,12 @@
 #include "html/dom_event.h"
 #include "html/css.h"
 #include "html/object.h"
+#include "html/preload.h"
 #include "html/html_save.h"
 #include "html/interaction.h"
 #include "html/box.h"
 #include "html/box_construct.h"
+#include "html/box_manipulate.h"
 #include "html/box_inspect.h"
 #include "html/form_internal.h"
 #include "html/imagemap.h"
@@ -221,6 +226,8 @@ static void html_box_convert_done(html_content *c, bool success)
 
 	NSLOG(netsurf, INFO, "DOM to box conversion complete (content %p)", c);
 
+	page_timings_phase_stop(c, PAGE_TIMINGS_BOX);
+
 	c->box_conversion_context = NULL;
 
 	/* Clean up and report error if unsuccessful or aborted */
@@ -369,7 +376,9 @@ void html_finish_conversion(html_content *htmlc)
 	}
 
 	/* create new css selection context */
+	page_timings_phase_start(htmlc, PAGE_TIMINGS_STYLE);
 	error = html_css_new_selection_context(htmlc, &htmlc->select_ctx);
+	page_timings_phase_stop(htmlc, PAGE_TIMINGS_STYLE);
 	if (error != NSERROR_OK) {
 		content_broadcast_error(&htmlc->base, error, NULL);
 		content_set_error(&htmlc->base);
@@ -401,6 +410,7 @@ void html_finish_conversion(html_content *htmlc)
 
 	html_get_dimensions(htmlc);
 
+	page_timings_phase_start(htmlc, PAGE_TIMINGS_BOX);
 	error = dom_to_box(html, htmlc, html_box_convert_done, &htmlc->box_conversion_context);
 	if (error != NSERROR_OK) {
 		NSLOG(netsurf, INFO, "box conversion failed");
@@ -638,6 +648,10 @@ html_create(const content_handler *handler,
 		return error;
 	}
 
+	/* begin timing this navigation; its fetch is already under way */
+	page_timings_open(html);
+	page_timings_phase_start(html, PAGE_TIMINGS_FETCH);
+
 	*c = (struct content *) html;
 
 	return NSERROR_OK;
@@ -728,6 +742,159 @@ html_process_encoding_change(struct content *c,
 }
 
 
+/** Number of bytes fed to the parser between parse budget checks */
+#define HTML_PARSE_SLICE_SIZE (32 * 1024)
+
+/**
+ * Feed data to the parser in slices until done or the budget expires
+ *
+ * If no parse budget is configured the whole buffer is fed to the
+ * parser in one call, as before.
+ *
+ * \param html Content to parse data for
+ * \param data Data to parse
+ * \param size Length of \a data, in bytes
+ * \param consumed Updated to the number of bytes fed to the parser
+ * \return NSERROR_OK on success, appropriate error otherwise
+ */
+static nserror
+html_parse_data_budgeted(html_content *html,
+			 const uint8_t *data,
+			 size_t size,
+			 size_t *consumed)
+{
+	dom_hubbub_error dom_ret = DOM_HUBBUB_OK;
+	int budget = nsoption_int(parse_budget_ms);
+	uint64_t start_ms = 0;
+	uint64_t now_ms;
+	size_t done = 0;
+
+	if (budget > 0) {
+		nsu_getmonotonic_ms(&start_ms);
+	}
+
+	page_timings_phase_start(html, PAGE_TIMINGS_PARSE);
+
+	while (done < size) {
+		size_t slice = size - done;
+
+		if ((budget > 0) && (slice > HTML_PARSE_SLICE_SIZE)) {
+			slice = HTML_PARSE_SLICE_SIZE;
+		}
+
+		dom_ret = dom_hubbub_parser_parse_chunk(html->parser,
+							data + done,
+							slice);
+		if (dom_ret != DOM_HUBBUB_OK) {
+			break;
+		}
+
+		done += slice;
+
+		if ((budget > 0) && (done < size)) {
+			nsu_getmonotonic_ms(&now_ms);
+			if ((now_ms - start_ms) >= (uint64_t)budget) {
+				/* Budget expired; leave the remainder
+				 * for the caller to carry over */
+				break;
+			}
+		}
+	}
+
+	page_timings_phase_stop(html, PAGE_TIMINGS_PARSE);
+
+	*consumed = done;
+
+	return libdom_hubbub_error_to_nserror(dom_ret);
+}
+
+
+/**
+ * Scheduler callback to parse data carried over from a large chunk
+ *
+ * \param p Content to parse carried data for
+ */
+static void html_process_carried_data(void *p)
+{
+	html_content *html = p;
+	size_t consumed = 0;
+	nserror err;
+
+	html->parse_scheduled = false;
+
+	if (html->aborted || (html->parser == NULL)) {
+		/* No longer parsing; drop the carried data */
+		free(html->parse_pending);
+		html->parse_pending = NULL;
+		content_set_fetch_paused(&html->base, false);
+		return;
+	}
+
+	err = html_parse_data_budgeted(html,
+			html->parse_pending + html->parse_pending_done,
+			html->parse_pending_len - html->parse_pending_done,
+			&consumed);
+	html->parse_pending_done += consumed;
+
+	if (err == NSERROR_ENCODING_CHANGE) {
+		/* The reparse covers the carried data too, as it has
+		 * already been appended to the content source */
+		free(html->parse_pending);
+		html->parse_pending = NULL;
+		err = html_process_encoding_change(&html->base, NULL, 0);
+	} else if ((err == NSERROR_OK) &&
+		   (html->parse_pending_done < html->parse_pending_len)) {
+		/* Yield to the GUI so a paint can happen between
+		 * slices, then continue */
+		html->parse_scheduled = true;
+		guit->misc->schedule(0, html_process_carried_data, html);
+		return;
+	} else {
+		free(html->parse_pending);
+		html->parse_pending = NULL;
+	}
+
+	/* Carried data drained; resume delivery */
+	content_set_fetch_paused(&html->base, false);
+
+	if (err != NSERROR_OK) {
+		content_broadcast_error(&html->base, err, NULL);
+	}
+}
+
+
+/**
+ * Carry unparsed data over to a scheduled parse continuation
+ *
+ * Delivery of further data is held off until the carried data has
+ * been drained.
+ *
+ * \param html Content to carry data over for
+ * \param data Data to carry over
+ * \param size Length of \a data, in bytes
+ * \return true on success, false on memory exhaustion
+ */
+static bool
+html_carry_over_data(html_content *html, const char *data, size_t size)
+{
+	html->parse_pending = malloc(size);
+	if (html->parse_pending == NULL) {
+		return false;
+	}
+
+	memcpy(html->parse_pending, data, size);
+	html->parse_pending_len = size;
+	html->parse_pending_done = 0;
+
+	content_set_fetch_paused(&html->base, true);
+
+	html->parse_scheduled = true;
+	guit->misc->schedule(0, html_process_carried_data, html);
+
+	return true;
+}
+
+
 /**
  * Process data for CONTENT_HTML.
  */
@@ -736,18 +903,42 @@ static bool
 html_process_data(struct content *c, const char *data, unsigned int size)
 {
 	html_content *html = (html_content *) c;
-	dom_hubbub_error dom_ret;
-	nserror err = NSERROR_OK; /* assume its all going to be ok */
+	nserror err;
+	size_t consumed = 0;
+
+	/* overlap subresource network time with the parse */
+	html_preload_scan(html, data, size);
 
-	dom_ret = dom_hubbub_parser_parse_chunk(html->parser,
-					      (const uint8_t *) data,
-					      size);
+	err = html_parse_data_budgeted(html, (const uint8_t *) data, size,
+				       &consumed);
 
-	err = libdom_hubbub_error_to_nserror(dom_ret);
+	if ((err == NSERROR_OK) && (consumed < size)) {
+		/* Parse budget expired before the chunk was consumed */
+		if (html_carry_over_data(html, data + consumed,
+					 size - consumed)) {
+			return true;
+		}
+
+		/* Carry over failed; keep parsing in this callback */
+		while ((err == NSERROR_OK) && (consumed < size)) {
+			size_t more = 0;
+
+			err = html_parse_data_budgeted(html,
+					(const uint8_t *) data + consumed,
+					size - consumed,
+					&more);
+			consumed += more;
+		}
+	}
 
 	/* deal with encoding change */
 	if (err == NSERROR_ENCODING_CHANGE) {
-		 err = html_process_encoding_change(c, data, size);
+		/* the change requires a reparse of everything received
+		 * so far; hold further delivery off while that runs
+		 */
+		content_set_fetch_paused(c, true);
+		err = html_process_encoding_change(c, data, size);
+		content_set_fetch_paused(c, false);
 	}
 
 	/* broadcast the error if necessary */
@@ -797,6 +988,8 @@ static bool html_convert(struct content *c)
 	htmlc->base.active--; /* the html fetch is no longer active */
 	NSLOG(netsurf, INFO, "%d fetches active (%p)", htmlc->base.active, c);
 
+	page_timings_phase_stop(htmlc, PAGE_TIMINGS_FETCH);
+
 	/* The parse cannot be completed here because it may be paused
 	 * untill all the resources being fetched have completed.
 	 */
@@ -853,7 +1046,9 @@ html_begin_conversion(html_content *htmlc)
 	if (htmlc->parse_completed == false) {
 		NSLOG(netsurf, INFO, "Completing parse (%p)", htmlc);
 		/* complete parsing */
+		page_timings_phase_start(htmlc, PAGE_TIMINGS_PARSE);
 		error = dom_hubbub_parser_completed(htmlc->parser);
+		page_timings_phase_stop(htmlc, PAGE_TIMINGS_PARSE);
 		if (error == DOM_HUBBUB_HUBBUB_ERR_PAUSED && htmlc->base.active > 0) {
 			/* The act of completing the parse failed because we've
 			 * encountered a sync script which needs to run
@@ -1054,21 +1249,51 @@ static void html_reformat(struct content *c, int width, int height)
 {
 	html_content *htmlc = (html_content *) c;
 	struct box *layout;
+	bool restyle;
 	uint64_t ms_before;
 	uint64_t ms_after;
 	uint64_t ms_interval;
 
 	nsu_getmonotonic_ms(&ms_before);
 
+	frame_budget_enter(FRAME_BUDGET_LAYOUT);
+
 	htmlc->reflowing = true;
 
+	/* layout can split and merge text boxes */
+	html_textselection_invalidate(htmlc);
+
 	htmlc->unit_len_ctx.viewport_width = css_unit_device2css_px(
 			INTTOFIX(width), htmlc->unit_len_ctx.device_dpi);
 	htmlc->unit_len_ctx.viewport_height = css_unit_device2css_px(
 			INTTOFIX(height), htmlc->unit_len_ctx.device_dpi);
+
+	/* Re-evaluate media queries only when the new viewport size
+	 * crosses a recorded breakpoint: most resize steps leave the
+	 * set of applicable rules unchanged, and the document can then
+	 * simply be laid out again with its existing styles. */
+	restyle = html_css_viewport_crossed_breakpoint(htmlc,
+			htmlc->unit_len_ctx.viewport_width,
+			htmlc->unit_len_ctx.viewport_height);
+
+	htmlc->media.width = htmlc->unit_len_ctx.viewport_width;
+	htmlc->media.height = htmlc->unit_len_ctx.viewport_height;
+
+	if (restyle && htmlc->layout->node != NULL) {
+		box_restyle(htmlc, htmlc->layout->node);
+	}
+
 	htmlc->unit_len_ctx.root_style = htmlc->layout->style;
 
+	/* box positions are in flux throughout the layout and settle
+	 * after it, so cached coordinates are stale on both sides */
+	box_coords_invalidate();
 	layout_document(htmlc, width, height);
+	box_coords_invalidate();
+
+	/* the styles in use may have changed wholesale with the layout */
+	plot_style_intern_invalidate();
+
 	layout = htmlc->layout;
 
 	/* width and height are at least margin box of document */
@@ -1090,9 +1315,13 @@ static void html_reformat(struct content *c, int width, int height)
 	htmlc->reflowing = false;
 	htmlc->had_initial_layout = true;
 
+	frame_budget_leave(FRAME_BUDGET_LAYOUT);
+
 	/* calculate next reflow time at three times what it took to reflow */
 	nsu_getmonotonic_ms(&ms_after);
 
+	page_timings_phase_add(htmlc, PAGE_TIMINGS_LAYOUT, ms_after - ms_before);
+
 	ms_interval = (ms_after - ms_before) * 3;
 	if (ms_interval < (nsoption_uint(min_reflow_period) * 10)) {
 		ms_interval = nsoption_uint(min_reflow_period) * 10;
@@ -1187,12 +1416,40 @@ static void html_destroy_iframe(struct content_html_iframe *iframe)
 
 static void html_free_layout(html_content *htmlc)
 {
+	unsigned int i;
+
 	if (htmlc->bctx != NULL) {
-		/* freeing talloc context should let the entire box
-		 * set be destroyed
+		/* destroying the arena lets the entire box set be
+		 * destroyed
 		 */
-		talloc_free(htmlc->bctx);
+		box_arena_destroy(htmlc->bctx);
+	}
+
+	/* drop the style share table's node references */
+	for (i = 0; i != STYLE_SHARE_CACHE_SIZE; i++) {
+		if (htmlc->style_share_cache[i].node != NULL) {
+			dom_node_unref(htmlc->style_share_cache[i].node);
+			htmlc->style_share_cache[i].node = NULL;
+		}
+		htmlc->style_share_cache[i].parent_style = NULL;
+		htmlc->style_share_cache[i].styles = NULL;
+	}
+
+	/* selection results shared between boxes are owned here */
+	for (i = 0; i != htmlc->shared_styles_count; i++) {
+		css_select_results_destroy(htmlc->shared_styles[i]);
 	}
+	free(htmlc->shared_styles);
+
+	/* the text runs point into the arena destroyed above */
+	free(htmlc->textselection_runs);
+	htmlc->textselection_runs = NULL;
+	htmlc->textselection_run_count = 0;
+	htmlc->textselection_run_alloc = 0;
+	htmlc->textselection_runs_valid = false;
+	htmlc->shared_styles = NULL;
+	htmlc->shared_styles_count = 0;
+	htmlc->shared_styles_alloc = 0;
 }
 
 /**
@@ -1206,6 +1463,10 @@ static void html_destroy(struct content *c)
 
 	NSLOG(netsurf, INFO, "content %p", c);
 
+	/* only a load which got all the way to done is a useful sample */
+	page_timings_close(html,
+			content__get_status(c) == CONTENT_STATUS_DONE);
+
 	/* If we're still converting a layout, cancel it */
 	if (html->box_conversion_context != NULL) {
 		if (cancel_dom_to_box(html->box_conversion_context) != NSERROR_OK) {
@@ -1224,6 +1485,10 @@ static void html_destroy(struct content *c)
 
 	imagemap_destroy(html);
 
+	html_preload_fini(html);
+
+	html_dom_event_fini(html);
+
 	if (c->refresh)
 		nsurl_unref(c->refresh);
 
@@ -1238,6 +1503,13 @@ static void html_destroy(struct content *c)
 		html->jsthread = NULL;
 	}
 
+	if (html->parse_scheduled) {
+		guit->misc->schedule(-1, html_process_carried_data, html);
+		html->parse_scheduled = false;
+	}
+	free(html->parse_pending);
+	html->parse_pending = NULL;
+
 	if (html->parser != NULL) {
 		dom_hubbub_parser_destroy(html->parser);
 		html->parser = NULL;
@@ -1253,6 +1525,11 @@ static void html_destroy(struct content *c)
 		html->title = NULL;
 	}
 
+	if (html->hover_node != NULL) {
+		dom_node_unref(html->hover_node);
+		html->hover_node = NULL;
+	}
+
 	/* Free encoding */
 	if (html->encoding != NULL) {
 		free(html->encoding);
@@ -1294,6 +1571,11 @@ static void html_destroy(struct content *c)
 		html->media.prefers_color_scheme = NULL;
 	}
 
+	if (html->media_breakpoints != NULL) {
+		free(html->media_breakpoints);
+		html->media_breakpoints = NULL;
+	}
+
 	/* Free stylesheets */
 	html_css_free_stylesheets(html);
 
@@ -2216,6 +2498,64 @@ static void html_fini(void)
 	html_css_fini();
 }
 
+/**
+ * Finds occurrences of a given string in the text of an html box
+ *
+ * \param pattern   the string pattern to search for
+ * \param p_len     pattern length
+ * \param cur       pointer to the box to scan
+ * \param b_off     byte offset within the box text to scan from
+ * \param case_sens whether to perform a case sensitive search
+ * \param context   The search context to add the entry to.
+ * \return true on success, false on memory allocation failure
+ */
+static nserror
+find_occurrences_html_text(const char *pattern,
+			   int p_len,
+			   struct box *cur,
+			   unsigned b_off,
+			   bool case_sens,
+			   struct textsearch_context *context)
+{
+	const char *text = cur->text + b_off;
+	unsigned length = cur->length - b_off;
+	nserror res = NSERROR_OK;
+
+	while (length > 0) {
+		unsigned match_length;
+		unsigned match_offset;
+		const char *new_text;
+		const char *pos;
+
+		pos = content_textsearch_find_pattern(text,
+				   length,
+				   pattern,
+				   p_len,
+				   case_sens,
+				   &match_length);
+		if (!pos)
+			break;
+
+		/* found string in box => add to list */
+		match_offset = pos - cur->text;
+
+		res = content_textsearch_add_match(context,
+				cur->byte_offset + match_offset,
+				cur->byte_offset + match_offset + match_length,
+				cur,
+				cur);
+		if (res != NSERROR_OK) {
+			return res;
+		}
+
+		new_text = pos + match_length;
+		length -= (new_text - text);
+		text = new_text;
+	}
+
+	return res;
+}
+
 /**
  * Finds all occurrences of a given string in an html box
  *
@@ -2238,39 +2578,14 @@ find_occurrences_html_box(const char *pattern,
 
 	/* ignore this box, if there's no visible text */
 	if (!cur->object && cur->text) {
-		const char *text = cur->text;
-		unsigned length = cur->length;
-
-		while (length > 0) {
-			unsigned match_length;
-			unsigned match_offset;
-			const char *new_text;
-			const char *pos;
-
-			pos = content_textsearch_find_pattern(text,
-					   length,
-					   pattern,
-					   p_len,
-					   case_sens,
-					   &match_length);
-			if (!pos)
-				break;
-
-			/* found string in box => add to list */
-			match_offset = pos - cur->text;
-
-			res = content_textsearch_add_match(context,
-					cur->byte_offset + match_offset,
-					cur->byte_offset + match_offset + match_length,
-					cur,
-					cur);
-			if (res != NSERROR_OK) {
-				return res;
-			}
-
-			new_text = pos + match_length;
-			length -= (new_text - text);
-			text = new_text;
+		res = find_occurrences_html_text(pattern,
+						 p_len,
+						 cur,
+						 0,
+						 case_sens,
+						 context);
+		if (res != NSERROR_OK) {
+			return res;
 		}
 	}
 
@@ -2320,6 +2635,56 @@ html_textsearch_find(struct content *c,
 }
 
 
+/**
+ * Finds occurrences of an extended string within one html box
+ *
+ * \param c The content to search
+ * \param context The search context to add entries to.
+ * \param pattern the string pattern to search for
+ * \param p_len pattern length
+ * \param csens whether to perform a case sensitive search
+ * \param box the box holding the first previous match
+ * \param start_idx byte index of that match within the content
+ * \param scanned_to updated with the byte index of the end of the box
+ * \return NSERROR_OK on success else error code
+ */
+static nserror
+html_textsearch_refind(struct content *c,
+		       struct textsearch_context *context,
+		       const char *pattern,
+		       int p_len,
+		       bool csens,
+		       struct box *box,
+		       unsigned int start_idx,
+		       unsigned int *scanned_to)
+{
+	html_content *html = (html_content *)c;
+	unsigned b_off = 0;
+
+	if (html->layout == NULL) {
+		return NSERROR_INVALID;
+	}
+
+	*scanned_to = box->byte_offset + box->length;
+
+	if (box->object || !box->text) {
+		return NSERROR_OK;
+	}
+
+	if ((start_idx > box->byte_offset) &&
+	    (start_idx <= box->byte_offset + box->length)) {
+		b_off = start_idx - box->byte_offset;
+	}
+
+	return find_occurrences_html_text(pattern,
+					  p_len,
+					  box,
+					  b_off,
+					  csens,
+					  context);
+}
+
+
 static nserror
 html_textsearch_bounds(struct content *c,
 		       unsigned start_idx,
@@ -2370,6 +2735,7 @@ static const content_handler html_content_handler = {
 	.exec = html_exec,
 	.saw_insecure_objects = html_saw_insecure_objects,
 	.textsearch_find = html_textsearch_find,
+	.textsearch_refind = html_textsearch_refind,
 	.textsearch_bounds = html_textsearch_bounds,
 	.textselection_redraw = html_textselection_redraw,
 	.textselection_copy = html_textselection_copy,
@@ -99,6 +99,8 @@ struct content_html_object {
 	/** Bitmap of acceptable content types */
 	content_type permitted_types;
 	bool background;  /**< This object is a background image. */
+	/** Fetch deferred until the box nears the viewport, or NULL */
+	struct nsurl *deferred_url;
 };
 
 
@@ -32,6 +32,7 @@
 
 #include "utils/log.h"
 #include "utils/corestrings.h"
+#include "utils/libdom.h"
 #include "content/content_protected.h"
 #include "content/hlcache.h"
 
@@ -74,9 +75,28 @@ struct mapentry {
 	struct mapentry *next;		/**< next entry in list */
 };
 
+/** Cells per side of the spatial index grid */
+#define IMAGEMAP_GRID_DIM 32
+
+/** Entry count below which a map is not worth indexing */
+#define IMAGEMAP_GRID_MIN_ENTRIES 64
+
 struct imagemap {
 	char *key;		/**< key for this entry */
 	struct mapentry *list;	/**< pointer to linked list of entries */
+
+	/* Spatial index for large maps, built lazily on first query.
+	 * Entry pointers are grouped by grid cell, in document order
+	 * within each cell, so point queries only test the areas
+	 * overlapping one cell instead of walking the whole list. */
+	struct mapentry **cell_entries;	/**< entry pointers grouped by cell */
+	unsigned int *cell_start;	/**< per cell offsets, one extra */
+	int grid_x0;		/**< left edge covered by the grid */
+	int grid_y0;		/**< top edge covered by the grid */
+	int grid_x1;		/**< right edge covered by the grid */
+	int grid_y1;		/**< bottom edge covered by the grid */
+	bool grid_tried;	/**< grid construction already attempted */
+
 	struct imagemap *next;	/**< next entry in this hash chain */
 };
 
@@ -214,6 +234,8 @@ void imagemap_destroy(html_content *c)
 		while (map != NULL) {
 			next = map->next;
 			imagemap_freelist(map->list);
+			free(map->cell_entries);
+			free(map->cell_start);
 			free(map->key);
 			free(map);
 			map = next;
@@ -524,6 +546,30 @@ ok_out:
 	return ret;
 }
 
+/**
+ * Context for gathering map entries from a subtree walk.
+ */
+struct imagemap_entry_ctx {
+	html_content *c;		/**< Content containing document */
+	struct mapentry **entry;	/**< List of map entries */
+	dom_string *tname;		/**< The sub-tag being gathered */
+};
+
+/**
+ * Add a matched area or anchor element to the entry list.
+ *
+ * \param node  The matched element
+ * \param ctxin The gathering context
+ * \return false on memory exhaustion, true otherwise
+ */
+static bool imagemap_extract_entry(dom_node *node, void *ctxin)
+{
+	struct imagemap_entry_ctx *ctx = ctxin;
+
+	return imagemap_addtolist(ctx->c, node, ctx->c->base_url,
+				  ctx->entry, ctx->tname);
+}
+
 /**
  * Extract an imagemap from html source
  *
@@ -531,48 +577,25 @@ ok_out:
  * \param c     Content containing document
  * \param entry List of map entries
  * \param tname The sub-tags to consider on this pass
+ * \param tag   lwc name of the sub-tags, for matching
  * \return false on memory exhaustion, true otherwise
  */
 static bool
 imagemap_extract_map_entries(dom_node *node, html_content *c,
-			     struct mapentry **entry, dom_string *tname)
+			     struct mapentry **entry, dom_string *tname,
+			     lwc_string *tag)
 {
-	dom_nodelist *nlist;
-	dom_exception exc;
-	unsigned long ent;
-	uint32_t tag_count;
-
-	exc = dom_element_get_elements_by_tag_name(node, tname, &nlist);
-	if (exc != DOM_NO_ERR) {
-		return false;
-	}
-
-	exc = dom_nodelist_get_length(nlist, &tag_count);
-	if (exc != DOM_NO_ERR) {
-		dom_nodelist_unref(nlist);
-		return false;
-	}
-
-	for (ent = 0; ent < tag_count; ++ent) {
-		dom_node *subnode;
-
-		exc = dom_nodelist_item(nlist, ent, &subnode);
-		if (exc != DOM_NO_ERR) {
-			dom_nodelist_unref(nlist);
-			return false;
-		}
-		if (imagemap_addtolist(c, subnode, c->base_url,
-				       entry, tname) == false) {
-			dom_node_unref(subnode);
-			dom_nodelist_unref(nlist);
-			return false;
-		}
-		dom_node_unref(subnode);
-	}
-
-	dom_nodelist_unref(nlist);
-
-	return true;
+	struct imagemap_entry_ctx ctx = {
+		.c = c,
+		.entry = entry,
+		.tname = tname,
+	};
+
+	/* Walk the subtree rather than taking a nodelist: nodelist
+	 * lookup is linear in the index, which made this loop
+	 * quadratic in the number of matching elements. */
+	return libdom_treewalk_elements(node, &tag, 1,
+					imagemap_extract_entry, &ctx);
 }
 
 /**
@@ -587,106 +610,106 @@ static bool imagemap_extract_map(dom_node *node, html_content *c,
 		struct mapentry **entry)
 {
 	if (imagemap_extract_map_entries(node, c, entry,
-			corestring_dom_area) == false)
+			corestring_dom_area, corestring_lwc_area) == false)
 		return false;
 	return imagemap_extract_map_entries(node, c, entry,
-			corestring_dom_a);
+			corestring_dom_a, corestring_lwc_a);
 }
 
 /**
- * Extract all imagemaps from a document tree
+ * Context for extracting imagemaps from a document walk.
+ */
+struct imagemap_extract_ctx {
+	html_content *c;	/**< Content to extract imagemaps from */
+	nserror res;		/**< Result of the extraction */
+};
+
+/**
+ * Extract a single map element found in the document walk.
  *
- * \param c The content to extract imagemaps from.
- * \return false on memory exhaustion, true otherwise
+ * \param node  The map element
+ * \param ctxin The extraction context
+ * \return true to continue the walk, false on error
  */
-nserror
-imagemap_extract(html_content *c)
+static bool imagemap_extract_map_element(dom_node *node, void *ctxin)
 {
-	dom_nodelist *nlist;
+	struct imagemap_extract_ctx *ctx = ctxin;
+	dom_string *name;
 	dom_exception exc;
-	unsigned long mapnr;
-	uint32_t maybe_maps;
-	nserror ret = NSERROR_OK;
-
-	exc = dom_document_get_elements_by_tag_name(c->document,
-						    corestring_dom_map,
-						    &nlist);
-	if (exc != DOM_NO_ERR) {
-		return NSERROR_DOM;
-	}
 
-	exc = dom_nodelist_get_length(nlist, &maybe_maps);
+	exc = dom_element_get_attribute(node, corestring_dom_id, &name);
 	if (exc != DOM_NO_ERR) {
-		ret = NSERROR_DOM;
-		goto out_nlist;
+		ctx->res = NSERROR_DOM;
+		return false;
 	}
 
-	for (mapnr = 0; mapnr < maybe_maps; ++mapnr) {
-		dom_node *node;
-		dom_string *name;
-		exc = dom_nodelist_item(nlist, mapnr, &node);
-		if (exc != DOM_NO_ERR) {
-			ret = NSERROR_DOM;
-			goto out_nlist;
-		}
-
-		exc = dom_element_get_attribute(node, corestring_dom_id,
+	if (name == NULL) {
+		exc = dom_element_get_attribute(node, corestring_dom_name,
 						&name);
 		if (exc != DOM_NO_ERR) {
-			dom_node_unref(node);
-			ret = NSERROR_DOM;
-			goto out_nlist;
-		}
-
-		if (name == NULL) {
-			exc = dom_element_get_attribute(node,
-							corestring_dom_name,
-							&name);
-			if (exc != DOM_NO_ERR) {
-				dom_node_unref(node);
-				ret = NSERROR_DOM;
-				goto out_nlist;
-			}
+			ctx->res = NSERROR_DOM;
+			return false;
 		}
+	}
 
-		if (name != NULL) {
-			struct mapentry *entry = NULL;
-			if (imagemap_extract_map(node, c, &entry) == false) {
-				if (entry != NULL) {
-					imagemap_freelist(entry);
-				}
-
-				dom_string_unref(name);
-				dom_node_unref(node);
-				ret = NSERROR_NOMEM; /** @todo check this */
-				goto out_nlist;
+	if (name != NULL) {
+		struct mapentry *entry = NULL;
+		if (imagemap_extract_map(node, ctx->c, &entry) == false) {
+			if (entry != NULL) {
+				imagemap_freelist(entry);
 			}
 
-			/* imagemap_extract_map may not extract anything,
-			 * so entry can still be NULL here. This isn't an
-			 * error as it just means that we've encountered
-			 * an incorrectly defined <map>...</map> block
-			 */
-			if ((entry != NULL) &&
-			    (imagemap_add(c, name, entry) == false)) {
-				imagemap_freelist(entry);
+			dom_string_unref(name);
+			ctx->res = NSERROR_NOMEM; /** @todo check this */
+			return false;
+		}
 
-				dom_string_unref(name);
-				dom_node_unref(node);
-				ret = NSERROR_NOMEM; /** @todo check this */
-				goto out_nlist;
-			}
+		/* imagemap_extract_map may not extract anything,
+		 * so entry can still be NULL here. This isn't an
+		 * error as it just means that we've encountered
+		 * an incorrectly defined <map>...</map> block
+		 */
+		if ((entry != NULL) &&
+		    (imagemap_add(ctx->c, name, entry) == false)) {
+			imagemap_freelist(entry);
+
+			dom_string_unref(name);
+			ctx->res = NSERROR_NOMEM; /** @todo check this */
+			return false;
 		}
 
 		dom_string_unref(name);
-		dom_node_unref(node);
 	}
 
-out_nlist:
+	return true;
+}
 
-	dom_nodelist_unref(nlist);
+/**
+ * Extract all imagemaps from a document tree
+ *
+ * \param c The content to extract imagemaps from.
+ * \return false on memory exhaustion, true otherwise
+ */
+nserror
+imagemap_extract(html_content *c)
+{
+	struct imagemap_extract_ctx ctx = {
+		.c = c,
+		.res = NSERROR_OK,
+	};
+
+	if (libdom_treewalk_elements((dom_node *)c->document,
+				     &corestring_lwc_map, 1,
+				     imagemap_extract_map_element,
+				     &ctx) == false) {
+		/* distinguish callback failures from walk failures */
+		if (ctx.res == NSERROR_OK) {
+			ctx.res = NSERROR_DOM;
+		}
+		return ctx.res;
+	}
 
-	return ret;
+	return NSERROR_OK;
 }
 
 /**
@@ -722,6 +745,250 @@ imagemap_point_in_poly(int num, float *xpt, float *ypt, unsigned long x,
 	return c;
 }
 
+/**
+ * Test if a point lies within a map entry
+ *
+ * \param entry    The entry to test against
+ * \param x        The left edge of the containing box
+ * \param y        The top edge of the containing box
+ * \param click_x  The horizontal location of the click
+ * \param click_y  The vertical location of the click
+ * \return true if the point hits the entry's area
+ */
+static bool
+imagemap_entry_match(struct mapentry *entry,
+		unsigned long x, unsigned long y,
+		unsigned long click_x, unsigned long click_y)
+{
+	unsigned long cx, cy;
+
+	switch (entry->type) {
+	case IMAGEMAP_DEFAULT:
+		/* matches everywhere. no checks required */
+		return true;
+	case IMAGEMAP_RECT:
+		if (click_x >= x + entry->bounds.rect.x0 &&
+			    click_x <= x + entry->bounds.rect.x1 &&
+			    click_y >= y + entry->bounds.rect.y0 &&
+			    click_y <= y + entry->bounds.rect.y1) {
+			return true;
+		}
+		break;
+	case IMAGEMAP_CIRCLE:
+		cx = x + entry->bounds.circle.x - click_x;
+		cy = y + entry->bounds.circle.y - click_y;
+		if ((cx * cx + cy * cy) <=
+			(unsigned long) (entry->bounds.circle.r *
+				entry->bounds.circle.r)) {
+			return true;
+		}
+		break;
+	case IMAGEMAP_POLY:
+		if (imagemap_point_in_poly(entry->bounds.poly.num,
+				entry->bounds.poly.xcoords,
+				entry->bounds.poly.ycoords, x, y,
+				click_x, click_y)) {
+			return true;
+		}
+		break;
+	}
+
+	return false;
+}
+
+/**
+ * Find the bounding box of a map entry, in map coordinates
+ *
+ * Not meaningful for IMAGEMAP_DEFAULT entries, which cover everything.
+ *
+ * \param entry The entry to measure
+ * \param x0 Updated to the left edge
+ * \param y0 Updated to the top edge
+ * \param x1 Updated to the right edge
+ * \param y1 Updated to the bottom edge
+ */
+static void
+imagemap_entry_bbox(const struct mapentry *entry,
+		int *x0, int *y0, int *x1, int *y1)
+{
+	int vertex;
+
+	switch (entry->type) {
+	case IMAGEMAP_RECT:
+		*x0 = entry->bounds.rect.x0;
+		*y0 = entry->bounds.rect.y0;
+		*x1 = entry->bounds.rect.x1;
+		*y1 = entry->bounds.rect.y1;
+		break;
+	case IMAGEMAP_CIRCLE:
+		*x0 = entry->bounds.circle.x - entry->bounds.circle.r;
+		*y0 = entry->bounds.circle.y - entry->bounds.circle.r;
+		*x1 = entry->bounds.circle.x + entry->bounds.circle.r;
+		*y1 = entry->bounds.circle.y + entry->bounds.circle.r;
+		break;
+	case IMAGEMAP_POLY: {
+		float fx0, fy0, fx1, fy1;
+
+		fx0 = fx1 = entry->bounds.poly.xcoords[0];
+		fy0 = fy1 = entry->bounds.poly.ycoords[0];
+		for (vertex = 1; vertex < entry->bounds.poly.num; vertex++) {
+			if (entry->bounds.poly.xcoords[vertex] < fx0)
+				fx0 = entry->bounds.poly.xcoords[vertex];
+			if (entry->bounds.poly.xcoords[vertex] > fx1)
+				fx1 = entry->bounds.poly.xcoords[vertex];
+			if (entry->bounds.poly.ycoords[vertex] < fy0)
+				fy0 = entry->bounds.poly.ycoords[vertex];
+			if (entry->bounds.poly.ycoords[vertex] > fy1)
+				fy1 = entry->bounds.poly.ycoords[vertex];
+		}
+		/* pad out a pixel rather than trusting float truncation */
+		*x0 = (int) fx0 - 1;
+		*y0 = (int) fy0 - 1;
+		*x1 = (int) fx1 + 1;
+		*y1 = (int) fy1 + 1;
+		break;
+	}
+	default:
+		*x0 = *y0 = *x1 = *y1 = 0;
+		break;
+	}
+}
+
+/**
+ * Find the range of grid cells an entry's bounding box overlaps
+ *
+ * IMAGEMAP_DEFAULT entries overlap every cell, since they match
+ * everywhere and must keep their place in document order.
+ */
+static void
+imagemap_grid_range(const struct imagemap *map, const struct mapentry *entry,
+		int *c0, int *r0, int *c1, int *r1)
+{
+	int x0, y0, x1, y1;
+	int cw, ch;
+
+	if (entry->type == IMAGEMAP_DEFAULT) {
+		*c0 = *r0 = 0;
+		*c1 = *r1 = IMAGEMAP_GRID_DIM - 1;
+		return;
+	}
+
+	imagemap_entry_bbox(entry, &x0, &y0, &x1, &y1);
+
+	cw = (map->grid_x1 - map->grid_x0) / IMAGEMAP_GRID_DIM + 1;
+	ch = (map->grid_y1 - map->grid_y0) / IMAGEMAP_GRID_DIM + 1;
+
+	*c0 = (x0 - map->grid_x0) / cw;
+	*c1 = (x1 - map->grid_x0) / cw;
+	*r0 = (y0 - map->grid_y0) / ch;
+	*r1 = (y1 - map->grid_y0) / ch;
+
+	if (*c0 < 0) *c0 = 0;
+	if (*r0 < 0) *r0 = 0;
+	if (*c1 > IMAGEMAP_GRID_DIM - 1) *c1 = IMAGEMAP_GRID_DIM - 1;
+	if (*r1 > IMAGEMAP_GRID_DIM - 1) *r1 = IMAGEMAP_GRID_DIM - 1;
+}
+
+/**
+ * Build the spatial index for a map
+ *
+ * Small maps are left unindexed; walking a short list is cheaper
+ * than the grid.  Allocation failure also leaves the map unindexed,
+ * since queries fall back to the list walk.
+ *
+ * \param map The map to index
+ */
+static void imagemap_build_grid(struct imagemap *map)
+{
+	struct mapentry *entry;
+	unsigned int *counts;
+	struct mapentry **pool;
+	unsigned int nentries = 0;
+	unsigned int ncells = IMAGEMAP_GRID_DIM * IMAGEMAP_GRID_DIM;
+	unsigned int total = 0;
+	unsigned int cell;
+	bool extent_set = false;
+	int c0, r0, c1, r1, col, row;
+
+	for (entry = map->list; entry != NULL; entry = entry->next) {
+		int x0, y0, x1, y1;
+
+		nentries++;
+
+		if (entry->type == IMAGEMAP_DEFAULT)
+			continue;
+
+		imagemap_entry_bbox(entry, &x0, &y0, &x1, &y1);
+		if (extent_set == false) {
+			map->grid_x0 = x0;
+			map->grid_y0 = y0;
+			map->grid_x1 = x1;
+			map->grid_y1 = y1;
+			extent_set = true;
+		} else {
+			if (x0 < map->grid_x0) map->grid_x0 = x0;
+			if (y0 < map->grid_y0) map->grid_y0 = y0;
+			if (x1 > map->grid_x1) map->grid_x1 = x1;
+			if (y1 > map->grid_y1) map->grid_y1 = y1;
+		}
+	}
+
+	if (nentries < IMAGEMAP_GRID_MIN_ENTRIES || extent_set == false) {
+		return;
+	}
+
+	counts = calloc(ncells + 1, sizeof(*counts));
+	if (counts == NULL) {
+		return;
+	}
+
+	/* count the entries overlapping each cell */
+	for (entry = map->list; entry != NULL; entry = entry->next) {
+		imagemap_grid_range(map, entry, &c0, &r0, &c1, &r1);
+		for (row = r0; row <= r1; row++) {
+			for (col = c0; col <= c1; col++) {
+				counts[row * IMAGEMAP_GRID_DIM + col]++;
+			}
+		}
+	}
+
+	/* convert to cell start offsets */
+	for (cell = 0; cell < ncells; cell++) {
+		unsigned int count = counts[cell];
+		counts[cell] = total;
+		total += count;
+	}
+	counts[ncells] = total;
+
+	pool = malloc(total * sizeof(*pool));
+	if (pool == NULL) {
+		free(counts);
+		return;
+	}
+
+	/* place the entries; walking the list in document order keeps
+	 * each cell's run in document order, so the first hit found in
+	 * a cell is the one the list walk would have returned */
+	for (entry = map->list; entry != NULL; entry = entry->next) {
+		imagemap_grid_range(map, entry, &c0, &r0, &c1, &r1);
+		for (row = r0; row <= r1; row++) {
+			for (col = c0; col <= c1; col++) {
+				pool[counts[row * IMAGEMAP_GRID_DIM + col]++] =
+						entry;
+			}
+		}
+	}
+
+	/* restore the start offsets consumed while placing */
+	for (cell = ncells; cell > 0; cell--) {
+		counts[cell] = counts[cell - 1];
+	}
+	counts[0] = 0;
+
+	map->cell_start = counts;
+	map->cell_entries = pool;
+}
+
 /**
  * Retrieve url associated with imagemap entry
  *
@@ -742,7 +1009,6 @@ nsurl *imagemap_get(struct html_content *c, const char *key,
 	unsigned int slot = 0;
 	struct imagemap *map;
 	struct mapentry *entry;
-	unsigned long cx, cy;
 
 	assert(c != NULL);
 
@@ -762,45 +1028,64 @@ nsurl *imagemap_get(struct html_content *c, const char *key,
 	if (map == NULL || map->list == NULL)
 		return NULL;
 
-	for (entry = map->list; entry; entry = entry->next) {
-		switch (entry->type) {
-		case IMAGEMAP_DEFAULT:
-			/* just return the URL. no checks required */
-			if (target)
-				*target = entry->target;
-			return entry->url;
-			break;
-		case IMAGEMAP_RECT:
-			if (click_x >= x + entry->bounds.rect.x0 &&
-				    click_x <= x + entry->bounds.rect.x1 &&
-				    click_y >= y + entry->bounds.rect.y0 &&
-				    click_y <= y + entry->bounds.rect.y1) {
-				if (target)
-					*target = entry->target;
-				return entry->url;
-			}
-			break;
-		case IMAGEMAP_CIRCLE:
-			cx = x + entry->bounds.circle.x - click_x;
-			cy = y + entry->bounds.circle.y - click_y;
-			if ((cx * cx + cy * cy) <=
-				(unsigned long) (entry->bounds.circle.r *
-					entry->bounds.circle.r)) {
-				if (target)
-					*target = entry->target;
-				return entry->url;
+	if (map->grid_tried == false) {
+		imagemap_build_grid(map);
+		map->grid_tried = true;
+	}
+
+	if (map->cell_start != NULL) {
+		/* point query against the spatial index */
+		long px = (long) click_x - (long) x;
+		long py = (long) click_y - (long) y;
+		int cw = (map->grid_x1 - map->grid_x0) /
+				IMAGEMAP_GRID_DIM + 1;
+		int ch = (map->grid_y1 - map->grid_y0) /
+				IMAGEMAP_GRID_DIM + 1;
+		unsigned int cell, idx;
+
+		if (px < map->grid_x0 || px > map->grid_x1 ||
+		    py < map->grid_y0 || py > map->grid_y1) {
+			/* outside every area; only a default entry
+			 * can match */
+			for (entry = map->list; entry; entry = entry->next) {
+				if (entry->type == IMAGEMAP_DEFAULT) {
+					if (target)
+						*target = entry->target;
+					return entry->url;
+				}
 			}
-			break;
-		case IMAGEMAP_POLY:
-			if (imagemap_point_in_poly(entry->bounds.poly.num,
-					entry->bounds.poly.xcoords,
-					entry->bounds.poly.ycoords, x, y,
+
+			if (target)
+				*target = NULL;
+
+			return NULL;
+		}
+
+		cell = ((py - map->grid_y0) / ch) * IMAGEMAP_GRID_DIM +
+				((px - map->grid_x0) / cw);
+
+		for (idx = map->cell_start[cell];
+				idx < map->cell_start[cell + 1]; idx++) {
+			entry = map->cell_entries[idx];
+			if (imagemap_entry_match(entry, x, y,
 					click_x, click_y)) {
 				if (target)
 					*target = entry->target;
 				return entry->url;
 			}
-			break;
+		}
+
+		if (target)
+			*target = NULL;
+
+		return NULL;
+	}
+
+	for (entry = map->list; entry; entry = entry->next) {
+		if (imagemap_entry_match(entry, x, y, click_x, click_y)) {
+			if (target)
+				*target = entry->target;
+			return entry->url;
 		}
 	}
 
@@ -51,8 +51,10 @@
 #include "desktop/gui_internal.h"
 
 #include "html/box.h"
+#include "html/box_construct.h"
 #include "html/box_textarea.h"
 #include "html/box_inspect.h"
+#include "html/dom_event.h"
 #include "html/font.h"
 #include "html/form_internal.h"
 #include "html/private.h"
@@ -1321,6 +1323,158 @@ default_mouse_action(html_content *html,
 /**
  * handle non dragging mouse actions
  */
+/**
+ * Test whether an element is the hovered element or one of its ancestors
+ *
+ * \param node     Element to test
+ * \param hovered  The hovered element
+ * \return true iff \a node is hovered
+ */
+static bool hover_chain_contains(dom_node *node, dom_node *hovered)
+{
+	dom_node *cur;
+
+	cur = dom_node_ref(hovered);
+	while (cur != NULL) {
+		dom_node *parent;
+		dom_exception exc;
+
+		if (cur == node) {
+			dom_node_unref(cur);
+			return true;
+		}
+
+		exc = dom_node_get_parent_node(cur, &parent);
+		dom_node_unref(cur);
+		if (exc != DOM_NO_ERR)
+			return false;
+		cur = parent;
+	}
+
+	return false;
+}
+
+
+/**
+ * Find the subtree to restyle for one side of a hover transition.
+ *
+ * The hover state of \a n and each of its ancestors changes, except
+ * for those which are also in the other element's hover chain. The
+ * highest ancestor whose state changes covers, with its descendants,
+ * every element a :hover selector could answer differently for on
+ * this side of the transition.
+ *
+ * \param n      The old or new hovered element, or NULL
+ * \param other  The element hovered on the other side, or NULL
+ * \return The root of the subtree to restyle, referenced, or NULL
+ */
+static dom_node *hover_restyle_root(dom_node *n, dom_node *other)
+{
+	dom_node *top = NULL;
+	dom_node *cur;
+
+	if (n == NULL)
+		return NULL;
+
+	cur = dom_node_ref(n);
+	while (cur != NULL) {
+		dom_node *parent;
+		dom_exception exc;
+
+		if (other != NULL && hover_chain_contains(cur, other)) {
+			/* hovered in both chains; nothing above here
+			 * changes */
+			dom_node_unref(cur);
+			break;
+		}
+
+		if (top != NULL)
+			dom_node_unref(top);
+		top = cur;
+
+		exc = dom_node_get_parent_node(cur, &parent);
+		if (exc != DOM_NO_ERR)
+			break;
+		cur = parent;
+	}
+
+	return top;
+}
+
+
+/**
+ * Track the hovered element and restyle across hover transitions.
+ *
+ * Does nothing unless a stylesheet actually uses :hover. When the
+ * element under the pointer changes, only the chains whose hover
+ * state changed are restyled, so moving along a dense run of links
+ * re-selects a handful of elements rather than the document.
+ *
+ * \param html  The html content being interacted with
+ * \param node  The deepest DOM node under the pointer
+ */
+static void html_update_hover(html_content *html, dom_node *node)
+{
+	dom_node *element;
+	dom_node *old;
+	dom_node *top;
+	bool restyled = false;
+
+	if (html->styles_use_hover == false || html->layout == NULL)
+		return;
+
+	/* Find the nearest element above the node under the pointer */
+	element = dom_node_ref(node);
+	while (element != NULL) {
+		dom_node *parent;
+		dom_node_type type;
+		dom_exception exc;
+
+		exc = dom_node_get_node_type(element, &type);
+		if (exc != DOM_NO_ERR) {
+			dom_node_unref(element);
+			return;
+		}
+		if (type == DOM_ELEMENT_NODE)
+			break;
+
+		exc = dom_node_get_parent_node(element, &parent);
+		dom_node_unref(element);
+		if (exc != DOM_NO_ERR)
+			return;
+		element = parent;
+	}
+
+	if (element == html->hover_node) {
+		if (element != NULL)
+			dom_node_unref(element);
+		return;
+	}
+
+	old = html->hover_node;
+	html->hover_node = element;
+
+	top = hover_restyle_root(old, element);
+	if (top != NULL) {
+		restyled |= box_restyle(html, top);
+		dom_node_unref(top);
+	}
+
+	top = hover_restyle_root(element, old);
+	if (top != NULL) {
+		restyled |= box_restyle(html, top);
+		dom_node_unref(top);
+	}
+
+	if (old != NULL)
+		dom_node_unref(old);
+
+	if (restyled) {
+		html_schedule_restyle_reflow(html);
+	}
+}
+
+
 static nserror
 mouse_action_drag_none(html_content *html,
 		       struct browser_window *bw,
@@ -1344,6 +1498,8 @@ mouse_action_drag_none(html_content *html,
 		return res;
 	}
 
+	html_update_hover(html, mas.node);
+
 	if (mas.scroll.bar) {
 		mas.result.status = scrollbar_mouse_status_to_message(
 				scrollbar_mouse_action(mas.scroll.bar,
@@ -1611,6 +1767,9 @@ void html_overflow_scroll_callback(void *client_data,
 	switch(scrollbar_data->msg) {
 	case SCROLLBAR_MSG_MOVED:
 
+		/* scroll offsets feed cached absolute coordinates */
+		box_coords_invalidate();
+
 		if (html->reflowing == true) {
 			/* Can't redraw during layout, and it will
 			 * be redrawn after layout anyway. */
@@ -45,6 +45,7 @@
 
 #include "utils/log.h"
 #include "utils/talloc.h"
+#include "utils/trace.h"
 #include "utils/utils.h"
 #include "utils/nsoption.h"
 #include "utils/corestrings.h"
@@ -245,6 +246,72 @@ static int layout_text_indent(
 }
 
 
+/**
+ * Distribute the min/max widths of a cell spanning several columns
+ * over those columns' running constraints.
+ *
+ * \param cell box of type TABLE_CELL with colspan > 1
+ * \param col column constraint array for the containing table
+ * \param border_spacing_h horizontal border spacing of the table
+ */
+static void layout_minmax_spanned_cell(struct box *cell,
+		struct column *col,
+		int border_spacing_h)
+{
+	unsigned int flexible_columns = 0;
+	unsigned int i = cell->start_column;
+	unsigned int j;
+	int min = 0, max = 0, extra;
+
+	/* find min width so far of spanned columns, and count
+	 * the number of non-fixed spanned columns */
+	for (j = 0; j != cell->columns; j++) {
+		min += col[i + j].min;
+		if (col[i + j].type != COLUMN_WIDTH_FIXED)
+			flexible_columns++;
+	}
+	min += (cell->columns - 1) * border_spacing_h;
+
+	/* distribute extra min to spanned columns */
+	if (min < cell->min_width) {
+		if (flexible_columns == 0) {
+			extra = 1 + (cell->min_width - min) /
+					cell->columns;
+			for (j = 0; j != cell->columns; j++) {
+				col[i + j].min += extra;
+				if (col[i + j].max < col[i + j].min)
+					col[i + j].max = col[i + j].min;
+			}
+		} else {
+			extra = 1 + (cell->min_width - min) /
+					flexible_columns;
+			for (j = 0; j != cell->columns; j++) {
+				if (col[i + j].type !=
+						COLUMN_WIDTH_FIXED) {
+					col[i + j].min += extra;
+					if (col[i + j].max <
+							col[i + j].min)
+						col[i + j].max =
+							col[i + j].min;
+				}
+			}
+		}
+	}
+
+	/* find max width so far of spanned columns */
+	for (j = 0; j != cell->columns; j++)
+		max += col[i + j].max;
+	max += (cell->columns - 1) * border_spacing_h;
+
+	/* distribute extra max to spanned columns */
+	if (max < cell->max_width && flexible_columns) {
+		extra = 1 + (cell->max_width - max) / flexible_columns;
+		for (j = 0; j != cell->columns; j++)
+			if (col[i + j].type != COLUMN_WIDTH_FIXED)
+				col[i + j].max += extra;
+	}
+}
+
 /**
  * Calculate minimum and maximum width of a table.
  *
@@ -258,7 +325,7 @@ static void layout_minmax_table(struct box *table,
 		const struct gui_layout_table *font_func,
 		const html_content *content)
 {
-	unsigned int i, j;
+	unsigned int i;
 	int width;
 	int border_spacing_h = 0;
 	int table_min = 0, table_max = 0;
@@ -266,12 +333,16 @@ static void layout_minmax_table(struct box *table,
 	float extra_frac = 0;
 	struct column *col;
 	struct box *row_group, *row, *cell;
+	struct box **spans = NULL;
+	unsigned int spans_used = 0, spans_alloc = 0;
+	bool spans_overflowed = false;
 
 	/* check if the widths have already been calculated */
 	if (table->max_width != UNKNOWN_MAX_WIDTH)
 		return;
 
-	if (table_calculate_column_types(&content->unit_len_ctx, table) == false) {
+	if (table_calculate_column_types(&content->unit_len_ctx,
+			content->bctx, table) == false) {
 		NSLOG(netsurf, ERROR,
 				"Could not establish table column types.");
 		return;
@@ -300,7 +371,9 @@ static void layout_minmax_table(struct box *table,
 				h, hu));
 	}
 
-	/* 1st pass: consider cells with colspan 1 only */
+	/* Single pass over the cells: accumulate the running min/max of
+	 * each column from colspan 1 cells, and note the cells spanning
+	 * several columns for the distribution phase below */
 	for (row_group = table->children; row_group; row_group =row_group->next)
 	for (row = row_group->children; row; row = row->next)
 	for (cell = row->children; cell; cell = cell->next) {
@@ -310,10 +383,29 @@ static void layout_minmax_table(struct box *table,
 		 *        It's currently converted to 1 in box normaisation */
 		assert(cell->columns != 0);
 
-		if (cell->columns != 1)
+		layout_minmax_block(cell, font_func, content);
+
+		if (cell->columns != 1) {
+			/* spanning cells are distributed once all the
+			 * colspan 1 constraints are known */
+			if (spans_used == spans_alloc &&
+					spans_overflowed == false) {
+				unsigned int n = spans_alloc ?
+						spans_alloc * 2 : 16;
+				struct box **s = realloc(spans,
+						n * sizeof(*spans));
+				if (s == NULL)
+					spans_overflowed = true;
+				else {
+					spans = s;
+					spans_alloc = n;
+				}
+			}
+			if (spans_overflowed == false)
+				spans[spans_used++] = cell;
 			continue;
+		}
 
-		layout_minmax_block(cell, font_func, content);
 		i = cell->start_column;
 
 		if (col[i].positioned)
@@ -326,69 +418,24 @@ static void layout_minmax_table(struct box *table,
 			col[i].max = cell->max_width;
 	}
 
-	/* 2nd pass: cells which span multiple columns */
-	for (row_group = table->children; row_group; row_group =row_group->next)
-	for (row = row_group->children; row; row = row->next)
-	for (cell = row->children; cell; cell = cell->next) {
-		unsigned int flexible_columns = 0;
-		int min = 0, max = 0, fixed_width = 0, extra;
-
-		if (cell->columns == 1)
-			continue;
-
-		layout_minmax_block(cell, font_func, content);
-		i = cell->start_column;
-
-		/* find min width so far of spanned columns, and count
-		 * number of non-fixed spanned columns and total fixed width */
-		for (j = 0; j != cell->columns; j++) {
-			min += col[i + j].min;
-			if (col[i + j].type == COLUMN_WIDTH_FIXED)
-				fixed_width += col[i + j].width;
-			else
-				flexible_columns++;
-		}
-		min += (cell->columns - 1) * border_spacing_h;
-
-		/* distribute extra min to spanned columns */
-		if (min < cell->min_width) {
-			if (flexible_columns == 0) {
-				extra = 1 + (cell->min_width - min) /
-						cell->columns;
-				for (j = 0; j != cell->columns; j++) {
-					col[i + j].min += extra;
-					if (col[i + j].max < col[i + j].min)
-						col[i + j].max = col[i + j].min;
-				}
-			} else {
-				extra = 1 + (cell->min_width - min) /
-						flexible_columns;
-				for (j = 0; j != cell->columns; j++) {
-					if (col[i + j].type !=
-							COLUMN_WIDTH_FIXED) {
-						col[i + j].min += extra;
-						if (col[i + j].max <
-								col[i + j].min)
-							col[i + j].max =
-								col[i + j].min;
-					}
-				}
-			}
-		}
-
-		/* find max width so far of spanned columns */
-		for (j = 0; j != cell->columns; j++)
-			max += col[i + j].max;
-		max += (cell->columns - 1) * border_spacing_h;
-
-		/* distribute extra max to spanned columns */
-		if (max < cell->max_width && flexible_columns) {
-			extra = 1 + (cell->max_width - max) / flexible_columns;
-			for (j = 0; j != cell->columns; j++)
-				if (col[i + j].type != COLUMN_WIDTH_FIXED)
-					col[i + j].max += extra;
+	/* Distribution phase: cells which span multiple columns. Each
+	 * cell must be considered exactly once, so if the note taking
+	 * above ran out of memory fall back to re-walking the table. */
+	if (spans_overflowed) {
+		for (row_group = table->children; row_group;
+				row_group = row_group->next)
+		for (row = row_group->children; row; row = row->next)
+		for (cell = row->children; cell; cell = cell->next) {
+			if (cell->columns != 1)
+				layout_minmax_spanned_cell(cell, col,
+						border_spacing_h);
 		}
+	} else {
+		for (i = 0; i != spans_used; i++)
+			layout_minmax_spanned_cell(spans[i], col,
+					border_spacing_h);
 	}
+	free(spans);
 
 	for (i = 0; i != table->columns; i++) {
 		if (col[i].max < col[i].min) {
@@ -562,7 +609,7 @@ layout_minmax_line(struct box *first,
 
 			if (b->next) {
 				if (b->space == UNKNOWN_WIDTH) {
-					font_func->width(&fstyle, " ", 1,
+					font_width_measure(font_func, &fstyle, " ", 1,
 							 &b->space);
 				}
 				max += b->space;
@@ -598,7 +645,7 @@ layout_minmax_line(struct box *first,
 							data.select.items; o;
 							o = o->next) {
 						int opt_width;
-						font_func->width(&fstyle,
+						font_width_measure(font_func, &fstyle,
 								o->text,
 								strlen(o->text),
 								&opt_width);
@@ -612,7 +659,7 @@ layout_minmax_line(struct box *first,
 						b->width += SCROLLBAR_WIDTH;
 
 				} else {
-					font_func->width(&fstyle, b->text,
+					font_width_measure(font_func, &fstyle, b->text,
 						b->length, &b->width);
 					b->flags |= MEASURED;
 				}
@@ -620,7 +667,7 @@ layout_minmax_line(struct box *first,
 			max += b->width;
 			if (b->next) {
 				if (b->space == UNKNOWN_WIDTH) {
-					font_func->width(&fstyle, " ", 1,
+					font_width_measure(font_func, &fstyle, " ", 1,
 							 &b->space);
 				}
 				max += b->space;
@@ -640,19 +687,29 @@ layout_minmax_line(struct box *first,
 			} else if (b->parent->flags & NEED_MIN) {
 				/* If we care what the minimum width is,
 				 * calculate it.  (It's only needed if we're
-				 * shrinking-to-fit.) */
-				/* min = widest single word */
-				i = 0;
-				do {
-					for (j = i; j != b->length &&
-							b->text[j] != ' '; j++)
-						;
-					font_func->width(&fstyle, b->text + i,
-							 j - i, &width);
-					if (min < width)
-						min = width;
-					i = j + 1;
-				} while (j != b->length);
+				 * shrinking-to-fit.)  The result only changes
+				 * if the text is altered, so keep it on the
+				 * box across reflows. */
+				if (!(b->flags & MIN_MEASURED)) {
+					/* min = widest single word */
+					b->min_width = 0;
+					i = 0;
+					do {
+						for (j = i; j != b->length &&
+								b->text[j] !=
+								' '; j++)
+							;
+						font_width_measure(font_func, &fstyle,
+								b->text + i,
+								j - i, &width);
+						if (b->min_width < width)
+							b->min_width = width;
+						i = j + 1;
+					} while (j != b->length);
+					b->flags |= MIN_MEASURED;
+				}
+				if (min < b->min_width)
+					min = b->min_width;
 			}
 
 			*line_has_height = true;
@@ -1625,6 +1682,31 @@ bool layout_table(
 	assert(table->children && table->children->children);
 	assert(columns);
 
+	htype = css_computed_height(style, &value, &unit);
+	if ((table->flags & LAYOUT_VALID) &&
+			available_width == table->cached_avail_width &&
+			(htype != CSS_HEIGHT_SET || unit != CSS_UNIT_PCT)) {
+		/* Nothing inside the table has changed and it is being laid
+		 * out to the same available width, so the previous layout
+		 * stands. Tables are independent formatting contexts, so
+		 * everything below the table box can be carried over.
+		 * Percentage height tables are excluded as they depend on
+		 * the containing block height too. */
+		NSLOG(layout, DEBUG, "table %p: reusing layout", table);
+		/* Restore the style margins; the caller resolves any AUTO
+		 * margins afresh each time it positions the table. */
+		layout_find_dimensions(&content->unit_len_ctx,
+				available_width, -1, table, style,
+				0, 0, 0, 0, 0, 0,
+				table->margin, table->padding, table->border);
+		if (table->margin[TOP] == AUTO)
+			table->margin[TOP] = 0;
+		if (table->margin[BOTTOM] == AUTO)
+			table->margin[BOTTOM] = 0;
+		table->flags |= LAYOUT_REUSED;
+		return true;
+	}
+
 	/* allocate working buffers */
 	col = malloc(columns * sizeof col[0]);
 	excess_y = malloc(columns * sizeof excess_y[0]);
@@ -2142,6 +2224,12 @@ bool layout_table(
 	table->width = table_width;
 	table->height = table_height;
 
+	/* This layout may be reused while the available width and the
+	 * table's contents are unchanged. */
+	table->cached_avail_width = available_width;
+	table->flags |= LAYOUT_VALID;
+	table->flags &= ~LAYOUT_REUSED;
+
 	return true;
 }
 
@@ -2362,7 +2450,7 @@ layout_text_box_split(html_content *content,
 		/* We're need to add a space, and we don't know how big
 		 * it's to be, OR we have a space of unknown width anyway;
 		 * Calculate space width */
-		font_func->width(fstyle, " ", 1, &space_width);
+		font_width_measure(font_func, fstyle, " ", 1, &space_width);
 	}
 
 	if (split_box->space == UNKNOWN_WIDTH)
@@ -2381,12 +2469,15 @@ layout_text_box_split(html_content *content,
 
 	/* Set c2 according to the remaining text */
 	c2->width -= new_width + space_width;
-	c2->flags &= ~MEASURED; /* width has been estimated */
+	c2->flags &= ~(MEASURED | MIN_MEASURED); /* widths now estimated */
+	c2->flags &= ~(BREAK_SCANNED | HAS_BREAK); /* remaining text differs */
 	c2->length = split_box->length - used_length;
 
 	/* Update split_box for its reduced text */
 	split_box->width = new_width;
 	split_box->flags |= MEASURED;
+	split_box->flags &= ~MIN_MEASURED; /* text changed; remeasure min */
+	split_box->flags &= ~(BREAK_SCANNED | HAS_BREAK); /* text changed */
 	split_box->length = new_length;
 	split_box->space = space_width;
 
@@ -2843,7 +2934,7 @@ layout_line(struct box *first,
 		} else if (b->type == BOX_INLINE_END) {
 			b->width = 0;
 			if (b->space == UNKNOWN_WIDTH) {
-				font_func->width(&fstyle, " ", 1, &b->space);
+				font_width_measure(font_func, &fstyle, " ", 1, &b->space);
 				/** \todo handle errors */
 			}
 			space_after = b->space;
@@ -2882,7 +2973,7 @@ layout_line(struct box *first,
 							data.select.items; o;
 							o = o->next) {
 						int opt_width;
-						font_func->width(&fstyle,
+						font_width_measure(font_func, &fstyle,
 								o->text,
 								strlen(o->text),
 								&opt_width);
@@ -2894,7 +2985,7 @@ layout_line(struct box *first,
 					if (nsoption_bool(core_select_menu))
 						b->width += SCROLLBAR_WIDTH;
 				} else {
-					font_func->width(&fstyle, b->text,
+					font_width_measure(font_func, &fstyle, b->text,
 							b->length, &b->width);
 					b->flags |= MEASURED;
 				}
@@ -2907,14 +2998,14 @@ layout_line(struct box *first,
 			if (b->text && (x + b->width < x1 - x0) &&
 					!(b->flags & MEASURED) &&
 					b->next) {
-				font_func->width(&fstyle, b->text,
+				font_width_measure(font_func, &fstyle, b->text,
 						 b->length, &b->width);
 				b->flags |= MEASURED;
 			}
 
 			x += b->width;
 			if (b->space == UNKNOWN_WIDTH) {
-				font_func->width(&fstyle, " ", 1, &b->space);
+				font_width_measure(font_func, &fstyle, " ", 1, &b->space);
 				/** \todo handle errors */
 			}
 			space_after = b->space;
@@ -3050,7 +3141,7 @@ layout_line(struct box *first,
 							&content->unit_len_ctx,
 							b->style, &fstyle);
 					/** \todo handle errors */
-					font_func->width(&fstyle, " ", 1,
+					font_width_measure(font_func, &fstyle, " ", 1,
 							 &b->space);
 				}
 				space_after = b->space;
@@ -3201,15 +3292,30 @@ layout_line(struct box *first,
 		    !(split_box->flags & IFRAME) &&
 		    !split_box->gadget && split_box->text) {
 
-			font_plot_style_from_css(&content->unit_len_ctx,
-					split_box->style, &fstyle);
-			/** \todo handle errors */
-			font_func->split(&fstyle,
-					 split_box->text,
-					 split_box->length,
-					 x1 - x0 - x - space_before,
-					 &split,
-					 &w);
+			/* Check whether the text has a break opportunity at
+			 * all. The result is kept on the box so further
+			 * reflows skip both the scan and the split call. */
+			if (!(split_box->flags & BREAK_SCANNED)) {
+				if (memchr(split_box->text, ' ',
+						split_box->length) != NULL)
+					split_box->flags |= HAS_BREAK;
+				else
+					split_box->flags &= ~HAS_BREAK;
+				split_box->flags |= BREAK_SCANNED;
+			}
+
+			if (split_box->flags & HAS_BREAK) {
+				font_plot_style_from_css(
+						&content->unit_len_ctx,
+						split_box->style, &fstyle);
+				/** \todo handle errors */
+				font_func->split(&fstyle,
+						 split_box->text,
+						 split_box->length,
+						 x1 - x0 - x - space_before,
+						 &split,
+						 &w);
+			}
 		}
 
 		/* split == 0 implies that text can't be split */
@@ -3516,11 +3622,15 @@ bool layout_block_context(
 	int max_neg_margin = 0;
 	int y = 0;
 	int lm, rm;
+	int prev_width = UNKNOWN_WIDTH;  /**< box width from previous layout */
+	int prev_height = AUTO;  /**< box height from previous layout */
 	struct box *margin_collapse = NULL;
 	bool in_margin = false;
 	css_fixed gadget_size;
 	css_unit gadget_unit; /* Checkbox / radio buttons */
 
+	NSTRACE(NSTRACE_LAYOUT, "layout_block_context", block);
+
 	assert(block->type == BOX_BLOCK ||
 			block->type == BOX_INLINE_BLOCK ||
 			block->type == BOX_TABLE_CELL ||
@@ -3675,6 +3785,8 @@ bool layout_block_context(
 						box->parent->padding[RIGHT] -
 						x1;
 			}
+			prev_width = box->width;
+			prev_height = box->height;
 			layout_block_find_dimensions(&content->unit_len_ctx,
 					box->parent->width,
 					viewport_height, lm, rm, box);
@@ -3765,10 +3877,27 @@ bool layout_block_context(
 				 (overflow_x != CSS_OVERFLOW_VISIBLE ||
 				  overflow_y != CSS_OVERFLOW_VISIBLE))) {
 
-			if (box->type == BOX_FLEX) {
+			if ((box->flags & LAYOUT_VALID) &&
+					box->width == prev_width &&
+					box->object == NULL &&
+					box->gadget == NULL &&
+					!(box->flags & (IFRAME | REPLACE_DIM))) {
+				/* Neither the available width nor anything
+				 * inside this formatting context has changed
+				 * since it was last laid out, so the geometry
+				 * of the whole subtree can be kept. */
+				NSLOG(layout, DEBUG,
+						"box %p: reusing subtree layout",
+						box);
+				if (box->height == AUTO)
+					box->height = prev_height;
+				box->flags |= LAYOUT_REUSED;
+			} else if (box->type == BOX_FLEX) {
 				if (!layout_flex(box, box->width, content)) {
 					return false;
 				}
+				box->flags |= LAYOUT_VALID;
+				box->flags &= ~LAYOUT_REUSED;
 			} else {
 				layout_block_context(box,
 						viewport_height, content);
@@ -4004,6 +4133,11 @@ bool layout_block_context(
 				block->padding[BOTTOM], block->padding[LEFT]);
 	}
 
+	/* This context was laid out afresh; it may be reused by subsequent
+	 * layouts until something inside it is changed. */
+	block->flags |= LAYOUT_VALID;
+	block->flags &= ~LAYOUT_REUSED;
+
 	return true;
 }
 
@@ -4426,7 +4560,7 @@ layout_lists(const html_content *content, struct box *box)
 							&content->unit_len_ctx,
 							marker->style,
 							&fstyle);
-					content->font_func->width(&fstyle,
+					font_width_measure(content->font_func, &fstyle,
 							marker->text,
 							marker->length,
 							&marker->width);
@@ -5154,8 +5288,12 @@ layout_position_relative(
 			fny = fy + y;
 		}
 
-		/* recurse first */
-		layout_position_relative(unit_len_ctx, box, fn, fnx, fny);
+		/* recurse first, unless the subtree kept its geometry from a
+		 * previous layout, in which case any relative offsets inside
+		 * it are already applied */
+		if (!(box->flags & LAYOUT_REUSED))
+			layout_position_relative(unit_len_ctx, box, fn, fnx,
+					fny);
 
 		/* Ignore things we're not interested in. */
 		if (!box->style || (box->style &&
@@ -5403,6 +5541,17 @@ bool layout_document(html_content *content, int width, int height)
 			width, height, nsurl_access(content_get_url(
 					&content->base)));
 
+	if ((doc->flags & LAYOUT_VALID) &&
+			width == content->last_layout_width &&
+			height == content->last_layout_height) {
+		/* Nothing in the box tree has changed since it was last laid
+		 * out to this size, so the existing layout is still valid. */
+		NSLOG(layout, DEBUG, "Reusing previous layout");
+		return true;
+	}
+	content->last_layout_width = width;
+	content->last_layout_height = height;
+
 	layout_minmax_block(doc, font_func, content);
 
 	layout_block_find_dimensions(&content->unit_len_ctx,
@@ -42,4 +42,11 @@ struct gui_layout_table;
  */
 bool layout_document(struct html_content *content, int width, int height);
 
+/**
+ * Destroy a flex layout context retained on a box.
+ *
+ * \param flex_ctx retained context from box->flex_ctx, may be NULL
+ */
+void layout_flex_ctx_destroy(void *flex_ctx);
+
 #endif
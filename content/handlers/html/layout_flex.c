@@ -40,6 +40,7 @@
 #include "html/html.h"
 #include "html/private.h"
 #include "html/box_inspect.h"
+#include "html/layout.h"
 #include "html/layout_internal.h"
 
 /**
@@ -130,37 +131,66 @@ static void layout_flex_ctx__destroy(struct flex_ctx *ctx)
 	}
 }
 
+/* exported function documented in html/layout.h */
+void layout_flex_ctx_destroy(void *flex_ctx)
+{
+	layout_flex_ctx__destroy(flex_ctx);
+}
+
 /**
- * Create a flex layout context
+ * Obtain a flex layout context for a container
+ *
+ * A context retained on the box by a previous layout is reused when the
+ * item count is unchanged, so resize-driven reflows avoid rebuilding the
+ * item and line arrays. Otherwise a fresh context is created and retained
+ * on the box; it is freed with the box's other resources.
  *
  * \param[in] content  HTML content containing flex box
- * \param[in] flex     Box to create layout context for
+ * \param[in] flex     Box to obtain layout context for
  * \return flex layout context or NULL on error
  */
-static struct flex_ctx *layout_flex_ctx__create(
+static struct flex_ctx *layout_flex_ctx__obtain(
 		html_content *content,
-		const struct box *flex)
+		struct box *flex)
 {
-	struct flex_ctx *ctx;
+	struct flex_ctx *ctx = flex->flex_ctx;
+	size_t item_count = box_count_children(flex);
+
+	if (ctx != NULL && ctx->item.count == item_count) {
+		/* Reset the derived state; the array storage is kept */
+		memset(ctx->item.data, 0,
+				ctx->item.count * sizeof(*ctx->item.data));
+		memset(ctx->line.data, 0,
+				ctx->line.alloc * sizeof(*ctx->line.data));
+		ctx->line.count = 0;
+		ctx->main_size = 0;
+		ctx->cross_size = 0;
+	} else {
+		layout_flex_ctx__destroy(ctx);
+		flex->flex_ctx = NULL;
 
-	ctx = calloc(1, sizeof(*ctx));
-	if (ctx == NULL) {
-		return NULL;
-	}
-	ctx->line.alloc = 1;
+		ctx = calloc(1, sizeof(*ctx));
+		if (ctx == NULL) {
+			return NULL;
+		}
+		ctx->line.alloc = 1;
+
+		ctx->item.count = item_count;
+		ctx->item.data = calloc(ctx->item.count,
+				sizeof(*ctx->item.data));
+		if (ctx->item.data == NULL) {
+			layout_flex_ctx__destroy(ctx);
+			return NULL;
+		}
 
-	ctx->item.count = box_count_children(flex);
-	ctx->item.data = calloc(ctx->item.count, sizeof(*ctx->item.data));
-	if (ctx->item.data == NULL) {
-		layout_flex_ctx__destroy(ctx);
-		return NULL;
-	}
+		ctx->line.data = calloc(ctx->line.alloc,
+				sizeof(*ctx->line.data));
+		if (ctx->line.data == NULL) {
+			layout_flex_ctx__destroy(ctx);
+			return NULL;
+		}
 
-	ctx->line.alloc = 1;
-	ctx->line.data = calloc(ctx->line.alloc, sizeof(*ctx->line.data));
-	if (ctx->line.data == NULL) {
-		layout_flex_ctx__destroy(ctx);
-		return NULL;
+		flex->flex_ctx = ctx;
 	}
 
 	ctx->flex = flex;
@@ -1050,7 +1080,7 @@ bool layout_flex(struct box *flex, int available_width,
 	struct flex_ctx *ctx;
 	bool success = false;
 
-	ctx = layout_flex_ctx__create(content, flex);
+	ctx = layout_flex_ctx__obtain(content, flex);
 	if (ctx == NULL) {
 		return false;
 	}
@@ -1108,8 +1138,7 @@ bool layout_flex(struct box *flex, int available_width,
 	success = true;
 
 cleanup:
-	layout_flex_ctx__destroy(ctx);
-
+	/* The context stays retained on the box for the next reflow */
 	NSLOG(flex, DEEPDEBUG, "box %p: %s: w: %i, h: %i", flex,
 			success ? "success" : "failure",
 			flex->width, flex->height);
@@ -35,6 +35,7 @@
 #include "utils/nsoption.h"
 #include "netsurf/content.h"
 #include "netsurf/misc.h"
+#include "content/fetch.h"
 #include "content/hlcache.h"
 #include "css/utils.h"
 #include "desktop/scrollbar.h"
@@ -113,9 +114,11 @@ html_object_done(struct box *box,
 	}
 
 	if (!(box->flags & REPLACE_DIM)) {
-		/* invalidate parent min, max widths */
-		for (b = box; b; b = b->parent)
+		/* invalidate parent min, max widths and cached layout */
+		for (b = box; b; b = b->parent) {
 			b->max_width = UNKNOWN_MAX_WIDTH;
+			b->flags &= ~LAYOUT_VALID;
+		}
 
 		/* delete any clones of this box */
 		while (box->next && (box->next->flags & CLONE)) {
@@ -154,6 +157,24 @@ html_object_nobox_callback(hlcache_handle *object,
 /**
  * Callback for hlcache_handle_retrieve() for objects with a box.
  */
+/**
+ * Scheduler callback for a reflow deferred by the reformat rate limit.
+ *
+ * \param p html content to reflow
+ */
+static void html_object_deferred_reflow(void *p)
+{
+	html_content *c = p;
+
+	if (c->base.status == CONTENT_STATUS_READY ||
+			c->base.status == CONTENT_STATUS_DONE) {
+		content__reformat(&c->base,
+				  false,
+				  c->base.available_width,
+				  c->base.available_height);
+	}
+}
+
 static nserror
 html_object_callback(hlcache_handle *object,
 		     const hlcache_event *event,
@@ -324,23 +345,31 @@ html_object_callback(hlcache_handle *object,
 				if (w != 0 && box->width != w) {
 					/* Not showing image at intrinsic
 					 * width; need to scale the redraw
-					 * request area. */
+					 * request area. Round the far edge
+					 * up so the scaled rect covers all
+					 * damaged pixels. */
+					int x1 = ((data.redraw.x +
+							data.redraw.width) *
+							box->width + w - 1) / w;
+
 					data.redraw.x = data.redraw.x *
 							box->width / w;
-					data.redraw.width =
-							data.redraw.width *
-							box->width / w;
+					data.redraw.width = x1 - data.redraw.x;
 				}
 
-				if (h != 0 && box->height != w) {
+				if (h != 0 && box->height != h) {
 					/* Not showing image at intrinsic
 					 * height; need to scale the redraw
-					 * request area. */
+					 * request area. Round the far edge
+					 * up so the scaled rect covers all
+					 * damaged pixels. */
+					int y1 = ((data.redraw.y +
+							data.redraw.height) *
+							box->height + h - 1) / h;
+
 					data.redraw.y = data.redraw.y *
 							box->height / h;
-					data.redraw.height =
-							data.redraw.height *
-							box->height / h;
+					data.redraw.height = y1 - data.redraw.y;
 				}
 
 				data.redraw.x += x + box->padding[LEFT];
@@ -506,6 +535,17 @@ html_object_callback(hlcache_handle *object,
 					  false,
 					  c->base.available_width,
 					  c->base.available_height);
+		} else {
+			/* Too soon after the last reflow; run this one
+			 *  from the scheduler once the rate limit
+			 *  allows, so the object is still displayed if
+			 *  no further fetch event prompts a reformat.
+			 *  Rescheduling replaces any pending callback,
+			 *  so at most one deferred reflow is queued.
+			 */
+			guit->misc->schedule(
+				(int)(c->base.reformat_time - ms_now),
+				html_object_deferred_reflow, c);
 		}
 	}
 
@@ -550,7 +590,9 @@ static bool html_replace_object(struct content_html_object *object, nsurl *url)
 	}
 
 	/* initialise fetch */
-	error = hlcache_handle_retrieve(url, HLCACHE_RETRIEVE_SNIFF_TYPE,
+	error = hlcache_handle_retrieve(url,
+			HLCACHE_RETRIEVE_SNIFF_TYPE |
+			LLCACHE_RETRIEVE_PRIORITY(FETCH_PRIORITY_IMG),
 			content_get_url(&c->base), NULL,
 			html_object_callback, object, &child,
 			object->permitted_types,
@@ -686,6 +728,8 @@ nserror html_object_close_objects(html_content *html)
 /* exported interface documented in html/object.h */
 nserror html_object_free_objects(html_content *html)
 {
+	guit->misc->schedule(-1, html_object_deferred_reflow, html);
+
 	while (html->object_list != NULL) {
 		struct content_html_object *victim = html->object_list;
 
@@ -698,6 +742,10 @@ nserror html_object_free_objects(html_content *html)
 			hlcache_handle_release(victim->content);
 		}
 
+		if (victim->deferred_url != NULL) {
+			nsurl_unref(victim->deferred_url);
+		}
+
 		html->object_list = victim->next;
 		free(victim);
 	}
@@ -743,8 +791,28 @@ html_fetch_object(html_content *c,
 	object->permitted_types = permitted_types;
 	object->background = background;
 
+	/* viewport aware lazy loading: the fetch of a pure image
+	 * object in the flow is deferred until its box nears the
+	 * visible area, which html_object_lazy_load() decides as the
+	 * page is redrawn
+	 */
+	if (nsoption_bool(lazy_image_loading) &&
+	    (box != NULL) &&
+	    (background == false) &&
+	    (permitted_types == CONTENT_IMAGE)) {
+		object->deferred_url = nsurl_ref(url);
+
+		object->next = c->object_list;
+		c->object_list = object;
+		c->num_objects++;
+
+		return true;
+	}
+
 	error = hlcache_handle_retrieve(url,
-					HLCACHE_RETRIEVE_SNIFF_TYPE,
+					HLCACHE_RETRIEVE_SNIFF_TYPE |
+					LLCACHE_RETRIEVE_PRIORITY(
+						FETCH_PRIORITY_IMG),
 					content_get_url(&c->base),
 					NULL,
 					object_callback,
@@ -769,3 +837,62 @@ html_fetch_object(html_content *c,
 
 	return true;
 }
+
+
+/* exported interface documented in html/object.h */
+nserror html_object_lazy_load(struct html_content *c, int y0, int y1)
+{
+	struct content_html_object *object;
+	hlcache_child_context child;
+	nsurl *url;
+	nserror error;
+	int margin;
+	int x, y;
+
+	/* once the content is aborted no further fetches are wanted */
+	if (c->aborted) {
+		return NSERROR_OK;
+	}
+
+	child.charset = c->encoding;
+	child.quirks = c->base.quirks;
+
+	margin = nsoption_int(lazy_load_margin);
+
+	for (object = c->object_list; object != NULL; object = object->next) {
+		if (object->deferred_url == NULL) {
+			continue;
+		}
+
+		box_coords(object->box, &x, &y);
+		if ((y > (y1 + margin)) ||
+		    ((y + object->box->height) < (y0 - margin))) {
+			/* box remains comfortably outside the viewport */
+			continue;
+		}
+
+		url = object->deferred_url;
+		object->deferred_url = NULL;
+
+		error = hlcache_handle_retrieve(url,
+						HLCACHE_RETRIEVE_SNIFF_TYPE |
+						LLCACHE_RETRIEVE_PRIORITY(
+							FETCH_PRIORITY_IMG),
+						content_get_url(&c->base),
+						NULL,
+						html_object_callback,
+						object,
+						&child,
+						object->permitted_types,
+						&object->content);
+		nsurl_unref(url);
+		if (error != NSERROR_OK) {
+			return error;
+		}
+
+		c->base.active++;
+		NSLOG(netsurf, INFO, "%d fetches active", c->base.active);
+	}
+
+	return NSERROR_OK;
+}
@@ -83,4 +83,20 @@ nserror html_object_open_objects(struct html_content *html, struct browser_windo
  */
 nserror html_object_abort_objects(struct html_content *html);
 
+
+/**
+ * start fetches for deferred objects near the visible area.
+ *
+ * When the lazy_image_loading option is set image object fetches are
+ *  deferred by html_fetch_object() until the containing box comes
+ *  within lazy_load_margin pixels of the visible vertical slice of
+ *  the document, which the redraw path reports here.
+ *
+ * \param c content of type CONTENT_HTML
+ * \param y0 top of the visible slice in document coordinates
+ * \param y1 bottom of the visible slice in document coordinates
+ * \return NSERROR_OK on success else appropriate error code.
+ */
+nserror html_object_lazy_load(struct html_content *c, int y0, int y1);
+
 #endif
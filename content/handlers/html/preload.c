@@ -0,0 +1,379 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * HTML speculative preload scanner.
+ *
+ * A deliberately small tokenizer that runs over each incoming source
+ * buffer ahead of hubbub.  It only understands enough markup to pull
+ * the URLs out of img, script and link start tags; everything
+ * surprising is skipped.  Discovered URLs are warmed in the low-level
+ * cache so the real fetches issued later during DOM construction find
+ * the bytes already present or in flight.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "utils/config.h"
+#include "utils/ascii.h"
+#include "utils/log.h"
+#include "utils/nsoption.h"
+#include "utils/nsurl.h"
+#include "content/fetch.h"
+#include "content/llcache.h"
+
+#include "html/private.h"
+#include "html/preload.h"
+
+/** Maximum number of speculative retrievals per document */
+#define PRELOAD_MAX 64
+
+/** Maximum attribute value length considered */
+#define PRELOAD_ATTR_MAX 2048
+
+/**
+ * Low-level cache callback for preload retrievals.
+ *
+ * The data is wanted in the cache, not here, so every event is simply
+ * acknowledged.
+ */
+static nserror
+html_preload_callback(llcache_handle *handle,
+		      const llcache_event *event,
+		      void *pw)
+{
+	return NSERROR_OK;
+}
+
+/**
+ * Start a speculative retrieval for a discovered URL.
+ *
+ * \param htmlc The HTML content being scanned.
+ * \param url The attribute value to resolve and fetch.
+ * \param priority Resource class to queue the fetch with.
+ */
+static void
+html_preload_fetch(struct html_content *htmlc,
+		   const char *url,
+		   fetch_priority priority)
+{
+	nsurl *joined;
+	llcache_handle *handle;
+	llcache_handle **preloads;
+	unsigned int i;
+
+	if (htmlc->preload_count == PRELOAD_MAX) {
+		return;
+	}
+
+	if (nsurl_join(htmlc->base_url, url, &joined) != NSERROR_OK) {
+		return;
+	}
+
+	/* ignore URLs already warmed from this document */
+	for (i = 0; i != htmlc->preload_count; i++) {
+		if (nsurl_compare(llcache_handle_get_url(htmlc->preloads[i]),
+				  joined, NSURL_COMPLETE)) {
+			nsurl_unref(joined);
+			return;
+		}
+	}
+
+	preloads = realloc(htmlc->preloads,
+			   sizeof(*preloads) * (htmlc->preload_count + 1));
+	if (preloads == NULL) {
+		nsurl_unref(joined);
+		return;
+	}
+	htmlc->preloads = preloads;
+
+	if (llcache_handle_retrieve(joined,
+				    LLCACHE_RETRIEVE_PRIORITY(priority),
+				    content_get_url(&htmlc->base),
+				    NULL,
+				    html_preload_callback,
+				    NULL,
+				    &handle) == NSERROR_OK) {
+		NSLOG(netsurf, DEBUG, "preloading %s", nsurl_access(joined));
+		htmlc->preloads[htmlc->preload_count++] = handle;
+	}
+
+	nsurl_unref(joined);
+}
+
+/**
+ * Find a byte sequence within a buffer.
+ */
+static const char *
+html_preload_find(const char *data, size_t size,
+		  const char *needle, size_t needle_len)
+{
+	size_t pos;
+
+	if (size < needle_len) {
+		return NULL;
+	}
+	for (pos = 0; pos <= size - needle_len; pos++) {
+		if ((data[pos] == needle[0]) &&
+		    (memcmp(data + pos, needle, needle_len) == 0)) {
+			return data + pos;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Case insensitively match an ASCII tag or attribute name.
+ */
+static bool
+html_preload_nameeq(const char *name, size_t name_len, const char *match)
+{
+	return (name_len == strlen(match)) &&
+	       (strncasecmp(name, match, name_len) == 0);
+}
+
+/**
+ * Parse the attributes of a start tag.
+ *
+ * \param data Source positioned after the tag name.
+ * \param size Remaining source length.
+ * \param want1 First attribute name wanted, e.g. "src".
+ * \param val1 Buffer of PRELOAD_ATTR_MAX for the first value.
+ * \param want2 Second attribute name wanted or NULL.
+ * \param val2 Buffer of PRELOAD_ATTR_MAX for the second value or NULL.
+ * \return Number of bytes consumed up to and including the closing '>'
+ *         or \a size if the tag was unterminated.
+ */
+static size_t
+html_preload_attrs(const char *data,
+		   size_t size,
+		   const char *want1, char *val1,
+		   const char *want2, char *val2)
+{
+	size_t pos = 0;
+
+	val1[0] = '\0';
+	if (val2 != NULL) {
+		val2[0] = '\0';
+	}
+
+	while (pos != size) {
+		const char *name;
+		size_t name_len;
+		const char *value = NULL;
+		size_t value_len = 0;
+
+		/* skip whitespace and stray slashes */
+		while ((pos != size) &&
+		       (ascii_is_space(data[pos]) || (data[pos] == '/'))) {
+			pos++;
+		}
+		if ((pos == size) || (data[pos] == '>')) {
+			return (pos == size) ? size : pos + 1;
+		}
+
+		/* attribute name */
+		name = data + pos;
+		while ((pos != size) &&
+		       (data[pos] != '=') && (data[pos] != '>') &&
+		       (ascii_is_space(data[pos]) == false)) {
+			pos++;
+		}
+		name_len = (data + pos) - name;
+
+		/* optional value */
+		while ((pos != size) && ascii_is_space(data[pos])) {
+			pos++;
+		}
+		if ((pos != size) && (data[pos] == '=')) {
+			pos++;
+			while ((pos != size) && ascii_is_space(data[pos])) {
+				pos++;
+			}
+			if (pos == size) {
+				return size;
+			}
+			if ((data[pos] == '"') || (data[pos] == '\'')) {
+				char quote = data[pos++];
+				value = data + pos;
+				while ((pos != size) && (data[pos] != quote)) {
+					pos++;
+				}
+				value_len = (data + pos) - value;
+				if (pos != size) {
+					pos++;
+				}
+			} else {
+				value = data + pos;
+				while ((pos != size) &&
+				       (data[pos] != '>') &&
+				       (ascii_is_space(data[pos]) == false)) {
+					pos++;
+				}
+				value_len = (data + pos) - value;
+			}
+		}
+
+		if ((value != NULL) && (value_len != 0) &&
+		    (value_len < PRELOAD_ATTR_MAX)) {
+			if (html_preload_nameeq(name, name_len, want1)) {
+				memcpy(val1, value, value_len);
+				val1[value_len] = '\0';
+			} else if ((want2 != NULL) &&
+				   html_preload_nameeq(name, name_len,
+						       want2)) {
+				memcpy(val2, value, value_len);
+				val2[value_len] = '\0';
+			}
+		}
+	}
+
+	return size;
+}
+
+/* exported interface documented in html/preload.h */
+void html_preload_scan(struct html_content *htmlc,
+		       const char *data,
+		       size_t size)
+{
+	size_t pos = 0;
+	char val1[PRELOAD_ATTR_MAX];
+	char val2[PRELOAD_ATTR_MAX];
+
+	if (nsoption_bool(preload_scanning) == false) {
+		return;
+	}
+	if ((htmlc->base_url == NULL) ||
+	    (htmlc->preload_count == PRELOAD_MAX)) {
+		return;
+	}
+
+	while (pos < size) {
+		const char *name;
+		size_t name_len;
+
+		if (data[pos] != '<') {
+			pos++;
+			continue;
+		}
+		pos++;
+		if (pos == size) {
+			break;
+		}
+
+		if (data[pos] == '!') {
+			/* comment or declaration */
+			if ((size - pos >= 3) &&
+			    (data[pos + 1] == '-') && (data[pos + 2] == '-')) {
+				const char *end;
+				end = html_preload_find(data + pos + 3,
+							size - pos - 3,
+							"-->", 3);
+				if (end == NULL) {
+					return;
+				}
+				pos = (end - data) + 3;
+			} else {
+				while ((pos != size) && (data[pos] != '>')) {
+					pos++;
+				}
+			}
+			continue;
+		}
+
+		if (data[pos] == '/') {
+			/* close tag; skip it */
+			while ((pos != size) && (data[pos] != '>')) {
+				pos++;
+			}
+			continue;
+		}
+
+		/* tag name */
+		name = data + pos;
+		while ((pos != size) &&
+		       (data[pos] != '>') &&
+		       (ascii_is_space(data[pos]) == false) &&
+		       (data[pos] != '/')) {
+			pos++;
+		}
+		name_len = (data + pos) - name;
+
+		if (html_preload_nameeq(name, name_len, "img")) {
+			pos += html_preload_attrs(data + pos, size - pos,
+						  "src", val1, NULL, NULL);
+			if (val1[0] != '\0') {
+				html_preload_fetch(htmlc, val1,
+						   FETCH_PRIORITY_IMG);
+			}
+		} else if (html_preload_nameeq(name, name_len, "script")) {
+			const char *end;
+
+			pos += html_preload_attrs(data + pos, size - pos,
+						  "src", val1, NULL, NULL);
+			if (val1[0] != '\0') {
+				html_preload_fetch(htmlc, val1,
+						   FETCH_PRIORITY_SCRIPT);
+			}
+
+			/* skip the script body so its text is not
+			 * misread as markup
+			 */
+			if (pos >= size) {
+				return;
+			}
+			end = html_preload_find(data + pos, size - pos,
+						"</script", 8);
+			if (end == NULL) {
+				return;
+			}
+			pos = end - data;
+		} else if (html_preload_nameeq(name, name_len, "link")) {
+			pos += html_preload_attrs(data + pos, size - pos,
+						  "href", val1, "rel", val2);
+			if (val1[0] != '\0') {
+				if (strcasestr(val2, "stylesheet") != NULL) {
+					html_preload_fetch(
+						htmlc, val1,
+						FETCH_PRIORITY_CSS);
+				} else if (strcasestr(val2,
+						      "preload") != NULL) {
+					html_preload_fetch(
+						htmlc, val1,
+						FETCH_PRIORITY_FONT);
+				}
+			}
+		}
+	}
+}
+
+/* exported interface documented in html/preload.h */
+void html_preload_fini(struct html_content *htmlc)
+{
+	unsigned int i;
+
+	for (i = 0; i != htmlc->preload_count; i++) {
+		llcache_handle_release(htmlc->preloads[i]);
+	}
+	free(htmlc->preloads);
+	htmlc->preloads = NULL;
+	htmlc->preload_count = 0;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * HTML speculative preload scanner interface.
+ */
+
+#ifndef NETSURF_HTML_PRELOAD_H
+#define NETSURF_HTML_PRELOAD_H
+
+struct html_content;
+
+/**
+ * Scan a chunk of incoming HTML source for likely subresource fetches.
+ *
+ * Runs a lightweight tokenizer over the raw buffer before it reaches
+ * the real parser and starts low-level cache retrievals for the src
+ * and href URLs of img, script and link elements, overlapping their
+ * network time with parsing.  The scan is purely speculative: tags
+ * split across chunk boundaries are simply missed and nothing is
+ * fetched that the low-level cache would not dedupe against the real
+ * request later.
+ *
+ * \param htmlc The HTML content being fed the data.
+ * \param data The source data chunk.
+ * \param size The length of the chunk.
+ */
+void html_preload_scan(struct html_content *htmlc,
+		       const char *data,
+		       size_t size);
+
+/**
+ * Release the low-level cache handles held by the preload scanner.
+ *
+ * \param htmlc The HTML content being finalised.
+ */
+void html_preload_fini(struct html_content *htmlc);
+
+#endif
@@ -87,6 +87,22 @@ union html_focus_owner {
 	struct box *content;
 };
 
+/**
+ * Number of slots in the style share table. Must be large enough that
+ * the distinct (parent style, element name) pairs on a typical page
+ * rarely collide, since each pair hashes to a single slot.
+ */
+#define STYLE_SHARE_CACHE_SIZE 128
+
+/**
+ * A viewport length at which one of a document's media queries changes
+ * state.
+ */
+struct html_media_breakpoint {
+	css_fixed value; /**< Boundary, in css pixels. */
+	bool height; /**< Boundary applies to the viewport height. */
+};
+
 /**
  * Data specific to CONTENT_HTML.
  */
@@ -97,6 +113,15 @@ typedef struct html_content {
 	bool parse_completed; /**< Whether the parse has been completed */
 	bool conversion_begun; /**< Whether or not the conversion has begun */
 
+	/** Data delivered but not yet fed to the parser, or NULL */
+	uint8_t *parse_pending;
+	/** Length of parse_pending, in bytes */
+	size_t parse_pending_len;
+	/** Number of bytes of parse_pending already parsed */
+	size_t parse_pending_done;
+	/** Whether a parse continuation is scheduled */
+	bool parse_scheduled;
+
 	/** Document tree */
 	dom_document *document;
 	/** Quirkyness of document */
@@ -124,14 +149,19 @@ typedef struct html_content {
 	/** Whether an initial layout has been done */
 	bool had_initial_layout;
 
+	/** Available width given to the last completed layout */
+	int last_layout_width;
+	/** Available height given to the last completed layout */
+	int last_layout_height;
+
 	/** Whether scripts are enabled for this content */
 	bool enable_scripting;
 
 	/* Title element node */
 	dom_node *title;
 
-	/** A talloc context purely for the render box tree */
-	int *bctx;
+	/** An arena talloc context purely for the render box tree */
+	void *bctx;
 	/** A context pointer for the box conversion, NULL if no conversion
 	 * is in progress.
 	 */
@@ -151,6 +181,15 @@ typedef struct html_content {
 	/** javascript thread in use */
 	struct jsthread *jsthread;
 
+	/** Number of entries in script_prefetches */
+	unsigned int script_prefetch_count;
+	/** Speculative script fetches started while the parser was
+	 * paused on a synchronous script. Entries may be NULL. */
+	struct hlcache_handle **script_prefetches;
+	/** Offset into the source data the speculative script scanner
+	 * has reached */
+	size_t script_speculate_offset;
+
 	/** Number of entries in stylesheet_content. */
 	unsigned int stylesheet_count;
 	/** Stylesheets. Each may be NULL. */
@@ -164,6 +203,52 @@ typedef struct html_content {
 	/**< Universal selector */
 	lwc_string *universal;
 
+	/** Viewport lengths at which the stylesheets' media queries
+	 * change which rules apply. */
+	struct html_media_breakpoint *media_breakpoints;
+	/** Number of entries in media_breakpoints. */
+	unsigned int media_breakpoints_count;
+	/** Allocated size of the media_breakpoints array. */
+	unsigned int media_breakpoints_alloc;
+	/** A media query was seen whose breakpoints could not be
+	 * determined; every viewport size change must then re-select. */
+	bool media_breakpoints_unknown;
+
+	/** The element the pointer is currently over, or NULL.
+	 * Referenced. Only tracked when styles_use_hover is set. */
+	dom_node *hover_node;
+	/** A stylesheet was seen which uses :hover; pointer movement
+	 * must then restyle the elements whose hover state changes. */
+	bool styles_use_hover;
+
+	/** Table of styled elements whose selection results may be
+	 * shared with equivalent elements later in the document,
+	 * hashed by parent style and element name. */
+	struct {
+		/** Computed style of the element's parent. */
+		const css_computed_style *parent_style;
+		/** The element itself (referenced). */
+		dom_node *node;
+		/** Selection results for the element; owned by
+		 * shared_styles, not by this ring. */
+		css_select_results *styles;
+	} style_share_cache[STYLE_SHARE_CACHE_SIZE];
+
+	/** Number of entries in shared_styles. */
+	unsigned int shared_styles_count;
+	/** Allocated size of the shared_styles array. */
+	unsigned int shared_styles_alloc;
+	/** Selection results used by more than one box. These are owned
+	 * by the content rather than by any box, since the box that
+	 * first produced a set of results may be discarded while other
+	 * boxes still refer to them. */
+	css_select_results **shared_styles;
+
+	/** Number of entries in preloads. */
+	unsigned int preload_count;
+	/** Low-level cache handles held by the speculative preload scanner. */
+	struct llcache_handle **preloads;
+
 	/** Number of entries in object_list. */
 	unsigned int num_objects;
 	/** List of objects. */
@@ -204,6 +289,18 @@ typedef struct html_content {
 	/** HTML content's own text selection object */
 	struct selection *sel;
 
+	/** Flattened array of the layout's text runs, in textual order,
+	 * used by the selection operations; or NULL. */
+	struct textselection_run *textselection_runs;
+	/** Number of entries in textselection_runs. */
+	unsigned int textselection_run_count;
+	/** Allocated size of the textselection_runs array. */
+	unsigned int textselection_run_alloc;
+	/** Length of the textual representation the runs describe. */
+	unsigned textselection_end_idx;
+	/** Whether textselection_runs matches the current layout. */
+	bool textselection_runs_valid;
+
 	/**
 	 * Open core-handled form SELECT menu, or NULL if none
 	 *  currently open.
@@ -63,6 +63,7 @@
 #include "html/form_internal.h"
 #include "html/private.h"
 #include "html/layout.h"
+#include "html/object.h"
 
 
 bool html_redraw_debug = false;
@@ -172,11 +173,15 @@ text_redraw(const char *utf8_text,
 {
 	bool highlighted = false;
 	plot_font_style_t plot_fstyle = *fstyle;
+	const plot_font_style_t *plot_ifstyle;
 	nserror res;
 
 	/* Need scaled text size to pass to plotters */
 	plot_fstyle.size *= scale;
 
+	/* give the plotters a stable style identity to cache against */
+	plot_ifstyle = plot_font_style_intern(&plot_fstyle, NULL);
+
 	/* is this box part of a selection? */
 	if (!excluded && ctx->interactive == true) {
 		unsigned len = utf8_len + (space ? 1 : 0);
@@ -248,7 +253,7 @@ text_redraw(const char *utf8_text,
 			/* draw any text preceding highlighted portion */
 			if ((start_idx > 0) &&
 			    (ctx->plot->text(ctx,
-					     &plot_fstyle,
+					     plot_ifstyle,
 					     x,
 					     y + (int)(height * 0.75 * scale),
 					     utf8_text,
@@ -319,7 +324,7 @@ text_redraw(const char *utf8_text,
 					clip_changed = true;
 
 					res = ctx->plot->text(ctx,
-							      &plot_fstyle,
+							      plot_ifstyle,
 							      x,
 							      y + (int)(height * 0.75 * scale),
 							      utf8_text,
@@ -339,7 +344,7 @@ text_redraw(const char *utf8_text,
 
 	if (!highlighted) {
 		res = ctx->plot->text(ctx,
-				      &plot_fstyle,
+				      plot_ifstyle,
 				      x,
 				      y + (int) (height * 0.75 * scale),
 				      utf8_text,
@@ -1165,6 +1170,44 @@ bool html_redraw_box(const html_content *html, struct box *box,
 		colour current_background_color,
 		const struct redraw_context *ctx);
 
+/**
+ * Cheap conservative test for a box lying outside the clip rectangle.
+ *
+ * The extent used covers both the border edge and the descendant box,
+ * so it is a superset of whichever rectangle html_redraw_box() would
+ * compute; a box passing this test is still subject to the exact cull
+ * there. Only valid at scale 1.0.
+ *
+ * \param  box   box to test
+ * \param  x     coordinate of parent box
+ * \param  y     coordinate of parent box
+ * \param  clip  clip rectangle
+ * \return true if the box and its descendants need no redraw
+ */
+static bool html_redraw_box_outside(struct box *box, int x, int y,
+		const struct rect *clip)
+{
+	int v;
+	struct rect r;
+
+	x += box->x;
+	y += box->y;
+
+	v = -box->border[LEFT].width;
+	r.x0 = x + (box->descendant_x0 < v ? box->descendant_x0 : v);
+	v = -box->border[TOP].width;
+	r.y0 = y + (box->descendant_y0 < v ? box->descendant_y0 : v);
+	v = box->padding[LEFT] + box->width + box->padding[RIGHT] +
+			box->border[RIGHT].width;
+	r.x1 = x + (box->descendant_x1 + 1 > v ? box->descendant_x1 + 1 : v);
+	v = box->padding[TOP] + box->height + box->padding[BOTTOM] +
+			box->border[BOTTOM].width;
+	r.y1 = y + (box->descendant_y1 + 1 > v ? box->descendant_y1 + 1 : v);
+
+	return (clip->y1 < r.y0 || r.y1 < clip->y0 ||
+			clip->x1 < r.x0 || r.x1 < clip->x0);
+}
+
 /**
  * Draw the various children of a box.
  *
@@ -1186,28 +1229,33 @@ static bool html_redraw_box_children(const html_content *html, struct box *box,
 		const struct redraw_context *ctx)
 {
 	struct box *c;
+	int x_offset = x_parent + box->x - scrollbar_get_offset(box->scroll_x);
+	int y_offset = y_parent + box->y - scrollbar_get_offset(box->scroll_y);
+	/* exact culling happens in html_redraw_box(); the cheap test
+	 * here just avoids descending into the many siblings a long
+	 * page has outside the damaged area */
+	bool cull = (scale == 1.0 && !html_redraw_printing);
 
 	for (c = box->children; c; c = c->next) {
-
-		if (c->type != BOX_FLOAT_LEFT && c->type != BOX_FLOAT_RIGHT)
-			if (!html_redraw_box(html, c,
-					x_parent + box->x -
-					scrollbar_get_offset(box->scroll_x),
-					y_parent + box->y -
-					scrollbar_get_offset(box->scroll_y),
-					clip, scale, current_background_color,
-					ctx))
-				return false;
+		if (c->type == BOX_FLOAT_LEFT || c->type == BOX_FLOAT_RIGHT)
+			continue;
+		if (cull && html_redraw_box_outside(c, x_offset, y_offset,
+				clip))
+			continue;
+		if (!html_redraw_box(html, c, x_offset, y_offset,
+				clip, scale, current_background_color,
+				ctx))
+			return false;
 	}
-	for (c = box->float_children; c; c = c->next_float)
-		if (!html_redraw_box(html, c,
-				x_parent + box->x -
-				scrollbar_get_offset(box->scroll_x),
-				y_parent + box->y -
-				scrollbar_get_offset(box->scroll_y),
+	for (c = box->float_children; c; c = c->next_float) {
+		if (cull && html_redraw_box_outside(c, x_offset, y_offset,
+				clip))
+			continue;
+		if (!html_redraw_box(html, c, x_offset, y_offset,
 				clip, scale, current_background_color,
 				ctx))
 			return false;
+	}
 
 	return true;
 }
@@ -1956,6 +2004,16 @@ bool html_redraw(struct content *c, struct content_redraw_data *data,
 	box = html->layout;
 	assert(box);
 
+	/* every redraw reports the visible vertical slice of the
+	 * document so fetches deferred by lazy image loading are
+	 * started as they are scrolled towards
+	 */
+	if (nsoption_bool(lazy_image_loading) && (data->scale > 0)) {
+		html_object_lazy_load(html,
+				(clip->y0 - data->y) / data->scale,
+				(clip->y1 - data->y) / data->scale);
+	}
+
 	/* The select menu needs special treating because, when opened, it
 	 * reaches beyond its layout box.
 	 */
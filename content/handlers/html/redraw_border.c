@@ -53,6 +53,9 @@ static plot_style_t plot_style_fillbdr_dlight = {
 	.fill_type = PLOT_OP_TYPE_SOLID,
 };
 
+/** Colour the derived border fill styles above were computed from */
+static colour plot_style_bdr_colour = NS_TRANSPARENT;
+
 
 static inline nserror
 plot_clipped_rectangle(const struct redraw_context *ctx,
@@ -113,11 +116,18 @@ html_redraw_border_plot(const int side,
 	plot_style_bdr.stroke_type = PLOT_OP_TYPE_DASH;
 	plot_style_bdr.stroke_colour = c;
 	plot_style_bdr.stroke_width = (thickness << PLOT_STYLE_RADIX);
-	plot_style_fillbdr.fill_colour = c;
-	plot_style_fillbdr_dark.fill_colour = darken_colour(c);
-	plot_style_fillbdr_light.fill_colour = lighten_colour(c);
-	plot_style_fillbdr_ddark.fill_colour = double_darken_colour(c);
-	plot_style_fillbdr_dlight.fill_colour = double_lighten_colour(c);
+	if (c != plot_style_bdr_colour) {
+		/* deriving the shaded fills is the expensive part;
+		 * reuse them when the colour repeats, as it does for
+		 * every identically styled border on a page
+		 */
+		plot_style_fillbdr.fill_colour = c;
+		plot_style_fillbdr_dark.fill_colour = darken_colour(c);
+		plot_style_fillbdr_light.fill_colour = lighten_colour(c);
+		plot_style_fillbdr_ddark.fill_colour = double_darken_colour(c);
+		plot_style_fillbdr_dlight.fill_colour = double_lighten_colour(c);
+		plot_style_bdr_colour = c;
+	}
 
 	switch (style) {
 	case CSS_BORDER_STYLE_DOTTED:
@@ -503,6 +513,13 @@ html_redraw_borders(struct box *box,
 
 		switch (side) {
 		case LEFT:
+			if (clip->x0 > p[2]) {
+				/* clip rectangle is right of border; nothing
+				 * to plot
+				 */
+				continue;
+			}
+
 			square_end_1 = (top == 0);
 			square_end_2 = (bottom == 0);
 
@@ -544,6 +561,13 @@ html_redraw_borders(struct box *box,
 			break;
 
 		case RIGHT:
+			if (clip->x1 < p[4]) {
+				/* clip rectangle is left of border; nothing
+				 * to plot
+				 */
+				continue;
+			}
+
 			square_end_1 = (top == 0);
 			square_end_2 = (bottom == 0);
 
@@ -374,6 +374,274 @@ convert_script_sync_cb(hlcache_handle *script,
 	return NSERROR_OK;
 }
 
+/** Maximum number of speculative script fetches per document */
+#define SCRIPT_PREFETCH_MAX 16
+
+/**
+ * Callback for speculative script fetches
+ *
+ * The fetch only exists to warm the cache; the real retrieval is
+ * issued when the parser reaches the script element and is merged
+ * with this one by the low level cache.
+ */
+static nserror
+convert_script_speculate_cb(hlcache_handle *script,
+			    const hlcache_event *event,
+			    void *pw)
+{
+	html_content *parent = pw;
+	unsigned int i;
+
+	switch (event->type) {
+	case CONTENT_MSG_ERROR:
+		NSLOG(netsurf, INFO, "speculative script %s failed: %s",
+		      nsurl_access(hlcache_handle_get_url(script)),
+		      event->data.errordata.errormsg);
+
+		for (i = 0; i != parent->script_prefetch_count; i++) {
+			if (parent->script_prefetches[i] == script) {
+				parent->script_prefetches[i] = NULL;
+				break;
+			}
+		}
+		hlcache_handle_release(script);
+
+		break;
+
+	default:
+		break;
+	}
+
+	return NSERROR_OK;
+}
+
+/**
+ * Find the value of the src attribute within a script start tag
+ *
+ * \param tag Position just after the tag name
+ * \param tag_end Position of the closing '>'
+ * \param src_out Updated to the start of the attribute value
+ * \param src_len_out Updated to the length of the attribute value
+ * \return true iff a non-empty src value was found
+ */
+static bool
+speculate_script_src(const char *tag,
+		     const char *tag_end,
+		     const char **src_out,
+		     size_t *src_len_out)
+{
+	const char *p = tag;
+	const char *name, *value;
+	size_t name_len, value_len;
+	char quote;
+
+	while (p < tag_end) {
+		while (p < tag_end && isspace((unsigned char)*p)) {
+			p++;
+		}
+
+		/* attribute name */
+		name = p;
+		while (p < tag_end &&
+		       !isspace((unsigned char)*p) && *p != '=') {
+			p++;
+		}
+		name_len = p - name;
+
+		while (p < tag_end && isspace((unsigned char)*p)) {
+			p++;
+		}
+
+		/* attribute value */
+		value = NULL;
+		value_len = 0;
+		if (p < tag_end && *p == '=') {
+			p++;
+			while (p < tag_end && isspace((unsigned char)*p)) {
+				p++;
+			}
+			if (p < tag_end && (*p == '"' || *p == '\'')) {
+				quote = *p++;
+				value = p;
+				while (p < tag_end && *p != quote) {
+					p++;
+				}
+				value_len = p - value;
+				if (p < tag_end) {
+					p++;
+				}
+			} else {
+				value = p;
+				while (p < tag_end &&
+				       !isspace((unsigned char)*p)) {
+					p++;
+				}
+				value_len = p - value;
+			}
+		}
+
+		if (name_len == 3 &&
+		    strncasecmp(name, "src", 3) == 0 &&
+		    value_len > 0) {
+			*src_out = value;
+			*src_len_out = value_len;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Check whether a script url is already being fetched
+ */
+static bool html_script_fetch_exists(html_content *c, nsurl *url)
+{
+	unsigned int i;
+	struct html_script *s;
+
+	for (i = 0, s = c->scripts; i != c->scripts_count; i++, s++) {
+		if (s->type != HTML_SCRIPT_INLINE &&
+		    s->data.handle != NULL &&
+		    nsurl_compare(hlcache_handle_get_url(s->data.handle),
+				  url, NSURL_COMPLETE)) {
+			return true;
+		}
+	}
+
+	for (i = 0; i != c->script_prefetch_count; i++) {
+		if (c->script_prefetches[i] != NULL &&
+		    nsurl_compare(
+			    hlcache_handle_get_url(c->script_prefetches[i]),
+			    url, NSURL_COMPLETE)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Speculatively fetch external scripts ahead of the parser
+ *
+ * A synchronous script pauses the parser until it has been fetched
+ * and executed, which serialises the fetches of any scripts that
+ * follow it. While the parser is stalled, scan the source data it
+ * has not yet consumed for further script start tags and begin their
+ * fetches early; the parser's own retrieval is merged with the
+ * speculative one by the low level cache when it catches up.
+ *
+ * The scan is a plain byte search, so a tag inside a comment or
+ * string may start a fetch that is never used; this only costs
+ * bandwidth, the script is not executed. Scripts inserted by
+ * document.write() are unaffected as execution still happens at the
+ * normal point in the parse.
+ *
+ * \param c The html content being parsed
+ */
+static void html_script_speculate(html_content *c)
+{
+	const char *source;
+	size_t length;
+	size_t i;
+	const char *tag_end, *src;
+	size_t src_len;
+	char *url_str;
+	nsurl *joined;
+	hlcache_child_context child;
+	struct hlcache_handle **prefetches;
+	hlcache_handle *handle;
+	nserror ns_error;
+
+	source = (const char *)content__get_source_data(&c->base, &length);
+	if (source == NULL) {
+		return;
+	}
+
+	for (i = c->script_speculate_offset; i + 7 < length; i++) {
+		if (source[i] != '<' ||
+		    strncasecmp(source + i + 1, "script", 6) != 0 ||
+		    (!isspace((unsigned char)source[i + 7]) &&
+		     source[i + 7] != '>')) {
+			continue;
+		}
+
+		tag_end = memchr(source + i + 7, '>', length - i - 7);
+		if (tag_end == NULL) {
+			/* incomplete tag; resume here once more data
+			 * has arrived
+			 */
+			break;
+		}
+
+		if (c->script_prefetch_count >= SCRIPT_PREFETCH_MAX) {
+			break;
+		}
+
+		if (!speculate_script_src(source + i + 7, tag_end,
+					  &src, &src_len)) {
+			i = tag_end - source;
+			continue;
+		}
+
+		url_str = malloc(src_len + 1);
+		if (url_str == NULL) {
+			break;
+		}
+		memcpy(url_str, src, src_len);
+		url_str[src_len] = '\0';
+
+		ns_error = nsurl_join(c->base_url, url_str, &joined);
+		free(url_str);
+		if (ns_error != NSERROR_OK) {
+			i = tag_end - source;
+			continue;
+		}
+
+		if (html_script_fetch_exists(c, joined)) {
+			nsurl_unref(joined);
+			i = tag_end - source;
+			continue;
+		}
+
+		prefetches = realloc(c->script_prefetches,
+				     sizeof(*prefetches) *
+				     (c->script_prefetch_count + 1));
+		if (prefetches == NULL) {
+			nsurl_unref(joined);
+			break;
+		}
+		c->script_prefetches = prefetches;
+
+		child.charset = c->encoding;
+		child.quirks = c->base.quirks;
+
+		ns_error = hlcache_handle_retrieve(joined,
+						   LLCACHE_RETRIEVE_PRIORITY(
+							   FETCH_PRIORITY_SCRIPT),
+						   content_get_url(&c->base),
+						   NULL,
+						   convert_script_speculate_cb,
+						   c,
+						   &child,
+						   CONTENT_SCRIPT,
+						   &handle);
+		nsurl_unref(joined);
+
+		if (ns_error == NSERROR_OK) {
+			NSLOG(netsurf, INFO, "speculative script %d '%s'",
+			      c->script_prefetch_count,
+			      nsurl_access(hlcache_handle_get_url(handle)));
+			c->script_prefetches[c->script_prefetch_count++] =
+					handle;
+		}
+
+		i = tag_end - source;
+	}
+
+	c->script_speculate_offset = i;
+}
+
 /**
  * process a script with a src tag
  */
@@ -468,7 +736,8 @@ exec_src_script(html_content *c,
 	child.quirks = c->base.quirks;
 
 	ns_error = hlcache_handle_retrieve(joined,
-					   0,
+					   LLCACHE_RETRIEVE_PRIORITY(
+						   FETCH_PRIORITY_SCRIPT),
 					   content_get_url(&c->base),
 					   NULL,
 					   script_cb,
@@ -495,6 +764,10 @@ exec_src_script(html_content *c,
 		switch (script_type) {
 		case HTML_SCRIPT_SYNC:
 			ret =  DOM_HUBBUB_HUBBUB_ERR | HUBBUB_PAUSED;
+			/* the parse is stalling; look ahead of the
+			 * parser and warm up further script fetches
+			 */
+			html_script_speculate(c);
 			break;
 
 		case HTML_SCRIPT_ASYNC:
@@ -661,5 +934,12 @@ nserror html_script_free(html_content *html)
 	}
 	free(html->scripts);
 
+	for (i = 0; i != html->script_prefetch_count; i++) {
+		if (html->script_prefetches[i] != NULL) {
+			hlcache_handle_release(html->script_prefetches[i]);
+		}
+	}
+	free(html->script_prefetches);
+
 	return NSERROR_OK;
 }
@@ -810,7 +810,9 @@ table_used_bottom_border_for_cell(const css_unit_ctx *unit_len_ctx,
 
 /* exported interface documented in html/table.h */
 bool
-table_calculate_column_types(const css_unit_ctx *unit_len_ctx, struct box *table)
+table_calculate_column_types(const css_unit_ctx *unit_len_ctx,
+		void *bctx,
+		struct box *table)
 {
 	unsigned int i, j;
 	struct column *col;
@@ -820,7 +822,7 @@ table_calculate_column_types(const css_unit_ctx *unit_len_ctx, struct box *table
 		/* table->col already constructed, for example frameset table */
 		return true;
 
-	table->col = col = talloc_array(table, struct column, table->columns);
+	table->col = col = talloc_array(bctx, struct column, table->columns);
 	if (!col)
 		return false;
 
@@ -34,13 +34,14 @@ struct box;
  * Determine the column width types for a table.
  *
  * \param unit_len_ctx Length conversion context
+ * \param bctx box tree allocation context
  * \param table box of type BOX_TABLE
  * \return true on success, false on memory exhaustion
  *
  * The table->col array is allocated and type and width are filled in for each
  * column.
  */
-bool table_calculate_column_types(const css_unit_ctx *unit_len_ctx,	struct box *table);
+bool table_calculate_column_types(const css_unit_ctx *unit_len_ctx, void *bctx, struct box *table);
 
 
 /**
@@ -43,6 +43,106 @@ struct rdw_info {
 	struct rect r;
 };
 
+/**
+ * A text box flattened out of the layout.
+ *
+ * The runs for a layout are stored in textual order, so the boxes a
+ * range of byte offsets touches can be found with a binary search
+ * instead of a traversal of the whole box tree.
+ */
+struct textselection_run {
+	struct box *box;	/**< text box generating this run */
+	unsigned start;		/**< byte offset of the run's start */
+	unsigned end;		/**< byte offset just past the run's end */
+};
+
+
+/**
+ * Extend a redraw range to cover a box.
+ *
+ * \param rdwi redraw range to extend
+ * \param box box to be covered
+ */
+static void rdw_info_add_box(struct rdw_info *rdwi, struct box *box)
+{
+	int width, height;
+	int x, y;
+
+	/**
+	 * \todo it should be possible to reduce the redrawn
+	 *        area using the offsets
+	 */
+	box_coords(box, &x, &y);
+
+	width = box->padding[LEFT] + box->width + box->padding[RIGHT];
+	height = box->padding[TOP] + box->height + box->padding[BOTTOM];
+
+	if ((box->type == BOX_TEXT) && (box->space != 0)) {
+		width += box->space;
+	}
+
+	if (rdwi->inited) {
+		if (x < rdwi->r.x0) {
+			rdwi->r.x0 = x;
+		}
+		if (y < rdwi->r.y0) {
+			rdwi->r.y0 = y;
+		}
+		if (x + width > rdwi->r.x1) {
+			rdwi->r.x1 = x + width;
+		}
+		if (y + height > rdwi->r.y1) {
+			rdwi->r.y1 = y + height;
+		}
+	} else {
+		rdwi->inited = true;
+		rdwi->r.x0 = x;
+		rdwi->r.y0 = y;
+		rdwi->r.x1 = x + width;
+		rdwi->r.y1 = y + height;
+	}
+}
+
+
+/**
+ * Append a text box to the content's run array.
+ *
+ * On memory exhaustion the run array is marked invalid; the selection
+ * operations then fall back to traversing the box tree.
+ *
+ * \param html content the runs describe
+ * \param box text box to append
+ */
+static void textselection_run_add(html_content *html, struct box *box)
+{
+	struct textselection_run *run;
+
+	if (html->textselection_runs_valid == false) {
+		return;
+	}
+
+	if (html->textselection_run_count == html->textselection_run_alloc) {
+		struct textselection_run *temp;
+		unsigned int alloc = (html->textselection_run_alloc == 0) ?
+				128 : html->textselection_run_alloc * 2;
+
+		temp = realloc(html->textselection_runs,
+				alloc * sizeof(*temp));
+		if (temp == NULL) {
+			html->textselection_runs_valid = false;
+			return;
+		}
+
+		html->textselection_runs = temp;
+		html->textselection_run_alloc = alloc;
+	}
+
+	run = &html->textselection_runs[html->textselection_run_count++];
+	run->box = box;
+	run->start = box->byte_offset;
+	run->end = box->byte_offset + box->length + SPACE_LEN(box);
+}
+
 
 /**
  * Tests whether a text box lies partially within the given range of
@@ -160,43 +260,7 @@ coords_from_range(struct box *box,
 		unsigned end_off;
 
 		if (selected_part(box, start_idx, end_idx, &start_off, &end_off)) {
-			int width, height;
-			int x, y;
-
-			/**
-			 * \todo it should be possible to reduce the redrawn
-			 *        area using the offsets
-			 */
-			box_coords(box, &x, &y);
-
-			width = box->padding[LEFT] + box->width + box->padding[RIGHT];
-			height = box->padding[TOP] + box->height + box->padding[BOTTOM];
-
-			if ((box->type == BOX_TEXT) &&
-			    (box->space != 0)) {
-				width += box->space;
-			}
-
-			if (rdwi->inited) {
-				if (x < rdwi->r.x0) {
-					rdwi->r.x0 = x;
-				}
-				if (y < rdwi->r.y0) {
-					rdwi->r.y0 = y;
-				}
-				if (x + width > rdwi->r.x1) {
-					rdwi->r.x1 = x + width;
-				}
-				if (y + height > rdwi->r.y1) {
-					rdwi->r.y1 = y + height;
-				}
-			} else {
-				rdwi->inited = true;
-				rdwi->r.x0 = x;
-				rdwi->r.y0 = y;
-				rdwi->r.x1 = x + width;
-				rdwi->r.y1 = y + height;
-			}
+			rdw_info_add_box(rdwi, box);
 		}
 	}
 
@@ -438,11 +502,17 @@ selection_copy(struct box *box,
  * Label each text box in the given box subtree with its position
  * in a textual representation of the content.
  *
+ * Each text box is also appended to the content's flattened run
+ * array, which the selection operations search instead of walking
+ * the box tree.
+ *
+ * \param html content the subtree belongs to
  * \param box The box at root of subtree
  * \param idx current position within textual representation
  * \return updated position
  */
-static unsigned selection_label_subtree(struct box *box, unsigned idx)
+static unsigned
+selection_label_subtree(html_content *html, struct box *box, unsigned idx)
 {
 	struct box *child;
 
@@ -454,14 +524,16 @@ static unsigned selection_label_subtree(struct box *box, unsigned idx)
 
 	if (box->text) {
 		idx += box->length + SPACE_LEN(box);
+		textselection_run_add(html, box);
 	}
 
 	while (child) {
 		if (child->list_marker) {
-			idx = selection_label_subtree(child->list_marker, idx);
+			idx = selection_label_subtree(html,
+					child->list_marker, idx);
 		}
 
-		idx = selection_label_subtree(child, idx);
+		idx = selection_label_subtree(html, child, idx);
 		child = child->next;
 	}
 
@@ -485,9 +557,39 @@ html_textselection_redraw(struct content *c,
 
 	rdw.inited = false;
 
-	res = coords_from_range(html->layout, start_idx, end_idx, &rdw, false);
-	if (res != NSERROR_OK) {
-		return res;
+	if (html->textselection_runs_valid) {
+		/* binary search for the first run ending inside the
+		 * range, then accumulate runs until one starts past
+		 * its end; only the boxes the change touches are
+		 * visited */
+		struct textselection_run *runs = html->textselection_runs;
+		unsigned lo = 0, hi = html->textselection_run_count;
+		unsigned start_off, end_off;
+		unsigned i;
+
+		while (lo < hi) {
+			unsigned mid = (lo + hi) / 2;
+
+			if (runs[mid].end <= start_idx) {
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
+		}
+
+		for (i = lo; i < html->textselection_run_count &&
+				runs[i].start < end_idx; i++) {
+			if (selected_part(runs[i].box, start_idx, end_idx,
+					&start_off, &end_off)) {
+				rdw_info_add_box(&rdw, runs[i].box);
+			}
+		}
+	} else {
+		res = coords_from_range(html->layout, start_idx, end_idx,
+				&rdw, false);
+		if (res != NSERROR_OK) {
+			return res;
+		}
 	}
 
 	if (rdw.inited) {
@@ -533,15 +635,33 @@ nserror
 html_textselection_get_end(struct content *c, unsigned *end_idx)
 {
 	html_content *html = (html_content *)c;
-	unsigned root_idx;
 
 	if (html->layout == NULL) {
 		return NSERROR_INVALID;
 	}
 
-	root_idx = 0;
+	if (html->textselection_runs_valid) {
+		/* the labelling and run array from the last build
+		 * still describe this layout */
+		*end_idx = html->textselection_end_idx;
+		return NSERROR_OK;
+	}
+
+	html->textselection_run_count = 0;
+	html->textselection_runs_valid = true;
 
-	*end_idx = selection_label_subtree(html->layout, root_idx);
+	*end_idx = selection_label_subtree(html, html->layout, 0);
+
+	/* textselection_run_add() withdraws the array on memory
+	 * exhaustion; the labelling itself is still complete */
+	html->textselection_end_idx = *end_idx;
 
 	return NSERROR_OK;
 }
+
+
+/* exported interface documented in html/textselection.h */
+void html_textselection_invalidate(struct html_content *html)
+{
+	html->textselection_runs_valid = false;
+}
@@ -26,6 +26,7 @@
 
 struct content;
 struct selection;
+struct html_content;
 
 nserror html_textselection_redraw(struct content *c, unsigned start_idx, unsigned end_idx);
 
@@ -40,4 +41,15 @@ nserror html_textselection_copy(struct content *c, unsigned start_idx, unsigned
  */
 nserror html_textselection_get_end(struct content *c, unsigned *end_idx);
 
+/**
+ * Invalidate the content's flattened text-run array.
+ *
+ * Must be called whenever the set of boxes in the layout may have
+ * changed (a reflow can split or merge text boxes); the array is
+ * rebuilt on the next selection operation.
+ *
+ * \param[in] html The html content whose layout changed
+ */
+void html_textselection_invalidate(struct html_content *html);
+
 #endif
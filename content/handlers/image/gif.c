@@ -61,8 +61,24 @@ typedef struct gif_content {
 
 	nsgif_t *gif; /**< GIF animation data */
 	uint32_t current_frame;   /**< current frame to display [0...(max-1)] */
+
+	uint32_t frame_delay;     /**< delay of the current frame in cs */
+	uint32_t frames_unseen;   /**< frames prepared since the last redraw */
+	bool animation_suspended; /**< animation timer stopped; nothing is
+				   *   displaying this content */
 } gif_content;
 
+/**
+ * Number of animation frames nobody redraws before the timer is suspended.
+ *
+ * Each prepared frame is broadcast as CONTENT_MSG_REDRAW; a visible
+ * content is then redrawn before the next frame is due.  If this many
+ * frames in a row go unpainted the content is scrolled out of view or
+ * otherwise obscured and animating it is wasted work.  More than one so
+ * a single slow paint does not suspend a visible animation.
+ */
+#define GIF_MAX_UNSEEN_FRAMES 2
+
 static inline nserror gif__nsgif_error_to_ns(nsgif_error gif_res)
 {
 	nserror err;
@@ -189,7 +205,15 @@ static nserror gif__animate(gif_content *gif, bool redraw)
 
 	/* Continue animating if we should */
 	if (nsoption_bool(animate_images) && delay != NSGIF_INFINITE) {
-		guit->misc->schedule(delay * 10, gif_animate_cb, gif);
+		if (gif->frames_unseen >= GIF_MAX_UNSEEN_FRAMES) {
+			/* Nobody has painted the last few frames, so the
+			 * content is not visible; stop the timer and let
+			 * the next redraw restart it. */
+			gif->animation_suspended = true;
+		} else {
+			gif->frame_delay = delay;
+			guit->misc->schedule(delay * 10, gif_animate_cb, gif);
+		}
 	}
 
 	if (redraw) {
@@ -201,6 +225,7 @@ static nserror gif__animate(gif_content *gif, bool redraw)
 		data.redraw.width  = rect.x1 - rect.x0;
 		data.redraw.height = rect.y1 - rect.y0;
 
+		gif->frames_unseen++;
 		content_broadcast(&gif->base, CONTENT_MSG_REDRAW, &data);
 	}
 
@@ -302,6 +327,16 @@ static bool gif_redraw(struct content *c, struct content_redraw_data *data,
 	gif_content *gif = (gif_content *) c;
 	nsgif_bitmap_t *bitmap;
 
+	/* the content is visible again; resume a suspended animation */
+	gif->frames_unseen = 0;
+	if (gif->animation_suspended) {
+		gif->animation_suspended = false;
+		if (nsoption_bool(animate_images)) {
+			guit->misc->schedule(gif->frame_delay * 10,
+					gif_animate_cb, gif);
+		}
+	}
+
 	if (gif_get_frame(gif, &bitmap) != NSGIF_OK) {
 		return false;
 	}
@@ -364,6 +399,8 @@ static void gif_add_user(struct content *c)
 	if (content_count_users(c) == 1) {
 		/* First user, and content already converted, so start the animation. */
 		if (nsgif_reset(gif->gif) == NSGIF_OK) {
+			gif->frames_unseen = 0;
+			gif->animation_suspended = false;
 			gif__animate(gif, true);
 		}
 	}
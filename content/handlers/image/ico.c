@@ -260,11 +260,17 @@ static nserror nsico_clone(const struct content *old, struct content **newc)
 static void *nsico_get_internal(const struct content *c, void *context)
 {
 	nsico_content *ico = (nsico_content *) c;
-	/* TODO: Pick best size for purpose.
-	 *       Currently assumes it's for a URL bar. */
+	const struct content_bitmap_size_hint *size_hint = context;
+	int width = 16; /* assume a URL bar sized icon if not told */
+	int height = 16;
 	struct bmp_image *bmp;
 
-	bmp = ico_find(ico->ico, 16, 16);
+	if (size_hint != NULL) {
+		width = size_hint->width;
+		height = size_hint->height;
+	}
+
+	bmp = ico_find(ico->ico, width, height);
 	if (bmp == NULL) {
 		/* return error */
 		NSLOG(netsurf, INFO, "Failed to select icon");
@@ -27,9 +27,13 @@
 #include <string.h>
 #include <stdlib.h>
 
+#include <nsutils/time.h>
+
 #include "netsurf/inttypes.h"
 #include "utils/utils.h"
 #include "utils/log.h"
+#include "utils/memreport.h"
+#include "utils/trace.h"
 #include "netsurf/misc.h"
 #include "netsurf/bitmap.h"
 #include "content/llcache.h"
@@ -47,6 +51,12 @@
  */
 typedef unsigned int cache_age;
 
+/** Time in ms between background decode operations */
+#define IMAGE_CACHE_DECODE_TIME 10
+
+/** Row granularity of band decodes of very large images */
+#define IMAGE_CACHE_BAND_GRANULARITY 256
+
 /**
  * Image cache entry
  */
@@ -60,6 +70,24 @@ struct image_cache_entry_s {
 	struct bitmap *bitmap;
 	/** routine to convert content into bitmap */
 	image_cache_convert_fn *convert;
+	/** routine to convert content into bitmap at a given size,
+	 * or NULL if the decoder cannot scale during decode */
+	image_cache_convert_scaled_fn *convert_scaled;
+	/** routine to convert a band of the content into a bitmap,
+	 * or NULL if the decoder cannot decode a row range */
+	image_cache_convert_band_fn *convert_band;
+
+	/** bitmap decoded at a reduced size, or NULL */
+	struct bitmap *scaled_bitmap;
+	int scaled_width; /**< width scaled_bitmap was decoded at */
+	int scaled_height; /**< height scaled_bitmap was decoded at */
+	size_t scaled_size; /**< storage occupied by scaled_bitmap */
+
+	/** bitmap holding a band of a very large image, or NULL */
+	struct bitmap *band_bitmap;
+	int band_y0; /**< first source row held in band_bitmap */
+	int band_y1; /**< one past the last source row in band_bitmap */
+	size_t band_size; /**< storage occupied by band_bitmap */
 
 	/* Statistics for replacement algorithm */
 
@@ -69,6 +97,12 @@ struct image_cache_entry_s {
 	cache_age bitmap_age; /**< Age of last conversion to a bitmap by cache*/
 
 	int conversion_count; /**< Number of times image has been converted */
+
+	/** time taken by the most recent conversion in ms */
+	unsigned int decode_cost;
+
+	/** entry is queued for conversion off the redraw path */
+	bool decode_pending;
 };
 
 /**
@@ -247,6 +281,40 @@ static void image_cache__unlink(struct image_cache_entry_s *centry)
 	}
 }
 
+/**
+ * free the reduced size bitmap from an image cache entry
+ *
+ * \param centry The image cache entry to free the scaled bitmap from.
+ */
+static void image_cache__free_scaled_bitmap(struct image_cache_entry_s *centry)
+{
+	if (centry->scaled_bitmap != NULL) {
+		guit->bitmap->destroy(centry->scaled_bitmap);
+		centry->scaled_bitmap = NULL;
+		image_cache->total_bitmap_size -= centry->scaled_size;
+		centry->scaled_size = 0;
+		centry->scaled_width = 0;
+		centry->scaled_height = 0;
+	}
+}
+
+/**
+ * free the band bitmap from an image cache entry
+ *
+ * \param centry The image cache entry to free the band bitmap from.
+ */
+static void image_cache__free_band_bitmap(struct image_cache_entry_s *centry)
+{
+	if (centry->band_bitmap != NULL) {
+		guit->bitmap->destroy(centry->band_bitmap);
+		centry->band_bitmap = NULL;
+		image_cache->total_bitmap_size -= centry->band_size;
+		centry->band_size = 0;
+		centry->band_y0 = 0;
+		centry->band_y1 = 0;
+	}
+}
+
 /**
  * free bitmap from an image cache entry
  *
@@ -254,6 +322,9 @@ static void image_cache__unlink(struct image_cache_entry_s *centry)
  */
 static void image_cache__free_bitmap(struct image_cache_entry_s *centry)
 {
+	image_cache__free_scaled_bitmap(centry);
+	image_cache__free_band_bitmap(centry);
+
 	if (centry->bitmap != NULL) {
 #ifdef IMAGE_CACHE_VERBOSE
 		NSLOG(netsurf, INFO,
@@ -296,26 +367,96 @@ static void image_cache__free_entry(struct image_cache_entry_s *centry)
 	free(centry);
 }
 
+/**
+ * Convert a cache entry into a bitmap, recording the decode cost.
+ *
+ * \param centry The image cache entry to convert.
+ * \return The resulting bitmap or NULL on conversion failure.
+ */
+static struct bitmap *image_cache__convert(struct image_cache_entry_s *centry)
+{
+	uint64_t start_ms = 0;
+	uint64_t end_ms = 0;
+
+	nsu_getmonotonic_ms(&start_ms);
+	centry->bitmap = centry->convert(centry->content);
+	nsu_getmonotonic_ms(&end_ms);
+
+	centry->decode_cost = (unsigned int)(end_ms - start_ms);
+
+	return centry->bitmap;
+}
+
+/**
+ * Score a cache entry for eviction.
+ *
+ * The score weighs the cost of bringing the bitmap back against the
+ * space freed by discarding it: the recorded decode cost, scaled by
+ * how often the entry is drawn, per kilobyte of bitmap storage. Low
+ * scoring entries are cheap to re-decode relative to the space they
+ * release and are evicted first.
+ *
+ * \param centry The image cache entry to score.
+ * \return The eviction score; lower is a better eviction candidate.
+ */
+static uint64_t image_cache__evict_score(struct image_cache_entry_s *centry)
+{
+	return (((uint64_t)centry->decode_cost + 1) *
+		(centry->redraw_count + 1) * 1024) /
+		(centry->bitmap_size + centry->scaled_size +
+		 centry->band_size + 1);
+}
+
 /**
  * Image cache cleaner
  *
+ * While the cache is over its target size, evict the bitmap with the
+ * lowest cost/benefit score, considering only entries not redrawn
+ * recently so active bitmaps are left alone.
+ *
  * \param icache The image cache context.
  */
 static void image_cache__clean(struct image_cache_s *icache)
 {
-	struct image_cache_entry_s *centry = icache->entries;
+	struct image_cache_entry_s *centry;
+	struct image_cache_entry_s *victim;
+	uint64_t victim_score = 0;
+	uint64_t score;
+
+	while (icache->total_bitmap_size >
+	       (icache->params.limit - icache->params.hysteresis)) {
+		victim = NULL;
+
+		for (centry = icache->entries;
+		     centry != NULL;
+		     centry = centry->next) {
+			if ((centry->bitmap == NULL) &&
+			    (centry->scaled_bitmap == NULL) &&
+			    (centry->band_bitmap == NULL)) {
+				continue;
+			}
 
-	while (centry != NULL) {
-		if ((icache->current_age - centry->redraw_age) >
-		    icache->params.bg_clean_time) {
-			/* only consider older entries, avoids active entries */
-			if ((icache->total_bitmap_size >
-			     (icache->params.limit - icache->params.hysteresis)) &&
-			    (rand() > (RAND_MAX / 2))) {
-				image_cache__free_bitmap(centry);
+			/* only consider older entries, avoids active
+			 * entries
+			 */
+			if ((icache->current_age - centry->redraw_age) <=
+			    icache->params.bg_clean_time) {
+				continue;
+			}
+
+			score = image_cache__evict_score(centry);
+			if ((victim == NULL) || (score < victim_score)) {
+				victim = centry;
+				victim_score = score;
 			}
 		}
-		centry=centry->next;
+
+		if (victim == NULL) {
+			/* every remaining bitmap is in active use */
+			break;
+		}
+
+		image_cache__free_bitmap(victim);
 	}
 }
 
@@ -342,6 +483,56 @@ static void image_cache__background_update(void *p)
 				icache);
 }
 
+/**
+ * Cache background decode scheduled callback.
+ *
+ * Converts at most one queued content per invocation so the decode of
+ * a burst of images is interleaved with other scheduled work instead
+ * of stalling inside the first redraw which needs them.
+ *
+ * \param p The image cache context.
+ */
+static void image_cache__background_decode(void *p)
+{
+	struct image_cache_s *icache = p;
+	struct image_cache_entry_s *centry = icache->entries;
+	bool decoded = false;
+
+	while (centry != NULL) {
+		if (centry->decode_pending) {
+			if (icache->total_bitmap_size >=
+			    icache->params.limit) {
+				/* cache is over its target usage; leave
+				 * the remainder to convert on demand at
+				 * plot time
+				 */
+				centry->decode_pending = false;
+			} else if (centry->bitmap == NULL) {
+				centry->decode_pending = false;
+				centry->bitmap = image_cache__convert(centry);
+				if (centry->bitmap != NULL) {
+					image_cache_stats_bitmap_add(centry);
+				} else {
+					icache->fail_count++;
+				}
+				decoded = true;
+				break;
+			} else {
+				/* already converted at plot time */
+				centry->decode_pending = false;
+			}
+		}
+		centry = centry->next;
+	}
+
+	if (decoded) {
+		/* further entries may remain queued */
+		guit->misc->schedule(IMAGE_CACHE_DECODE_TIME,
+				image_cache__background_decode,
+				icache);
+	}
+}
+
 /* exported interface documented in image_cache.h */
 struct bitmap *image_cache_get_bitmap(const struct content *c)
 {
@@ -354,7 +545,8 @@ struct bitmap *image_cache_get_bitmap(const struct content *c)
 
 	if (centry->bitmap == NULL) {
 		if (centry->convert != NULL) {
-			centry->bitmap = centry->convert(centry->content);
+			centry->bitmap = image_cache__convert(centry);
+			centry->decode_pending = false;
 		}
 
 		if (centry->bitmap != NULL) {
@@ -411,6 +603,16 @@ struct bitmap *image_cache_find_bitmap(struct content *c)
 	return centry->bitmap;
 }
 
+/**
+ * Report the decoded bitmap heap usage for memory accounting.
+ */
+static size_t image_cache__memreport(void *pw)
+{
+	struct image_cache_s *icache = pw;
+
+	return icache->total_bitmap_size;
+}
+
 /* exported interface documented in image_cache.h */
 nserror
 image_cache_init(const struct image_cache_parameters *image_cache_parameters)
@@ -422,6 +624,9 @@ image_cache_init(const struct image_cache_parameters *image_cache_parameters)
 
 	image_cache->params = *image_cache_parameters;
 
+	memreport_register("Image bitmaps", image_cache__memreport,
+			   image_cache);
+
 	guit->misc->schedule(image_cache->params.bg_clean_time,
 				image_cache__background_update,
 				image_cache);
@@ -441,6 +646,9 @@ nserror image_cache_fini(void)
 	uint64_t op_size;
 
 	guit->misc->schedule(-1, image_cache__background_update, image_cache);
+	guit->misc->schedule(-1, image_cache__background_decode, image_cache);
+
+	memreport_unregister("Image bitmaps");
 
 	NSLOG(netsurf, INFO, "Size at finish %"PRIsizet" (in %d)",
 	      image_cache->total_bitmap_size, image_cache->bitmap_count);
@@ -506,10 +714,25 @@ nserror image_cache_fini(void)
 	return NSERROR_OK;
 }
 
+/**
+ * Check whether an entry should be plotted from decoded bands.
+ *
+ * \param centry The image cache entry to check.
+ * \return true if full size decodes of the entry should be avoided.
+ */
+static bool image_cache__band_preferred(
+		const struct image_cache_entry_s *centry)
+{
+	return (centry->convert_band != NULL) &&
+	       (centry->bitmap_size > (image_cache->params.limit / 2));
+}
+
 /* exported interface documented in image_cache.h */
-nserror image_cache_add(struct content *content,
+nserror image_cache_add_banded(struct content *content,
 			struct bitmap *bitmap,
-			image_cache_convert_fn *convert)
+			image_cache_convert_fn *convert,
+			image_cache_convert_scaled_fn *convert_scaled,
+			image_cache_convert_band_fn *convert_band)
 {
 	struct image_cache_entry_s *centry;
 
@@ -535,6 +758,8 @@ nserror image_cache_add(struct content *content,
 	      content, bitmap);
 
 	centry->convert = convert;
+	centry->convert_scaled = convert_scaled;
+	centry->convert_band = convert_band;
 
 	/* set bitmap entry if one is passed, free extant one if present */
 	if (bitmap != NULL) {
@@ -548,7 +773,7 @@ nserror image_cache_add(struct content *content,
 		/* no bitmap, check to see if we should speculatively convert */
 		if ((centry->convert != NULL) &&
 		    (image_cache_speculate(content) == true)) {
-			centry->bitmap = centry->convert(centry->content);
+			centry->bitmap = image_cache__convert(centry);
 
 			if (centry->bitmap != NULL) {
 				image_cache_stats_bitmap_add(centry);
@@ -556,6 +781,19 @@ nserror image_cache_add(struct content *content,
 				image_cache->fail_count++;
 			}
 		}
+
+		if ((centry->bitmap == NULL) &&
+		    (centry->convert != NULL) &&
+		    (image_cache__band_preferred(centry) == false)) {
+			/* queue a conversion ahead of the first plot
+			 * so a burst of large images does not stall a
+			 * single redraw
+			 */
+			centry->decode_pending = true;
+			guit->misc->schedule(IMAGE_CACHE_DECODE_TIME,
+					image_cache__background_decode,
+					image_cache);
+		}
 	}
 
 
@@ -563,6 +801,24 @@ nserror image_cache_add(struct content *content,
 	return NSERROR_OK;
 }
 
+/* exported interface documented in image_cache.h */
+nserror image_cache_add_scaled(struct content *content,
+			struct bitmap *bitmap,
+			image_cache_convert_fn *convert,
+			image_cache_convert_scaled_fn *convert_scaled)
+{
+	return image_cache_add_banded(content, bitmap, convert,
+			convert_scaled, NULL);
+}
+
+/* exported interface documented in image_cache.h */
+nserror image_cache_add(struct content *content,
+			struct bitmap *bitmap,
+			image_cache_convert_fn *convert)
+{
+	return image_cache_add_banded(content, bitmap, convert, NULL, NULL);
+}
+
 /* exported interface documented in image_cache.h */
 nserror image_cache_remove(struct content *content)
 {
@@ -802,6 +1058,8 @@ bool image_cache_redraw(struct content *c,
 {
 	struct image_cache_entry_s *centry;
 
+	NSTRACE(NSTRACE_IMAGE, "image_cache_redraw", c);
+
 	/* get the cache entry */
 	centry = image_cache__find(c);
 	if (centry == NULL) {
@@ -810,9 +1068,136 @@ bool image_cache_redraw(struct content *c,
 		return false;
 	}
 
+	/* plot from a bitmap decoded at the display size when the
+	 * decoder can scale and the image is heavily reduced.
+	 */
+	if ((centry->convert_scaled != NULL) &&
+	    (data->width > 0) && (data->height > 0) &&
+	    ((data->width * 2) <= c->width) &&
+	    ((data->height * 2) <= c->height)) {
+		if ((centry->scaled_bitmap != NULL) &&
+		    ((centry->scaled_width != data->width) ||
+		     (centry->scaled_height != data->height))) {
+			/* previous reduced bitmap is the wrong size */
+			image_cache__free_scaled_bitmap(centry);
+		}
+
+		if (centry->scaled_bitmap == NULL) {
+			centry->scaled_bitmap = centry->convert_scaled(
+					centry->content,
+					data->width, data->height);
+
+			if (centry->scaled_bitmap != NULL) {
+				centry->scaled_width = data->width;
+				centry->scaled_height = data->height;
+				centry->scaled_size = data->width *
+						data->height * 4;
+				image_cache->total_bitmap_size +=
+						centry->scaled_size;
+				image_cache->miss_count++;
+				image_cache->miss_size += centry->scaled_size;
+			}
+			/* on failure fall through to the full size path */
+		} else {
+			image_cache->hit_count++;
+			image_cache->hit_size += centry->scaled_size;
+		}
+
+		if (centry->scaled_bitmap != NULL) {
+			/* reduced bitmap suffices; cancel any queued
+			 * full size conversion
+			 */
+			centry->decode_pending = false;
+
+			centry->redraw_count++;
+			centry->redraw_age = image_cache->current_age;
+
+			return image_bitmap_plot(centry->scaled_bitmap,
+					data, clip, ctx);
+		}
+	}
+
+	/* plot very large images from a band covering the clip so a
+	 * single enormous bitmap allocation is never needed.
+	 */
+	if ((centry->bitmap == NULL) &&
+	    (image_cache__band_preferred(centry)) &&
+	    (data->repeat_x == false) && (data->repeat_y == false) &&
+	    (data->width > 0) && (data->height > 0) && (c->height > 0)) {
+		int y0_dev = (clip->y0 > data->y) ? clip->y0 : data->y;
+		int y1_dev = (clip->y1 < (data->y + data->height)) ?
+				clip->y1 : (data->y + data->height);
+		int y0, y1;
+
+		if (y1_dev <= y0_dev) {
+			/* image wholly outside the clip */
+			return true;
+		}
+
+		/* source rows covering the clip, expanded to band
+		 * granularity
+		 */
+		y0 = (y0_dev - data->y) * c->height / data->height;
+		y1 = ((y1_dev - data->y) * c->height + data->height - 1) /
+				data->height;
+		y0 -= y0 % IMAGE_CACHE_BAND_GRANULARITY;
+		y1 += IMAGE_CACHE_BAND_GRANULARITY - 1;
+		y1 -= y1 % IMAGE_CACHE_BAND_GRANULARITY;
+		if (y1 > c->height) {
+			y1 = c->height;
+		}
+
+		if ((centry->band_bitmap != NULL) &&
+		    ((y0 < centry->band_y0) || (y1 > centry->band_y1))) {
+			/* cached band does not cover the clip */
+			image_cache__free_band_bitmap(centry);
+		}
+
+		if (centry->band_bitmap == NULL) {
+			centry->band_bitmap = centry->convert_band(
+					centry->content, y0, y1);
+
+			if (centry->band_bitmap != NULL) {
+				centry->band_y0 = y0;
+				centry->band_y1 = y1;
+				centry->band_size = (size_t)c->width *
+						(y1 - y0) * 4;
+				image_cache->total_bitmap_size +=
+						centry->band_size;
+				image_cache->miss_count++;
+				image_cache->miss_size += centry->band_size;
+			}
+			/* on failure fall through to the full size path */
+		} else {
+			image_cache->hit_count++;
+			image_cache->hit_size += centry->band_size;
+		}
+
+		if (centry->band_bitmap != NULL) {
+			struct content_redraw_data band_data = *data;
+
+			/* position the band within the full image area,
+			 * flooring both edges so adjacent bands tile
+			 * without gaps
+			 */
+			band_data.y = data->y + centry->band_y0 *
+					data->height / c->height;
+			band_data.height = (data->y + centry->band_y1 *
+					data->height / c->height) -
+					band_data.y;
+
+			centry->redraw_count++;
+			centry->redraw_age = image_cache->current_age;
+
+			return image_bitmap_plot(centry->band_bitmap,
+					&band_data, clip, ctx);
+		}
+	}
+
 	if (centry->bitmap == NULL) {
 		if (centry->convert != NULL) {
-			centry->bitmap = centry->convert(centry->content);
+			centry->bitmap = image_cache__convert(centry);
+			centry->decode_pending = false;
 		}
 
 		if (centry->bitmap != NULL) {
@@ -46,6 +46,35 @@ struct redraw_context;
 
 typedef struct bitmap * (image_cache_convert_fn) (struct content *content);
 
+/**
+ * Convert a content into a bitmap decoded at a given size.
+ *
+ * Decoders able to scale during decode provide this in addition to
+ * their full-size conversion routine, so the cache can satisfy
+ * redraws of heavily reduced images without decoding, or storing,
+ * every pixel of the original.
+ *
+ * \param content The content to convert
+ * \param width   Target bitmap width, in pixels
+ * \param height  Target bitmap height, in pixels
+ * \return The decoded bitmap, or NULL on failure
+ */
+typedef struct bitmap * (image_cache_convert_scaled_fn) (struct content *content, int width, int height);
+
+/**
+ * Convert a horizontal band of a content into a bitmap.
+ *
+ * Decoders able to produce a range of rows without decoding the whole
+ * image provide this, so the cache can plot very large images from a
+ * band covering the current clip instead of one enormous bitmap.
+ *
+ * \param content The content to convert
+ * \param y0      First source row of the band, in pixels
+ * \param y1      One past the last source row of the band, in pixels
+ * \return The decoded band bitmap of \a y1 - \a y0 rows, or NULL on failure
+ */
+typedef struct bitmap * (image_cache_convert_band_fn) (struct content *content, int y0, int y1);
+
 struct image_cache_parameters {
 	/** How frequently the background cache clean process is run (ms) */
 	unsigned int bg_clean_time;
@@ -74,10 +103,50 @@ nserror image_cache_fini(void);
  * @param convert A function pointer to convert the content into a bitmap or NULL.
  * @return A netsurf error code.
  */
-nserror image_cache_add(struct content *content, 
-			struct bitmap *bitmap, 
+nserror image_cache_add(struct content *content,
+			struct bitmap *bitmap,
 			image_cache_convert_fn *convert);
 
+/** adds an image content to be cached, with scaled decode support.
+ *
+ * As image_cache_add(), but additionally registers a routine to
+ * decode the content directly at a requested size. Redraws at a
+ * fraction of the image's natural size are then satisfied from a
+ * bitmap decoded at the displayed size, which is retained alongside
+ * the full-size bitmap slot.
+ *
+ * @param content The content handle used as a key
+ * @param bitmap A bitmap representing the already converted content or NULL.
+ * @param convert A function pointer to convert the content into a bitmap or NULL.
+ * @param convert_scaled A function pointer to convert the content into a bitmap at a given size or NULL.
+ * @return A netsurf error code.
+ */
+nserror image_cache_add_scaled(struct content *content,
+			struct bitmap *bitmap,
+			image_cache_convert_fn *convert,
+			image_cache_convert_scaled_fn *convert_scaled);
+
+/** adds an image content to be cached, with scaled and band decode support.
+ *
+ * As image_cache_add_scaled(), but additionally registers a routine to
+ * decode a horizontal band of the content. Images whose full size
+ * bitmap would dominate the cache are then plotted from a cached band
+ * covering the redraw clip, decoded on demand, rather than from a
+ * single huge allocation.
+ *
+ * @param content The content handle used as a key
+ * @param bitmap A bitmap representing the already converted content or NULL.
+ * @param convert A function pointer to convert the content into a bitmap or NULL.
+ * @param convert_scaled A function pointer to convert the content into a bitmap at a given size or NULL.
+ * @param convert_band A function pointer to convert a band of the content into a bitmap or NULL.
+ * @return A netsurf error code.
+ */
+nserror image_cache_add_banded(struct content *content,
+			struct bitmap *bitmap,
+			image_cache_convert_fn *convert,
+			image_cache_convert_scaled_fn *convert_scaled,
+			image_cache_convert_band_fn *convert_band);
+
 nserror image_cache_remove(struct content *content);
 
 
@@ -166,14 +166,17 @@ static void nsjpeg_error_exit(j_common_ptr cinfo)
 static inline void nsjpeg__decode_cmyk(
 		struct jpeg_decompress_struct *cinfo,
 		uint8_t * volatile pixels,
-		size_t rowstride)
+		size_t rowstride,
+		unsigned int row0,
+		unsigned int row_end)
 {
 	int width = cinfo->output_width * 4;
 
 	do {
 		JSAMPROW scanlines[1] = {
 			[0] = (JSAMPROW)
-				(pixels + rowstride * cinfo->output_scanline),
+				(pixels + rowstride *
+				 (cinfo->output_scanline - row0)),
 		};
 		jpeg_read_scanlines(cinfo, scanlines, 1);
 
@@ -195,7 +198,7 @@ static inline void nsjpeg__decode_cmyk(
 			scanlines[0][i + bitmap_layout.a] = 0xff;
 #undef DIV255
 		}
-	} while (cinfo->output_scanline != cinfo->output_height);
+	} while (cinfo->output_scanline != row_end);
 }
 
 /**
@@ -204,7 +207,9 @@ static inline void nsjpeg__decode_cmyk(
 static inline void nsjpeg__decode_rgb(
 		struct jpeg_decompress_struct *cinfo,
 		uint8_t * volatile pixels,
-		size_t rowstride)
+		size_t rowstride,
+		unsigned int row0,
+		unsigned int row_end)
 {
 #if RGB_RED != 0 || RGB_GREEN != 1 || RGB_BLUE != 2 || RGB_PIXELSIZE != 4
 	int width = cinfo->output_width;
@@ -213,7 +218,8 @@ static inline void nsjpeg__decode_rgb(
 	do {
 		JSAMPROW scanlines[1] = {
 			[0] = (JSAMPROW)
-				(pixels + rowstride * cinfo->output_scanline),
+				(pixels + rowstride *
+				 (cinfo->output_scanline - row0)),
 		};
 		jpeg_read_scanlines(cinfo, scanlines, 1);
 
@@ -230,7 +236,7 @@ static inline void nsjpeg__decode_rgb(
 			scanlines[0][i * 4 + bitmap_layout.a] = 0xff;
 		}
 #endif
-	} while (cinfo->output_scanline != cinfo->output_height);
+	} while (cinfo->output_scanline != row_end);
 }
 
 /**
@@ -239,22 +245,30 @@ static inline void nsjpeg__decode_rgb(
 static inline void nsjpeg__decode_client_fmt(
 		struct jpeg_decompress_struct *cinfo,
 		uint8_t * volatile pixels,
-		size_t rowstride)
+		size_t rowstride,
+		unsigned int row0,
+		unsigned int row_end)
 {
 	do {
 		JSAMPROW scanlines[1] = {
 			[0] = (JSAMPROW)
-				(pixels + rowstride * cinfo->output_scanline),
+				(pixels + rowstride *
+				 (cinfo->output_scanline - row0)),
 		};
 		jpeg_read_scanlines(cinfo, scanlines, 1);
-	} while (cinfo->output_scanline != cinfo->output_height);
+	} while (cinfo->output_scanline != row_end);
 }
 
 /**
  * create a bitmap from jpeg content.
+ *
+ * \param c The jpeg content to decode.
+ * \param width Minimum output width in pixels, or 0 for full size.
+ * \param height Minimum output height in pixels, or 0 for full size.
+ * \return A decoded bitmap or NULL on error.
  */
 static struct bitmap *
-jpeg_cache_convert(struct content *c)
+jpeg_cache_convert_to(struct content *c, int width, int height)
 {
 	const uint8_t *source_data; /* Jpeg source data */
 	size_t source_size; /* length of Jpeg source data */
@@ -303,6 +317,22 @@ jpeg_cache_convert(struct content *c)
 	/* read JPEG header information */
 	jpeg_read_header(&cinfo, TRUE);
 
+	/* have the jpeg library scale during decode; select the
+	 * smallest M/8 scale which still covers the requested size
+	 */
+	if ((width > 0) && (height > 0)) {
+		cinfo.scale_denom = 8;
+		for (cinfo.scale_num = 1; cinfo.scale_num < 8;
+				cinfo.scale_num++) {
+			if (((int)((cinfo.image_width *
+					cinfo.scale_num) / 8) >= width) &&
+			    ((int)((cinfo.image_height *
+					cinfo.scale_num) / 8) >= height)) {
+				break;
+			}
+		}
+	}
+
 	/* set output processing parameters */
 	if (cinfo.jpeg_color_space == JCS_CMYK ||
 	    cinfo.jpeg_color_space == JCS_YCCK) {
@@ -360,15 +390,18 @@ jpeg_cache_convert(struct content *c)
 
 	switch (cinfo.out_color_space) {
 	case JCS_CMYK:
-		nsjpeg__decode_cmyk(&cinfo, pixels, rowstride);
+		nsjpeg__decode_cmyk(&cinfo, pixels, rowstride,
+				0, cinfo.output_height);
 		break;
 
 	case JCS_RGB:
-		nsjpeg__decode_rgb(&cinfo, pixels, rowstride);
+		nsjpeg__decode_rgb(&cinfo, pixels, rowstride,
+				0, cinfo.output_height);
 		break;
 
 	default:
-		nsjpeg__decode_client_fmt(&cinfo, pixels, rowstride);
+		nsjpeg__decode_client_fmt(&cinfo, pixels, rowstride,
+				0, cinfo.output_height);
 		break;
 	}
 
@@ -380,6 +413,191 @@ jpeg_cache_convert(struct content *c)
 	return bitmap;
 }
 
+/**
+ * create a full size bitmap from jpeg content.
+ */
+static struct bitmap *
+jpeg_cache_convert(struct content *c)
+{
+	return jpeg_cache_convert_to(c, 0, 0);
+}
+
+/**
+ * create a bitmap from jpeg content decoded at a reduced size.
+ */
+static struct bitmap *
+jpeg_cache_convert_scaled(struct content *c, int width, int height)
+{
+	return jpeg_cache_convert_to(c, width, height);
+}
+
+/**
+ * create a bitmap from a horizontal band of jpeg content.
+ *
+ * Rows above the band are decoded into a scratch line and discarded;
+ * decompression is aborted once the band is complete so rows below it
+ * are never decoded.
+ *
+ * \param c The jpeg content to decode.
+ * \param y0 First source row of the band.
+ * \param y1 One past the last source row of the band.
+ * \return A decoded band bitmap or NULL on error.
+ */
+static struct bitmap *
+jpeg_cache_convert_band(struct content *c, int y0, int y1)
+{
+	const uint8_t *source_data; /* Jpeg source data */
+	size_t source_size; /* length of Jpeg source data */
+	struct jpeg_decompress_struct cinfo;
+	struct jpeg_error_mgr jerr;
+	jmp_buf setjmp_buffer;
+	struct bitmap * volatile bitmap = NULL;
+	uint8_t * volatile pixels = NULL;
+	uint8_t * volatile scanbuf = NULL;
+	size_t rowstride;
+	struct jpeg_source_mgr source_mgr = {
+		0,
+		0,
+		nsjpeg_init_source,
+		nsjpeg_fill_input_buffer,
+		nsjpeg_skip_input_data,
+		jpeg_resync_to_restart,
+		nsjpeg_term_source };
+
+	/* obtain jpeg source data and perfom minimal sanity checks */
+	source_data = content__get_source_data(c, &source_size);
+
+	if ((source_data == NULL) ||
+	    (source_size < MIN_JPEG_SIZE)) {
+		return NULL;
+	}
+
+	/* setup a JPEG library error handler */
+	cinfo.err = jpeg_std_error(&jerr);
+	jerr.error_exit = nsjpeg_error_exit;
+	jerr.output_message = nsjpeg_error_log;
+
+	/* handler for fatal errors during decompression */
+	if (setjmp(setjmp_buffer)) {
+		jpeg_destroy_decompress(&cinfo);
+		free(scanbuf);
+		return bitmap;
+	}
+
+	cinfo.client_data = &setjmp_buffer;
+	jpeg_create_decompress(&cinfo);
+
+	/* setup data source */
+	source_mgr.next_input_byte = source_data;
+	source_mgr.bytes_in_buffer = source_size;
+	cinfo.src = &source_mgr;
+
+	/* read JPEG header information */
+	jpeg_read_header(&cinfo, TRUE);
+
+	/* set output processing parameters */
+	if (cinfo.jpeg_color_space == JCS_CMYK ||
+	    cinfo.jpeg_color_space == JCS_YCCK) {
+		cinfo.out_color_space = JCS_CMYK;
+	} else {
+#ifdef JCS_ALPHA_EXTENSIONS
+		switch (bitmap_fmt.layout) {
+		case BITMAP_LAYOUT_R8G8B8A8:
+			cinfo.out_color_space = JCS_EXT_RGBA;
+			break;
+		case BITMAP_LAYOUT_B8G8R8A8:
+			cinfo.out_color_space = JCS_EXT_BGRA;
+			break;
+		case BITMAP_LAYOUT_A8R8G8B8:
+			cinfo.out_color_space = JCS_EXT_ARGB;
+			break;
+		case BITMAP_LAYOUT_A8B8G8R8:
+			cinfo.out_color_space = JCS_EXT_ABGR;
+			break;
+		default:
+			NSLOG(netsurf, ERROR, "Unexpected bitmap format: %u",
+					bitmap_fmt.layout);
+			jpeg_destroy_decompress(&cinfo);
+			return NULL;
+		}
+#else
+		cinfo.out_color_space = JCS_RGB;
+#endif
+	}
+	cinfo.dct_method = JDCT_ISLOW;
+
+	/* commence the decompression, output parameters now valid */
+	jpeg_start_decompress(&cinfo);
+
+	if ((y1 <= y0) || ((unsigned int)y1 > cinfo.output_height)) {
+		jpeg_destroy_decompress(&cinfo);
+		return NULL;
+	}
+
+	/* create opaque bitmap holding just the band */
+	bitmap = guit->bitmap->create(cinfo.output_width, y1 - y0,
+			BITMAP_OPAQUE);
+	if (bitmap == NULL) {
+		/* empty bitmap could not be created */
+		jpeg_destroy_decompress(&cinfo);
+		return NULL;
+	}
+
+	pixels = guit->bitmap->get_buffer(bitmap);
+	if (pixels == NULL) {
+		/* bitmap with no buffer available */
+		guit->bitmap->destroy(bitmap);
+		jpeg_destroy_decompress(&cinfo);
+		return NULL;
+	}
+
+	rowstride = guit->bitmap->get_rowstride(bitmap);
+
+	/* decode and discard the rows above the band */
+	if (y0 > 0) {
+		scanbuf = malloc(cinfo.output_width *
+				cinfo.output_components);
+		if (scanbuf == NULL) {
+			guit->bitmap->destroy(bitmap);
+			jpeg_destroy_decompress(&cinfo);
+			return NULL;
+		}
+
+		while (cinfo.output_scanline < (unsigned int)y0) {
+			JSAMPROW scanlines[1] = {
+				[0] = (JSAMPROW)scanbuf,
+			};
+			jpeg_read_scanlines(&cinfo, scanlines, 1);
+		}
+
+		free(scanbuf);
+		scanbuf = NULL;
+	}
+
+	/* Convert the band's scanlines from jpeg into bitmap */
+	switch (cinfo.out_color_space) {
+	case JCS_CMYK:
+		nsjpeg__decode_cmyk(&cinfo, pixels, rowstride, y0, y1);
+		break;
+
+	case JCS_RGB:
+		nsjpeg__decode_rgb(&cinfo, pixels, rowstride, y0, y1);
+		break;
+
+	default:
+		nsjpeg__decode_client_fmt(&cinfo, pixels, rowstride, y0, y1);
+		break;
+	}
+
+	guit->bitmap->modified(bitmap);
+
+	/* rows below the band are never decoded */
+	jpeg_abort_decompress(&cinfo);
+	jpeg_destroy_decompress(&cinfo);
+
+	return bitmap;
+}
+
 /**
  * Convert a CONTENT_JPEG for display.
  */
@@ -430,7 +648,9 @@ static bool nsjpeg_convert(struct content *c)
 
 	jpeg_destroy_decompress(&cinfo);
 
-	image_cache_add(c, NULL, jpeg_cache_convert);
+	image_cache_add_banded(c, NULL, jpeg_cache_convert,
+			jpeg_cache_convert_scaled,
+			jpeg_cache_convert_band);
 
 	/* set title text */
 	title = messages_get_buff("JPEGTitle",
@@ -550,6 +550,142 @@ png_cache_convert_error:
 	return (struct bitmap *)bitmap;
 }
 
+/** PNG content to band bitmap conversion.
+ *
+ * Decodes rows [\a y0, \a y1) of a non-interlaced PNG into a bitmap
+ * holding just that band. Rows above the band are read into a scratch
+ * line and discarded, and reading stops at the end of the band, so
+ * the memory needed is bounded by the band size rather than the image.
+ *
+ * \param c The png content to decode.
+ * \param y0 First source row of the band.
+ * \param y1 One past the last source row of the band.
+ * \return A decoded band bitmap or NULL on error.
+ */
+static struct bitmap *
+png_cache_convert_band(struct content *c, int y0, int y1)
+{
+	png_structp png_ptr;
+	png_infop info_ptr;
+	png_infop end_info_ptr;
+	volatile struct bitmap * volatile bitmap = NULL;
+	struct png_cache_read_data_s png_cache_read_data;
+	png_uint_32 width, height;
+	uint8_t * volatile scanbuf = NULL;
+	uint8_t *buffer;
+	size_t rowstride;
+	int row;
+
+	png_cache_read_data.data =
+		content__get_source_data(c, &png_cache_read_data.size);
+
+	if ((png_cache_read_data.data == NULL) ||
+	    (png_cache_read_data.size <= 8)) {
+		return NULL;
+	}
+
+	png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL,
+			nspng_error, nspng_warning);
+	if (png_ptr == NULL) {
+		return NULL;
+	}
+
+	info_ptr = png_create_info_struct(png_ptr);
+	if (info_ptr == NULL) {
+		png_destroy_read_struct(&png_ptr, NULL, NULL);
+		return NULL;
+	}
+
+	end_info_ptr = png_create_info_struct(png_ptr);
+	if (end_info_ptr == NULL) {
+		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+		return NULL;
+	}
+
+	/* setup error exit path */
+	if (setjmp(png_jmpbuf(png_ptr))) {
+		/* cleanup and bail */
+		goto png_cache_convert_band_error;
+	}
+
+	/* read from a buffer instead of stdio */
+	png_set_read_fn(png_ptr, &png_cache_read_data, png_cache_read_fn);
+
+	/* ensure the png info structure is populated */
+	png_read_info(png_ptr, info_ptr);
+
+	/* band decode needs rows to arrive sequentially */
+	if (png_get_interlace_type(png_ptr, info_ptr) != PNG_INTERLACE_NONE) {
+		goto png_cache_convert_band_error;
+	}
+
+	/* setup output transforms */
+	nspng_setup_transforms(png_ptr, info_ptr);
+
+	width = png_get_image_width(png_ptr, info_ptr);
+	height = png_get_image_height(png_ptr, info_ptr);
+
+	if ((y1 <= y0) || ((png_uint_32)y1 > height)) {
+		goto png_cache_convert_band_error;
+	}
+
+	/* Claim the required memory for the band */
+	bitmap = guit->bitmap->create(width, y1 - y0, BITMAP_NONE);
+	if (bitmap == NULL) {
+		/* cleanup and bail */
+		goto png_cache_convert_band_error;
+	}
+
+	buffer = guit->bitmap->get_buffer((struct bitmap *) bitmap);
+	if (buffer == NULL) {
+		guit->bitmap->destroy((struct bitmap *) bitmap);
+		bitmap = NULL;
+		goto png_cache_convert_band_error;
+	}
+
+	rowstride = guit->bitmap->get_rowstride((struct bitmap *) bitmap);
+
+	/* decode and discard the rows above the band */
+	if (y0 > 0) {
+		scanbuf = malloc(png_get_rowbytes(png_ptr, info_ptr));
+		if (scanbuf == NULL) {
+			guit->bitmap->destroy((struct bitmap *) bitmap);
+			bitmap = NULL;
+			goto png_cache_convert_band_error;
+		}
+
+		for (row = 0; row < y0; row++) {
+			png_read_row(png_ptr, scanbuf, NULL);
+		}
+	}
+
+	/* decode the band itself; rows below it are never read */
+	for (row = y0; row < y1; row++) {
+		png_read_row(png_ptr, buffer + rowstride * (row - y0), NULL);
+	}
+
+png_cache_convert_band_error:
+
+	/* cleanup png read */
+	png_destroy_read_struct(&png_ptr, &info_ptr, &end_info_ptr);
+
+	if (scanbuf != NULL) {
+		free(scanbuf);
+	}
+
+	if (bitmap != NULL) {
+		bool opaque = bitmap_test_opaque((void *)bitmap);
+		guit->bitmap->set_opaque((void *)bitmap, opaque);
+		bitmap_format_to_client((void *)bitmap, &(bitmap_fmt_t) {
+			.layout = bitmap_fmt.layout,
+			.pma = opaque ? bitmap_fmt.pma : false,
+		});
+		guit->bitmap->modified((void *)bitmap);
+	}
+
+	return (struct bitmap *)bitmap;
+}
+
 static bool nspng_convert(struct content *c)
 {
 	nspng_content *png_c = (nspng_content *) c;
@@ -580,7 +716,8 @@ static bool nspng_convert(struct content *c)
 		guit->bitmap->modified(png_c->bitmap);
 	}
 
-	image_cache_add(c, png_c->bitmap, png_cache_convert);
+	image_cache_add_banded(c, png_c->bitmap, png_cache_convert,
+			NULL, png_cache_convert_band);
 
 	content_set_ready(c);
 	content_set_done(c);
@@ -92,10 +92,10 @@ rsvg_create(const content_handler *handler,
 
 
 /**
- * create a bitmap from jpeg content for the image cache.
+ * render svg content into a bitmap of the given size.
  */
 static struct bitmap *
-rsvg_cache_convert(struct content *c)
+rsvg_cache__render(struct content *c, int width, int height)
 {
 	rsvg_content *svgc = (rsvg_content *)c;
 	struct bitmap *bitmap;
@@ -104,7 +104,7 @@ rsvg_cache_convert(struct content *c)
 	RsvgRectangle viewport;
 	gboolean renderres;
 
-	if ((bitmap = guit->bitmap->create(c->width, c->height,	BITMAP_NONE)) == NULL) {
+	if ((bitmap = guit->bitmap->create(width, height, BITMAP_NONE)) == NULL) {
 		NSLOG(netsurf, INFO, "Failed to create bitmap for rsvg render.");
 		return NULL;
 	}
@@ -112,7 +112,7 @@ rsvg_cache_convert(struct content *c)
 	if ((cs = cairo_image_surface_create_for_data(
 		     (unsigned char *)guit->bitmap->get_buffer(bitmap),
 		     CAIRO_FORMAT_ARGB32,
-		     c->width, c->height,
+		     width, height,
 		     guit->bitmap->get_rowstride(bitmap))) == NULL) {
 		NSLOG(netsurf, INFO, "Failed to create Cairo image surface for rsvg render.");
 		guit->bitmap->destroy(bitmap);
@@ -128,10 +128,10 @@ rsvg_cache_convert(struct content *c)
 
 	viewport.x = 0;
 	viewport.y = 0;
-	viewport.width = c->width;
-	viewport.height = c->height;
+	viewport.width = width;
+	viewport.height = height;
 	renderres = rsvg_handle_render_document(svgc->rsvgh, cr, &viewport, NULL);
-	NSLOG(netsurf, DEBUG, "rsvg render:%d, width:%d, height %d", renderres, c->width, c->height);
+	NSLOG(netsurf, DEBUG, "rsvg render:%d, width:%d, height %d", renderres, width, height);
 
 	bitmap_format_to_client(bitmap, &(bitmap_fmt_t) {
 			.layout = BITMAP_LAYOUT_ARGB8888,
@@ -144,6 +144,28 @@ rsvg_cache_convert(struct content *c)
 	return bitmap;
 }
 
+/**
+ * create a bitmap from svg content for the image cache.
+ */
+static struct bitmap *
+rsvg_cache_convert(struct content *c)
+{
+	return rsvg_cache__render(c, c->width, c->height);
+}
+
+/**
+ * create a bitmap from svg content rendered at a reduced size.
+ *
+ * Rendering the vector at the displayed size gives a sharper result
+ * than scaling the natural size raster at plot time, as well as
+ * costing less to blit.
+ */
+static struct bitmap *
+rsvg_cache_convert_scaled(struct content *c, int width, int height)
+{
+	return rsvg_cache__render(c, width, height);
+}
+
 static void rsvg__get_demensions(const rsvg_content *svgc,
 		int *width, int *height)
 {
@@ -207,7 +229,8 @@ static bool rsvg_convert(struct content *c)
 
 	c->size = c->width * c->height * 4;
 
-	image_cache_add(c, NULL, rsvg_cache_convert);
+	image_cache_add_scaled(c, NULL, rsvg_cache_convert,
+			rsvg_cache_convert_scaled);
 
 	content_set_ready(c);
 	content_set_done(c);
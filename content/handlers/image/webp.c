@@ -170,6 +170,105 @@ webp_cache_convert(struct content *c)
 	return bitmap;
 }
 
+/**
+ * create a bitmap from webp content decoded at a reduced size.
+ */
+static struct bitmap *
+webp_cache_convert_scaled(struct content *c, int width, int height)
+{
+	const uint8_t *source_data; /* webp source data */
+	size_t source_size; /* length of webp source data */
+	VP8StatusCode webpres;
+	WebPDecoderConfig config;
+	unsigned int bmap_flags;
+	uint8_t *pixels = NULL;
+	size_t rowstride;
+	struct bitmap *bitmap = NULL;
+	bitmap_fmt_t webp_fmt = {
+		.layout = bitmap_fmt.layout,
+	};
+
+	source_data = content__get_source_data(c, &source_size);
+
+	if (WebPInitDecoderConfig(&config) == 0) {
+		return NULL;
+	}
+
+	webpres = WebPGetFeatures(source_data, source_size, &config.input);
+
+	if (webpres != VP8_STATUS_OK) {
+		return NULL;
+	}
+
+	if (config.input.has_alpha == 0) {
+		bmap_flags = BITMAP_OPAQUE;
+		/* Image has no alpha. Premultiplied alpha makes no difference.
+		 * Optimisation: Avoid unnecessary conversion by copying format.
+		 */
+		webp_fmt.pma = bitmap_fmt.pma;
+	} else {
+		bmap_flags = BITMAP_NONE;
+	}
+
+	/* create bitmap at the requested size */
+	bitmap = guit->bitmap->create(width, height, bmap_flags);
+	if (bitmap == NULL) {
+		/* empty bitmap could not be created */
+		return NULL;
+	}
+
+	pixels = guit->bitmap->get_buffer(bitmap);
+	if (pixels == NULL) {
+		/* bitmap with no buffer available */
+		guit->bitmap->destroy(bitmap);
+		return NULL;
+	}
+
+	rowstride = guit->bitmap->get_rowstride(bitmap);
+
+	switch (webp_fmt.layout) {
+	default:
+		/* WebP has no ABGR mode, fall back to default. */
+		webp_fmt.layout = BITMAP_LAYOUT_R8G8B8A8;
+		fallthrough;
+	case BITMAP_LAYOUT_R8G8B8A8:
+		config.output.colorspace = MODE_RGBA;
+		break;
+
+	case BITMAP_LAYOUT_B8G8R8A8:
+		config.output.colorspace = MODE_BGRA;
+		break;
+
+	case BITMAP_LAYOUT_A8R8G8B8:
+		config.output.colorspace = MODE_ARGB;
+		break;
+	}
+
+	/* have the webp library scale during decode, straight into
+	 * the bitmap's buffer
+	 */
+	config.options.use_scaling = 1;
+	config.options.scaled_width = width;
+	config.options.scaled_height = height;
+
+	config.output.is_external_memory = 1;
+	config.output.u.RGBA.rgba = pixels;
+	config.output.u.RGBA.stride = rowstride;
+	config.output.u.RGBA.size = rowstride * height;
+
+	webpres = WebPDecode(source_data, source_size, &config);
+	if (webpres != VP8_STATUS_OK) {
+		/* decode failed */
+		guit->bitmap->destroy(bitmap);
+		return NULL;
+	}
+
+	bitmap_format_to_client(bitmap, &webp_fmt);
+	guit->bitmap->modified(bitmap);
+
+	return bitmap;
+}
+
 /**
  * Convert the webp source data content.
  *
@@ -200,7 +299,8 @@ static bool webp_convert(struct content *c)
 	c->height = height;
 	c->size = c->width * c->height * 4;
 
-	image_cache_add(c, NULL, webp_cache_convert);
+	image_cache_add_scaled(c, NULL, webp_cache_convert,
+			webp_cache_convert_scaled);
 
 	content_set_ready(c);
 	content_set_done(c);
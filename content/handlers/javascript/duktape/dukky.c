@@ -25,14 +25,21 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 #include <nsutils/time.h>
 
 #include "netsurf/inttypes.h"
 #include "utils/utils.h"
 #include "utils/nsoption.h"
 #include "utils/log.h"
+#include "utils/memreport.h"
+#include "desktop/frame_budget.h"
+#include "desktop/perf_log.h"
 #include "utils/corestrings.h"
+#include "utils/hashmap.h"
+#include "netsurf/misc.h"
 #include "content/content.h"
+#include "desktop/gui_internal.h"
 
 #include "javascript/js.h"
 #include "javascript/content.h"
@@ -53,15 +60,70 @@
 #define GENERICS_MAGIC MAGIC(GENERICS_TABLE)
 #define THREAD_MAP MAGIC(THREAD_MAP)
 
+/* Pooled allocator for duktape heap allocations */
+
+/** Size of the blocks carved into pool cells */
+#define DUKKY_POOL_CHUNK_SIZE (16 * 1024)
+
+/** Flag set in a cell header for an allocation passed through to malloc */
+#define DUKKY_POOL_LARGE_FLAG (~(SIZE_MAX >> 1))
+
+/** Allocation size classes served from the pool; anything larger is
+ * passed through to malloc. Chosen for duktape's strongly
+ * small-object-biased allocation profile.
+ */
+static const size_t dukky_pool_class_size[] = {
+	16, 32, 48, 64, 96, 128, 192, 256
+};
+
+#define DUKKY_POOL_CLASSES NOF_ELEMENTS(dukky_pool_class_size)
+
+/**
+ * Header preceding every allocation handed to duktape.
+ *
+ * Holds the size class index for pooled cells, or the allocation size
+ * with DUKKY_POOL_LARGE_FLAG set for pass-through allocations. The
+ * union keeps the payload suitably aligned.
+ */
+union dukky_pool_header {
+	size_t info;
+	double align;
+};
+
+/**
+ * Per-heap allocation pool.
+ *
+ * Free cells are kept on per-class freelists threaded through the
+ * cell payloads. Backing chunks are never returned individually; the
+ * whole pool is released when its heap is destroyed, so a page's GC
+ * churn cannot fragment the process heap.
+ */
+struct dukky_pool {
+	void *chunks; /**< chain of backing chunks, linked by first word */
+	void *free_cells[DUKKY_POOL_CLASSES]; /**< per-class freelists */
+	size_t chunk_count; /**< number of backing chunks allocated */
+	size_t cells_in_use[DUKKY_POOL_CLASSES]; /**< live cells per class */
+	size_t large_count; /**< live pass-through allocations */
+	size_t large_bytes; /**< bytes in live pass-through allocations */
+};
+
+/** Bytes held by all heap pools, for memory accounting */
+static size_t dukky_pool_total_bytes = 0;
+
 /**
  * dukky javascript heap
  */
 struct jsheap {
 	duk_context *ctx; /**< duktape base context */
+	struct dukky_pool pool; /**< allocation pool backing \a ctx */
 	duk_uarridx_t next_thread; /**< monotonic thread counter */
 	bool pending_destroy; /**< Whether this heap is pending destruction */
 	unsigned int live_threads; /**< number of live threads */
 	uint64_t exec_start_time;
+	int timeout; /**< script execution timeout in seconds, 0 disables */
+	unsigned int gc_runs; /**< number of idle collections performed */
+	uint64_t gc_total_ms; /**< total time spent in idle collections */
+	uint64_t gc_max_pause_ms; /**< longest single idle collection */
 };
 
 /**
@@ -543,39 +605,564 @@ dukky_inject_not_ctr(duk_context *ctx, int idx, const char *name)
 /* We need to override the defaults because not all platforms are fully ANSI
  * compatible.  E.g. RISC OS gets upset if we malloc or realloc a zero byte
  * block, as do debugging tools such as Electric Fence by Bruce Perens.
+ *
+ * Beyond that, allocations up to 256 bytes are served from per-class
+ * freelists backed by chunks owned by the heap's pool, as the vast
+ * majority of duktape's allocations are small and short lived.
+ */
+
+/**
+ * Add a chunk of fresh cells to a size class freelist.
+ *
+ * \param pool The pool to refill
+ * \param class The size class needing cells
+ * \return true on success, false on memory exhaustion
+ */
+static bool dukky_pool_refill(struct dukky_pool *pool, size_t class)
+{
+	size_t stride = sizeof(union dukky_pool_header) +
+		dukky_pool_class_size[class];
+	size_t offset;
+	uint8_t *chunk;
+
+	chunk = malloc(DUKKY_POOL_CHUNK_SIZE);
+	if (chunk == NULL)
+		return false;
+
+	/* chain the chunk for wholesale release with the heap */
+	*(void **)(void *)chunk = pool->chunks;
+	pool->chunks = chunk;
+	pool->chunk_count++;
+	dukky_pool_total_bytes += DUKKY_POOL_CHUNK_SIZE;
+
+	/* carve the remainder into cells on the freelist */
+	for (offset = sizeof(union dukky_pool_header);
+	     offset + stride <= DUKKY_POOL_CHUNK_SIZE;
+	     offset += stride) {
+		union dukky_pool_header *hdr = (void *)(chunk + offset);
+		*(void **)(void *)(hdr + 1) = pool->free_cells[class];
+		pool->free_cells[class] = hdr;
+	}
+
+	return true;
+}
+
+/**
+ * Release a pool's backing chunks and log its usage for monitoring.
  */
+static void dukky_pool_fini(struct dukky_pool *pool)
+{
+	void *chunk;
+
+	NSLOG(dukky, DEBUG,
+	      "Heap pool held %"PRIsizet" chunks (%"PRIsizet" bytes), %"PRIsizet" large allocations (%"PRIsizet" bytes) still live",
+	      pool->chunk_count,
+	      pool->chunk_count * DUKKY_POOL_CHUNK_SIZE,
+	      pool->large_count,
+	      pool->large_bytes);
+
+	dukky_pool_total_bytes -= pool->chunk_count * DUKKY_POOL_CHUNK_SIZE;
+	dukky_pool_total_bytes -= pool->large_bytes;
+
+	while (pool->chunks != NULL) {
+		chunk = pool->chunks;
+		pool->chunks = *(void **)chunk;
+		free(chunk);
+	}
+	pool->chunk_count = 0;
+}
 
 static void *dukky_alloc_function(void *udata, duk_size_t size)
 {
+	jsheap *heap = udata;
+	union dukky_pool_header *hdr;
+	size_t class;
+
 	if (size == 0)
 		return NULL;
 
-	return malloc(size);
+	for (class = 0; class < DUKKY_POOL_CLASSES; class++) {
+		if (size <= dukky_pool_class_size[class])
+			break;
+	}
+
+	if (class == DUKKY_POOL_CLASSES) {
+		/* too large for the pool, pass through */
+		hdr = malloc(sizeof(*hdr) + size);
+		if (hdr == NULL)
+			return NULL;
+		hdr->info = size | DUKKY_POOL_LARGE_FLAG;
+		heap->pool.large_count++;
+		heap->pool.large_bytes += size;
+		dukky_pool_total_bytes += size;
+		return hdr + 1;
+	}
+
+	if (heap->pool.free_cells[class] == NULL &&
+	    dukky_pool_refill(&heap->pool, class) == false) {
+		return NULL;
+	}
+
+	hdr = heap->pool.free_cells[class];
+	heap->pool.free_cells[class] = *(void **)(void *)(hdr + 1);
+	hdr->info = class;
+	heap->pool.cells_in_use[class]++;
+
+	return hdr + 1;
+}
+
+static void dukky_free_function(void *udata, void *ptr)
+{
+	jsheap *heap = udata;
+	union dukky_pool_header *hdr;
+
+	if (ptr == NULL)
+		return;
+
+	hdr = (union dukky_pool_header *)ptr - 1;
+	if (hdr->info & DUKKY_POOL_LARGE_FLAG) {
+		heap->pool.large_count--;
+		heap->pool.large_bytes -= hdr->info & ~DUKKY_POOL_LARGE_FLAG;
+		dukky_pool_total_bytes -= hdr->info & ~DUKKY_POOL_LARGE_FLAG;
+		free(hdr);
+	} else {
+		*(void **)ptr = heap->pool.free_cells[hdr->info];
+		heap->pool.free_cells[hdr->info] = hdr;
+		heap->pool.cells_in_use[hdr->info]--;
+	}
 }
 
 static void *dukky_realloc_function(void *udata, void *ptr, duk_size_t size)
 {
+	jsheap *heap = udata;
+	union dukky_pool_header *hdr;
+	size_t osize;
+	void *nptr;
+
 	if (ptr == NULL && size == 0)
 		return NULL;
 
+	if (ptr == NULL)
+		return dukky_alloc_function(udata, size);
+
 	if (size == 0) {
-		free(ptr);
+		dukky_free_function(udata, ptr);
 		return NULL;
 	}
 
-	return realloc(ptr, size);
+	hdr = (union dukky_pool_header *)ptr - 1;
+	if (hdr->info & DUKKY_POOL_LARGE_FLAG) {
+		osize = hdr->info & ~DUKKY_POOL_LARGE_FLAG;
+		if (size > dukky_pool_class_size[DUKKY_POOL_CLASSES - 1]) {
+			/* large to large, let libc move it */
+			hdr = realloc(hdr, sizeof(*hdr) + size);
+			if (hdr == NULL)
+				return NULL;
+			hdr->info = size | DUKKY_POOL_LARGE_FLAG;
+			heap->pool.large_bytes += size - osize;
+			dukky_pool_total_bytes += size - osize;
+			return hdr + 1;
+		}
+	} else {
+		osize = dukky_pool_class_size[hdr->info];
+		if (size <= osize) {
+			/* still fits the cell it is in */
+			return ptr;
+		}
+	}
+
+	nptr = dukky_alloc_function(udata, size);
+	if (nptr == NULL)
+		return NULL;
+	memcpy(nptr, ptr, (osize < size) ? osize : size);
+	dukky_free_function(udata, ptr);
+
+	return nptr;
 }
 
+/* Bytecode cache for compiled scripts */
 
-static void dukky_free_function(void *udata, void *ptr)
+/** Upper bound on memory retained by the script bytecode cache */
+#define DUKKY_BYTECODE_CACHE_LIMIT (4 * 1024 * 1024)
+
+/**
+ * Key for the script bytecode cache.
+ *
+ * A copy of the script source is kept in the key so a hash collision
+ * can never substitute one script for another.  The compile filename
+ * is part of the key as it is baked into the compiled function and
+ * surfaces in stack traces.
+ */
+typedef struct {
+	uint8_t *src; /**< Script source bytes */
+	size_t src_len; /**< Length of script source */
+	char *name; /**< Filename the script was compiled with */
+	duk_uint_t flags; /**< Compile flags the script was compiled with */
+} dukky_bytecode_key;
+
+/**
+ * Cached serialised bytecode for one script.
+ */
+typedef struct {
+	uint8_t *bytecode; /**< Serialised function from duk_dump_function() */
+	size_t len; /**< Length of serialised function */
+	uint64_t last_used; /**< Monotonic time of last use, for eviction */
+} dukky_bytecode_entry;
+
+/** The script bytecode cache, or NULL if unavailable */
+static hashmap_t *dukky_bytecode_cache = NULL;
+
+/** Memory currently retained by the script bytecode cache */
+static size_t dukky_bytecode_cache_size = 0;
+
+static inline uint32_t dukky_bytecode_fnv(const uint8_t *datum, size_t len)
+{
+	uint32_t z = 0x811c9dc5;
+
+	while (len > 0) {
+		z *= 0x01000193;
+		z ^= *datum++;
+		len--;
+	}
+
+	return z;
+}
+
+static uint32_t dukky_bytecode_key_hash(void *key)
+{
+	dukky_bytecode_key *bkey = key;
+
+	return dukky_bytecode_fnv(bkey->src, bkey->src_len) ^
+		dukky_bytecode_fnv((const uint8_t *)bkey->name,
+				   strlen(bkey->name)) ^
+		(uint32_t)bkey->flags;
+}
+
+static bool dukky_bytecode_key_eq(void *key1, void *key2)
+{
+	dukky_bytecode_key *bkey1 = key1;
+	dukky_bytecode_key *bkey2 = key2;
+
+	return (bkey1->src_len == bkey2->src_len) &&
+		(bkey1->flags == bkey2->flags) &&
+		(memcmp(bkey1->src, bkey2->src, bkey1->src_len) == 0) &&
+		(strcmp(bkey1->name, bkey2->name) == 0);
+}
+
+static void *dukky_bytecode_key_clone(void *key)
+{
+	dukky_bytecode_key *okey = key;
+	dukky_bytecode_key *nkey;
+
+	nkey = calloc(1, sizeof(*nkey));
+	if (nkey == NULL)
+		return NULL;
+
+	nkey->src = malloc(okey->src_len);
+	nkey->name = strdup(okey->name);
+	if (nkey->src == NULL || nkey->name == NULL) {
+		free(nkey->src);
+		free(nkey->name);
+		free(nkey);
+		return NULL;
+	}
+	memcpy(nkey->src, okey->src, okey->src_len);
+	nkey->src_len = okey->src_len;
+	nkey->flags = okey->flags;
+
+	dukky_bytecode_cache_size += sizeof(*nkey) + nkey->src_len +
+		strlen(nkey->name) + 1;
+
+	return nkey;
+}
+
+static void dukky_bytecode_key_destroy(void *key)
+{
+	dukky_bytecode_key *bkey = key;
+
+	dukky_bytecode_cache_size -= sizeof(*bkey) + bkey->src_len +
+		strlen(bkey->name) + 1;
+
+	free(bkey->src);
+	free(bkey->name);
+	free(bkey);
+}
+
+static void *dukky_bytecode_value_alloc(void *key)
+{
+	dukky_bytecode_entry *entry = calloc(1, sizeof(dukky_bytecode_entry));
+
+	if (entry != NULL) {
+		dukky_bytecode_cache_size += sizeof(*entry);
+	}
+
+	return entry;
+}
+
+static void dukky_bytecode_value_destroy(void *value)
+{
+	dukky_bytecode_entry *entry = value;
+
+	dukky_bytecode_cache_size -= sizeof(*entry) + entry->len;
+
+	free(entry->bytecode);
+	free(entry);
+}
+
+static hashmap_parameters_t dukky_bytecode_cache_parameters = {
+	.key_clone = dukky_bytecode_key_clone,
+	.key_destroy = dukky_bytecode_key_destroy,
+	.key_eq = dukky_bytecode_key_eq,
+	.key_hash = dukky_bytecode_key_hash,
+	.value_alloc = dukky_bytecode_value_alloc,
+	.value_destroy = dukky_bytecode_value_destroy,
+};
+
+/** context for the bytecode cache eviction iterator */
+struct dukky_bytecode_evict_ctx {
+	const dukky_bytecode_key *keep; /**< key which must not be chosen */
+	dukky_bytecode_key *victim; /**< oldest key seen so far */
+	uint64_t victim_used; /**< last use time of \a victim */
+};
+
+static bool dukky_bytecode_evict_cb(void *key, void *value, void *ctx)
+{
+	struct dukky_bytecode_evict_ctx *ectx = ctx;
+	dukky_bytecode_entry *entry = value;
+
+	if (dukky_bytecode_key_eq(key, (void *)ectx->keep)) {
+		return false;
+	}
+
+	if (ectx->victim == NULL || entry->last_used < ectx->victim_used) {
+		ectx->victim = key;
+		ectx->victim_used = entry->last_used;
+	}
+
+	return false;
+}
+
+/**
+ * Bring the bytecode cache back under its memory limit.
+ *
+ * Evicts least recently used entries until within budget.
+ *
+ * \param keep The key of the entry just added which is exempt
+ */
+static void dukky_bytecode_clean(const dukky_bytecode_key *keep)
 {
-	if (ptr != NULL)
-		free(ptr);
+	struct dukky_bytecode_evict_ctx ectx;
+
+	while (dukky_bytecode_cache_size > DUKKY_BYTECODE_CACHE_LIMIT) {
+		ectx.keep = keep;
+		ectx.victim = NULL;
+		ectx.victim_used = 0;
+		hashmap_iterate(dukky_bytecode_cache,
+				dukky_bytecode_evict_cb, &ectx);
+		if (ectx.victim == NULL) {
+			break;
+		}
+		hashmap_remove(dukky_bytecode_cache, ectx.victim);
+	}
+}
+
+static duk_ret_t dukky_bytecode_load_helper(duk_context *ctx, void *udata)
+{
+	duk_load_function(ctx);
+	return 1;
+}
+
+/**
+ * Push a cached compiled function for a script if one is available.
+ *
+ * \param ctx The duktape context to push onto
+ * \param src The script source
+ * \param srclen The length of the script source
+ * \param name The filename the script would be compiled with
+ * \param flags The compile flags the script would be compiled with
+ * \return true if the compiled function was pushed, false on cache miss
+ */
+static bool
+dukky_bytecode_find(duk_context *ctx,
+		    const uint8_t *src,
+		    size_t srclen,
+		    const char *name,
+		    duk_uint_t flags)
+{
+	dukky_bytecode_key key;
+	dukky_bytecode_entry *entry;
+	void *buf;
+
+	if (dukky_bytecode_cache == NULL) {
+		return false;
+	}
+
+	key.src = (uint8_t *)src;
+	key.src_len = srclen;
+	key.name = (char *)name;
+	key.flags = flags;
+
+	entry = hashmap_lookup(dukky_bytecode_cache, &key);
+	if (entry == NULL) {
+		return false;
+	}
+
+	buf = duk_push_fixed_buffer(ctx, entry->len);
+	memcpy(buf, entry->bytecode, entry->len);
+	if (duk_safe_call(ctx, dukky_bytecode_load_helper, NULL, 1, 1) != 0) {
+		/* Should never happen as we serialised it ourselves,
+		 * but drop the entry and fall back to compiling
+		 */
+		NSLOG(dukky, WARNING, "Unable to load cached bytecode for %s",
+		      name);
+		duk_pop(ctx);
+		hashmap_remove(dukky_bytecode_cache, &key);
+		return false;
+	}
+
+	(void) nsu_getmonotonic_ms(&entry->last_used);
+
+	NSLOG(dukky, DEEPDEBUG, "Bytecode cache hit for %s", name);
+
+	return true;
+}
+
+/**
+ * Store the compiled function at the top of the stack in the cache.
+ *
+ * The stack is unchanged on exit and failure to cache is not an error.
+ *
+ * \param ctx The duktape context with the compiled function on top
+ * \param src The script source the function was compiled from
+ * \param srclen The length of the script source
+ * \param name The filename the script was compiled with
+ * \param flags The compile flags the script was compiled with
+ */
+static void
+dukky_bytecode_store(duk_context *ctx,
+		     const uint8_t *src,
+		     size_t srclen,
+		     const char *name,
+		     duk_uint_t flags)
+{
+	dukky_bytecode_key key;
+	dukky_bytecode_entry *entry;
+	void *buf;
+	duk_size_t buflen;
+
+	if (dukky_bytecode_cache == NULL) {
+		return;
+	}
+
+	if (!duk_is_ecmascript_function(ctx, -1)) {
+		return;
+	}
+
+	duk_dup_top(ctx);
+	duk_dump_function(ctx);
+	/* ..., function, bytecode */
+	buf = duk_get_buffer(ctx, -1, &buflen);
+	if (buf == NULL || buflen == 0 ||
+	    (buflen + srclen) > (DUKKY_BYTECODE_CACHE_LIMIT / 2)) {
+		duk_pop(ctx);
+		return;
+	}
+
+	key.src = (uint8_t *)src;
+	key.src_len = srclen;
+	key.name = (char *)name;
+	key.flags = flags;
+
+	entry = hashmap_insert(dukky_bytecode_cache, &key);
+	if (entry == NULL) {
+		duk_pop(ctx);
+		return;
+	}
+
+	entry->bytecode = malloc(buflen);
+	if (entry->bytecode == NULL) {
+		hashmap_remove(dukky_bytecode_cache, &key);
+		duk_pop(ctx);
+		return;
+	}
+	memcpy(entry->bytecode, buf, buflen);
+	entry->len = buflen;
+	dukky_bytecode_cache_size += buflen;
+	(void) nsu_getmonotonic_ms(&entry->last_used);
+
+	duk_pop(ctx);
+	/* ..., function */
+
+	dukky_bytecode_clean(&key);
+}
+
+/**
+ * Compile a script, satisfying it from the bytecode cache if possible.
+ *
+ * On success the compiled function is left at the top of the stack
+ * and zero returned, otherwise the error is left at the top of the
+ * stack as duk_pcompile() would leave it.
+ *
+ * \param ctx The duktape context to compile within
+ * \param name The filename to attribute the script to
+ * \param src The script source
+ * \param srclen The length of the script source
+ * \param flags The DUK_COMPILE flags to compile with
+ * \return zero on success, non-zero on compile error
+ */
+static duk_int_t
+dukky_pcompile_cached(duk_context *ctx,
+		      const char *name,
+		      const uint8_t *src,
+		      size_t srclen,
+		      duk_uint_t flags)
+{
+	if (dukky_bytecode_find(ctx, src, srclen, name, flags)) {
+		return 0;
+	}
+
+	duk_push_string(ctx, name);
+	if (duk_pcompile_lstring_filename(ctx, flags,
+					  (const char *)src, srclen) != 0) {
+		return -1;
+	}
+
+	dukky_bytecode_store(ctx, src, srclen, name, flags);
+
+	return 0;
+}
+
+/** Delay before rebuilding the spare heap once one is handed out (ms)
+ *
+ * Long enough that the navigation which consumed the spare heap is
+ * not competing with its replacement's construction.
+ */
+#define DUKKY_SPARE_HEAP_DELAY_MS 500
+
+/** A spare initialised heap ready for the next navigation, or NULL */
+static jsheap *dukky_spare_heap = NULL;
+
+static void dukky_replenish_spare_heap(void *p);
+
+/**
+ * Report the combined javascript heap usage for memory accounting.
+ */
+static size_t dukky_memreport(void *pw)
+{
+	return dukky_pool_total_bytes;
 }
 
 /* exported interface documented in js.h */
 void js_initialise(void)
 {
+	memreport_register("Javascript heaps", dukky_memreport, NULL);
+
+	dukky_bytecode_cache = hashmap_create(&dukky_bytecode_cache_parameters);
+	if (dukky_bytecode_cache == NULL) {
+		NSLOG(dukky, WARNING,
+		      "Unable to create bytecode cache, scripts will always be compiled");
+	}
+
 	/** TODO: Forces JS on for our testing, needs changing before a release
 	 * lest we incur the wrath of others.
 	 */
@@ -589,13 +1176,31 @@ void js_initialise(void)
 /* exported interface documented in js.h */
 void js_finalise(void)
 {
-	/* NADA for now */
+	guit->misc->schedule(-1, dukky_replenish_spare_heap, NULL);
+	if (dukky_spare_heap != NULL) {
+		js_destroyheap(dukky_spare_heap);
+		dukky_spare_heap = NULL;
+	}
+
+	if (dukky_bytecode_cache != NULL) {
+		hashmap_destroy(dukky_bytecode_cache);
+		dukky_bytecode_cache = NULL;
+	}
+
+	memreport_unregister("Javascript heaps");
 }
 
 
-/* exported interface documented in js.h */
-nserror
-js_newheap(int timeout, jsheap **heap)
+/**
+ * Build a fully initialised duktape heap.
+ *
+ * Creating the prototypes for the whole binding environment is the
+ * expensive part of heap construction.
+ *
+ * \param heap Pointer to recieve the new heap
+ * \return NSERROR_OK on success else appropriate error code
+ */
+static nserror dukky_build_heap(jsheap **heap)
 {
 	duk_context *ctx;
 	jsheap *ret = calloc(1, sizeof(*ret));
@@ -608,7 +1213,11 @@ js_newheap(int timeout, jsheap **heap)
 		dukky_free_function,
 		ret,
 		NULL);
-	if (ret->ctx == NULL) { free(ret); return NSERROR_NOMEM; }
+	if (ret->ctx == NULL) {
+		dukky_pool_fini(&ret->pool);
+		free(ret);
+		return NSERROR_NOMEM;
+	}
 	/* Create the prototype stuffs */
 	duk_push_global_object(ctx);
 	duk_push_boolean(ctx, true);
@@ -624,13 +1233,99 @@ js_newheap(int timeout, jsheap **heap)
 	return NSERROR_OK;
 }
 
+/**
+ * Scheduler callback to rebuild the spare heap.
+ */
+static void dukky_replenish_spare_heap(void *p)
+{
+	if (dukky_spare_heap == NULL) {
+		if (dukky_build_heap(&dukky_spare_heap) != NSERROR_OK) {
+			/* No spare; the next heap is built synchronously */
+			dukky_spare_heap = NULL;
+		}
+	}
+}
+
+/** Interval between idle collections on a live heap (ms) */
+#define DUKKY_IDLE_GC_MS 1000
+
+/**
+ * Scheduler callback to collect garbage while the heap is idle.
+ *
+ * Left to itself duktape starts voluntary mark-and-sweep from
+ * whichever allocation happens to trip its counter, which can be the
+ * middle of a reflow or a paint. Collecting from the scheduler
+ * instead resets that counter between events, so pauses
+ * preferentially land where nothing is being rendered. Emergency
+ * collections under allocation pressure cannot be prevented by this,
+ * only made rarer.
+ *
+ * \param p The heap to collect
+ */
+static void dukky_heap_gc(void *p)
+{
+	jsheap *heap = p;
+	uint64_t start_ms = 0, end_ms = 0, pause_ms;
+
+	(void) nsu_getmonotonic_ms(&start_ms);
+	duk_gc(heap->ctx, 0);
+	(void) nsu_getmonotonic_ms(&end_ms);
+
+	pause_ms = end_ms - start_ms;
+	perf_log_sample(PERF_LOG_GC_PAUSE, pause_ms);
+	heap->gc_runs++;
+	heap->gc_total_ms += pause_ms;
+	if (pause_ms > heap->gc_max_pause_ms) {
+		heap->gc_max_pause_ms = pause_ms;
+	}
+
+	guit->misc->schedule(DUKKY_IDLE_GC_MS, dukky_heap_gc, heap);
+}
+
+/* exported interface documented in js.h */
+nserror
+js_newheap(int timeout, jsheap **heap)
+{
+	nserror res = NSERROR_OK;
+
+	if (dukky_spare_heap != NULL) {
+		/* Hand out the heap prepared earlier */
+		*heap = dukky_spare_heap;
+		dukky_spare_heap = NULL;
+	} else {
+		res = dukky_build_heap(heap);
+	}
+
+	if (res == NSERROR_OK) {
+		(*heap)->timeout = timeout;
+
+		/* Prepare a replacement off the critical path once the
+		 * navigation which wanted this heap has settled
+		 */
+		guit->misc->schedule(DUKKY_SPARE_HEAP_DELAY_MS,
+				     dukky_replenish_spare_heap, NULL);
+
+		/* Pace collections from idle time rather than from
+		 * allocation pressure
+		 */
+		guit->misc->schedule(DUKKY_IDLE_GC_MS, dukky_heap_gc, *heap);
+	}
+
+	return res;
+}
+
 
 static void dukky_destroyheap(jsheap *heap)
 {
 	assert(heap->pending_destroy == true);
 	assert(heap->live_threads == 0);
 	NSLOG(dukky, DEBUG, "Destroying duktape javascript context");
+	guit->misc->schedule(-1, dukky_heap_gc, heap);
+	NSLOG(dukky, DEBUG,
+	      "Idle GC ran %u times for %"PRIu64"ms, max pause %"PRIu64"ms",
+	      heap->gc_runs, heap->gc_total_ms, heap->gc_max_pause_ms);
 	duk_destroy_heap(heap->ctx);
+	dukky_pool_fini(&heap->pool);
 	free(heap);
 }
 
@@ -697,10 +1392,9 @@ nserror js_newthread(jsheap *heap, void *win_priv, void *doc_priv, jsthread **th
 
 	/* Now load the polyfills */
 	/* ... */
-	duk_push_string(CTX, "polyfill.js");
-	/* ..., polyfill.js */
-	if (duk_pcompile_lstring_filename(CTX, DUK_COMPILE_EVAL,
-					  (const char *)polyfill_js, polyfill_js_len) != 0) {
+	if (dukky_pcompile_cached(CTX, "polyfill.js",
+				  polyfill_js, polyfill_js_len,
+				  DUK_COMPILE_EVAL) != 0) {
 		NSLOG(dukky, CRITICAL, "%s", duk_safe_to_string(CTX, -1));
 		NSLOG(dukky, CRITICAL, "Unable to compile polyfill.js, thread aborted");
 		js_destroythread(ret);
@@ -718,10 +1412,9 @@ nserror js_newthread(jsheap *heap, void *win_priv, void *doc_priv, jsthread **th
 
 	/* Now load the NetSurf table in */
 	/* ... */
-	duk_push_string(CTX, "generics.js");
-	/* ..., generics.js */
-	if (duk_pcompile_lstring_filename(CTX, DUK_COMPILE_EVAL,
-					  (const char *)generics_js, generics_js_len) != 0) {
+	if (dukky_pcompile_cached(CTX, "generics.js",
+				  generics_js, generics_js_len,
+				  DUK_COMPILE_EVAL) != 0) {
 		NSLOG(dukky, CRITICAL, "%s", duk_safe_to_string(CTX, -1));
 		NSLOG(dukky, CRITICAL, "Unable to compile generics.js, thread aborted");
 		js_destroythread(ret);
@@ -839,10 +1532,14 @@ static void dukky_leave_thread(jsthread *thread)
 
 duk_bool_t dukky_check_timeout(void *udata)
 {
-#define JS_EXEC_TIMEOUT_MS 10000 /* 10 seconds */
 	jsheap *heap = (jsheap *) udata;
 	uint64_t now;
 
+	if (heap->timeout <= 0) {
+		/* Timeout disabled for this heap */
+		return false;
+	}
+
 	(void) nsu_getmonotonic_ms(&now);
 
 	/* This function may be called during duk heap construction,
@@ -850,7 +1547,8 @@ duk_bool_t dukky_check_timeout(void *udata)
 	 * start time.
 	 */
 	return heap->exec_start_time != 0 &&
-			now > (heap->exec_start_time + JS_EXEC_TIMEOUT_MS);
+			now > (heap->exec_start_time +
+			       ((uint64_t)heap->timeout * 1000));
 }
 
 static void dukky_dump_error(duk_context *ctx)
@@ -873,18 +1571,29 @@ static void dukky_reset_start_time(duk_context *ctx)
 	(void) nsu_getmonotonic_ms(&heap->exec_start_time);
 }
 
+/** Re-entry depth of dukky_pcall, so only outermost calls are timed */
+static unsigned int dukky_pcall_depth = 0;
+
 duk_int_t dukky_pcall(duk_context *ctx, duk_size_t argc, bool reset_timeout)
 {
 	if (reset_timeout) {
 		dukky_reset_start_time(ctx);
 	}
 
+	if (dukky_pcall_depth++ == 0) {
+		frame_budget_enter(FRAME_BUDGET_SCRIPT);
+	}
+
 	duk_int_t ret = duk_pcall(ctx, argc);
 	if (ret) {
 		/* Something went wrong calling this... */
 		dukky_dump_error(ctx);
 	}
 
+	if (--dukky_pcall_depth == 0) {
+		frame_budget_leave(FRAME_BUDGET_SCRIPT);
+	}
+
 	return ret;
 }
 
@@ -940,15 +1649,9 @@ js_exec(jsthread *thread, const uint8_t *txt, size_t txtlen, const char *name)
 	/* NSLOG(dukky, DEEPDEBUG, "\n%s\n", txt); */
 
 	dukky_reset_start_time(CTX);
-	if (name != NULL) {
-		duk_push_string(CTX, name);
-	} else {
-		duk_push_string(CTX, "?unknown source?");
-	}
-	if (duk_pcompile_lstring_filename(CTX,
-					  DUK_COMPILE_EVAL,
-					  (const char *)txt,
-					  txtlen) != 0) {
+	if (dukky_pcompile_cached(CTX,
+				  (name != NULL) ? name : "?unknown source?",
+				  txt, txtlen, DUK_COMPILE_EVAL) != 0) {
 		NSLOG(dukky, DEBUG, "Failed to compile JavaScript input");
 		goto handle_error;
 	}
@@ -1117,15 +1820,31 @@ bool dukky_get_current_value_of_event_handler(duk_context *ctx,
 		/* ... node prefix handlercode suffix */
 		duk_concat(ctx, 3);
 		/* ... node fullhandlersrc */
-		duk_push_string(ctx, "internal raw uncompiled handler");
-		/* ... node fullhandlersrc filename */
-		if (duk_pcompile(ctx, DUK_COMPILE_FUNCTION) != 0) {
-			/* ... node err */
-			NSLOG(dukky, DEBUG,
-			      "Unable to proceed with handler, could not compile");
-			duk_pop_2(ctx);
-			return false;
+		{
+			/* Attribute defined handlers fire for every
+			 * dispatch, so compile through the bytecode
+			 * cache; event floods then reuse the compiled
+			 * handler instead of recompiling it per event,
+			 * and identical handler text shares one entry
+			 * across nodes.
+			 */
+			duk_size_t srclen;
+			const char *src = duk_get_lstring(ctx, -1, &srclen);
+
+			if (dukky_pcompile_cached(
+				    ctx,
+				    "internal raw uncompiled handler",
+				    (const uint8_t *)src, srclen,
+				    DUK_COMPILE_FUNCTION) != 0) {
+				/* ... node fullhandlersrc err */
+				NSLOG(dukky, DEBUG,
+				      "Unable to proceed with handler, could not compile");
+				duk_pop_3(ctx);
+				return false;
+			}
 		}
+		/* ... node fullhandlersrc handler */
+		duk_replace(ctx, -2);
 		/* ... node handler */
 		duk_insert(ctx, -2);
 		/* ... handler node */
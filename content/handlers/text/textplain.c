@@ -68,6 +68,7 @@ typedef struct textplain_content {
 	unsigned long physical_line_count;
 	struct textplain_line *physical_line;
 	int formatted_width;
+	size_t formatted_columns;
 	struct browser_window *bw;
 
 	struct selection *sel; /** Selection state */
@@ -168,6 +169,7 @@ textplain_create_internal(textplain_content *c, lwc_string *encoding)
 	c->physical_line = 0;
 	c->physical_line_count = 0;
 	c->formatted_width = 0;
+	c->formatted_columns = 0;
 	c->bw = NULL;
 	c->sel = selection_create((struct content *)c);
 
@@ -252,6 +254,9 @@ textplain_copy_utf8_data(textplain_content *c, const uint8_t *buf, size_t len)
 	memcpy(c->utf8_data + c->utf8_data_size, buf, len);
 	c->utf8_data_size += len;
 
+	/* new data invalidates any previously computed line breaks */
+	c->formatted_columns = 0;
+
 	return true;
 }
 
@@ -428,7 +433,23 @@ static void textplain_reformat(struct content *c, int width, int height)
 	columns = (width - MARGIN - MARGIN) * 8 / character_width;
 	textplain_tab_width = (TAB_WIDTH * character_width) / 8;
 
+	/* line breaks depend only on the column count, so if that is
+	 * unchanged the physical line records from the previous
+	 * reformat are still valid and the document need not be
+	 * re-scanned; just adopt the new width
+	 */
+	if (text->physical_line != NULL &&
+	    text->formatted_columns == columns &&
+	    columns != 0) {
+		text->formatted_width = width;
+		c->width = width;
+		c->height = text->physical_line_count *
+				textplain_line_height() + MARGIN + MARGIN;
+		return;
+	}
+
 	text->formatted_width = width;
+	text->formatted_columns = 0;
 
 	text->physical_line_count = 0;
 
@@ -448,11 +469,20 @@ static void textplain_reformat(struct content *c, int width, int height)
 		uint32_t chr;
 		bool term;
 		size_t next_col;
-		parserutils_error perror;
 
-		perror = parserutils_charset_utf8_to_ucs4((const uint8_t *)utf8_data + i, utf8_data_size - i, &chr, &csize);
-		if (perror != PARSERUTILS_OK) {
-			chr = 0xfffd;
+		if ((unsigned char)utf8_data[i] < 0x80) {
+			/* ASCII, which is the common case by far for
+			 * the large logs and data files viewed as
+			 * text, needs no decoding */
+			chr = (unsigned char)utf8_data[i];
+			csize = 1;
+		} else {
+			parserutils_error perror;
+
+			perror = parserutils_charset_utf8_to_ucs4((const uint8_t *)utf8_data + i, utf8_data_size - i, &chr, &csize);
+			if (perror != PARSERUTILS_OK) {
+				chr = 0xfffd;
+			}
 		}
 
 		term = (chr == '\n' || chr == '\r');
@@ -506,6 +536,7 @@ static void textplain_reformat(struct content *c, int width, int height)
 	line[line_count].start = utf8_data_size;
 
 	text->physical_line_count = line_count;
+	text->formatted_columns = columns;
 	c->width = width;
 	c->height = line_count * textplain_line_height() + MARGIN + MARGIN;
 
@@ -674,6 +674,28 @@ void hlcache_finalise(void)
 	llcache_finalise();
 }
 
+/* See hlcache.h for documentation */
+nserror hlcache_get_stats(struct hlcache_stats *stats)
+{
+	hlcache_entry *entry;
+
+	if ((hlcache == NULL) || (stats == NULL)) {
+		return NSERROR_BAD_PARAMETER;
+	}
+
+	stats->hit_count = hlcache->hit_count;
+	stats->miss_count = hlcache->miss_count;
+
+	stats->content_count = 0;
+	for (entry = hlcache->content_list;
+	     entry != NULL;
+	     entry = entry->next) {
+		stats->content_count++;
+	}
+
+	return NSERROR_OK;
+}
+
 /* See hlcache.h for documentation */
 nserror
 hlcache_handle_retrieve(nsurl *url,
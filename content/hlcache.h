@@ -94,6 +94,23 @@ void hlcache_stop(void);
  */
 void hlcache_finalise(void);
 
+/**
+ * High-level cache usage statistics
+ */
+struct hlcache_stats {
+	unsigned int hit_count; /**< retrievals which reused a content */
+	unsigned int miss_count; /**< retrievals which created a content */
+	unsigned int content_count; /**< number of contents currently cached */
+};
+
+/**
+ * Retrieve high-level cache usage statistics
+ *
+ * \param stats Updated with the current statistics.
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+nserror hlcache_get_stats(struct hlcache_stats *stats);
+
 /**
  * Retrieve a high-level cache handle for an object
  *
@@ -31,6 +31,7 @@
  *
  */
 
+#include <assert.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
@@ -42,6 +43,7 @@
 #include "utils/config.h"
 #include "utils/corestrings.h"
 #include "utils/log.h"
+#include "utils/memreport.h"
 #include "utils/messages.h"
 #include "utils/nsurl.h"
 #include "utils/utils.h"
@@ -50,6 +52,7 @@
 #include "utils/nsoption.h"
 #include "netsurf/misc.h"
 #include "desktop/gui_internal.h"
+#include "desktop/perf_log.h"
 
 #include "content/fetch.h"
 #include "content/backing_store.h"
@@ -145,6 +148,9 @@ typedef struct {
 	int age;		/**< Age: response header */
 	int max_age;		/**< Max-Age Cache-control parameter */
 	llcache_validate no_cache;	/**< No-Cache Cache-control parameter */
+	bool immutable;		/**< Immutable Cache-control parameter */
+	/** Stale-While-Revalidate Cache-control parameter (seconds) */
+	int stale_while_revalidate;
 	char *etag;		/**< Etag: response header */
 	time_t last_modified;	/**< Last-Modified: response header */
 } llcache_cache_control;
@@ -153,8 +159,30 @@ typedef struct {
 typedef struct {
 	char *name;		/**< Header name */
 	char *value;		/**< Header value */
+	/** Whether name points at the static interned name table. If
+	 * so value is the entry's sole allocation, otherwise name is a
+	 * single block holding both strings.
+	 */
+	bool name_interned;
 } llcache_header;
 
+/** Number of buckets in the source data deduplication index */
+#define LLCACHE_DEDUP_BUCKETS 64
+
+/**
+ * Entry in the content-addressed source data index
+ *
+ * Identical payloads fetched from different URLs share a single
+ * source buffer through these reference counted entries.
+ */
+typedef struct llcache_dedup_entry {
+	struct llcache_dedup_entry *next; /**< Next entry in bucket */
+	uint64_t hash;		/**< Hash of the shared data */
+	size_t len;		/**< Byte length of the shared data */
+	uint8_t *data;		/**< The shared source data buffer */
+	unsigned int refs;	/**< Number of objects using the buffer */
+} llcache_dedup_entry;
+
 /** Current status of an object's data */
 typedef enum {
 	LLCACHE_STATE_RAM = 0, /**< source data is stored in RAM only */
@@ -170,6 +198,9 @@ struct llcache_object {
 	llcache_object *prev;	     /**< Previous in list */
 	llcache_object *next;	     /**< Next in list */
 
+	llcache_object *lru_prev;    /**< More recently used cached object */
+	llcache_object *lru_next;    /**< Less recently used cached object */
+
 	nsurl *url;		     /**< Post-redirect URL for object */
 
 	/** \todo We need a generic dynamic buffer object */
@@ -181,6 +212,8 @@ struct llcache_object {
 
 	llcache_store_state store_state; /**< where the data for the object is stored */
 
+	bool source_shared;	     /**< source data is in the dedup index */
+
 	llcache_object_user *users;  /**< List of users */
 
 	llcache_fetch_ctx fetch;     /**< Fetch context for object */
@@ -214,6 +247,15 @@ struct llcache_s {
 	/** Head of the low-level uncached object list */
 	llcache_object *uncached_objects;
 
+	/** Most recently used cached object */
+	llcache_object *lru_head;
+
+	/** Least recently used cached object */
+	llcache_object *lru_tail;
+
+	/** Content hash index of complete source data buffers */
+	llcache_dedup_entry *dedup[LLCACHE_DEDUP_BUCKETS];
+
 	/** The target upper bound for the RAM cache size */
 	uint32_t limit;
 
@@ -261,6 +303,9 @@ struct llcache_s {
 	 */
 	uint64_t total_elapsed;
 
+	/** Usage counters reported by llcache_get_stats() */
+	struct llcache_stats stats;
+
 };
 
 /** low level cache state */
@@ -491,13 +536,46 @@ static nserror llcache_post_data_clone(const llcache_post_data *orig,
  * \param len	 Byte length of header
  * \param name	 Pointer to location to receive header name
  * \param value	 Pointer to location to receive header value
+ * \param name_interned  Pointer to location to receive whether name
+ *			 was interned. If so \a value is the only
+ *			 allocation made, otherwise \a name is a
+ *			 single block holding both strings.
  * \return NSERROR_OK on success, appropriate error otherwise
  */
 static nserror llcache_fetch_split_header(const uint8_t *data, size_t len,
-		char **name, char **value)
+		char **name, char **value, bool *name_interned)
 {
-	char *n, *v;
+	/* Common response header names. A parsed name matching one of
+	 * these (case insensitively) shares the static string rather
+	 * than carrying its own copy, saving an allocation on almost
+	 * every header of a typical response.
+	 */
+	static const char * const common_names[] = {
+		"Accept-Ranges",
+		"Age",
+		"Cache-Control",
+		"Connection",
+		"Content-Encoding",
+		"Content-Length",
+		"Content-Type",
+		"Date",
+		"ETag",
+		"Expires",
+		"Last-Modified",
+		"Link",
+		"Location",
+		"Server",
+		"Set-Cookie",
+		"Strict-Transport-Security",
+		"Transfer-Encoding",
+		"Vary",
+		NULL
+	};
+	const char * const *cn;
 	const uint8_t *colon;
+	const uint8_t *vstart = NULL;
+	size_t name_len, value_len = 0;
+	char *block;
 
 	/* Strip leading whitespace from name */
 	while (data[0] == ' ' || data[0] == '\t' ||
@@ -517,15 +595,7 @@ static nserror llcache_fetch_split_header(const uint8_t *data, size_t len,
 			colon[-1] == '\r' || colon[-1] == '\n')) {
 			colon--;
 		}
-		n = strndup((const char *) data, colon - data);
-		if (n == NULL)
-			return NSERROR_NOMEM;
-
-		v = strdup("");
-		if (v == NULL) {
-			free(n);
-			return NSERROR_NOMEM;
-		}
+		name_len = colon - data;
 	} else {
 		/* Split header into name & value */
 
@@ -535,9 +605,7 @@ static nserror llcache_fetch_split_header(const uint8_t *data, size_t len,
 				colon[-1] == '\n'))
 			colon--;
 
-		n = strndup((const char *) data, colon - data);
-		if (n == NULL)
-			return NSERROR_NOMEM;
+		name_len = colon - data;
 
 		/* Find colon again */
 		while (*colon != ':') {
@@ -558,15 +626,48 @@ static nserror llcache_fetch_split_header(const uint8_t *data, size_t len,
 			len--;
 		}
 
-		v = strndup((const char *) colon, len - (colon - data));
-		if (v == NULL) {
-			free(n);
-			return NSERROR_NOMEM;
+		vstart = colon;
+		if (len > (size_t) (vstart - data)) {
+			value_len = len - (vstart - data);
+		}
+	}
+
+	/* Use the interned name where possible */
+	for (cn = common_names; *cn != NULL; cn++) {
+		if ((strlen(*cn) == name_len) &&
+		    (strncasecmp(*cn, (const char *) data, name_len) == 0)) {
+			break;
 		}
 	}
 
-	*name = n;
-	*value = v;
+	if (*cn != NULL) {
+		/* Interned name; only the value needs storage */
+		block = malloc(value_len + 1);
+		if (block == NULL)
+			return NSERROR_NOMEM;
+
+		*name = (char *) *cn;
+		*name_interned = true;
+	} else {
+		/* Pack name and value into a single block */
+		block = malloc(name_len + 1 + value_len + 1);
+		if (block == NULL)
+			return NSERROR_NOMEM;
+
+		memcpy(block, data, name_len);
+		block[name_len] = '\0';
+
+		*name = block;
+		block += name_len + 1;
+		*name_interned = false;
+	}
+
+	if (value_len > 0) {
+		memcpy(block, vstart, value_len);
+	}
+	block[value_len] = '\0';
+
+	*value = block;
 
 	return NSERROR_OK;
 }
@@ -603,6 +704,15 @@ llcache_fetch_parse_cache_control(llcache_object *object, char *value)
 		object->cache.max_age = http_cache_control_max_age(cc);
 	}
 
+	if (http_cache_control_immutable(cc)) {
+		object->cache.immutable = true;
+	}
+
+	if (http_cache_control_has_stale_while_revalidate(cc)) {
+		object->cache.stale_while_revalidate =
+			http_cache_control_stale_while_revalidate(cc);
+	}
+
 	http_cache_control_destroy(cc);
 
 	return NSERROR_OK;
@@ -702,8 +812,11 @@ static inline void llcache_destroy_headers(llcache_object *object)
 	while (object->num_headers > 0) {
 		object->num_headers--;
 
-		free(object->headers[object->num_headers].name);
-		free(object->headers[object->num_headers].value);
+		if (object->headers[object->num_headers].name_interned) {
+			free(object->headers[object->num_headers].value);
+		} else {
+			free(object->headers[object->num_headers].name);
+		}
 	}
 	free(object->headers);
 	object->headers = NULL;
@@ -723,6 +836,207 @@ static inline void llcache_invalidate_cache_control_data(llcache_object *object)
 	object->cache.max_age = INVALID_AGE;
 }
 
+/**
+ * Handler for events on fetches started from Link header preload hints.
+ *
+ * The fetch exists purely to populate the cache ahead of a client
+ * request so the handle is dropped as soon as it completes.
+ *
+ * \param handle The low-level cache handle for the preload.
+ * \param event The event to process.
+ * \param pw Unused private context.
+ * \return NSERROR_OK on success else appropriate error code.
+ */
+static nserror
+llcache_preload_callback(llcache_handle *handle,
+			 const llcache_event *event,
+			 void *pw)
+{
+	switch (event->type) {
+	case LLCACHE_EVENT_DONE:
+	case LLCACHE_EVENT_ERROR:
+		llcache_handle_release(handle);
+		break;
+
+	default:
+		break;
+	}
+
+	return NSERROR_OK;
+}
+
+/**
+ * Process a Link response header looking for preload hints.
+ *
+ * Walks the comma separated link values and starts a cache fetch for
+ * each target carrying a rel=preload parameter, so resources the
+ * server hints at (including via a 103 Early Hints response) are in
+ * flight before the client parses the body that references them. The
+ * as parameter selects the fetch priority of the preload.
+ *
+ * \param object  Object whose response carried the header
+ * \param value	  Header value
+ * \return NSERROR_OK on success, appropriate error otherwise
+ */
+static nserror
+llcache_fetch_process_link(llcache_object *object, const char *value)
+{
+	const char *s = value;
+	nserror res;
+
+	while (*s != '\0') {
+		const char *target;
+		size_t target_len;
+		bool preload = false;
+		fetch_priority priority = FETCH_PRIORITY_IMG;
+
+		/* skip whitespace and list separators to the target */
+		while (*s == ' ' || *s == '\t' || *s == ',') {
+			s++;
+		}
+		if (*s != '<') {
+			break;
+		}
+		s++;
+		target = s;
+		while ((*s != '\0') && (*s != '>')) {
+			s++;
+		}
+		if (*s == '\0') {
+			break;
+		}
+		target_len = s - target;
+		s++;
+		while (*s == ' ' || *s == '\t') {
+			s++;
+		}
+
+		/* walk the parameters of this link value */
+		while (*s == ';') {
+			const char *pname;
+			size_t pname_len;
+			const char *pval = NULL;
+			size_t pval_len = 0;
+
+			s++;
+			while (*s == ' ' || *s == '\t') {
+				s++;
+			}
+			pname = s;
+			while ((*s != '\0') && (*s != '=') &&
+			       (*s != ';') && (*s != ',')) {
+				s++;
+			}
+			pname_len = s - pname;
+			while ((pname_len > 0) &&
+			       ((pname[pname_len - 1] == ' ') ||
+				(pname[pname_len - 1] == '\t'))) {
+				pname_len--;
+			}
+
+			if (*s == '=') {
+				s++;
+				if (*s == '"') {
+					s++;
+					pval = s;
+					while ((*s != '\0') && (*s != '"')) {
+						s++;
+					}
+					pval_len = s - pval;
+					if (*s == '"') {
+						s++;
+					}
+				} else {
+					pval = s;
+					while ((*s != '\0') && (*s != ';') &&
+					       (*s != ',') && (*s != ' ') &&
+					       (*s != '\t')) {
+						s++;
+					}
+					pval_len = s - pval;
+				}
+			}
+			while (*s == ' ' || *s == '\t') {
+				s++;
+			}
+
+			if ((pname_len == SLEN("rel")) &&
+			    (strncasecmp(pname, "rel", pname_len) == 0)) {
+				/* scan the space separated relation list */
+				size_t tok = 0;
+				while (tok < pval_len) {
+					size_t tok_start;
+					while ((tok < pval_len) &&
+					       (pval[tok] == ' ')) {
+						tok++;
+					}
+					tok_start = tok;
+					while ((tok < pval_len) &&
+					       (pval[tok] != ' ')) {
+						tok++;
+					}
+					if (((tok - tok_start) ==
+					     SLEN("preload")) &&
+					    (strncasecmp(pval + tok_start,
+							 "preload",
+							 SLEN("preload")) == 0)) {
+						preload = true;
+					}
+				}
+			} else if ((pname_len == SLEN("as")) &&
+				   (strncasecmp(pname, "as", pname_len) == 0)) {
+				if ((pval_len == SLEN("style")) &&
+				    (strncasecmp(pval, "style",
+						 pval_len) == 0)) {
+					priority = FETCH_PRIORITY_CSS;
+				} else if ((pval_len == SLEN("script")) &&
+					   (strncasecmp(pval, "script",
+							pval_len) == 0)) {
+					priority = FETCH_PRIORITY_SCRIPT;
+				} else if ((pval_len == SLEN("font")) &&
+					   (strncasecmp(pval, "font",
+							pval_len) == 0)) {
+					priority = FETCH_PRIORITY_FONT;
+				}
+			}
+		}
+
+		if (preload && (target_len > 0)) {
+			char *turl;
+			nsurl *purl;
+
+			turl = strndup(target, target_len);
+			if (turl == NULL) {
+				return NSERROR_NOMEM;
+			}
+
+			res = nsurl_join(object->url, turl, &purl);
+			free(turl);
+			if (res == NSERROR_OK) {
+				llcache_handle *handle;
+
+				res = llcache_handle_retrieve(
+						purl,
+						LLCACHE_RETRIEVE_PRIORITY(
+							priority),
+						object->url,
+						NULL,
+						llcache_preload_callback,
+						NULL,
+						&handle);
+				if (res == NSERROR_OK) {
+					NSLOG(llcache, DEBUG,
+					      "Preloading %s",
+					      nsurl_access(purl));
+				}
+				nsurl_unref(purl);
+			}
+		}
+	}
+
+	return NSERROR_OK;
+}
+
 /**
  * Process a fetch header
  *
@@ -736,6 +1050,7 @@ static nserror llcache_fetch_process_header(llcache_object *object,
 {
 	nserror res;
 	char *name, *value;
+	bool name_interned;
 	llcache_header *temp;
 
 	/**
@@ -768,32 +1083,37 @@ static nserror llcache_fetch_process_header(llcache_object *object,
 	}
 
 	/* Parse header into name-value pair */
-	res = llcache_fetch_split_header(data, len, &name, &value);
+	res = llcache_fetch_split_header(data, len, &name, &value,
+			&name_interned);
 	if (res != NSERROR_OK) {
 		return res;
 	}
 
 	/* deal with empty header */
 	if (name[0] == 0) {
-		free(name);
-		free(value);
+		free(name_interned ? value : name);
 		return NSERROR_OK;
 	}
 
 	/* update cache control data from header */
 	res = llcache_fetch_header_cache_control(object, name, value);
 	if (res != NSERROR_OK) {
-		free(name);
-		free(value);
+		free(name_interned ? value : name);
 		return res;
 	}
 
+	/* start fetches for resources the server hints at; Early
+	 * Hints responses deliver these before the main body
+	 */
+	if (strcasecmp(name, "Link") == 0) {
+		llcache_fetch_process_link(object, value);
+	}
+
 	/* Append header data to the object's headers array */
 	temp = realloc(object->headers,
 		       (object->num_headers + 1) * sizeof(llcache_header));
 	if (temp == NULL) {
-		free(name);
-		free(value);
+		free(name_interned ? value : name);
 		return NSERROR_NOMEM;
 	}
 
@@ -801,6 +1121,7 @@ static nserror llcache_fetch_process_header(llcache_object *object,
 
 	object->headers[object->num_headers].name = name;
 	object->headers[object->num_headers].value = value;
+	object->headers[object->num_headers].name_interned = name_interned;
 
 	object->num_headers++;
 
@@ -991,6 +1312,13 @@ static nserror llcache_object_refetch(llcache_object *object)
 			  (const char **)headers,
 			  &object->fetch.fetch);
 
+	if (res == NSERROR_OK) {
+		/* Queue the fetch by the resource class it was tagged with */
+		fetch_set_priority(object->fetch.fetch,
+				   LLCACHE_RETRIEVE_GET_PRIORITY(
+					   object->fetch.flags));
+	}
+
 	/* Clean up cache-control headers */
 	while (--header_idx >= 0) {
 		free(headers[header_idx]);
@@ -1045,6 +1373,190 @@ static nserror llcache_object_fetch(llcache_object *object, uint32_t flags,
 	return llcache_object_refetch(object);
 }
 
+/**
+ * Compute the content hash of a source data buffer
+ *
+ * 64bit FNV-1a; collisions are tolerable as index hits are always
+ * confirmed with a full comparison before buffers are shared.
+ *
+ * \param data  Buffer to hash
+ * \param len   Byte length of \a data
+ * \return The hash of the buffer contents
+ */
+static uint64_t llcache_dedup_hash(const uint8_t *data, size_t len)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		hash ^= data[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+/**
+ * Find the dedup index slot referencing a shared buffer
+ *
+ * \param data  The shared buffer to find
+ * \param len   Byte length of \a data
+ * \return Pointer to the linkage of the entry, or NULL if not indexed
+ */
+static llcache_dedup_entry **
+llcache_dedup_lookup(const uint8_t *data, size_t len)
+{
+	llcache_dedup_entry **cur;
+	uint64_t hash = llcache_dedup_hash(data, len);
+
+	for (cur = &llcache->dedup[hash % LLCACHE_DEDUP_BUCKETS];
+	     (*cur) != NULL;
+	     cur = &(*cur)->next) {
+		if ((*cur)->data == data) {
+			return cur;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Share a completed object's source data with identical cached payloads
+ *
+ * If another object already holds an identical payload this object's
+ * copy is discarded in favour of the shared buffer, otherwise the
+ * object's buffer is published in the index for later arrivals.
+ *
+ * \param object  Object whose fetch has just completed
+ */
+static void llcache_dedup_share(llcache_object *object)
+{
+	llcache_dedup_entry *entry;
+	uint64_t hash;
+
+	if ((object->source_data == NULL) ||
+	    (object->source_len == 0) ||
+	    (object->store_state != LLCACHE_STATE_RAM) ||
+	    (object->source_shared)) {
+		return;
+	}
+
+	hash = llcache_dedup_hash(object->source_data, object->source_len);
+
+	for (entry = llcache->dedup[hash % LLCACHE_DEDUP_BUCKETS];
+	     entry != NULL;
+	     entry = entry->next) {
+		if ((entry->hash == hash) &&
+		    (entry->len == object->source_len) &&
+		    (memcmp(entry->data, object->source_data,
+			    entry->len) == 0)) {
+			break;
+		}
+	}
+
+	if (entry != NULL) {
+		/* Identical payload already cached; adopt its buffer */
+		free(object->source_data);
+		object->source_data = entry->data;
+		object->source_alloc = entry->len;
+		entry->refs++;
+
+		NSLOG(llcache, DEBUG,
+		      "Sharing %"PRIsizet" bytes between %u objects (%p)",
+		      entry->len, entry->refs, object);
+	} else {
+		entry = malloc(sizeof(*entry));
+		if (entry == NULL) {
+			/* no deduplication, no harm done */
+			return;
+		}
+
+		entry->hash = hash;
+		entry->len = object->source_len;
+		entry->data = object->source_data;
+		entry->refs = 1;
+		entry->next = llcache->dedup[hash % LLCACHE_DEDUP_BUCKETS];
+		llcache->dedup[hash % LLCACHE_DEDUP_BUCKETS] = entry;
+	}
+
+	object->source_shared = true;
+}
+
+/**
+ * Drop an object's reference to its possibly shared source data
+ *
+ * The buffer is freed once the last referencing object lets go.
+ *
+ * \param object  Object releasing its source data
+ */
+static void llcache_dedup_release(llcache_object *object)
+{
+	llcache_dedup_entry **cur, *entry;
+
+	if (object->source_shared == false) {
+		free(object->source_data);
+		object->source_data = NULL;
+		return;
+	}
+
+	cur = llcache_dedup_lookup(object->source_data, object->source_len);
+	assert(cur != NULL);
+	entry = *cur;
+
+	object->source_data = NULL;
+	object->source_shared = false;
+
+	entry->refs--;
+	if (entry->refs == 0) {
+		*cur = entry->next;
+		free(entry->data);
+		free(entry);
+	}
+}
+
+/**
+ * Give an object exclusive ownership of its source data
+ *
+ * Required before buffer ownership passes outside the cache, e.g. to
+ * the backing store which releases buffers behind our back.
+ *
+ * \param object  Object requiring a private source buffer
+ * \return NSERROR_OK on success, appropriate error otherwise
+ */
+static nserror llcache_dedup_exclusive(llcache_object *object)
+{
+	llcache_dedup_entry **cur, *entry;
+	uint8_t *copy;
+
+	if (object->source_shared == false) {
+		return NSERROR_OK;
+	}
+
+	cur = llcache_dedup_lookup(object->source_data, object->source_len);
+	assert(cur != NULL);
+	entry = *cur;
+
+	if (entry->refs > 1) {
+		/* other objects still use the buffer; take a copy */
+		copy = malloc(object->source_len);
+		if (copy == NULL) {
+			return NSERROR_NOMEM;
+		}
+		memcpy(copy, entry->data, object->source_len);
+
+		object->source_data = copy;
+		entry->refs--;
+	} else {
+		/* sole user; simply withdraw the buffer from the index */
+		*cur = entry->next;
+		free(entry);
+	}
+
+	object->source_shared = false;
+
+	return NSERROR_OK;
+}
+
 /**
  * Destroy a low-level cache object
  *
@@ -1068,7 +1580,7 @@ static nserror llcache_object_destroy(llcache_object *object)
 		if (object->store_state == LLCACHE_STATE_DISC) {
 			guit->llcache->release(object->url, BACKING_STORE_NONE);
 		} else {
-			free(object->source_data);
+			llcache_dedup_release(object);
 		}
 	}
 
@@ -1096,8 +1608,11 @@ static nserror llcache_object_destroy(llcache_object *object)
 	free(object->cache.etag);
 
 	for (i = 0; i < object->num_headers; i++) {
-		free(object->headers[i].name);
-		free(object->headers[i].value);
+		if (object->headers[i].name_interned) {
+			free(object->headers[i].value);
+		} else {
+			free(object->headers[i].name);
+		}
 	}
 	free(object->headers);
 
@@ -1106,6 +1621,55 @@ static nserror llcache_object_destroy(llcache_object *object)
 	return NSERROR_OK;
 }
 
+/**
+ * Unlink a cached object from the least recently used list
+ *
+ * Safe to call for objects which are not currently linked.
+ *
+ * \param object  Object to unlink
+ */
+static void llcache_object_lru_remove(llcache_object *object)
+{
+	if ((object->lru_prev == NULL) && (llcache->lru_head != object)) {
+		/* not on the list */
+		return;
+	}
+
+	if (object->lru_prev != NULL)
+		object->lru_prev->lru_next = object->lru_next;
+	else
+		llcache->lru_head = object->lru_next;
+
+	if (object->lru_next != NULL)
+		object->lru_next->lru_prev = object->lru_prev;
+	else
+		llcache->lru_tail = object->lru_prev;
+
+	object->lru_prev = object->lru_next = NULL;
+}
+
+/**
+ * Mark a cached object as the most recently used
+ *
+ * The object is moved (or inserted) at the head of the least recently
+ * used list so cleaning can take eviction candidates from the tail
+ * without scanning.
+ *
+ * \param object  Object that has been used
+ */
+static void llcache_object_lru_touch(llcache_object *object)
+{
+	llcache_object_lru_remove(object);
+
+	object->lru_next = llcache->lru_head;
+	if (llcache->lru_head != NULL)
+		llcache->lru_head->lru_prev = object;
+	llcache->lru_head = object;
+
+	if (llcache->lru_tail == NULL)
+		llcache->lru_tail = object;
+}
+
 /**
  * Add a low-level cache object to a cache list
  *
@@ -1123,6 +1687,10 @@ static nserror llcache_object_add_to_list(llcache_object *object,
 		(*list)->prev = object;
 	*list = object;
 
+	/* cached objects additionally join the recently used list */
+	if (list == &llcache->cached_objects)
+		llcache_object_lru_touch(object);
+
 	return NSERROR_OK;
 }
 
@@ -1198,6 +1766,52 @@ static bool llcache_object_is_fresh(const llcache_object *object)
 		 (object->fetch.state != LLCACHE_FETCH_COMPLETE)));
 }
 
+/**
+ * Determine if an expired object may be served while revalidating
+ *
+ * RFC 5861 permits a response bearing a stale-while-revalidate
+ * directive to be served for that many seconds beyond its freshness
+ * lifetime provided revalidation is started in the background.
+ *
+ * \param object  Object to consider
+ * \return True if the stale copy may be served, false otherwise
+ */
+static bool llcache_object_can_serve_stale(const llcache_object *object)
+{
+	const llcache_cache_control *cd = &object->cache;
+	int current_age, freshness_lifetime;
+	time_t now = time(NULL);
+
+	if (cd->stale_while_revalidate <= 0) {
+		return false;
+	}
+
+	if (cd->no_cache != LLCACHE_VALIDATE_FRESH) {
+		/* response forbade unvalidated reuse */
+		return false;
+	}
+
+	/* Age and lifetime computed as for
+	 * llcache_object_rfc2616_remaining_lifetime()
+	 */
+	current_age = max(0, (cd->res_time - cd->date));
+	current_age = max(current_age, (cd->age == INVALID_AGE) ? 0 : cd->age);
+	current_age += cd->res_time - cd->req_time + now - cd->res_time;
+
+	if (cd->max_age != INVALID_AGE) {
+		freshness_lifetime = cd->max_age;
+	} else if (cd->expires != 0) {
+		freshness_lifetime = cd->expires - cd->date;
+	} else if (cd->last_modified != 0) {
+		freshness_lifetime = (now - cd->last_modified) / 10;
+	} else {
+		freshness_lifetime = 0;
+	}
+
+	return (current_age <
+		(freshness_lifetime + cd->stale_while_revalidate));
+}
+
 /**
  * Clone an object's cache data
  *
@@ -1253,6 +1867,9 @@ static nserror llcache_object_clone_cache_data(llcache_object *source,
 	if (source->cache.last_modified != 0)
 		destination->cache.last_modified = source->cache.last_modified;
 
+	if (source->cache.immutable)
+		destination->cache.immutable = true;
+
 	return NSERROR_OK;
 }
 
@@ -1274,6 +1891,9 @@ llcache_object_remove_from_list(llcache_object *object, llcache_object **list)
 	if (object->next != NULL)
 		object->next->prev = object->prev;
 
+	if (list == &llcache->cached_objects)
+		llcache_object_lru_remove(object);
+
 	return NSERROR_OK;
 }
 
@@ -1921,6 +2541,7 @@ llcache_object_retrieve_from_cache(nsurl *url,
 {
 	nserror error;
 	llcache_object *obj, *newest = NULL;
+	uint32_t urlhash;
 
 	NSLOG(llcache, DEBUG,
 	      "Searching cache for %s flags:%"PRIx32" referer:%s post:%p",
@@ -1928,11 +2549,16 @@ llcache_object_retrieve_from_cache(nsurl *url,
 	      referer==NULL?"":nsurl_access(referer),
 	      post);
 
-	/* Search for the most recently fetched matching object */
+	/* Search for the most recently fetched matching object. The
+	 * cheap hash comparison rejects the overwhelming majority of
+	 * non-matches before the full URL comparison is made.
+	 */
+	urlhash = nsurl_hash(url);
 	for (obj = llcache->cached_objects; obj != NULL; obj = obj->next) {
 
 		if ((newest == NULL ||
 		     obj->cache.req_time > newest->cache.req_time) &&
+		    (nsurl_hash(obj->url) == urlhash) &&
 		    nsurl_compare(obj->url, url,
 				  NSURL_COMPLETE) == true) {
 			newest = obj;
@@ -1968,7 +2594,28 @@ llcache_object_retrieve_from_cache(nsurl *url,
 		 */
 	}
 
+	if ((newest != NULL) &&
+	    (newest->cache.immutable) &&
+	    (newest->source_data != NULL) &&
+	    (newest->fetch.state == LLCACHE_FETCH_COMPLETE) &&
+	    (llcache_object_is_fresh(newest))) {
+		/* Immutable object wholly in RAM; no validation or
+		 * persistent store bookkeeping is required.
+		 */
+		NSLOG(llcache, DEBUG, "Immutable fast path %p", newest);
+
+		llcache->stats.hit_ram++;
+
+		llcache_object_lru_touch(newest);
+
+		*result = newest;
+
+		return NSERROR_OK;
+	}
+
 	if ((newest != NULL) && (llcache_object_is_fresh(newest))) {
+		bool was_in_ram = (newest->source_data != NULL);
+
 		/* Found a suitable object, and it's still fresh */
 		NSLOG(llcache, DEBUG, "Found fresh %p", newest);
 
@@ -1982,6 +2629,14 @@ llcache_object_retrieve_from_cache(nsurl *url,
 			/* source data was successfully retrieved from
 			 * persistent store
 			 */
+			if (was_in_ram) {
+				llcache->stats.hit_ram++;
+			} else {
+				llcache->stats.hit_disk++;
+			}
+
+			llcache_object_lru_touch(newest);
+
 			*result = newest;
 
 			return NSERROR_OK;
@@ -2037,6 +2692,29 @@ llcache_object_retrieve_from_cache(nsurl *url,
 			/* Add new object to cache */
 			llcache_object_add_to_list(obj, &llcache->cached_objects);
 
+			llcache->stats.revalidate++;
+
+			if ((post == NULL) &&
+			    (newest->fetch.state == LLCACHE_FETCH_COMPLETE) &&
+			    (llcache_object_can_serve_stale(newest))) {
+				/* Within the stale-while-revalidate
+				 * window; the client gets the stale
+				 * copy at once while the validation
+				 * fetch proceeds in the background to
+				 * refresh the cache for the next
+				 * retrieval.
+				 */
+				NSLOG(llcache, DEBUG,
+				      "Serving stale %p while revalidating",
+				      newest);
+
+				llcache_object_lru_touch(newest);
+
+				*result = newest;
+
+				return NSERROR_OK;
+			}
+
 			*result = obj;
 
 			return NSERROR_OK;
@@ -2069,11 +2747,37 @@ llcache_object_retrieve_from_cache(nsurl *url,
 	/* Add new object to cache */
 	llcache_object_add_to_list(obj, &llcache->cached_objects);
 
+	llcache->stats.miss++;
+
 	*result = obj;
 
 	return NSERROR_OK;
 }
 
+/**
+ * Determine if a fresh immutable object is cached for a URL.
+ *
+ * \param url  URL to look for
+ * \return The matching object, or NULL if there is none
+ */
+static llcache_object *llcache__find_fresh_immutable(nsurl *url)
+{
+	llcache_object *obj;
+	uint32_t urlhash = nsurl_hash(url);
+
+	for (obj = llcache->cached_objects; obj != NULL; obj = obj->next) {
+		if ((obj->cache.immutable) &&
+		    (obj->fetch.state == LLCACHE_FETCH_COMPLETE) &&
+		    (nsurl_hash(obj->url) == urlhash) &&
+		    (nsurl_compare(obj->url, url, NSURL_COMPLETE) == true) &&
+		    (llcache_object_is_fresh(obj))) {
+			return obj;
+		}
+	}
+
+	return NULL;
+}
+
 /**
  * Retrieve an object from the cache, fetching it if necessary.
  *
@@ -2111,8 +2815,18 @@ llcache_object_retrieve(nsurl *url,
 
 	/* determine if content is cachable */
 	if ((flags & LLCACHE_RETRIEVE_FORCE_FETCH) != 0) {
-		/* Forced fetches are never cached */
-		uncachable = true;
+		/* Forced fetches are never cached. However a fresh
+		 * immutable object cannot differ from what a refetch
+		 * would return (RFC8246) so the held copy is used
+		 * regardless.
+		 */
+		if ((post == NULL) &&
+		    (llcache__find_fresh_immutable(defragmented_url)
+		     != NULL)) {
+			flags &= ~LLCACHE_RETRIEVE_FORCE_FETCH;
+		} else {
+			uncachable = true;
+		}
 	} else if (post != NULL) {
 		/* POST requests are never cached */
 		uncachable = true;
@@ -2442,6 +3156,8 @@ static nserror llcache_object_cache_update(llcache_object *object)
 static nserror llcache_fetch_notmodified(llcache_object *object,
 		llcache_object **replacement)
 {
+	llcache->stats.not_modified++;
+
 	/* There may be no candidate if the server erroneously responded
 	 * to an unconditional request with a 304 Not Modified response.
 	 * In this case, we simply retain the initial object, having
@@ -2498,6 +3214,39 @@ static nserror llcache_fetch_notmodified(llcache_object *object,
 	return NSERROR_OK;
 }
 
+/**
+ * Account fetched bytes against the scheme of the object's URL
+ *
+ * \param object  Object being fetched
+ * \param len	  Byte length of data received
+ */
+static void llcache_stats_add_bytes(llcache_object *object, size_t len)
+{
+	lwc_string *scheme;
+	bool match;
+
+	scheme = nsurl_get_component(object->url, NSURL_SCHEME);
+	if (scheme == NULL) {
+		llcache->stats.other_bytes += len;
+		return;
+	}
+
+	if ((lwc_string_caseless_isequal(scheme, corestring_lwc_http,
+			&match) == lwc_error_ok) && match) {
+		llcache->stats.http_bytes += len;
+	} else if ((lwc_string_caseless_isequal(scheme, corestring_lwc_https,
+			&match) == lwc_error_ok) && match) {
+		llcache->stats.https_bytes += len;
+	} else if ((lwc_string_caseless_isequal(scheme, corestring_lwc_file,
+			&match) == lwc_error_ok) && match) {
+		llcache->stats.file_bytes += len;
+	} else {
+		llcache->stats.other_bytes += len;
+	}
+
+	lwc_string_unref(scheme);
+}
+
 /**
  * Process a chunk of fetched data
  *
@@ -2560,6 +3309,8 @@ llcache_fetch_process_data(llcache_object *object,
 	memcpy(object->source_data + object->source_len, data, len);
 	object->source_len += len;
 
+	llcache_stats_add_bytes(object, len);
+
 	return NSERROR_OK;
 }
 
@@ -2848,6 +3599,12 @@ write_backing_store(struct llcache_object *object,
 
 	nsu_getmonotonic_ms(&startms);
 
+	/* backing store takes buffer ownership so unshare the data */
+	ret = llcache_dedup_exclusive(object);
+	if (ret != NSERROR_OK) {
+		return ret;
+	}
+
 	/* put object data in backing store */
 	ret = guit->llcache->store(object->url,
 				   BACKING_STORE_NONE,
@@ -3126,6 +3883,9 @@ static void llcache_fetch_callback(const fetch_msg *msg, void *p)
 
 		llcache_object_cache_update(object);
 
+		/* share the payload with any identical cached object */
+		llcache_dedup_share(object);
+
 		/* record when the fetch finished */
 		object->cache.fin_time = time(NULL);
 
@@ -3612,11 +4372,29 @@ llcache_object_snapshot(llcache_object *object,	llcache_object **snapshot)
 			llcache_header *oh =
 					&(object->headers[newobj->num_headers]);
 			newobj->num_headers += 1;
-			nh->name = strdup(oh->name);
-			nh->value = strdup(oh->value);
-			if (nh->name == NULL || nh->value == NULL) {
-				llcache_object_destroy(newobj);
-				return NSERROR_NOMEM;
+			nh->name_interned = oh->name_interned;
+			if (oh->name_interned) {
+				/* static name shared, only the value
+				 * needs copying
+				 */
+				nh->name = oh->name;
+				nh->value = strdup(oh->value);
+				if (nh->value == NULL) {
+					llcache_object_destroy(newobj);
+					return NSERROR_NOMEM;
+				}
+			} else {
+				size_t nlen = strlen(oh->name) + 1;
+				size_t vlen = strlen(oh->value) + 1;
+
+				nh->name = malloc(nlen + vlen);
+				if (nh->name == NULL) {
+					llcache_object_destroy(newobj);
+					return NSERROR_NOMEM;
+				}
+				memcpy(nh->name, oh->name, nlen);
+				nh->value = nh->name + nlen;
+				memcpy(nh->value, oh->value, vlen);
 			}
 		}
 	}
@@ -3724,7 +4502,7 @@ static void llcache_users_not_caught_up(void)
  */
 void llcache_clean(bool purge)
 {
-	llcache_object *object, *next;
+	llcache_object *object, *next, *prev;
 	uint32_t llcache_size = 0;
 	int remaining_lifetime;
 	uint32_t limit;
@@ -3804,11 +4582,15 @@ void llcache_clean(bool purge)
 	/* Source data of fresh cacheable objects with no users, no
 	 * pending fetches and pushed to persistent store while the
 	 * cache exceeds the configured size.
+	 *
+	 * These passes walk the least recently used list from the tail
+	 * so the oldest objects are evicted first and the walk stops as
+	 * soon as the cache is back under its limit.
 	 */
-	for (object = llcache->cached_objects;
+	for (object = llcache->lru_tail;
 	     ((limit < llcache_size) && (object != NULL));
-	     object = next) {
-		next = object->next;
+	     object = prev) {
+		prev = object->lru_prev;
 		if ((object->users == NULL) &&
 		    (object->candidate_count == 0) &&
 		    (object->fetch.fetch == NULL) &&
@@ -3829,10 +4611,10 @@ void llcache_clean(bool purge)
 	 * and pushed to persistent store while the cache exceeds
 	 * the configured size. Effectively just the llcache object metadata.
 	 */
-	for (object = llcache->cached_objects;
+	for (object = llcache->lru_tail;
 	     ((limit < llcache_size) && (object != NULL));
-	     object = next) {
-		next = object->next;
+	     object = prev) {
+		prev = object->lru_prev;
 		if ((object->users == NULL) &&
 		    (object->candidate_count == 0) &&
 		    (object->fetch.fetch == NULL) &&
@@ -3851,6 +4633,7 @@ void llcache_clean(bool purge)
 						&llcache->cached_objects);
 			llcache_object_destroy(object);
 
+			llcache->stats.evicted++;
 		}
 	}
 
@@ -3859,10 +4642,10 @@ void llcache_clean(bool purge)
 	 * most valuable objects as replacing them is a full network
 	 * fetch
 	 */
-	for (object = llcache->cached_objects;
+	for (object = llcache->lru_tail;
 	     ((limit < llcache_size) && (object != NULL));
-	     object = next) {
-		next = object->next;
+	     object = prev) {
+		prev = object->lru_prev;
 
 		if ((object->users == NULL) &&
 		    (object->candidate_count == 0) &&
@@ -3880,12 +4663,60 @@ void llcache_clean(bool purge)
 			llcache_object_remove_from_list(object,
 						&llcache->cached_objects);
 			llcache_object_destroy(object);
+
+			llcache->stats.evicted++;
 		}
 	}
 
 	NSLOG(llcache, DEBUG, "Size: %"PRIu32" (limit: %"PRIu32")", llcache_size, limit);
 }
 
+/* Exported interface documented in content/llcache.h */
+nserror llcache_get_stats(struct llcache_stats *stats)
+{
+	llcache_object *object;
+
+	if ((llcache == NULL) || (stats == NULL)) {
+		return NSERROR_BAD_PARAMETER;
+	}
+
+	*stats = llcache->stats;
+
+	stats->limit = llcache->limit;
+
+	/* current occupancy is computed on demand */
+	stats->object_count = 0;
+	stats->size = 0;
+	for (object = llcache->cached_objects;
+	     object != NULL;
+	     object = object->next) {
+		stats->object_count++;
+		stats->size += total_object_size(object);
+	}
+	for (object = llcache->uncached_objects;
+	     object != NULL;
+	     object = object->next) {
+		stats->object_count++;
+		stats->size += total_object_size(object);
+	}
+
+	return NSERROR_OK;
+}
+
+/**
+ * Report source object heap usage for memory accounting.
+ */
+static size_t llcache__memreport(void *pw)
+{
+	struct llcache_stats stats;
+
+	if (llcache_get_stats(&stats) != NSERROR_OK) {
+		return 0;
+	}
+
+	return stats.size;
+}
+
 /* Exported interface documented in content/llcache.h */
 nserror
 llcache_initialise(const struct llcache_parameters *prm)
@@ -3907,6 +4738,8 @@ llcache_initialise(const struct llcache_parameters *prm)
 	      "llcache initialising with a limit of %"PRIu32" bytes",
 	      llcache->limit);
 
+	memreport_register("Source objects", llcache__memreport, NULL);
+
 	/* backing store initialisation */
 	return guit->llcache->initialise(&prm->store);
 }
@@ -3918,6 +4751,8 @@ void llcache_finalise(void)
 	llcache_object *object, *next;
 	uint64_t total_bandwidth = 0; /* total bandwidth */
 
+	memreport_unregister("Source objects");
+
 	/* Attempt to persist anything we have left lying around */
 	llcache_persist(NULL);
 	/* Now clear the persistence callback */
@@ -3999,6 +4834,7 @@ llcache_handle_retrieve(nsurl *url,
 	llcache_object *object;
 	nsurl *hsts_url;
 	bool hsts_in_use;
+	uint64_t retrievals;
 
 	/* Perform HSTS transform */
 	error = llcache_hsts_transform_url(url, &hsts_url, &hsts_in_use);
@@ -4032,6 +4868,16 @@ llcache_handle_retrieve(nsurl *url,
 	/* Add user to object */
 	llcache_object_add_user(object, user);
 
+	/* log the running hit rate for the perf timeline */
+	retrievals = llcache->stats.hit_ram + llcache->stats.hit_disk +
+		llcache->stats.miss;
+	if (retrievals > 0) {
+		perf_log_sample(PERF_LOG_CACHE_HIT,
+				(float)((llcache->stats.hit_ram +
+					 llcache->stats.hit_disk) * 100) /
+				retrievals);
+	}
+
 	*result = user->handle;
 
 	/* Users exist which are now not caught up! */
@@ -4178,6 +5024,22 @@ nserror llcache_handle_force_stream(llcache_handle *handle)
 	return NSERROR_OK;
 }
 
+/* See llcache.h for documentation */
+nserror llcache_handle_pause(llcache_handle *handle, bool pause)
+{
+	llcache_object *object = handle->object;
+
+	if (object == NULL) {
+		return NSERROR_BAD_PARAMETER;
+	}
+
+	if (object->fetch.fetch != NULL) {
+		fetch_pause(object->fetch.fetch, pause);
+	}
+
+	return NSERROR_OK;
+}
+
 /* See llcache.h for documentation */
 nserror llcache_handle_invalidate_cache_data(llcache_handle *handle)
 {
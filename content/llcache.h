@@ -63,6 +63,16 @@ enum llcache_retrieve_flag {
 	LLCACHE_RETRIEVE_STREAM_DATA    = (1 << 3)
 };
 
+/** Encode a ::fetch_priority resource class into retrieve flags.
+ *
+ * The priority occupies bits 4 to 6 of the flags word; the default of
+ * zero is FETCH_PRIORITY_HTML so existing callers are unaffected.
+ */
+#define LLCACHE_RETRIEVE_PRIORITY(p) (((uint32_t)(p) & 0x7) << 4)
+
+/** Extract the ::fetch_priority resource class from retrieve flags. */
+#define LLCACHE_RETRIEVE_GET_PRIORITY(f) (((f) >> 4) & 0x7)
+
 /** Low-level cache event types */
 typedef enum {
 	LLCACHE_EVENT_GOT_CERTS,        /**< SSL certificates arrived */
@@ -153,6 +163,28 @@ struct llcache_parameters {
 	struct llcache_store_parameters store;
 };
 
+/**
+ * Low-level cache usage statistics
+ */
+struct llcache_stats {
+	uint64_t hit_ram; /**< retrievals served from objects in RAM */
+	uint64_t hit_disk; /**< retrievals served from the backing store */
+	uint64_t miss; /**< retrievals requiring a network fetch */
+	uint64_t revalidate; /**< conditional fetches issued */
+	uint64_t not_modified; /**< conditional fetches answered 304 */
+	uint64_t evicted; /**< objects discarded to stay within the limit */
+
+	/* bytes fetched from the network by scheme */
+	uint64_t http_bytes;
+	uint64_t https_bytes;
+	uint64_t file_bytes;
+	uint64_t other_bytes;
+
+	uint32_t object_count; /**< number of objects currently cached */
+	uint32_t size; /**< current RAM usage estimate in bytes */
+	uint32_t limit; /**< configured RAM cache size target */
+};
+
 /**
  * Initialise the low-level cache
  *
@@ -177,6 +209,14 @@ void llcache_finalise(void);
  */
 void llcache_clean(bool purge);
 
+/**
+ * Retrieve low-level cache usage statistics
+ *
+ * \param stats Updated with the current statistics.
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+nserror llcache_get_stats(struct llcache_stats *stats);
+
 /**
  * Retrieve a handle for a low-level cache object
  *
@@ -231,6 +271,21 @@ nserror llcache_handle_clone(llcache_handle *handle, llcache_handle **result);
  */
 nserror llcache_handle_abort(llcache_handle *handle);
 
+/**
+ * Pause or resume delivery on the fetch underlying a low-level cache handle.
+ *
+ * Applies flow control to the network connection instead of letting
+ * received data accumulate faster than users can consume it.  As the
+ * fetch is shared, pausing affects every user of the object; callers
+ * must pair each pause with a resume.  A no-op once the fetch has
+ * completed.
+ *
+ * \param handle The handle to pause or resume
+ * \param pause true to suspend delivery, false to resume it
+ * \return NSERROR_OK on success, appropriate error otherwise
+ */
+nserror llcache_handle_pause(llcache_handle *handle, bool pause);
+
 /**
  * Force a low-level cache handle into streaming mode
  *
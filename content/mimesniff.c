@@ -40,6 +40,9 @@ struct map_s {
 	lwc_string **type;
 };
 
+/** Counters of sniffing outcomes */
+static struct mimesniff_stats mimesniff_stats;
+
 static bool mimesniff__has_binary_octets(const uint8_t *data, size_t len)
 {
 	const uint8_t *end = data + len;
@@ -270,9 +273,33 @@ static nserror mimesniff__match_unknown_exact(const uint8_t *data, size_t len,
 		{ NULL, 0, false, NULL }
 	};
 #undef SIG
+	/* Dispatch index from first signature byte to a bitmap of the
+	 * table entries it may match; the linear memcmp chain is only
+	 * walked for those entries. Built on first use.
+	 */
+	static uint16_t first_byte_index[256];
+	static bool index_built = false;
 	const struct map_s *it;
+	uint16_t candidates;
+	unsigned int i;
+
+	if (index_built == false) {
+		for (i = 0; exact_match_types[i].sig != NULL; i++) {
+			first_byte_index[exact_match_types[i].sig[0]] |=
+				1 << i;
+		}
+		index_built = true;
+	}
+
+	if (len == 0)
+		return NSERROR_NOT_FOUND;
+
+	candidates = first_byte_index[data[0]];
+	for (i = 0; candidates != 0; i++, candidates >>= 1) {
+		if ((candidates & 1) == 0)
+			continue;
 
-	for (it = exact_match_types; it->sig != NULL; it++) {
+		it = &exact_match_types[i];
 		if (it->len <= len && memcmp(data, it->sig, it->len) == 0 &&
 				(allow_unsafe || it->safe)) {
 			*effective_type = lwc_string_ref(*it->type);
@@ -392,15 +419,31 @@ static nserror mimesniff__compute_image(lwc_string *official_type,
 		{ NULL, 0, NULL }
 	};
 #undef SIG
-
+	/* First byte dispatch index as for the exact match table */
+	static uint16_t first_byte_index[256];
+	static bool index_built = false;
 	const struct it_s *it;
+	uint16_t candidates;
+	unsigned int i;
+
+	if (index_built == false) {
+		for (i = 0; image_types[i].sig != NULL; i++) {
+			first_byte_index[image_types[i].sig[0]] |= 1 << i;
+		}
+		index_built = true;
+	}
 
 	if (data == NULL) {
 		lwc_string_unref(official_type);
 		return NSERROR_NEED_DATA;
 	}
 
-	for (it = image_types; it->sig != NULL; it++) {
+	candidates = (len == 0) ? 0 : first_byte_index[data[0]];
+	for (i = 0; candidates != 0; i++, candidates >>= 1) {
+		if ((candidates & 1) == 0)
+			continue;
+
+		it = &image_types[i];
 		if (it->len <= len && memcmp(data, it->sig, it->len) == 0) {
 			lwc_string_unref(official_type);
 			*effective_type = lwc_string_ref(*it->type);
@@ -586,12 +629,15 @@ mimesniff_compute_effective_type(const char *content_type_header,
 	bool match;
 	nserror error;
 
+	mimesniff_stats.total++;
+
 	if (content_type_header == NULL) {
 		if (sniff_allowed == false) {
 			return NSERROR_NOT_FOUND;
 		}
 
 		/* No official type => unknown */
+		mimesniff_stats.unknown++;
 		return mimesniff__compute_unknown(data, len, effective_type);
 	}
 
@@ -601,12 +647,14 @@ mimesniff_compute_effective_type(const char *content_type_header,
 			return NSERROR_NOT_FOUND;
 
 		/* Unparseable => unknown */
+		mimesniff_stats.unknown++;
 		return mimesniff__compute_unknown(data, len, effective_type);
 	}
 
 	if (sniff_allowed == false) {
 		*effective_type = lwc_string_ref(ct->media_type);
 		http_content_type_destroy(ct);
+		mimesniff_stats.official++;
 		return NSERROR_OK;
 	}
 
@@ -618,11 +666,13 @@ mimesniff_compute_effective_type(const char *content_type_header,
 						&match) == lwc_error_ok && match) {
 			*effective_type = lwc_string_ref(corestring_lwc_image_svg);
 			http_content_type_destroy(ct);
+			mimesniff_stats.official++;
 			return NSERROR_OK;
 		}
 
 		official_type = lwc_string_ref(ct->media_type);
 		http_content_type_destroy(ct);
+		mimesniff_stats.image++;
 		return mimesniff__compute_image(official_type,
 				data, len, effective_type);
 	}
@@ -636,6 +686,7 @@ mimesniff_compute_effective_type(const char *content_type_header,
 			   content_type_header,
 			   content_type_header_len) == 0) {
 			http_content_type_destroy(ct);
+			mimesniff_stats.text++;
 			return mimesniff__compute_text_or_binary(data, len,
 					effective_type);
 		}
@@ -652,6 +703,7 @@ mimesniff_compute_effective_type(const char *content_type_header,
 					 corestring_lwc_any,
 					 &match) == lwc_error_ok && match)) {
 		http_content_type_destroy(ct);
+		mimesniff_stats.unknown++;
 		return mimesniff__compute_unknown(data, len, effective_type);
 	}
 
@@ -664,6 +716,7 @@ mimesniff_compute_effective_type(const char *content_type_header,
 		/* Use official type */
 		*effective_type = lwc_string_ref(ct->media_type);
 		http_content_type_destroy(ct);
+		mimesniff_stats.official++;
 		return NSERROR_OK;
 	}
 
@@ -677,6 +730,7 @@ mimesniff_compute_effective_type(const char *content_type_header,
 		/* Use official type */
 		*effective_type = lwc_string_ref(ct->media_type);
 		http_content_type_destroy(ct);
+		mimesniff_stats.official++;
 		return NSERROR_OK;
 	}
 
@@ -685,6 +739,7 @@ mimesniff_compute_effective_type(const char *content_type_header,
 			CONTENT_IMAGE) {
 		lwc_string *official_type = lwc_string_ref(ct->media_type);
 		http_content_type_destroy(ct);
+		mimesniff_stats.image++;
 		return mimesniff__compute_image(official_type,
 				data, len, effective_type);
 	}
@@ -694,6 +749,7 @@ mimesniff_compute_effective_type(const char *content_type_header,
 					 corestring_lwc_text_html,
 					 &match) == lwc_error_ok && match)) {
 		http_content_type_destroy(ct);
+		mimesniff_stats.html++;
 		return mimesniff__compute_feed_or_html(data, len,
 						       effective_type);
 	}
@@ -703,5 +759,15 @@ mimesniff_compute_effective_type(const char *content_type_header,
 
 	http_content_type_destroy(ct);
 
+	mimesniff_stats.official++;
+
+	return NSERROR_OK;
+}
+
+/* See mimesniff.h for documentation */
+nserror mimesniff_get_stats(struct mimesniff_stats *stats)
+{
+	*stats = mimesniff_stats;
+
 	return NSERROR_OK;
 }
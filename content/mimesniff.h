@@ -25,12 +25,25 @@
 #define NETSURF_CONTENT_MIMESNIFF_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include <libwapcaplet/libwapcaplet.h>
 #include "utils/errors.h"
 
 struct llcache_handle;
 
+/**
+ * Counters of mime sniffing outcomes
+ */
+struct mimesniff_stats {
+	uint64_t total;		/**< Effective type computations made */
+	uint64_t official;	/**< Header type used unmodified */
+	uint64_t text;		/**< Text or binary sniffs performed */
+	uint64_t image;		/**< Image signature sniffs performed */
+	uint64_t html;		/**< Feed or html sniffs performed */
+	uint64_t unknown;	/**< Full unknown type sniffs performed */
+};
+
 /**
  * Compute the effective MIME type for an object
  *
@@ -52,4 +65,12 @@ nserror mimesniff_compute_effective_type(const char *content_type_header,
 		const uint8_t *data, size_t len, bool sniff_allowed,
 		bool image_only, lwc_string **effective_type);
 
+/**
+ * Get counters of the sniffing outcomes so far
+ *
+ * \param stats  Location to receive the counters
+ * \return NSERROR_OK on success
+ */
+nserror mimesniff_get_stats(struct mimesniff_stats *stats);
+
 #endif
@@ -0,0 +1,302 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf.
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Per navigation page load phase timing recording.
+ *
+ * Open navigations are kept in a small fixed table keyed by an
+ * opaque handle. Phase durations accumulate while the navigation is
+ * open and, when it is closed and committed, are copied into a ring
+ * of recent samples per phase from which the aggregate statistics
+ * are computed on demand.
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nsutils/time.h>
+
+#include "utils/errors.h"
+#include "utils/log.h"
+
+#include "content/page_timings.h"
+
+/** Maximum number of concurrently recorded navigations */
+#define TIMINGS_OPEN_MAX 8
+
+/** Number of committed samples retained per phase */
+#define TIMINGS_SAMPLE_MAX 128
+
+/**
+ * An open navigation being recorded
+ */
+struct timings_open {
+	const void *key; /**< handle this record is for, NULL if free */
+	/** accumulated duration of each phase in ms */
+	uint64_t phase_ms[PAGE_TIMINGS_PHASE_COUNT];
+	/** time each phase last started, 0 if not running */
+	uint64_t phase_started[PAGE_TIMINGS_PHASE_COUNT];
+};
+
+/** Table of open navigations */
+static struct timings_open timings_open_table[TIMINGS_OPEN_MAX];
+
+/** Ring of committed phase durations in ms */
+static uint64_t timings_samples[PAGE_TIMINGS_PHASE_COUNT][TIMINGS_SAMPLE_MAX];
+
+/** Next write position in the sample ring */
+static unsigned int timings_sample_pos;
+
+/** Number of valid entries in the sample ring */
+static unsigned int timings_sample_count;
+
+/** Total navigations committed since startup */
+static unsigned int timings_committed;
+
+/** Human readable phase names, indexed by phase */
+static const char *timings_phase_names[PAGE_TIMINGS_PHASE_COUNT] = {
+	"Fetch",
+	"Parse",
+	"Style",
+	"Box construct",
+	"Layout",
+	"Paint",
+};
+
+
+/**
+ * Find the open record for a key.
+ *
+ * \param key The handle to find the record of.
+ * \return The record or NULL if the key is not being recorded.
+ */
+static struct timings_open *timings_find(const void *key)
+{
+	unsigned int idx;
+
+	if (key == NULL) {
+		return NULL;
+	}
+
+	for (idx = 0; idx < TIMINGS_OPEN_MAX; idx++) {
+		if (timings_open_table[idx].key == key) {
+			return &timings_open_table[idx];
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * Comparison function for sorting durations.
+ */
+static int timings_sample_cmp(const void *a, const void *b)
+{
+	const uint64_t sa = *(const uint64_t *)a;
+	const uint64_t sb = *(const uint64_t *)b;
+
+	if (sa < sb) {
+		return -1;
+	} else if (sa > sb) {
+		return 1;
+	}
+	return 0;
+}
+
+
+/* exported interface documented in content/page_timings.h */
+nserror page_timings_open(const void *key)
+{
+	struct timings_open *rec;
+	unsigned int idx;
+
+	/* reopening a key discards the partial record */
+	rec = timings_find(key);
+	if (rec == NULL) {
+		for (idx = 0; idx < TIMINGS_OPEN_MAX; idx++) {
+			if (timings_open_table[idx].key == NULL) {
+				rec = &timings_open_table[idx];
+				break;
+			}
+		}
+	}
+	if (rec == NULL) {
+		return NSERROR_NOSPACE;
+	}
+
+	memset(rec, 0, sizeof(*rec));
+	rec->key = key;
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in content/page_timings.h */
+void page_timings_phase_start(const void *key, enum page_timings_phase phase)
+{
+	struct timings_open *rec;
+
+	rec = timings_find(key);
+	if ((rec == NULL) || (phase >= PAGE_TIMINGS_PHASE_COUNT)) {
+		return;
+	}
+
+	if (rec->phase_started[phase] == 0) {
+		nsu_getmonotonic_ms(&rec->phase_started[phase]);
+	}
+}
+
+
+/* exported interface documented in content/page_timings.h */
+void page_timings_phase_stop(const void *key, enum page_timings_phase phase)
+{
+	struct timings_open *rec;
+	uint64_t now_ms;
+
+	rec = timings_find(key);
+	if ((rec == NULL) ||
+	    (phase >= PAGE_TIMINGS_PHASE_COUNT) ||
+	    (rec->phase_started[phase] == 0)) {
+		return;
+	}
+
+	nsu_getmonotonic_ms(&now_ms);
+	rec->phase_ms[phase] += now_ms - rec->phase_started[phase];
+	rec->phase_started[phase] = 0;
+}
+
+
+/* exported interface documented in content/page_timings.h */
+void page_timings_phase_add(const void *key,
+			    enum page_timings_phase phase,
+			    uint64_t ms)
+{
+	struct timings_open *rec;
+
+	rec = timings_find(key);
+	if ((rec == NULL) || (phase >= PAGE_TIMINGS_PHASE_COUNT)) {
+		return;
+	}
+
+	rec->phase_ms[phase] += ms;
+}
+
+
+/* exported interface documented in content/page_timings.h */
+void page_timings_close(const void *key, bool commit)
+{
+	struct timings_open *rec;
+	unsigned int phase;
+
+	rec = timings_find(key);
+	if (rec == NULL) {
+		return;
+	}
+
+	if (commit) {
+		/* a still running phase contributes what it has so far */
+		for (phase = 0; phase < PAGE_TIMINGS_PHASE_COUNT; phase++) {
+			page_timings_phase_stop(key, phase);
+		}
+
+		for (phase = 0; phase < PAGE_TIMINGS_PHASE_COUNT; phase++) {
+			timings_samples[phase][timings_sample_pos] =
+				rec->phase_ms[phase];
+		}
+		timings_sample_pos =
+			(timings_sample_pos + 1) % TIMINGS_SAMPLE_MAX;
+		if (timings_sample_count < TIMINGS_SAMPLE_MAX) {
+			timings_sample_count++;
+		}
+		timings_committed++;
+
+		NSLOG(netsurf, DEBUG,
+		      "%p fetch:%"PRIu64" parse:%"PRIu64" style:%"PRIu64
+		      " box:%"PRIu64" layout:%"PRIu64" paint:%"PRIu64" (ms)",
+		      key,
+		      rec->phase_ms[PAGE_TIMINGS_FETCH],
+		      rec->phase_ms[PAGE_TIMINGS_PARSE],
+		      rec->phase_ms[PAGE_TIMINGS_STYLE],
+		      rec->phase_ms[PAGE_TIMINGS_BOX],
+		      rec->phase_ms[PAGE_TIMINGS_LAYOUT],
+		      rec->phase_ms[PAGE_TIMINGS_PAINT]);
+	}
+
+	memset(rec, 0, sizeof(*rec));
+}
+
+
+/* exported interface documented in content/page_timings.h */
+const char *page_timings_phase_name(enum page_timings_phase phase)
+{
+	if (phase >= PAGE_TIMINGS_PHASE_COUNT) {
+		return "Unknown";
+	}
+	return timings_phase_names[phase];
+}
+
+
+/* exported interface documented in content/page_timings.h */
+nserror page_timings_phase_stats(enum page_timings_phase phase,
+				 struct page_timings_stats *stats)
+{
+	uint64_t sorted[TIMINGS_SAMPLE_MAX];
+	uint64_t total;
+	unsigned int idx;
+
+	if ((phase >= PAGE_TIMINGS_PHASE_COUNT) || (stats == NULL)) {
+		return NSERROR_BAD_PARAMETER;
+	}
+
+	if (timings_sample_count == 0) {
+		return NSERROR_NOT_FOUND;
+	}
+
+	memcpy(sorted,
+	       timings_samples[phase],
+	       timings_sample_count * sizeof(uint64_t));
+	qsort(sorted,
+	      timings_sample_count,
+	      sizeof(uint64_t),
+	      timings_sample_cmp);
+
+	total = 0;
+	for (idx = 0; idx < timings_sample_count; idx++) {
+		total += sorted[idx];
+	}
+
+	stats->count = timings_sample_count;
+	stats->min = sorted[0];
+	stats->max = sorted[timings_sample_count - 1];
+	stats->mean = total / timings_sample_count;
+	stats->p50 = sorted[(timings_sample_count - 1) * 50 / 100];
+	stats->p90 = sorted[(timings_sample_count - 1) * 90 / 100];
+	stats->p99 = sorted[(timings_sample_count - 1) * 99 / 100];
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in content/page_timings.h */
+unsigned int page_timings_count(void)
+{
+	return timings_committed;
+}
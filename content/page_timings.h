@@ -0,0 +1,144 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf.
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Per navigation page load phase timing recording.
+ *
+ * Records how long each phase of a page load took, keyed by an
+ * opaque handle (the content being loaded), and aggregates the
+ * committed samples so percentiles can be reported by the
+ * about:timings page.
+ */
+
+#ifndef NETSURF_CONTENT_PAGE_TIMINGS_H
+#define NETSURF_CONTENT_PAGE_TIMINGS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Phases of a page load which are timed separately.
+ */
+enum page_timings_phase {
+	PAGE_TIMINGS_FETCH, /**< source data being fetched */
+	PAGE_TIMINGS_PARSE, /**< parsing source data to a DOM */
+	PAGE_TIMINGS_STYLE, /**< building the CSS selection context */
+	PAGE_TIMINGS_BOX, /**< converting the DOM to a box tree */
+	PAGE_TIMINGS_LAYOUT, /**< laying the box tree out */
+	PAGE_TIMINGS_PAINT, /**< redrawing the laid out page */
+	PAGE_TIMINGS_PHASE_COUNT /**< number of phases, not a phase */
+};
+
+/**
+ * Aggregate statistics for one phase across committed samples.
+ *
+ * All times are in milliseconds.
+ */
+struct page_timings_stats {
+	unsigned int count; /**< number of samples aggregated */
+	uint64_t min;
+	uint64_t max;
+	uint64_t mean;
+	uint64_t p50; /**< median */
+	uint64_t p90; /**< 90th percentile */
+	uint64_t p99; /**< 99th percentile */
+};
+
+/**
+ * Begin recording a navigation.
+ *
+ * \param key Opaque handle identifying the navigation.
+ * \return NSERROR_OK on success or NSERROR_NOSPACE if too many
+ *           navigations are already being recorded.
+ */
+nserror page_timings_open(const void *key);
+
+/**
+ * Mark a phase of a recorded navigation as having started.
+ *
+ * A phase may start and stop several times; the durations are
+ * accumulated. Unknown keys are ignored.
+ *
+ * \param key Opaque handle identifying the navigation.
+ * \param phase The phase that is starting.
+ */
+void page_timings_phase_start(const void *key, enum page_timings_phase phase);
+
+/**
+ * Mark a phase of a recorded navigation as having stopped.
+ *
+ * Unknown keys and phases which were not started are ignored.
+ *
+ * \param key Opaque handle identifying the navigation.
+ * \param phase The phase that is stopping.
+ */
+void page_timings_phase_stop(const void *key, enum page_timings_phase phase);
+
+/**
+ * Add an externally measured duration to a phase of a navigation.
+ *
+ * \param key Opaque handle identifying the navigation.
+ * \param phase The phase the duration belongs to.
+ * \param ms The duration in milliseconds.
+ */
+void page_timings_phase_add(const void *key,
+			    enum page_timings_phase phase,
+			    uint64_t ms);
+
+/**
+ * Finish recording a navigation.
+ *
+ * \param key Opaque handle identifying the navigation.
+ * \param commit Whether to commit the sample to the aggregates; a
+ *                 navigation which was aborted or errored should not
+ *                 be committed.
+ */
+void page_timings_close(const void *key, bool commit);
+
+/**
+ * Get the human readable name of a phase.
+ *
+ * \param phase The phase to name.
+ * \return The phase name.
+ */
+const char *page_timings_phase_name(enum page_timings_phase phase);
+
+/**
+ * Get aggregate statistics for a phase.
+ *
+ * \param phase The phase to aggregate.
+ * \param stats Updated with the aggregate statistics.
+ * \return NSERROR_OK on success, NSERROR_BAD_PARAMETER on a bad
+ *           phase or NSERROR_NOT_FOUND if no samples have been
+ *           committed yet.
+ */
+nserror page_timings_phase_stats(enum page_timings_phase phase,
+				 struct page_timings_stats *stats);
+
+/**
+ * Get the total number of navigations committed since startup.
+ *
+ * This may exceed the number of samples aggregated as only the most
+ * recent navigations are retained.
+ *
+ * \return The number of committed navigations.
+ */
+unsigned int page_timings_count(void);
+
+#endif
@@ -192,6 +192,128 @@ static void search_show_all(bool all, struct textsearch_context *context)
 }
 
 
+/**
+ * Determine whether a search can refine the previous set of matches.
+ *
+ * A search can be refined when the new string extends the previous
+ * one, as every new match must then start at a previous match. The
+ * wildcard characters void that property so their presence prevents
+ * refinement.
+ *
+ * \param context The search context.
+ * \param string the string to search for
+ * \param string_len length of search string
+ * \param case_sensitive whether the new search is case sensitive
+ * \return true iff the previous matches can be refined
+ */
+static bool
+search_can_refine(struct textsearch_context *context,
+		  const char *string,
+		  int string_len,
+		  bool case_sensitive)
+{
+	int prev_len;
+	int idx;
+
+	if (context->c->handler->textsearch_refind == NULL) {
+		return false;
+	}
+
+	if ((context->string == NULL) ||
+	    (context->prev_case_sens != case_sensitive)) {
+		return false;
+	}
+
+	prev_len = strlen(context->string);
+	if ((prev_len == 0) ||
+	    (prev_len >= string_len) ||
+	    (strncmp(context->string, string, prev_len) != 0)) {
+		return false;
+	}
+
+	for (idx = 0; idx < string_len; idx++) {
+		if ((string[idx] == '*') || (string[idx] == '#')) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/**
+ * Refine the previous set of matches with an extended string.
+ *
+ * Rescans only the regions of the content which held a match,
+ * instead of the whole content. Each region is rescanned from its
+ * first previous match, which is sound because no match of the
+ * extended string can start before the first match of its prefix.
+ *
+ * \param context The search context.
+ * \param string the string to search for
+ * \param string_len length of search string
+ * \param case_sensitive whether the search is case sensitive
+ */
+static nserror
+search_refine(struct textsearch_context *context,
+	      const char *string,
+	      int string_len,
+	      bool case_sensitive)
+{
+	struct list_entry *old_head;
+	struct list_entry *cur;
+	struct list_entry *nxt;
+	unsigned int scanned_to = 0;
+	bool scanned = false;
+	nserror res = NSERROR_OK;
+
+	/*
+	 * detach the old matches; the new list is rebuilt from them
+	 * and they are only released once the handler has finished
+	 * with their positions
+	 */
+	old_head = context->found->next;
+	context->found->prev = NULL;
+	context->found->next = NULL;
+	context->current = NULL;
+
+	for (cur = old_head; cur != NULL; cur = cur->next) {
+		if (scanned && (cur->start_idx < scanned_to)) {
+			/* region already rescanned */
+			continue;
+		}
+
+		res = context->c->handler->textsearch_refind(context->c,
+							     context,
+							     string,
+							     string_len,
+							     case_sensitive,
+							     cur->start_box,
+							     cur->start_idx,
+							     &scanned_to);
+		if (res != NSERROR_OK) {
+			break;
+		}
+		scanned = true;
+	}
+
+	/* release the old matches, deleting selection objects too */
+	for (cur = old_head; cur != NULL; cur = nxt) {
+		nxt = cur->next;
+		if (cur->sel) {
+			selection_destroy(cur->sel);
+		}
+		free(cur);
+	}
+
+	if (res != NSERROR_OK) {
+		free_matches(context);
+	}
+
+	return res;
+}
+
+
 /**
  * Search for a string in a content.
  *
@@ -223,14 +345,18 @@ search_text(struct textsearch_context *context,
 	/* check if we need to start a new search or continue an old one */
 	if ((context->newsearch) ||
 	    (context->prev_case_sens != case_sensitive)) {
+		bool refine;
+
+		/* check before the previous string is replaced */
+		refine = search_can_refine(context,
+					   string,
+					   string_len,
+					   case_sensitive);
 
 		if (context->string != NULL) {
 			free(context->string);
 		}
 
-		context->current = NULL;
-		free_matches(context);
-
 		context->string = malloc(string_len + 1);
 		if (context->string != NULL) {
 			memcpy(context->string, string, string_len);
@@ -241,12 +367,23 @@ search_text(struct textsearch_context *context,
 		textsearch_broadcast(context, CONTENT_TEXTSEARCH_FIND, true, NULL);
 
 
-		/* call content find handler */
-		res = context->c->handler->textsearch_find(context->c,
-							   context,
-							   string,
-							   string_len,
-							   case_sensitive);
+		if (refine) {
+			/* narrow the previous matches to the new string */
+			res = search_refine(context,
+					    string,
+					    string_len,
+					    case_sensitive);
+		} else {
+			context->current = NULL;
+			free_matches(context);
+
+			/* call content find handler */
+			res = context->c->handler->textsearch_find(context->c,
+								   context,
+								   string,
+								   string_len,
+								   case_sensitive);
+		}
 
 		/* indicate find operation finished */
 		textsearch_broadcast(context, CONTENT_TEXTSEARCH_FIND, false, NULL);
@@ -704,16 +841,25 @@ content_textsearch(struct hlcache_handle *h,
 			return NSERROR_NOMEM;
 		}
 
-		if (c->textsearch.context != NULL) {
-			content_textsearch_destroy(c->textsearch.context);
-			c->textsearch.context = NULL;
-		}
+		if ((c->textsearch.context != NULL) &&
+		    (c->textsearch.context->gui_p == context)) {
+			/*
+			 * keep the previous context so its matches can
+			 * be refined if the new string extends the old
+			 */
+			c->textsearch.context->newsearch = true;
+		} else {
+			if (c->textsearch.context != NULL) {
+				content_textsearch_destroy(c->textsearch.context);
+				c->textsearch.context = NULL;
+			}
 
-		res = content_textsearch_create(c,
-						context,
-						&c->textsearch.context);
-		if (res != NSERROR_OK) {
-			return res;
+			res = content_textsearch_create(c,
+							context,
+							&c->textsearch.context);
+			if (res != NSERROR_OK) {
+				return res;
+			}
 		}
 
 		content_textsearch_step(c->textsearch.context, flags, string);
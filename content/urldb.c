@@ -87,13 +87,23 @@
  * potential crashes.
  */
 
+#include "utils/config.h"
+
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
 #include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
 #ifdef WITH_NSPSL
 #include <nspsl.h>
 #endif
@@ -105,6 +115,7 @@
 #include "utils/url.h"
 #include "utils/utils.h"
 #include "utils/bloom.h"
+#include "utils/hashmap.h"
 #include "utils/time.h"
 #include "utils/nsurl.h"
 #include "utils/ascii.h"
@@ -220,6 +231,14 @@ struct path_data {
 	struct path_data *parent; /**< Parent path segment */
 	struct path_data *children; /**< Child path segments */
 	struct path_data *last; /**< Last child */
+
+	/** Next node in parent's segment index bucket chain */
+	struct path_data *hash_next;
+	/** Hash index over children by segment, or NULL while there
+	 * are too few children for the sibling walk to matter. */
+	struct path_data **index;
+	unsigned int index_size; /**< Buckets in the segment index */
+	unsigned int child_count; /**< Number of child segments */
 };
 
 struct hsts_data {
@@ -241,6 +260,13 @@ struct host_part {
 	/* HSTS data */
 	struct hsts_data hsts;
 
+	/**
+	 * Number of cookies stored against this host's paths,
+	 * including domain cookies. Allows cookie matching to skip
+	 * hosts without any cookies at all.
+	 */
+	unsigned int cookie_count;
+
 	/**
 	 * Part of host string
 	 */
@@ -294,11 +320,26 @@ static struct search_node *search_trees[NUM_SEARCH_TREES] = {
 /** loaded cookie file version */
 static int loaded_cookie_file_version;
 
+/**
+ * Journal of cookie changes made since the last full cookie save, or
+ * NULL if no journal is in use. Opened for append once the cookie
+ * file has been loaded and truncated on each full save.
+ */
+static FILE *cookie_journal;
+
+/** TLS decision cache, keyed by host name */
+static hashmap_t *tls_cache;
+
 /** Minimum URL database file version */
 #define MIN_URL_FILE_VERSION 106
 /** Current URL database file version */
 #define URL_FILE_VERSION 107
 
+/** Magic identifying a binary format URL database file */
+#define URL_FILE_MAGIC "NSUB"
+/** Current binary URL database file version */
+#define URL_BINARY_FILE_VERSION 1
+
 /**
  * filter for url presence in database
  *
@@ -309,6 +350,11 @@ static int loaded_cookie_file_version;
  * has a 5% false-positive rate.  We set it to 32kB, which should be
  * enough for all but the largest databases, while not being
  * shockingly wasteful on memory.
+ *
+ * The filter is a counting one so that entries can be withdrawn when
+ * URLs are dropped from the database; a counting filter holds a
+ * quarter of the slots of a plain one per byte, hence the multiplier
+ * at the creation sites.
  */
 static struct bloom_filter *url_bloom;
 /**
@@ -316,6 +362,230 @@ static struct bloom_filter *url_bloom;
  */
 #define BLOOM_SIZE (1024 * 32)
 
+/**
+ * URL completion index entry.
+ */
+struct urldb_completion_entry {
+	/** Entry URL less scheme and credentials; owned by the node's URL */
+	const char *key;
+	/** The path node carrying the URL */
+	const struct path_data *path;
+};
+
+/**
+ * URL completion index.
+ *
+ * A flat array over every URL in the database, ordered by key, so a
+ * completion query is a binary search plus a bounded scan instead of
+ * a walk of the host and path trees.  New URLs are appended as they
+ * are added and the array is re-sorted lazily on the next query.
+ */
+static struct urldb_completion_entry *completion_index;
+
+/** Number of entries in the completion index. */
+static size_t completion_index_count;
+
+/** Number of entries allocated for the completion index. */
+static size_t completion_index_alloc;
+
+/** Whether the completion index needs sorting before use. */
+static bool completion_index_dirty;
+
+/**
+ * Set when the completion index could not be maintained; completion
+ * queries then fall back to walking the trees.
+ */
+static bool completion_index_broken;
+
+
+/**
+ * Obtain the completion key of a URL.
+ *
+ * The key is the URL string with the scheme separator and any
+ * credentials skipped, so it starts with the host, matching the
+ * prefixes typed into a URL bar.  The returned pointer shares the
+ * URL's storage and lives exactly as long as it.
+ *
+ * \param url URL to obtain a key for
+ * \return The completion key
+ */
+static const char *urldb_completion_key(nsurl *url)
+{
+	const char *s = nsurl_access(url);
+	const char *sep = strstr(s, "://");
+	const char *at, *slash;
+
+	if (sep == NULL)
+		return s;
+
+	s = sep + 3;
+
+	slash = strchr(s, '/');
+	at = strchr(s, '@');
+	if (at != NULL && (slash == NULL || at < slash))
+		s = at + 1;
+
+	return s;
+}
+
+
+/**
+ * Comparator ordering completion index entries by key.
+ *
+ * \param va first entry
+ * \param vb second entry
+ * \return <0, 0 or >0 as for strcasecmp
+ */
+static int urldb_completion_entry_cmp(const void *va, const void *vb)
+{
+	const struct urldb_completion_entry *a = va;
+	const struct urldb_completion_entry *b = vb;
+	int r = strcasecmp(a->key, b->key);
+
+	if (r == 0) {
+		/* keep the order of duplicate keys deterministic */
+		r = (a->path > b->path) - (a->path < b->path);
+	}
+
+	return r;
+}
+
+
+/**
+ * Add a path node's URL to the completion index.
+ *
+ * \param p Path node which has just gained a URL
+ */
+static void urldb_completion_add(const struct path_data *p)
+{
+	struct urldb_completion_entry *entry;
+
+	if (completion_index_broken || p->url == NULL)
+		return;
+
+	if (completion_index_count == completion_index_alloc) {
+		struct urldb_completion_entry *temp;
+		size_t nalloc = completion_index_alloc ?
+				completion_index_alloc * 2 : 1024;
+
+		temp = realloc(completion_index, nalloc * sizeof(*temp));
+		if (temp == NULL) {
+			/* an incomplete index would drop results, so
+			 * stop using the index altogether */
+			free(completion_index);
+			completion_index = NULL;
+			completion_index_count = 0;
+			completion_index_alloc = 0;
+			completion_index_broken = true;
+			return;
+		}
+
+		completion_index = temp;
+		completion_index_alloc = nalloc;
+	}
+
+	entry = &completion_index[completion_index_count++];
+	entry->key = urldb_completion_key(p->url);
+	entry->path = p;
+
+	completion_index_dirty = true;
+}
+
+
+/**
+ * Collect completion index entries matching a prefix.
+ *
+ * The index must be sorted.  Only leaf nodes are collected; interior
+ * nodes' URLs are reported by the leaves beneath them, as in the tree
+ * walk.
+ *
+ * \param prefix Prefix to match, already stripped of any scheme
+ * \param matches Pointer to array of matches to extend
+ * \param match_count Pointer to number of matches collected
+ * \param match_alloc Pointer to allocated size of matches
+ * \return true on success, false on memory exhaustion
+ */
+static bool
+urldb_completion_collect(const char *prefix,
+		const struct path_data ***matches,
+		size_t *match_count,
+		size_t *match_alloc)
+{
+	size_t plen = strlen(prefix);
+	size_t lo = 0, hi = completion_index_count;
+	size_t i;
+
+	/* find the first entry with key >= prefix */
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (strncasecmp(completion_index[mid].key, prefix, plen) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	for (i = lo; i < completion_index_count; i++) {
+		const struct path_data *p = completion_index[i].path;
+
+		if (strncasecmp(completion_index[i].key, prefix, plen) != 0)
+			break;
+
+		if (p->children != NULL)
+			continue;
+
+		if (*match_count == *match_alloc) {
+			const struct path_data **temp;
+			size_t nalloc = *match_alloc ? *match_alloc * 2 : 64;
+
+			temp = realloc(*matches, nalloc * sizeof(*temp));
+			if (temp == NULL)
+				return false;
+
+			*matches = temp;
+			*match_alloc = nalloc;
+		}
+
+		(*matches)[(*match_count)++] = p;
+	}
+
+	return true;
+}
+
+
+/**
+ * Comparator ranking collected completion matches.
+ *
+ * Most visited first, then most recently visited, so the results a
+ * frontend shows first are the ones the user most likely wants.
+ *
+ * \param va first match
+ * \param vb second match
+ * \return <0, 0 or >0 ordering the matches
+ */
+static int urldb_completion_rank_cmp(const void *va, const void *vb)
+{
+	const struct path_data *a = *(const struct path_data **)va;
+	const struct path_data *b = *(const struct path_data **)vb;
+
+	if (a->urld.visits != b->urld.visits)
+		return (a->urld.visits < b->urld.visits) ? 1 : -1;
+
+	if (a->urld.last_visit != b->urld.last_visit)
+		return (a->urld.last_visit < b->urld.last_visit) ? 1 : -1;
+
+	return strcasecmp(nsurl_access(a->url), nsurl_access(b->url));
+}
+
+/**
+ * Number of children at which a path node gains a segment index.
+ *
+ * Below this the sibling list walk is cheaper than maintaining an
+ * index; above it hosts with many distinct paths (wikis, issue
+ * trackers) degrade linearly without one.
+ */
+#define PATH_INDEX_THRESHOLD 16
+
 
 /**
  * write a time_t to a file portably
@@ -338,12 +608,51 @@ static nserror urldb_write_timet(FILE *fp, time_t val)
 	return NSERROR_OK;
 }
 
+/**
+ * write a 16bit value to a binary database file
+ */
+static void urldb_write_bin_u16(FILE *fp, uint16_t val)
+{
+	fwrite(&val, sizeof(val), 1, fp);
+}
+
+/**
+ * write a 32bit value to a binary database file
+ */
+static void urldb_write_bin_u32(FILE *fp, uint32_t val)
+{
+	fwrite(&val, sizeof(val), 1, fp);
+}
+
+/**
+ * write a 64bit time value to a binary database file
+ */
+static void urldb_write_bin_time(FILE *fp, time_t val)
+{
+	int64_t v = (int64_t)val;
+	fwrite(&v, sizeof(v), 1, fp);
+}
+
+/**
+ * write a length prefixed string to a binary database file
+ *
+ * A NULL string is written as a zero length.
+ */
+static void urldb_write_bin_str(FILE *fp, const char *s, size_t len)
+{
+	urldb_write_bin_u32(fp, len);
+	if (len > 0) {
+		fwrite(s, len, 1, fp);
+	}
+}
+
 /**
  * Write paths associated with a host
  *
  * \param parent Root of (sub)tree to write
  * \param host Current host name
  * \param fp File to write to
+ * \param binary Whether to write the binary format
  * \param path Current path string
  * \param path_alloc Allocated size of path
  * \param path_used Used size of path
@@ -353,6 +662,7 @@ static void
 urldb_write_paths(const struct path_data *parent,
 		  const char *host,
 		  FILE *fp,
+		  bool binary,
 		  char **path,
 		  int *path_alloc,
 		  int *path_used,
@@ -395,9 +705,28 @@ urldb_write_paths(const struct path_data *parent,
 			p = p->children;
 		} else {
 			/* leaf node */
-			if (p->persistent ||
-			    ((p->urld.last_visit > expiry) &&
-			     (p->urld.visits > 0))) {
+			bool wanted = p->persistent ||
+				((p->urld.last_visit > expiry) &&
+				 (p->urld.visits > 0));
+
+			if (wanted && binary) {
+				urldb_write_bin_str(fp,
+						lwc_string_data(p->scheme),
+						lwc_string_length(p->scheme));
+				urldb_write_bin_u16(fp, p->port);
+				urldb_write_bin_str(fp, *path,
+						strlen(*path));
+
+				/** \todo handle fragments? */
+
+				urldb_write_bin_u32(fp, p->urld.visits);
+				urldb_write_bin_time(fp, p->urld.last_visit);
+				urldb_write_bin_u32(fp,
+						(uint32_t)p->urld.type);
+				urldb_write_bin_str(fp, p->urld.title,
+						p->urld.title != NULL ?
+						strlen(p->urld.title) : 0);
+			} else if (wanted) {
 				fprintf(fp, "%s\n", lwc_string_data(p->scheme));
 
 				if (p->port) {
@@ -510,8 +839,10 @@ urldb_count_urls(const struct path_data *root,
  *
  * \param parent root node of search tree to save.
  * \param fp File to write to
+ * \param binary Whether to write the binary format
  */
-static void urldb_save_search_tree(struct search_node *parent, FILE *fp)
+static void
+urldb_save_search_tree(struct search_node *parent, FILE *fp, bool binary)
 {
 	char host[256];
 	const struct host_part *h;
@@ -526,7 +857,7 @@ static void urldb_save_search_tree(struct search_node *parent, FILE *fp)
 	if (parent == &empty)
 		return;
 
-	urldb_save_search_tree(parent->left, fp);
+	urldb_save_search_tree(parent->left, fp, binary);
 
 	path = malloc(path_alloc);
 	if (!path)
@@ -553,22 +884,29 @@ static void urldb_save_search_tree(struct search_node *parent, FILE *fp)
 
 	urldb_count_urls(&parent->data->paths, expiry, &path_count);
 
-	if (path_count > 0) {
-		fprintf(fp, "%s %i ", host, hsts_include_subdomains);
-		urldb_write_timet(fp, hsts_expiry);
-		fprintf(fp, "%i\n", path_count);
+	if ((path_count > 0) || hsts_expiry) {
+		if (binary) {
+			urldb_write_bin_str(fp, host, strlen(host));
+			urldb_write_bin_u16(fp, hsts_include_subdomains);
+			urldb_write_bin_time(fp, hsts_expiry);
+			urldb_write_bin_u32(fp, path_count);
+		} else {
+			fprintf(fp, "%s %i ", host, hsts_include_subdomains);
+			urldb_write_timet(fp, hsts_expiry);
+			fprintf(fp, "%i\n", path_count);
+		}
 
-		urldb_write_paths(&parent->data->paths, host, fp,
-				  &path, &path_alloc, &path_used, expiry);
-	} else if (hsts_expiry) {
-		fprintf(fp, "%s %i ", host, hsts_include_subdomains);
-		urldb_write_timet(fp, hsts_expiry);
-		fprintf(fp, "0\n");
+		if (path_count > 0) {
+			urldb_write_paths(&parent->data->paths, host, fp,
+					  binary,
+					  &path, &path_alloc, &path_used,
+					  expiry);
+		}
 	}
 
 	free(path);
 
-	urldb_save_search_tree(parent->right, fp);
+	urldb_save_search_tree(parent->right, fp, binary);
 }
 
 
@@ -1090,6 +1428,140 @@ urldb_add_path_fragment(struct path_data *segment, lwc_string *fragment)
 }
 
 
+/**
+ * Hash a path segment for the per-node child index
+ *
+ * \param segment The segment text, not necessarily terminated.
+ * \param len Length of the segment text.
+ * \return hash value for segment
+ */
+static uint32_t urldb_segment_hash(const char *segment, size_t len)
+{
+	uint32_t hash = 2166136261u;
+
+	while (len-- > 0) {
+		hash ^= (uint8_t)*segment++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/**
+ * Insert a node into its parent's segment index, if one exists.
+ *
+ * \param parent The parent node.
+ * \param d The child node to index.
+ */
+static void urldb_index_insert(struct path_data *parent, struct path_data *d)
+{
+	uint32_t bucket;
+
+	if (parent->index == NULL)
+		return;
+
+	bucket = urldb_segment_hash(d->segment, strlen(d->segment)) &
+		(parent->index_size - 1);
+	d->hash_next = parent->index[bucket];
+	parent->index[bucket] = d;
+}
+
+/**
+ * Build or grow a node's segment index.
+ *
+ * Does nothing until the node has enough children for the sibling
+ * list walk to be noticeable. The index is purely an accelerator so
+ * allocation failure simply leaves the list walk in use.
+ *
+ * \param parent The node to index the children of.
+ */
+static void urldb_index_build(struct path_data *parent)
+{
+	struct path_data *e;
+	unsigned int size;
+
+	if (parent->child_count < PATH_INDEX_THRESHOLD)
+		return;
+
+	if ((parent->index != NULL) &&
+	    (parent->child_count <= parent->index_size))
+		return;
+
+	/* at least twice as many buckets as children, in powers of two */
+	size = PATH_INDEX_THRESHOLD * 2;
+	while (size < (parent->child_count * 2))
+		size *= 2;
+
+	free(parent->index);
+	parent->index = calloc(size, sizeof(*parent->index));
+	if (parent->index == NULL) {
+		parent->index_size = 0;
+		return;
+	}
+	parent->index_size = size;
+
+	for (e = parent->children; e != NULL; e = e->next) {
+		e->hash_next = NULL;
+		urldb_index_insert(parent, e);
+	}
+}
+
+/**
+ * Look up a child of a path node by segment
+ *
+ * Uses the parent's segment index where one has been built and falls
+ * back to walking the sibling list.
+ *
+ * \param parent The node whose children to search.
+ * \param segment The segment text, not necessarily terminated.
+ * \param seglen Length of the segment text.
+ * \param scheme URL scheme to match.
+ * \param port Port to match.
+ * \return The matching child node or NULL.
+ */
+static struct path_data *
+urldb_find_child(const struct path_data *parent,
+		 const char *segment,
+		 size_t seglen,
+		 lwc_string *scheme,
+		 unsigned int port)
+{
+	struct path_data *e;
+	bool match;
+
+	if (parent->index != NULL) {
+		uint32_t bucket = urldb_segment_hash(segment, seglen) &
+			(parent->index_size - 1);
+		e = parent->index[bucket];
+
+		for (; e != NULL; e = e->hash_next) {
+			if ((strncmp(e->segment, segment, seglen) == 0) &&
+			    (e->segment[seglen] == '\0') &&
+			    (lwc_string_isequal(scheme, e->scheme,
+						&match) == lwc_error_ok) &&
+			    (match == true) &&
+			    (e->port == port)) {
+				return e;
+			}
+		}
+
+		return NULL;
+	}
+
+	for (e = parent->children; e != NULL; e = e->next) {
+		if ((strncmp(e->segment, segment, seglen) == 0) &&
+		    (e->segment[seglen] == '\0') &&
+		    (lwc_string_isequal(scheme, e->scheme,
+					&match) == lwc_error_ok) &&
+		    (match == true) &&
+		    (e->port == port)) {
+			return e;
+		}
+	}
+
+	return NULL;
+}
+
 /**
  * Add a path node to the tree
  *
@@ -1159,6 +1631,11 @@ urldb_add_path_node(lwc_string *scheme,
 	}
 	d->parent = parent;
 
+	/* keep the segment index over the children current */
+	parent->child_count++;
+	urldb_index_insert(parent, d);
+	urldb_index_build(parent);
+
 	return d;
 }
 
@@ -1306,7 +1783,6 @@ urldb_match_path(const struct path_data *parent,
 {
 	const struct path_data *p;
 	const char *slash;
-	bool match;
 
 	assert(parent != NULL);
 	assert(parent->segment == NULL);
@@ -1317,8 +1793,7 @@ urldb_match_path(const struct path_data *parent,
 
 	assert(path[0] == '/');
 
-	/* Start with children, as parent has no segment */
-	p = parent->children;
+	p = parent;
 
 	while (p != NULL) {
 		slash = strchr(path + 1, '/');
@@ -1326,23 +1801,20 @@ urldb_match_path(const struct path_data *parent,
 			slash = path + strlen(path);
 		}
 
-		if (strncmp(p->segment, path + 1, slash - path - 1) == 0 &&
-		    lwc_string_isequal(p->scheme, scheme, &match) == lwc_error_ok &&
-		    match == true &&
-		    p->port == port) {
-			if (*slash == '\0') {
-				/* Complete match */
-				return (struct path_data *) p;
-			}
-
-			/* Match so far, go down tree */
-			p = p->children;
+		p = urldb_find_child(p, path + 1, slash - path - 1,
+				     scheme, port);
+		if (p == NULL) {
+			/* No matching segment at this level */
+			return NULL;
+		}
 
-			path = slash;
-		} else {
-			/* No match, try next sibling */
-			p = p->next;
+		if (*slash == '\0') {
+			/* Complete match */
+			return (struct path_data *) p;
 		}
+
+		/* Match so far, go down tree */
+		path = slash;
 	}
 
 	return NULL;
@@ -2093,7 +2565,6 @@ urldb_add_path(lwc_string *scheme,
 	struct path_data *d, *e;
 	char *buf = path_query;
 	char *segment, *slash;
-	bool match;
 
 	assert(scheme && host && url);
 
@@ -2110,14 +2581,8 @@ urldb_add_path(lwc_string *scheme,
 		if (!slash) {
 			/* last segment */
 			/* look for existing entry */
-			for (e = d->children; e; e = e->next)
-				if (strcmp(segment, e->segment) == 0 &&
-				    lwc_string_isequal(scheme,
-						       e->scheme, &match) ==
-				    lwc_error_ok &&
-				    match == true &&
-				    e->port == port)
-					break;
+			e = urldb_find_child(d, segment, strlen(segment),
+					     scheme, port);
 
 			d = e ? urldb_add_path_fragment(e, fragment) :
 				urldb_add_path_node(scheme, port,
@@ -2128,13 +2593,8 @@ urldb_add_path(lwc_string *scheme,
 		*slash = '\0';
 
 		/* look for existing entry */
-		for (e = d->children; e; e = e->next)
-			if (strcmp(segment, e->segment) == 0 &&
-			    lwc_string_isequal(scheme, e->scheme,
-					       &match) == lwc_error_ok &&
-			    match == true &&
-			    e->port == port)
-				break;
+		e = urldb_find_child(d, segment, strlen(segment),
+				     scheme, port);
 
 		d = e ? e : urldb_add_path_node(scheme, port, segment, NULL, d);
 		if (!d)
@@ -2149,6 +2609,8 @@ urldb_add_path(lwc_string *scheme,
 		/* Insert defragmented URL */
 		if (nsurl_defragment(url, &d->url) != NSERROR_OK)
 			return NULL;
+
+		urldb_completion_add(d);
 	}
 
 	return d;
@@ -2245,6 +2707,84 @@ static struct host_part *urldb_add_host(const char *host)
 }
 
 
+/**
+ * Find the host a path node belongs to
+ *
+ * \param p Path node
+ * \return Host owning the path
+ */
+static struct host_part *urldb_get_path_host(struct path_data *p)
+{
+	while (p->parent != NULL)
+		p = p->parent;
+
+	/* A host's root path is the first member of the host */
+	return (struct host_part *) p;
+}
+
+
+/**
+ * Write a cookie to a cookie file as a single line
+ *
+ * \param fp File pointer to write to
+ * \param c Cookie to write
+ * \param p Path the cookie is stored against
+ * \param expires Expiry time to record for the cookie
+ */
+static void
+urldb_write_cookie(FILE *fp,
+		   const struct cookie_internal_data *c,
+		   const struct path_data *p,
+		   time_t expires)
+{
+	fprintf(fp,
+		"%d\t%s\t%d\t%s\t%d\t%d\t%d\t%d\t%d\t%d\t"
+		"%s\t%s\t%d\t%s\t%s\t%s\n",
+		c->version, c->domain,
+		c->domain_from_set, c->path,
+		c->path_from_set, c->secure,
+		c->http_only,
+		(int)expires, (int)c->last_used,
+		c->no_destroy, c->name, c->value,
+		c->value_was_quoted,
+		p->scheme ? lwc_string_data(p->scheme) :
+		"unused",
+		p->url ? nsurl_access(p->url) :
+		"unused",
+		c->comment ? c->comment : "");
+}
+
+
+/**
+ * Record a cookie change in the journal
+ *
+ * Changes are replayed over the main cookie file on startup, so a
+ * full save is not needed after every change. Removals are recorded
+ * by writing the cookie with an expiry in the past, which the replay
+ * discards.
+ *
+ * \param c Cookie which was added, replaced or removed
+ * \param p Path the cookie was stored against
+ * \param removed Whether the cookie was removed
+ */
+static void
+urldb_journal_cookie(const struct cookie_internal_data *c,
+		     const struct path_data *p,
+		     bool removed)
+{
+	if (cookie_journal == NULL)
+		return;
+
+	if (c->expires == -1) {
+		/* Session cookies are never persisted */
+		return;
+	}
+
+	urldb_write_cookie(cookie_journal, c, p, removed ? 0 : c->expires);
+	fflush(cookie_journal);
+}
+
+
 /**
  * Insert a cookie into the database
  *
@@ -2260,6 +2800,7 @@ urldb_insert_cookie(struct cookie_internal_data *c,
 {
 	struct cookie_internal_data *d;
 	const struct host_part *h;
+	struct host_part *host;
 	struct path_data *p;
 	time_t now = time(NULL);
 
@@ -2326,6 +2867,12 @@ urldb_insert_cookie(struct cookie_internal_data *c,
 
 			cookie_manager_remove((struct cookie_data *)d);
 
+			urldb_journal_cookie(c, p, true);
+
+			host = urldb_get_path_host(p);
+			if (host->cookie_count > 0)
+				host->cookie_count--;
+
 			urldb_free_cookie(d);
 			urldb_free_cookie(c);
 		} else {
@@ -2345,6 +2892,8 @@ urldb_insert_cookie(struct cookie_internal_data *c,
 			urldb_free_cookie(d);
 
 			cookie_manager_add((struct cookie_data *)c);
+
+			urldb_journal_cookie(c, p, false);
 		}
 	} else {
 		c->prev = p->cookies_end;
@@ -2356,6 +2905,9 @@ urldb_insert_cookie(struct cookie_internal_data *c,
 		p->cookies_end = c;
 
 		cookie_manager_add((struct cookie_data *)c);
+
+		urldb_journal_cookie(c, p, false);
+		urldb_get_path_host(p)->cookie_count++;
 	}
 
 	return true;
@@ -2533,8 +3085,9 @@ urldb_concat_cookie(struct cookie_internal_data *c,
  * \param path the cookie path
  * \param name The cookie name
  * \param parent The url data of the cookie
+ * \return true if a cookie was removed, false otherwise
  */
-static void
+static bool
 urldb_delete_cookie_paths(const char *domain,
 			  const char *path,
 			  const char *name,
@@ -2562,9 +3115,11 @@ urldb_delete_cookie_paths(const char *domain,
 					p->cookies_end = c->prev;
 				}
 
+				urldb_journal_cookie(c, p, true);
+
 				urldb_free_cookie(c);
 
-				return;
+				return true;
 			}
 		}
 
@@ -2581,6 +3136,8 @@ urldb_delete_cookie_paths(const char *domain,
 			}
 		}
 	} while (p != parent);
+
+	return false;
 }
 
 
@@ -2601,7 +3158,10 @@ urldb_delete_cookie_hosts(const char *domain,
 	struct host_part *h;
 	assert(parent);
 
-	urldb_delete_cookie_paths(domain, path, name, &parent->paths);
+	if (urldb_delete_cookie_paths(domain, path, name, &parent->paths) &&
+	    parent->cookie_count > 0) {
+		parent->cookie_count--;
+	}
 
 	for (h = parent->children; h; h = h->next) {
 		urldb_delete_cookie_hosts(domain, path, name, h);
@@ -2632,21 +3192,7 @@ static void urldb_save_cookie_paths(FILE *fp, struct path_data *parent)
 					continue;
 				}
 
-				fprintf(fp,
-					"%d\t%s\t%d\t%s\t%d\t%d\t%d\t%d\t%d\t%d\t"
-					"%s\t%s\t%d\t%s\t%s\t%s\n",
-					c->version, c->domain,
-					c->domain_from_set, c->path,
-					c->path_from_set, c->secure,
-					c->http_only,
-					(int)c->expires, (int)c->last_used,
-					c->no_destroy, c->name, c->value,
-					c->value_was_quoted,
-					p->scheme ? lwc_string_data(p->scheme) :
-					"unused",
-					p->url ? nsurl_access(p->url) :
-					"unused",
-					c->comment ? c->comment : "");
+				urldb_write_cookie(fp, c, p, c->expires);
 			}
 		}
 
@@ -2720,6 +3266,7 @@ static void urldb_destroy_path_node_content(struct path_data *node)
 	}
 
 	free(node->segment);
+	free(node->index);
 	for (i = 0; i < node->frag_cnt; i++)
 		free(node->fragment[i]);
 	free(node->fragment);
@@ -2869,8 +3416,348 @@ void urldb_destroy(void)
 		bloom_destroy(url_bloom);
 		url_bloom = NULL;
 	}
+
+	/* And the completion index */
+	free(completion_index);
+	completion_index = NULL;
+	completion_index_count = 0;
+	completion_index_alloc = 0;
+	completion_index_dirty = false;
+	completion_index_broken = false;
+
+	/* And the cookie journal */
+	if (cookie_journal != NULL) {
+		fclose(cookie_journal);
+		cookie_journal = NULL;
+	}
+
+	/* And the TLS decision cache */
+	if (tls_cache != NULL) {
+		hashmap_destroy(tls_cache);
+		tls_cache = NULL;
+	}
+}
+
+
+/**
+ * Cursor over a memory resident binary database file.
+ */
+struct urldb_bin_cursor {
+	const uint8_t *pos; /**< current read position */
+	const uint8_t *end; /**< end of the file data */
+};
+
+/**
+ * read a 16bit value from a binary database file
+ */
+static bool urldb_read_bin_u16(struct urldb_bin_cursor *bc, uint16_t *val)
+{
+	if ((size_t)(bc->end - bc->pos) < sizeof(*val)) {
+		return false;
+	}
+	memcpy(val, bc->pos, sizeof(*val));
+	bc->pos += sizeof(*val);
+	return true;
+}
+
+/**
+ * read a 32bit value from a binary database file
+ */
+static bool urldb_read_bin_u32(struct urldb_bin_cursor *bc, uint32_t *val)
+{
+	if ((size_t)(bc->end - bc->pos) < sizeof(*val)) {
+		return false;
+	}
+	memcpy(val, bc->pos, sizeof(*val));
+	bc->pos += sizeof(*val);
+	return true;
+}
+
+/**
+ * read a 64bit time value from a binary database file
+ */
+static bool urldb_read_bin_time(struct urldb_bin_cursor *bc, time_t *val)
+{
+	int64_t v;
+
+	if ((size_t)(bc->end - bc->pos) < sizeof(v)) {
+		return false;
+	}
+	memcpy(&v, bc->pos, sizeof(v));
+	bc->pos += sizeof(v);
+	*val = (time_t)v;
+	return true;
+}
+
+/**
+ * read a length prefixed string from a binary database file
+ *
+ * The returned pointer aliases the file data and is not terminated.
+ */
+static bool
+urldb_read_bin_str(struct urldb_bin_cursor *bc,
+		   const char **s,
+		   uint32_t *len)
+{
+	if (!urldb_read_bin_u32(bc, len)) {
+		return false;
+	}
+	if ((size_t)(bc->end - bc->pos) < *len) {
+		return false;
+	}
+	*s = (const char *)bc->pos;
+	bc->pos += *len;
+	return true;
 }
 
+/**
+ * Populate the database from binary format file data.
+ *
+ * \param buf The file data.
+ * \param buflen The length of the file data.
+ * \return NSERROR_OK on success or error code on failure.
+ */
+static nserror urldb_parse_binary(const uint8_t *buf, size_t buflen)
+{
+	struct urldb_bin_cursor bc;
+	uint32_t version;
+	char host[256];
+	char scheme[64];
+	char url[64 + 3 + 256 + 6 + 4096 + 1 + 1];
+	struct host_part *h;
+
+	bc.pos = buf;
+	bc.end = buf + buflen;
+
+	if ((size_t)(bc.end - bc.pos) < 4) {
+		return NSERROR_INVALID;
+	}
+	if (memcmp(bc.pos, URL_FILE_MAGIC, 4) != 0) {
+		return NSERROR_INVALID;
+	}
+	bc.pos += 4;
+
+	if (!urldb_read_bin_u32(&bc, &version)) {
+		return NSERROR_INVALID;
+	}
+	if (version != URL_BINARY_FILE_VERSION) {
+		NSLOG(netsurf, INFO, "Unknown URL file version.");
+		return NSERROR_INVALID;
+	}
+
+	while (bc.pos < bc.end) {
+		const char *str;
+		uint32_t len;
+		uint16_t hsts_include_sub_domains;
+		time_t hsts_expiry;
+		uint32_t urls;
+		uint32_t i;
+
+		/* host record */
+		if (!urldb_read_bin_str(&bc, &str, &len) ||
+		    (len >= sizeof(host))) {
+			return NSERROR_INVALID;
+		}
+		memcpy(host, str, len);
+		host[len] = '\0';
+
+		if (!urldb_read_bin_u16(&bc, &hsts_include_sub_domains) ||
+		    !urldb_read_bin_time(&bc, &hsts_expiry) ||
+		    !urldb_read_bin_u32(&bc, &urls)) {
+			return NSERROR_INVALID;
+		}
+
+		h = urldb_add_host(host);
+		if (!h) {
+			NSLOG(netsurf, INFO, "Failed adding host: '%s'", host);
+			return NSERROR_NOMEM;
+		}
+		h->hsts.expires = hsts_expiry;
+		h->hsts.include_sub_domains = (hsts_include_sub_domains != 0);
+
+		for (i = 0; i < urls; i++) {
+			struct path_data *p;
+			uint16_t port;
+			uint32_t visits;
+			time_t last_visit;
+			uint32_t type;
+			bool is_file = false;
+			nsurl *nsurl;
+			lwc_string *scheme_lwc, *fragment_lwc;
+			char *path_query;
+			size_t pqlen;
+
+			/* scheme */
+			if (!urldb_read_bin_str(&bc, &str, &len) ||
+			    (len >= sizeof(scheme))) {
+				return NSERROR_INVALID;
+			}
+			memcpy(scheme, str, len);
+			scheme[len] = '\0';
+
+			if (!urldb_read_bin_u16(&bc, &port)) {
+				return NSERROR_INVALID;
+			}
+
+			/* path and query */
+			if (!urldb_read_bin_str(&bc, &str, &len) ||
+			    (len > 4096)) {
+				return NSERROR_INVALID;
+			}
+
+			if (!strcasecmp(host, "localhost") &&
+			    !strcasecmp(scheme, "file"))
+				is_file = true;
+
+			if (port != 0) {
+				snprintf(url, sizeof url, "%s://%s:%u%.*s",
+					 scheme,
+					 (is_file ? "" : host),
+					 port,
+					 (int)len, str);
+			} else {
+				snprintf(url, sizeof url, "%s://%s%.*s",
+					 scheme,
+					 (is_file ? "" : host),
+					 (int)len, str);
+			}
+
+			if (nsurl_create(url, &nsurl) != NSERROR_OK) {
+				NSLOG(netsurf, INFO, "Failed inserting '%s'",
+				      url);
+				return NSERROR_NOMEM;
+			}
+
+			if (url_bloom != NULL) {
+				bloom_insert_hash(url_bloom,
+						  nsurl_hash(nsurl));
+			}
+
+			/* Copy and merge path/query strings */
+			if (nsurl_get(nsurl, NSURL_PATH | NSURL_QUERY,
+				      &path_query, &pqlen) != NSERROR_OK) {
+				NSLOG(netsurf, INFO, "Failed inserting '%s'",
+				      url);
+				nsurl_unref(nsurl);
+				return NSERROR_NOMEM;
+			}
+
+			scheme_lwc = nsurl_get_component(nsurl, NSURL_SCHEME);
+			fragment_lwc = nsurl_get_component(nsurl,
+							   NSURL_FRAGMENT);
+			p = urldb_add_path(scheme_lwc, port, h, path_query,
+					   fragment_lwc, nsurl);
+			if (!p) {
+				NSLOG(netsurf, INFO, "Failed inserting '%s'",
+				      url);
+				nsurl_unref(nsurl);
+				lwc_string_unref(scheme_lwc);
+				if (fragment_lwc != NULL)
+					lwc_string_unref(fragment_lwc);
+				return NSERROR_NOMEM;
+			}
+			nsurl_unref(nsurl);
+			lwc_string_unref(scheme_lwc);
+			if (fragment_lwc != NULL)
+				lwc_string_unref(fragment_lwc);
+
+			if (!urldb_read_bin_u32(&bc, &visits) ||
+			    !urldb_read_bin_time(&bc, &last_visit) ||
+			    !urldb_read_bin_u32(&bc, &type)) {
+				return NSERROR_INVALID;
+			}
+			p->urld.visits = visits;
+			p->urld.last_visit = last_visit;
+			p->urld.type = (content_type)type;
+
+			/* title */
+			if (!urldb_read_bin_str(&bc, &str, &len)) {
+				return NSERROR_INVALID;
+			}
+			if (len > 0) {
+				p->urld.title = malloc(len + 1);
+				if (p->urld.title) {
+					memcpy(p->urld.title, str, len);
+					p->urld.title[len] = '\0';
+				}
+			}
+		}
+	}
+
+	return NSERROR_OK;
+}
+
+/**
+ * Load the database from a binary format file.
+ *
+ * The file is mapped where supported so the source data is paged in
+ * on demand rather than buffered.
+ *
+ * \param filename Name of file containing data.
+ * \return NSERROR_OK on success or error code on failure.
+ */
+static nserror urldb_load_binary(const char *filename)
+{
+	uint8_t *buf;
+	size_t buflen;
+	struct stat st;
+	nserror ret;
+	int fd;
+
+	fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		return NSERROR_NOT_FOUND;
+	}
+
+	if ((fstat(fd, &st) < 0) || (st.st_size < 8)) {
+		close(fd);
+		return NSERROR_INVALID;
+	}
+	buflen = st.st_size;
+
+#ifdef HAVE_MMAP
+	buf = mmap(NULL, buflen, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (buf == MAP_FAILED) {
+		return NSERROR_NOMEM;
+	}
+
+	ret = urldb_parse_binary(buf, buflen);
+
+	munmap(buf, buflen);
+#else
+	{
+		size_t tot = 0;
+		ssize_t rd;
+
+		buf = malloc(buflen);
+		if (buf == NULL) {
+			close(fd);
+			return NSERROR_NOMEM;
+		}
+
+		while (tot < buflen) {
+			rd = read(fd, buf + tot, buflen - tot);
+			if (rd <= 0) {
+				break;
+			}
+			tot += rd;
+		}
+		close(fd);
+
+		if (tot != buflen) {
+			free(buf);
+			return NSERROR_INVALID;
+		}
+
+		ret = urldb_parse_binary(buf, buflen);
+
+		free(buf);
+	}
+#endif
+
+	return ret;
+}
 
 /* exported interface documented in netsurf/url_db.h */
 nserror urldb_load(const char *filename)
@@ -2890,15 +3777,25 @@ nserror urldb_load(const char *filename)
 	NSLOG(netsurf, INFO, "Loading URL file %s", filename);
 
 	if (url_bloom == NULL)
-		url_bloom = bloom_create(BLOOM_SIZE);
+		url_bloom = bloom_create_counting(BLOOM_SIZE * 4);
 
-	fp = fopen(filename, "r");
+	fp = fopen(filename, "rb");
 	if (!fp) {
 		NSLOG(netsurf, INFO, "Failed to open file '%s' for reading",
 		      filename);
 		return NSERROR_NOT_FOUND;
 	}
 
+	/* binary format files are identified by a leading magic;
+	 * anything else is parsed as the text format for import.
+	 */
+	if ((fread(s, 1, 4, fp) == 4) &&
+	    (memcmp(s, URL_FILE_MAGIC, 4) == 0)) {
+		fclose(fp);
+		return urldb_load_binary(filename);
+	}
+	rewind(fp);
+
 	if (!fgets(s, MAXIMUM_URL_LENGTH, fp)) {
 		fclose(fp);
 		return NSERROR_NEED_DATA;
@@ -3098,6 +3995,35 @@ nserror urldb_save(const char *filename)
 
 	assert(filename);
 
+	fp = fopen(filename, "wb");
+	if (!fp) {
+		NSLOG(netsurf, INFO, "Failed to open file '%s' for writing",
+		      filename);
+		return NSERROR_SAVE_FAILED;
+	}
+
+	/* file magic and format version number */
+	fwrite(URL_FILE_MAGIC, 4, 1, fp);
+	urldb_write_bin_u32(fp, URL_BINARY_FILE_VERSION);
+
+	for (i = 0; i != NUM_SEARCH_TREES; i++) {
+		urldb_save_search_tree(search_trees[i], fp, true);
+	}
+
+	fclose(fp);
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in netsurf/url_db.h */
+nserror urldb_save_text(const char *filename)
+{
+	FILE *fp;
+	int i;
+
+	assert(filename);
+
 	fp = fopen(filename, "w");
 	if (!fp) {
 		NSLOG(netsurf, INFO, "Failed to open file '%s' for writing",
@@ -3109,7 +4035,7 @@ nserror urldb_save(const char *filename)
 	fprintf(fp, "%d\n", URL_FILE_VERSION);
 
 	for (i = 0; i != NUM_SEARCH_TREES; i++) {
-		urldb_save_search_tree(search_trees[i], fp);
+		urldb_save_search_tree(search_trees[i], fp, false);
 	}
 
 	fclose(fp);
@@ -3154,7 +4080,7 @@ bool urldb_add_url(nsurl *url)
 	assert(url);
 
 	if (url_bloom == NULL)
-		url_bloom = bloom_create(BLOOM_SIZE);
+		url_bloom = bloom_create_counting(BLOOM_SIZE * 4);
 
 	if (url_bloom != NULL) {
 		uint32_t hash = nsurl_hash(url);
@@ -3451,11 +4377,117 @@ const char *urldb_get_auth_details(nsurl *url, const char *realm)
 }
 
 
+/**
+ * Cached TLS decisions for a host.
+ *
+ * TLS setup consults the certificate exception flag and HSTS policy
+ * on every HTTPS fetch, so the outcome of the host tree searches is
+ * kept in a flat cache keyed by host name. The host tree remains the
+ * authoritative store.
+ */
+struct tls_cache_entry {
+	bool permit_invalid_certs; /**< Invalid certificates permitted */
+	bool hsts_cached; /**< Whether the HSTS decision below is valid */
+	bool hsts_enabled; /**< Cached HSTS decision */
+	time_t hsts_until; /**< Expiry of the decision, 0 for none */
+};
+
+static void *tls_cache_key_clone(void *key)
+{
+	return lwc_string_ref((lwc_string *)key);
+}
+
+static void tls_cache_key_destroy(void *key)
+{
+	lwc_string_unref((lwc_string *)key);
+}
+
+static uint32_t tls_cache_key_hash(void *key)
+{
+	return lwc_string_hash_value((lwc_string *)key);
+}
+
+static bool tls_cache_key_eq(void *key1, void *key2)
+{
+	bool match;
+
+	return (lwc_string_isequal((lwc_string *)key1,
+				   (lwc_string *)key2,
+				   &match) == lwc_error_ok) && match;
+}
+
+static void *tls_cache_value_alloc(void *key)
+{
+	return calloc(1, sizeof(struct tls_cache_entry));
+}
+
+static void tls_cache_value_destroy(void *value)
+{
+	free(value);
+}
+
+static hashmap_parameters_t tls_cache_parameters = {
+	.key_clone = tls_cache_key_clone,
+	.key_destroy = tls_cache_key_destroy,
+	.key_hash = tls_cache_key_hash,
+	.key_eq = tls_cache_key_eq,
+	.value_alloc = tls_cache_value_alloc,
+	.value_destroy = tls_cache_value_destroy,
+};
+
+/**
+ * Get the TLS decision cache entry for a URL's host
+ *
+ * \param url URL to look up
+ * \param create Whether to create a missing entry
+ * \return Cache entry, or NULL if absent or on allocation failure
+ */
+static struct tls_cache_entry *
+urldb_get_tls_cache_entry(nsurl *url, bool create)
+{
+	lwc_string *host;
+	struct tls_cache_entry *e;
+
+	host = nsurl_get_component(url, NSURL_HOST);
+	if (host == NULL)
+		return NULL;
+
+	if (tls_cache == NULL) {
+		tls_cache = hashmap_create(&tls_cache_parameters);
+		if (tls_cache == NULL) {
+			lwc_string_unref(host);
+			return NULL;
+		}
+	}
+
+	e = hashmap_lookup(tls_cache, host);
+	if (e == NULL && create)
+		e = hashmap_insert(tls_cache, host);
+
+	lwc_string_unref(host);
+
+	return e;
+}
+
+/**
+ * Iteration callback clearing a cached HSTS decision
+ */
+static bool tls_cache_clear_hsts_cb(void *key, void *value, void *ctx)
+{
+	struct tls_cache_entry *e = value;
+
+	e->hsts_cached = false;
+
+	return false;
+}
+
+
 /* exported interface documented in netsurf/url_db.h */
 void urldb_set_cert_permissions(nsurl *url, bool permit)
 {
 	struct path_data *p;
 	struct host_part *h;
+	struct tls_cache_entry *e;
 
 	assert(url);
 
@@ -3473,6 +4505,10 @@ void urldb_set_cert_permissions(nsurl *url, bool permit)
 	h = (struct host_part *)p;
 
 	h->permit_invalid_certs = permit;
+
+	e = urldb_get_tls_cache_entry(url, true);
+	if (e != NULL)
+		e->permit_invalid_certs = permit;
 }
 
 
@@ -3481,9 +4517,14 @@ bool urldb_get_cert_permissions(nsurl *url)
 {
 	struct path_data *p;
 	const struct host_part *h;
+	struct tls_cache_entry *e;
 
 	assert(url);
 
+	e = urldb_get_tls_cache_entry(url, false);
+	if (e != NULL)
+		return e->permit_invalid_certs;
+
 	p = urldb_find_url(url);
 	if (!p)
 		return false;
@@ -3494,6 +4535,10 @@ bool urldb_get_cert_permissions(nsurl *url)
 
 	h = (const struct host_part *)p;
 
+	e = urldb_get_tls_cache_entry(url, true);
+	if (e != NULL)
+		e->permit_invalid_certs = h->permit_invalid_certs;
+
 	return h->permit_invalid_certs;
 }
 
@@ -3508,6 +4553,8 @@ bool urldb_set_hsts_policy(struct nsurl *url, const char *header)
 	http_strict_transport_security *sts;
 	uint32_t max_age = 0;
 	nserror error;
+	bool was_enabled;
+	bool had_sub_domains;
 
 	assert(url);
 
@@ -3552,6 +4599,9 @@ bool urldb_set_hsts_policy(struct nsurl *url, const char *header)
 		return true;
 	}
 
+	was_enabled = (h->hsts.expires > now);
+	had_sub_domains = h->hsts.include_sub_domains;
+
 	h->hsts.include_sub_domains =
 		http_strict_transport_security_include_subdomains(sts);
 
@@ -3565,6 +4615,19 @@ bool urldb_set_hsts_policy(struct nsurl *url, const char *header)
 
 	http_strict_transport_security_destroy(sts);
 
+	if (((h->hsts.expires > now) != was_enabled) ||
+	    (h->hsts.include_sub_domains != had_sub_domains)) {
+		/* The policy outcome changed; cached decisions for
+		 * this host and any of its subdomains may now be
+		 * wrong. Refreshing an existing policy leaves cached
+		 * decisions correct, so this is rare. */
+		if (tls_cache != NULL) {
+			hashmap_iterate(tls_cache,
+					tls_cache_clear_hsts_cb,
+					NULL);
+		}
+	}
+
 	return true;
 }
 
@@ -3576,6 +4639,9 @@ bool urldb_get_hsts_enabled(struct nsurl *url)
 	const struct host_part *h;
 	lwc_string *host;
 	time_t now = time(NULL);
+	struct tls_cache_entry *e;
+	bool enabled = false;
+	time_t until = 0;
 
 	assert(url);
 
@@ -3597,6 +4663,12 @@ bool urldb_get_hsts_enabled(struct nsurl *url)
 		return false;
 	}
 
+	e = urldb_get_tls_cache_entry(url, false);
+	if ((e != NULL) && (e->hsts_cached) &&
+	    ((e->hsts_until == 0) || (e->hsts_until > now))) {
+		return e->hsts_enabled;
+	}
+
 	/* The URL must exist in the db in order to find HSTS policy, since
 	 * we search up the tree from the URL node, and policy from further
 	 * up may also apply. */
@@ -3615,18 +4687,31 @@ bool urldb_get_hsts_enabled(struct nsurl *url)
 	/* Consult record for this host */
 	if (h->hsts.expires > now) {
 		/* Not expired */
-		return true;
+		enabled = true;
+		until = h->hsts.expires;
+	} else {
+		/* Consult parent domains */
+		for (h = h->parent; h && h != &db_root; h = h->parent) {
+			if (h->hsts.expires > now &&
+			    h->hsts.include_sub_domains) {
+				/* Not expired and subdomains included */
+				enabled = true;
+				until = h->hsts.expires;
+				break;
+			}
+		}
 	}
 
-	/* Consult parent domains */
-	for (h = h->parent; h && h != &db_root; h = h->parent) {
-		if (h->hsts.expires > now && h->hsts.include_sub_domains) {
-			/* Not expired and subdomains included */
-			return true;
-		}
+	/* An enabled decision holds until the matched record expires;
+	 * a disabled one holds until a policy change clears it */
+	e = urldb_get_tls_cache_entry(url, true);
+	if (e != NULL) {
+		e->hsts_cached = true;
+		e->hsts_enabled = enabled;
+		e->hsts_until = until;
 	}
 
-	return false;
+	return enabled;
 }
 
 
@@ -3648,6 +4733,52 @@ urldb_iterate_partial(const char *prefix,
 	if (scheme_sep)
 		prefix = scheme_sep + 3;
 
+	if (!completion_index_broken) {
+		const struct path_data **matches = NULL;
+		size_t match_count = 0, match_alloc = 0;
+		size_t i;
+		int len = strlen(prefix);
+		bool ok;
+
+		if (completion_index_dirty) {
+			qsort(completion_index, completion_index_count,
+					sizeof(*completion_index),
+					urldb_completion_entry_cmp);
+			completion_index_dirty = false;
+		}
+
+		ok = urldb_completion_collect(prefix, &matches,
+				&match_count, &match_alloc);
+
+		if (ok && (len <= 3 ||
+				strncasecmp(prefix, "www.", 4) != 0)) {
+			/* as with the tree walk, also offer www. hosts */
+			snprintf(buf, sizeof(buf), "www.%s", prefix);
+			ok = urldb_completion_collect(buf, &matches,
+					&match_count, &match_alloc);
+		}
+
+		if (ok) {
+			qsort(matches, match_count, sizeof(*matches),
+					urldb_completion_rank_cmp);
+
+			for (i = 0; i < match_count; i++) {
+				const struct path_data *p = matches[i];
+
+				if (!callback(p->url,
+						(const struct url_data *)
+							&p->urld))
+					break;
+			}
+
+			free(matches);
+			return;
+		}
+
+		free(matches);
+		/* collection failed; fall back to the tree walk */
+	}
+
 	slash = strchr(prefix, '/');
 	tree = urldb_get_search_tree(prefix);
 
@@ -4022,6 +5153,19 @@ char *urldb_get_cookie(nsurl *url, bool include_http_only)
 	if (!p)
 		return NULL;
 
+	/* Check whether this host, or any ancestor domain that could
+	 * hold a domain cookie for it, has any cookies at all before
+	 * allocating buffers and searching the path tree: most hosts
+	 * have none. */
+	for (h = urldb_get_path_host((struct path_data *) p);
+	     h != NULL && h != &db_root;
+	     h = h->parent) {
+		if (h->cookie_count > 0)
+			break;
+	}
+	if (h == NULL || h == &db_root)
+		return NULL;
+
 	scheme = p->scheme;
 
 	matched_cookies = malloc(matched_cookies_size *
@@ -4277,17 +5421,32 @@ void urldb_delete_cookie(const char *domain, const char *path,
 }
 
 
-/* exported interface documented in content/urldb.h */
-void urldb_load_cookies(const char *filename)
+/**
+ * Construct the name of the journal accompanying a cookie file
+ *
+ * \param filename Cookie file name
+ * \return Journal file name, or NULL on memory exhaustion
+ */
+static char *urldb_cookie_journal_name(const char *filename)
 {
-	FILE *fp;
-	char s[16*1024];
+	char *jname;
 
-	assert(filename);
+	jname = malloc(strlen(filename) + SLEN(".jnl") + 1);
+	if (jname != NULL)
+		sprintf(jname, "%s.jnl", filename);
 
-	fp = fopen(filename, "r");
-	if (!fp)
-		return;
+	return jname;
+}
+
+
+/**
+ * Load cookies from an open cookie or journal file
+ *
+ * \param fp File pointer to read from
+ */
+static void urldb_load_cookie_file(FILE *fp)
+{
+	char s[16*1024];
 
 #define FIND_T {				\
 		for (; *p && *p != '\t'; p++)	\
@@ -4439,8 +5598,48 @@ void urldb_load_cookies(const char *filename)
 
 #undef SKIP_T
 #undef FIND_T
+}
 
-	fclose(fp);
+
+/* exported interface documented in content/urldb.h */
+void urldb_load_cookies(const char *filename)
+{
+	FILE *fp;
+	char *jname;
+
+	assert(filename);
+
+	fp = fopen(filename, "r");
+	if (fp != NULL) {
+		urldb_load_cookie_file(fp);
+		fclose(fp);
+	}
+
+	jname = urldb_cookie_journal_name(filename);
+	if (jname == NULL)
+		return;
+
+	/* Replay any changes journalled since the last full save */
+	fp = fopen(jname, "r");
+	if (fp != NULL) {
+		urldb_load_cookie_file(fp);
+		fclose(fp);
+	}
+
+	/* Keep the journal open for append so subsequent cookie
+	 * changes are recorded as they are made */
+	cookie_journal = fopen(jname, "a");
+	if (cookie_journal != NULL) {
+		fseek(cookie_journal, 0, SEEK_END);
+		if (ftell(cookie_journal) == 0) {
+			fprintf(cookie_journal, "Version:\t%d\n",
+				max(loaded_cookie_file_version,
+				    COOKIE_FILE_VERSION));
+			fflush(cookie_journal);
+		}
+	}
+
+	free(jname);
 }
 
 
@@ -4448,6 +5647,7 @@ void urldb_load_cookies(const char *filename)
 void urldb_save_cookies(const char *filename)
 {
 	FILE *fp;
+	char *jname;
 	int cookie_file_version = max(loaded_cookie_file_version,
 				      COOKIE_FILE_VERSION);
 
@@ -4474,6 +5674,22 @@ void urldb_save_cookies(const char *filename)
 	urldb_save_cookie_hosts(fp, &db_root);
 
 	fclose(fp);
+
+	/* The full save supersedes any journalled changes */
+	if (cookie_journal != NULL) {
+		fclose(cookie_journal);
+		cookie_journal = NULL;
+	}
+	jname = urldb_cookie_journal_name(filename);
+	if (jname != NULL) {
+		cookie_journal = fopen(jname, "w");
+		if (cookie_journal != NULL) {
+			fprintf(cookie_journal, "Version:\t%d\n",
+				cookie_file_version);
+			fflush(cookie_journal);
+		}
+		free(jname);
+	}
 }
 
 
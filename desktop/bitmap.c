@@ -133,9 +133,28 @@ void bitmap_set_format(const bitmap_fmt_t *bitmap_format)
 	bitmap_layout = bitmap__get_colour_layout(&bitmap_fmt);
 }
 
+/**
+ * Get the pixel value bit shift for a byte offset within a pixel.
+ *
+ * \param[in] offset  Byte offset within pixel to a colour component.
+ * \return Shift to move that component to the low byte of a pixel value.
+ */
+static inline unsigned int bitmap__layout_shift(uint8_t offset)
+{
+	if (endian_host_is_le()) {
+		return offset * 8;
+	}
+
+	return (3 - offset) * 8;
+}
+
 /**
  * Swap colour component order.
  *
+ * The conversion is expressed as whole-pixel shifts and masks, rather
+ * than per-component byte accesses, so compilers can keep pixels in
+ * registers and vectorise the inner loop.
+ *
  * \param[in] width      Bitmap width in pixels.
  * \param[in] height     Bitmap height in pixels.
  * \param[in] buffer     Pixel buffer.
@@ -151,19 +170,26 @@ static inline void bitmap__format_convert(
 		struct bitmap_colour_layout to,
 		struct bitmap_colour_layout from)
 {
+	const unsigned int from_r = bitmap__layout_shift(from.r);
+	const unsigned int from_g = bitmap__layout_shift(from.g);
+	const unsigned int from_b = bitmap__layout_shift(from.b);
+	const unsigned int from_a = bitmap__layout_shift(from.a);
+	const unsigned int to_r = bitmap__layout_shift(to.r);
+	const unsigned int to_g = bitmap__layout_shift(to.g);
+	const unsigned int to_b = bitmap__layout_shift(to.b);
+	const unsigned int to_a = bitmap__layout_shift(to.a);
+
 	/* Just swapping the components around */
 	for (int y = 0; y < height; y++) {
-		uint8_t *row = buffer;
+		uint32_t *row = (uint32_t *)(void *) buffer;
 
 		for (int x = 0; x < width; x++) {
-			const uint32_t px = *((uint32_t *)(void *) row);
+			const uint32_t px = row[x];
 
-			row[to.r] = ((const uint8_t *) &px)[from.r];
-			row[to.g] = ((const uint8_t *) &px)[from.g];
-			row[to.b] = ((const uint8_t *) &px)[from.b];
-			row[to.a] = ((const uint8_t *) &px)[from.a];
-
-			row += sizeof(uint32_t);
+			row[x] = (((px >> from_r) & 0xff) << to_r) |
+			         (((px >> from_g) & 0xff) << to_g) |
+			         (((px >> from_b) & 0xff) << to_b) |
+			         (((px >> from_a) & 0xff) << to_a);
 		}
 
 		buffer += rowstride;
@@ -173,6 +199,10 @@ static inline void bitmap__format_convert(
 /**
  * Convert plain alpha to premultiplied alpha.
  *
+ * The inner loop is branchless: for zero alpha the multiply by
+ * (a + 1) == 1 and shift already yield zero components, so no special
+ * case is needed and compilers can vectorise the loop.
+ *
  * \param[in] width      Bitmap width in pixels.
  * \param[in] height     Bitmap height in pixels.
  * \param[in] buffer     Pixel buffer.
@@ -188,32 +218,35 @@ static inline void bitmap__format_convert_to_pma(
 		struct bitmap_colour_layout to,
 		struct bitmap_colour_layout from)
 {
+	const unsigned int from_r = bitmap__layout_shift(from.r);
+	const unsigned int from_g = bitmap__layout_shift(from.g);
+	const unsigned int from_b = bitmap__layout_shift(from.b);
+	const unsigned int from_a = bitmap__layout_shift(from.a);
+	const unsigned int to_r = bitmap__layout_shift(to.r);
+	const unsigned int to_g = bitmap__layout_shift(to.g);
+	const unsigned int to_b = bitmap__layout_shift(to.b);
+	const unsigned int to_a = bitmap__layout_shift(to.a);
+
 	for (int y = 0; y < height; y++) {
-		uint8_t *row = buffer;
+		uint32_t *row = (uint32_t *)(void *) buffer;
 
 		for (int x = 0; x < width; x++) {
-			const uint32_t px = *((uint32_t *)(void *) row);
+			const uint32_t px = row[x];
 			uint32_t a, r, g, b;
 
-			r = ((const uint8_t *) &px)[from.r];
-			g = ((const uint8_t *) &px)[from.g];
-			b = ((const uint8_t *) &px)[from.b];
-			a = ((const uint8_t *) &px)[from.a];
-
-			if (a != 0) {
-				r = ((r * (a + 1)) >> 8) & 0xff;
-				g = ((g * (a + 1)) >> 8) & 0xff;
-				b = ((b * (a + 1)) >> 8) & 0xff;
-			} else {
-				r = g = b = 0;
-			}
-
-			row[to.r] = r;
-			row[to.g] = g;
-			row[to.b] = b;
-			row[to.a] = a;
-
-			row += sizeof(uint32_t);
+			r = (px >> from_r) & 0xff;
+			g = (px >> from_g) & 0xff;
+			b = (px >> from_b) & 0xff;
+			a = (px >> from_a) & 0xff;
+
+			r = ((r * (a + 1)) >> 8) & 0xff;
+			g = ((g * (a + 1)) >> 8) & 0xff;
+			b = ((b * (a + 1)) >> 8) & 0xff;
+
+			row[x] = (r << to_r) |
+			         (g << to_g) |
+			         (b << to_b) |
+			         (a << to_a);
 		}
 
 		buffer += rowstride;
@@ -223,6 +256,11 @@ static inline void bitmap__format_convert_to_pma(
 /**
  * Convert from premultiplied alpha to plain alpha.
  *
+ * The per-pixel divisions by alpha are replaced with multiplies by a
+ * fixed point reciprocal from a 256-entry table, computed on first
+ * use. The zero alpha entry is zero, so fully transparent pixels come
+ * out black without a special case in the loop.
+ *
  * \param[in] width      Bitmap width in pixels.
  * \param[in] height     Bitmap height in pixels.
  * \param[in] buffer     Pixel buffer.
@@ -238,36 +276,46 @@ static inline void bitmap__format_convert_from_pma(
 		struct bitmap_colour_layout to,
 		struct bitmap_colour_layout from)
 {
+	static uint32_t recip[256];
+	const unsigned int from_r = bitmap__layout_shift(from.r);
+	const unsigned int from_g = bitmap__layout_shift(from.g);
+	const unsigned int from_b = bitmap__layout_shift(from.b);
+	const unsigned int from_a = bitmap__layout_shift(from.a);
+	const unsigned int to_r = bitmap__layout_shift(to.r);
+	const unsigned int to_g = bitmap__layout_shift(to.g);
+	const unsigned int to_b = bitmap__layout_shift(to.b);
+	const unsigned int to_a = bitmap__layout_shift(to.a);
+
+	if (recip[255] == 0) {
+		for (uint32_t i = 1; i < 256; i++) {
+			recip[i] = ((256u << 16) + i - 1) / i;
+		}
+	}
+
 	for (int y = 0; y < height; y++) {
-		uint8_t *row = buffer;
+		uint32_t *row = (uint32_t *)(void *) buffer;
 
 		for (int x = 0; x < width; x++) {
-			const uint32_t px = *((uint32_t *)(void *) row);
+			const uint32_t px = row[x];
 			uint32_t a, r, g, b;
 
-			r = ((const uint8_t *) &px)[from.r];
-			g = ((const uint8_t *) &px)[from.g];
-			b = ((const uint8_t *) &px)[from.b];
-			a = ((const uint8_t *) &px)[from.a];
-
-			if (a != 0) {
-				r = (r << 8) / a;
-				g = (g << 8) / a;
-				b = (b << 8) / a;
-
-				r = (r > 255) ? 255 : r;
-				g = (g > 255) ? 255 : g;
-				b = (b > 255) ? 255 : b;
-			} else {
-				r = g = b = 0;
-			}
-
-			row[to.r] = r;
-			row[to.g] = g;
-			row[to.b] = b;
-			row[to.a] = a;
-
-			row += sizeof(uint32_t);
+			r = (px >> from_r) & 0xff;
+			g = (px >> from_g) & 0xff;
+			b = (px >> from_b) & 0xff;
+			a = (px >> from_a) & 0xff;
+
+			r = (r * recip[a]) >> 16;
+			g = (g * recip[a]) >> 16;
+			b = (b * recip[a]) >> 16;
+
+			r = (r > 255) ? 255 : r;
+			g = (g > 255) ? 255 : g;
+			b = (b > 255) ? 255 : b;
+
+			row[x] = (r << to_r) |
+			         (g << to_g) |
+			         (b << to_b) |
+			         (a << to_a);
 		}
 
 		buffer += rowstride;
@@ -319,16 +367,22 @@ bool bitmap_test_opaque(void *bitmap)
 	int height = guit->bitmap->get_height(bitmap);
 	size_t rowstride = guit->bitmap->get_rowstride(bitmap);
 	const uint8_t *buffer = guit->bitmap->get_buffer(bitmap);
+	const uint32_t amask =
+			0xffu << bitmap__layout_shift(bitmap_layout.a);
 
-	width *= sizeof(uint32_t);
-
+	/* Accumulating the alpha bytes with a branchless whole-pixel
+	 * AND lets compilers keep the inner loop in vector registers;
+	 * a row with any translucency is caught when it completes. */
 	for (int y = 0; y < height; y++) {
-		const uint8_t *row = buffer;
+		const uint32_t *row = (const uint32_t *)(const void *) buffer;
+		uint32_t acc = amask;
+
+		for (int x = 0; x < width; x++) {
+			acc &= row[x];
+		}
 
-		for (int x = bitmap_layout.a; x < width; x += 4) {
-			if (row[x] != 0xff) {
-				return false;
-			}
+		if ((acc & amask) != amask) {
+			return false;
 		}
 
 		buffer += rowstride;
@@ -29,11 +29,14 @@
 #include <time.h>
 
 #include "utils/log.h"
+#include "utils/nsoption.h"
 #include "utils/utils.h"
 #include "netsurf/layout.h"
 #include "netsurf/content.h"
+#include "netsurf/misc.h"
 #include "netsurf/window.h"
 #include "netsurf/browser_window.h"
+#include "content/content.h"
 #include "content/hlcache.h"
 #include "content/urldb.h"
 #include "netsurf/bitmap.h"
@@ -44,6 +47,33 @@
 #include "desktop/local_history_private.h"
 #include "desktop/browser_history.h"
 
+/** Delay before a pending thumbnail render is performed (ms) */
+#define THUMBNAIL_RENDER_DELAY 500
+
+/**
+ * Render the thumbnail for the current history entry.
+ *
+ * Scheduled from browser_window_history_update() so a burst of
+ * updates to the same entry, as caused by scrolling or incremental
+ * reflows during a fetch, only renders its thumbnail once.
+ *
+ * \param p The browser window owning the history.
+ */
+static void browser_window_history__render_thumbnail(void *p)
+{
+	struct browser_window *bw = p;
+
+	if ((bw->history == NULL) ||
+	    (bw->history->current == NULL) ||
+	    (bw->history->current->page.bitmap == NULL) ||
+	    (bw->current_content == NULL)) {
+		return;
+	}
+
+	guit->bitmap->render(bw->history->current->page.bitmap,
+			     bw->current_content);
+}
+
 /**
  * Clone a history entry
  *
@@ -184,6 +214,242 @@ static void browser_window_history__free_entry(struct history_entry *entry)
 }
 
 
+/**
+ * Recursively scan a subtree for retention limit candidates.
+ *
+ * Counts entries and thumbnails and tracks the least recently
+ * visited prunable leaf and thumbnail holder; the current entry is
+ * never a candidate.
+ *
+ * \param history history being scanned
+ * \param entry subtree to scan
+ * \param prune updated to the best entry to prune, if any
+ * \param drop updated to the best entry to drop a thumbnail from
+ * \param bitmaps incremented for each thumbnail found
+ * \return number of entries in the subtree
+ */
+static unsigned int
+browser_window_history__scan_subtree(struct history *history,
+				     struct history_entry *entry,
+				     struct history_entry **prune,
+				     struct history_entry **drop,
+				     unsigned int *bitmaps)
+{
+	struct history_entry *child;
+	unsigned int count = 1;
+
+	if ((entry->forward == NULL) &&
+	    (entry != history->current) &&
+	    ((*prune == NULL) ||
+	     (entry->last_visited < (*prune)->last_visited))) {
+		*prune = entry;
+	}
+
+	if (entry->page.bitmap != NULL) {
+		(*bitmaps)++;
+		if ((entry != history->current) &&
+		    ((*drop == NULL) ||
+		     (entry->last_visited < (*drop)->last_visited))) {
+			*drop = entry;
+		}
+	}
+
+	for (child = entry->forward; child != NULL; child = child->next) {
+		count += browser_window_history__scan_subtree(history,
+				child, prune, drop, bitmaps);
+	}
+
+	return count;
+}
+
+
+/**
+ * Remove a leaf entry from the tree and free it.
+ *
+ * \param history history the entry belongs to
+ * \param entry leaf entry to remove
+ */
+static void
+browser_window_history__remove_entry(struct history *history,
+				     struct history_entry *entry)
+{
+	struct history_entry *parent = entry->back;
+	struct history_entry *child;
+	struct history_entry *prev = NULL;
+	unsigned int i;
+
+	assert(entry->forward == NULL);
+	assert(parent != NULL);
+
+	/* drop any frozen page belonging to the pruned entry */
+	for (i = 0; i < BROWSER_HISTORY_MAX_FROZEN; i++) {
+		if (history->frozen[i].entry == entry) {
+			hlcache_handle_release(history->frozen[i].content);
+			history->frozen[i].entry = NULL;
+			history->frozen[i].content = NULL;
+		}
+	}
+
+	for (child = parent->forward; child != entry; child = child->next) {
+		prev = child;
+	}
+
+	if (prev == NULL) {
+		parent->forward = entry->next;
+	} else {
+		prev->next = entry->next;
+	}
+
+	if (parent->forward_last == entry) {
+		parent->forward_last = prev;
+	}
+	if (parent->forward_pref == entry) {
+		parent->forward_pref = parent->forward;
+	}
+
+	parent->children--;
+
+	entry->next = NULL;
+	browser_window_history__free_entry(entry);
+}
+
+
+/**
+ * Apply the configured retention limits to a history tree.
+ *
+ * Entries beyond history_max_entries are pruned and thumbnails
+ * beyond history_max_thumbnails are dropped, least recently visited
+ * first in both cases. A dropped thumbnail is recreated if its entry
+ * is visited again.
+ *
+ * \param history history to apply limits to
+ */
+static void
+browser_window_history__apply_retention(struct history *history)
+{
+	int max_entries = nsoption_int(history_max_entries);
+	int max_thumbnails = nsoption_int(history_max_thumbnails);
+
+	if ((history->start == NULL) ||
+	    ((max_entries <= 0) && (max_thumbnails <= 0))) {
+		return;
+	}
+
+	while (true) {
+		struct history_entry *prune = NULL;
+		struct history_entry *drop = NULL;
+		unsigned int bitmaps = 0;
+		unsigned int count;
+
+		count = browser_window_history__scan_subtree(history,
+				history->start, &prune, &drop, &bitmaps);
+
+		if ((max_entries > 0) &&
+		    (count > (unsigned int)max_entries) &&
+		    (prune != NULL)) {
+			browser_window_history__remove_entry(history, prune);
+			continue;
+		}
+
+		if ((max_thumbnails > 0) &&
+		    (bitmaps > (unsigned int)max_thumbnails) &&
+		    (drop != NULL)) {
+			guit->bitmap->destroy(drop->page.bitmap);
+			drop->page.bitmap = NULL;
+			continue;
+		}
+
+		break;
+	}
+}
+
+
+/* exported interface documented in desktop/browser_private.h */
+bool
+browser_window_history_freeze(struct browser_window *bw,
+			      struct hlcache_handle *content)
+{
+	struct history *history = bw->history;
+	int limit = nsoption_int(page_cache_size);
+	unsigned int used = 0;
+	unsigned int i;
+	int slot = -1;
+
+	if ((limit <= 0) ||
+	    (history == NULL) ||
+	    (history->current == NULL)) {
+		return false;
+	}
+	if (limit > BROWSER_HISTORY_MAX_FROZEN) {
+		limit = BROWSER_HISTORY_MAX_FROZEN;
+	}
+
+	if ((content_get_type(content) != CONTENT_HTML) ||
+	    (content_get_status(content) != CONTENT_STATUS_DONE)) {
+		/* only fully loaded pages are worth keeping */
+		return false;
+	}
+
+	/* replace any stale page for this entry and find a free slot */
+	for (i = 0; i < BROWSER_HISTORY_MAX_FROZEN; i++) {
+		if (history->frozen[i].entry == history->current) {
+			hlcache_handle_release(history->frozen[i].content);
+			history->frozen[i].entry = NULL;
+			history->frozen[i].content = NULL;
+		}
+		if (history->frozen[i].content == NULL) {
+			slot = i;
+		} else {
+			used++;
+		}
+	}
+
+	if ((slot == -1) || (used >= (unsigned int)limit)) {
+		/* evict the next slot in rotation */
+		slot = history->frozen_next;
+		history->frozen_next =
+			(slot + 1) % BROWSER_HISTORY_MAX_FROZEN;
+		if (history->frozen[slot].content != NULL) {
+			hlcache_handle_release(history->frozen[slot].content);
+		}
+	}
+
+	history->frozen[slot].entry = history->current;
+	history->frozen[slot].content = content;
+
+	NSLOG(netsurf, DEBUG, "Froze page %s",
+	      nsurl_access(hlcache_handle_get_url(content)));
+
+	return true;
+}
+
+
+/* exported interface documented in desktop/browser_private.h */
+struct hlcache_handle *
+browser_window_history_take_frozen(struct browser_window *bw,
+				   struct history_entry *entry)
+{
+	struct history *history = bw->history;
+	struct hlcache_handle *content;
+	unsigned int i;
+
+	if (history == NULL) {
+		return NULL;
+	}
+
+	for (i = 0; i < BROWSER_HISTORY_MAX_FROZEN; i++) {
+		if (history->frozen[i].entry == entry) {
+			content = history->frozen[i].content;
+			history->frozen[i].entry = NULL;
+			history->frozen[i].content = NULL;
+			return content;
+		}
+	}
+
+	return NULL;
+}
+
+
 /**
  * Recursively position a subtree.
  *
@@ -334,6 +600,10 @@ nserror browser_window_history_clone(const struct browser_window *existing,
 	clone->history = new_history;
 	memcpy(new_history, existing->history, sizeof *new_history);
 
+	/* frozen pages belong to the original window */
+	memset(new_history->frozen, 0, sizeof(new_history->frozen));
+	new_history->frozen_next = 0;
+
 	new_history->start = browser_window_history__clone_entry(new_history,
 			new_history->start);
 	if (!new_history->start) {
@@ -402,6 +672,7 @@ browser_window_history_add(struct browser_window *bw,
 	entry->next = NULL;
 	entry->forward = entry->forward_pref = entry->forward_last = NULL;
 	entry->children = 0;
+	entry->last_visited = time(NULL);
 
 	if (history->current) {
 		if (history->current->forward_last) {
@@ -417,6 +688,8 @@ browser_window_history_add(struct browser_window *bw,
 	}
 	history->current = entry;
 
+	browser_window_history__apply_retention(history);
+
 	browser_window_history__layout(history);
 
 	return NSERROR_OK;
@@ -450,8 +723,21 @@ nserror browser_window_history_update(struct browser_window *bw,
 	free(history->current->page.title);
 	history->current->page.title = title;
 
+	history->current->last_visited = time(NULL);
+
+	if (history->current->page.bitmap == NULL) {
+		/* the thumbnail was dropped by a retention limit;
+		 * recreate it now the page is on view again */
+		history->current->page.bitmap = guit->bitmap->create(
+				LOCAL_HISTORY_WIDTH, LOCAL_HISTORY_HEIGHT,
+				BITMAP_CLEAR | BITMAP_OPAQUE);
+	}
+
 	if (history->current->page.bitmap != NULL) {
-		guit->bitmap->render(history->current->page.bitmap, content);
+		/* coalesce repeated updates into one deferred render */
+		guit->misc->schedule(THUMBNAIL_RENDER_DELAY,
+				browser_window_history__render_thumbnail,
+				bw);
 	}
 
 	if ((bw->window != NULL) &&
@@ -501,11 +787,23 @@ browser_window_history_get_scroll(struct browser_window *bw,
 /* exported interface documented in desktop/browser_history.h */
 void browser_window_history_destroy(struct browser_window *bw)
 {
+	unsigned int i;
+
 	assert(bw != NULL);
 
 	if (bw->history == NULL)
 		return;
 
+	guit->misc->schedule(-1,
+			browser_window_history__render_thumbnail,
+			bw);
+
+	for (i = 0; i < BROWSER_HISTORY_MAX_FROZEN; i++) {
+		if (bw->history->frozen[i].content != NULL) {
+			hlcache_handle_release(bw->history->frozen[i].content);
+		}
+	}
+
 	browser_window_history__free_entry(bw->history->start);
 	free(bw->history);
 
@@ -629,7 +927,18 @@ nserror browser_window_history_go(struct browser_window *bw,
 		if (bw->current_content != NULL) {
 			browser_window_history_update(bw, bw->current_content);
 		}
+
+		/* a frozen page restores without refetching */
+		error = browser_window_restore_frozen(bw, entry);
+		if (error == NSERROR_OK) {
+			history->current = entry;
+			entry->last_visited = time(NULL);
+			nsurl_unref(url);
+			return NSERROR_OK;
+		}
+
 		history->current = entry;
+		entry->last_visited = time(NULL);
 		error = browser_window_navigate(bw, url, NULL,
 				BW_NAVIGATE_NO_TERMINAL_HISTORY_UPDATE,
 				NULL, NULL, NULL);
@@ -25,15 +25,23 @@
 #ifndef NETSURF_DESKTOP_BROWSER_PRIVATE_H_
 #define NETSURF_DESKTOP_BROWSER_PRIVATE_H_
 
+#include <stdint.h>
+#include <time.h>
+
+#include "netsurf/types.h"
 #include "content/fetch.h"
 #include "desktop/frame_types.h"
 
+struct bitmap;
 struct box;
 struct hlcache_handle;
 struct gui_window;
 struct selection;
 struct nsurl;
 
+/** Maximum number of rectangles in a pending invalidation region */
+#define BROWSER_WINDOW_DAMAGE_RECTS 8
+
 /**
  * history entry page information
  */
@@ -60,8 +68,12 @@ struct history_entry {
 	unsigned int children;  /**< Number of children. */
 	int x;  /**< Position of node. */
 	int y;  /**< Position of node. */
+	time_t last_visited;  /**< Time the entry was last visited. */
 };
 
+/** Number of slots in a history tree's frozen page cache */
+#define BROWSER_HISTORY_MAX_FROZEN 8
+
 /**
  * History tree for a window.
  */
@@ -74,6 +86,19 @@ struct history {
 	int width;
 	/** Height of layout. */
 	int height;
+
+	/**
+	 * Recently left pages kept alive, with DOM and layout, for
+	 * instant restoration on back/forward navigation.
+	 */
+	struct {
+		/** History entry the page belongs to. */
+		struct history_entry *entry;
+		/** The closed content. */
+		struct hlcache_handle *content;
+	} frozen[BROWSER_HISTORY_MAX_FROZEN];
+	/** Next frozen slot considered for eviction. */
+	unsigned int frozen_next;
 };
 
 /**
@@ -156,6 +181,35 @@ struct browser_window {
 	 */
 	struct gui_window *window;
 
+	/**
+	 * Pending invalidation region only valid at top level.
+	 *
+	 * Damage reported by contents is accumulated here and
+	 * flushed to the front end once per frame tick so that
+	 * overlapping updates are only repainted once.
+	 */
+	struct {
+		struct rect rects[BROWSER_WINDOW_DAMAGE_RECTS];
+		unsigned int count;
+		bool scheduled;
+		/** the pending flush only carries animation damage and
+		 * is scheduled on the slower animation tick
+		 */
+		bool anim_only;
+	} damage;
+
+	/**
+	 * The front end reports the window is not visible.
+	 *
+	 * Only valid at top level. While set, damage flushes are
+	 * withheld and meta refreshes are deferred; both are released
+	 * when the window is shown again.
+	 */
+	bool hidden;
+
+	/** A meta refresh came due while the window was hidden. */
+	bool refresh_pending;
+
 	/** Busy indicator is active. */
 	bool throbbing;
 	/** Add loading_content to the window history when it loads. */
@@ -163,6 +217,9 @@ struct browser_window {
 	/** Internal navigation, do not update URL etc */
 	bool internal_nav;
 
+	/** Session journal identifier, 0 until first recorded. */
+	uint32_t session_id;
+
 	/** Fragment identifier for current_content. */
 	lwc_string *frag_id;
 
@@ -223,6 +280,9 @@ struct browser_window {
 	int rows;
 	int cols;
 
+	/** frameset recalculation is scheduled */
+	bool frameset_recalc_scheduled;
+
 	/** frame dimensions */
 	struct frame_dimension frame_width;
 	struct frame_dimension frame_height;
@@ -241,6 +301,20 @@ struct browser_window {
 	/** iframe parent box */
 	struct box *box;
 
+	/**
+	 * Retained raster layer for core managed iframe windows.
+	 *
+	 * Repaints of the embedding page blit the last rendering of
+	 * the iframe instead of replotting its box tree; the raster
+	 * is dropped whenever the iframe's own content changes.
+	 */
+	struct {
+		struct bitmap *bitmap; /**< rendered content raster */
+		int width; /**< width the raster was rendered at */
+		int height; /**< height the raster was rendered at */
+		bool valid; /**< raster matches the content */
+	} layer;
+
 	/** [cols * rows] children */
 	struct browser_window *children;
 	struct browser_window *parent;
@@ -398,6 +472,44 @@ nserror browser_window_history_update(struct browser_window *bw,
 nserror browser_window_history_get_scroll(struct browser_window *bw,
 					  float *sx, float *sy);
 
+/**
+ * Offer a page's content to the history frozen page cache.
+ *
+ * The content must already be closed. If the cache takes the content
+ * it takes ownership of the caller's reference and keeps the page,
+ * with DOM and layout intact, against the current history entry for
+ * later restoration.
+ *
+ * \param bw The browser window being navigated away from.
+ * \param content The content being left.
+ * \return true if the cache took ownership of the content.
+ */
+bool browser_window_history_freeze(struct browser_window *bw,
+				   struct hlcache_handle *content);
+
+/**
+ * Take the frozen page for a history entry out of the cache.
+ *
+ * Ownership of the returned content passes to the caller.
+ *
+ * \param bw The browser window being navigated.
+ * \param entry The history entry being returned to.
+ * \return The frozen content, or NULL if none is cached.
+ */
+struct hlcache_handle *browser_window_history_take_frozen(
+		struct browser_window *bw, struct history_entry *entry);
+
+/**
+ * Restore a frozen page as the browser window's current content.
+ *
+ * \param bw The browser window to restore the page in.
+ * \param entry The history entry being returned to.
+ * \return NSERROR_OK on success, NSERROR_NOT_FOUND if the entry has
+ *         no frozen page.
+ */
+nserror browser_window_restore_frozen(struct browser_window *bw,
+				      struct history_entry *entry);
+
 /**
  * Free a history structure.
  *
@@ -43,8 +43,10 @@
 #include "netsurf/content.h"
 #include "netsurf/search.h"
 #include "netsurf/plotters.h"
+#include "netsurf/bitmap.h"
 #include "content/content.h"
 #include "content/hlcache.h"
+#include "content/page_timings.h"
 #include "content/urldb.h"
 #include "content/content_debug.h"
 
@@ -56,12 +58,14 @@
 #include "desktop/scrollbar.h"
 #include "desktop/gui_internal.h"
 #include "desktop/download.h"
+#include "desktop/frame_budget.h"
 #include "desktop/frames.h"
 #include "desktop/global_history.h"
 #include "desktop/textinput.h"
 #include "desktop/hotlist.h"
 #include "desktop/knockout.h"
 #include "desktop/browser_history.h"
+#include "desktop/session.h"
 #include "desktop/theme.h"
 
 #ifdef WITH_THEME_INSTALL
@@ -78,6 +82,16 @@
  */
 #define SCALE_MAXIMUM 10.0
 
+/**
+ * interval after the last scale step before reformatting, in ms
+ *
+ * Zoom gestures arrive as a rapid run of scale steps.  Each step is
+ * shown immediately by repainting the existing layout at the new
+ * scale; the expensive reformat is held back until the scale has been
+ * still for this long.
+ */
+#define SCALE_REFORMAT_INTERVAL 150
+
 /**
  * maximum frame depth
  */
@@ -87,6 +101,10 @@
 static nserror browser_window__navigate_internal(
 	struct browser_window *bw, struct browser_fetch_parameters *params);
 
+/* Forward declare internal invalidation function */
+static nserror browser_window__invalidate_rect(
+	struct browser_window *bw, struct rect *rect, bool animated);
+
 
 /**
  * Close and destroy all child browser window.
@@ -481,7 +499,9 @@ browser_window_favicon_callback(hlcache_handle *c,
 				      "Unable to create default location url");
 			} else {
 				hlcache_handle_retrieve(nsurl,
-							HLCACHE_RETRIEVE_SNIFF_TYPE,
+							HLCACHE_RETRIEVE_SNIFF_TYPE |
+							LLCACHE_RETRIEVE_PRIORITY(
+								FETCH_PRIORITY_FAVICON),
 							nsref, NULL,
 							browser_window_favicon_callback,
 							bw, NULL, CONTENT_IMAGE,
@@ -593,8 +613,12 @@ browser_window_update_favicon(hlcache_handle *c,
 		      nsurl_access(nsurl));
 	}
 
+	/* favicons are cosmetic; only fetch them when nothing the page
+	 * is waiting on wants the fetcher slot */
 	res = hlcache_handle_retrieve(nsurl,
-				      HLCACHE_RETRIEVE_SNIFF_TYPE,
+				      HLCACHE_RETRIEVE_SNIFF_TYPE |
+				      LLCACHE_RETRIEVE_PRIORITY(
+					      FETCH_PRIORITY_FAVICON),
 				      nsref,
 				      NULL,
 				      browser_window_favicon_callback,
@@ -727,6 +751,155 @@ static bool frag_scroll(struct browser_window *bw)
 }
 
 
+/** Interval between pending invalidation flushes (ms) */
+#define DAMAGE_FLUSH_INTERVAL 10
+
+
+/**
+ * Obtain the animation tick interval in milliseconds.
+ *
+ * Animation driven damage is flushed on a slower clock than
+ * interactive damage so concurrent animations are painted together
+ * once per tick at the configured rate.
+ *
+ * \return the animation tick interval.
+ */
+static int browser_window__animation_interval(void)
+{
+	int fps = nsoption_int(animation_fps);
+
+	if (fps < 1) {
+		fps = 1;
+	} else if (fps > 100) {
+		fps = 100;
+	}
+
+	return 1000 / fps;
+}
+
+
+/**
+ * Flush a window's pending invalidation region to the front end.
+ *
+ * \param p The browser window owning the region.
+ */
+static void browser_window__damage_flush(void *p)
+{
+	struct browser_window *bw = p;
+	unsigned int i;
+
+	bw->damage.scheduled = false;
+
+	for (i = 0; i < bw->damage.count; i++) {
+		guit->window->invalidate(bw->window, &bw->damage.rects[i]);
+	}
+	bw->damage.count = 0;
+}
+
+
+/**
+ * Add a rectangle to a top level window's pending invalidation region.
+ *
+ * The rectangle is merged into any pending rectangle it overlaps so
+ * the front end is never asked to repaint the overlap twice. The
+ * region is bounded; when it is full it is collapsed into a single
+ * bounding rectangle. The region is flushed once per frame tick.
+ *
+ * \param bw The top level browser window to damage.
+ * \param rect The damaged rectangle in window coordinates.
+ * \param animated The damage was reported by an animating content.
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+browser_window__damage_add(struct browser_window *bw,
+			   const struct rect *rect,
+			   bool animated)
+{
+	struct rect *r;
+	unsigned int i;
+
+	assert(bw->window != NULL);
+
+	for (i = 0; i < bw->damage.count; i++) {
+		r = &bw->damage.rects[i];
+		if (rect->x0 < r->x1 && rect->x1 > r->x0 &&
+		    rect->y0 < r->y1 && rect->y1 > r->y0) {
+			/* overlaps a pending rectangle; merge into it */
+			break;
+		}
+	}
+
+	if (i == bw->damage.count) {
+		if (bw->damage.count == BROWSER_WINDOW_DAMAGE_RECTS) {
+			/* region full; collapse it into its first entry */
+			r = &bw->damage.rects[0];
+			for (i = 1; i < bw->damage.count; i++) {
+				if (bw->damage.rects[i].x0 < r->x0)
+					r->x0 = bw->damage.rects[i].x0;
+				if (bw->damage.rects[i].y0 < r->y0)
+					r->y0 = bw->damage.rects[i].y0;
+				if (bw->damage.rects[i].x1 > r->x1)
+					r->x1 = bw->damage.rects[i].x1;
+				if (bw->damage.rects[i].y1 > r->y1)
+					r->y1 = bw->damage.rects[i].y1;
+			}
+			bw->damage.count = 1;
+		} else {
+			bw->damage.rects[bw->damage.count++] = *rect;
+			r = NULL;
+		}
+	}
+
+	if (r != NULL) {
+		if (rect->x0 < r->x0)
+			r->x0 = rect->x0;
+		if (rect->y0 < r->y0)
+			r->y0 = rect->y0;
+		if (rect->x1 > r->x1)
+			r->x1 = rect->x1;
+		if (rect->y1 > r->y1)
+			r->y1 = rect->y1;
+	}
+
+	if (bw->hidden) {
+		/* nobody can see the window; the accumulated region is
+		 * flushed when the front end reports it visible again
+		 */
+		return NSERROR_OK;
+	}
+
+	if (!bw->damage.scheduled) {
+		nserror res;
+		int interval = DAMAGE_FLUSH_INTERVAL;
+
+		if (animated) {
+			interval = browser_window__animation_interval();
+		}
+		res = guit->misc->schedule(interval,
+					   browser_window__damage_flush,
+					   bw);
+		if (res != NSERROR_OK) {
+			/* no flush is coming; invalidate immediately */
+			browser_window__damage_flush(bw);
+			return res;
+		}
+		bw->damage.scheduled = true;
+		bw->damage.anim_only = animated;
+	} else if (!animated && bw->damage.anim_only) {
+		/* interactive damage must not wait for the animation
+		 * tick; bring the pending flush forward.
+		 */
+		if (guit->misc->schedule(DAMAGE_FLUSH_INTERVAL,
+					 browser_window__damage_flush,
+					 bw) == NSERROR_OK) {
+			bw->damage.anim_only = false;
+		}
+	}
+
+	return NSERROR_OK;
+}
+
+
 /**
  * Redraw browser window, set extent to content, and update title.
  *
@@ -824,10 +997,13 @@ static nserror browser_window_content_ready(struct browser_window *bw)
 	int width, height;
 	nserror res = NSERROR_OK;
 
-	/* close and release the current window content */
+	/* close the current window content, freezing it for instant
+	 * back navigation if the cache will take it */
 	if (bw->current_content != NULL) {
 		content_close(bw->current_content);
-		hlcache_handle_release(bw->current_content);
+		if (!browser_window_history_freeze(bw, bw->current_content)) {
+			hlcache_handle_release(bw->current_content);
+		}
 	}
 
 	bw->current_content = bw->loading_content;
@@ -890,6 +1066,12 @@ static nserror browser_window_content_ready(struct browser_window *bw)
 		browser_window_history_add(bw, bw->current_content, bw->frag_id);
 	}
 
+	/* journal the displayed URL for session restore */
+	if (!bw->internal_nav) {
+		session_record_navigate(bw,
+				hlcache_handle_get_url(bw->current_content));
+	}
+
 	browser_window_remove_caret(bw, false);
 
 	if (bw->window != NULL) {
@@ -962,14 +1144,96 @@ browser_window_content_done(struct browser_window *bw)
 	}
 
 	if (bw->refresh_interval != -1) {
-		guit->misc->schedule(bw->refresh_interval * 10,
-				     browser_window_refresh, bw);
+		if (browser_window_get_root(bw)->hidden) {
+			/* nobody is watching; reload when they are */
+			bw->refresh_pending = true;
+		} else {
+			guit->misc->schedule(bw->refresh_interval * 10,
+					     browser_window_refresh, bw);
+		}
 	}
 
 	return NSERROR_OK;
 }
 
 
+/* exported interface documented in desktop/browser_private.h */
+nserror
+browser_window_restore_frozen(struct browser_window *bw,
+			      struct history_entry *entry)
+{
+	struct hlcache_handle *content;
+	struct browser_window *root;
+	struct rect rect;
+	int width, height;
+
+	content = browser_window_history_take_frozen(bw, entry);
+	if (content == NULL) {
+		return NSERROR_NOT_FOUND;
+	}
+
+	NSLOG(netsurf, INFO, "Restoring frozen page %s",
+	      nsurl_access(hlcache_handle_get_url(content)));
+
+	/* discard any load in progress */
+	browser_window_stop(bw);
+	browser_window_remove_caret(bw, false);
+	browser_window_destroy_children(bw);
+	browser_window_destroy_iframes(bw);
+
+	/* swap the current content for the frozen page, offering the
+	 * page being left to the cache in turn */
+	if (bw->current_content != NULL) {
+		content_close(bw->current_content);
+		if (!browser_window_history_freeze(bw, bw->current_content)) {
+			hlcache_handle_release(bw->current_content);
+		}
+	}
+	bw->current_content = content;
+
+	/* journal the displayed URL for session restore */
+	session_record_navigate(bw,
+			hlcache_handle_get_url(bw->current_content));
+
+	/* Format the restored content to the correct dimensions */
+	browser_window_get_dimensions(bw, &width, &height);
+	width /= bw->scale;
+	height /= bw->scale;
+	content_reformat(bw->current_content, false, width, height);
+
+	if (bw->window != NULL) {
+		guit->window->event(bw->window, GW_EVENT_NEW_CONTENT);
+
+		browser_window_refresh_url_bar(bw);
+	}
+
+	browser_window_update(bw, false);
+	content_open(bw->current_content, bw, 0, 0);
+	browser_window_set_status(bw,
+			content_get_status_message(bw->current_content));
+	browser_window_update_favicon(bw->current_content, bw, NULL);
+
+	/* frames */
+	browser_window_create_frameset(bw);
+
+	/* iframes */
+	browser_window_create_iframes(bw);
+
+	/* restore the scroll offsets recorded against the entry */
+	rect.x0 = rect.x1 = (int)((float)content_get_width(
+			bw->current_content) * entry->page.scroll_x);
+	rect.y0 = rect.y1 = (int)((float)content_get_height(
+			bw->current_content) * entry->page.scroll_y);
+	browser_window_set_scroll(bw, &rect);
+
+	/* Indicate page status may have changed */
+	root = browser_window_get_root(bw);
+	guit->window->event(root->window, GW_EVENT_PAGE_INFO_CHANGE);
+
+	return NSERROR_OK;
+}
+
+
 /**
  * Handle query responses from SSL requests
  */
@@ -1452,6 +1716,12 @@ browser_window_callback(hlcache_handle *c, const hlcache_event *event, void *pw)
 	struct browser_window *bw = pw;
 	nserror res = NSERROR_OK;
 
+	if ((c != bw->loading_content) && (c != bw->current_content)) {
+		/* Message from a frozen page held in the history
+		 * cache; it is not on display, so ignore it. */
+		return NSERROR_OK;
+	}
+
 	switch (event->type) {
 	case CONTENT_MSG_SSL_CERTS:
 		/* SSL certificate information has arrived, store it */
@@ -1542,6 +1812,9 @@ browser_window_callback(hlcache_handle *c, const hlcache_event *event, void *pw)
 		break;
 
 	case CONTENT_MSG_REFORMAT:
+		/* the retained layer no longer matches the content */
+		bw->layer.valid = false;
+
 		if (c == bw->current_content) {
 			/* recompute frameset */
 			browser_window_recalculate_frameset(bw);
@@ -1568,7 +1841,15 @@ browser_window_callback(hlcache_handle *c, const hlcache_event *event, void *pw)
 					    .y1 = event->data.redraw.y + event->data.redraw.height
 			};
 
-			browser_window_invalidate_rect(bw, &rect);
+			/* the retained layer no longer matches the
+			 * content */
+			bw->layer.valid = false;
+
+			/* content driven repaints are almost always
+			 * animation frames, so batch them onto the
+			 * animation tick.
+			 */
+			browser_window__invalidate_rect(bw, &rect, true);
 		}
 		break;
 
@@ -1833,9 +2114,18 @@ nserror browser_window_destroy_internal(struct browser_window *bw)
 {
 	assert(bw);
 
+	/* deliberate closes drop the window from the session journal */
+	session_record_close(bw);
+
 	browser_window_destroy_children(bw);
 	browser_window_destroy_iframes(bw);
 
+	/* Destroy any retained layer */
+	if (bw->layer.bitmap != NULL) {
+		guit->bitmap->destroy(bw->layer.bitmap);
+		bw->layer.bitmap = NULL;
+	}
+
 	/* Destroy scrollbars */
 	if (bw->scroll_x != NULL) {
 		scrollbar_destroy(bw->scroll_x);
@@ -1850,6 +2140,8 @@ nserror browser_window_destroy_internal(struct browser_window *bw)
 	NSLOG(netsurf, INFO,
 	      "Clearing reformat schedule for browser window %p", bw);
 	guit->misc->schedule(-1, scheduled_reformat, bw);
+	guit->misc->schedule(-1, browser_window__damage_flush, bw);
+	browser_window_cancel_frameset_recalc(bw);
 
 	/* If this brower window is not the root window, and has focus, unset
 	 * the root browser window's focus pointer. */
@@ -1951,7 +2243,18 @@ browser_window_set_scale_internal(struct browser_window *bw, float scale)
 		if (content_can_reformat(bw->current_content) == false) {
 			browser_window_update(bw, false);
 		} else {
-			res = browser_window_schedule_reformat(bw);
+			/* Repaint the existing layout scaled right away
+			 * so every step of a zoom gesture is seen, and
+			 * debounce the reformat until the gesture has
+			 * settled; rescheduling resets the pending
+			 * callback on each step. */
+			browser_window_update(bw, false);
+			if (bw->window != NULL) {
+				res = guit->misc->schedule(
+						SCALE_REFORMAT_INTERVAL,
+						scheduled_reformat,
+						bw);
+			}
 		}
 	}
 
@@ -2578,6 +2881,85 @@ browser_window_set_name(struct browser_window *bw, const char *name)
 }
 
 
+/**
+ * Maximum width of an iframe retained layer, in pixels.
+ *
+ * Matches the limit the front end bitmap renderers place on their
+ * render buffers; a wider layer would come back scaled.
+ */
+#define LAYER_WIDTH_MAX 1024
+
+/**
+ * Redraw a core managed iframe window from its retained layer.
+ *
+ * Renders the iframe's content into the layer raster if it is stale
+ * and blits the raster.  The raster is only a faithful copy of what
+ * direct plotting would produce while the view is unscaled and
+ * unscrolled; anything else falls back to plotting the content.
+ *
+ * \param bw The iframe browser window being redrawn.
+ * \param x Window x coordinate of the iframe.
+ * \param y Window y coordinate of the iframe.
+ * \param clip The clip rectangle for the content area.
+ * \param ctx The redraw context.
+ * \return true if the layer was blitted, false to plot the content.
+ */
+static bool
+browser_window__redraw_from_layer(struct browser_window *bw,
+				  int x, int y,
+				  const struct rect *clip,
+				  const struct redraw_context *ctx)
+{
+	int width;
+
+	if (fabs(bw->scale - 1.0) >= 0.0001) {
+		return false;
+	}
+
+	if ((bw->scroll_x != NULL && scrollbar_get_offset(bw->scroll_x) != 0) ||
+	    (bw->scroll_y != NULL && scrollbar_get_offset(bw->scroll_y) != 0)) {
+		return false;
+	}
+
+	width = content_get_width(bw->current_content);
+	if (width <= 0 || width > LAYER_WIDTH_MAX || bw->height <= 0) {
+		return false;
+	}
+
+	/* (re)create the raster if the iframe changed size */
+	if (bw->layer.bitmap != NULL &&
+	    (bw->layer.width != width || bw->layer.height != bw->height)) {
+		guit->bitmap->destroy(bw->layer.bitmap);
+		bw->layer.bitmap = NULL;
+	}
+
+	if (bw->layer.bitmap == NULL) {
+		bw->layer.bitmap = guit->bitmap->create(width, bw->height,
+							BITMAP_OPAQUE);
+		if (bw->layer.bitmap == NULL) {
+			return false;
+		}
+		bw->layer.width = width;
+		bw->layer.height = bw->height;
+		bw->layer.valid = false;
+	}
+
+	if (bw->layer.valid == false) {
+		if (guit->bitmap->render(bw->layer.bitmap,
+					 bw->current_content) != NSERROR_OK) {
+			return false;
+		}
+		bw->layer.valid = true;
+	}
+
+	ctx->plot->clip(ctx, clip);
+
+	return (ctx->plot->bitmap(ctx, bw->layer.bitmap, x, y,
+				  bw->layer.width, bw->layer.height,
+				  0xFFFFFF, BITMAPF_NONE) == NSERROR_OK);
+}
+
+
 /* exported interface, documented in netsurf/browser_window.h */
 bool
 browser_window_redraw(struct browser_window *bw,
@@ -2720,9 +3102,32 @@ browser_window_redraw(struct browser_window *bw,
 		if (y1 < content_clip.y1) content_clip.y1 = y1;
 	}
 
-	/* Render the content */
-	plot_ok &= content_redraw(bw->current_content, &data,
-				  &content_clip, &new_ctx);
+	/* Render the content; core managed iframes blit their retained
+	 * layer when it is usable, so repaints of the embedding page do
+	 * not replot the iframe's box tree. */
+	if ((bw->browser_window_type == BROWSER_WINDOW_IFRAME) &&
+	    browser_window__redraw_from_layer(bw, x, y,
+					      &content_clip, &new_ctx)) {
+		/* blitted from the retained layer */
+	} else {
+		frame_budget_enter(FRAME_BUDGET_PAINT);
+		page_timings_phase_start(hlcache_handle_get_content(bw->current_content),
+					 PAGE_TIMINGS_PAINT);
+		plot_ok &= content_redraw(bw->current_content, &data,
+					  &content_clip, &new_ctx);
+		page_timings_phase_stop(hlcache_handle_get_content(bw->current_content),
+					PAGE_TIMINGS_PAINT);
+		frame_budget_leave(FRAME_BUDGET_PAINT);
+	}
+
+	/* the navigation sample is complete once a finished page has
+	 * been painted
+	 */
+	if (content_get_status(bw->current_content) == CONTENT_STATUS_DONE) {
+		page_timings_close(
+			hlcache_handle_get_content(bw->current_content),
+			true);
+	}
 
 	/* Back to full clip rect */
 	new_ctx.plot->clip(&new_ctx, clip);
@@ -4042,9 +4447,18 @@ browser_window_set_dimensions(struct browser_window *bw, int width, int height)
 }
 
 
-/* Exported interface, documented in browser/browser_private.h */
-nserror
-browser_window_invalidate_rect(struct browser_window *bw, struct rect *rect)
+/**
+ * Invalidate an area of a browser window.
+ *
+ * \param bw The browser window invalidated.
+ * \param rect The area to invalidate in window coordinates.
+ * \param animated The invalidation is driven by an animating content.
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+browser_window__invalidate_rect(struct browser_window *bw,
+				struct rect *rect,
+				bool animated)
 {
 	int pos_x;
 	int pos_y;
@@ -4069,7 +4483,15 @@ browser_window_invalidate_rect(struct browser_window *bw, struct rect *rect)
 	rect->x1 *= top->scale;
 	rect->y1 *= top->scale;
 
-	return guit->window->invalidate(top->window, rect);
+	return browser_window__damage_add(top, rect, animated);
+}
+
+
+/* Exported interface, documented in browser/browser_private.h */
+nserror
+browser_window_invalidate_rect(struct browser_window *bw, struct rect *rect)
+{
+	return browser_window__invalidate_rect(bw, rect, false);
 }
 
 
@@ -4329,6 +4751,71 @@ float browser_window_get_scale(struct browser_window *bw)
 }
 
 
+/**
+ * Run any meta refresh deferred while a window was hidden.
+ *
+ * \param bw The browser window to resume refreshes beneath.
+ */
+static void browser_window__run_pending_refresh(struct browser_window *bw)
+{
+	int index;
+
+	if (bw->refresh_pending) {
+		bw->refresh_pending = false;
+		if ((bw->refresh_interval != -1) &&
+		    (bw->current_content != NULL)) {
+			guit->misc->schedule(0, browser_window_refresh, bw);
+		}
+	}
+
+	for (index = 0; index < (bw->rows * bw->cols); index++) {
+		browser_window__run_pending_refresh(&bw->children[index]);
+	}
+	for (index = 0; index < bw->iframe_count; index++) {
+		browser_window__run_pending_refresh(&bw->iframes[index]);
+	}
+}
+
+
+/* exported interface documented in netsurf/browser_window.h */
+nserror browser_window_set_visibility(struct browser_window *bw, bool visible)
+{
+	assert(bw != NULL);
+
+	bw = browser_window_get_root(bw);
+
+	if (bw->hidden == !visible) {
+		return NSERROR_OK;
+	}
+	bw->hidden = !visible;
+
+	if (bw->hidden) {
+		/* nothing is torn down; repaints stop being requested,
+		 * which in turn lets animations suspend themselves
+		 */
+		return NSERROR_OK;
+	}
+
+	/* flush any damage withheld while the window was hidden */
+	if ((bw->damage.count > 0) && (!bw->damage.scheduled)) {
+		browser_window__damage_flush(bw);
+	}
+
+	browser_window__run_pending_refresh(bw);
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in netsurf/browser_window.h */
+bool browser_window_get_visibility(struct browser_window *bw)
+{
+	assert(bw != NULL);
+
+	return !(browser_window_get_root(bw)->hidden);
+}
+
+
 /* exported interface documented in netsurf/browser_window.h */
 struct browser_window *
 browser_window_find_target(struct browser_window *bw,
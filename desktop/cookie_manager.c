@@ -79,6 +79,9 @@ struct cookie_manager_ctx {
 	struct treeview_field_desc fields[COOKIE_M_N_FIELDS];
 	struct treeview_field_data values[COOKIE_M_N_VALUES];
 	bool built;
+	/** Domain folder used by the last update, tried before walking the
+	 * tree, since bursts of cookie updates tend to hit one domain */
+	struct cookie_manager_folder *last_folder;
 };
 struct cookie_manager_ctx cm_ctx;
 
@@ -94,6 +97,8 @@ struct cookie_manager_entry {
 struct treeview_walk_ctx {
 	const char *title;
 	size_t title_len;
+	const char *path;
+	size_t path_len;
 	struct cookie_manager_folder *folder;
 	struct cookie_manager_entry *entry;
 };
@@ -108,7 +113,11 @@ static nserror cookie_manager_walk_cb(void *ctx, void *node_data,
 
 		if (entry->data[COOKIE_M_NAME].value_len == tw->title_len &&
 				strcmp(tw->title,
-				entry->data[COOKIE_M_NAME].value) == 0) {
+				entry->data[COOKIE_M_NAME].value) == 0 &&
+				entry->data[COOKIE_M_PATH].value_len ==
+				tw->path_len &&
+				strcmp(tw->path,
+				entry->data[COOKIE_M_PATH].value) == 0) {
 			/* Found what we're looking for */
 			tw->entry = entry;
 			*abort = true;
@@ -130,20 +139,27 @@ static nserror cookie_manager_walk_cb(void *ctx, void *node_data,
 /**
  * Find a cookie entry in the cookie manager's treeview
  *
+ * Entries are keyed by name and path within their domain folder.
+ *
  * \param root		Search root node, or NULL to search from tree's root
- * \param title		ID of the node to look for
+ * \param title		Name of the cookie to look for
  * \param title_len	Byte length of title string
+ * \param path		Path of the cookie to look for
+ * \param path_len	Byte length of path string
  * \param found		Updated to the matching node's cookie maanger entry
  * \return NSERROR_OK on success, appropriate error otherwise
  */
 static nserror cookie_manager_find_entry(treeview_node *root,
 		const char *title, size_t title_len,
+		const char *path, size_t path_len,
 		struct cookie_manager_entry **found)
 {
 	nserror err;
 	struct treeview_walk_ctx tw = {
 		.title = title,
 		.title_len = title_len,
+		.path = path,
+		.path_len = path_len,
 		.folder = NULL,
 		.entry = NULL
 	};
@@ -174,6 +190,8 @@ static nserror cookie_manager_find_folder(treeview_node *root,
 	struct treeview_walk_ctx tw = {
 		.title = title,
 		.title_len = title_len,
+		.path = NULL,
+		.path_len = 0,
 		.folder = NULL,
 		.entry = NULL
 	};
@@ -380,11 +398,40 @@ static nserror cookie_manager_create_cookie_node(
 }
 
 
+/**
+ * Check whether two sets of cookie entry field data are identical.
+ *
+ * \param a		First set of entry field data
+ * \param b		Second set of entry field data
+ * \return true iff every field has the same value in both sets
+ */
+static bool cookie_manager_field_data_match(
+		const struct treeview_field_data *a,
+		const struct treeview_field_data *b)
+{
+	int i;
+
+	for (i = 0; i < COOKIE_M_N_FIELDS - 1; i++) {
+		if (a[i].value_len != b[i].value_len)
+			return false;
+		if (a[i].value == b[i].value)
+			continue;
+		if (a[i].value == NULL || b[i].value == NULL)
+			return false;
+		if (strcmp(a[i].value, b[i].value) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+
 /**
  * Updates a cookie manager entry for updated cookie_data.
  *
  * All information is copied from the cookie_data, and as such can
- * be edited and should be freed.
+ * be edited and should be freed.  If nothing the treeview shows has
+ * actually changed, the treeview is left undisturbed.
  *
  * \param e	      the entry to update
  * \param data	      the cookie data to use
@@ -394,20 +441,29 @@ static nserror cookie_manager_update_cookie_node(
 		struct cookie_manager_entry *e,
 		const struct cookie_data *data)
 {
+	struct cookie_manager_entry temp;
 	nserror err;
 
 	assert(e != NULL);
 
-	/* Reset to defaults */
-	e->user_delete = false;
-	cookie_manager_free_treeview_field_data(e);
-
-	/* Set new field values from the cookie_data */
-	err = cookie_manager_set_treeview_field_data(e, data);
+	/* Build the new field values from the cookie_data */
+	err = cookie_manager_set_treeview_field_data(&temp, data);
 	if (err != NSERROR_OK) {
 		return err;
 	}
 
+	if (cookie_manager_field_data_match(e->data, temp.data)) {
+		/* URL database pings the cookie manager whenever a cookie
+		 * is sent, so most updates change nothing visible */
+		cookie_manager_free_treeview_field_data(&temp);
+		return NSERROR_OK;
+	}
+
+	/* Replace the old field values */
+	e->user_delete = false;
+	cookie_manager_free_treeview_field_data(e);
+	memcpy(e->data, temp.data, sizeof(e->data));
+
 	/* Update the treeview */
 	err = treeview_update_node_entry(cm_ctx.tree, e->entry, e->data, e);
 	if (err != NSERROR_OK) {
@@ -476,10 +532,17 @@ bool cookie_manager_add(const struct cookie_data *data)
 	if (cm_ctx.tree == NULL)
 		return true;
 
-	err = cookie_manager_find_folder(NULL, data->domain,
-			strlen(data->domain), &parent);
-	if (err != NSERROR_OK) {
-		return false;
+	/* Try the folder the last update landed in before walking the
+	 * whole tree; bursts of updates tend to hit one domain */
+	parent = cm_ctx.last_folder;
+	if (parent == NULL ||
+			parent->data.value_len != strlen(data->domain) ||
+			strcmp(data->domain, parent->data.value) != 0) {
+		err = cookie_manager_find_folder(NULL, data->domain,
+				strlen(data->domain), &parent);
+		if (err != NSERROR_OK) {
+			return false;
+		}
 	}
 
 	if (parent == NULL) {
@@ -489,9 +552,12 @@ bool cookie_manager_add(const struct cookie_data *data)
 			return false;
 	}
 
+	cm_ctx.last_folder = parent;
+
 	/* Create cookie node */
 	err = cookie_manager_find_entry(parent->folder, data->name,
-			strlen(data->name), &cookie);
+			strlen(data->name), data->path, strlen(data->path),
+			&cookie);
 	if (err != NSERROR_OK)
 		return false;
 
@@ -520,15 +586,21 @@ void cookie_manager_remove(const struct cookie_data *data)
 	if (cm_ctx.tree == NULL)
 		return;
 
-	err = cookie_manager_find_folder(NULL, data->domain,
-			strlen(data->domain), &parent);
-	if (err != NSERROR_OK || parent == NULL) {
-		/* Nothing to delete */
-		return;
+	parent = cm_ctx.last_folder;
+	if (parent == NULL ||
+			parent->data.value_len != strlen(data->domain) ||
+			strcmp(data->domain, parent->data.value) != 0) {
+		err = cookie_manager_find_folder(NULL, data->domain,
+				strlen(data->domain), &parent);
+		if (err != NSERROR_OK || parent == NULL) {
+			/* Nothing to delete */
+			return;
+		}
 	}
 
 	err = cookie_manager_find_entry(parent->folder, data->name,
-			strlen(data->name), &cookie);
+			strlen(data->name), data->path, strlen(data->path),
+			&cookie);
 	if (err != NSERROR_OK || cookie == NULL) {
 		/* Nothing to delete */
 		return;
@@ -745,6 +817,8 @@ static nserror cookie_manager_tree_node_folder_cb(
 
 	switch (msg.msg) {
 	case TREE_MSG_NODE_DELETE:
+		if (cm_ctx.last_folder == f)
+			cm_ctx.last_folder = NULL;
 		free(f);
 		break;
 
@@ -855,6 +929,7 @@ nserror cookie_manager_fini(void)
 	/* Destroy the cookie manager treeview */
 	err = treeview_destroy(cm_ctx.tree);
 	cm_ctx.tree = NULL;
+	cm_ctx.last_folder = NULL;
 
 	/* Free cookie manager treeview entry fields */
 	for (i = 0; i < COOKIE_M_N_FIELDS; i++)
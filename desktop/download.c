@@ -22,12 +22,16 @@
  */
 
 #include <assert.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "content/fetch.h"
 #include "content/llcache.h"
 #include "utils/corestrings.h"
 #include "utils/http.h"
+#include "utils/nsoption.h"
+#include "utils/messages.h"
 #include "utils/utils.h"
 #include "utils/log.h"
 #include "desktop/download.h"
@@ -45,6 +49,12 @@ struct download_context {
 	unsigned long long int total_length;	/**< Length of data, in bytes */
 	char *filename;				/**< Suggested filename */
 
+	unsigned long long int received;	/**< Bytes delivered so far */
+	bool can_resume;	/**< Server advertised byte range support */
+	unsigned int retries;	/**< Resume attempts made */
+	struct fetch *resume_fetch;	/**< Active resume fetch, or NULL */
+	bool resume_validated;	/**< Resume response checked for 206 */
+
 	struct gui_download_window *window;	/**< GUI download window */
 };
 
@@ -114,6 +124,13 @@ static nserror download_context_process_headers(download_context *ctx)
 		length = strtoull(http_header, NULL, 10);
 	}
 
+	/* Note whether an interrupted transfer could be resumed */
+	http_header = llcache_handle_get_header(ctx->llcache, "Accept-Ranges");
+	if ((http_header != NULL) &&
+	    (strstr(http_header, "bytes") != NULL)) {
+		ctx->can_resume = true;
+	}
+
 	/* Retrieve and parse Content-Disposition */
 	http_header = llcache_handle_get_header(ctx->llcache, 
 			"Content-Disposition");
@@ -167,6 +184,134 @@ static nserror download_context_process_headers(download_context *ctx)
 	return NSERROR_OK;
 }
 
+/**
+ * Fetch callback used once a download context no longer wants events.
+ */
+static void download_fetch_ignore(const fetch_msg *msg, void *p)
+{
+}
+
+static bool download_attempt_resume(download_context *ctx);
+
+/**
+ * Callback for the fetch performing a ranged resume.
+ *
+ * \param msg  The fetch message
+ * \param p    Our context
+ */
+static void download_resume_callback(const fetch_msg *msg, void *p)
+{
+	download_context *ctx = p;
+	nserror error;
+
+	switch (msg->type) {
+	case FETCH_DATA:
+		if (ctx->resume_validated == false) {
+			/* A server ignoring the Range header restarts
+			 * from zero which would corrupt the output;
+			 * insist on a partial content response.
+			 */
+			if (fetch_http_code(ctx->resume_fetch) != 206) {
+				struct fetch *f = ctx->resume_fetch;
+
+				ctx->resume_fetch = NULL;
+				guit->download->error(ctx->window,
+						messages_get("FetchFailed"));
+				fetch_change_callback(f,
+						download_fetch_ignore, NULL);
+				fetch_abort(f);
+				break;
+			}
+			ctx->resume_validated = true;
+		}
+
+		ctx->received += msg->data.header_or_data.len;
+		error = guit->download->data(ctx->window,
+				(const char *)msg->data.header_or_data.buf,
+				msg->data.header_or_data.len);
+		if (error != NSERROR_OK) {
+			struct fetch *f = ctx->resume_fetch;
+
+			ctx->resume_fetch = NULL;
+			fetch_change_callback(f, download_fetch_ignore, NULL);
+			fetch_abort(f);
+		}
+		break;
+
+	case FETCH_FINISHED:
+		ctx->resume_fetch = NULL;
+		guit->download->done(ctx->window);
+		break;
+
+	case FETCH_ERROR:
+	case FETCH_SSL_ERR:
+	case FETCH_CERT_ERR:
+	case FETCH_TIMEDOUT:
+		ctx->resume_fetch = NULL;
+		if (download_attempt_resume(ctx) == false) {
+			guit->download->error(ctx->window,
+					(msg->type == FETCH_ERROR ||
+					 msg->type == FETCH_TIMEDOUT) ?
+						msg->data.error :
+						messages_get("FetchFailed"));
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+/**
+ * Restart an interrupted download from the current offset.
+ *
+ * Issues a fresh fetch carrying a Range header for the bytes not yet
+ * delivered to the frontend window.
+ *
+ * \param ctx  Context of the interrupted download
+ * \return true if a resume fetch was started else false
+ */
+static bool download_attempt_resume(download_context *ctx)
+{
+	char range[64];
+	const char *headers[2];
+	nserror error;
+
+	if ((ctx->can_resume == false) ||
+	    (ctx->window == NULL) ||
+	    (ctx->received == 0) ||
+	    (ctx->retries >= nsoption_uint(max_retried_fetches))) {
+		return false;
+	}
+	ctx->retries++;
+
+	snprintf(range, sizeof(range),
+		 "Range: bytes=%llu-", ctx->received);
+	headers[0] = range;
+	headers[1] = NULL;
+
+	ctx->resume_validated = false;
+	error = fetch_start(llcache_handle_get_url(ctx->llcache),
+			    NULL,
+			    download_resume_callback,
+			    ctx,
+			    false,
+			    NULL,
+			    NULL,
+			    true,
+			    false,
+			    headers,
+			    &ctx->resume_fetch);
+	if (error != NSERROR_OK) {
+		return false;
+	}
+
+	NSLOG(netsurf, INFO, "resuming download at offset %llu (retry %u)",
+	      ctx->received, ctx->retries);
+
+	return true;
+}
+
 /**
  * Callback for low-level cache events
  *
@@ -213,6 +358,8 @@ static nserror download_callback(llcache_handle *handle,
 					event->data.data.len);
 			if (error != NSERROR_OK)
 				llcache_handle_abort(handle);
+			else
+				ctx->received += event->data.data.len;
 		}
 
 		break;
@@ -227,10 +374,17 @@ static nserror download_callback(llcache_handle *handle,
 		break;
 
 	case LLCACHE_EVENT_ERROR:
-		if (ctx->window != NULL)
-			guit->download->error(ctx->window, event->data.error.msg);
-		else
+		if (ctx->window != NULL) {
+			/* Attempt to carry on from where the transfer
+			 * stopped before bothering the user.
+			 */
+			if (download_attempt_resume(ctx) == false) {
+				guit->download->error(ctx->window,
+						event->data.error.msg);
+			}
+		} else {
 			download_context_destroy(ctx);
+		}
 
 		break;
 
@@ -259,6 +413,11 @@ nserror download_context_create(llcache_handle *llcache,
 	ctx->mime_type = NULL;
 	ctx->total_length = 0;
 	ctx->filename = NULL;
+	ctx->received = 0;
+	ctx->can_resume = false;
+	ctx->retries = 0;
+	ctx->resume_fetch = NULL;
+	ctx->resume_validated = false;
 	ctx->window = NULL;
 
 	llcache_handle_change_callback(llcache, download_callback, ctx);
@@ -269,6 +428,13 @@ nserror download_context_create(llcache_handle *llcache,
 /* See download.h for documentation */
 void download_context_destroy(download_context *ctx)
 {
+	if (ctx->resume_fetch != NULL) {
+		fetch_change_callback(ctx->resume_fetch,
+				download_fetch_ignore, NULL);
+		fetch_abort(ctx->resume_fetch);
+		ctx->resume_fetch = NULL;
+	}
+
 	llcache_handle_release(ctx->llcache);
 
 	if (ctx->mime_type != NULL)
@@ -284,6 +450,13 @@ void download_context_destroy(download_context *ctx)
 /* See download.h for documentation */
 void download_context_abort(download_context *ctx)
 {
+	if (ctx->resume_fetch != NULL) {
+		fetch_change_callback(ctx->resume_fetch,
+				download_fetch_ignore, NULL);
+		fetch_abort(ctx->resume_fetch);
+		ctx->resume_fetch = NULL;
+	}
+
 	llcache_handle_abort(ctx->llcache);
 }
 
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Frame time budget monitor implementation.
+ */
+
+#include <stdint.h>
+#include <nsutils/time.h>
+
+#include "netsurf/inttypes.h"
+#include "utils/log.h"
+#include "utils/nsoption.h"
+#include "desktop/frame_budget.h"
+#include "desktop/perf_log.h"
+
+/** Names of the timed sections for attribution in logs */
+static const char *frame_budget_names[FRAME_BUDGET_SECTION_COUNT] = {
+	"fetch polling",
+	"layout",
+	"script execution",
+	"painting",
+};
+
+/** Entry time of each currently running section */
+static uint64_t frame_budget_start[FRAME_BUDGET_SECTION_COUNT];
+
+/** Number of budget overruns attributed to each section */
+static unsigned int frame_budget_overruns[FRAME_BUDGET_SECTION_COUNT];
+
+/** Longest run of each section in ms */
+static uint64_t frame_budget_worst[FRAME_BUDGET_SECTION_COUNT];
+
+/** Metric the elapsed time of each section is logged under */
+static const enum perf_log_metric
+frame_budget_metric[FRAME_BUDGET_SECTION_COUNT] = {
+	PERF_LOG_METRIC_COUNT, /* fetch polling is not charted */
+	PERF_LOG_LAYOUT,
+	PERF_LOG_SCRIPT,
+	PERF_LOG_PAINT,
+};
+
+
+/* exported interface documented in desktop/frame_budget.h */
+void frame_budget_enter(enum frame_budget_section section)
+{
+	if (section >= FRAME_BUDGET_SECTION_COUNT) {
+		return;
+	}
+
+	nsu_getmonotonic_ms(&frame_budget_start[section]);
+}
+
+
+/* exported interface documented in desktop/frame_budget.h */
+void frame_budget_leave(enum frame_budget_section section)
+{
+	uint64_t now;
+	uint64_t elapsed;
+	int budget;
+
+	if ((section >= FRAME_BUDGET_SECTION_COUNT) ||
+	    (frame_budget_start[section] == 0)) {
+		return;
+	}
+
+	nsu_getmonotonic_ms(&now);
+	elapsed = now - frame_budget_start[section];
+	frame_budget_start[section] = 0;
+
+	if (elapsed > frame_budget_worst[section]) {
+		frame_budget_worst[section] = elapsed;
+	}
+
+	if (frame_budget_metric[section] != PERF_LOG_METRIC_COUNT) {
+		perf_log_sample(frame_budget_metric[section], elapsed);
+	}
+
+	budget = nsoption_int(frame_time_budget);
+	if ((budget > 0) && (elapsed > (uint64_t)budget)) {
+		frame_budget_overruns[section]++;
+		NSLOG(netsurf, WARNING,
+		      "%s took %"PRIu64"ms, exceeding the %dms frame budget",
+		      frame_budget_names[section],
+		      elapsed,
+		      budget);
+	}
+}
+
+
+/* exported interface documented in desktop/frame_budget.h */
+void frame_budget_fini(void)
+{
+	int section;
+
+	for (section = 0; section < FRAME_BUDGET_SECTION_COUNT; section++) {
+		if (frame_budget_overruns[section] == 0) {
+			continue;
+		}
+		NSLOG(netsurf, INFO,
+		      "Frame budget overruns in %s: %u (worst %"PRIu64"ms)",
+		      frame_budget_names[section],
+		      frame_budget_overruns[section],
+		      frame_budget_worst[section]);
+	}
+}
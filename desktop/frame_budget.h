@@ -0,0 +1,69 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Frame time budget monitor interface.
+ *
+ * The frontends own the event loop, so the core cannot time a whole
+ * iteration directly; instead the subsystems doing significant work
+ * inside one (fetch polling, layout, script execution and painting)
+ * bracket themselves with enter/leave calls. A section which runs
+ * longer than the configured budget is logged with its attribution,
+ * identifying which subsystem caused a stutter without a profiler
+ * attached. Overruns are also counted per section and the totals
+ * reported at exit.
+ */
+
+#ifndef NETSURF_DESKTOP_FRAME_BUDGET_H_
+#define NETSURF_DESKTOP_FRAME_BUDGET_H_
+
+/**
+ * The subsystems timed against the frame budget
+ */
+enum frame_budget_section {
+	FRAME_BUDGET_FETCH, /**< fetcher polling */
+	FRAME_BUDGET_LAYOUT, /**< document reflow */
+	FRAME_BUDGET_SCRIPT, /**< javascript execution */
+	FRAME_BUDGET_PAINT, /**< window redraw */
+	FRAME_BUDGET_SECTION_COUNT /**< number of timed sections */
+};
+
+/**
+ * Mark entry to a timed section.
+ *
+ * \param section The section being entered
+ */
+void frame_budget_enter(enum frame_budget_section section);
+
+/**
+ * Mark exit from a timed section.
+ *
+ * Logs an attributed warning if the section exceeded the budget set
+ * by the frame_time_budget option.
+ *
+ * \param section The section being left
+ */
+void frame_budget_leave(enum frame_budget_section section);
+
+/**
+ * Log accumulated overrun counts.
+ */
+void frame_budget_fini(void);
+
+#endif
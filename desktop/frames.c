@@ -32,6 +32,8 @@
 #include "utils/log.h"
 #include "utils/utils.h"
 #include "netsurf/content.h"
+#include "netsurf/window.h"
+#include "netsurf/misc.h"
 #include "content/hlcache.h"
 #include "html/html.h"
 #include "html/box.h"
@@ -39,6 +41,7 @@
 
 #include "desktop/browser_private.h"
 #include "desktop/frames.h"
+#include "desktop/gui_internal.h"
 #include "desktop/scrollbar.h"
 
 /** maximum frame resize margin */
@@ -49,6 +52,118 @@ static bool browser_window_resolve_frame_dimension(struct browser_window *bw,
 		bool height);
 
 
+/**
+ * Repaint a core managed frame after its scrollbar has moved.
+ *
+ * Attempts to shift the unchanged overlap of the frame viewport with
+ * the frontend's scroll_area() operation so only the newly exposed
+ * strip and the scrollbar well need painting. Falls back to
+ * invalidating the whole viewport when the frontend cannot shift or
+ * the move is not a simple shift.
+ *
+ * \param bw The scrolled frame
+ * \param scrollbar_data The scrollbar MOVED message data
+ */
+static void browser_window_frame_scrolled(struct browser_window *bw,
+		struct scrollbar_msg_data *scrollbar_data)
+{
+	struct browser_window *top = browser_window_get_root(bw);
+	int delta = scrollbar_data->old_scroll_offset -
+			scrollbar_data->scroll_offset;
+	bool horizontal = scrollbar_is_horizontal(scrollbar_data->scrollbar);
+	int vis_width, vis_height;
+	int pos_x, pos_y;
+	int sx, sy;
+	struct rect rect;
+
+	/* the scrollbar wells are not moved by a scroll */
+	vis_width = bw->width -
+			((bw->scroll_y != NULL) ? SCROLLBAR_WIDTH : 0);
+	vis_height = bw->height -
+			((bw->scroll_x != NULL) ? SCROLLBAR_WIDTH : 0);
+
+	if (delta != 0 &&
+	    bw->scale == 1.0 && top->scale == 1.0 &&
+	    (horizontal ? (abs(delta) < vis_width) :
+			  (abs(delta) < vis_height))) {
+		sx = scrollbar_get_offset(bw->scroll_x);
+		sy = scrollbar_get_offset(bw->scroll_y);
+
+		/* the returned position is of the frame document
+		 * origin; the viewport origin is offset from it by
+		 * the scroll offsets */
+		browser_window_get_position(bw, true, &pos_x, &pos_y);
+		rect.x0 = pos_x + sx;
+		rect.y0 = pos_y + sy;
+		rect.x1 = rect.x0 + vis_width;
+		rect.y1 = rect.y0 + vis_height;
+
+		if (guit->window->scroll_area(top->window, &rect,
+					      horizontal ? delta : 0,
+					      horizontal ? 0 : delta) ==
+		    NSERROR_OK) {
+			struct rect strip;
+
+			/* newly exposed strip, frame document coordinates */
+			strip.x0 = sx;
+			strip.y0 = sy;
+			strip.x1 = sx + vis_width;
+			strip.y1 = sy + vis_height;
+			if (horizontal && delta < 0) {
+				strip.x0 = sx + vis_width + delta;
+			} else if (horizontal) {
+				strip.x1 = sx + delta;
+			} else if (delta < 0) {
+				strip.y0 = sy + vis_height + delta;
+			} else {
+				strip.y1 = sy + delta;
+			}
+			browser_window_invalidate_rect(bw, &strip);
+
+			/* the moved scrollbar needs redrawing too; only
+			 * the union of the old and new bar positions
+			 * changes, not the whole well */
+			if (scrollbar_get_moved_rect(scrollbar_data->scrollbar,
+					scrollbar_data->old_scroll_offset,
+					&strip)) {
+				if (horizontal) {
+					strip.x0 += sx;
+					strip.y0 = sy + bw->height -
+							SCROLLBAR_WIDTH;
+					strip.x1 += sx;
+					strip.y1 = sy + bw->height;
+				} else {
+					strip.x0 = sx + bw->width -
+							SCROLLBAR_WIDTH;
+					strip.y0 += sy;
+					strip.x1 = sx + bw->width;
+					strip.y1 += sy;
+				}
+			} else if (horizontal) {
+				strip.x0 = sx;
+				strip.y0 = sy + bw->height - SCROLLBAR_WIDTH;
+				strip.x1 = sx + bw->width;
+				strip.y1 = sy + bw->height;
+			} else {
+				strip.x0 = sx + bw->width - SCROLLBAR_WIDTH;
+				strip.y0 = sy;
+				strip.x1 = sx + bw->width;
+				strip.y1 = sy + bw->height;
+			}
+			browser_window_invalidate_rect(bw, &strip);
+			return;
+		}
+	}
+
+	/* shifting was not possible; repaint the whole viewport */
+	rect.x0 = scrollbar_get_offset(bw->scroll_x);
+	rect.y0 = scrollbar_get_offset(bw->scroll_y);
+	rect.x1 = rect.x0 + bw->width;
+	rect.y1 = rect.y0 + bw->height;
+
+	browser_window_invalidate_rect(bw, &rect);
+}
+
 /**
  * Callback for (i)frame scrollbars.
  */
@@ -62,14 +177,7 @@ void browser_window_scroll_callback(void *client_data,
 		if (bw->browser_window_type == BROWSER_WINDOW_IFRAME) {
 			html_redraw_a_box(bw->parent->current_content, bw->box);
 		} else {
-			struct rect rect;
-
-			rect.x0 = scrollbar_get_offset(bw->scroll_x);
-			rect.y0 = scrollbar_get_offset(bw->scroll_y);
-			rect.x1 = rect.x0 + bw->width;
-			rect.y1 = rect.y0 + bw->height;
-
-			browser_window_invalidate_rect(bw, &rect);
+			browser_window_frame_scrolled(bw, scrollbar_data);
 		}
 		break;
 	case SCROLLBAR_MSG_SCROLL_START:
@@ -709,6 +817,34 @@ nserror browser_window_create_frameset(struct browser_window *bw)
 
 
 
+/** Delay in ms before a scheduled frameset recalculation is performed */
+#define FRAMESET_RECALC_INTERVAL 40
+
+
+/**
+ * Scheduler callback performing a coalesced frameset recalculation.
+ *
+ * \param p The browser window owning the frameset
+ */
+static void browser_window__recalculate_frameset_cb(void *p)
+{
+	struct browser_window *bw = p;
+
+	bw->frameset_recalc_scheduled = false;
+
+	if (bw->current_content == NULL ||
+	    content_get_type(bw->current_content) != CONTENT_HTML) {
+		return;
+	}
+
+	if (html_get_frameset(bw->current_content) == NULL) {
+		return;
+	}
+
+	browser_window_recalculate_frameset_internal(bw);
+}
+
+
 /**
  * Recalculate frameset positions following a resize.
  *
@@ -725,10 +861,33 @@ void browser_window_recalculate_frameset(struct browser_window *bw)
 		return;
 	}
 
+	/* a live resize raises one reformat per motion event, each of
+	 * which cascades through every nested frameset; coalesce them
+	 * into one recalculation per interval */
+	if (bw->frameset_recalc_scheduled) {
+		return;
+	}
+
+	if (guit->misc->schedule(FRAMESET_RECALC_INTERVAL,
+				 browser_window__recalculate_frameset_cb,
+				 bw) == NSERROR_OK) {
+		bw->frameset_recalc_scheduled = true;
+		return;
+	}
+
+	/* scheduling failed; recalculate immediately */
 	browser_window_recalculate_frameset_internal(bw);
 }
 
 
+/* exported interface documented in desktop/frames.h */
+void browser_window_cancel_frameset_recalc(struct browser_window *bw)
+{
+	guit->misc->schedule(-1, browser_window__recalculate_frameset_cb, bw);
+	bw->frameset_recalc_scheduled = false;
+}
+
+
 /**
  * Resize a browser window that is a frame.
  *
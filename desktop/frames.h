@@ -67,6 +67,14 @@ nserror browser_window_destroy_iframes(struct browser_window *bw);
 nserror browser_window_create_frameset(struct browser_window *bw);
 
 void browser_window_recalculate_frameset(struct browser_window *bw);
+
+/**
+ * Cancel any scheduled frameset recalculation for a browser window.
+ *
+ * \param bw The browser window being destroyed
+ */
+void browser_window_cancel_frameset_recalc(struct browser_window *bw);
+
 bool browser_window_frame_resize_start(struct browser_window *bw,
 		browser_mouse_state mouse, int x, int y,
 		browser_pointer_shape *pointer);
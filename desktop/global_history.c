@@ -30,12 +30,17 @@
 #include "content/urldb.h"
 
 #include "desktop/global_history.h"
+#include "desktop/gui_internal.h"
 #include "desktop/treeview.h"
 #include "netsurf/browser_window.h"
+#include "netsurf/misc.h"
 
 #define N_DAYS 28
 #define N_SEC_PER_DAY (60 * 60 * 24)
 
+/** Number of entries added to the treeview per scheduler callback */
+#define GH_BUILD_BATCH 128
+
 enum global_history_folders {
 	GH_TODAY = 0,
 	GH_YESTERDAY,
@@ -71,6 +76,11 @@ struct global_history_ctx {
 	time_t today;
 	int weekday;
 	bool built;
+
+	/** Slot the progressive treeview build has reached */
+	int build_slot;
+	/** Next entry the progressive treeview build will insert */
+	struct global_history_entry *build_next;
 };
 struct global_history_ctx gh_ctx;
 
@@ -502,9 +512,18 @@ static bool global_history_add_entry(nsurl *url,
 		/* Delete any existing entry for this URL */
 		e = global_history_find(url);
 		if (e != NULL) {
-			treeview_delete_node(gh_ctx.tree, e->entry,
-					TREE_OPTION_SUPPRESS_REDRAW |
-					TREE_OPTION_SUPPRESS_RESIZE);
+			if (e->entry != NULL) {
+				treeview_delete_node(gh_ctx.tree, e->entry,
+						TREE_OPTION_SUPPRESS_REDRAW |
+						TREE_OPTION_SUPPRESS_RESIZE);
+			} else {
+				/* Not yet added by the progressive build;
+				 * keep the build cursor valid */
+				if (gh_ctx.build_next == e) {
+					gh_ctx.build_next = e->prev;
+				}
+				global_history_delete_entry_internal(e);
+			}
 		}
 	}
 
@@ -623,37 +642,71 @@ static nserror global_history_initialise_time(void)
 
 
 /**
- * Initialise the treeview entries
+ * Scheduler callback progressively filling the treeview with entries.
  *
- * \return NSERROR_OK on success, or appropriate error otherwise
+ * Each slot's list is kept sorted by visit time, so entries are
+ * inserted oldest first, a batch per callback, leaving the window
+ * responsive while a large history is added.
+ *
+ * \param p unused
  */
-static nserror global_history_init_entries(void)
+static void global_history_build_cb(void *p)
 {
-	int i;
+	int budget = GH_BUILD_BATCH;
 	nserror err;
 
-	/* Itterate over all global history data, inserting it into treeview */
-	for (i = 0; i < N_DAYS; i++) {
-		struct global_history_entry *l = NULL;
-		struct global_history_entry *e = gh_list[i];
+	while (true) {
+		struct global_history_entry *e = gh_ctx.build_next;
 
-		/* Insert in reverse order; find last */
-		while (e != NULL) {
-			l = e;
-			e = e->next;
+		if (e == NULL) {
+			/* move on to the next slot with entries */
+			int slot = gh_ctx.build_slot + 1;
+
+			while (slot < N_DAYS && gh_list[slot] == NULL) {
+				slot++;
+			}
+			gh_ctx.build_slot = slot;
+			if (slot >= N_DAYS) {
+				/* all slots done */
+				break;
+			}
+
+			/* Insert in reverse order; find last */
+			e = gh_list[slot];
+			while (e->next != NULL) {
+				e = e->next;
+			}
+			gh_ctx.build_next = e;
+			continue;
+		}
+
+		if (budget <= 0) {
+			if (guit->misc->schedule(0, global_history_build_cb,
+					&gh_ctx) == NSERROR_OK) {
+				return;
+			}
+			/* can't defer; carry on building now */
+			budget = GH_BUILD_BATCH;
 		}
 
-		/* Insert the entries into the treeview */
-		while (l != NULL) {
-			err = global_history_entry_insert(l, i);
+		gh_ctx.build_next = e->prev;
+
+		if (e->entry == NULL) {
+			/* entries visited during the build are already in */
+			err = global_history_entry_insert(e, e->slot);
 			if (err != NSERROR_OK) {
-				return err;
+				NSLOG(netsurf, INFO,
+				      "Aborting global history build");
+				break;
 			}
-			l = l->prev;
+			budget--;
 		}
 	}
 
-	return NSERROR_OK;
+	/* Inform client of window height */
+	treeview_get_height(gh_ctx.tree);
+
+	NSLOG(netsurf, INFO, "Loaded global history");
 }
 
 
@@ -768,12 +821,6 @@ nserror global_history_init(void *core_window_handle)
 		return err;
 	}
 
-	/* Add the history to the treeview */
-	err = global_history_init_entries();
-	if (err != NSERROR_OK) {
-		return err;
-	}
-
 	/* Expand the "Today" folder node */
 	err = treeview_node_expand(gh_ctx.tree,
 			gh_ctx.folders[GH_TODAY].folder);
@@ -781,15 +828,17 @@ nserror global_history_init(void *core_window_handle)
 		return err;
 	}
 
-	/* History tree is built
-	 * We suppress the treeview height callback on entry insertion before
-	 * the treeview is built. */
+	/* History tree exists; entries are filled in progressively
+	 * from the scheduler so the window appears at once. */
 	gh_ctx.built = true;
 
-	/* Inform client of window height */
-	treeview_get_height(gh_ctx.tree);
-
-	NSLOG(netsurf, INFO, "Loaded global history");
+	gh_ctx.build_slot = -1;
+	gh_ctx.build_next = NULL;
+	if (guit->misc->schedule(0, global_history_build_cb,
+			&gh_ctx) != NSERROR_OK) {
+		/* no scheduler; build in one go */
+		global_history_build_cb(&gh_ctx);
+	}
 
 	return NSERROR_OK;
 }
@@ -803,6 +852,10 @@ nserror global_history_fini(void)
 
 	NSLOG(netsurf, INFO, "Finalising global history");
 
+	/* Stop any outstanding progressive build */
+	guit->misc->schedule(-1, global_history_build_cb, &gh_ctx);
+	gh_ctx.build_next = NULL;
+
 	gh_ctx.built = false;
 
 	/* Destroy the global history treeview */
@@ -116,6 +116,13 @@ static void gui_default_window_drag_save_selection(struct gui_window *g,
 {
 }
 
+static nserror gui_default_window_scroll_area(struct gui_window *g,
+					      const struct rect *rect,
+					      int dx, int dy)
+{
+	return NSERROR_NOT_IMPLEMENTED;
+}
+
 
 static void
 gui_default_console_log(struct gui_window *gw,
@@ -197,6 +204,9 @@ static nserror verify_window_register(struct gui_window_table *gwt)
 	if (gwt->drag_save_selection == NULL) {
 		gwt->drag_save_selection = gui_default_window_drag_save_selection;
 	}
+	if (gwt->scroll_area == NULL) {
+		gwt->scroll_area = gui_default_window_scroll_area;
+	}
 	if (gwt->console_log == NULL) {
 		gwt->console_log = gui_default_console_log;
 	}
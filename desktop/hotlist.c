@@ -32,6 +32,7 @@
 #include "utils/libdom.h"
 #include "utils/log.h"
 #include "utils/nsurl.h"
+#include "utils/hashmap.h"
 #include "content/urldb.h"
 
 #include "netsurf/misc.h"
@@ -64,6 +65,8 @@ struct hotlist_ctx {
 	struct hotlist_folder *default_folder;
 	char *save_path;
 	bool save_scheduled;
+	/** Index over entry urls, or NULL to fall back to tree walks */
+	hashmap_t *url_index;
 };
 struct hotlist_ctx hl_ctx;
 
@@ -75,6 +78,82 @@ struct hotlist_entry {
 };
 
 
+/** Value in the hotlist url index: entries may share a url */
+struct hotlist_index_value {
+	unsigned int count;
+};
+
+static bool hotlist_index_key_eq(void *key1, void *key2)
+{
+	return nsurl_compare((nsurl *)key1, (nsurl *)key2, NSURL_COMPLETE);
+}
+
+static void *hotlist_index_value_alloc(void *key)
+{
+	return calloc(1, sizeof(struct hotlist_index_value));
+}
+
+static void hotlist_index_value_destroy(void *value)
+{
+	free(value);
+}
+
+static hashmap_parameters_t hotlist_index_parameters = {
+	.key_clone = (hashmap_key_clone_t)nsurl_ref,
+	.key_destroy = (hashmap_key_destroy_t)nsurl_unref,
+	.key_hash = (hashmap_key_hash_t)nsurl_hash,
+	.key_eq = hotlist_index_key_eq,
+	.value_alloc = hotlist_index_value_alloc,
+	.value_destroy = hotlist_index_value_destroy,
+};
+
+
+/**
+ * Account for an entry url added to the hotlist
+ *
+ * On allocation failure the index is dropped and lookups fall back
+ * to walking the treeview.
+ *
+ * \param url URL of the added entry
+ */
+static void hotlist_url_index_add(nsurl *url)
+{
+	struct hotlist_index_value *v;
+
+	if (hl_ctx.url_index == NULL)
+		return;
+
+	v = hashmap_lookup(hl_ctx.url_index, url);
+	if (v == NULL) {
+		v = hashmap_insert(hl_ctx.url_index, url);
+		if (v == NULL) {
+			hashmap_destroy(hl_ctx.url_index);
+			hl_ctx.url_index = NULL;
+			return;
+		}
+	}
+	v->count++;
+}
+
+
+/**
+ * Account for an entry url removed from the hotlist
+ *
+ * \param url URL of the removed entry
+ */
+static void hotlist_url_index_remove(nsurl *url)
+{
+	struct hotlist_index_value *v;
+
+	if (hl_ctx.url_index == NULL)
+		return;
+
+	v = hashmap_lookup(hl_ctx.url_index, url);
+	if (v != NULL && --v->count == 0)
+		hashmap_remove(hl_ctx.url_index, url);
+}
+
+
 /*
  * Get path for writing hotlist to
  *
@@ -309,6 +388,8 @@ static nserror hotlist_entry_insert(struct hotlist_entry *e,
 		return err;
 	}
 
+	hotlist_url_index_add(e->url);
+
 	return NSERROR_OK;
 }
 
@@ -546,6 +627,7 @@ hotlist_tree_node_entry_cb(struct treeview_node_msg msg, void *data)
 
 	switch (msg.msg) {
 	case TREE_MSG_NODE_DELETE:
+		hotlist_url_index_remove(e->url);
 		e->entry = NULL;
 		hotlist_delete_entry_internal(e);
 
@@ -591,6 +673,8 @@ hotlist_tree_node_entry_cb(struct treeview_node_msg msg, void *data)
 
 				treeview_update_node_entry(hl_ctx.tree,
 						   e->entry, e->data, e);
+				hotlist_url_index_remove(old_url);
+				hotlist_url_index_add(url);
 				nsurl_unref(old_url);
 
 				err = hotlist_schedule_save();
@@ -1303,6 +1387,7 @@ nserror hotlist_init(
 	hl_ctx.tree = NULL;
 	hl_ctx.built = false;
 	hl_ctx.default_folder = NULL;
+	hl_ctx.url_index = NULL;
 
 	/* Store the save path */
 	if (save_path != NULL) {
@@ -1332,6 +1417,10 @@ nserror hotlist_init(
 		return err;
 	}
 
+	/* Create the entry url index; lookups fall back to walking
+	 * the treeview without it */
+	hl_ctx.url_index = hashmap_create(&hotlist_index_parameters);
+
 	/* Populate the hotlist */
 	err = hotlist_populate(load_path);
 	if (err != NSERROR_OK) {
@@ -1410,6 +1499,12 @@ nserror hotlist_fini(void)
 	}
 	hl_ctx.built = false;
 
+	/* Destroy the entry url index */
+	if (hl_ctx.url_index != NULL) {
+		hashmap_destroy(hl_ctx.url_index);
+		hl_ctx.url_index = NULL;
+	}
+
 	/* Free hotlist treeview entry fields */
 	for (i = 0; i < HL_N_FIELDS; i++)
 		if (hl_ctx.fields[i].field != NULL)
@@ -1501,6 +1596,11 @@ bool hotlist_has_url(nsurl *url)
 	if (hl_ctx.built == false)
 		return false;
 
+	if (hl_ctx.url_index != NULL) {
+		return hashmap_lookup(hl_ctx.url_index, url) != NULL;
+	}
+
+	/* Index unavailable; fall back to walking the treeview */
 	err = treeview_walk(hl_ctx.tree, NULL, hotlist_has_url_walk_cb, NULL,
 			&tw, TREE_NODE_ENTRY);
 	if (err != NSERROR_OK)
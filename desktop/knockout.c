@@ -70,6 +70,7 @@
 #include "utils/utils.h"
 #include "utils/log.h"
 #include "utils/errors.h"
+#include "utils/trace.h"
 #include "netsurf/bitmap.h"
 #include "content/content.h"
 #include "netsurf/plotters.h"
@@ -83,6 +84,8 @@
 #define KNOCKOUT_ENTRIES 3072	/* 40 bytes each */
 #define KNOCKOUT_BOXES 768	/* 28 bytes each */
 #define KNOCKOUT_POLYGONS 3072	/* 4 bytes each */
+#define KNOCKOUT_PATHS 4096	/* 4 bytes each */
+#define KNOCKOUT_QUADS 256	/* 40 bytes each */
 
 struct knockout_box;
 struct knockout_entry;
@@ -90,7 +93,8 @@ struct knockout_entry;
 typedef enum {
 	KNOCKOUT_PLOT_RECTANGLE,
 	KNOCKOUT_PLOT_LINE,
-	KNOCKOUT_PLOT_POLYGON,
+	KNOCKOUT_PLOT_POLYGON,		/* knocked out */
+	KNOCKOUT_PLOT_PATH,		/* knocked out */
 	KNOCKOUT_PLOT_FILL,		/* knockout, knocked out */
 	KNOCKOUT_PLOT_CLIP,
 	KNOCKOUT_PLOT_TEXT,
@@ -127,6 +131,12 @@ struct knockout_entry {
 			unsigned int n;
 			plot_style_t plot_style;
 		} polygon;
+		struct {
+			float *p;
+			unsigned int n;
+			float transform[6];
+			plot_style_t plot_style;
+		} path;
 		struct {
 			struct rect r;
 			plot_style_t plot_style;
@@ -169,13 +179,33 @@ struct knockout_entry {
 };
 
 
+/**
+ * Quadtree node indexing the top level knockout boxes.
+ *
+ * Each node covers a rectangle of the plot area and holds the boxes
+ * which straddle its centre lines; boxes wholly within one quadrant
+ * are pushed down into a child node. Knocking out a rectangle then
+ * only visits the nodes it overlaps rather than every box plotted so
+ * far.
+ */
+struct knockout_quad {
+	struct rect bbox;
+	struct knockout_box *boxes;	/* boxes stored at this node */
+	int child[4];			/* quadrant node indexes, -1 if none */
+};
+
+
 static struct knockout_entry knockout_entries[KNOCKOUT_ENTRIES];
 static struct knockout_box knockout_boxes[KNOCKOUT_BOXES];
 static int knockout_polygons[KNOCKOUT_POLYGONS];
+static float knockout_paths[KNOCKOUT_PATHS];
+static struct knockout_quad knockout_quads[KNOCKOUT_QUADS];
 static int knockout_entry_cur = 0;
 static int knockout_box_cur = 0;
 static int knockout_polygon_cur = 0;
-static struct knockout_box *knockout_list = NULL;
+static int knockout_path_cur = 0;
+static int knockout_quad_cur = 0;
+static int knockout_quad_root = -1;
 
 static struct plotter_table real_plot;
 
@@ -183,6 +213,93 @@ static struct rect clip_cur;
 static int nested_depth = 0;
 
 
+/** Rectangles pending a single batched rectangles() plot */
+static struct rect knockout_batch[KNOCKOUT_BOXES];
+static unsigned int knockout_batch_cur = 0;
+
+
+/**
+ * determine if two knockout fill styles plot identically
+ *
+ * Fill entries always have their stroke disabled, so the fill type
+ * and colour alone identify the plotted style.
+ */
+static bool
+knockout_fill_style_eq(const plot_style_t *a, const plot_style_t *b)
+{
+	return (a->fill_type == b->fill_type) &&
+	       (a->fill_colour == b->fill_colour);
+}
+
+
+/**
+ * emit the pending rectangle batch with a single plot call
+ */
+static nserror
+knockout_batch_emit(const struct redraw_context *ctx,
+		    const plot_style_t *plot_style)
+{
+	nserror res = NSERROR_OK;
+
+	if (knockout_batch_cur > 0) {
+		res = real_plot.rectangles(ctx, plot_style,
+					   knockout_batch,
+					   knockout_batch_cur);
+		knockout_batch_cur = 0;
+	}
+	return res;
+}
+
+
+/**
+ * append a rectangle to the batch, emitting first if it is full
+ */
+static nserror
+knockout_batch_add(const struct redraw_context *ctx,
+		   const struct rect *r,
+		   const plot_style_t *plot_style)
+{
+	nserror res = NSERROR_OK;
+
+	if (knockout_batch_cur == KNOCKOUT_BOXES) {
+		res = knockout_batch_emit(ctx, plot_style);
+	}
+	knockout_batch[knockout_batch_cur++] = *r;
+	return res;
+}
+
+
+/**
+ * append the undeleted leaf boxes of a knockout list to the batch
+ */
+static nserror
+knockout_batch_boxes(const struct redraw_context *ctx,
+		     struct knockout_box *box,
+		     const plot_style_t *plot_style)
+{
+	struct knockout_box *parent;
+	nserror res;
+	nserror ffres = NSERROR_OK; /* first failing result */
+
+	for (parent = box; parent; parent = parent->next) {
+		if (parent->deleted)
+			continue;
+		if (parent->child) {
+			res = knockout_batch_boxes(ctx, parent->child,
+						   plot_style);
+		} else {
+			res = knockout_batch_add(ctx, &parent->bbox,
+						 plot_style);
+		}
+		/* remember the first error */
+		if ((res != NSERROR_OK) && (ffres == NSERROR_OK)) {
+			ffres = res;
+		}
+	}
+	return ffres;
+}
+
+
 /**
  * fill an area recursively
  */
@@ -265,6 +382,8 @@ static nserror knockout_plot_flush(const struct redraw_context *ctx)
 	nserror res = NSERROR_OK; /* operation result */
 	nserror ffres = NSERROR_OK; /* first failing result */
 
+	NSTRACE(NSTRACE_PLOT, "knockout_flush", knockout_entry_cur);
+
 	/* debugging information */
 #ifdef KNOCKOUT_DEBUG
 	NSLOG(netsurf, INFO, "Entries are %i/%i, %i/%i, %i/%i",
@@ -287,13 +406,71 @@ static nserror knockout_plot_flush(const struct redraw_context *ctx)
 			break;
 
 		case KNOCKOUT_PLOT_POLYGON:
+			/* completely covered by later plots; skip */
+			if (knockout_entries[i].box != NULL &&
+					knockout_entries[i].box->deleted) {
+				res = NSERROR_OK;
+				break;
+			}
 			res = real_plot.polygon(ctx,
 				&knockout_entries[i].data.polygon.plot_style,
 				knockout_entries[i].data.polygon.p,
 				knockout_entries[i].data.polygon.n);
 			break;
 
+		case KNOCKOUT_PLOT_PATH:
+			/* completely covered by later plots; skip */
+			if (knockout_entries[i].box != NULL &&
+					knockout_entries[i].box->deleted) {
+				res = NSERROR_OK;
+				break;
+			}
+			res = real_plot.path(ctx,
+				&knockout_entries[i].data.path.plot_style,
+				knockout_entries[i].data.path.p,
+				knockout_entries[i].data.path.n,
+				knockout_entries[i].data.path.transform);
+			break;
+
 		case KNOCKOUT_PLOT_FILL:
+			if (real_plot.rectangles != NULL) {
+				plot_style_t *fstyle =
+					&knockout_entries[i].data.fill.plot_style;
+				nserror bres;
+
+				/* aggregate the run of fills sharing this
+				 * style into one batched plot */
+				res = NSERROR_OK;
+				do {
+					box = knockout_entries[i].box->child;
+					if (box) {
+						bres = knockout_batch_boxes(
+							ctx, box, fstyle);
+					} else if (!knockout_entries[i].box->deleted) {
+						bres = knockout_batch_add(ctx,
+						  &knockout_entries[i].data.fill.r,
+						  fstyle);
+					} else {
+						bres = NSERROR_OK;
+					}
+					if ((bres != NSERROR_OK) &&
+					    (res == NSERROR_OK)) {
+						res = bres;
+					}
+					i++;
+				} while ((i < knockout_entry_cur) &&
+					 (knockout_entries[i].type ==
+							KNOCKOUT_PLOT_FILL) &&
+					 knockout_fill_style_eq(fstyle,
+					  &knockout_entries[i].data.fill.plot_style));
+				i--;
+				bres = knockout_batch_emit(ctx, fstyle);
+				if ((bres != NSERROR_OK) &&
+				    (res == NSERROR_OK)) {
+					res = bres;
+				}
+				break;
+			}
 			box = knockout_entries[i].box->child;
 			if (box) {
 				res = knockout_plot_fill_recursive(ctx,
@@ -374,54 +551,47 @@ static nserror knockout_plot_flush(const struct redraw_context *ctx)
 	knockout_entry_cur = 0;
 	knockout_box_cur = 0;
 	knockout_polygon_cur = 0;
-	knockout_list = NULL;
+	knockout_path_cur = 0;
+	knockout_quad_cur = 0;
+	knockout_quad_root = -1;
 
 	return ffres;
 }
 
 
 /**
- * Knockout a section of previous rendering
+ * Knockout a section of previous rendering from a box list
  *
  * \param ctx The current redraw context.
  * \param x0    The left edge of the removal box
  * \param y0    The bottom edge of the removal box
  * \param x1    The right edge of the removal box
  * \param y1    The top edge of the removal box
- * \param owner The parent box set to consider, or NULL for top level
+ * \param head  The head of the box list to consider
+ * \param owner The parent box of the list, or NULL for a quadtree node list
  */
 static void
 knockout_calculate(const struct redraw_context *ctx,
 		   int x0, int y0, int x1, int y1,
+		   struct knockout_box **head,
 		   struct knockout_box *owner)
 {
-	struct knockout_box *box;
 	struct knockout_box *parent;
 	struct knockout_box *prev = NULL;
 	int nx0, ny0, nx1, ny1;
 
-	if (owner == NULL)
-		box = knockout_list;
-	else
-		box = owner->child;
-
-	for (parent = box; parent; parent = parent->next) {
+	for (parent = *head; parent; parent = parent->next) {
 		/* permanently delink deleted nodes */
 		if (parent->deleted) {
 			if (prev) {
 				/* not the first valid element: just skip future */
 				prev->next = parent->next;
 			} else {
-				if (owner) {
-					/* first valid element: update child reference */
-					owner->child = parent->next;
-					/* have we deleted all child nodes? */
-					if (!owner->child)
-						owner->deleted = true;
-				} else {
-					/* we are the head of the list */
-					knockout_list = parent->next;
-				}
+				/* first valid element: update the list head */
+				*head = parent->next;
+				/* have we deleted all child nodes? */
+				if (owner && !owner->child)
+					owner->deleted = true;
 			}
 			continue;
 		} else {
@@ -446,7 +616,8 @@ knockout_calculate(const struct redraw_context *ctx,
 
 		/* has the box been replaced by children? */
 		if (parent->child) {
-			knockout_calculate(ctx, x0, y0, x1, y1, parent);
+			knockout_calculate(ctx, x0, y0, x1, y1,
+					   &parent->child, parent);
 		} else {
 			/* we need a maximum of 4 child boxes */
 			if (knockout_box_cur + 4 >= KNOCKOUT_BOXES) {
@@ -509,6 +680,128 @@ knockout_calculate(const struct redraw_context *ctx,
 }
 
 
+/**
+ * Insert a top level box into the quadtree index
+ *
+ * The box is pushed down to the smallest node which wholly contains
+ * it, creating nodes on demand. Boxes which straddle a centre line,
+ * lie outside the root area or arrive once the node pool is
+ * exhausted stay at the deepest node reached, degrading towards a
+ * single list rather than failing.
+ *
+ * \param box The box to index; its bounding box must already be set
+ */
+static void knockout_quad_insert(struct knockout_box *box)
+{
+	struct knockout_quad *quad;
+	int mx, my, quadrant;
+
+	if (knockout_quad_root == -1) {
+		/* first box of the session; the current clip is the
+		 * area being plotted into */
+		knockout_quad_root = knockout_quad_cur++;
+		quad = &knockout_quads[knockout_quad_root];
+		quad->bbox = clip_cur;
+		quad->boxes = NULL;
+		quad->child[0] = quad->child[1] = -1;
+		quad->child[2] = quad->child[3] = -1;
+	}
+
+	quad = &knockout_quads[knockout_quad_root];
+
+	/* boxes outside the root area can never descend safely */
+	if ((box->bbox.x0 < quad->bbox.x0) || (box->bbox.x1 > quad->bbox.x1) ||
+	    (box->bbox.y0 < quad->bbox.y0) || (box->bbox.y1 > quad->bbox.y1)) {
+		box->next = quad->boxes;
+		quad->boxes = box;
+		return;
+	}
+
+	while (knockout_quad_cur < KNOCKOUT_QUADS) {
+		mx = (quad->bbox.x0 + quad->bbox.x1) / 2;
+		my = (quad->bbox.y0 + quad->bbox.y1) / 2;
+
+		/* stop at this node if the box straddles a centre line */
+		if (box->bbox.x1 <= mx)
+			quadrant = 0;
+		else if (box->bbox.x0 >= mx)
+			quadrant = 1;
+		else
+			break;
+		if (box->bbox.y1 <= my)
+			;
+		else if (box->bbox.y0 >= my)
+			quadrant += 2;
+		else
+			break;
+
+		if (quad->child[quadrant] == -1) {
+			struct knockout_quad *child;
+
+			quad->child[quadrant] = knockout_quad_cur++;
+			child = &knockout_quads[quad->child[quadrant]];
+			child->bbox.x0 = (quadrant & 1) ? mx : quad->bbox.x0;
+			child->bbox.x1 = (quadrant & 1) ? quad->bbox.x1 : mx;
+			child->bbox.y0 = (quadrant & 2) ? my : quad->bbox.y0;
+			child->bbox.y1 = (quadrant & 2) ? quad->bbox.y1 : my;
+			child->boxes = NULL;
+			child->child[0] = child->child[1] = -1;
+			child->child[2] = child->child[3] = -1;
+		}
+		quad = &knockout_quads[quad->child[quadrant]];
+	}
+
+	box->next = quad->boxes;
+	quad->boxes = box;
+}
+
+
+/**
+ * Knockout a section of previous rendering via the quadtree index
+ *
+ * Only quadtree nodes overlapping the removal box are visited, so the
+ * cost scales with the area affected rather than with every box
+ * plotted so far.
+ *
+ * \param ctx The current redraw context.
+ * \param x0   The left edge of the removal box
+ * \param y0   The bottom edge of the removal box
+ * \param x1   The right edge of the removal box
+ * \param y1   The top edge of the removal box
+ * \param quad The index of the quadtree node to consider
+ */
+static void
+knockout_calculate_quad(const struct redraw_context *ctx,
+			int x0, int y0, int x1, int y1,
+			int quad)
+{
+	struct rect *cbox;
+	int child;
+	int i;
+
+	knockout_calculate(ctx, x0, y0, x1, y1,
+			   &knockout_quads[quad].boxes, NULL);
+
+	for (i = 0; i != 4; i++) {
+		/* the box pool may have run out and flushed everything */
+		if (knockout_quad_root == -1)
+			return;
+
+		child = knockout_quads[quad].child[i];
+		if (child == -1)
+			continue;
+
+		/* reject non-overlapping quadrants */
+		cbox = &knockout_quads[child].bbox;
+		if ((cbox->x0 >= x1) || (cbox->x1 <= x0) ||
+		    (cbox->y0 >= y1) || (cbox->y1 <= y0))
+			continue;
+
+		knockout_calculate_quad(ctx, x0, y0, x1, y1, child);
+	}
+}
+
+
 /**
  * knockout rectangle plotting.
  *
@@ -544,12 +837,13 @@ knockout_plot_rectangle(const struct redraw_context *ctx,
 		}
 
 		/* fills both knock out and get knocked out */
-		knockout_calculate(ctx, kx0, ky0, kx1, ky1, NULL);
+		if (knockout_quad_root != -1)
+			knockout_calculate_quad(ctx, kx0, ky0, kx1, ky1,
+						knockout_quad_root);
 		knockout_boxes[knockout_box_cur].bbox = *rect;
 		knockout_boxes[knockout_box_cur].deleted = false;
 		knockout_boxes[knockout_box_cur].child = NULL;
-		knockout_boxes[knockout_box_cur].next = knockout_list;
-		knockout_list = &knockout_boxes[knockout_box_cur];
+		knockout_quad_insert(&knockout_boxes[knockout_box_cur]);
 		knockout_entries[knockout_entry_cur].box = &knockout_boxes[knockout_box_cur];
 		knockout_entries[knockout_entry_cur].data.fill.r = *rect;
 		knockout_entries[knockout_entry_cur].data.fill.plot_style = *pstyle;
@@ -602,6 +896,163 @@ knockout_plot_line(const struct redraw_context *ctx,
 }
 
 
+/**
+ * Register a passive bounding box against the current entry.
+ *
+ * The box is indexed so later opaque plots can knock the entry out
+ * entirely, but unlike fills and opaque bitmaps it never knocks out
+ * anything beneath it: the entry does not cover its bounding box
+ * completely. The box pool cursor is advanced by the caller alongside
+ * the entry cursor.
+ *
+ * \param bbox The bounding box of the entry, already clipped
+ */
+static void knockout_plot_passive_box(const struct rect *bbox)
+{
+	knockout_boxes[knockout_box_cur].bbox = *bbox;
+	knockout_boxes[knockout_box_cur].deleted = false;
+	knockout_boxes[knockout_box_cur].child = NULL;
+	knockout_quad_insert(&knockout_boxes[knockout_box_cur]);
+	knockout_entries[knockout_entry_cur].box =
+			&knockout_boxes[knockout_box_cur];
+}
+
+
+/**
+ * Calculate the clipped bounding box of a polygon.
+ *
+ * \param p verticies of polygon
+ * \param n number of verticies
+ * \param bbox Updated to the bounding box clipped to the current clip
+ * \return true if the box is not empty, false if nothing is visible
+ */
+static bool
+knockout_polygon_bounds(const int *p, unsigned int n, struct rect *bbox)
+{
+	unsigned int i;
+
+	bbox->x0 = bbox->x1 = p[0];
+	bbox->y0 = bbox->y1 = p[1];
+	for (i = 1; i < n; i++) {
+		if (p[i * 2] < bbox->x0)
+			bbox->x0 = p[i * 2];
+		if (p[i * 2] > bbox->x1)
+			bbox->x1 = p[i * 2];
+		if (p[i * 2 + 1] < bbox->y0)
+			bbox->y0 = p[i * 2 + 1];
+		if (p[i * 2 + 1] > bbox->y1)
+			bbox->y1 = p[i * 2 + 1];
+	}
+
+	if (bbox->x0 < clip_cur.x0)
+		bbox->x0 = clip_cur.x0;
+	if (bbox->y0 < clip_cur.y0)
+		bbox->y0 = clip_cur.y0;
+	if (bbox->x1 > clip_cur.x1)
+		bbox->x1 = clip_cur.x1;
+	if (bbox->y1 > clip_cur.y1)
+		bbox->y1 = clip_cur.y1;
+
+	return (bbox->x0 < bbox->x1) && (bbox->y0 < bbox->y1);
+}
+
+
+/**
+ * Calculate the clipped bounding box of a path.
+ *
+ * The control points are run through the path transform and the
+ * result inflated by the stroke width, so the box covers everything
+ * the path can touch; bezier control points make it conservative.
+ *
+ * \param pstyle Style controlling the path plot
+ * \param p elements of path
+ * \param n number of elements on path
+ * \param transform The transform applied to the path
+ * \param bbox Updated to the bounding box clipped to the current clip
+ * \param visible Updated to whether any of the box survives the clip
+ * \return true if bounds were computed, false if the path is malformed
+ */
+static bool
+knockout_path_bounds(const plot_style_t *pstyle,
+		     const float *p,
+		     unsigned int n,
+		     const float transform[6],
+		     struct rect *bbox,
+		     bool *visible)
+{
+	float x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+	bool first = true;
+	unsigned int i;
+	unsigned int points;
+	unsigned int pnt;
+	int inflate;
+
+	for (i = 0; i < n; ) {
+		if (p[i] == PLOTTER_PATH_MOVE ||
+				p[i] == PLOTTER_PATH_LINE) {
+			points = 1;
+		} else if (p[i] == PLOTTER_PATH_BEZIER) {
+			points = 3;
+		} else if (p[i] == PLOTTER_PATH_CLOSE) {
+			i++;
+			continue;
+		} else {
+			/* bad path command; no usable bounds */
+			return false;
+		}
+		i++;
+
+		for (pnt = 0; pnt < points; pnt++) {
+			float x = transform[0] * p[i] +
+					transform[2] * p[i + 1] +
+					transform[4];
+			float y = transform[1] * p[i] +
+					transform[3] * p[i + 1] +
+					transform[5];
+
+			if (first || x < x0)
+				x0 = x;
+			if (first || x > x1)
+				x1 = x;
+			if (first || y < y0)
+				y0 = y;
+			if (first || y > y1)
+				y1 = y;
+			first = false;
+			i += 2;
+		}
+	}
+
+	if (first) {
+		/* no points at all; nothing to plot */
+		*visible = false;
+		return true;
+	}
+
+	/* stroked edges extend beyond the points */
+	inflate = 1;
+	if (pstyle->stroke_type != PLOT_OP_TYPE_NONE)
+		inflate += plot_style_fixed_to_int(pstyle->stroke_width) + 1;
+
+	bbox->x0 = ((int)x0) - inflate;
+	bbox->y0 = ((int)y0) - inflate;
+	bbox->x1 = ((int)x1) + inflate;
+	bbox->y1 = ((int)y1) + inflate;
+
+	if (bbox->x0 < clip_cur.x0)
+		bbox->x0 = clip_cur.x0;
+	if (bbox->y0 < clip_cur.y0)
+		bbox->y0 = clip_cur.y0;
+	if (bbox->x1 > clip_cur.x1)
+		bbox->x1 = clip_cur.x1;
+	if (bbox->y1 > clip_cur.y1)
+		bbox->y1 = clip_cur.y1;
+
+	*visible = (bbox->x0 < bbox->x1) && (bbox->y0 < bbox->y1);
+	return true;
+}
+
+
 /**
  * Knockout polygon plotting.
  *
@@ -623,6 +1074,8 @@ knockout_plot_polygon(const struct redraw_context *ctx,
 		      unsigned int n)
 {
 	int *dest;
+	struct rect bbox;
+	bool visible;
 	nserror res = NSERROR_OK;
 	nserror ffres = NSERROR_OK;
 
@@ -637,6 +1090,12 @@ knockout_plot_polygon(const struct redraw_context *ctx,
 		return ffres;
 	}
 
+	visible = knockout_polygon_bounds(p, n, &bbox);
+	if (!visible) {
+		/* entirely clipped away */
+		return NSERROR_OK;
+	}
+
 	/* ensure we have enough room right now */
 	if (knockout_polygon_cur + n * 2 >= KNOCKOUT_POLYGONS) {
 		ffres = knockout_plot_flush(ctx);
@@ -650,7 +1109,9 @@ knockout_plot_polygon(const struct redraw_context *ctx,
 	knockout_entries[knockout_entry_cur].data.polygon.n = n;
 	knockout_entries[knockout_entry_cur].data.polygon.plot_style = *pstyle;
 	knockout_entries[knockout_entry_cur].type = KNOCKOUT_PLOT_POLYGON;
-	if (++knockout_entry_cur >= KNOCKOUT_ENTRIES) {
+	knockout_plot_passive_box(&bbox);
+	if ((++knockout_entry_cur >= KNOCKOUT_ENTRIES) ||
+	    (++knockout_box_cur >= KNOCKOUT_BOXES)) {
 		res = knockout_plot_flush(ctx);
 	}
 	/* return the first error */
@@ -664,8 +1125,10 @@ knockout_plot_polygon(const struct redraw_context *ctx,
 /**
  * knockout path plotting.
  *
- * The knockout implementation simply flushes the queue and plots the path
- *  directly using real plotter.
+ * Paths are queued with a bounding box like any other entry so they
+ * take part in occlusion culling; a path later covered entirely by an
+ * opaque plot is never sent to the real plotter. Only paths too large
+ * for the queue fall back to flushing and plotting directly.
  *
  * \param ctx The current redraw context.
  * \param pstyle Style controlling the path plot.
@@ -681,12 +1144,50 @@ knockout_plot_path(const struct redraw_context *ctx,
 		   unsigned int n,
 		   const float transform[6])
 {
-	nserror res;
-	nserror ffres;
+	float *dest;
+	struct rect bbox;
+	bool visible;
+	nserror res = NSERROR_OK;
+	nserror ffres = NSERROR_OK;
 
-	ffres = knockout_plot_flush(ctx);
-	res = real_plot.path(ctx, pstyle, p, n, transform);
+	/* ensure we have sufficient room even when flushed; malformed
+	 * paths have no usable bounds so take the same fallback */
+	if (n >= KNOCKOUT_PATHS ||
+	    !knockout_path_bounds(pstyle, p, n, transform, &bbox, &visible)) {
+		ffres = knockout_plot_flush(ctx);
+		res = real_plot.path(ctx, pstyle, p, n, transform);
+		/* return the first error */
+		if ((res != NSERROR_OK) && (ffres == NSERROR_OK)) {
+			ffres = res;
+		}
+		return ffres;
+	}
 
+	if (!visible) {
+		/* entirely clipped away */
+		return NSERROR_OK;
+	}
+
+	/* ensure we have enough room right now */
+	if (knockout_path_cur + n >= KNOCKOUT_PATHS) {
+		ffres = knockout_plot_flush(ctx);
+	}
+
+	/* copy our data */
+	dest = &(knockout_paths[knockout_path_cur]);
+	memcpy(dest, p, n * sizeof(float));
+	knockout_path_cur += n;
+	knockout_entries[knockout_entry_cur].data.path.p = dest;
+	knockout_entries[knockout_entry_cur].data.path.n = n;
+	memcpy(knockout_entries[knockout_entry_cur].data.path.transform,
+			transform, sizeof(float[6]));
+	knockout_entries[knockout_entry_cur].data.path.plot_style = *pstyle;
+	knockout_entries[knockout_entry_cur].type = KNOCKOUT_PLOT_PATH;
+	knockout_plot_passive_box(&bbox);
+	if ((++knockout_entry_cur >= KNOCKOUT_ENTRIES) ||
+	    (++knockout_box_cur >= KNOCKOUT_BOXES)) {
+		res = knockout_plot_flush(ctx);
+	}
 	/* return the first error */
 	if ((res != NSERROR_OK) && (ffres == NSERROR_OK)) {
 		ffres = res;
@@ -888,7 +1389,9 @@ knockout_plot_bitmap(const struct redraw_context *ctx,
 
 	/* tiled bitmaps both knock out and get knocked out */
 	if (guit->bitmap->get_opaque(bitmap)) {
-		knockout_calculate(ctx, kx0, ky0, kx1, ky1, NULL);
+		if (knockout_quad_root != -1)
+			knockout_calculate_quad(ctx, kx0, ky0, kx1, ky1,
+						knockout_quad_root);
 	}
 	knockout_boxes[knockout_box_cur].bbox.x0 = kx0;
 	knockout_boxes[knockout_box_cur].bbox.y0 = ky0;
@@ -896,8 +1399,7 @@ knockout_plot_bitmap(const struct redraw_context *ctx,
 	knockout_boxes[knockout_box_cur].bbox.y1 = ky1;
 	knockout_boxes[knockout_box_cur].deleted = false;
 	knockout_boxes[knockout_box_cur].child = NULL;
-	knockout_boxes[knockout_box_cur].next = knockout_list;
-	knockout_list = &knockout_boxes[knockout_box_cur];
+	knockout_quad_insert(&knockout_boxes[knockout_box_cur]);
 	knockout_entries[knockout_entry_cur].box = &knockout_boxes[knockout_box_cur];
 	knockout_entries[knockout_entry_cur].data.bitmap.x = x;
 	knockout_entries[knockout_entry_cur].data.bitmap.y = y;
@@ -26,20 +26,28 @@
 #include <libwapcaplet/libwapcaplet.h>
 #include <dom/dom.h>
 
+#include <string.h>
+
 #include "netsurf/inttypes.h"
 #include "utils/config.h"
 #include "utils/errors.h"
 #include "utils/nscolour.h"
 #include "utils/nsoption.h"
+#include "utils/nsurl.h"
 #include "utils/corestrings.h"
 #include "utils/log.h"
+#include "utils/memreport.h"
 #include "utils/string.h"
+#include "utils/talloc.h"
 #include "utils/utf8.h"
 #include "utils/messages.h"
+#include "utils/trace.h"
 #include "utils/useragent.h"
 #include "content/content_factory.h"
+#include "content/fetch.h"
 #include "content/fetchers.h"
 #include "content/hlcache.h"
+#include "content/llcache.h"
 #include "content/mimesniff.h"
 #include "content/urldb.h"
 #include "css/css.h"
@@ -50,6 +58,7 @@
 #include "text/textplain.h"
 
 #include "netsurf/browser_window.h"
+#include "desktop/frame_budget.h"
 #include "desktop/system_colour.h"
 #include "desktop/page-info.h"
 #include "desktop/searchweb.h"
@@ -97,6 +106,112 @@
 /** default time quantum with which to calculate bandwidth (ms) */
 #define LLCACHE_STORE_TIME_QUANTUM (100)
 
+/** time after startup before warmup manifest fetches begin (ms) */
+#define WARMUP_START_DELAY (2 * 1000)
+
+/** maximum length of a warmup manifest line */
+#define WARMUP_LINE_MAX 2048
+
+/**
+ * Callback for a warmup fetch; the data is wanted only for its side
+ * effect of populating the cache.
+ */
+static nserror
+netsurf_warmup_llcache_cb(llcache_handle *handle,
+			  const llcache_event *event,
+			  void *pw)
+{
+	switch (event->type) {
+	case LLCACHE_EVENT_DONE:
+		NSLOG(netsurf, INFO, "Warmed "URL_FMT_SPC,
+		      nsurl_access_log(llcache_handle_get_url(handle)));
+		llcache_handle_release(handle);
+		break;
+
+	case LLCACHE_EVENT_ERROR:
+		NSLOG(netsurf, WARNING, "Warmup fetch of "URL_FMT_SPC" failed",
+		      nsurl_access_log(llcache_handle_get_url(handle)));
+		llcache_handle_release(handle);
+		break;
+
+	default:
+		break;
+	}
+
+	return NSERROR_OK;
+}
+
+/**
+ * Fetch every URL in the warmup manifest through the low-level cache.
+ *
+ * Scheduled shortly after startup so the fetches proceed in the
+ * background once the frontend event loop is running. The fetches are
+ * issued at image priority so a user navigation started meanwhile
+ * always wins the fetcher queue, and cache headers are honoured as
+ * for any other retrieval.
+ *
+ * \param p unused
+ */
+static void netsurf_warmup(void *p)
+{
+	FILE *manifest;
+	char line[WARMUP_LINE_MAX];
+	size_t len;
+	nsurl *url;
+	llcache_handle *handle;
+	unsigned int issued = 0;
+	nserror res;
+
+	manifest = fopen(nsoption_charp(warmup_manifest), "r");
+	if (manifest == NULL) {
+		NSLOG(netsurf, WARNING, "Unable to open warmup manifest %s",
+		      nsoption_charp(warmup_manifest));
+		return;
+	}
+
+	while (fgets(line, sizeof(line), manifest) != NULL) {
+		len = strlen(line);
+		while ((len > 0) &&
+		       ((line[len - 1] == '\n') || (line[len - 1] == '\r'))) {
+			line[--len] = '\0';
+		}
+
+		/* skip blank lines and comments */
+		if ((len == 0) || (line[0] == '#')) {
+			continue;
+		}
+
+		res = nsurl_create(line, &url);
+		if (res != NSERROR_OK) {
+			NSLOG(netsurf, WARNING,
+			      "Ignoring bad warmup manifest entry %s", line);
+			continue;
+		}
+
+		res = llcache_handle_retrieve(url,
+				LLCACHE_RETRIEVE_PRIORITY(FETCH_PRIORITY_IMG),
+				NULL, NULL,
+				netsurf_warmup_llcache_cb, NULL,
+				&handle);
+		nsurl_unref(url);
+		if (res == NSERROR_OK) {
+			issued++;
+		}
+	}
+
+	fclose(manifest);
+
+	NSLOG(netsurf, INFO, "Warmup started for %u manifest entries", issued);
+}
+
+/**
+ * Report total talloc usage, which is dominated by the box trees.
+ */
+static size_t netsurf_talloc_usage(void *pw)
+{
+	return talloc_total_size(NULL);
+}
+
 static void netsurf_lwc_iterator(lwc_string *str, void *pw)
 {
 	NSLOG(netsurf, WARNING, "[%3"PRIu32"] %.*s", str->refcnt,
@@ -132,6 +247,18 @@ nserror netsurf_init(const char *store_path)
 	signal(SIGPIPE, SIG_IGN);
 #endif
 
+	/* tracepoint init */
+	ret = nstrace_init();
+	if (ret != NSERROR_OK)
+		return ret;
+
+	/* track all talloc contexts so their usage can be accounted */
+	talloc_enable_null_tracking();
+	ret = memreport_register("Box trees (talloc)",
+				 netsurf_talloc_usage, NULL);
+	if (ret != NSERROR_OK)
+		return ret;
+
 	/* corestrings init */
 	ret = corestrings_init();
 	if (ret != NSERROR_OK)
@@ -221,6 +348,13 @@ nserror netsurf_init(const char *store_path)
 		return ret;
 	}
 
+	/* begin warming the cache from the manifest once the frontend
+	 * event loop is running
+	 */
+	if (nsoption_charp(warmup_manifest) != NULL) {
+		guit->misc->schedule(WARMUP_START_DELAY, netsurf_warmup, NULL);
+	}
+
 	return NSERROR_OK;
 }
 
@@ -231,6 +365,8 @@ nserror netsurf_init(const char *store_path)
 
 void netsurf_exit(void)
 {
+	guit->misc->schedule(-1, netsurf_warmup, NULL);
+
 	hlcache_stop();
 	
 	NSLOG(netsurf, INFO, "Closing GUI");
@@ -271,6 +407,8 @@ void netsurf_exit(void)
 	NSLOG(netsurf, INFO, "Destroying Messages");
 	messages_destroy();
 
+	memreport_unregister("Box trees (talloc)");
+
 	corestrings_fini();
 	if (dom_namespace_finalise() != DOM_NO_ERR) {
 		NSLOG(netsurf, WARNING, "Unable to finalise DOM namespace strings");
@@ -278,5 +416,11 @@ void netsurf_exit(void)
 	NSLOG(netsurf, INFO, "Remaining lwc strings:");
 	lwc_iterate_strings(netsurf_lwc_iterator, NULL);
 
+	/* report accumulated frame budget overruns */
+	frame_budget_fini();
+
+	/* dump and release any recorded tracepoints */
+	nstrace_fini();
+
 	NSLOG(netsurf, INFO, "Exited successfully");
 }
@@ -101,6 +101,9 @@ NSOPTION_UINT(disc_cache_size, 1024 * 1024 * 1024)
 /** Preferred expiry age of disc cache / days. */
 NSOPTION_INTEGER(disc_cache_age, 28)
 
+/** Compression level for disc cache entries (0 disables compression) */
+NSOPTION_UINT(disc_cache_compression, 1)
+
 /** Whether to block advertisements */
 NSOPTION_BOOL(block_advertisements, false)
 
@@ -126,9 +129,14 @@ NSOPTION_BOOL(enable_javascript, false)
 /** Whether to allow Author level CSS. */
 NSOPTION_BOOL(author_level_css, true)
 
-/** Maximum time (in seconds) to wait for a script to run */
+/** Maximum time (in seconds) to wait for a script to run, 0 to wait
+ * indefinitely */
 NSOPTION_INTEGER(script_timeout, 10)
 
+/** Frame time budget (in ms) above which a slow subsystem is logged,
+ * 0 disables the monitor */
+NSOPTION_INTEGER(frame_time_budget, 16)
+
 /** How many days to retain URL data for */
 NSOPTION_INTEGER(expire_url, 28)
 
@@ -180,9 +188,38 @@ NSOPTION_INTEGER(scale, 100)
 /* Whether to reflow web pages while objects are fetching */
 NSOPTION_BOOL(incremental_reflow, true)
 
+/* Whether to defer image fetches until scrolled near the viewport */
+NSOPTION_BOOL(lazy_image_loading, false)
+
+/** Margin (in px) around the viewport within which deferred images load */
+NSOPTION_INTEGER(lazy_load_margin, 512)
+
+/** Maximum time (in ms) spent parsing HTML per data callback, 0 for
+ * no limit; the remainder of a chunk is carried over to a scheduled
+ * continuation */
+NSOPTION_INTEGER(parse_budget_ms, 0)
+
+/** Maximum number of entries kept in a window's history tree, 0 for
+ * no limit; least recently visited leaves are pruned first */
+NSOPTION_INTEGER(history_max_entries, 0)
+
+/** Maximum number of history entries keeping a thumbnail bitmap, 0
+ * for no limit; dropped thumbnails are recreated when revisited */
+NSOPTION_INTEGER(history_max_thumbnails, 0)
+
+/** Number of fully built pages kept per window for instant
+ * back/forward navigation, 0 to disable the frozen page cache */
+NSOPTION_INTEGER(page_cache_size, 0)
+
 /* Minimum time (in cs) between HTML reflows while objects are fetching */
 NSOPTION_UINT(min_reflow_period, DEFAULT_REFLOW_PERIOD)
 
+/** Rate (in Hz) animation driven repaints are batched to */
+NSOPTION_INTEGER(animation_fps, 25)
+
+/* animate core scrollbar wheel scrolling towards its target */
+NSOPTION_BOOL(smooth_scrolling, true)
+
 /* use core selection menu */
 NSOPTION_BOOL(core_select_menu, false)
 
@@ -203,6 +240,13 @@ NSOPTION_INTEGER(max_fetchers, 24)
  */
 NSOPTION_INTEGER(max_fetchers_per_host, 5)
 
+/** Maximum rate (per second) fetch starts are dispatched at,
+ * 0 disables the limiter */
+NSOPTION_INTEGER(max_fetch_rate, 0)
+
+/** Number of fetch starts the dispatch rate limiter allows in a burst */
+NSOPTION_INTEGER(max_fetch_burst, 8)
+
 /** Maximum number of inactive fetchers cached.  The total number of
  * handles netsurf will therefore have open is this plus
  * option_max_fetchers.
@@ -212,6 +256,26 @@ NSOPTION_INTEGER(max_cached_fetch_handles, 6)
 /** Number of times to retry timed-out fetches before giving up. */
 NSOPTION_UINT(max_retried_fetches, 1)
 
+/** Directory to record http(s) fetch responses into for later replay,
+ * NULL disables recording.
+ */
+NSOPTION_STRING(fetch_record_path, NULL)
+
+/** Directory to serve http(s) fetches from instead of the network,
+ * NULL disables replay.
+ */
+NSOPTION_STRING(fetch_replay_path, NULL)
+
+/** Whether replayed fetches honour their recorded duration rather
+ * than completing immediately.
+ */
+NSOPTION_BOOL(fetch_replay_timing, false)
+
+/** File listing URLs to fetch into the cache shortly after startup,
+ * one per line, NULL disables warmup.
+ */
+NSOPTION_STRING(warmup_manifest, NULL)
+
 /** Number of seconds to allow for a DNS-resolution+connect() before timing out
  * the cURL socket.
  */
@@ -220,6 +284,35 @@ NSOPTION_UINT(curl_fetch_timeout, 30)
 /** Suppress debug output from cURL. */
 NSOPTION_BOOL(suppress_curl_debug, true)
 
+/** Use the event driven curl_multi_socket_action interface to
+ * progress fetches.  Only the sockets cURL has reported activity on
+ * are serviced per poll instead of rescanning every descriptor with
+ * curl_multi_fdset()/select().
+ */
+NSOPTION_BOOL(curl_socket_events, false)
+
+/** Negotiate HTTP/2 over TLS and multiplex fetches to the same host
+ * onto a single connection instead of opening one connection per
+ * resource.
+ */
+NSOPTION_BOOL(http2_multiplexing, false)
+
+/** Maximum concurrent streams to advertise on a multiplexed HTTP/2
+ * connection.
+ */
+NSOPTION_UINT(http2_max_concurrent_streams, 100)
+
+/** Speculatively resolve the hosts of anchors found during box
+ * construction.  Explicit dns-prefetch/preconnect link hints are
+ * always honoured regardless of this option.
+ */
+NSOPTION_BOOL(dns_prefetch_anchors, false)
+
+/** Speculatively scan incoming HTML for img/script/link URLs ahead of
+ * the parser and warm them in the low-level cache.
+ */
+NSOPTION_BOOL(preload_scanning, true)
+
 /** Whether to allow target="_blank" */
 NSOPTION_BOOL(target_blank, true)
 
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Rolling performance sample log implementation.
+ */
+
+#include "desktop/perf_log.h"
+
+/** Names of the logged metrics for presentation */
+static const char *perf_log_names[PERF_LOG_METRIC_COUNT] = {
+	"Paint time (ms)",
+	"Layout time (ms)",
+	"Script time (ms)",
+	"GC pause (ms)",
+	"Cache hit rate (%)",
+	"Active fetches",
+};
+
+/** Retained samples for each metric */
+static float perf_log_values[PERF_LOG_METRIC_COUNT][PERF_LOG_DEPTH];
+
+/** Position the next sample for each metric is written at */
+static unsigned int perf_log_head[PERF_LOG_METRIC_COUNT];
+
+/** Number of valid samples for each metric, saturating at the depth */
+static unsigned int perf_log_count[PERF_LOG_METRIC_COUNT];
+
+
+/* exported interface documented in desktop/perf_log.h */
+void perf_log_sample(enum perf_log_metric metric, float value)
+{
+	if (metric >= PERF_LOG_METRIC_COUNT) {
+		return;
+	}
+
+	perf_log_values[metric][perf_log_head[metric]] = value;
+	perf_log_head[metric] = (perf_log_head[metric] + 1) % PERF_LOG_DEPTH;
+	if (perf_log_count[metric] < PERF_LOG_DEPTH) {
+		perf_log_count[metric]++;
+	}
+}
+
+
+/* exported interface documented in desktop/perf_log.h */
+unsigned int perf_log_series(enum perf_log_metric metric,
+			     float *values,
+			     unsigned int size)
+{
+	unsigned int count;
+	unsigned int idx;
+	unsigned int pos;
+
+	if (metric >= PERF_LOG_METRIC_COUNT) {
+		return 0;
+	}
+
+	count = perf_log_count[metric];
+	if (count > size) {
+		count = size;
+	}
+
+	/* walk forward from the oldest sample being copied */
+	pos = (perf_log_head[metric] + (PERF_LOG_DEPTH - count))
+		% PERF_LOG_DEPTH;
+	for (idx = 0; idx < count; idx++) {
+		values[idx] = perf_log_values[metric][pos];
+		pos = (pos + 1) % PERF_LOG_DEPTH;
+	}
+
+	return count;
+}
+
+
+/* exported interface documented in desktop/perf_log.h */
+const char *perf_log_metric_name(enum perf_log_metric metric)
+{
+	if (metric >= PERF_LOG_METRIC_COUNT) {
+		return "unknown";
+	}
+	return perf_log_names[metric];
+}
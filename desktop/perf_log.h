@@ -0,0 +1,81 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Rolling performance sample log interface.
+ *
+ * Instrumented subsystems push one value per event into a fixed ring
+ * buffer per metric. Recording is a couple of array stores so it is
+ * cheap enough to leave enabled; the retained history backs the
+ * about:perf dashboard timelines so a stutter can be diagnosed in the
+ * field without external tooling.
+ */
+
+#ifndef NETSURF_DESKTOP_PERF_LOG_H_
+#define NETSURF_DESKTOP_PERF_LOG_H_
+
+/** Number of samples retained per metric */
+#define PERF_LOG_DEPTH 128
+
+/**
+ * The metrics with retained sample history
+ */
+enum perf_log_metric {
+	PERF_LOG_PAINT, /**< time painting a window in ms */
+	PERF_LOG_LAYOUT, /**< time in document reflow in ms */
+	PERF_LOG_SCRIPT, /**< time executing javascript in ms */
+	PERF_LOG_GC_PAUSE, /**< javascript idle collection pause in ms */
+	PERF_LOG_CACHE_HIT, /**< running source cache hit rate percentage */
+	PERF_LOG_FETCH_ACTIVE, /**< concurrent active fetches at dispatch */
+	PERF_LOG_METRIC_COUNT /**< number of logged metrics */
+};
+
+/**
+ * Record a sample for a metric.
+ *
+ * The oldest retained sample for the metric is discarded once the
+ * ring is full.
+ *
+ * \param metric The metric the sample belongs to
+ * \param value The sampled value
+ */
+void perf_log_sample(enum perf_log_metric metric, float value);
+
+/**
+ * Copy the retained samples for a metric in chronological order.
+ *
+ * \param metric The metric to copy samples of
+ * \param values Buffer of at least \a size entries receiving the samples
+ * \param size Capacity of \a values; only the newest samples that fit
+ *             are copied
+ * \return The number of samples copied
+ */
+unsigned int perf_log_series(enum perf_log_metric metric,
+			     float *values,
+			     unsigned int size);
+
+/**
+ * Get the presentation name of a metric.
+ *
+ * \param metric The metric to name
+ * \return Pointer to constant string name
+ */
+const char *perf_log_metric_name(enum perf_log_metric metric);
+
+#endif
@@ -23,6 +23,10 @@
  * These plot styles are globaly available and used in many places.
  */
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 #include "netsurf/plot_style.h"
 
 static plot_style_t plot_style_fill_white_static = {
@@ -164,3 +168,168 @@ static const plot_font_style_t plot_style_font_static = {
 };
 plot_font_style_t const * const plot_style_font = &plot_style_font_static;
 
+
+
+/** Number of slots in each style intern table; must be a power of two */
+#define PLOT_STYLE_INTERN_SLOTS 64
+
+/** Longest probe sequence before giving up on interning a style */
+#define PLOT_STYLE_INTERN_PROBES 8
+
+/** An interned plot style and its handle */
+struct plot_style_interned {
+	plot_style_t style;
+	unsigned int handle; /**< 0 while the slot is empty */
+};
+
+/** An interned font plot style and its handle */
+struct plot_font_style_interned {
+	plot_font_style_t style;
+	unsigned int handle; /**< 0 while the slot is empty */
+};
+
+static struct plot_style_interned
+		plot_style_intern_table[PLOT_STYLE_INTERN_SLOTS];
+static struct plot_font_style_interned
+		plot_font_style_intern_table[PLOT_STYLE_INTERN_SLOTS];
+
+/** Next handle to issue; handles are never reused */
+static unsigned int plot_style_intern_next = 1;
+
+
+/**
+ * Fold a value into a style hash
+ */
+static inline unsigned int
+plot_style_intern_fold(unsigned int hash, unsigned int value)
+{
+	return (hash * 31) + value;
+}
+
+
+/**
+ * Determine if two plot styles are identical
+ */
+static bool plot_style_eq(const plot_style_t *a, const plot_style_t *b)
+{
+	return (a->stroke_type == b->stroke_type) &&
+	       (a->stroke_width == b->stroke_width) &&
+	       (a->stroke_colour == b->stroke_colour) &&
+	       (a->fill_type == b->fill_type) &&
+	       (a->fill_colour == b->fill_colour);
+}
+
+
+/**
+ * Determine if two font plot styles are identical
+ *
+ * The family array is compared by pointer; see the interface
+ * documentation.
+ */
+static bool
+plot_font_style_eq(const plot_font_style_t *a, const plot_font_style_t *b)
+{
+	return (a->families == b->families) &&
+	       (a->family == b->family) &&
+	       (a->size == b->size) &&
+	       (a->weight == b->weight) &&
+	       (a->flags == b->flags) &&
+	       (a->background == b->background) &&
+	       (a->foreground == b->foreground);
+}
+
+
+/* exported interface documented in netsurf/plot_style.h */
+const plot_style_t *
+plot_style_intern(const plot_style_t *style, unsigned int *handle_out)
+{
+	unsigned int hash = 0;
+	unsigned int probe;
+	struct plot_style_interned *slot;
+
+	hash = plot_style_intern_fold(hash, style->stroke_type);
+	hash = plot_style_intern_fold(hash, style->stroke_width);
+	hash = plot_style_intern_fold(hash, style->stroke_colour);
+	hash = plot_style_intern_fold(hash, style->fill_type);
+	hash = plot_style_intern_fold(hash, style->fill_colour);
+
+	for (probe = 0; probe < PLOT_STYLE_INTERN_PROBES; probe++) {
+		slot = &plot_style_intern_table[
+			(hash + probe) & (PLOT_STYLE_INTERN_SLOTS - 1)];
+
+		if (slot->handle == 0) {
+			/* free slot; intern here */
+			slot->style = *style;
+			slot->handle = plot_style_intern_next++;
+		} else if (!plot_style_eq(&slot->style, style)) {
+			continue;
+		}
+
+		if (handle_out != NULL) {
+			*handle_out = slot->handle;
+		}
+		return &slot->style;
+	}
+
+	/* table contended; hand the caller's style straight back */
+	if (handle_out != NULL) {
+		*handle_out = 0;
+	}
+	return style;
+}
+
+
+/* exported interface documented in netsurf/plot_style.h */
+const plot_font_style_t *
+plot_font_style_intern(const plot_font_style_t *fstyle,
+		       unsigned int *handle_out)
+{
+	unsigned int hash = 0;
+	unsigned int probe;
+	struct plot_font_style_interned *slot;
+
+	hash = plot_style_intern_fold(hash,
+			(unsigned int)(uintptr_t)fstyle->families);
+	hash = plot_style_intern_fold(hash, fstyle->family);
+	hash = plot_style_intern_fold(hash, fstyle->size);
+	hash = plot_style_intern_fold(hash, fstyle->weight);
+	hash = plot_style_intern_fold(hash, fstyle->flags);
+	hash = plot_style_intern_fold(hash, fstyle->background);
+	hash = plot_style_intern_fold(hash, fstyle->foreground);
+
+	for (probe = 0; probe < PLOT_STYLE_INTERN_PROBES; probe++) {
+		slot = &plot_font_style_intern_table[
+			(hash + probe) & (PLOT_STYLE_INTERN_SLOTS - 1)];
+
+		if (slot->handle == 0) {
+			/* free slot; intern here */
+			slot->style = *fstyle;
+			slot->handle = plot_style_intern_next++;
+		} else if (!plot_font_style_eq(&slot->style, fstyle)) {
+			continue;
+		}
+
+		if (handle_out != NULL) {
+			*handle_out = slot->handle;
+		}
+		return &slot->style;
+	}
+
+	/* table contended; hand the caller's style straight back */
+	if (handle_out != NULL) {
+		*handle_out = 0;
+	}
+	return fstyle;
+}
+
+
+/* exported interface documented in netsurf/plot_style.h */
+void plot_style_intern_invalidate(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < PLOT_STYLE_INTERN_SLOTS; i++) {
+		plot_style_intern_table[i].handle = 0;
+		plot_font_style_intern_table[i].handle = 0;
+	}
+}
@@ -23,6 +23,7 @@
 #include "utils/config.h"
 
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 #include <dom/dom.h>
 
@@ -32,12 +33,16 @@
 #include "utils/talloc.h"
 #include "netsurf/content.h"
 #include "netsurf/plotters.h"
+#include "netsurf/misc.h"
 #include "content/hlcache.h"
 #include "css/utils.h"
 #include "html/box.h"
+#include "html/html_save.h"
 
+#include "desktop/gui_internal.h"
 #include "desktop/print.h"
 #include "desktop/printer.h"
+#include "desktop/scrollbar.h"
 
 /* Default print settings */
 #define DEFAULT_PAGE_WIDTH 595
@@ -48,6 +53,22 @@ static float page_content_width, page_content_height;
 static struct hlcache_handle *printed_content;
 static float done_height;
 
+/** Vertical extent of an unbreakable box, in scaled output units */
+struct print_extent {
+	int y0;
+	int y1;
+};
+
+/** Extents collected from the box tree for pagination */
+static struct print_extent *print_extents;
+static unsigned int print_extent_count;
+static unsigned int print_extent_alloc;
+
+/** Content offset each page begins at, or NULL if not paginated */
+static float *print_page_begin;
+static unsigned int print_page_count;
+static unsigned int print_current_page;
+
 bool html_redraw_printing = false;
 int html_redraw_printing_border = 0;
 int html_redraw_printing_top_cropped = 0;
@@ -82,6 +103,91 @@ bool print_basic_run(hlcache_handle *content,
 }
 
 
+/** State for a print run being performed from the scheduler. */
+struct print_run {
+	struct hlcache_handle *content;
+	const struct printer *printer;
+	struct print_settings *settings;
+	print_done_cb done;
+	void *done_ctx;
+};
+
+
+/**
+ * Scheduler callback printing one page per call.
+ */
+static void print_run_step(void *p)
+{
+	struct print_run *run = p;
+	bool ok = true;
+
+	if (done_height < content_get_height(printed_content)) {
+		ok = print_draw_next_page(run->printer, run->settings);
+		if (ok) {
+			if (guit->misc->schedule(0, print_run_step,
+					run) == NSERROR_OK) {
+				return;
+			}
+			ok = false;
+		}
+	}
+
+	print_cleanup(run->content, run->printer, run->settings);
+
+	if (run->done != NULL) {
+		run->done(run->done_ctx, ok);
+	}
+
+	free(run);
+}
+
+
+/**
+ * This function calls print setup and then prints page after page from
+ * the scheduler until the whole content is printed, so other work can
+ * be serviced between pages, before cleaning up afterwards.
+ *
+ * \param content The content to be printed
+ * \param printer The printer interface for the printer to be used
+ * \param settings The settings for printing to use
+ * \param done Callback made when the print run finishes, or NULL
+ * \param done_ctx Context pointer passed to the done callback
+ * \return true if the print run was started, false otherwise
+ */
+bool print_basic_run_async(hlcache_handle *content,
+		const struct printer *printer,
+		struct print_settings *settings,
+		print_done_cb done, void *done_ctx)
+{
+	struct print_run *run;
+
+	assert(content != NULL && printer != NULL && settings != NULL);
+
+	run = malloc(sizeof(*run));
+	if (run == NULL)
+		return false;
+
+	if (!print_set_up(content, printer, settings, NULL)) {
+		free(run);
+		return false;
+	}
+
+	run->content = content;
+	run->printer = printer;
+	run->settings = settings;
+	run->done = done;
+	run->done_ctx = done_ctx;
+
+	if (guit->misc->schedule(0, print_run_step, run) != NSERROR_OK) {
+		print_cleanup(content, printer, settings);
+		free(run);
+		return false;
+	}
+
+	return true;
+}
+
+
 /**
  * The content passed to the function is duplicated with its boxes, font
  * measuring functions are being set.
@@ -135,6 +241,198 @@ print_apply_settings(hlcache_handle *content, struct print_settings *settings)
 }
 
 
+/**
+ * Append one unbreakable extent to the pagination set.
+ *
+ * \param y0 Top of the extent in scaled output units
+ * \param y1 Bottom of the extent in scaled output units
+ * \return true if successful, false on memory exhaustion
+ */
+static bool print_add_extent(int y0, int y1)
+{
+	if (print_extent_count == print_extent_alloc) {
+		struct print_extent *tmp;
+		unsigned int new_alloc = (print_extent_alloc == 0) ?
+				256 : print_extent_alloc * 2;
+
+		tmp = realloc(print_extents, new_alloc * sizeof(*tmp));
+		if (tmp == NULL)
+			return false;
+
+		print_extents = tmp;
+		print_extent_alloc = new_alloc;
+	}
+
+	print_extents[print_extent_count].y0 = y0;
+	print_extents[print_extent_count].y1 = y1;
+	print_extent_count++;
+
+	return true;
+}
+
+
+/**
+ * Collect the vertical extents of unbreakable boxes from a box subtree.
+ *
+ * Mirrors the coordinate and extent computation of html_redraw_box()
+ * for the box types its page break logic defers (text, table cells,
+ * objects and gadgets), so pagination decided from these extents
+ * matches what the renderer would have decided page by page.
+ *
+ * \param box The subtree root
+ * \param y_parent Absolute y coordinate of the parent, unscaled
+ * \param scale The print scale
+ * \return true if successful, false on memory exhaustion
+ */
+static bool
+print_collect_extents(struct box *box, int y_parent, float scale)
+{
+	struct box *c;
+	int y_offset;
+
+	if (box->type == BOX_TEXT || box->type == BOX_TABLE_CELL ||
+			box->object || box->gadget) {
+		enum css_overflow_e overflow_y = CSS_OVERFLOW_VISIBLE;
+		int y, y0, y1;
+
+		if (box->style != NULL)
+			overflow_y = css_computed_overflow_y(box->style);
+
+		y = (y_parent + box->y) * scale;
+
+		if (box->style && overflow_y != CSS_OVERFLOW_VISIBLE &&
+				box->parent != NULL) {
+			/* box contents clipped to box size */
+			y0 = y - box->border[TOP].width * scale;
+			y1 = y + (box->padding[TOP] + box->height +
+					box->padding[BOTTOM] +
+					box->border[BOTTOM].width) * scale;
+		} else {
+			/* box contents can hang out of the box */
+			y0 = y + box->descendant_y0 * scale;
+			y1 = y + box->descendant_y1 * scale + 1;
+		}
+
+		if (!print_add_extent(y0, y1))
+			return false;
+	}
+
+	y_offset = y_parent + box->y - scrollbar_get_offset(box->scroll_y);
+
+	for (c = box->children; c; c = c->next) {
+		if (c->type == BOX_FLOAT_LEFT || c->type == BOX_FLOAT_RIGHT)
+			continue;
+		if (!print_collect_extents(c, y_offset, scale))
+			return false;
+	}
+	for (c = box->float_children; c; c = c->next_float) {
+		if (!print_collect_extents(c, y_offset, scale))
+			return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * Comparison function ordering extents by their top edge.
+ */
+static int print_extent_cmp(const void *a, const void *b)
+{
+	const struct print_extent *ea = a;
+	const struct print_extent *eb = b;
+
+	return ea->y0 - eb->y0;
+}
+
+
+/**
+ * Compute every page break position in a single pass.
+ *
+ * Walks the laid out box tree once collecting the extents of the
+ * boxes the renderer refuses to split across pages, then applies the
+ * same break rule it uses (a box straddling the page border which
+ * could fit on a page pushes the border up to its top) to derive the
+ * start offset of every page up front. Drawing a page then no longer
+ * needs to discover its own break, and the page count is known before
+ * the first page is output.
+ *
+ * On failure the page table is left empty and drawing falls back to
+ * discovering breaks page by page as before.
+ *
+ * \param content The laid out content to be printed
+ * \param settings The settings for printing to use
+ * \return true if the page table was built, false otherwise
+ */
+static bool
+print_paginate(struct hlcache_handle *content, struct print_settings *settings)
+{
+	float border_h = page_content_height * settings->scale;
+	int height = content_get_height(content);
+	unsigned int start = 0;
+	unsigned int i;
+	float done = 0;
+
+	if (content_get_type(content) != CONTENT_HTML || border_h <= 0)
+		return false;
+
+	if (!print_collect_extents(html_get_box_tree(content), 0,
+			settings->scale))
+		return false;
+
+	qsort(print_extents, print_extent_count, sizeof(*print_extents),
+			print_extent_cmp);
+
+	while (done < height) {
+		float page_top = done * settings->scale;
+		int crop = INT_MAX;
+
+		if (print_page_count % 64 == 0) {
+			float *tmp;
+
+			tmp = realloc(print_page_begin,
+					(print_page_count + 64) *
+					sizeof(*print_page_begin));
+			if (tmp == NULL) {
+				free(print_page_begin);
+				print_page_begin = NULL;
+				print_page_count = 0;
+				return false;
+			}
+			print_page_begin = tmp;
+		}
+		print_page_begin[print_page_count++] = done;
+
+		/* skip extents wholly on earlier pages */
+		while (start < print_extent_count &&
+				print_extents[start].y1 <= page_top)
+			start++;
+
+		/* find the topmost box deferred to the next page */
+		for (i = start; i < print_extent_count &&
+				print_extents[i].y0 < page_top + border_h;
+				i++) {
+			if (print_extents[i].y1 <= page_top)
+				continue;
+			if (print_extents[i].y1 > page_top + border_h &&
+					print_extents[i].y1 -
+					print_extents[i].y0 <= border_h) {
+				int rel = print_extents[i].y0 - page_top;
+				if (rel < crop)
+					crop = rel;
+			}
+		}
+
+		done += page_content_height - (crop != INT_MAX ?
+				(border_h - crop) / settings->scale : 0);
+	}
+
+	NSLOG(netsurf, INFO, "Paginated into %u pages", print_page_count);
+
+	return true;
+}
+
+
 /**
  * This function prepares the content to be printed. The current browser content
  * is duplicated and resized, printer initialization is called.
@@ -159,6 +457,10 @@ bool print_set_up(hlcache_handle *content,
 	if (height)
 		*height = content_get_height(printed_content);
 
+	/* compute all page break positions up front where possible */
+	print_paginate(printed_content, settings);
+	print_current_page = 0;
+
 	printer->print_begin(settings);
 
 	done_height = 0;
@@ -208,10 +510,20 @@ bool print_draw_next_page(const struct printer *printer,
 	if (!content_redraw(printed_content, &data, &clip, &ctx))
 		return false;
 
-	done_height += page_content_height -
-			(html_redraw_printing_top_cropped != INT_MAX ?
-			clip.y1 - html_redraw_printing_top_cropped : 0) /
-			settings->scale;
+	if (print_page_begin != NULL) {
+		/* breaks were all computed during set up */
+		print_current_page++;
+		if (print_current_page < print_page_count) {
+			done_height = print_page_begin[print_current_page];
+		} else {
+			done_height = content_get_height(printed_content);
+		}
+	} else {
+		done_height += page_content_height -
+				(html_redraw_printing_top_cropped != INT_MAX ?
+				clip.y1 - html_redraw_printing_top_cropped : 0) /
+				settings->scale;
+	}
 
 	return true;
 }
@@ -232,6 +544,15 @@ bool print_cleanup(hlcache_handle *content, const struct printer *printer,
 
 	html_redraw_printing = false;
 
+	free(print_extents);
+	print_extents = NULL;
+	print_extent_count = 0;
+	print_extent_alloc = 0;
+
+	free(print_page_begin);
+	print_page_begin = NULL;
+	print_page_count = 0;
+
 	if (printed_content) {
 		hlcache_handle_release(printed_content);
 	}
@@ -67,8 +67,21 @@ struct print_settings{
 };
 
 
-bool print_basic_run(struct hlcache_handle *, const struct printer *, 
+/**
+ * Callback made when a print run started with print_basic_run_async()
+ * has finished.
+ *
+ * \param ctx      Context pointer passed to print_basic_run_async()
+ * \param success  true if the whole content was printed
+ */
+typedef void (*print_done_cb)(void *ctx, bool success);
+
+bool print_basic_run(struct hlcache_handle *, const struct printer *,
 		struct print_settings *);
+bool print_basic_run_async(struct hlcache_handle *content,
+		const struct printer *printer,
+		struct print_settings *settings,
+		print_done_cb done, void *done_ctx);
 bool print_set_up(struct hlcache_handle *content, const struct printer *printer,
 		struct print_settings *settings, double *height);
 bool print_draw_next_page(const struct printer *printer,
@@ -40,6 +40,7 @@
 #include "utils/file.h"
 #include "utils/messages.h"
 #include "utils/ascii.h"
+#include "utils/libdom.h"
 #include "netsurf/content.h"
 #include "content/hlcache.h"
 #include "css/css.h"
@@ -67,16 +68,20 @@ typedef struct save_complete_ctx {
     nsurl *base;
     FILE *fp;
     enum { STATE_NORMAL, STATE_IN_STYLE } iter_state;
-} save_complete_ctx;
 
-typedef enum {
-	EVENT_ENTER,
-	EVENT_LEAVE
-} save_complete_event_type;
+    /* state for asynchronous saves */
+    struct hlcache_handle *root; /**< root content being saved */
+    save_complete_entry *next_save; /**< next entry to write out */
+    unsigned int total; /**< number of resources to write */
+    unsigned int saved; /**< number of resources written */
+    save_complete_progress_cb progress;
+    save_complete_done_cb done;
+    void *cbctx; /**< context for progress and done callbacks */
+} save_complete_ctx;
 
 
-static nserror save_complete_save_html(save_complete_ctx *ctx, struct hlcache_handle *c, bool index);
-static nserror save_complete_save_imported_sheets(save_complete_ctx *ctx,
+static nserror save_complete_collect_html(save_complete_ctx *ctx, struct hlcache_handle *c);
+static nserror save_complete_collect_imported_sheets(save_complete_ctx *ctx,
 		struct nscss_import *imports, uint32_t import_count);
 
 
@@ -141,21 +146,6 @@ save_complete_ctx_find_content(save_complete_ctx *ctx, const nsurl *url)
 }
 
 
-static bool
-save_complete_ctx_has_content(save_complete_ctx *ctx,
-			      struct hlcache_handle *content)
-{
-	save_complete_entry *entry;
-
-	for (entry = ctx->list; entry != NULL; entry = entry->next) {
-		if (hlcache_handle_get_content(entry->content) ==
-		    hlcache_handle_get_content(content))
-			return true;
-	}
-
-	return false;
-}
-
 static nserror
 save_complete_save_buffer(save_complete_ctx *ctx,
 			  const char *leafname,
@@ -356,6 +346,12 @@ save_complete_rewrite_stylesheet_urls(save_complete_ctx *ctx,
 	return rewritten;
 }
 
+/**
+ * Write out a stylesheet which has already been collected.
+ *
+ * The context's content list must be complete so \@import rules can
+ * be rewritten to reference their saved filenames.
+ */
 static nserror
 save_complete_save_stylesheet(save_complete_ctx *ctx, hlcache_handle *css)
 {
@@ -363,30 +359,10 @@ save_complete_save_stylesheet(save_complete_ctx *ctx, hlcache_handle *css)
 	size_t css_size;
 	uint8_t *source;
 	size_t source_len;
-	struct nscss_import *imports;
-	uint32_t import_count;
 	lwc_string *type;
 	char filename[32];
 	nserror result;
 
-	if (save_complete_ctx_find_content(ctx,
-			hlcache_handle_get_url(css)) != NULL) {
-		return NSERROR_OK;
-	}
-
-	result = save_complete_ctx_add_content(ctx, css);
-	if (result != NSERROR_OK) {
-		return result;
-	}
-
-	imports = nscss_get_imports(css, &import_count);
-	result = save_complete_save_imported_sheets(ctx,
-						    imports,
-						    import_count);
-	if (result != NSERROR_OK) {
-		return result;
-	}
-
 	css_data = content_get_source_data(css, &css_size);
 	source = save_complete_rewrite_stylesheet_urls(
 		ctx,
@@ -415,10 +391,37 @@ save_complete_save_stylesheet(save_complete_ctx *ctx, hlcache_handle *css)
 	return result;
 }
 
+/**
+ * Add a stylesheet and any sheets it imports to the content list.
+ */
 static nserror
-save_complete_save_imported_sheets(save_complete_ctx *ctx,
-				   struct nscss_import *imports,
-				   uint32_t import_count)
+save_complete_collect_stylesheet(save_complete_ctx *ctx, hlcache_handle *css)
+{
+	struct nscss_import *imports;
+	uint32_t import_count;
+	nserror result;
+
+	if (save_complete_ctx_find_content(ctx,
+			hlcache_handle_get_url(css)) != NULL) {
+		return NSERROR_OK;
+	}
+
+	result = save_complete_ctx_add_content(ctx, css);
+	if (result != NSERROR_OK) {
+		return result;
+	}
+
+	imports = nscss_get_imports(css, &import_count);
+
+	return save_complete_collect_imported_sheets(ctx,
+						     imports,
+						     import_count);
+}
+
+static nserror
+save_complete_collect_imported_sheets(save_complete_ctx *ctx,
+				      struct nscss_import *imports,
+				      uint32_t import_count)
 {
 	nserror res = NSERROR_OK;
 	uint32_t i;
@@ -426,7 +429,8 @@ save_complete_save_imported_sheets(save_complete_ctx *ctx,
 	for (i = 0; i < import_count; i++) {
 		/* treat a valid content as a stylesheet to save */
 		if (imports[i].c != NULL) {
-			res = save_complete_save_stylesheet(ctx, imports[i].c);
+			res = save_complete_collect_stylesheet(ctx,
+							       imports[i].c);
 			if (res != NSERROR_OK) {
 				return res;
 			}
@@ -437,19 +441,19 @@ save_complete_save_imported_sheets(save_complete_ctx *ctx,
 }
 
 static nserror
-save_complete_save_html_stylesheet(save_complete_ctx *ctx,
-				   struct html_stylesheet *sheet)
+save_complete_collect_html_stylesheet(save_complete_ctx *ctx,
+				      struct html_stylesheet *sheet)
 {
 	if (sheet->sheet == NULL) {
 		return NSERROR_OK;
 	}
 
-	return save_complete_save_stylesheet(ctx, sheet->sheet);
+	return save_complete_collect_stylesheet(ctx, sheet->sheet);
 }
 
 static nserror
-save_complete_save_html_stylesheets(save_complete_ctx *ctx,
-				    hlcache_handle *c)
+save_complete_collect_html_stylesheets(save_complete_ctx *ctx,
+				       hlcache_handle *c)
 {
 	struct html_stylesheet *sheets;
 	unsigned int i, count;
@@ -458,7 +462,7 @@ save_complete_save_html_stylesheets(save_complete_ctx *ctx,
 	sheets = html_get_stylesheets(c, &count);
 
 	for (i = STYLESHEET_START; i != count; i++) {
-		res = save_complete_save_html_stylesheet(ctx, &sheets[i]);
+		res = save_complete_collect_html_stylesheet(ctx, &sheets[i]);
 		if (res != NSERROR_OK) {
 			return res;
 		}
@@ -467,8 +471,11 @@ save_complete_save_html_stylesheets(save_complete_ctx *ctx,
 	return NSERROR_OK;
 }
 
+/**
+ * Write out an object which has already been collected.
+ */
 static nserror
-save_complete_save_html_object(save_complete_ctx *ctx, hlcache_handle *obj)
+save_complete_save_object(save_complete_ctx *ctx, hlcache_handle *obj)
 {
 	const uint8_t *obj_data;
 	size_t obj_size;
@@ -476,6 +483,32 @@ save_complete_save_html_object(save_complete_ctx *ctx, hlcache_handle *obj)
 	nserror result;
 	char filename[32];
 
+	obj_data = content_get_source_data(obj, &obj_size);
+	if (obj_data == NULL) {
+		return NSERROR_OK;
+	}
+
+	snprintf(filename, sizeof filename, "%p", obj);
+
+	type = content_get_mime_type(obj);
+	if (type == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	result = save_complete_save_buffer(ctx, filename, obj_data, obj_size, type);
+
+	lwc_string_unref(type);
+
+	return result;
+}
+
+static nserror
+save_complete_collect_html_object(save_complete_ctx *ctx, hlcache_handle *obj)
+{
+	const uint8_t *obj_data;
+	size_t obj_size;
+	nserror result;
+
 	if (content_get_type(obj) == CONTENT_NONE) {
 		return NSERROR_OK;
 	}
@@ -496,26 +529,15 @@ save_complete_save_html_object(save_complete_ctx *ctx, hlcache_handle *obj)
 	}
 
 	if (content_get_type(obj) == CONTENT_HTML) {
-		return save_complete_save_html(ctx, obj, false);
+		return save_complete_collect_html(ctx, obj);
 	}
 
-	snprintf(filename, sizeof filename, "%p", obj);
-
-	type = content_get_mime_type(obj);
-	if (type == NULL) {
-		return NSERROR_NOMEM;
-	}
-
-	result = save_complete_save_buffer(ctx, filename, obj_data, obj_size, type);
-
-	lwc_string_unref(type);
-
-	return result;
+	return NSERROR_OK;
 }
 
 static nserror
-save_complete_save_html_objects(save_complete_ctx *ctx,
-				hlcache_handle *c)
+save_complete_collect_html_objects(save_complete_ctx *ctx,
+				   hlcache_handle *c)
 {
 	struct content_html_object *object;
 	unsigned int count;
@@ -526,7 +548,8 @@ save_complete_save_html_objects(save_complete_ctx *ctx,
 	for (; object != NULL; object = object->next) {
 		if ((object->content != NULL) &&
 		    (object->box != NULL)) {
-			res = save_complete_save_html_object(ctx, object->content);
+			res = save_complete_collect_html_object(ctx,
+							object->content);
 			if (res != NSERROR_OK) {
 				return res;
 			}
@@ -536,102 +559,6 @@ save_complete_save_html_objects(save_complete_ctx *ctx,
 	return NSERROR_OK;
 }
 
-static bool
-save_complete_libdom_treewalk(dom_node *root,
-			      bool (*callback)(dom_node *node,
-				       save_complete_event_type event_type,
-					       void *ctx),
-			      void *ctx)
-{
-	dom_node *node;
-
-	node = dom_node_ref(root); /* tree root */
-
-	while (node != NULL) {
-		dom_node *next = NULL;
-		dom_exception exc;
-
-		exc = dom_node_get_first_child(node, &next);
-		if (exc != DOM_NO_ERR) {
-			dom_node_unref(node);
-			break;
-		}
-
-		if (next != NULL) {  /* 1. children */
-			dom_node_unref(node);
-			node = next;
-		} else {
-			exc = dom_node_get_next_sibling(node, &next);
-			if (exc != DOM_NO_ERR) {
-				dom_node_unref(node);
-				break;
-			}
-
-			if (next != NULL) {  /* 2. siblings */
-				if (callback(node, EVENT_LEAVE, ctx) == false) {
-					return false;
-				}
-				dom_node_unref(node);
-				node = next;
-			} else {  /* 3. ancestor siblings */
-				while (node != NULL) {
-					exc = dom_node_get_next_sibling(node,
-							&next);
-					if (exc != DOM_NO_ERR) {
-						dom_node_unref(node);
-						node = NULL;
-						break;
-					}
-
-					if (next != NULL) {
-						dom_node_unref(next);
-						break;
-					}
-
-					exc = dom_node_get_parent_node(node,
-							&next);
-					if (exc != DOM_NO_ERR) {
-						dom_node_unref(node);
-						node = NULL;
-						break;
-					}
-
-					if (callback(node, EVENT_LEAVE,
-							ctx) == false) {
-						return false;
-					}
-					dom_node_unref(node);
-					node = next;
-				}
-
-				if (node == NULL)
-					break;
-
-				exc = dom_node_get_next_sibling(node, &next);
-				if (exc != DOM_NO_ERR) {
-					dom_node_unref(node);
-					break;
-				}
-
-				if (callback(node, EVENT_LEAVE, ctx) == false) {
-					return false;
-				}
-				dom_node_unref(node);
-				node = next;
-			}
-		}
-
-		assert(node != NULL);
-
-		if (callback(node, EVENT_ENTER, ctx) == false) {
-			return false; /* callback caused early termination */
-		}
-
-	}
-
-	return true;
-}
-
 static bool save_complete_rewrite_url_value(save_complete_ctx *ctx,
 		const char *value, size_t value_len)
 {
@@ -864,7 +791,7 @@ save_complete_handle_attrs(save_complete_ctx *ctx,
 static bool
 save_complete_handle_element(save_complete_ctx *ctx,
 			     dom_node *node,
-			     save_complete_event_type event_type)
+			     libdom_treewalk_event event_type)
 {
 	dom_string *name;
 	dom_namednodemap *attrs;
@@ -892,7 +819,7 @@ save_complete_handle_element(save_complete_ctx *ctx,
 	} else if ((name_len == SLEN("meta")) &&
 		   (strncasecmp(name_data, "meta", name_len) == 0)) {
 		/* Don't emit close tags for META elements */
-		if (event_type == EVENT_LEAVE) {
+		if (event_type == LIBDOM_TREEWALK_LEAVE) {
 			process = false;
 		} else {
 			/* Elide meta charsets */
@@ -928,7 +855,7 @@ save_complete_handle_element(save_complete_ctx *ctx,
 					process = false;
 			}
 		}
-	} else if (event_type == EVENT_LEAVE &&
+	} else if (event_type == LIBDOM_TREEWALK_LEAVE &&
 			((name_len == SLEN("link") &&
 			strncasecmp(name_data, "link", name_len) == 0))) {
 		/* Don't emit close tags for void elements */
@@ -941,12 +868,12 @@ save_complete_handle_element(save_complete_ctx *ctx,
 	}
 
 	fputc('<', ctx->fp);
-	if (event_type == EVENT_LEAVE) {
+	if (event_type == LIBDOM_TREEWALK_LEAVE) {
 		fputc('/', ctx->fp);
 	}
 	fwrite(name_data, sizeof(*name_data), name_len, ctx->fp);
 
-	if (event_type == EVENT_ENTER) {
+	if (event_type == LIBDOM_TREEWALK_ENTER) {
 		error = dom_node_get_attributes(node, &attrs);
 		if (error != DOM_NO_ERR) {
 			dom_string_unref(name);
@@ -965,7 +892,7 @@ save_complete_handle_element(save_complete_ctx *ctx,
 	fputc('>', ctx->fp);
 
 	/* Rewrite contents of style elements */
-	if (event_type == EVENT_ENTER && name_len == SLEN("style") &&
+	if (event_type == LIBDOM_TREEWALK_ENTER && name_len == SLEN("style") &&
 			strncasecmp(name_data, "style", name_len) == 0) {
 		dom_string *content;
 
@@ -1000,7 +927,7 @@ save_complete_handle_element(save_complete_ctx *ctx,
 		}
 
 		ctx->iter_state = STATE_IN_STYLE;
-	} else if (event_type == EVENT_ENTER && name_len == SLEN("head") &&
+	} else if (event_type == LIBDOM_TREEWALK_ENTER && name_len == SLEN("head") &&
 			strncasecmp(name_data, "head", name_len) == 0) {
 		/* If this is a HEAD element, insert a meta charset */
 		fputs("<META http-equiv=\"Content-Type\" "
@@ -1015,7 +942,7 @@ save_complete_handle_element(save_complete_ctx *ctx,
 
 static bool
 save_complete_node_handler(dom_node *node,
-			   save_complete_event_type event_type,
+			   libdom_treewalk_event event_type,
 			   void *ctxin)
 {
 	save_complete_ctx *ctx = ctxin;
@@ -1030,7 +957,7 @@ save_complete_node_handler(dom_node *node,
 	if (type == DOM_ELEMENT_NODE) {
 		return save_complete_handle_element(ctx, node, event_type);
 	} else if (type == DOM_TEXT_NODE || type == DOM_COMMENT_NODE) {
-		if (event_type != EVENT_ENTER)
+		if (event_type != LIBDOM_TREEWALK_ENTER)
 			return true;
 
 		if (ctx->iter_state != STATE_IN_STYLE) {
@@ -1076,7 +1003,7 @@ save_complete_node_handler(dom_node *node,
 		const char *name_data;
 		size_t name_len;
 
-		if (event_type != EVENT_ENTER)
+		if (event_type != LIBDOM_TREEWALK_ENTER)
 			return true;
 
 		error = dom_document_type_get_name(node, &name);
@@ -1170,9 +1097,9 @@ save_complete_save_html_document(save_complete_ctx *ctx,
 
 	doc = html_get_document(c);
 
-	if (save_complete_libdom_treewalk((dom_node *)doc,
-					  save_complete_node_handler,
-					  ctx) == false) {
+	if (libdom_treewalk((dom_node *)doc,
+			    save_complete_node_handler,
+			    ctx) == false) {
 		free(fname);
 		fclose(fp);
 		return NSERROR_NOMEM;
@@ -1194,17 +1121,18 @@ save_complete_save_html_document(save_complete_ctx *ctx,
 }
 
 /**
- * Save an HTML page with all dependencies, recursing through imported pages.
+ * Gather the dependencies of an HTML page, recursing through imported pages.
+ *
+ * Adds every stylesheet and object the page requires to the context's
+ * content list without writing anything, so the complete list is
+ * available when rewriting URLs during the write out phase.
  *
  * \param  ctx    Save complete context
- * \param  c      Content to save
- * \param  index  true to save as "index"
- * \return  true on success, false on error and error reported
+ * \param  c      Content to gather dependencies of
+ * \return NSERROR_OK on success else error code
  */
 static nserror
-save_complete_save_html(save_complete_ctx *ctx,
-			hlcache_handle *c,
-			bool index)
+save_complete_collect_html(save_complete_ctx *ctx, hlcache_handle *c)
 {
 	nserror res;
 
@@ -1212,21 +1140,37 @@ save_complete_save_html(save_complete_ctx *ctx,
 		return NSERROR_INVALID;
 	}
 
-	if (save_complete_ctx_has_content(ctx, c)) {
-		return NSERROR_OK;
-	}
-
-	res = save_complete_save_html_stylesheets(ctx, c);
+	res = save_complete_collect_html_stylesheets(ctx, c);
 	if (res != NSERROR_OK) {
 		return res;
 	}
 
-	res = save_complete_save_html_objects(ctx, c);
-	if (res != NSERROR_OK) {
-		return res;
-	}
+	return save_complete_collect_html_objects(ctx, c);
+}
+
+
+/**
+ * Write out a single collected resource.
+ *
+ * \param  ctx    Save complete context
+ * \param  entry  Entry in the content list to write
+ * \return NSERROR_OK on success else error code
+ */
+static nserror
+save_complete_save_entry(save_complete_ctx *ctx, save_complete_entry *entry)
+{
+	switch (content_get_type(entry->content)) {
+	case CONTENT_HTML:
+		return save_complete_save_html_document(ctx,
+							entry->content,
+							false);
 
-	return save_complete_save_html_document(ctx, c, index);
+	case CONTENT_CSS:
+		return save_complete_save_stylesheet(ctx, entry->content);
+
+	default:
+		return save_complete_save_object(ctx, entry->content);
+	}
 }
 
 
@@ -1333,10 +1277,21 @@ save_complete(hlcache_handle *c,
 {
 	nserror result;
 	save_complete_ctx ctx;
+	save_complete_entry *entry;
 
 	save_complete_ctx_initialise(&ctx, path, set_type);
 
-	result = save_complete_save_html(&ctx, c, true);
+	result = save_complete_collect_html(&ctx, c);
+
+	for (entry = ctx.list;
+	     (result == NSERROR_OK) && (entry != NULL);
+	     entry = entry->next) {
+		result = save_complete_save_entry(&ctx, entry);
+	}
+
+	if (result == NSERROR_OK) {
+		result = save_complete_save_html_document(&ctx, c, true);
+	}
 
 	if (result == NSERROR_OK) {
 		result = save_complete_inventory(&ctx);
@@ -1346,3 +1301,125 @@ save_complete(hlcache_handle *c,
 
 	return result;
 }
+
+
+/**
+ * Finish an asynchronous save, reporting the result.
+ */
+static void
+save_complete_async_done(save_complete_ctx *ctx, nserror result)
+{
+	if (ctx->done != NULL) {
+		ctx->done(ctx->cbctx, result);
+	}
+
+	save_complete_ctx_finalise(ctx);
+	free((void *)ctx->path);
+	free(ctx);
+}
+
+
+/**
+ * Scheduler callback writing out one collected resource per call.
+ */
+static void save_complete_async_step(void *p)
+{
+	save_complete_ctx *ctx = p;
+	nserror result;
+
+	if (ctx->next_save != NULL) {
+		/* write the next collected resource */
+		result = save_complete_save_entry(ctx, ctx->next_save);
+		if (result != NSERROR_OK) {
+			save_complete_async_done(ctx, result);
+			return;
+		}
+
+		ctx->next_save = ctx->next_save->next;
+	} else {
+		/* all dependencies written; finish with the root page */
+		result = save_complete_save_html_document(ctx,
+							  ctx->root,
+							  true);
+		if (result == NSERROR_OK) {
+			result = save_complete_inventory(ctx);
+		}
+		if (result != NSERROR_OK) {
+			save_complete_async_done(ctx, result);
+			return;
+		}
+	}
+
+	ctx->saved++;
+
+	if (ctx->progress != NULL) {
+		ctx->progress(ctx->cbctx, ctx->saved, ctx->total);
+	}
+
+	if (ctx->saved < ctx->total) {
+		result = guit->misc->schedule(0, save_complete_async_step, ctx);
+		if (result != NSERROR_OK) {
+			save_complete_async_done(ctx, result);
+		}
+	} else {
+		save_complete_async_done(ctx, NSERROR_OK);
+	}
+}
+
+
+/* Documented in save_complete.h */
+nserror
+save_complete_async(hlcache_handle *c,
+		    const char *path,
+		    save_complete_set_type_cb set_type,
+		    save_complete_progress_cb progress,
+		    save_complete_done_cb done,
+		    void *cbctx)
+{
+	save_complete_ctx *ctx;
+	save_complete_entry *entry;
+	char *path_copy;
+	nserror result;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	path_copy = strdup(path);
+	if (path_copy == NULL) {
+		free(ctx);
+		return NSERROR_NOMEM;
+	}
+
+	save_complete_ctx_initialise(ctx, path_copy, set_type);
+	ctx->root = c;
+	ctx->progress = progress;
+	ctx->done = done;
+	ctx->cbctx = cbctx;
+
+	/* gather the dependencies up front; writing is deferred */
+	result = save_complete_collect_html(ctx, c);
+	if (result != NSERROR_OK) {
+		save_complete_ctx_finalise(ctx);
+		free(path_copy);
+		free(ctx);
+		return result;
+	}
+
+	ctx->next_save = ctx->list;
+	ctx->saved = 0;
+	ctx->total = 1; /* the root page itself */
+	for (entry = ctx->list; entry != NULL; entry = entry->next) {
+		ctx->total++;
+	}
+
+	result = guit->misc->schedule(0, save_complete_async_step, ctx);
+	if (result != NSERROR_OK) {
+		save_complete_ctx_finalise(ctx);
+		free(path_copy);
+		free(ctx);
+	}
+
+	return result;
+}
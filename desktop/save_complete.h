@@ -39,6 +39,24 @@ struct hlcache_handle;
 typedef void (*save_complete_set_type_cb)(const char *path,
 		lwc_string *mime_type);
 
+/**
+ * Callback to report progress of an asynchronous save
+ *
+ * \param ctx    Context pointer passed to save_complete_async()
+ * \param saved  Number of resources written so far
+ * \param total  Total number of resources to write
+ */
+typedef void (*save_complete_progress_cb)(void *ctx,
+		unsigned int saved, unsigned int total);
+
+/**
+ * Callback made when an asynchronous save finishes
+ *
+ * \param ctx     Context pointer passed to save_complete_async()
+ * \param result  NSERROR_OK on success else error code
+ */
+typedef void (*save_complete_done_cb)(void *ctx, nserror result);
+
 /**
  * Initialise save complete module.
  */
@@ -61,4 +79,26 @@ nserror save_complete_finalise(void);
 nserror save_complete(struct hlcache_handle *c, const char *path,
 		save_complete_set_type_cb set_type);
 
+/**
+ * Save an HTML page with all dependencies without blocking.
+ *
+ * The dependencies of the page are gathered up front and then written
+ * out one resource at a time from the browser scheduler, so the
+ * interface remains responsive while a large page is saved. The
+ * content and path must remain valid until the done callback is made.
+ *
+ * \param  c         CONTENT_HTML to save
+ * \param  path      Native path to directory to save in to (must exist)
+ * \param  set_type  Callback to set type of a file, or NULL
+ * \param  progress  Callback to report progress, or NULL
+ * \param  done      Callback made on completion, or NULL
+ * \param  cbctx     Context pointer passed to the callbacks
+ * \return NSERROR_OK if the save was started else error code
+ */
+nserror save_complete_async(struct hlcache_handle *c, const char *path,
+		save_complete_set_type_cb set_type,
+		save_complete_progress_cb progress,
+		save_complete_done_cb done,
+		void *cbctx);
+
 #endif
@@ -23,6 +23,8 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <dom/dom.h>
@@ -46,9 +48,114 @@ static bool save_text_add_to_buffer(const char *text, size_t length,
 		size_t whitespace_length, struct save_text_state *save);
 
 
+/**
+ * Flush pending text to the output file.
+ *
+ * The pending UTF-8 is converted to the local encoding and written
+ * out. Unless this is the final flush any incomplete multibyte
+ * sequence at the end of the buffer is held back so a character is
+ * never split across two conversion calls.
+ *
+ * \param  save		Our save_text_state workspace pointer.
+ * \param  final	Whether this is the last flush of the save.
+ * \return true iff conversion and writing succeeded.
+ */
+
+static bool save_text_flush(struct save_text_state *save, bool final)
+{
+	size_t len = save->length;
+	nserror ret;
+	char *result;
+
+	if (!final && len > 0) {
+		/* find the start of the last character in the buffer */
+		size_t last = len - 1;
+		size_t expected = 1;
+
+		while (last > 0 && (save->buffer[last] & 0xc0) == 0x80)
+			last--;
+
+		if ((save->buffer[last] & 0xe0) == 0xc0)
+			expected = 2;
+		else if ((save->buffer[last] & 0xf0) == 0xe0)
+			expected = 3;
+		else if ((save->buffer[last] & 0xf8) == 0xf0)
+			expected = 4;
+
+		if (last + expected > len) {
+			/* sequence incomplete; hold it back */
+			len = last;
+		}
+	}
+
+	if (len == 0)
+		return true;
+
+	ret = guit->utf8->utf8_to_local(save->buffer, len, &result);
+	if (ret != NSERROR_OK) {
+		NSLOG(netsurf, INFO,
+		      "failed to convert to local encoding, return %d", ret);
+		save->error = true;
+		return false;
+	}
+
+	if (fputs(result, save->fp) < 0) {
+		NSLOG(netsurf, INFO, "Warning: write failed");
+		free(result);
+		save->error = true;
+		return false;
+	}
+	free(result);
+
+	/* retain any held back partial character */
+	memmove(save->buffer, save->buffer + len, save->length - len);
+	save->length -= len;
+
+	return true;
+}
+
+
+/**
+ * Append text to the pending buffer, flushing to the file as it fills.
+ *
+ * \param  save		Our save_text_state workspace pointer.
+ * \param  text		Pointer to UTF-8 text being added.
+ * \param  length	Length of text to be appended (bytes).
+ * \return true iff successful.
+ */
+
+static bool
+save_text_write(struct save_text_state *save, const char *text, size_t length)
+{
+	size_t space;
+	size_t chunk;
+
+	if (save->error)
+		return false;
+
+	while (length > 0) {
+		space = sizeof(save->buffer) - save->length;
+		if (space == 0) {
+			if (!save_text_flush(save, false))
+				return false;
+			space = sizeof(save->buffer) - save->length;
+		}
+
+		chunk = (length < space) ? length : space;
+		memcpy(save->buffer + save->length, text, chunk);
+		save->length += chunk;
+		text += chunk;
+		length -= chunk;
+	}
+
+	return true;
+}
+
+
 /**
  * Extract the text from an HTML content and save it as a text file. Text is
- * converted to the local encoding.
+ * converted to the local encoding and streamed out in chunks, so the
+ * whole extracted text is never held in memory at once.
  *
  * \param  c		An HTML content.
  * \param  path		Path to save text file too.
@@ -56,48 +163,30 @@ static bool save_text_add_to_buffer(const char *text, size_t length,
 
 void save_as_text(struct hlcache_handle *c, char *path)
 {
-	FILE *out;
-	struct save_text_state save = { NULL, 0, 0 };
+	struct save_text_state save = { .length = 0, .error = false };
 	save_text_whitespace before = WHITESPACE_NONE;
 	bool first = true;
-	nserror ret;
-	char *result;
 
 	if (!c || content_get_type(c) != CONTENT_HTML) {
 		return;
 	}
 
-	extract_text(html_get_box_tree(c), &first, &before, &save);
-	if (!save.block)
-		return;
-
-	ret = guit->utf8->utf8_to_local(save.block, save.length, &result);
-	free(save.block);
-
-	if (ret != NSERROR_OK) {
-		NSLOG(netsurf, INFO,
-		      "failed to convert to local encoding, return %d", ret);
+	save.fp = fopen(path, "w");
+	if (save.fp == NULL) {
+		NSLOG(netsurf, INFO, "Warning: unable to open %s", path);
 		return;
 	}
 
-	out = fopen(path, "w");
-	if (out) {
-		int res = fputs(result, out);
+	extract_text(html_get_box_tree(c), &first, &before, &save);
 
-		if (res < 0) {
-			NSLOG(netsurf, INFO, "Warning: write failed");
-		}
+	save_text_flush(&save, true);
 
-		res = fputs("\n", out);
-		if (res < 0) {
-			NSLOG(netsurf, INFO,
-			      "Warning: failed writing trailing newline");
-		}
-
-		fclose(out);
+	if (!save.error && fputs("\n", save.fp) < 0) {
+		NSLOG(netsurf, INFO,
+		      "Warning: failed writing trailing newline");
 	}
 
-	free(result);
+	fclose(save.fp);
 }
 
 
@@ -255,7 +344,7 @@ void extract_text(struct box *box, bool *first, save_text_whitespace *before,
 
 /**
  * Add text to save text buffer. Any preceding whitespace or following space is
- * also added to the buffer.
+ * also added to the buffer, which is streamed to the output file as it fills.
  *
  * \param  text		Pointer to text being added.
  * \param  length	Length of text to be appended (bytes).
@@ -271,39 +360,21 @@ bool save_text_add_to_buffer(const char *text, size_t length, struct box *box,
 		const char *whitespace_text, size_t whitespace_length,
 		struct save_text_state *save)
 {
-	size_t new_length;
-	int space = 0;
-
 	assert(save);
 
-	if (box->space > 0)
-		space = 1;
-
-	if (whitespace_text)
-		length += whitespace_length;
-
-	new_length = save->length + whitespace_length + length + space;
-	if (new_length >= save->alloc) {
-		size_t new_alloc = save->alloc + (save->alloc / 4);
-		char *new_block;
-
-		if (new_alloc < new_length) new_alloc = new_length;
-
-		new_block = realloc(save->block, new_alloc);
-		if (!new_block) return false;
-
-		save->block = new_block;
-		save->alloc = new_alloc;
-	}
 	if (whitespace_text) {
-		memcpy(save->block + save->length, whitespace_text,
-				whitespace_length);
+		if (!save_text_write(save, whitespace_text,
+				whitespace_length))
+			return false;
 	}
-	memcpy(save->block + save->length + whitespace_length, text, length);
-	save->length += length;
 
-	if (space == 1)
-		save->block[save->length++] = ' ';
+	if (!save_text_write(save, text, length))
+		return false;
+
+	if (box->space > 0) {
+		if (!save_text_write(save, " ", 1))
+			return false;
+	}
 
 	return true;
 }
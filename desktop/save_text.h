@@ -24,14 +24,20 @@
 #ifndef _NETSURF_DESKTOP_SAVE_TEXT_H_
 #define _NETSURF_DESKTOP_SAVE_TEXT_H_
 
+#include <stdio.h>
+
 struct box;
 struct hlcache_handle;
 
+/** Size of the streaming save buffer */
+#define SAVE_TEXT_BUFFER_SIZE 4096
+
 /* text currently being saved */
 struct save_text_state {
-	char *block;
-	size_t length;
-	size_t alloc;
+	FILE *fp; /**< output file */
+	char buffer[SAVE_TEXT_BUFFER_SIZE]; /**< UTF-8 awaiting conversion */
+	size_t length; /**< bytes pending in buffer */
+	bool error; /**< a conversion or write has failed */
 };
 
 typedef enum {
@@ -36,8 +36,16 @@
 #include "netsurf/plotters.h"
 
 #include "desktop/system_colour.h"
+#include "desktop/gui_internal.h"
+#include "netsurf/misc.h"
 #include "desktop/scrollbar.h"
 
+/** Milliseconds between animated scrolling steps */
+#define SCROLLBAR_ANIM_INTERVAL 15
+
+/** Share of the remaining distance covered by an animation step */
+#define SCROLLBAR_ANIM_FRACTION 4
+
 /**
  * Scrollbar context
  */
@@ -82,8 +90,19 @@ struct scrollbar {
 	 *  perpendicular scrollbar too
 	 */
 	bool pair_drag;
+
+	/** Animated scrolling is heading for anim_target */
+	bool anim_active;
+	/** The animation is applying a step of its own */
+	bool anim_stepping;
+	/** Offset the animation is heading for */
+	int anim_target;
+	/** Animated position in 1/256ths of a pixel */
+	int anim_pos;
 };
 
+static void scrollbar_animate_cb(void *p);
+
 
 
 /*
@@ -126,6 +145,11 @@ scrollbar_create(bool horizontal,
 	scrollbar->dragging = false;
 	scrollbar->drag_content = false;
 
+	scrollbar->anim_active = false;
+	scrollbar->anim_stepping = false;
+	scrollbar->anim_target = 0;
+	scrollbar->anim_pos = 0;
+
 	*s = scrollbar;
 
 	return NSERROR_OK;
@@ -137,6 +161,9 @@ scrollbar_create(bool horizontal,
  */
 void scrollbar_destroy(struct scrollbar *s)
 {
+	if (s->anim_active) {
+		guit->misc->schedule(-1, scrollbar_animate_cb, s);
+	}
 	if (s->pair != NULL) {
 		s->pair->pair = NULL;
 	}
@@ -515,6 +542,12 @@ void scrollbar_set(struct scrollbar *s, int value, bool bar_pos)
 	int old_offset = s->offset;
 	struct scrollbar_msg_data msg;
 
+	if (s->anim_active && !s->anim_stepping) {
+		/* an absolute placement supersedes any animation */
+		guit->misc->schedule(-1, scrollbar_animate_cb, s);
+		s->anim_active = false;
+	}
+
 	if (value < 0) {
 		value = 0;
 	}
@@ -551,11 +584,51 @@ void scrollbar_set(struct scrollbar *s, int value, bool bar_pos)
 		msg.scrollbar = s;
 		msg.msg = SCROLLBAR_MSG_MOVED;
 		msg.scroll_offset = s->offset;
+		msg.old_scroll_offset = old_offset;
 		s->client_callback(s->client_data, &msg);
 	}
 }
 
 
+/**
+ * Apply one step of an animated scroll.
+ *
+ * Each step covers a share of the distance still to go, easing the
+ * movement out as the target is approached. The position is kept in
+ * sub-pixel units so the fractional part of each step is carried
+ * rather than lost.
+ *
+ * \param p The scrollbar being animated.
+ */
+static void scrollbar_animate_cb(void *p)
+{
+	struct scrollbar *s = p;
+	int dist, step;
+
+	dist = (s->anim_target * 256) - s->anim_pos;
+	if (dist > -256 && dist < 256) {
+		/* within a pixel of the target; finish */
+		s->anim_pos = s->anim_target * 256;
+		s->anim_active = false;
+	} else {
+		step = dist / SCROLLBAR_ANIM_FRACTION;
+		if (step > -256 && step < 256) {
+			/* never step less than a pixel or the
+			 * animation would stall short of the target
+			 */
+			step = (dist < 0) ? -256 : 256;
+		}
+		s->anim_pos += step;
+		guit->misc->schedule(SCROLLBAR_ANIM_INTERVAL,
+				     scrollbar_animate_cb, s);
+	}
+
+	s->anim_stepping = true;
+	scrollbar_set(s, (s->anim_pos + 128) / 256, false);
+	s->anim_stepping = false;
+}
+
+
 /*
  * Exported interface.  Documented in scrollbar.h
  */
@@ -593,6 +666,39 @@ bool scrollbar_scroll(struct scrollbar *s, int change)
 		break;
 	}
 
+	if (nsoption_bool(smooth_scrolling)) {
+		int target;
+
+		/* coalesce the change into any animation in flight */
+		target = (s->anim_active ? s->anim_target : s->offset) +
+			change;
+		if (target > s->full_size - s->visible_size) {
+			target = s->full_size - s->visible_size;
+		} else if (target < 0) {
+			target = 0;
+		}
+
+		if (s->anim_active) {
+			s->anim_target = target;
+			return true;
+		}
+
+		if (target == s->offset) {
+			/* already hard against the edge */
+			return false;
+		}
+
+		s->anim_pos = s->offset * 256;
+		if (guit->misc->schedule(SCROLLBAR_ANIM_INTERVAL,
+					 scrollbar_animate_cb,
+					 s) == NSERROR_OK) {
+			s->anim_active = true;
+			s->anim_target = target;
+			return true;
+		}
+		/* no animation possible; scroll immediately */
+	}
+
 	/* Get new offset */
 	old_offset = s->offset;
 	if (s->offset + change > s->full_size - s->visible_size) {
@@ -616,6 +722,7 @@ bool scrollbar_scroll(struct scrollbar *s, int change)
 	msg.scrollbar = s;
 	msg.msg = SCROLLBAR_MSG_MOVED;
 	msg.scroll_offset = s->offset;
+	msg.old_scroll_offset = old_offset;
 	s->client_callback(s->client_data, &msg);
 
 	return true;
@@ -634,6 +741,56 @@ int scrollbar_get_offset(struct scrollbar *s)
 }
 
 
+/*
+ * Exported interface.  Documented in scrollbar.h
+ */
+bool
+scrollbar_get_moved_rect(struct scrollbar *s, int old_offset, struct rect *rect)
+{
+	int well_length;
+	int old_bar_pos;
+	int p0, p1;
+
+	if (s == NULL || rect == NULL) {
+		return false;
+	}
+
+	well_length = s->length - 2 * SCROLLBAR_WIDTH;
+	if (well_length < 1) {
+		return false;
+	}
+
+	old_bar_pos = (s->full_size < 1) ? 0 :
+			((well_length * old_offset) / s->full_size);
+	if (old_bar_pos > well_length - s->bar_len) {
+		old_bar_pos = well_length - s->bar_len;
+	}
+	if (old_bar_pos < 0) {
+		old_bar_pos = 0;
+	}
+
+	/* the arrows are unchanged by a move; only the union of the
+	 * old and new bar positions, including the well between them,
+	 * needs repainting */
+	p0 = SCROLLBAR_WIDTH + min(old_bar_pos, s->bar_pos);
+	p1 = SCROLLBAR_WIDTH + max(old_bar_pos, s->bar_pos) + s->bar_len;
+
+	if (s->horizontal) {
+		rect->x0 = p0;
+		rect->y0 = 0;
+		rect->x1 = p1;
+		rect->y1 = SCROLLBAR_WIDTH;
+	} else {
+		rect->x0 = 0;
+		rect->y0 = p0;
+		rect->x1 = SCROLLBAR_WIDTH;
+		rect->y1 = p1;
+	}
+
+	return true;
+}
+
+
 /*
  * Exported interface.  Documented in scrollbar.h
  */
@@ -685,6 +842,8 @@ void scrollbar_set_extents(struct scrollbar *s, int length,
 	msg.scrollbar = s;
 	msg.msg = SCROLLBAR_MSG_MOVED;
 	msg.scroll_offset = s->offset;
+	/* the whole area needs redrawing anyway after an extent change */
+	msg.old_scroll_offset = s->offset;
 	s->client_callback(s->client_data, &msg);
 }
 
@@ -60,6 +60,9 @@ struct scrollbar_msg_data {
 	struct scrollbar *scrollbar;
 	scrollbar_msg msg;
 	int scroll_offset;
+	int old_scroll_offset;	/**< offset before a MOVED message, equal to
+				 * scroll_offset when the move can not be
+				 * expressed as a simple shift */
 	int x0, y0, x1, y1;
 };
 
@@ -161,6 +164,23 @@ bool scrollbar_scroll(struct scrollbar *s, int change);
  */
 int scrollbar_get_offset(struct scrollbar *s);
 
+/**
+ * Get the rectangle of a scrollbar needing redraw after a move.
+ *
+ * Only the union of the old and new bar positions, including the well
+ * between them, changes when a scrollbar moves, so a caller handling
+ * SCROLLBAR_MSG_MOVED can invalidate that rectangle rather than the
+ * whole widget.
+ *
+ * \param s the scrollbar which moved
+ * \param old_offset the scroll offset before the move
+ * \param rect updated with the changed area, relative to the
+ *		scrollbar's origin
+ * \return true if rect was filled in, else false
+ */
+bool scrollbar_get_moved_rect(struct scrollbar *s, int old_offset,
+		struct rect *rect);
+
 /**
  * Set the length of the scrollbar widget, the size of the visible area, and the
  * size of the full area.
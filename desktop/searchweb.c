@@ -46,6 +46,12 @@ static struct search_web_ctx_s {
 	struct search_provider *providers; /* web search providers */
 	size_t providers_count; /* number of providers */
 
+	/* provider strings are held in a single heap block */
+	bool providers_on_heap;
+
+	/* providers sorted by name, or NULL to scan on selection */
+	struct search_provider **provider_index;
+
 	size_t current; /* current provider */
 
 	hlcache_handle *default_ico_handle;
@@ -53,7 +59,24 @@ static struct search_web_ctx_s {
 } search_web_ctx;
 
 
-static const char *default_providers = "Google|www.google.com|https://www.google.com/search?q=%s|https://www.google.com/favicon.ico|\n";
+/**
+ * Built in web search providers.
+ *
+ * Used when the providers file is absent, avoiding the startup parse.
+ */
+static const struct {
+	const char *name;
+	const char *hostname;
+	const char *searchstring;
+	const char *ico;
+} default_providers[] = {
+	{
+		"Google",
+		"www.google.com",
+		"https://www.google.com/search?q=%s",
+		"https://www.google.com/favicon.ico"
+	},
+};
 
 static const char *default_search_icon_url = "resource:icons/search.png";
 
@@ -219,6 +242,63 @@ parse_providers(char *providersd,
 	return NSERROR_OK;
 }
 
+/**
+ * construct a provider array from the built in provider table.
+ *
+ * \param providers_out The resulting provider array.
+ * \param providers_count The number of providers in the output array.
+ * \return NSERROR_OK on success or error code on failure.
+ */
+static nserror
+builtin_providers(struct search_provider **providers_out,
+		  size_t *providers_count)
+{
+	struct search_provider *providers;
+	size_t pidx;
+
+	providers = malloc(NOF_ELEMENTS(default_providers) *
+			   sizeof(*providers));
+	if (providers == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	for (pidx = 0; pidx < NOF_ELEMENTS(default_providers); pidx++) {
+		providers[pidx].name = (char *)default_providers[pidx].name;
+		providers[pidx].hostname =
+				(char *)default_providers[pidx].hostname;
+		providers[pidx].searchstring =
+				(char *)default_providers[pidx].searchstring;
+		providers[pidx].ico = (char *)default_providers[pidx].ico;
+		providers[pidx].ico_handle = NULL;
+	}
+
+	*providers_out = providers;
+	*providers_count = NOF_ELEMENTS(default_providers);
+
+	return NSERROR_OK;
+}
+
+/**
+ * comparison of two providers by name for sorting
+ */
+static int provider_index_cmp(const void *a, const void *b)
+{
+	const struct search_provider * const *pa = a;
+	const struct search_provider * const *pb = b;
+
+	return strcmp((*pa)->name, (*pb)->name);
+}
+
+/**
+ * comparison of a provider name key against a provider for searching
+ */
+static int provider_index_search_cmp(const void *key, const void *element)
+{
+	const struct search_provider * const *pe = element;
+
+	return strcmp(key, (*pe)->name);
+}
+
 /**
  * create a url for a search provider and a term
  *
@@ -406,7 +486,22 @@ nserror search_web_select_provider(const char *selection)
 	}
 
 	/* negative value just selects whatevers current */
-	if (selection != NULL) {
+	if (selection != NULL && search_web_ctx.provider_index != NULL) {
+		struct search_provider **found;
+
+		found = bsearch(selection,
+				search_web_ctx.provider_index,
+				search_web_ctx.providers_count,
+				sizeof(*search_web_ctx.provider_index),
+				provider_index_search_cmp);
+		if (found != NULL) {
+			search_web_ctx.current =
+					*found - search_web_ctx.providers;
+		} else {
+			/* selected provider not found */
+			search_web_ctx.current = 0;
+		}
+	} else if (selection != NULL) {
 		for (pidx=0; pidx < search_web_ctx.providers_count;pidx++) {
 			if (strcmp(search_web_ctx.providers[pidx].name, selection)==0) {
 				search_web_ctx.current = pidx;
@@ -527,6 +622,7 @@ nserror search_web_init(const char *provider_fname)
 	nserror ret;
 	char *providers;
 	size_t providers_size;
+	size_t pidx;
 	nsurl *icon_nsurl;
 
 	/* create search icon url */
@@ -537,22 +633,44 @@ nserror search_web_init(const char *provider_fname)
 
 	/* get a list of providers */
 	ret = read_providers(provider_fname, &providers, &providers_size);
-	if (ret != NSERROR_OK) {
-		providers = strdup(default_providers);
-		if (providers == NULL) {
-			return NSERROR_NOMEM;
+	if (ret == NSERROR_OK) {
+		/* parse list of providers */
+		ret = parse_providers(providers,
+				      providers_size,
+				      &search_web_ctx.providers,
+				      &search_web_ctx.providers_count);
+		if (ret != NSERROR_OK) {
+			free(providers);
+			nsurl_unref(icon_nsurl);
+			return ret;
+		}
+		search_web_ctx.providers_on_heap = true;
+	} else {
+		/* no providers file; use the built in provider table */
+		ret = builtin_providers(&search_web_ctx.providers,
+					&search_web_ctx.providers_count);
+		if (ret != NSERROR_OK) {
+			nsurl_unref(icon_nsurl);
+			return ret;
 		}
-		providers_size = strlen(providers);
+		search_web_ctx.providers_on_heap = false;
 	}
 
-	/* parse list of providers */
-	ret = parse_providers(providers,
-			      providers_size,
-			      &search_web_ctx.providers,
-			      &search_web_ctx.providers_count);
-	if (ret != NSERROR_OK) {
-		free(providers);
-		return ret;
+	/* build the index used for provider selection; without it
+	 * selection falls back to a linear scan
+	 */
+	search_web_ctx.provider_index =
+		malloc(search_web_ctx.providers_count *
+		       sizeof(*search_web_ctx.provider_index));
+	if (search_web_ctx.provider_index != NULL) {
+		for (pidx = 0; pidx < search_web_ctx.providers_count; pidx++) {
+			search_web_ctx.provider_index[pidx] =
+					&search_web_ctx.providers[pidx];
+		}
+		qsort(search_web_ctx.provider_index,
+		      search_web_ctx.providers_count,
+		      sizeof(*search_web_ctx.provider_index),
+		      provider_index_cmp);
 	}
 
 	/* get default search icon */
@@ -568,9 +686,13 @@ nserror search_web_init(const char *provider_fname)
 	nsurl_unref(icon_nsurl);
 	if (ret != NSERROR_OK) {
 		search_web_ctx.default_ico_handle = NULL;
+		free(search_web_ctx.provider_index);
+		search_web_ctx.provider_index = NULL;
+		if (search_web_ctx.providers_on_heap) {
+			free(search_web_ctx.providers[0].name);
+		}
 		free(search_web_ctx.providers);
 		search_web_ctx.providers = NULL;
-		free(providers);
 		return ret;
 	}
 
@@ -597,10 +719,15 @@ nserror search_web_finalise(void)
 		}
 	}
 
-	/* All the search provider data is held in a single block for
-	 * efficiency.
-	 */
-	free(search_web_ctx.providers[0].name);
+	free(search_web_ctx.provider_index);
+	search_web_ctx.provider_index = NULL;
+
+	if (search_web_ctx.providers_on_heap) {
+		/* All the search provider data is held in a single block for
+		 * efficiency.
+		 */
+		free(search_web_ctx.providers[0].name);
+	}
 
 	free(search_web_ctx.providers);
 	search_web_ctx.providers = NULL;
@@ -0,0 +1,412 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Session persistence implementation.
+ *
+ * The journal is a sequence of fixed header records each optionally
+ * followed by a URL. Appending a record is a single buffered write
+ * and flush, so journalling a navigation costs far less than the
+ * navigation itself. The file is never updated in place; a window
+ * navigating again simply appends a newer record, and replay keeps
+ * the last record seen for each window identifier. The journal is
+ * truncated and restarted when the first record of a new session is
+ * written, by which time any restore has already read the old file.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils/errors.h"
+#include "utils/log.h"
+#include "utils/nsurl.h"
+#include "utils/utils.h"
+#include "netsurf/browser_window.h"
+#include "desktop/browser_private.h"
+#include "desktop/session.h"
+
+/** Magic bytes identifying a session journal */
+#define SESSION_MAGIC "NSSN"
+
+/** Current session journal format version */
+#define SESSION_VERSION 1
+
+/** Types of journal record */
+enum session_record_type {
+	SESSION_RECORD_NAVIGATE = 1, /**< window displayed a URL */
+	SESSION_RECORD_CLOSE = 2, /**< window was closed */
+};
+
+/** Path the session journal lives at, or NULL if sessions are unused */
+static char *session_path;
+
+/** Open journal being appended to, or NULL if not yet started */
+static FILE *session_journal;
+
+/** Next window identifier to assign */
+static uint32_t session_next_id = 1;
+
+/** A window reconstructed from the journal during restore */
+struct session_window {
+	uint32_t id; /**< recorded window identifier */
+	char *url; /**< last URL the window displayed */
+};
+
+
+/**
+ * Start a fresh journal, discarding any previous session file.
+ *
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+static nserror session__start_journal(void)
+{
+	uint8_t version = SESSION_VERSION;
+
+	if (session_journal != NULL) {
+		return NSERROR_OK;
+	}
+
+	session_journal = fopen(session_path, "wb");
+	if (session_journal == NULL) {
+		NSLOG(netsurf, WARNING,
+		      "Unable to open session journal %s", session_path);
+		return NSERROR_SAVE_FAILED;
+	}
+
+	if ((fwrite(SESSION_MAGIC, SLEN(SESSION_MAGIC), 1,
+		    session_journal) != 1) ||
+	    (fwrite(&version, sizeof(version), 1, session_journal) != 1)) {
+		fclose(session_journal);
+		session_journal = NULL;
+		return NSERROR_SAVE_FAILED;
+	}
+
+	fflush(session_journal);
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Append one record to the journal.
+ *
+ * \param type The record type.
+ * \param id The window identifier the record applies to.
+ * \param url The URL for navigate records, or NULL.
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+static nserror
+session__append_record(uint8_t type, uint32_t id, struct nsurl *url)
+{
+	const char *url_s = NULL;
+	size_t url_len = 0;
+	uint16_t len;
+	nserror res;
+
+	res = session__start_journal();
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	if (url != NULL) {
+		url_s = nsurl_access(url);
+		url_len = strlen(url_s);
+		if (url_len > UINT16_MAX) {
+			/* too long to record; ignore rather than
+			 * truncate to an incorrect URL
+			 */
+			return NSERROR_BAD_SIZE;
+		}
+	}
+	len = url_len;
+
+	if ((fwrite(&type, sizeof(type), 1, session_journal) != 1) ||
+	    (fwrite(&id, sizeof(id), 1, session_journal) != 1) ||
+	    (fwrite(&len, sizeof(len), 1, session_journal) != 1) ||
+	    ((len > 0) &&
+	     (fwrite(url_s, url_len, 1, session_journal) != 1))) {
+		return NSERROR_SAVE_FAILED;
+	}
+
+	fflush(session_journal);
+
+	return NSERROR_OK;
+}
+
+
+/**
+ * Find a restored window entry by identifier.
+ *
+ * \param windows The window array.
+ * \param count Number of entries in the array.
+ * \param id The identifier to find.
+ * \return The entry or NULL if not present.
+ */
+static struct session_window *
+session__find_window(struct session_window *windows,
+		     unsigned int count,
+		     uint32_t id)
+{
+	unsigned int i;
+
+	for (i = 0; i < count; i++) {
+		if (windows[i].id == id) {
+			return &windows[i];
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * Read the journal into a set of surviving windows.
+ *
+ * Later records supersede earlier ones for the same window and close
+ * records remove the window entirely, so the result is exactly the
+ * windows open when the journal was last written.
+ *
+ * \param fp The journal file positioned after the header.
+ * \param windows_out Updated to the window array on success.
+ * \param count_out Updated to the number of entries on success.
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+static nserror
+session__read_journal(FILE *fp,
+		      struct session_window **windows_out,
+		      unsigned int *count_out)
+{
+	struct session_window *windows = NULL;
+	unsigned int count = 0;
+	unsigned int allocated = 0;
+	uint8_t type;
+	uint32_t id;
+	uint16_t len;
+	char *url;
+	struct session_window *window;
+
+	while (fread(&type, sizeof(type), 1, fp) == 1) {
+		if ((fread(&id, sizeof(id), 1, fp) != 1) ||
+		    (fread(&len, sizeof(len), 1, fp) != 1)) {
+			/* torn final record from an unclean shutdown;
+			 * everything before it is still good
+			 */
+			break;
+		}
+
+		url = NULL;
+		if (len > 0) {
+			url = malloc((size_t)len + 1);
+			if (url == NULL) {
+				break;
+			}
+			if (fread(url, len, 1, fp) != 1) {
+				free(url);
+				break;
+			}
+			url[len] = '\0';
+		}
+
+		window = session__find_window(windows, count, id);
+
+		switch (type) {
+		case SESSION_RECORD_NAVIGATE:
+			if (url == NULL) {
+				break;
+			}
+			if (window == NULL) {
+				if (count == allocated) {
+					struct session_window *tmp;
+					allocated = (allocated == 0) ?
+						4 : allocated * 2;
+					tmp = realloc(windows,
+						      allocated *
+						      sizeof(*windows));
+					if (tmp == NULL) {
+						free(url);
+						url = NULL;
+						break;
+					}
+					windows = tmp;
+				}
+				window = &windows[count++];
+				window->id = id;
+				window->url = NULL;
+			}
+			free(window->url);
+			window->url = url;
+			url = NULL;
+			break;
+
+		case SESSION_RECORD_CLOSE:
+			if (window != NULL) {
+				free(window->url);
+				*window = windows[--count];
+			}
+			break;
+
+		default:
+			/* unknown record from a newer version; the
+			 * URL length lets us skip it safely
+			 */
+			break;
+		}
+
+		free(url);
+
+		/* keep identifiers unique across the restart */
+		if (id >= session_next_id) {
+			session_next_id = id + 1;
+		}
+	}
+
+	*windows_out = windows;
+	*count_out = count;
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in desktop/session.h */
+nserror session_init(const char *path)
+{
+	if (path == NULL) {
+		return NSERROR_BAD_PARAMETER;
+	}
+
+	if (session_path != NULL) {
+		free(session_path);
+		session_path = NULL;
+	}
+
+	session_path = strdup(path);
+	if (session_path == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in desktop/session.h */
+nserror session_restore(void)
+{
+	FILE *fp;
+	char magic[SLEN(SESSION_MAGIC)];
+	uint8_t version;
+	struct session_window *windows;
+	unsigned int count;
+	unsigned int i;
+	nserror res;
+
+	if (session_path == NULL) {
+		return NSERROR_BAD_PARAMETER;
+	}
+
+	fp = fopen(session_path, "rb");
+	if (fp == NULL) {
+		return NSERROR_NOT_FOUND;
+	}
+
+	if ((fread(magic, sizeof(magic), 1, fp) != 1) ||
+	    (memcmp(magic, SESSION_MAGIC, sizeof(magic)) != 0) ||
+	    (fread(&version, sizeof(version), 1, fp) != 1) ||
+	    (version != SESSION_VERSION)) {
+		NSLOG(netsurf, INFO,
+		      "Unrecognised session journal %s", session_path);
+		fclose(fp);
+		return NSERROR_INVALID;
+	}
+
+	res = session__read_journal(fp, &windows, &count);
+	fclose(fp);
+	if (res != NSERROR_OK) {
+		return res;
+	}
+
+	NSLOG(netsurf, INFO, "Restoring %u session windows", count);
+
+	for (i = 0; i < count; i++) {
+		nsurl *url;
+
+		if (nsurl_create(windows[i].url, &url) == NSERROR_OK) {
+			res = browser_window_create(BW_CREATE_HISTORY,
+						    url, NULL, NULL, NULL);
+			if (res != NSERROR_OK) {
+				NSLOG(netsurf, WARNING,
+				      "Unable to restore window for %s",
+				      windows[i].url);
+			}
+			nsurl_unref(url);
+		}
+
+		free(windows[i].url);
+	}
+	free(windows);
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in desktop/session.h */
+nserror session_record_navigate(struct browser_window *bw, struct nsurl *url)
+{
+	if ((session_path == NULL) ||
+	    (bw->parent != NULL) ||
+	    (url == NULL)) {
+		/* sessions unused or not a top level window */
+		return NSERROR_OK;
+	}
+
+	if (bw->session_id == 0) {
+		bw->session_id = session_next_id++;
+	}
+
+	return session__append_record(SESSION_RECORD_NAVIGATE,
+				      bw->session_id, url);
+}
+
+
+/* exported interface documented in desktop/session.h */
+nserror session_record_close(struct browser_window *bw)
+{
+	if ((session_path == NULL) || (bw->session_id == 0)) {
+		return NSERROR_OK;
+	}
+
+	return session__append_record(SESSION_RECORD_CLOSE,
+				      bw->session_id, NULL);
+}
+
+
+/* exported interface documented in desktop/session.h */
+nserror session_finalise(void)
+{
+	if (session_journal != NULL) {
+		fclose(session_journal);
+		session_journal = NULL;
+	}
+
+	free(session_path);
+	session_path = NULL;
+
+	return NSERROR_OK;
+}
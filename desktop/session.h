@@ -0,0 +1,100 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Session persistence interface.
+ *
+ * The session module journals the set of open top level browser
+ * windows and the URL each one is displaying into a compact binary
+ * file. Records are appended incrementally as navigations commit and
+ * windows close, so the journal is always current and an unclean
+ * shutdown loses nothing. On the next start the journal can be
+ * replayed to reopen every window at its last location without the
+ * frontend renavigating by hand.
+ *
+ * Frontends opt in by calling session_init() with a file path before
+ * creating any windows, optionally calling session_restore() to
+ * reopen the previous session. A frontend which never calls
+ * session_init() gets the old behaviour; the journalling hooks in the
+ * browser window core are no-ops until the module is initialised.
+ */
+
+#ifndef NETSURF_DESKTOP_SESSION_H_
+#define NETSURF_DESKTOP_SESSION_H_
+
+#include "utils/errors.h"
+
+struct browser_window;
+struct nsurl;
+
+/**
+ * Initialise the session module.
+ *
+ * Only records where the session journal lives; the file itself is
+ * not touched so a subsequent session_restore() can still read it.
+ *
+ * \param path Path to the session journal file.
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+nserror session_init(const char *path);
+
+/**
+ * Reopen the windows recorded in the session journal.
+ *
+ * Replays the journal and creates one browser window for each window
+ * that was open when it was written, navigating to the last URL that
+ * window displayed. The journal is then restarted to record the new
+ * session.
+ *
+ * \return NSERROR_OK on success, NSERROR_NOT_FOUND if there is no
+ *         previous session to restore, appropriate error otherwise.
+ */
+nserror session_restore(void);
+
+/**
+ * Record that a top level window is displaying a URL.
+ *
+ * Called by the browser window core whenever a navigation commits;
+ * frontends do not need to call this.
+ *
+ * \param bw The browser window that navigated.
+ * \param url The URL now displayed.
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+nserror session_record_navigate(struct browser_window *bw, struct nsurl *url);
+
+/**
+ * Record that a top level window has been closed.
+ *
+ * Called by the browser window core on window destruction; frontends
+ * do not need to call this.
+ *
+ * \param bw The browser window being closed.
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+nserror session_record_close(struct browser_window *bw);
+
+/**
+ * Finalise the session module and close the journal.
+ *
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+nserror session_finalise(void);
+
+#endif
@@ -930,9 +930,19 @@ static bool textarea_reflow_multiline(struct textarea *ta,
 	int v_extent; /* vertical extent */
 	bool restart = false;
 	bool skip_line = false;
+	unsigned int old_line; /* reuse cursor into the previous layout */
+	unsigned int old_line_count;
+	size_t reflow_end;
+	bool reuse;
 
 	assert(ta->flags & TEXTAREA_MULTILINE);
 
+	/* Lines of the previous layout may be reused once wrapping has
+	 * converged beyond the end of the modified region */
+	old_line_count = (ta->line_count > 0) ? (unsigned)ta->line_count : 0;
+	reflow_end = b_start + ((b_length > 0) ? b_length : 0);
+	reuse = (old_line_count > 0);
+
 	if (ta->lines == NULL) {
 		ta->lines = calloc(LINE_CHUNK_SIZE, sizeof(struct line_info));
 		if (ta->lines == NULL) {
@@ -943,10 +953,25 @@ static bool textarea_reflow_multiline(struct textarea *ta,
 		ta->lines_alloc_size = LINE_CHUNK_SIZE;
 	}
 
-	/* Get line of start of changes */
-	for (start = 0; (signed) start < ta->line_count - 1; start++)
-		if (ta->lines[start + 1].b_start > b_start)
-			break;
+	/* Get line of start of changes: binary search the sorted line
+	 * start offsets for the last line starting at or before the
+	 * modification */
+	start = 0;
+	if (ta->line_count > 0) {
+		unsigned int lo = 0;
+		unsigned int hi = ta->line_count - 1;
+
+		while (lo < hi) {
+			unsigned int mid = lo + (hi - lo + 1) / 2;
+
+			if (ta->lines[mid].b_start <= b_start) {
+				lo = mid;
+			} else {
+				hi = mid - 1;
+			}
+		}
+		start = lo;
+	}
 
 	/* Find max number of lines before vertical scrollbar is required */
 	scroll_lines = (ta->vis_height - 2 * ta->border_width -
@@ -967,12 +992,17 @@ static bool textarea_reflow_multiline(struct textarea *ta,
 	 * textarea's first line. */
 	do {
 		/* If a vertical scrollbar has been added or removed, we need
-		 * to restart from the first line in the textarea. */
-		if (restart)
+		 * to restart from the first line in the textarea.  The
+		 * previous layout has been overwritten by the first pass,
+		 * so none of it may be reused. */
+		if (restart) {
 			start = 0;
+			reuse = false;
+		}
 
 		/* Set current line to the starting line */
 		line = start;
+		old_line = start;
 
 		/* Find available width */
 		avail_width = ta->vis_width - 2 * ta->border_width -
@@ -1012,6 +1042,70 @@ static bool textarea_reflow_multiline(struct textarea *ta,
 
 		restart = false;
 		for (; len > 0; len -= b_off, text += b_off) {
+			size_t cur = text - ta->text.data;
+
+			if (reuse && cur > reflow_end) {
+				/* Past the modified region.  If a line of the
+				 * previous layout starts at this byte offset
+				 * once shifted by the edit's byte delta, the
+				 * remaining lines wrap identically, so they
+				 * are shifted into place rather than being
+				 * remeasured. */
+				if (old_line < line) {
+					/* Previous layout overwritten up to
+					 * here; skip what has been lost */
+					old_line = line;
+				}
+				while (old_line < old_line_count &&
+				       (int)ta->lines[old_line].b_start +
+						b_length < (int)cur) {
+					old_line++;
+				}
+
+				if (old_line < old_line_count &&
+				    (int)ta->lines[old_line].b_start +
+						b_length == (int)cur) {
+					unsigned int tail = old_line_count -
+							old_line;
+					unsigned int i;
+
+					if (line + tail + 1 >
+							ta->lines_alloc_size) {
+						struct line_info *temp =
+							realloc(ta->lines,
+							(line + tail + 1 +
+							 LINE_CHUNK_SIZE) *
+							sizeof(struct line_info));
+						if (temp == NULL) {
+							NSLOG(netsurf, INFO,
+							      "realloc failed");
+							return false;
+						}
+						ta->lines = temp;
+						ta->lines_alloc_size = line +
+								tail + 1 +
+								LINE_CHUNK_SIZE;
+					}
+
+					memmove(ta->lines + line,
+						ta->lines + old_line,
+						tail * sizeof(struct line_info));
+
+					for (i = line; i < line + tail; i++) {
+						ta->lines[i].b_start +=
+								b_length;
+						if (ta->lines[i].width >
+								h_extent) {
+							h_extent = ta->
+								lines[i].width;
+						}
+					}
+
+					line += tail;
+					break;
+				}
+			}
+
 			/* Find end of paragraph */
 			for (para_end = text; para_end < text + len;
 					para_end++) {
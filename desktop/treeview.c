@@ -539,16 +539,28 @@ static treeview_node * treeview_y_node(treeview *tree, int target_y)
 	assert(tree != NULL);
 	assert(tree->root != NULL);
 
-	n = treeview_node_next(tree->root, false);
+	/* Descend using the subtree display heights kept on each node,
+	 * stepping over any subtree which ends above the target rather
+	 * than visiting every node in it. */
+	n = tree->root->children;
 
 	while (n != NULL) {
-		int h = (n->type == TREE_NODE_ENTRY) ?
-			n->height : tree_g.line_height;
-		if (target_y >= y && target_y < y + h)
+		if (target_y >= y + n->height) {
+			/* Target is below this node's entire subtree */
+			y += n->height;
+			n = n->next_sib;
+			continue;
+		}
+
+		if (n->type == TREE_NODE_ENTRY ||
+		    target_y < y + tree_g.line_height) {
+			/* Target is in this node's own rows */
 			return n;
-		y += h;
+		}
 
-		n = treeview_node_next(n, false);
+		/* Target is among the folder's children */
+		y += tree_g.line_height;
+		n = n->children;
 	}
 
 	return NULL;
@@ -566,19 +578,28 @@ static int treeview_node_y(
 		const treeview *tree,
 		const treeview_node *node)
 {
-	treeview_node *n;
+	const treeview_node *n = node;
 	int y = treeview__get_search_height(tree);
 
 	assert(tree != NULL);
 	assert(tree->root != NULL);
 
-	n = treeview_node_next(tree->root, false);
+	/* Sum everything displayed before the node: the subtree display
+	 * height of the earlier siblings at each level, and the row of
+	 * each ancestor folder itself. */
+	while (n->parent != NULL) {
+		const treeview_node *sib;
 
-	while (n != NULL && n != node) {
-		y += (n->type == TREE_NODE_ENTRY) ?
-			n->height : tree_g.line_height;
+		for (sib = n->parent->children;
+		     sib != NULL && sib != n;
+		     sib = sib->next_sib) {
+			y += sib->height;
+		}
 
-		n = treeview_node_next(n, false);
+		n = n->parent;
+		if (n->parent != NULL) {
+			y += tree_g.line_height;
+		}
 	}
 
 	return y;
@@ -2469,7 +2469,7 @@ static void gui_window_set_icon(struct gui_window *g, struct hlcache_handle *ico
 	if(nsoption_bool(kiosk_mode) == true) return;
 	if(!g) return;
 
-	if ((icon != NULL) && ((icon_bitmap = content_get_bitmap(icon)) != NULL))
+	if ((icon != NULL) && ((icon_bitmap = content_get_bitmap_sized(icon, 16, 16)) != NULL))
 	{
 		bm = ami_bitmap_get_native(icon_bitmap, 16, 16, ami_plot_screen_is_palettemapped(),
 					g->shared->win->RPort->BitMap);
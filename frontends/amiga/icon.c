@@ -406,8 +406,8 @@ void amiga_icon_superimpose_favicon_internal(struct hlcache_handle *icon, struct
 
 	if(format != IDFMT_DIRECTMAPPED) return;
 #ifdef __amigaos4__
-	if ((icon != NULL) && (content_get_bitmap(icon) != NULL)) {
-		bm = ami_bitmap_get_native(content_get_bitmap(icon), 16, 16, false, NULL);
+	if ((icon != NULL) && (content_get_bitmap_sized(icon, 16, 16) != NULL)) {
+		bm = ami_bitmap_get_native(content_get_bitmap_sized(icon, 16, 16), 16, 16, false, NULL);
 	}
 
 	if(bm) {
@@ -18,6 +18,9 @@
  */
 
 #include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <ft2build.h>
 #include FT_CACHE_H
@@ -41,6 +44,12 @@
 
 #define BOLD_WEIGHT 700
 
+/* shaped glyph run cache parameters */
+#define GLYPH_RUN_BUCKETS 64		/* hash buckets */
+#define GLYPH_RUN_MAX_LENGTH 64		/* longest cacheable text in bytes */
+#define GLYPH_RUN_MAX_ENTRIES 1024	/* runs cached before eviction */
+#define GLYPH_RUN_STRIP_MAX (256 * 1024) /* largest composed run image */
+
 static FT_Library library; 
 static FTC_Manager ft_cmanager;
 static FTC_CMapCache ft_cmap_cache ;
@@ -75,6 +84,13 @@ enum fb_face_e {
 
 static fb_faceid_t *fb_faces[FB_FACE_COUNT];
 
+/* shaped glyph run cache */
+static struct fb_glyph_run *fb_glyph_run_buckets[GLYPH_RUN_BUCKETS];
+static unsigned int fb_glyph_run_count;
+static uint64_t fb_glyph_run_age;
+
+static void fb_glyph_run_flush(void);
+
 /**
  * map cache manager handle to face id
  */
@@ -160,7 +176,27 @@ bool fb_font_init(void)
         }
 
         /* set the Glyph cache size up */
-        max_cache_size = nsoption_int(fb_font_cachesize) * 1024; 
+        max_cache_size = nsoption_int(fb_font_cachesize) * 1024;
+
+	/* larger displays show more text at more sizes at once, so
+	 * scale the cache budget with the display area. the user
+	 * configured size is still honoured when it is larger.
+	 */
+	{
+		FT_ULong adaptive;
+		int width = nsoption_int(window_width);
+		int height = nsoption_int(window_height);
+
+		if (width <= 0)
+			width = 800;
+		if (height <= 0)
+			height = 600;
+
+		adaptive = (FT_ULong)width * height;
+		if (max_cache_size < adaptive) {
+			max_cache_size = adaptive;
+		}
+	}
 
 	if (max_cache_size < CACHE_MIN_SIZE) {
 		max_cache_size = CACHE_MIN_SIZE;
@@ -317,6 +353,9 @@ bool fb_font_finalise(void)
 {
 	int i, j;
 
+	/* unpin the run cache nodes before the cache goes away */
+	fb_glyph_run_flush();
+
         FTC_Manager_Done(ft_cmanager);
         FT_Done_FreeType(library);
 
@@ -429,6 +468,300 @@ FT_Glyph fb_getglyph(const plot_font_style_t *fstyle, uint32_t ucs4)
 }
 
 
+/**
+ * hash text and shaping style for the run cache
+ */
+static uint32_t
+fb_glyph_run_hash(const char *string,
+		  size_t length,
+		  FTC_FaceID face_id,
+		  FT_UInt size)
+{
+	uint32_t hash = 0x811c9dc5;
+	size_t i;
+
+	for (i = 0; i < length; i++) {
+		hash ^= (uint8_t)string[i];
+		hash *= 0x01000193;
+	}
+	hash ^= (uint32_t)(uintptr_t)face_id;
+	hash ^= size;
+
+	return hash;
+}
+
+
+/**
+ * release a run and the glyph cache nodes it pins
+ */
+static void fb_glyph_run_free(struct fb_glyph_run *run)
+{
+	unsigned int i;
+
+	for (i = 0; i < run->nglyphs; i++) {
+		FTC_Node_Unref(run->nodes[i], ft_cmanager);
+	}
+	free(run->strip);
+	free(run->nodes);
+	free(run->glyphs);
+	free(run->string);
+	free(run);
+}
+
+
+/**
+ * evict the least recently used run from the cache
+ */
+static void fb_glyph_run_evict(void)
+{
+	struct fb_glyph_run **link;
+	struct fb_glyph_run **victim = NULL;
+	struct fb_glyph_run *run;
+	unsigned int bucket;
+
+	for (bucket = 0; bucket < GLYPH_RUN_BUCKETS; bucket++) {
+		for (link = &fb_glyph_run_buckets[bucket];
+		     *link != NULL;
+		     link = &(*link)->next) {
+			if (victim == NULL ||
+			    ((*link)->age < (*victim)->age)) {
+				victim = link;
+			}
+		}
+	}
+
+	if (victim != NULL) {
+		run = *victim;
+		*victim = run->next;
+		fb_glyph_run_free(run);
+		fb_glyph_run_count--;
+	}
+}
+
+
+/**
+ * release every cached run
+ */
+static void fb_glyph_run_flush(void)
+{
+	struct fb_glyph_run *run;
+	unsigned int bucket;
+
+	for (bucket = 0; bucket < GLYPH_RUN_BUCKETS; bucket++) {
+		while ((run = fb_glyph_run_buckets[bucket]) != NULL) {
+			fb_glyph_run_buckets[bucket] = run->next;
+			fb_glyph_run_free(run);
+		}
+	}
+	fb_glyph_run_count = 0;
+}
+
+
+/* exported interface documented in framebuffer/font_freetype.h */
+struct fb_glyph_run *
+fb_getglyph_run(const plot_font_style_t *fstyle,
+		const char *string,
+		size_t length)
+{
+	FTC_ScalerRec srec;
+	fb_faceid_t *fb_face;
+	struct fb_glyph_run *run;
+	uint32_t hash;
+	unsigned int bucket;
+	uint32_t ucs4;
+	size_t nxtchr = 0;
+
+	if (length == 0 || length > GLYPH_RUN_MAX_LENGTH)
+		return NULL;
+
+	fb_fill_scalar(fstyle, &srec);
+	fb_face = (fb_faceid_t *)srec.face_id;
+
+	hash = fb_glyph_run_hash(string, length, srec.face_id, srec.width);
+	bucket = hash % GLYPH_RUN_BUCKETS;
+
+	for (run = fb_glyph_run_buckets[bucket]; run != NULL; run = run->next) {
+		if (run->hash == hash &&
+		    run->length == length &&
+		    run->face_id == srec.face_id &&
+		    run->size == srec.width &&
+		    memcmp(run->string, string, length) == 0) {
+			run->age = ++fb_glyph_run_age;
+			return run;
+		}
+	}
+
+	/* not seen before; shape the run */
+	run = calloc(1, sizeof(*run));
+	if (run == NULL)
+		return NULL;
+
+	/* a run can never have more glyphs than the text has bytes */
+	run->string = malloc(length);
+	run->glyphs = malloc(length * sizeof(*run->glyphs));
+	run->nodes = malloc(length * sizeof(*run->nodes));
+	if (run->string == NULL || run->glyphs == NULL || run->nodes == NULL) {
+		free(run->nodes);
+		free(run->glyphs);
+		free(run->string);
+		free(run);
+		return NULL;
+	}
+	memcpy(run->string, string, length);
+	run->length = length;
+	run->face_id = srec.face_id;
+	run->size = srec.width;
+	run->hash = hash;
+
+	while (nxtchr < length) {
+		FT_UInt glyph_index;
+		FT_Glyph glyph;
+		FTC_Node node;
+
+		ucs4 = utf8_to_ucs4(string + nxtchr, length - nxtchr);
+		nxtchr = utf8_next(string, length, nxtchr);
+
+		glyph_index = FTC_CMapCache_Lookup(ft_cmap_cache,
+						   srec.face_id,
+						   fb_face->cidx,
+						   ucs4);
+
+		if (FTC_ImageCache_LookupScaler(ft_image_cache,
+						&srec,
+						FT_LOAD_RENDER |
+						FT_LOAD_FORCE_AUTOHINT |
+						ft_load_type,
+						glyph_index,
+						&glyph,
+						&node) != 0)
+			continue;
+
+		run->glyphs[run->nglyphs].glyph = glyph;
+		run->glyphs[run->nglyphs].x = run->advance;
+		run->nodes[run->nglyphs] = node;
+		run->nglyphs++;
+		run->advance += glyph->advance.x >> 16;
+	}
+
+	run->age = ++fb_glyph_run_age;
+	run->next = fb_glyph_run_buckets[bucket];
+	fb_glyph_run_buckets[bucket] = run;
+	fb_glyph_run_count++;
+
+	if (fb_glyph_run_count > GLYPH_RUN_MAX_ENTRIES)
+		fb_glyph_run_evict();
+
+	return run;
+}
+
+
+/* exported interface documented in framebuffer/font_freetype.h */
+const uint8_t *
+fb_glyph_run_strip(struct fb_glyph_run *run,
+		   int *x, int *y,
+		   unsigned int *width, unsigned int *rows)
+{
+	FT_BitmapGlyph bglyph;
+	unsigned int i;
+	int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+	bool have_bbox = false;
+
+	if (run->strip_unusable)
+		return NULL;
+
+	if (run->strip == NULL) {
+		/* compose the run's glyph bitmaps into one image */
+		for (i = 0; i < run->nglyphs; i++) {
+			int gx0, gy0, gx1, gy1;
+
+			if (run->glyphs[i].glyph->format !=
+					FT_GLYPH_FORMAT_BITMAP) {
+				run->strip_unusable = true;
+				return NULL;
+			}
+			bglyph = (FT_BitmapGlyph)run->glyphs[i].glyph;
+
+			/* only grey coverage bitmaps can be merged */
+			if (bglyph->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY) {
+				run->strip_unusable = true;
+				return NULL;
+			}
+
+			if (bglyph->bitmap.width == 0 ||
+			    bglyph->bitmap.rows == 0)
+				continue;
+
+			gx0 = run->glyphs[i].x + bglyph->left;
+			gy0 = -bglyph->top;
+			gx1 = gx0 + bglyph->bitmap.width;
+			gy1 = gy0 + bglyph->bitmap.rows;
+
+			if (!have_bbox) {
+				x0 = gx0; y0 = gy0; x1 = gx1; y1 = gy1;
+				have_bbox = true;
+			} else {
+				if (gx0 < x0) x0 = gx0;
+				if (gy0 < y0) y0 = gy0;
+				if (gx1 > x1) x1 = gx1;
+				if (gy1 > y1) y1 = gy1;
+			}
+		}
+
+		if (!have_bbox ||
+		    ((x1 - x0) * (y1 - y0)) > GLYPH_RUN_STRIP_MAX) {
+			run->strip_unusable = true;
+			return NULL;
+		}
+
+		run->strip_width = x1 - x0;
+		run->strip_rows = y1 - y0;
+		run->strip_x = x0;
+		run->strip_y = y0;
+
+		run->strip = calloc(run->strip_rows, run->strip_width);
+		if (run->strip == NULL) {
+			run->strip_unusable = true;
+			return NULL;
+		}
+
+		for (i = 0; i < run->nglyphs; i++) {
+			unsigned int row, col;
+			const uint8_t *src;
+			uint8_t *dst;
+
+			bglyph = (FT_BitmapGlyph)run->glyphs[i].glyph;
+
+			for (row = 0; row < bglyph->bitmap.rows; row++) {
+				src = bglyph->bitmap.buffer +
+					(row * bglyph->bitmap.pitch);
+				dst = run->strip +
+					((-bglyph->top - y0 + row) *
+					 run->strip_width) +
+					(run->glyphs[i].x +
+					 bglyph->left - x0);
+
+				/* merge with maximum coverage as
+				 * kerned glyphs may overlap
+				 */
+				for (col = 0;
+				     col < bglyph->bitmap.width;
+				     col++) {
+					if (src[col] > dst[col])
+						dst[col] = src[col];
+				}
+			}
+		}
+	}
+
+	*x = run->strip_x;
+	*y = run->strip_y;
+	*width = run->strip_width;
+	*rows = run->strip_rows;
+
+	return run->strip;
+}
+
+
 /* exported interface documented in framebuffer/freetype_font.h */
 nserror
 fb_font_width(const plot_font_style_t *fstyle,
@@ -438,6 +771,14 @@ fb_font_width(const plot_font_style_t *fstyle,
         uint32_t ucs4;
         size_t nxtchr = 0;
         FT_Glyph glyph;
+	struct fb_glyph_run *run;
+
+	/* measure from the shaped run where possible */
+	run = fb_getglyph_run(fstyle, string, length);
+	if (run != NULL) {
+		*width = run->advance;
+		return NSERROR_OK;
+	}
 
         *width = 0;
         while (nxtchr < length) {
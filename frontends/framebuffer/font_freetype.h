@@ -19,12 +19,85 @@
 #ifndef NETSURF_FB_FONT_FREETYPE_H
 #define NETSURF_FB_FONT_FREETYPE_H
 
-#include <ft2build.h>  
-#include FT_FREETYPE_H 
+#include <ft2build.h>
+#include FT_FREETYPE_H
 #include FT_GLYPH_H
+#include FT_CACHE_H
 
 extern int ft_load_type;
 
 FT_Glyph fb_getglyph(const plot_font_style_t *fstyle, uint32_t ucs4);
 
+/**
+ * A glyph positioned within a shaped run.
+ */
+struct fb_glyph_pos {
+	FT_Glyph glyph;		/**< glyph image held live by the run */
+	int x;			/**< pen offset from the run origin */
+};
+
+/**
+ * A shaped glyph run held in the run cache.
+ *
+ * The glyph images are pinned in the freetype glyph cache for as
+ * long as the run is cached, so they may be replayed without any
+ * character map or image lookups.
+ */
+struct fb_glyph_run {
+	struct fb_glyph_run *next;	/**< bucket chain */
+
+	char *string;			/**< copy of the source text */
+	size_t length;			/**< length of the source text */
+	FTC_FaceID face_id;		/**< face the run was shaped with */
+	FT_UInt size;			/**< size the run was shaped at */
+	uint32_t hash;			/**< hash of text and style */
+	uint64_t age;			/**< last use, for eviction */
+
+	struct fb_glyph_pos *glyphs;	/**< positioned glyphs of the run */
+	FTC_Node *nodes;		/**< pinned cache nodes per glyph */
+	unsigned int nglyphs;		/**< number of glyphs in the run */
+	int advance;			/**< total advance of the run */
+
+	uint8_t *strip;			/**< composed alpha image, or NULL */
+	bool strip_unusable;		/**< the run cannot be composed */
+	int strip_x;			/**< strip left edge from run origin */
+	int strip_y;			/**< strip top edge from baseline */
+	unsigned int strip_width;	/**< strip width in pixels */
+	unsigned int strip_rows;	/**< strip height in pixels */
+};
+
+/**
+ * Obtain the shaped glyph run for a piece of text.
+ *
+ * Returns the cached run if the text has been shaped with this style
+ * before, shaping and caching it otherwise. Returns NULL when the
+ * run is not cacheable and the caller should shape glyph by glyph.
+ *
+ * \param fstyle The style to shape with.
+ * \param string The UTF-8 text of the run.
+ * \param length The length of the text in bytes.
+ * \return the shaped run or NULL.
+ */
+struct fb_glyph_run *fb_getglyph_run(const plot_font_style_t *fstyle,
+		const char *string, size_t length);
+
+/**
+ * Obtain the composed alpha image of a shaped run.
+ *
+ * All the run's glyph bitmaps packed into one 8 bit coverage buffer,
+ * composed on first use and retained with the run, so the whole run
+ * can be blitted with a single glyph plot. Returns NULL when the run
+ * cannot be composed (monochrome rendering, oversized runs) and the
+ * caller should plot glyph by glyph.
+ *
+ * \param run The shaped run.
+ * \param x Updated to the strip left edge relative to the run origin.
+ * \param y Updated to the strip top edge relative to the baseline.
+ * \param width Updated to the strip width in pixels.
+ * \param rows Updated to the strip height in pixels.
+ * \return the composed image or NULL.
+ */
+const uint8_t *fb_glyph_run_strip(struct fb_glyph_run *run,
+		int *x, int *y, unsigned int *width, unsigned int *rows);
+
 #endif /* NETSURF_FB_FONT_FREETYPE_H */
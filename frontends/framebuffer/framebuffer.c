@@ -422,6 +422,61 @@ framebuffer_plot_text(const struct redraw_context *ctx,
 	FT_Glyph glyph;
 	FT_BitmapGlyph bglyph;
 	nsfb_bbox_t loc;
+	struct fb_glyph_run *run;
+
+	/* replay the shaped run where possible */
+	run = fb_getglyph_run(fstyle, text, length);
+	if (run != NULL) {
+		const uint8_t *strip;
+		int sx, sy;
+		unsigned int swidth, srows;
+		unsigned int i;
+
+		/* blit the whole run at once where it has been composed */
+		strip = fb_glyph_run_strip(run, &sx, &sy, &swidth, &srows);
+		if (strip != NULL) {
+			loc.x0 = x + sx;
+			loc.y0 = y + sy;
+			loc.x1 = loc.x0 + swidth;
+			loc.y1 = loc.y0 + srows;
+
+			nsfb_plot_glyph8(nsfb,
+					 &loc,
+					 strip,
+					 swidth,
+					 fstyle->foreground);
+			return NSERROR_OK;
+		}
+
+		for (i = 0; i < run->nglyphs; i++) {
+			glyph = run->glyphs[i].glyph;
+
+			if (glyph->format != FT_GLYPH_FORMAT_BITMAP)
+				continue;
+
+			bglyph = (FT_BitmapGlyph)glyph;
+
+			loc.x0 = x + run->glyphs[i].x + bglyph->left;
+			loc.y0 = y - bglyph->top;
+			loc.x1 = loc.x0 + bglyph->bitmap.width;
+			loc.y1 = loc.y0 + bglyph->bitmap.rows;
+
+			if (bglyph->bitmap.pixel_mode == FT_PIXEL_MODE_MONO) {
+				nsfb_plot_glyph1(nsfb,
+						 &loc,
+						 bglyph->bitmap.buffer,
+						 bglyph->bitmap.pitch,
+						 fstyle->foreground);
+			} else {
+				nsfb_plot_glyph8(nsfb,
+						 &loc,
+						 bglyph->bitmap.buffer,
+						 bglyph->bitmap.pitch,
+						 fstyle->foreground);
+			}
+		}
+		return NSERROR_OK;
+	}
 
 	while (nxtchr < length) {
 		ucs4 = utf8_to_ucs4(text + nxtchr, length - nxtchr);
@@ -344,6 +344,15 @@ fb_pan(fbtk_widget_t *widget,
 	bwidget->pany = 0;
 }
 
+/**
+ * Largest area, in pixels, painted in one pass of the redraw loop.
+ *
+ * Pending redraws larger than this are painted a band at a time,
+ * returning to the event loop between bands so input handling is
+ * not stalled behind a full screen repaint.
+ */
+#define FB_REDRAW_BAND_AREA (256 * 1024)
+
 static void
 fb_redraw(fbtk_widget_t *widget,
 	  struct browser_widget_s *bwidget,
@@ -359,23 +368,41 @@ fb_redraw(fbtk_widget_t *widget,
 		.plot = &fb_plotters
 	};
 	nsfb_t *nsfb = fbtk_get_nsfb(widget);
+	nsfb_bbox_t redraw_box; /* the band painted this pass */
+	int band_height;
 
 	x = fbtk_get_absx(widget);
 	y = fbtk_get_absy(widget);
 
+	redraw_box = bwidget->redraw_box;
+
+	/* bound the area painted in one pass; any remainder below
+	 * the band is left queued for the next pass
+	 */
+	if (redraw_box.x1 > redraw_box.x0) {
+		band_height = FB_REDRAW_BAND_AREA /
+				(redraw_box.x1 - redraw_box.x0);
+		if (band_height < 1) {
+			band_height = 1;
+		}
+		if (redraw_box.y0 + band_height < redraw_box.y1) {
+			redraw_box.y1 = redraw_box.y0 + band_height;
+		}
+	}
+
 	/* adjust clipping co-ordinates according to window location */
-	bwidget->redraw_box.y0 += y;
-	bwidget->redraw_box.y1 += y;
-	bwidget->redraw_box.x0 += x;
-	bwidget->redraw_box.x1 += x;
+	redraw_box.y0 += y;
+	redraw_box.y1 += y;
+	redraw_box.x0 += x;
+	redraw_box.x1 += x;
 
-	nsfb_claim(nsfb, &bwidget->redraw_box);
+	nsfb_claim(nsfb, &redraw_box);
 
 	/* redraw bounding box is relative to window */
-	clip.x0 = bwidget->redraw_box.x0;
-	clip.y0 = bwidget->redraw_box.y0;
-	clip.x1 = bwidget->redraw_box.x1;
-	clip.y1 = bwidget->redraw_box.y1;
+	clip.x0 = redraw_box.x0;
+	clip.y0 = redraw_box.y0;
+	clip.x1 = redraw_box.x1;
+	clip.y1 = redraw_box.y1;
 
 	browser_window_redraw(bw,
 			x - bwidget->scrollx,
@@ -399,11 +426,18 @@ fb_redraw(fbtk_widget_t *widget,
 		nsfb_plot_line(nsfb, &line, &pen);
 	}
 
-	nsfb_update(fbtk_get_nsfb(widget), &bwidget->redraw_box);
+	nsfb_update(fbtk_get_nsfb(widget), &redraw_box);
 
-	bwidget->redraw_box.y0 = bwidget->redraw_box.x0 = INT_MAX;
-	bwidget->redraw_box.y1 = bwidget->redraw_box.x1 = INT_MIN;
-	bwidget->redraw_required = false;
+	if ((redraw_box.y1 - y) < bwidget->redraw_box.y1) {
+		/* more bands to paint; requeue the remainder */
+		bwidget->redraw_box.y0 = redraw_box.y1 - y;
+		bwidget->redraw_required = true;
+		fbtk_request_redraw(widget);
+	} else {
+		bwidget->redraw_box.y0 = bwidget->redraw_box.x0 = INT_MAX;
+		bwidget->redraw_box.y1 = bwidget->redraw_box.x1 = INT_MIN;
+		bwidget->redraw_required = false;
+	}
 }
 
 static int
@@ -1886,6 +1920,70 @@ fb_window_invalidate_area(struct gui_window *g, const struct rect *rect)
 	return NSERROR_OK;
 }
 
+/**
+ * Shift an area of valid framebuffer browser window content.
+ *
+ * Copies the pixels of the area by the given delta so the core only
+ * has to repaint the newly exposed strip after a frame scroll. The
+ * copy is refused when other updates are already queued or the area
+ * is not fully within the viewport, in which case the core repaints
+ * the whole area instead.
+ *
+ * \param g The netsurf window to shift content in.
+ * \param rect The area to shift.
+ * \param dx The horizontal displacement of the existing pixels.
+ * \param dy The vertical displacement of the existing pixels.
+ * \return NSERROR_OK if the area was copied else appropriate error code.
+ */
+static nserror
+fb_window_scroll_area(struct gui_window *g, const struct rect *rect,
+		      int dx, int dy)
+{
+	struct browser_widget_s *bwidget = fbtk_get_userpw(g->browser);
+	nsfb_t *nsfb = fbtk_get_nsfb(g->browser);
+	nsfb_bbox_t srcbox;
+	nsfb_bbox_t dstbox;
+	int x0, y0, x1, y1;
+	int absx, absy;
+
+	/* queued updates may overlap the area; the stale pixels must
+	 * not be copied around */
+	if (bwidget->redraw_required || bwidget->pan_required)
+		return NSERROR_INVALID;
+
+	/* viewport relative bounds of the area to move */
+	x0 = rect->x0 - bwidget->scrollx;
+	y0 = rect->y0 - bwidget->scrolly;
+	x1 = rect->x1 - bwidget->scrollx;
+	y1 = rect->y1 - bwidget->scrolly;
+
+	/* a partially visible area has no valid source pixels for
+	 * part of the copy */
+	if (x0 < 0 || y0 < 0 ||
+	    x1 > fbtk_get_width(g->browser) ||
+	    y1 > fbtk_get_height(g->browser))
+		return NSERROR_BAD_SIZE;
+
+	absx = fbtk_get_absx(g->browser);
+	absy = fbtk_get_absy(g->browser);
+
+	/* copy the overlap of the area and the area shifted by the
+	 * delta */
+	srcbox.x0 = absx + x0 + ((dx > 0) ? 0 : -dx);
+	srcbox.y0 = absy + y0 + ((dy > 0) ? 0 : -dy);
+	srcbox.x1 = absx + x1 - ((dx > 0) ? dx : 0);
+	srcbox.y1 = absy + y1 - ((dy > 0) ? dy : 0);
+
+	dstbox.x0 = srcbox.x0 + dx;
+	dstbox.y0 = srcbox.y0 + dy;
+	dstbox.x1 = srcbox.x1 + dx;
+	dstbox.y1 = srcbox.y1 + dy;
+
+	nsfb_plot_copy(nsfb, &srcbox, nsfb, &dstbox);
+
+	return NSERROR_OK;
+}
+
 static bool
 gui_window_get_scroll(struct gui_window *g, int *sx, int *sy)
 {
@@ -2157,6 +2255,7 @@ static struct gui_window_table framebuffer_window_table = {
 	.get_dimensions = gui_window_get_dimensions,
 	.event = gui_window_event,
 
+	.scroll_area = fb_window_scroll_area,
 	.set_url = gui_window_set_url,
 	.set_status = gui_window_set_status,
 	.set_pointer = gui_window_set_pointer,
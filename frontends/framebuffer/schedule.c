@@ -24,20 +24,96 @@
 
 #include "framebuffer/schedule.h"
 
-/* linked list of scheduled callbacks */
-static struct nscallback *schedule_list = NULL;
-
 /**
  * scheduled callback.
  */
 struct nscallback
 {
-        struct nscallback *next;
 	struct timeval tv;
 	void (*callback)(void *p);
 	void *p;
 };
 
+/* scheduled callbacks in a binary min-heap ordered on deadline, so the
+ * soonest event is always at the root and insert and remove restructure
+ * in O(log n) rather than scanning a list.
+ */
+static struct nscallback *schedule_heap = NULL;
+static unsigned int schedule_heap_used = 0;
+static unsigned int schedule_heap_alloc = 0;
+
+/* initial heap allocation in entries */
+#define SCHEDULE_HEAP_MIN 16
+
+/**
+ * Restore the heap property moving an entry towards the root.
+ *
+ * \param idx The index of the entry to move.
+ */
+static void schedule_heap_up(unsigned int idx)
+{
+	struct nscallback tmp;
+	unsigned int parent;
+
+	while (idx > 0) {
+		parent = (idx - 1) / 2;
+		if (!timercmp(&schedule_heap[idx].tv,
+			      &schedule_heap[parent].tv, <)) {
+			break;
+		}
+		tmp = schedule_heap[idx];
+		schedule_heap[idx] = schedule_heap[parent];
+		schedule_heap[parent] = tmp;
+		idx = parent;
+	}
+}
+
+/**
+ * Restore the heap property moving an entry towards the leaves.
+ *
+ * \param idx The index of the entry to move.
+ */
+static void schedule_heap_down(unsigned int idx)
+{
+	struct nscallback tmp;
+	unsigned int child;
+
+	while ((child = (idx * 2) + 1) < schedule_heap_used) {
+		if ((child + 1) < schedule_heap_used &&
+		    timercmp(&schedule_heap[child + 1].tv,
+			     &schedule_heap[child].tv, <)) {
+			child++;
+		}
+		if (!timercmp(&schedule_heap[child].tv,
+			      &schedule_heap[idx].tv, <)) {
+			break;
+		}
+		tmp = schedule_heap[idx];
+		schedule_heap[idx] = schedule_heap[child];
+		schedule_heap[child] = tmp;
+		idx = child;
+	}
+}
+
+/**
+ * Remove the heap entry at an index.
+ *
+ * The last entry takes the removed entry's place and is moved to
+ * where the heap property holds again.
+ *
+ * \param idx The index of the entry to remove.
+ */
+static void schedule_heap_remove(unsigned int idx)
+{
+	schedule_heap_used--;
+	if (idx == schedule_heap_used) {
+		return;
+	}
+	schedule_heap[idx] = schedule_heap[schedule_heap_used];
+	schedule_heap_down(idx);
+	schedule_heap_up(idx);
+}
+
 /**
  * Unschedule a callback.
  *
@@ -48,45 +124,32 @@ struct nscallback
  */
 static nserror schedule_remove(void (*callback)(void *p), void *p)
 {
-        struct nscallback *cur_nscb;
-        struct nscallback *prev_nscb;
-        struct nscallback *unlnk_nscb;
+	unsigned int idx;
 
-	/* check there is something on the list to remove */
-        if (schedule_list == NULL) {
-                return NSERROR_OK;
+	/* check there is something in the heap to remove */
+	if (schedule_heap_used == 0) {
+		return NSERROR_OK;
 	}
 
 	NSLOG(schedule, DEBUG, "removing %p, %p", callback, p);
 
-        cur_nscb = schedule_list;
-        prev_nscb = NULL;
-
-        while (cur_nscb != NULL) {
-                if ((cur_nscb->callback ==  callback) &&
-                    (cur_nscb->p ==  p)) {
-                        /* item to remove */
-
-                        NSLOG(schedule, DEBUG,
-			      "callback entry %p removing  %p(%p)",
-                             cur_nscb, cur_nscb->callback, cur_nscb->p);
-
-                        /* remove callback */
-                        unlnk_nscb = cur_nscb;
-                        cur_nscb = unlnk_nscb->next;
-
-                        if (prev_nscb == NULL) {
-                                schedule_list = cur_nscb;
-                        } else {
-                                prev_nscb->next = cur_nscb;
-                        }
-                        free (unlnk_nscb);
-                } else {
-                        /* move to next element */
-                        prev_nscb = cur_nscb;
-                        cur_nscb = prev_nscb->next;
-                }
-        }
+	/* entries carry no handle so matches are located by scanning,
+	 * but each removal restructures in O(log n). the entry moved
+	 * into a removed slot is examined again, so the index only
+	 * advances when no removal was made.
+	 */
+	idx = 0;
+	while (idx < schedule_heap_used) {
+		if ((schedule_heap[idx].callback == callback) &&
+		    (schedule_heap[idx].p == p)) {
+			NSLOG(schedule, DEBUG,
+			      "callback entry %u removing %p(%p)",
+			      idx, callback, p);
+			schedule_heap_remove(idx);
+		} else {
+			idx++;
+		}
+	}
 
 	return NSERROR_OK;
 }
@@ -106,10 +169,24 @@ nserror framebuffer_schedule(int tival, void (*callback)(void *p), void *p)
 
 	NSLOG(schedule, DEBUG, "Adding %p(%p) in %d", callback, p, tival);
 
+	if (schedule_heap_used == schedule_heap_alloc) {
+		struct nscallback *nheap;
+		unsigned int nalloc;
+
+		nalloc = (schedule_heap_alloc == 0) ?
+			SCHEDULE_HEAP_MIN : (schedule_heap_alloc * 2);
+		nheap = realloc(schedule_heap, nalloc * sizeof(*nheap));
+		if (nheap == NULL) {
+			return NSERROR_NOMEM;
+		}
+		schedule_heap = nheap;
+		schedule_heap_alloc = nalloc;
+	}
+
         tv.tv_sec = tival / 1000; /* miliseconds to seconds */
         tv.tv_usec = (tival % 1000) * 1000; /* remainder to microseconds */
 
-	nscb = calloc(1, sizeof(struct nscallback));
+	nscb = &schedule_heap[schedule_heap_used];
 
 	gettimeofday(&nscb->tv, NULL);
 	timeradd(&nscb->tv, &tv, &nscb->tv);
@@ -117,9 +194,9 @@ nserror framebuffer_schedule(int tival, void (*callback)(void *p), void *p)
 	nscb->callback = callback;
 	nscb->p = p;
 
-        /* add to list front */
-        nscb->next = schedule_list;
-        schedule_list = nscb;
+	/* add as the last leaf and move into place */
+	schedule_heap_used++;
+	schedule_heap_up(schedule_heap_used - 1);
 
 	return NSERROR_OK;
 }
@@ -128,66 +205,41 @@ nserror framebuffer_schedule(int tival, void (*callback)(void *p), void *p)
 int schedule_run(void)
 {
 	struct timeval tv;
-	struct timeval nexttime;
 	struct timeval rettime;
-        struct nscallback *cur_nscb;
-        struct nscallback *prev_nscb;
-        struct nscallback *unlnk_nscb;
-
-        if (schedule_list == NULL)
-                return -1;
+	void (*callback)(void *p);
+	void *p;
 
-	/* reset enumeration to the start of the list */
-        cur_nscb = schedule_list;
-        prev_nscb = NULL;
-	nexttime = cur_nscb->tv;
+	if (schedule_heap_used == 0)
+		return -1;
 
 	gettimeofday(&tv, NULL);
 
-        while (cur_nscb != NULL) {
-                if (timercmp(&tv, &cur_nscb->tv, >)) {
-                        /* scheduled time */
-
-                        /* remove callback */
-                        unlnk_nscb = cur_nscb;
-
-                        if (prev_nscb == NULL) {
-                                schedule_list = unlnk_nscb->next;
-                        } else {
-                                prev_nscb->next = unlnk_nscb->next;
-                        }
-
-                        unlnk_nscb->callback(unlnk_nscb->p);
-
-                        free(unlnk_nscb);
-
-                        /* need to deal with callback modifying the list. */
-			if (schedule_list == NULL)
-				return -1; /* no more callbacks scheduled */
-			
-                        /* reset enumeration to the start of the list */
-                        cur_nscb = schedule_list;
-                        prev_nscb = NULL;
-			nexttime = cur_nscb->tv;
-                } else {
-			/* if the time to the event is sooner than the
-			 * currently recorded soonest event record it 
-			 */
-			if (timercmp(&nexttime, &cur_nscb->tv, >)) {
-				nexttime = cur_nscb->tv;
-			}
-                        /* move to next element */
-                        prev_nscb = cur_nscb;
-                        cur_nscb = prev_nscb->next;
-                }
-        }
+	/* the soonest deadline is always at the root, so expired
+	 * callbacks are run by repeatedly popping it with no scan.
+	 */
+	while ((schedule_heap_used > 0) &&
+	       (timercmp(&tv, &schedule_heap[0].tv, >))) {
+		/* scheduled time */
+		callback = schedule_heap[0].callback;
+		p = schedule_heap[0].p;
+
+		/* remove before calling as the callback may
+		 * modify the heap.
+		 */
+		schedule_heap_remove(0);
+
+		callback(p);
+	}
+
+	if (schedule_heap_used == 0)
+		return -1; /* no more callbacks scheduled */
 
 	/* make rettime relative to now */
-	timersub(&nexttime, &tv, &rettime);
+	timersub(&schedule_heap[0].tv, &tv, &rettime);
 
 	NSLOG(schedule, DEBUG,
 	      "returning time to next event as %ldms",
-	      (rettime.tv_sec * 1000) + (rettime.tv_usec / 1000)); 
+	      (rettime.tv_sec * 1000) + (rettime.tv_usec / 1000));
 
 	/* return next event time in milliseconds (24days max wait) */
         return (rettime.tv_sec * 1000) + (rettime.tv_usec / 1000);
@@ -196,20 +248,18 @@ int schedule_run(void)
 void list_schedule(void)
 {
 	struct timeval tv;
-        struct nscallback *cur_nscb;
+	unsigned int idx;
 
 	gettimeofday(&tv, NULL);
 
         NSLOG(netsurf, INFO, "schedule list at %ld:%ld", tv.tv_sec,
               tv.tv_usec);
 
-        cur_nscb = schedule_list;
-
-        while (cur_nscb != NULL) {
-                NSLOG(netsurf, INFO, "Schedule %p at %ld:%ld", cur_nscb,
-                      cur_nscb->tv.tv_sec, cur_nscb->tv.tv_usec);
-                cur_nscb = cur_nscb->next;
-        }
+	for (idx = 0; idx < schedule_heap_used; idx++) {
+		NSLOG(netsurf, INFO, "Schedule %u at %ld:%ld", idx,
+		      schedule_heap[idx].tv.tv_sec,
+		      schedule_heap[idx].tv.tv_usec);
+	}
 }
 
 
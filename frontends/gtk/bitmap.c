@@ -150,6 +150,10 @@ static void bitmap_destroy(void *vbitmap)
 	struct bitmap *gbitmap = (struct bitmap *)vbitmap;
 	assert(gbitmap);
 
+	if (gbitmap->opsurface != NULL) {
+		/* the view shares the surface's pixels so must go first */
+		cairo_surface_destroy(gbitmap->opsurface);
+	}
 	if (gbitmap->surface != NULL) {
 		cairo_surface_destroy(gbitmap->surface);
 	}
@@ -172,6 +176,43 @@ static void bitmap_modified(void *vbitmap)
 	assert(gbitmap);
 
 	cairo_surface_mark_dirty(gbitmap->surface);
+	if (gbitmap->opsurface != NULL) {
+		cairo_surface_mark_dirty(gbitmap->opsurface);
+	}
+}
+
+/* exported interface documented in gtk/bitmap.h */
+cairo_surface_t *nsgtk_bitmap_get_plot_surface(void *vbitmap)
+{
+	struct bitmap *gbitmap = (struct bitmap *)vbitmap;
+
+	assert(gbitmap);
+
+	if (!gbitmap->opaque) {
+		return gbitmap->surface;
+	}
+
+	if (gbitmap->opsurface == NULL) {
+		/* both formats are four bytes per pixel with the alpha
+		 * byte simply ignored by RGB24, so the view can share
+		 * the surface's pixel data without conversion.
+		 */
+		cairo_surface_flush(gbitmap->surface);
+		gbitmap->opsurface = cairo_image_surface_create_for_data(
+			cairo_image_surface_get_data(gbitmap->surface),
+			CAIRO_FORMAT_RGB24,
+			cairo_image_surface_get_width(gbitmap->surface),
+			cairo_image_surface_get_height(gbitmap->surface),
+			cairo_image_surface_get_stride(gbitmap->surface));
+		if (cairo_surface_status(gbitmap->opsurface) !=
+				CAIRO_STATUS_SUCCESS) {
+			cairo_surface_destroy(gbitmap->opsurface);
+			gbitmap->opsurface = NULL;
+			return gbitmap->surface;
+		}
+	}
+
+	return gbitmap->opsurface;
 }
 
 /* exported interface documented in gtk/bitmap.h */
@@ -274,6 +315,11 @@ bitmap_render(struct bitmap *bitmap, struct hlcache_handle *content)
 
 	cairo_surface_destroy(surface);
 
+	/* the destination's pixels changed behind any opaque view */
+	if (bitmap->opsurface != NULL) {
+		cairo_surface_mark_dirty(bitmap->opsurface);
+	}
+
 	return NSERROR_OK;
 }
 
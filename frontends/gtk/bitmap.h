@@ -26,10 +26,24 @@ extern struct gui_bitmap_table *nsgtk_bitmap_table;
 struct bitmap {
 	cairo_surface_t *surface; /* original cairo surface */
 	cairo_surface_t *scsurface; /* scaled surface */
+	cairo_surface_t *opsurface; /* opaque view over surface's pixels */
 	bool opaque;
 };
 
 int nsgtk_bitmap_get_width(void *vbitmap);
 int nsgtk_bitmap_get_height(void *vbitmap);
 
+/**
+ * Obtain the surface a bitmap should be painted from.
+ *
+ * For opaque bitmaps this is an RGB24 surface sharing the pixel data
+ * of the bitmap's ARGB32 surface, so painting takes cairo's opaque
+ * compositing path without alpha fetch and blend and without copying
+ * the pixels. Otherwise it is the bitmap's own surface.
+ *
+ * \param vbitmap a bitmap, as returned by bitmap_create()
+ * \return the surface to set as the paint source.
+ */
+cairo_surface_t *nsgtk_bitmap_get_plot_surface(void *vbitmap);
+
 #endif /* NS_GTK_BITMAP_H */
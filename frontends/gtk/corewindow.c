@@ -490,6 +490,10 @@ nsgtk_cw_input_method_commit(GtkIMContext *ctx, const gchar *str, gpointer g)
 /**
  * handler for gtk draw event on a nsgtk core window for GTK 3
  *
+ * Core rendering is retained in an image surface and only performed
+ * for areas the core has invalidated since they were last rendered;
+ * other exposures are satisfied by painting from the surface.
+ *
  * \param widget The GTK widget to redraw.
  * \param cr The cairo drawing context of the widget
  * \param data The context pointer passed when the event was registered.
@@ -499,22 +503,101 @@ static gboolean
 nsgtk_cw_draw_event(GtkWidget *widget, cairo_t *cr, gpointer data)
 {
 	struct nsgtk_corewindow *nsgtk_cw = (struct nsgtk_corewindow *)data;
+	GtkAllocation allocation;
 	double x1;
 	double y1;
 	double x2;
 	double y2;
+	cairo_rectangle_int_t cliprect;
+	cairo_region_t *damage;
+	cairo_t *scr;
 	struct rect clip;
-
-	current_cr = cr;
+	int i;
 
 	cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
 
-	clip.x0 = x1;
-	clip.y0 = y1;
-	clip.x1 = x2;
-	clip.y1 = y2;
+	/* ensure the retained surface matches the drawable area */
+	gtk_widget_get_allocation(widget, &allocation);
+	if (nsgtk_cw->surface != NULL &&
+	    (cairo_image_surface_get_width(nsgtk_cw->surface) !=
+			allocation.width ||
+	     cairo_image_surface_get_height(nsgtk_cw->surface) !=
+			allocation.height)) {
+		cairo_surface_destroy(nsgtk_cw->surface);
+		nsgtk_cw->surface = NULL;
+	}
+	if (nsgtk_cw->surface == NULL) {
+		nsgtk_cw->surface = cairo_image_surface_create(
+				CAIRO_FORMAT_RGB24,
+				allocation.width,
+				allocation.height);
+		if (cairo_surface_status(nsgtk_cw->surface) !=
+				CAIRO_STATUS_SUCCESS) {
+			cairo_surface_destroy(nsgtk_cw->surface);
+			nsgtk_cw->surface = NULL;
+		}
+		if (nsgtk_cw->rendered != NULL) {
+			cairo_region_destroy(nsgtk_cw->rendered);
+		}
+		nsgtk_cw->rendered = cairo_region_create();
+	}
 
-	nsgtk_cw->draw(nsgtk_cw, &clip);
+	if (nsgtk_cw->surface == NULL) {
+		/* surface unavailable; render directly to the widget */
+		current_cr = cr;
+
+		clip.x0 = x1;
+		clip.y0 = y1;
+		clip.x1 = x2;
+		clip.y1 = y2;
+
+		nsgtk_cw->draw(nsgtk_cw, &clip);
+
+		return FALSE;
+	}
+
+	cliprect.x = (int)x1;
+	cliprect.y = (int)y1;
+	cliprect.width = (int)(x2 + 1) - cliprect.x;
+	cliprect.height = (int)(y2 + 1) - cliprect.y;
+
+	/* render the damaged strips within the clip into the surface */
+	damage = cairo_region_create_rectangle(&cliprect);
+	cairo_region_subtract(damage, nsgtk_cw->rendered);
+
+	if (!cairo_region_is_empty(damage)) {
+		scr = cairo_create(nsgtk_cw->surface);
+
+		for (i = 0; i < cairo_region_num_rectangles(damage); i++) {
+			cairo_rectangle_int_t r;
+
+			cairo_region_get_rectangle(damage, i, &r);
+
+			cairo_save(scr);
+			cairo_rectangle(scr, r.x, r.y, r.width, r.height);
+			cairo_clip(scr);
+
+			current_cr = scr;
+
+			clip.x0 = r.x;
+			clip.y0 = r.y;
+			clip.x1 = r.x + r.width;
+			clip.y1 = r.y + r.height;
+
+			nsgtk_cw->draw(nsgtk_cw, &clip);
+
+			cairo_restore(scr);
+		}
+
+		cairo_destroy(scr);
+
+		cairo_region_union(nsgtk_cw->rendered, damage);
+	}
+	cairo_region_destroy(damage);
+
+	/* paint the retained surface through the event's clip */
+	cairo_set_source_surface(cr, nsgtk_cw->surface, 0, 0);
+	cairo_paint(cr);
 
 	return FALSE;
 }
@@ -572,10 +655,24 @@ nsgtk_cw_invalidate_area(struct core_window *cw, const struct rect *rect)
 	struct nsgtk_corewindow *nsgtk_cw = (struct nsgtk_corewindow *)cw;
 
 	if (rect == NULL) {
+		if (nsgtk_cw->rendered != NULL) {
+			cairo_region_destroy(nsgtk_cw->rendered);
+			nsgtk_cw->rendered = cairo_region_create();
+		}
 		gtk_widget_queue_draw(GTK_WIDGET(nsgtk_cw->drawing_area));
 		return NSERROR_OK;
 	}
 
+	if (nsgtk_cw->rendered != NULL) {
+		cairo_rectangle_int_t r = {
+			.x = rect->x0,
+			.y = rect->y0,
+			.width = rect->x1 - rect->x0,
+			.height = rect->y1 - rect->y0,
+		};
+		cairo_region_subtract_rectangle(nsgtk_cw->rendered, &r);
+	}
+
 	gtk_widget_queue_draw_area(GTK_WIDGET(nsgtk_cw->drawing_area),
 				   rect->x0,
 				   rect->y0,
@@ -733,6 +830,8 @@ struct core_window_table *nsgtk_core_window_table = &nsgtk_cw_cb_table;
 nserror nsgtk_corewindow_init(struct nsgtk_corewindow *nsgtk_cw)
 {
 	nsgtk_cw->drag_status = CORE_WINDOW_DRAG_NONE;
+	nsgtk_cw->surface = NULL;
+	nsgtk_cw->rendered = NULL;
 
 	/* input method setup */
 	nsgtk_cw->input_method = gtk_im_multicontext_new();
@@ -785,6 +884,15 @@ nserror nsgtk_corewindow_init(struct nsgtk_corewindow *nsgtk_cw)
 /* exported interface documented in gtk/corewindow.h */
 nserror nsgtk_corewindow_fini(struct nsgtk_corewindow *nsgtk_cw)
 {
+	if (nsgtk_cw->rendered != NULL) {
+		cairo_region_destroy(nsgtk_cw->rendered);
+		nsgtk_cw->rendered = NULL;
+	}
+	if (nsgtk_cw->surface != NULL) {
+		cairo_surface_destroy(nsgtk_cw->surface);
+		nsgtk_cw->surface = NULL;
+	}
+
 	g_object_unref(nsgtk_cw->input_method);
 
 	return NSERROR_OK;
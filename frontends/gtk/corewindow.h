@@ -49,6 +49,12 @@ struct nsgtk_corewindow {
 	/** Input method */
 	GtkIMContext *input_method;
 
+	/** retained rendering of the drawable area, or NULL */
+	cairo_surface_t *surface;
+
+	/** region of the retained surface holding up to date rendering */
+	cairo_region_t *rendered;
+
 	/** mouse state */
 	struct nsgtk_corewindow_mouse mouse_state;
 
@@ -43,6 +43,30 @@ cairo_t *current_cr;
 
 static GdkRectangle cliprect;
 
+/** line dash patterns the plotters use */
+enum nsgtk_plot_dash {
+	DASH_UNSET,
+	DASH_SOLID,
+	DASH_DOTTED,
+	DASH_DASHED,
+};
+
+/**
+ * Cached cairo rendering state.
+ *
+ * Consecutive plots with the same style skip re-submitting source
+ * colour, dash pattern and line width to cairo. The cache is reset
+ * whenever the clip is set, which every redraw sequence does before
+ * plotting, so a change of target context cannot leave stale state.
+ */
+static struct nsgtk_plot_state {
+	bool colour_valid;
+	colour c;
+	enum nsgtk_plot_dash dash;
+	bool width_valid;
+	double width;
+} plot_state;
+
 /**
  * Set cairo context colour to nsgtk colour.
  *
@@ -50,11 +74,18 @@ static GdkRectangle cliprect;
  */
 void nsgtk_set_colour(colour c)
 {
-	cairo_set_source_rgba(current_cr, 
-			      (c & 0xff) / 255.0, 
-			      ((c & 0xff00) >> 8) / 255.0, 
-			      ((c & 0xff0000) >> 16) / 255.0, 
+	if (plot_state.colour_valid && plot_state.c == c) {
+		return;
+	}
+
+	cairo_set_source_rgba(current_cr,
+			      (c & 0xff) / 255.0,
+			      ((c & 0xff00) >> 8) / 255.0,
+			      ((c & 0xff0000) >> 16) / 255.0,
 			      1.0);
+
+	plot_state.colour_valid = true;
+	plot_state.c = c;
 }
 
 
@@ -64,7 +95,12 @@ void nsgtk_set_colour(colour c)
 static inline void nsgtk_set_solid(void)
 {
 	double dashes = 0;
+
+	if (plot_state.dash == DASH_SOLID) {
+		return;
+	}
 	cairo_set_dash(current_cr, &dashes, 0, 0);
+	plot_state.dash = DASH_SOLID;
 }
 
 
@@ -74,7 +110,12 @@ static inline void nsgtk_set_solid(void)
 static inline void nsgtk_set_dotted(void)
 {
 	double cdashes[] = { 1.0, 2.0 };
+
+	if (plot_state.dash == DASH_DOTTED) {
+		return;
+	}
 	cairo_set_dash(current_cr, cdashes, 2, 0);
+	plot_state.dash = DASH_DOTTED;
 }
 
 
@@ -84,7 +125,26 @@ static inline void nsgtk_set_dotted(void)
 static inline void nsgtk_set_dashed(void)
 {
 	double cdashes[] = { 8.0, 2.0 };
+
+	if (plot_state.dash == DASH_DASHED) {
+		return;
+	}
 	cairo_set_dash(current_cr, cdashes, 2, 0);
+	plot_state.dash = DASH_DASHED;
+}
+
+
+/**
+ * Set cairo context line width in cairo units.
+ */
+static inline void nsgtk_set_cairo_line_width(double width)
+{
+	if (plot_state.width_valid && plot_state.width == width) {
+		return;
+	}
+	cairo_set_line_width(current_cr, width);
+	plot_state.width_valid = true;
+	plot_state.width = width;
 }
 
 
@@ -94,9 +154,9 @@ static inline void nsgtk_set_dashed(void)
 static inline void nsgtk_set_line_width(plot_style_fixed width)
 {
 	if (width == 0) {
-		cairo_set_line_width(current_cr, 1);
+		nsgtk_set_cairo_line_width(1);
 	} else {
-		cairo_set_line_width(current_cr,
+		nsgtk_set_cairo_line_width(
 				plot_style_fixed_to_double(width));
 	}
 }
@@ -113,6 +173,13 @@ static inline void nsgtk_set_line_width(plot_style_fixed width)
 static nserror
 nsgtk_plot_clip(const struct redraw_context *ctx, const struct rect *clip)
 {
+	/* the target context may have changed since the last plot;
+	 * drop the cached rendering state
+	 */
+	plot_state.colour_valid = false;
+	plot_state.dash = DASH_UNSET;
+	plot_state.width_valid = false;
+
 	cairo_reset_clip(current_cr);
 	cairo_rectangle(current_cr, clip->x0, clip->y0,
 			clip->x1 - clip->x0, clip->y1 - clip->y0);
@@ -151,7 +218,7 @@ nsgtk_plot_arc(const struct redraw_context *ctx,
 	nsgtk_set_colour(style->fill_colour);
 	nsgtk_set_solid();
 
-	cairo_set_line_width(current_cr, 1);
+	nsgtk_set_cairo_line_width(1);
 	cairo_arc(current_cr, x, y, radius,
 		  (angle1 + 90) * (M_PI / 180),
 		  (angle2 + 90) * (M_PI / 180));
@@ -181,7 +248,7 @@ nsgtk_plot_disc(const struct redraw_context *ctx,
 	if (style->fill_type != PLOT_OP_TYPE_NONE) {
 		nsgtk_set_colour(style->fill_colour);
 		nsgtk_set_solid();
-		cairo_set_line_width(current_cr, 0);
+		nsgtk_set_cairo_line_width(0);
 		cairo_arc(current_cr, x, y, radius, 0, M_PI * 2);
 		cairo_fill(current_cr);
 		cairo_stroke(current_cr);
@@ -279,7 +346,7 @@ void nsgtk_plot_caret(int x, int y, int h)
 {
 	nsgtk_set_solid(); /* solid line */
 	nsgtk_set_colour(0); /* black */
-	cairo_set_line_width(current_cr, 1); /* thin line */
+	nsgtk_set_cairo_line_width(1); /* thin line */
 
 	/* core expects horizontal and vertical lines to be on pixels, not
 	 * between pixels */
@@ -311,7 +378,7 @@ nsgtk_plot_rectangle(const struct redraw_context *ctx,
 		nsgtk_set_colour(style->fill_colour);
 		nsgtk_set_solid();
 
-		cairo_set_line_width(current_cr, 0);
+		nsgtk_set_cairo_line_width(0);
 		cairo_rectangle(current_cr,
 				rect->x0,
 				rect->y0,
@@ -352,6 +419,48 @@ nsgtk_plot_rectangle(const struct redraw_context *ctx,
 }
 
 
+/**
+ * Plots many filled rectangles.
+ *
+ * Equivalent to plotting each rectangle in turn but the colour and
+ *  line state is set up once and the rectangles accumulate into a
+ *  single cairo path with one fill.
+ *
+ * \param ctx The current redraw context.
+ * \param style Style controlling the rectangle plots.
+ * \param rects The rectangles to fill.
+ * \param n number of rectangles.
+ * \return NSERROR_OK on success else error code.
+ */
+static nserror
+nsgtk_plot_rectangles(const struct redraw_context *ctx,
+		      const plot_style_t *style,
+		      const struct rect *rects,
+		      unsigned int n)
+{
+	unsigned int i;
+
+	if (style->fill_type == PLOT_OP_TYPE_NONE) {
+		return NSERROR_OK;
+	}
+
+	nsgtk_set_colour(style->fill_colour);
+	nsgtk_set_solid();
+
+	nsgtk_set_cairo_line_width(0);
+	for (i = 0; i < n; i++) {
+		cairo_rectangle(current_cr,
+				rects[i].x0,
+				rects[i].y0,
+				rects[i].x1 - rects[i].x0,
+				rects[i].y1 - rects[i].y0);
+	}
+	cairo_fill(current_cr);
+
+	return NSERROR_OK;
+}
+
+
 /**
  * Plot a polygon
  *
@@ -377,7 +486,7 @@ nsgtk_plot_polygon(const struct redraw_context *ctx,
 	nsgtk_set_colour(style->fill_colour);
 	nsgtk_set_solid();
 
-	cairo_set_line_width(current_cr, 0);
+	nsgtk_set_cairo_line_width(0);
 	cairo_move_to(current_cr, p[0], p[1]);
 	for (i = 1; i != n; i++) {
 		cairo_line_to(current_cr, p[i * 2], p[i * 2 + 1]);
@@ -562,7 +671,7 @@ nsgtk_plot_bitmap(const struct redraw_context *ctx,
 	}
 
 	/* Get the image's surface and intrinsic dimensions */
-	img_surface = bitmap->surface;
+	img_surface = nsgtk_bitmap_get_plot_surface(bitmap);
 	img_width = cairo_image_surface_get_width(img_surface);
 	img_height = cairo_image_surface_get_height(img_surface);
 
@@ -616,6 +725,9 @@ nsgtk_plot_bitmap(const struct redraw_context *ctx,
 		cairo_restore(current_cr);
 	}
 
+	/* the source is now a surface pattern, not a colour */
+	plot_state.colour_valid = false;
+
 	return NSERROR_OK;
 }
 
@@ -650,6 +762,7 @@ const struct plotter_table nsgtk_plotters = {
 	.disc = nsgtk_plot_disc,
 	.line = nsgtk_plot_line,
 	.rectangle = nsgtk_plot_rectangle,
+	.rectangles = nsgtk_plot_rectangles,
 	.polygon = nsgtk_plot_polygon,
 	.path = nsgtk_plot_path,
 	.bitmap = nsgtk_plot_bitmap,
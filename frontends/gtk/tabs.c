@@ -207,6 +207,7 @@ nsgtk_tab_switch_page_after(GtkNotebook *notebook,
 	GtkWidget *addpage;
 	GtkMenuBar *menubar;
 	struct gui_window *gw = NULL;
+	struct gui_window *srcgw = NULL;
 	nserror res = NSERROR_INVALID;
 
 	addpage = g_object_get_data(G_OBJECT(notebook), "addtab");
@@ -221,11 +222,28 @@ nsgtk_tab_switch_page_after(GtkNotebook *notebook,
 			nsgtk_scaffolding_set_top_level(gw);
 			gtk_widget_show(GTK_WIDGET(addpage));
 			gtk_widget_set_sensitive(GTK_WIDGET(menubar), true);
+			browser_window_set_visibility(
+					nsgtk_get_browser_window(gw), true);
 		} else {
 			/* tab with non browser content (e.g. tb customize) */
 			gtk_widget_hide(GTK_WIDGET(addpage));
 			gtk_widget_set_sensitive(GTK_WIDGET(menubar), false);
 		}
+
+		/* the previously shown tab is now in the background */
+		if ((srcpagenum != -1) && (srcpagenum != (gint)selpagenum)) {
+			srcpage = gtk_notebook_get_nth_page(notebook,
+							    srcpagenum);
+			if (srcpage != NULL) {
+				srcgw = g_object_get_data(G_OBJECT(srcpage),
+							  "gui_window");
+			}
+			if (srcgw != NULL) {
+				browser_window_set_visibility(
+					nsgtk_get_browser_window(srcgw),
+					false);
+			}
+		}
 		return;
 	}
 
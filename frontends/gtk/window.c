@@ -1042,7 +1042,7 @@ gui_window_set_icon(struct gui_window *gw, struct hlcache_handle *icon)
 	}
 
 	if (icon != NULL) {
-		icon_bitmap = content_get_bitmap(icon);
+		icon_bitmap = content_get_bitmap_sized(icon, 16, 16);
 		if (icon_bitmap != NULL) {
 			NSLOG(netsurf, INFO, "Using %p bitmap", icon_bitmap);
 			gw->icon = nsgdk_pixbuf_get_from_surface(icon_bitmap->surface, 16, 16);
@@ -23,6 +23,7 @@
 #include <string.h>
 
 #include "utils/utils.h"
+#include "utils/sys_time.h"
 #include "utils/ring.h"
 #include "utils/log.h"
 #include "utils/messages.h"
@@ -40,6 +41,33 @@ static uint32_t win_ctr = 0;
 
 static struct gui_window *gw_ring = NULL;
 
+/* whether navigation milestone timestamps are reported */
+static bool bench_enabled = false;
+
+/**
+ * Report a benchmark milestone for a window.
+ *
+ * Emits a machine-readable line carrying the wall clock time the
+ * milestone was reached, when benchmark mode is enabled.
+ *
+ * \param g The gui window the milestone occurred in.
+ * \param event The milestone name.
+ */
+static void monkey_bench_mark(struct gui_window *g, const char *event)
+{
+	struct timeval tv;
+
+	if (!bench_enabled) {
+		return;
+	}
+
+	gettimeofday(&tv, NULL);
+
+	moutf(MOUT_BENCH, "WIN %u EVENT %s TIME %lld.%06ld",
+	      g->win_num, event,
+	      (long long)tv.tv_sec, (long)tv.tv_usec);
+}
+
 /* exported function documented in monkey/browser.h */
 nserror monkey_warn_user(const char *warning, const char *detail)
 {
@@ -138,6 +166,7 @@ static void
 gui_window_new_content(struct gui_window *g)
 {
 	moutf(MOUT_WINDOW, "NEW_CONTENT WIN %u", g->win_num);
+	monkey_bench_mark(g, "CONVERT_DONE");
 }
 
 static void
@@ -150,12 +179,20 @@ static void
 gui_window_start_throbber(struct gui_window *g)
 {
 	moutf(MOUT_WINDOW, "START_THROBBER WIN %u", g->win_num);
+
+	/* a new navigation is starting, so the first-occurrence
+	 * milestones may be reported again.
+	 */
+	g->bench_layout_seen = false;
+	g->bench_paint_seen = false;
+	monkey_bench_mark(g, "FETCH_START");
 }
 
 static void
 gui_window_stop_throbber(struct gui_window *g)
 {
 	moutf(MOUT_WINDOW, "STOP_THROBBER WIN %u", g->win_num);
+	monkey_bench_mark(g, "FETCH_COMPLETE");
 }
 
 
@@ -201,6 +238,14 @@ monkey_window_invalidate_area(struct gui_window *gw, const struct rect *rect)
 		moutf(MOUT_WINDOW, "INVALIDATE_AREA WIN %u ALL", gw->win_num);
 	}
 
+	/* monkey has no compositor, so the first area invalidated after
+	 * a navigation starts stands in for first paint.
+	 */
+	if (!gw->bench_paint_seen) {
+		gw->bench_paint_seen = true;
+		monkey_bench_mark(gw, "FIRST_PAINT");
+	}
+
 	return NSERROR_OK;
 }
 
@@ -214,6 +259,11 @@ gui_window_update_extent(struct gui_window *g)
 
 	moutf(MOUT_WINDOW, "UPDATE_EXTENT WIN %u WIDTH %d HEIGHT %d",
 	      g->win_num, width, height);
+
+	if (!g->bench_layout_seen) {
+		g->bench_layout_seen = true;
+		monkey_bench_mark(g, "FIRST_LAYOUT");
+	}
 }
 
 static void
@@ -655,6 +705,49 @@ monkey_window_handle_exec(int argc, char **argv)
 }
 
 
+static void
+monkey_window_handle_resize(int argc, char **argv)
+{
+	/* `WINDOW RESIZE WIN` _%id%_ `WIDTH` _%num%_ `HEIGHT` _%num%_ */
+	/*  0      1      2    3       4       5       6        7      */
+	struct gui_window *gw;
+	if (argc != 8) {
+		moutf(MOUT_ERROR, "WINDOW RESIZE ARGS BAD\n");
+		return;
+	}
+
+	gw = monkey_find_window_by_num(atoi(argv[2]));
+
+	if (gw == NULL) {
+		moutf(MOUT_ERROR, "WINDOW NUM BAD");
+	} else {
+		int width = atoi(argv[4]);
+		int height = atoi(argv[6]);
+		struct timeval start_tv, end_tv, elapsed_tv;
+
+		gw->width = width;
+		gw->height = height;
+
+		/* The reformat is performed immediately rather than
+		 * via browser_window_schedule_reformat() so the
+		 * elapsed time covers exactly one layout; command
+		 * processing happens outside any core callback so the
+		 * direct call is safe here.
+		 */
+		gettimeofday(&start_tv, NULL);
+		browser_window_reformat(gw->bw, false, width, height);
+		gettimeofday(&end_tv, NULL);
+		timersub(&end_tv, &start_tv, &elapsed_tv);
+
+		moutf(MOUT_WINDOW,
+		      "RESIZE WIN %u WIDTH %d HEIGHT %d TIME %lld.%06ld",
+		      gw->win_num, width, height,
+		      (long long)elapsed_tv.tv_sec,
+		      (long)elapsed_tv.tv_usec);
+	}
+}
+
+
 static void
 monkey_window_handle_click(int argc, char **argv)
 {
@@ -717,6 +810,8 @@ monkey_window_handle_command(int argc, char **argv)
 		monkey_window_handle_reload(argc, argv);
 	} else if (strcmp(argv[1], "EXEC") == 0) {
 		monkey_window_handle_exec(argc, argv);
+	} else if (strcmp(argv[1], "RESIZE") == 0) {
+		monkey_window_handle_resize(argc, argv);
 	} else if (strcmp(argv[1], "CLICK") == 0) {
 		monkey_window_handle_click(argc, argv);
 	} else {
@@ -725,6 +820,26 @@ monkey_window_handle_command(int argc, char **argv)
 
 }
 
+/* exported function documented in monkey/browser.h */
+void
+monkey_benchmark_handle_command(int argc, char **argv)
+{
+	if (argc != 2) {
+		moutf(MOUT_ERROR, "BENCH ARGS BAD");
+		return;
+	}
+
+	if (strcmp(argv[1], "ON") == 0) {
+		bench_enabled = true;
+		moutf(MOUT_BENCH, "ON");
+	} else if (strcmp(argv[1], "OFF") == 0) {
+		bench_enabled = false;
+		moutf(MOUT_BENCH, "OFF");
+	} else {
+		moutf(MOUT_ERROR, "BENCH COMMAND UNKNOWN %s", argv[1]);
+	}
+}
+
 /**
  * process miscellaneous window events
  *
@@ -35,7 +35,10 @@ struct gui_window {
 	int scrollx, scrolly;
   
 	char *host;  /* Ignore this, it's in case RING*() gets debugging for fetchers */
-  
+
+	/* benchmark milestones already reported for the current navigation */
+	bool bench_layout_seen;
+	bool bench_paint_seen;
 };
 
 struct gui_window *monkey_find_window_by_num(uint32_t win_num);
@@ -43,6 +46,7 @@ struct gui_window *monkey_find_window_by_content(struct hlcache_handle *content)
 void monkey_window_process_reformats(void);
 
 void monkey_window_handle_command(int argc, char **argv);
+void monkey_benchmark_handle_command(int argc, char **argv);
 void monkey_kill_browser_windows(void);
 
 nserror monkey_warn_user(const char *warning, const char *detail);
@@ -484,6 +484,11 @@ main(int argc, char **argv)
 		die("login handler failed to register");
 	}
 
+	ret = monkey_register_handler("BENCH", monkey_benchmark_handle_command);
+	if (ret != NSERROR_OK) {
+		die("benchmark handler failed to register");
+	}
+
 
 	moutf(MOUT_GENERIC, "STARTED");
 	monkey_run();
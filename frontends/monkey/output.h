@@ -28,6 +28,7 @@ enum monkey_output_type {
 	MOUT_LOGIN,
 	MOUT_DOWNLOAD,
 	MOUT_PLOT,
+	MOUT_BENCH,
 };
 
 int moutf(enum monkey_output_type mout_type, const char *fmt, ...);
@@ -354,6 +354,80 @@ nsws_drawable_keydown(struct gui_window *gw, HWND hwnd, WPARAM wparam)
 }
 
 
+/**
+ * Ensure a drawable window's back buffer matches the client area.
+ *
+ * \param gw The gui window owning the buffer.
+ * \param hdc A device context compatible with the window.
+ * \param width The required buffer width.
+ * \param height The required buffer height.
+ * \return true if the back buffer is usable.
+ */
+static bool
+nsws_drawable_ensure_backbuffer(struct gui_window *gw,
+				HDC hdc,
+				int width,
+				int height)
+{
+	void *bits;
+	BITMAPINFO bmi = {
+		.bmiHeader = {
+			.biSize = sizeof(BITMAPINFOHEADER),
+			.biWidth = width,
+			.biHeight = -height, /* top down */
+			.biPlanes = 1,
+			.biBitCount = 32,
+			.biCompression = BI_RGB,
+		},
+	};
+
+	if ((gw->backdc != NULL) &&
+	    (gw->backwidth == width) &&
+	    (gw->backheight == height)) {
+		return true;
+	}
+
+	if (gw->backbitmap != NULL) {
+		DeleteObject(gw->backbitmap);
+		gw->backbitmap = NULL;
+	}
+	if (gw->backdc != NULL) {
+		DeleteDC(gw->backdc);
+		gw->backdc = NULL;
+	}
+
+	if ((width <= 0) || (height <= 0)) {
+		return false;
+	}
+
+	gw->backdc = CreateCompatibleDC(hdc);
+	if (gw->backdc == NULL) {
+		return false;
+	}
+
+	gw->backbitmap = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS,
+					  &bits, NULL, 0);
+	if (gw->backbitmap == NULL) {
+		DeleteDC(gw->backdc);
+		gw->backdc = NULL;
+		return false;
+	}
+	SelectObject(gw->backdc, gw->backbitmap);
+
+	gw->backwidth = width;
+	gw->backheight = height;
+
+	/* nothing has been rendered into the new buffer yet */
+	if (gw->backvalid == NULL) {
+		gw->backvalid = CreateRectRgn(0, 0, 0, 0);
+	} else {
+		SetRectRgn(gw->backvalid, 0, 0, 0, 0);
+	}
+
+	return (gw->backvalid != NULL);
+}
+
+
 /**
  * Handle paint messages.
  */
@@ -362,6 +436,7 @@ nsws_drawable_paint(struct gui_window *gw, HWND hwnd)
 {
 	struct rect clip;
 	PAINTSTRUCT ps;
+	RECT rc;
 	struct redraw_context ctx = {
 		.interactive = true,
 		.background_images = true,
@@ -370,7 +445,73 @@ nsws_drawable_paint(struct gui_window *gw, HWND hwnd)
 
 	BeginPaint(hwnd, &ps);
 
-	if (gw != NULL) {
+	if (gw == NULL) {
+		EndPaint(hwnd, &ps);
+		return 0;
+	}
+
+	GetClientRect(hwnd, &rc);
+
+	if (nsws_drawable_ensure_backbuffer(gw, ps.hdc, rc.right, rc.bottom)) {
+		HRGN damage;
+		RECT dr;
+
+		/* work out which part of the exposed area is stale in
+		 * the buffer; areas still valid from a previous paint
+		 * are blitted without replaying any plot calls.
+		 */
+		damage = CreateRectRgn(ps.rcPaint.left, ps.rcPaint.top,
+				       ps.rcPaint.right, ps.rcPaint.bottom);
+		if (damage != NULL) {
+			CombineRgn(damage, damage, gw->backvalid, RGN_DIFF);
+
+			if (GetRgnBox(damage, &dr) != NULLREGION) {
+				plot_hdc = gw->backdc;
+
+				clip.x0 = dr.left;
+				clip.y0 = dr.top;
+				clip.x1 = dr.right;
+				clip.y1 = dr.bottom;
+
+				browser_window_redraw(gw->bw,
+						      -gw->scrollx,
+						      -gw->scrolly,
+						      &clip,
+						      &ctx);
+
+				CombineRgn(gw->backvalid, gw->backvalid,
+					   damage, RGN_OR);
+			}
+			DeleteObject(damage);
+		} else {
+			/* cannot track damage; render the exposed area
+			 * into the buffer without marking it valid.
+			 */
+			plot_hdc = gw->backdc;
+
+			clip.x0 = ps.rcPaint.left;
+			clip.y0 = ps.rcPaint.top;
+			clip.x1 = ps.rcPaint.right;
+			clip.y1 = ps.rcPaint.bottom;
+
+			browser_window_redraw(gw->bw,
+					      -gw->scrollx,
+					      -gw->scrolly,
+					      &clip,
+					      &ctx);
+		}
+
+		BitBlt(ps.hdc,
+		       ps.rcPaint.left,
+		       ps.rcPaint.top,
+		       ps.rcPaint.right - ps.rcPaint.left,
+		       ps.rcPaint.bottom - ps.rcPaint.top,
+		       gw->backdc,
+		       ps.rcPaint.left,
+		       ps.rcPaint.top,
+		       SRCCOPY);
+	} else {
+		/* no back buffer; render straight to the window */
 		plot_hdc = ps.hdc;
 
 		clip.x0 = ps.rcPaint.left;
@@ -381,7 +522,7 @@ nsws_drawable_paint(struct gui_window *gw, HWND hwnd)
                 /**
 		 * \todo work out why the heck scroll needs scaling
 		 */
-		
+
 		browser_window_redraw(gw->bw,
 				      -gw->scrollx,
 				      -gw->scrolly,
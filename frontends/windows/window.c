@@ -947,6 +947,30 @@ win32_window_invalidate_area(struct gui_window *gw, const struct rect *rect)
 		redrawrect.bottom = (long)rect->y1;
 
 	}
+
+	/* drop the invalidated area from the back buffer's valid region
+	 * so the next paint renders it afresh.
+	 */
+	if (gw->backvalid != NULL) {
+		if (rect != NULL) {
+			HRGN inv;
+
+			inv = CreateRectRgn(redrawrect.left,
+					    redrawrect.top,
+					    redrawrect.right,
+					    redrawrect.bottom);
+			if (inv != NULL) {
+				CombineRgn(gw->backvalid, gw->backvalid,
+					   inv, RGN_DIFF);
+				DeleteObject(inv);
+			} else {
+				SetRectRgn(gw->backvalid, 0, 0, 0, 0);
+			}
+		} else {
+			SetRectRgn(gw->backvalid, 0, 0, 0, 0);
+		}
+	}
+
 	RedrawWindow(gw->drawingarea,
 		     redrawrectp,
 		     NULL,
@@ -1610,6 +1634,16 @@ static void win32_window_destroy(struct gui_window *w)
 
 	destroy_page_info_bitmaps(w);
 
+	if (w->backbitmap != NULL) {
+		DeleteObject(w->backbitmap);
+	}
+	if (w->backdc != NULL) {
+		DeleteDC(w->backdc);
+	}
+	if (w->backvalid != NULL) {
+		DeleteObject(w->backvalid);
+	}
+
 	free(w);
 	w = NULL;
 }
@@ -2069,6 +2103,27 @@ nserror win32_window_set_scroll(struct gui_window *gw, const struct rect *rect)
 	      - gw->requestscrollx,
 	      - gw->requestscrolly);
 
+	/* keep the back buffer and its valid region in step with the
+	 * scrolled window content; the strip scrolled in is left
+	 * outside the valid region so the next paint renders it.
+	 */
+	if (gw->backdc != NULL) {
+		BitBlt(gw->backdc,
+		       - gw->requestscrollx,
+		       - gw->requestscrolly,
+		       gw->backwidth,
+		       gw->backheight,
+		       gw->backdc,
+		       0,
+		       0,
+		       SRCCOPY);
+		if (gw->backvalid != NULL) {
+			OffsetRgn(gw->backvalid,
+				  - gw->requestscrollx,
+				  - gw->requestscrolly);
+		}
+	}
+
 	gw->scrolly += gw->requestscrolly;
 	gw->scrollx += gw->requestscrollx;
 	gw->requestscrollx = 0;
@@ -68,6 +68,13 @@ struct gui_window {
 
 	RECT *fullscreen; /**< memorize non-fullscreen area */
 	RECT redraw; /**< Area needing redraw. */
+
+	HDC backdc; /**< memory DC the back buffer is selected into */
+	HBITMAP backbitmap; /**< DIB section holding rendered window content */
+	int backwidth; /**< width of the back buffer */
+	int backheight; /**< height of the back buffer */
+	HRGN backvalid; /**< region of the back buffer that is up to date */
+
 	int requestscrollx, requestscrolly; /**< scolling requested. */
 	struct gui_window *next, *prev; /**< global linked list */
 };
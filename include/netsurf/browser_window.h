@@ -365,6 +365,33 @@ nserror browser_window_set_scale(struct browser_window *bw, float scale, bool ab
 float browser_window_get_scale(struct browser_window *bw);
 
 
+/**
+ * Inform the core whether a browser window is visible to the user.
+ *
+ * Front ends should call this from their tab switch and window
+ * iconise events. While a window is not visible the core withholds
+ * repaint requests, lets animations suspend, clamps javascript timers
+ * and defers meta refresh navigations, so background tabs stop
+ * consuming CPU; everything withheld is released when the window is
+ * reported visible again. Windows start visible.
+ *
+ * \param bw The browser window the visibility change applies to.
+ * \param visible true if the window can be seen by the user.
+ * \return NSERROR_OK on success else error code.
+ */
+nserror browser_window_set_visibility(struct browser_window *bw, bool visible);
+
+
+/**
+ * Find out whether a browser window is visible to the user.
+ *
+ * \param bw The browser window to query; may be a frame, in which
+ *           case the containing window's visibility is reported.
+ * \return true unless the front end has reported the window hidden.
+ */
+bool browser_window_get_visibility(struct browser_window *bw);
+
+
 /**
  * Get access to any page features at the given coordinates.
  *
@@ -68,6 +68,21 @@ struct content_redraw_data {
 struct bitmap *content_get_bitmap(struct hlcache_handle *h);
 
 
+/**
+ * Retrieve the bitmap contained in an image content at a given size
+ *
+ * As content_get_bitmap() but passes the size the caller will display
+ * the bitmap at, so contents holding several resolutions of an image
+ * (e.g. ico) can decode only the most appropriate one.
+ *
+ * \param h handle to the content.
+ * \param width The width the bitmap will be displayed at.
+ * \param height The height the bitmap will be displayed at.
+ * \return Pointer to bitmap, or NULL if none.
+ */
+struct bitmap *content_get_bitmap_sized(struct hlcache_handle *h, int width, int height);
+
+
 /**
  * Retrieve the encoding of a content
  *
@@ -285,4 +285,54 @@ extern plot_style_t *plot_style_stroke_lightwbasec;
 extern plot_font_style_t const * const plot_style_font;
 
 
+/**
+ * Intern a plot style.
+ *
+ * Resolves a computed style to a canonical copy with a small stable
+ * handle. Within one intern generation identical styles always
+ * resolve to the same copy, so plotters can cache expensive state
+ * (cairo patterns, GPU objects) against the handle or the canonical
+ * pointer instead of re-deriving it from the style fields on every
+ * plot call. The canonical copy remains valid until the next
+ * generation starts.
+ *
+ * If the intern table is full the style passed in is returned
+ * unchanged with a handle of zero; callers need not treat this
+ * specially as the returned pointer is always plottable.
+ *
+ * \param style The style to intern.
+ * \param handle_out Updated to the style's handle, or 0 if not
+ *                   interned. May be NULL.
+ * \return The canonical style, or \a style itself if not interned.
+ */
+const plot_style_t *plot_style_intern(const plot_style_t *style,
+		unsigned int *handle_out);
+
+/**
+ * Intern a font plot style.
+ *
+ * As plot_style_intern() but for font styles. The font family array
+ * is compared by pointer, so styles only unify when they come from
+ * the same computed style data.
+ *
+ * \param fstyle The font style to intern.
+ * \param handle_out Updated to the style's handle, or 0 if not
+ *                   interned. May be NULL.
+ * \return The canonical style, or \a fstyle itself if not interned.
+ */
+const plot_font_style_t *plot_font_style_intern(
+		const plot_font_style_t *fstyle,
+		unsigned int *handle_out);
+
+/**
+ * Start a new intern generation, discarding all interned styles.
+ *
+ * Called when the styles in use change wholesale, such as after a
+ * layout or a colour table update. Handles are never reused across
+ * generations, so state a plotter cached against a handle from an
+ * earlier generation simply never matches again.
+ */
+void plot_style_intern_invalidate(void);
+
+
 #endif
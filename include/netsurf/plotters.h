@@ -190,6 +190,27 @@ struct plotter_table {
 			const plot_style_t *pstyle,
 			const struct rect *rectangle);
 
+	/**
+	 * Plots many filled rectangles.
+	 *
+	 * optional, may be NULL. Equivalent to calling rectangle()
+	 *  for each rectangle in turn but allows the implementation
+	 *  to amortise its per call setup over the whole batch. Only
+	 *  ever called with styles which fill; the outline is never
+	 *  plotted.
+	 *
+	 * \param ctx The current redraw context.
+	 * \param pstyle Style controlling the rectangle plots.
+	 * \param rects The rectangles to fill.
+	 * \param n number of rectangles.
+	 * \return NSERROR_OK on success else error code.
+	 */
+	nserror (*rectangles)(
+			const struct redraw_context *ctx,
+			const plot_style_t *pstyle,
+			const struct rect *rects,
+			unsigned int n);
+
 	/**
 	 * Plot a polygon
 	 *
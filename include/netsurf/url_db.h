@@ -50,13 +50,21 @@ nserror urldb_load(const char *filename);
 
 
 /**
- * Export the current database to file
+ * Save the current database to file in the binary format
  *
- * \param filename Name of file to export to
+ * \param filename Name of file to save to
  */
 nserror urldb_save(const char *filename);
 
 
+/**
+ * Export the current database to file in the text format
+ *
+ * \param filename Name of file to export to
+ */
+nserror urldb_save_text(const char *filename);
+
+
 /**
  * Iterate over entries in the database which match the given prefix
  *
@@ -255,6 +255,29 @@ struct gui_window_table {
 
 	/* Optional entries */
 
+	/**
+	 * Shift an area of valid window content.
+	 *
+	 * Copies the pixels of an area of the window by the given
+	 *  delta, using the same coordinate space as invalidate().
+	 *  The core uses this to avoid repainting the unchanged
+	 *  overlap when a core managed frame scrolls; it invalidates
+	 *  the newly exposed region itself afterwards.
+	 *
+	 * A frontend which cannot perform the copy, either at all or
+	 *  at the time of the call (for example because updates are
+	 *  already pending for the area), should return an error and
+	 *  the core will repaint the whole area instead.
+	 *
+	 * \param gw The gui window to shift content in.
+	 * \param rect The area to shift.
+	 * \param dx The horizontal displacement of the existing pixels.
+	 * \param dy The vertical displacement of the existing pixels.
+	 * \return NSERROR_OK if the area was copied else error code.
+	 */
+	nserror (*scroll_area)(struct gui_window *gw, const struct rect *rect,
+			int dx, int dy);
+
 	/**
 	 * Set the title of a window.
 	 *
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Test base64 decoding operations.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+
+#include "utils/errors.h"
+#include "utils/base64.h"
+
+#define NELEMS(x)  (sizeof(x) / sizeof((x)[0]))
+
+struct test_decode_pair {
+	const char* test;
+	const char* expected;
+};
+
+struct test_bad_decode {
+	const char* test;
+	nserror res;
+};
+
+static const struct test_decode_pair decode_tests[] = {
+	{
+		.test     = "",
+		.expected = ""
+	},
+	{
+		.test     = "Zg==",
+		.expected = "f"
+	},
+	{
+		.test     = "Zm8=",
+		.expected = "fo"
+	},
+	{
+		.test     = "Zm9v",
+		.expected = "foo"
+	},
+	{
+		.test     = "Zm9vYg==",
+		.expected = "foob"
+	},
+	{
+		.test     = "Zm9vYmE=",
+		.expected = "fooba"
+	},
+	{
+		.test     = "Zm9vYmFy",
+		.expected = "foobar"
+	},
+	{
+		/* unpadded input must also decode */
+		.test     = "Zm9vYmE",
+		.expected = "fooba"
+	},
+	{
+		/* embedded whitespace is skipped */
+		.test     = "Zm9v\r\nYmFy",
+		.expected = "foobar"
+	},
+	{
+		/* whitespace breaking group alignment */
+		.test     = "Z m 9 v Y m F y",
+		.expected = "foobar"
+	},
+	{
+		.test     = "TmV0U3VyZiBpcyBhIHNtYWxsIHdlYiBicm93c2Vy",
+		.expected = "NetSurf is a small web browser"
+	},
+};
+
+static const struct test_bad_decode bad_decode_tests[] = {
+	{
+		.test = "Zm9v!mFy",
+		.res  = NSERROR_INVALID
+	},
+	{
+		.test = "####",
+		.res  = NSERROR_INVALID
+	},
+	{
+		.test = "Z",
+		.res  = NSERROR_INVALID
+	},
+};
+
+START_TEST(base64_decode_test)
+{
+	nserror res;
+	const struct test_decode_pair *tst = &decode_tests[_i];
+	uint8_t *data = NULL;
+	size_t datalen = 0;
+
+	res = base64_decode_alloc((const uint8_t *)tst->test,
+				  strlen(tst->test),
+				  &data,
+				  &datalen);
+	ck_assert_int_eq(res, NSERROR_OK);
+	ck_assert_uint_eq(datalen, strlen(tst->expected));
+	ck_assert(memcmp(data, tst->expected, datalen) == 0);
+
+	free(data);
+}
+END_TEST
+
+START_TEST(base64_bad_decode_test)
+{
+	nserror res;
+	const struct test_bad_decode *tst = &bad_decode_tests[_i];
+	uint8_t *data = NULL;
+	size_t datalen = 0;
+
+	res = base64_decode_alloc((const uint8_t *)tst->test,
+				  strlen(tst->test),
+				  &data,
+				  &datalen);
+	ck_assert_int_eq(res, tst->res);
+}
+END_TEST
+
+static Suite *base64_suite(void)
+{
+	Suite *s;
+	TCase *tc_decode;
+	TCase *tc_bad_decode;
+
+	s = suite_create("base64");
+
+	tc_decode = tcase_create("decode");
+	tcase_add_loop_test(tc_decode,
+			    base64_decode_test,
+			    0, NELEMS(decode_tests));
+	suite_add_tcase(s, tc_decode);
+
+	tc_bad_decode = tcase_create("decode (bad input)");
+	tcase_add_loop_test(tc_bad_decode,
+			    base64_bad_decode_test,
+			    0, NELEMS(bad_decode_tests));
+	suite_add_tcase(s, tc_bad_decode);
+
+	return s;
+}
+
+int main(int argc, char **argv)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = base64_suite();
+
+	sr = srunner_create(s);
+	srunner_run_all(sr, CK_ENV);
+
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
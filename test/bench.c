@@ -0,0 +1,421 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Microbenchmarks for core data structures.
+ *
+ * Timed workloads for the hashmap, hashtable, bloom filter, nsurl
+ * parsing and url database at realistic sizes. Results are emitted
+ * as JSON on stdout so successive runs on reference hardware can be
+ * compared across releases.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libwapcaplet/libwapcaplet.h>
+#include <nsutils/time.h>
+
+#include "utils/bloom.h"
+#include "utils/corestrings.h"
+#include "utils/errors.h"
+#include "utils/hashmap.h"
+#include "utils/hashtable.h"
+#include "utils/nsurl.h"
+#include "netsurf/bitmap.h"
+#include "netsurf/url_db.h"
+#include "content/urldb.h"
+#include "desktop/gui_internal.h"
+
+/** Number of urls used by the nsurl, hashmap and urldb workloads */
+#define BENCH_URL_COUNT 50000
+
+/** Number of entries used by the hashtable and bloom workloads */
+#define BENCH_KEY_COUNT 100000
+
+/** Number of lookup passes over the inserted data */
+#define BENCH_LOOKUP_PASSES 4
+
+/* mock table so urldb does not dereference a NULL gui table */
+static void bench_bitmap_destroy(void *bitmap)
+{
+}
+
+static struct gui_bitmap_table bench_bitmap_table = {
+	.destroy = bench_bitmap_destroy,
+};
+
+static struct netsurf_table bench_table = {
+	.bitmap = &bench_bitmap_table,
+};
+
+struct netsurf_table *guit = NULL;
+
+/** Whether a result has been emitted yet, for JSON comma placement */
+static bool bench_first_result = true;
+
+/**
+ * Emit one benchmark result as a JSON object.
+ *
+ * \param name Benchmark name.
+ * \param iterations Number of operations the elapsed time covers.
+ * \param start_ms Monotonic time the workload started.
+ * \param end_ms Monotonic time the workload finished.
+ */
+static void
+bench_report(const char *name,
+	     uint64_t iterations,
+	     uint64_t start_ms,
+	     uint64_t end_ms)
+{
+	uint64_t elapsed_ms = end_ms - start_ms;
+
+	printf("%s\n    {\"name\": \"%s\", "
+	       "\"iterations\": %"PRIu64", "
+	       "\"elapsed_ms\": %"PRIu64", "
+	       "\"ns_per_op\": %"PRIu64"}",
+	       bench_first_result ? "" : ",",
+	       name,
+	       iterations,
+	       elapsed_ms,
+	       (elapsed_ms * 1000000) / (iterations ? iterations : 1));
+
+	bench_first_result = false;
+}
+
+/**
+ * Build a plausible url string for an index.
+ *
+ * The host varies so entries spread across hosts like real browsing
+ * history does, while paths and queries keep the strings a realistic
+ * length.
+ */
+static void bench_url_string(char *buffer, size_t size, unsigned int idx)
+{
+	snprintf(buffer, size,
+		 "https://www%u.example%u.org/path/%u/page?q=%u&ref=bench",
+		 idx % 100, idx % 1000, idx, idx);
+}
+
+/**
+ * Time parsing url strings with nsurl_create.
+ */
+static nserror bench_nsurl(nsurl **urls)
+{
+	char buffer[128];
+	unsigned int idx;
+	uint64_t start_ms, end_ms;
+	nserror res;
+
+	nsu_getmonotonic_ms(&start_ms);
+	for (idx = 0; idx < BENCH_URL_COUNT; idx++) {
+		bench_url_string(buffer, sizeof(buffer), idx);
+		res = nsurl_create(buffer, &urls[idx]);
+		if (res != NSERROR_OK) {
+			return res;
+		}
+	}
+	nsu_getmonotonic_ms(&end_ms);
+
+	bench_report("nsurl_parse", BENCH_URL_COUNT, start_ms, end_ms);
+
+	return NSERROR_OK;
+}
+
+/* hashmap parameters mapping nsurl keys to a trivial value */
+
+static void *bench_key_clone(void *key)
+{
+	return nsurl_ref((nsurl *)key);
+}
+
+static void bench_key_destroy(void *key)
+{
+	nsurl_unref((nsurl *)key);
+}
+
+static uint32_t bench_key_hash(void *key)
+{
+	return nsurl_hash((nsurl *)key);
+}
+
+static bool bench_key_eq(void *key1, void *key2)
+{
+	return nsurl_compare((nsurl *)key1, (nsurl *)key2, NSURL_COMPLETE);
+}
+
+static void *bench_value_alloc(void *key)
+{
+	return malloc(sizeof(unsigned int));
+}
+
+static void bench_value_destroy(void *value)
+{
+	free(value);
+}
+
+static hashmap_parameters_t bench_hashmap_params = {
+	.key_clone = bench_key_clone,
+	.key_hash = bench_key_hash,
+	.key_eq = bench_key_eq,
+	.key_destroy = bench_key_destroy,
+	.value_alloc = bench_value_alloc,
+	.value_destroy = bench_value_destroy,
+};
+
+/**
+ * Time hashmap insert, lookup and remove with nsurl keys.
+ */
+static nserror bench_hashmap(nsurl **urls)
+{
+	hashmap_t *map;
+	unsigned int pass;
+	unsigned int idx;
+	uint64_t start_ms, end_ms;
+
+	map = hashmap_create(&bench_hashmap_params);
+	if (map == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	nsu_getmonotonic_ms(&start_ms);
+	for (idx = 0; idx < BENCH_URL_COUNT; idx++) {
+		if (hashmap_insert(map, urls[idx]) == NULL) {
+			hashmap_destroy(map);
+			return NSERROR_NOMEM;
+		}
+	}
+	nsu_getmonotonic_ms(&end_ms);
+	bench_report("hashmap_insert", BENCH_URL_COUNT, start_ms, end_ms);
+
+	nsu_getmonotonic_ms(&start_ms);
+	for (pass = 0; pass < BENCH_LOOKUP_PASSES; pass++) {
+		for (idx = 0; idx < BENCH_URL_COUNT; idx++) {
+			if (hashmap_lookup(map, urls[idx]) == NULL) {
+				hashmap_destroy(map);
+				return NSERROR_NOT_FOUND;
+			}
+		}
+	}
+	nsu_getmonotonic_ms(&end_ms);
+	bench_report("hashmap_lookup",
+		     (uint64_t)BENCH_URL_COUNT * BENCH_LOOKUP_PASSES,
+		     start_ms, end_ms);
+
+	nsu_getmonotonic_ms(&start_ms);
+	for (idx = 0; idx < BENCH_URL_COUNT; idx++) {
+		hashmap_remove(map, urls[idx]);
+	}
+	nsu_getmonotonic_ms(&end_ms);
+	bench_report("hashmap_remove", BENCH_URL_COUNT, start_ms, end_ms);
+
+	hashmap_destroy(map);
+
+	return NSERROR_OK;
+}
+
+/**
+ * Time hashtable add and get with string keys.
+ */
+static nserror bench_hashtable(void)
+{
+	struct hash_table *ht;
+	char key[64];
+	unsigned int pass;
+	unsigned int idx;
+	uint64_t start_ms, end_ms;
+
+	/* chain count matches the messages hash use of this table */
+	ht = hash_create(1031);
+	if (ht == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	nsu_getmonotonic_ms(&start_ms);
+	for (idx = 0; idx < BENCH_KEY_COUNT; idx++) {
+		snprintf(key, sizeof(key), "MessageKey%u", idx);
+		if (hash_add(ht, key, "benchmark value string") == false) {
+			hash_destroy(ht);
+			return NSERROR_NOMEM;
+		}
+	}
+	nsu_getmonotonic_ms(&end_ms);
+	bench_report("hashtable_add", BENCH_KEY_COUNT, start_ms, end_ms);
+
+	nsu_getmonotonic_ms(&start_ms);
+	for (pass = 0; pass < BENCH_LOOKUP_PASSES; pass++) {
+		for (idx = 0; idx < BENCH_KEY_COUNT; idx++) {
+			snprintf(key, sizeof(key), "MessageKey%u", idx);
+			if (hash_get(ht, key) == NULL) {
+				hash_destroy(ht);
+				return NSERROR_NOT_FOUND;
+			}
+		}
+	}
+	nsu_getmonotonic_ms(&end_ms);
+	bench_report("hashtable_get",
+		     (uint64_t)BENCH_KEY_COUNT * BENCH_LOOKUP_PASSES,
+		     start_ms, end_ms);
+
+	hash_destroy(ht);
+
+	return NSERROR_OK;
+}
+
+/**
+ * Time bloom filter insert and search.
+ */
+static nserror bench_bloom(void)
+{
+	struct bloom_filter *bloom;
+	char key[64];
+	unsigned int pass;
+	unsigned int idx;
+	uint64_t start_ms, end_ms;
+
+	/* filter size matches the urldb use of the bloom filter */
+	bloom = bloom_create(8192);
+	if (bloom == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	nsu_getmonotonic_ms(&start_ms);
+	for (idx = 0; idx < BENCH_KEY_COUNT; idx++) {
+		snprintf(key, sizeof(key), "https://example%u.org/", idx);
+		bloom_insert_str(bloom, key, strlen(key));
+	}
+	nsu_getmonotonic_ms(&end_ms);
+	bench_report("bloom_insert", BENCH_KEY_COUNT, start_ms, end_ms);
+
+	nsu_getmonotonic_ms(&start_ms);
+	for (pass = 0; pass < BENCH_LOOKUP_PASSES; pass++) {
+		for (idx = 0; idx < BENCH_KEY_COUNT; idx++) {
+			snprintf(key, sizeof(key),
+				 "https://example%u.org/", idx);
+			if (bloom_search_str(bloom, key,
+					     strlen(key)) == false) {
+				bloom_destroy(bloom);
+				return NSERROR_NOT_FOUND;
+			}
+		}
+	}
+	nsu_getmonotonic_ms(&end_ms);
+	bench_report("bloom_search",
+		     (uint64_t)BENCH_KEY_COUNT * BENCH_LOOKUP_PASSES,
+		     start_ms, end_ms);
+
+	bloom_destroy(bloom);
+
+	return NSERROR_OK;
+}
+
+/**
+ * Time url database insert and lookup.
+ */
+static nserror bench_urldb(nsurl **urls)
+{
+	unsigned int pass;
+	unsigned int idx;
+	uint64_t start_ms, end_ms;
+
+	nsu_getmonotonic_ms(&start_ms);
+	for (idx = 0; idx < BENCH_URL_COUNT; idx++) {
+		if (urldb_add_url(urls[idx]) == false) {
+			return NSERROR_NOMEM;
+		}
+	}
+	nsu_getmonotonic_ms(&end_ms);
+	bench_report("urldb_add", BENCH_URL_COUNT, start_ms, end_ms);
+
+	nsu_getmonotonic_ms(&start_ms);
+	for (pass = 0; pass < BENCH_LOOKUP_PASSES; pass++) {
+		for (idx = 0; idx < BENCH_URL_COUNT; idx++) {
+			if (urldb_get_url(urls[idx]) == NULL) {
+				return NSERROR_NOT_FOUND;
+			}
+		}
+	}
+	nsu_getmonotonic_ms(&end_ms);
+	bench_report("urldb_lookup",
+		     (uint64_t)BENCH_URL_COUNT * BENCH_LOOKUP_PASSES,
+		     start_ms, end_ms);
+
+	urldb_destroy();
+
+	return NSERROR_OK;
+}
+
+int main(int argc, char **argv)
+{
+	nsurl **urls;
+	unsigned int idx;
+	nserror res;
+	int ret = EXIT_SUCCESS;
+
+	guit = &bench_table;
+
+	res = corestrings_init();
+	if (res != NSERROR_OK) {
+		fprintf(stderr, "corestrings initialisation failed\n");
+		return EXIT_FAILURE;
+	}
+
+	urls = calloc(BENCH_URL_COUNT, sizeof(*urls));
+	if (urls == NULL) {
+		corestrings_fini();
+		return EXIT_FAILURE;
+	}
+
+	printf("{\n  \"benchmarks\": [");
+
+	res = bench_nsurl(urls);
+	if (res == NSERROR_OK) {
+		res = bench_hashmap(urls);
+	}
+	if (res == NSERROR_OK) {
+		res = bench_hashtable();
+	}
+	if (res == NSERROR_OK) {
+		res = bench_bloom();
+	}
+	if (res == NSERROR_OK) {
+		res = bench_urldb(urls);
+	}
+
+	printf("\n  ]\n}\n");
+
+	if (res != NSERROR_OK) {
+		fprintf(stderr, "benchmark failed: %d\n", res);
+		ret = EXIT_FAILURE;
+	}
+
+	for (idx = 0; idx < BENCH_URL_COUNT; idx++) {
+		if (urls[idx] != NULL) {
+			nsurl_unref(urls[idx]);
+		}
+	}
+	free(urls);
+
+	corestrings_fini();
+
+	return ret;
+}
@@ -114,6 +114,52 @@ START_TEST(bloom_insert_empty_str_test)
 END_TEST
 
 
+/**
+ * Test counting bloom filter removal
+ *
+ * Create a counting bloom filter, add a single entry twice, remove it
+ * twice and check presence is only reported while insertions remain.
+ */
+START_TEST(bloom_counting_remove_test)
+{
+	struct bloom_filter *b;
+	b = bloom_create_counting(BLOOM_SIZE);
+	ck_assert(b != NULL);
+
+	bloom_insert_str(b, "NetSurf", 7);
+	bloom_insert_str(b, "NetSurf", 7);
+	ck_assert(bloom_search_str(b, "NetSurf", 7));
+	ck_assert(bloom_items(b) == 2);
+
+	bloom_remove_str(b, "NetSurf", 7);
+	ck_assert(bloom_search_str(b, "NetSurf", 7));
+
+	bloom_remove_str(b, "NetSurf", 7);
+	ck_assert(!bloom_search_str(b, "NetSurf", 7));
+	ck_assert(bloom_items(b) == 0);
+
+	bloom_destroy(b);
+}
+END_TEST
+
+/**
+ * Test that removal from a plain bloom filter is ignored
+ */
+START_TEST(bloom_plain_remove_test)
+{
+	struct bloom_filter *b;
+	b = bloom_create(BLOOM_SIZE);
+	ck_assert(b != NULL);
+
+	bloom_insert_str(b, "NetSurf", 7);
+	bloom_remove_str(b, "NetSurf", 7);
+	ck_assert(bloom_search_str(b, "NetSurf", 7));
+
+	bloom_destroy(b);
+}
+END_TEST
+
+
 /**
  * Basic API creation test case
  */
@@ -125,6 +171,8 @@ static TCase *bloom_api_case_create(void)
 
 	tcase_add_test(tc, bloom_create_test);
 	tcase_add_test(tc, bloom_insert_empty_str_test);
+	tcase_add_test(tc, bloom_counting_remove_test);
+	tcase_add_test(tc, bloom_plain_remove_test);
 
 	return tc;
 }
@@ -247,6 +247,19 @@ START_TEST(insert_then_lookup)
 }
 END_TEST
 
+START_TEST(reserve_then_insert)
+{
+	hashmap_test_value_t *value;
+	/* Enough to force the table to grow several times */
+	ck_assert(hashmap_reserve(test_hashmap, 4096) == true);
+	ck_assert_int_eq(hashmap_count(test_hashmap), 0);
+	value = hashmap_insert(test_hashmap, corestring_nsurl_about_blank);
+	ck_assert(value != NULL);
+	ck_assert(hashmap_lookup(test_hashmap, corestring_nsurl_about_blank) == value);
+	ck_assert_int_eq(hashmap_count(test_hashmap), 1);
+}
+END_TEST
+
 START_TEST(iterate_empty)
 {
 	iteration_stop = iteration_counter = 0;
@@ -291,7 +304,8 @@ static TCase *basic_api_case_create(void)
 	tcase_add_test(tc, remove_not_present);
 	tcase_add_test(tc, insert_then_remove);
 	tcase_add_test(tc, insert_then_lookup);
-	
+	tcase_add_test(tc, reserve_then_insert);
+
 	tcase_add_test(tc, iterate_empty);
 	tcase_add_test(tc, iterate_one);
 	tcase_add_test(tc, iterate_one_and_stop);
@@ -299,7 +313,7 @@ static TCase *basic_api_case_create(void)
 	return tc;
 }
 
-/* Chain verification test suite */
+/* Collision verification test suite */
 
 typedef struct {
 	const char *url;
@@ -308,9 +322,9 @@ typedef struct {
 
 /* The hobbled hash has only 4 values
  * By having at least 12 test cases, we can be confident that
- * at worst they'll all be on one chain, but at best there'll
- * be four chains of 3 entries which means we should be able
- * to validate prevptr and next in all cases.
+ * at worst they'll all land in one probe cluster, but at best
+ * there'll be four clusters of 3 entries, which exercises entry
+ * displacement and removal from within a cluster in all cases.
  */
 static case_pair chain_pairs[] = {
 	{ "https://www.google.com/", NULL },
@@ -477,7 +491,7 @@ START_TEST(chain_add_all_twice_remove_all_iterate)
 }
 END_TEST
 
-#define CHAIN_TEST_MALLOC_COUNT_MAX 60
+#define CHAIN_TEST_MALLOC_COUNT_MAX 48
 
 START_TEST(chain_add_all_remove_all_alloc)
 {
@@ -525,7 +539,7 @@ END_TEST
 static TCase *chain_case_create(void)
 {
 	TCase *tc;
-	tc = tcase_create("Bucket Chain tests");
+	tc = tcase_create("Probe cluster tests");
 	
 	tcase_add_unchecked_fixture(tc,
 				    chain_fixture_create,
@@ -29,6 +29,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <check.h>
 
 #include "utils/errors.h"
@@ -49,6 +50,9 @@ static struct hash_table *match_hash_b;
 
 static struct hash_table *dict_hash;
 
+static struct hash_table *file_hash;
+static char file_hash_path[] = "/tmp/nshashtablefileXXXXXX";
+
 static const struct test_pairs match_tests[] = {
 	{ "cow", "moo" },
 	{ "pig", "oink" },
@@ -129,6 +133,50 @@ static void dict_hashtable_teardown(void)
 	hash_destroy(dict_hash);
 }
 
+/**
+ * create a hashtable from an uncompressed key/value file
+ *
+ * exercises the file add path, which on platforms with mmap() maps
+ * the file and materialises entries on first lookup
+ */
+static void file_hashtable_create(void)
+{
+	int fd;
+	FILE *f;
+
+	fd = mkstemp(file_hash_path);
+	ck_assert(fd >= 0);
+
+	f = fdopen(fd, "w");
+	ck_assert(f != NULL);
+	fputs("# comment line\n"
+	      "\n"
+	      "KeyOne:Value One\n"
+	      "\tIndented:indented value\n"
+	      "Dup:first\n"
+	      "Dup:second\n"
+	      "Preexisting:from file\n", f);
+	fclose(f);
+
+	file_hash = hash_create(7);
+	ck_assert(file_hash != NULL);
+
+	/* table entries present before the file is added are
+	 * overridden by it */
+	ck_assert(hash_add(file_hash, "Preexisting", "fallback"));
+
+	ck_assert_int_eq(hash_add_file(file_hash, file_hash_path),
+			 NSERROR_OK);
+}
+
+static void file_hashtable_teardown(void)
+{
+	hash_destroy(file_hash);
+	unlink(file_hash_path);
+	/* restore the template for the next fixture invocation */
+	memcpy(file_hash_path + strlen(file_hash_path) - 6, "XXXXXX", 6);
+}
+
 /* Tests */
 
 /**
@@ -253,6 +301,82 @@ START_TEST(hashtable_dict_test)
 }
 END_TEST
 
+START_TEST(hashtable_file_positive_test)
+{
+	const char *res;
+
+	res = hash_get(file_hash, "KeyOne");
+	ck_assert(res != NULL);
+	ck_assert_str_eq(res, "Value One");
+
+	/* a second lookup must yield the same entry */
+	res = hash_get(file_hash, "KeyOne");
+	ck_assert(res != NULL);
+	ck_assert_str_eq(res, "Value One");
+}
+END_TEST
+
+
+START_TEST(hashtable_file_indented_test)
+{
+	const char *res;
+
+	/* leading whitespace before a key is skipped */
+	res = hash_get(file_hash, "Indented");
+	ck_assert(res != NULL);
+	ck_assert_str_eq(res, "indented value");
+}
+END_TEST
+
+
+START_TEST(hashtable_file_duplicate_test)
+{
+	const char *res;
+
+	/* later lines take precedence over earlier ones */
+	res = hash_get(file_hash, "Dup");
+	ck_assert(res != NULL);
+	ck_assert_str_eq(res, "second");
+}
+END_TEST
+
+
+START_TEST(hashtable_file_override_test)
+{
+	const char *res;
+
+	/* the file entry overrides the entry added before the file */
+	res = hash_get(file_hash, "Preexisting");
+	ck_assert(res != NULL);
+	ck_assert_str_eq(res, "from file");
+}
+END_TEST
+
+
+START_TEST(hashtable_file_negative_test)
+{
+	/* comment lines do not become entries */
+	ck_assert(hash_get(file_hash, "# comment line") == NULL);
+
+	ck_assert(hash_get(file_hash, "Absent") == NULL);
+}
+END_TEST
+
+
+START_TEST(hashtable_file_missing_test)
+{
+	struct hash_table *ht;
+
+	ht = hash_create(7);
+	ck_assert(ht != NULL);
+
+	ck_assert_int_eq(hash_add_file(ht, "/nonexistent/Messages"),
+			 NSERROR_NOT_FOUND);
+
+	hash_destroy(ht);
+}
+END_TEST
+
 /* Suite */
 
 static Suite *hashtable_suite(void)
@@ -262,6 +386,7 @@ static Suite *hashtable_suite(void)
 	TCase *tc_match;
 	TCase *tc_dict_s;
 	TCase *tc_dict_l;
+	TCase *tc_file;
 
 	s = suite_create("hash table filter");
 
@@ -311,6 +436,21 @@ static Suite *hashtable_suite(void)
 
 	suite_add_tcase(s, tc_dict_l);
 
+	/* file add tests */
+	tc_file = tcase_create("File");
+	tcase_add_checked_fixture(tc_file,
+				  file_hashtable_create,
+				  file_hashtable_teardown);
+
+	tcase_add_test(tc_file, hashtable_file_positive_test);
+	tcase_add_test(tc_file, hashtable_file_indented_test);
+	tcase_add_test(tc_file, hashtable_file_duplicate_test);
+	tcase_add_test(tc_file, hashtable_file_override_test);
+	tcase_add_test(tc_file, hashtable_file_negative_test);
+	tcase_add_test(tc_file, hashtable_file_missing_test);
+
+	suite_add_tcase(s, tc_file);
+
 	return s;
 }
 
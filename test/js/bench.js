@@ -0,0 +1,26 @@
+/* Shared helper for the JS binding benchmark pages.
+ *
+ * Each page calls bench() for its cases and benchDone() once at the
+ * end.  Results go through the console, so the monkey frontend's
+ * CONSOLE_LOG output carries them to monkey_js_bench.py; case names
+ * must not contain spaces as the transport folds whitespace.
+ */
+
+function bench(name, ops, fn) {
+	/* short warm up so one-off setup is not measured */
+	fn(100 < ops ? 100 : ops);
+
+	var start = Date.now();
+	fn(ops);
+	var elapsed = (Date.now() - start) / 1000;
+
+	console.log("NSJSBENCH " + JSON.stringify({
+		name: name,
+		ops: ops,
+		time_s: elapsed
+	}));
+}
+
+function benchDone() {
+	console.log("NSJSBENCH-DONE");
+}
@@ -124,7 +124,6 @@ START_TEST(mimesniff_api_test)
 }
 END_TEST
 
-
 static TCase *mimesniff_api_case_create(void)
 {
 	TCase *tc;
@@ -833,6 +832,35 @@ START_TEST(mimesniff_text_fancy_header_sniff_test)
 END_TEST
 
 
+/* sniff outcome counters track computations */
+START_TEST(mimesniff_stats_test)
+{
+	nserror err;
+	lwc_string *effective_type;
+	struct mimesniff_stats before;
+	struct mimesniff_stats after;
+
+	err = mimesniff_get_stats(&before);
+	ck_assert(err == NSERROR_OK);
+
+	/* official header type used unmodified */
+	err = mimesniff_compute_effective_type("text/css",
+					       NULL,
+					       0,
+					       true,
+					       false,
+					       &effective_type);
+	ck_assert(err == NSERROR_OK);
+	lwc_string_unref(effective_type);
+
+	err = mimesniff_get_stats(&after);
+	ck_assert(err == NSERROR_OK);
+	ck_assert_int_eq(after.total, before.total + 1);
+	ck_assert_int_eq(after.official, before.official + 1);
+}
+END_TEST
+
+
 /* test cases with header mime type */
 static TCase *mimesniff_header_case_create(void)
 {
@@ -863,6 +891,8 @@ static TCase *mimesniff_header_case_create(void)
 
 	tcase_add_test(tc, mimesniff_text_fancy_header_sniff_test);
 
+	tcase_add_test(tc, mimesniff_stats_test);
+
 	return tc;
 }
 
@@ -0,0 +1,148 @@
+#!/usr/bin/python3
+#
+# Copyright 2026 NetSurf Developers
+#
+# This file is part of NetSurf, http://www.netsurf-browser.org/
+#
+# NetSurf is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; version 2 of the License.
+#
+# NetSurf is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""
+JS binding benchmark harness driving the monkey frontend
+
+Loads each test/js/bench-*.html page, which times its binding hot
+loops and reports each case through the console, and aggregates the
+per case timings over several fresh loads into a JSON report
+comparable across builds.
+"""
+
+# pylint: disable=locally-disabled, missing-docstring
+
+import getopt
+import glob
+import json
+import os
+import sys
+
+from monkeyfarmer import Browser
+
+DEFAULT_CORPUS = os.path.join(os.path.dirname(__file__), "js")
+DEFAULT_REPEATS = 3
+
+BENCH_PREFIX = "NSJSBENCH "
+BENCH_DONE = "NSJSBENCH-DONE"
+
+
+def print_usage():
+    print('Usage:')
+    print('  ' + sys.argv[0] +
+          ' -m <path to monkey> [-c <corpus dir>] [-r <repeats>]'
+          ' [-w <wrapper arguments>]')
+
+
+def parse_argv(argv):
+    path_monkey = ''
+    corpus = DEFAULT_CORPUS
+    repeats = DEFAULT_REPEATS
+    wrapper = None
+    try:
+        opts, _args = getopt.getopt(
+            argv, "hm:c:r:w:",
+            ["monkey=", "corpus=", "repeats=", "wrapper="])
+    except getopt.GetoptError:
+        print_usage()
+        sys.exit(2)
+    for opt, arg in opts:
+        if opt == '-h':
+            print_usage()
+            sys.exit()
+        elif opt in ("-m", "--monkey"):
+            path_monkey = arg
+        elif opt in ("-c", "--corpus"):
+            corpus = arg
+        elif opt in ("-r", "--repeats"):
+            repeats = int(arg)
+        elif opt in ("-w", "--wrapper"):
+            if wrapper is None:
+                wrapper = []
+            wrapper.extend(arg.split())
+
+    if path_monkey == '':
+        print_usage()
+        sys.exit()
+
+    return path_monkey, corpus, repeats, wrapper
+
+
+def run_page(browser, path):
+    url = "file://" + os.path.abspath(path)
+    win = browser.new_window(url=url)
+    win.wait_loaded()
+    win.wait_for_log(substr=BENCH_DONE)
+
+    cases = []
+    for (_src, _foldable, _level, msg) in win.log_entries:
+        idx = msg.find(BENCH_PREFIX)
+        if idx != -1:
+            cases.append(json.loads(msg[idx + len(BENCH_PREFIX):]))
+
+    win.kill()
+    win.wait_until_dead()
+
+    return cases
+
+
+def bench_page(browser, path, repeats):
+    results = {}
+    # a fresh window per repeat so runs do not share heap state
+    for _ in range(repeats):
+        for case in run_page(browser, path):
+            entry = results.setdefault(case["name"], {
+                "ops": case["ops"],
+                "times_s": [],
+            })
+            entry["times_s"].append(case["time_s"])
+
+    for entry in results.values():
+        entry["min_s"] = min(entry["times_s"])
+        entry["mean_s"] = sum(entry["times_s"]) / len(entry["times_s"])
+
+    return results
+
+
+def main(argv):
+    path_monkey, corpus, repeats, wrapper = parse_argv(argv)
+
+    pages = sorted(glob.glob(os.path.join(corpus, "bench-*.html")))
+    if not pages:
+        print("No benchmark pages found in " + corpus)
+        sys.exit(1)
+
+    browser = Browser(monkey_cmd=[path_monkey], quiet=True, wrapper=wrapper)
+    assert browser.started
+
+    report = {
+        "repeats": repeats,
+        "pages": {},
+    }
+    for path in pages:
+        report["pages"][os.path.basename(path)] = bench_page(
+            browser, path, repeats)
+
+    browser.quit_and_wait()
+
+    json.dump(report, sys.stdout, indent=2)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
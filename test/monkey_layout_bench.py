@@ -0,0 +1,138 @@
+#!/usr/bin/python3
+#
+# Copyright 2026 NetSurf Developers
+#
+# This file is part of NetSurf, http://www.netsurf-browser.org/
+#
+# NetSurf is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; version 2 of the License.
+#
+# NetSurf is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""
+layout benchmark harness driving the monkey frontend
+
+Loads each page of a stored corpus, forces repeated reformats at
+several widths via the WINDOW RESIZE command and reports per page
+layout times as JSON.
+"""
+
+# pylint: disable=locally-disabled, missing-docstring
+
+import getopt
+import glob
+import json
+import os
+import sys
+
+from monkeyfarmer import Browser
+
+DEFAULT_CORPUS = os.path.join(os.path.dirname(__file__), "layout-corpus")
+DEFAULT_WIDTHS = [320, 800, 1280]
+DEFAULT_REPEATS = 5
+
+
+def print_usage():
+    print('Usage:')
+    print('  ' + sys.argv[0] +
+          ' -m <path to monkey> [-c <corpus dir>] [-W <widths>]'
+          ' [-r <repeats>] [-w <wrapper arguments>]')
+
+
+def parse_argv(argv):
+    path_monkey = ''
+    corpus = DEFAULT_CORPUS
+    widths = DEFAULT_WIDTHS
+    repeats = DEFAULT_REPEATS
+    wrapper = None
+    try:
+        opts, _args = getopt.getopt(
+            argv, "hm:c:W:r:w:",
+            ["monkey=", "corpus=", "widths=", "repeats=", "wrapper="])
+    except getopt.GetoptError:
+        print_usage()
+        sys.exit(2)
+    for opt, arg in opts:
+        if opt == '-h':
+            print_usage()
+            sys.exit()
+        elif opt in ("-m", "--monkey"):
+            path_monkey = arg
+        elif opt in ("-c", "--corpus"):
+            corpus = arg
+        elif opt in ("-W", "--widths"):
+            widths = [int(width) for width in arg.split(",")]
+        elif opt in ("-r", "--repeats"):
+            repeats = int(arg)
+        elif opt in ("-w", "--wrapper"):
+            if wrapper is None:
+                wrapper = []
+            wrapper.extend(arg.split())
+
+    if path_monkey == '':
+        print_usage()
+        sys.exit()
+
+    return path_monkey, corpus, widths, repeats, wrapper
+
+
+def bench_page(browser, path, widths, repeats):
+    url = "file://" + os.path.abspath(path)
+    win = browser.new_window(url=url)
+    win.wait_loaded()
+
+    results = {}
+    for width in widths:
+        times = []
+        for _ in range(repeats):
+            # alternate the height so every reformat does real work
+            # rather than being elided as a no-op
+            win.resize(width, 600)
+            times.append(win.resize(width, 601))
+        results[str(width)] = {
+            "times_s": times,
+            "min_s": min(times),
+            "mean_s": sum(times) / len(times),
+        }
+
+    win.kill()
+    win.wait_until_dead()
+
+    return results
+
+
+def main(argv):
+    path_monkey, corpus, widths, repeats, wrapper = parse_argv(argv)
+
+    pages = sorted(glob.glob(os.path.join(corpus, "*.html")))
+    if not pages:
+        print("No corpus pages found in " + corpus)
+        sys.exit(1)
+
+    browser = Browser(monkey_cmd=[path_monkey], quiet=True, wrapper=wrapper)
+    assert browser.started
+
+    report = {
+        "widths": widths,
+        "repeats": repeats,
+        "pages": {},
+    }
+    for path in pages:
+        report["pages"][os.path.basename(path)] = bench_page(
+            browser, path, widths, repeats)
+
+    browser.quit_and_wait()
+
+    json.dump(report, sys.stdout, indent=2)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
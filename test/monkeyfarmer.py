@@ -406,6 +406,7 @@ class BrowserWindow:
         self.plotting = False
         self.log_entries = []
         self.page_info_state = "UNKNOWN"
+        self.last_resize_time = None
 
     def kill(self):
         self.browser.farmer.tell_monkey("WINDOW DESTROY %s" % self.winid)
@@ -453,6 +454,11 @@ class BrowserWindow:
         self.width = int(width)
         self.height = int(height)
 
+    def handle_window_RESIZE(self, _width, width, _height, height, _time, elapsed):
+        self.width = int(width)
+        self.height = int(height)
+        self.last_resize_time = float(elapsed)
+
     def handle_window_DESTROY(self):
         self.alive = False
 
@@ -555,6 +561,16 @@ class BrowserWindow:
             self.browser.farmer.loop(once=True)
         return self.plotted
 
+    def resize(self, width, height):
+        """ Resize the window, returning the time the reformat took in
+        seconds. """
+        self.last_resize_time = None
+        self.browser.farmer.tell_monkey("WINDOW RESIZE WIN %s WIDTH %s HEIGHT %s" % (
+            self.winid, width, height))
+        while self.last_resize_time is None:
+            self.browser.farmer.loop(once=True)
+        return self.last_resize_time
+
     def clear_log(self):
         self.log_entries = []
 
@@ -483,6 +483,46 @@ START_TEST(nsurl_join_test)
 END_TEST
 
 
+/**
+ * url joining against a query-bearing base with the results interned
+ *
+ * The fast join path composes the candidate string from the base
+ * URL's prefix and matches it against live interned URLs. Keep both
+ * the correct result and the URL a one byte prefix error would
+ * compose (a double slash after the authority) interned, so a prefix
+ * length mistake returns the wrong object instead of quietly falling
+ * back to the full parser.
+ */
+START_TEST(nsurl_join_query_base_test)
+{
+	nserror err;
+	nsurl *base_url;
+	nsurl *expected;
+	nsurl *bogus;
+	nsurl *joined;
+
+	err = nsurl_create("http://a/b/c/d;p?q", &base_url);
+	ck_assert(err == NSERROR_OK);
+
+	err = nsurl_create("http://a/b/c/g", &expected);
+	ck_assert(err == NSERROR_OK);
+
+	err = nsurl_create("http://a//b/c/g", &bogus);
+	ck_assert(err == NSERROR_OK);
+
+	err = nsurl_join(base_url, "g", &joined);
+	ck_assert(err == NSERROR_OK);
+
+	ck_assert_str_eq(nsurl_access(joined), "http://a/b/c/g");
+
+	nsurl_unref(joined);
+	nsurl_unref(bogus);
+	nsurl_unref(expected);
+	nsurl_unref(base_url);
+}
+END_TEST
+
+
 /**
  * more complex joins that specify a base to join to
  */
@@ -1508,6 +1548,7 @@ static Suite *nsurl_suite(void)
 	tcase_add_loop_test(tc_join,
 			    nsurl_join_complex_test,
 			    0, NELEMS(join_complex_tests));
+	tcase_add_test(tc_join, nsurl_join_query_base_test);
 
 	suite_add_tcase(s, tc_join);
 
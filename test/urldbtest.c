@@ -591,9 +591,9 @@ START_TEST(urldb_session_test)
 
 	urldb_load_cookies(test_cookies_path);
 
-	/* write database out */
+	/* write text export out */
 	outnam = testnam(NULL);
-	res = urldb_save(outnam);
+	res = urldb_save_text(outnam);
 	ck_assert_int_eq(res, NSERROR_OK);
 
 	/* check the url database file written and the test file match */
@@ -602,6 +602,27 @@ START_TEST(urldb_session_test)
 	/* remove test output */
 	unlink(outnam);
 
+	/* write binary database out and reload it */
+	outnam = testnam(NULL);
+	res = urldb_save(outnam);
+	ck_assert_int_eq(res, NSERROR_OK);
+
+	res = urldb_load(outnam);
+	ck_assert_int_eq(res, NSERROR_OK);
+
+	/* remove test output */
+	unlink(outnam);
+
+	/* text export after the binary round trip must be unchanged */
+	outnam = testnam(NULL);
+	res = urldb_save_text(outnam);
+	ck_assert_int_eq(res, NSERROR_OK);
+
+	ck_assert_int_eq(cmp(outnam, test_urldb_out_path), 0);
+
+	/* remove test output */
+	unlink(outnam);
+
 	/* write cookies out */
 	outnam = testnam(NULL);
 	urldb_save_cookies(outnam);
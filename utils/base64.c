@@ -0,0 +1,216 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Fast base64 decoding implementation.
+ *
+ * The decoder maps each of the four characters in an input group
+ * through a position-specific table yielding pre-shifted 24 bit
+ * values which are simply ORed together.  A single sentinel bit
+ * doubles as the validity check for the whole group so the common
+ * path decodes three output bytes with four loads, three ORs and one
+ * branch.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "utils/ascii.h"
+#include "utils/base64.h"
+
+/** Sentinel bit set in the tables for characters outside the alphabet */
+#define B64_INVALID 0x01000000u
+
+/** The base64 alphabet in encoding order */
+static const char base64_alphabet[] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/** Position specific decode tables; built on first use */
+static uint32_t base64_table[4][256];
+
+/** Whether the decode tables have been built */
+static bool base64_table_ready;
+
+/**
+ * Build the position specific decode tables.
+ */
+static void base64_build_table(void)
+{
+	unsigned int pos;
+	unsigned int chr;
+
+	for (pos = 0; pos != 4; pos++) {
+		for (chr = 0; chr != 256; chr++) {
+			base64_table[pos][chr] = B64_INVALID;
+		}
+		for (chr = 0; chr != 64; chr++) {
+			base64_table[pos][(uint8_t)base64_alphabet[chr]] =
+				(uint32_t)chr << (18 - (6 * pos));
+		}
+	}
+
+	base64_table_ready = true;
+}
+
+/**
+ * Decode a single group of up to four characters.
+ *
+ * \param group The group characters, already filtered for whitespace.
+ * \param group_used Number of characters present (2 to 4).
+ * \param output Location to write up to three decoded bytes.
+ * \return Number of bytes written or -1 if the group is invalid.
+ */
+static int base64_decode_tail(const uint8_t *group,
+			      size_t group_used,
+			      uint8_t *output)
+{
+	uint32_t accum;
+
+	if (group_used < 2) {
+		return -1;
+	}
+
+	accum = base64_table[0][group[0]] | base64_table[1][group[1]];
+	if (group_used > 2) {
+		accum |= base64_table[2][group[2]];
+	}
+	if (group_used > 3) {
+		accum |= base64_table[3][group[3]];
+	}
+	if (accum & B64_INVALID) {
+		return -1;
+	}
+
+	output[0] = (accum >> 16) & 0xff;
+	if (group_used > 2) {
+		output[1] = (accum >> 8) & 0xff;
+	}
+	if (group_used > 3) {
+		output[2] = accum & 0xff;
+	}
+
+	return (int)(group_used - 1);
+}
+
+/* exported interface documented in utils/base64.h */
+nserror
+base64_decode_alloc(const uint8_t *input,
+		    size_t input_length,
+		    uint8_t **output,
+		    size_t *output_length)
+{
+	uint8_t *decoded;
+	uint8_t *outp;
+	size_t inp = 0;
+	uint8_t group[4];
+	size_t group_used = 0;
+	bool ended = false;
+
+	if (!base64_table_ready) {
+		base64_build_table();
+	}
+
+	/* upper bound on the decoded size */
+	decoded = malloc(((input_length / 4) + 1) * 3);
+	if (decoded == NULL) {
+		return NSERROR_NOMEM;
+	}
+	outp = decoded;
+
+	/* fast path over aligned groups of four alphabet characters */
+	while ((ended == false) && (inp + 4 <= input_length)) {
+		uint32_t accum;
+
+		accum = base64_table[0][input[inp]] |
+			base64_table[1][input[inp + 1]] |
+			base64_table[2][input[inp + 2]] |
+			base64_table[3][input[inp + 3]];
+		if ((accum & B64_INVALID) == 0) {
+			outp[0] = (accum >> 16) & 0xff;
+			outp[1] = (accum >> 8) & 0xff;
+			outp[2] = accum & 0xff;
+			outp += 3;
+			inp += 4;
+			continue;
+		}
+
+		/* something other than four alphabet characters;
+		 * gather a group one character at a time
+		 */
+		group_used = 0;
+		while ((group_used != 4) && (inp < input_length)) {
+			uint8_t chr = input[inp];
+
+			if (ascii_is_space((char)chr)) {
+				inp++;
+			} else if (chr == '=') {
+				ended = true;
+				break;
+			} else if (base64_table[0][chr] != B64_INVALID) {
+				group[group_used++] = chr;
+				inp++;
+			} else {
+				free(decoded);
+				return NSERROR_INVALID;
+			}
+		}
+
+		if (group_used == 4) {
+			int used = base64_decode_tail(group, 4, outp);
+			if (used < 0) {
+				free(decoded);
+				return NSERROR_INVALID;
+			}
+			outp += used;
+			group_used = 0;
+		}
+	}
+
+	/* gather any remaining characters */
+	while ((ended == false) && (inp < input_length)) {
+		uint8_t chr = input[inp];
+
+		if (ascii_is_space((char)chr)) {
+			inp++;
+		} else if (chr == '=') {
+			ended = true;
+		} else if ((group_used != 4) &&
+			   (base64_table[0][chr] != B64_INVALID)) {
+			group[group_used++] = chr;
+			inp++;
+		} else {
+			free(decoded);
+			return NSERROR_INVALID;
+		}
+	}
+
+	if (group_used != 0) {
+		int used = base64_decode_tail(group, group_used, outp);
+		if (used < 0) {
+			free(decoded);
+			return NSERROR_INVALID;
+		}
+		outp += used;
+	}
+
+	*output = decoded;
+	*output_length = outp - decoded;
+
+	return NSERROR_OK;
+}
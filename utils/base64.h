@@ -0,0 +1,56 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Interface to fast base64 decoding.
+ *
+ * Unlike the character-at-a-time decoder in libnsutils this
+ * implementation consumes aligned groups of four input characters
+ * with per-position lookup tables so the hot loop is branch free.
+ * Intended for large inputs such as base64 encoded data: URLs.
+ */
+
+#ifndef NETSURF_UTILS_BASE64_H_
+#define NETSURF_UTILS_BASE64_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "utils/errors.h"
+
+/**
+ * Decode a base64 encoded buffer into a newly allocated buffer.
+ *
+ * Embedded ASCII whitespace is skipped and decoding stops at the
+ * first padding character.  The output buffer is allocated with
+ * malloc and ownership is passed to the caller.
+ *
+ * \param input The encoded input data.
+ * \param input_length The length of the encoded input.
+ * \param output Updated to the allocated decoded data on success.
+ * \param output_length Updated to the decoded length on success.
+ * \return NSERROR_OK on success, NSERROR_NOMEM on allocation failure
+ *         or NSERROR_INVALID if the input is not valid base64.
+ */
+nserror base64_decode_alloc(const uint8_t *input,
+			    size_t input_length,
+			    uint8_t **output,
+			    size_t *output_length);
+
+#endif
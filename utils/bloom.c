@@ -53,18 +53,31 @@ static inline uint32_t fnv(const char *datum, size_t len)
 struct bloom_filter {
 	size_t size;
 	uint32_t items;
+	bool counting;	/**< 4-bit counters instead of single bits */
 	uint8_t filter[FLEX_ARRAY_LEN_DECL];
 };
 
 struct bloom_filter *bloom_create(size_t size)
 {
 	struct bloom_filter *r = calloc(sizeof(*r) + size, 1);
-        
+
 	if (r == NULL)
 		return NULL;
-        
+
 	r->size = size;
-        
+
+	return r;
+}
+
+struct bloom_filter *bloom_create_counting(size_t size)
+{
+	struct bloom_filter *r = bloom_create(size);
+
+	if (r == NULL)
+		return NULL;
+
+	r->counting = true;
+
 	return r;
 }
 
@@ -81,14 +94,57 @@ void bloom_insert_str(struct bloom_filter *b, const char *s, size_t z)
 
 void bloom_insert_hash(struct bloom_filter *b, uint32_t hash)
 {
-	unsigned int index = hash % (b->size << 3);
-	unsigned int byte_index = index >> 3;
-	unsigned int bit_index = index & 7;
-
-	b->filter[byte_index] |= (1 << bit_index);
+	if (b->counting) {
+		unsigned int index = hash % (b->size << 1);
+		unsigned int byte_index = index >> 1;
+		unsigned int shift = (index & 1) << 2;
+		uint8_t count = (b->filter[byte_index] >> shift) & 0xf;
+
+		/* a saturated counter is never changed again, so the
+		 * filter can only over-report, never under-report */
+		if (count < 0xf) {
+			b->filter[byte_index] += (1 << shift);
+		}
+	} else {
+		unsigned int index = hash % (b->size << 3);
+		unsigned int byte_index = index >> 3;
+		unsigned int bit_index = index & 7;
+
+		b->filter[byte_index] |= (1 << bit_index);
+	}
 	b->items++;
 }
 
+void bloom_remove_str(struct bloom_filter *b, const char *s, size_t z)
+{
+	uint32_t hash = fnv(s, z);
+	bloom_remove_hash(b, hash);
+}
+
+void bloom_remove_hash(struct bloom_filter *b, uint32_t hash)
+{
+	unsigned int index, byte_index, shift;
+	uint8_t count;
+
+	if (b->counting == false) {
+		/* plain filters cannot forget */
+		return;
+	}
+
+	index = hash % (b->size << 1);
+	byte_index = index >> 1;
+	shift = (index & 1) << 2;
+	count = (b->filter[byte_index] >> shift) & 0xf;
+
+	/* zero counters were never set, saturated counters are stuck */
+	if ((count == 0) || (count == 0xf)) {
+		return;
+	}
+
+	b->filter[byte_index] -= (1 << shift);
+	b->items--;
+}
+
 bool bloom_search_str(struct bloom_filter *b, const char *s, size_t z)
 {
 	uint32_t hash = fnv(s, z);
@@ -97,11 +153,19 @@ bool bloom_search_str(struct bloom_filter *b, const char *s, size_t z)
 
 bool bloom_search_hash(struct bloom_filter *b, uint32_t hash)
 {
-	unsigned int index = hash % (b->size << 3);
-	unsigned int byte_index = index >> 3;
-	unsigned int bit_index = index & 7;
-	
-	return (b->filter[byte_index] & (1 << bit_index)) != 0;
+	if (b->counting) {
+		unsigned int index = hash % (b->size << 1);
+		unsigned int byte_index = index >> 1;
+		unsigned int shift = (index & 1) << 2;
+
+		return ((b->filter[byte_index] >> shift) & 0xf) != 0;
+	} else {
+		unsigned int index = hash % (b->size << 3);
+		unsigned int byte_index = index >> 3;
+		unsigned int bit_index = index & 7;
+
+		return (b->filter[byte_index] & (1 << bit_index)) != 0;
+	}
 }
 
 uint32_t bloom_items(struct bloom_filter *b)
@@ -36,9 +36,23 @@ struct bloom_filter;
  */
 struct bloom_filter *bloom_create(size_t size);
 
+/**
+ * Create a new counting bloom filter.
+ *
+ * A counting filter keeps a 4-bit saturating counter per slot instead
+ * of a single bit, so entries can be removed again with
+ * bloom_remove_str() / bloom_remove_hash().  It holds two slots per
+ * byte rather than eight, so for a comparable false-positive rate it
+ * needs four times the storage of a plain filter.
+ *
+ * \param size Size of bloom filter in bytes
+ * \return Handle for newly-created bloom filter, or NULL
+ */
+struct bloom_filter *bloom_create_counting(size_t size);
+
 /**
  * Destroy a previously-created bloom filter
- * 
+ *
  * \param b Bloom filter to destroy
  */
 void bloom_destroy(struct bloom_filter *b);
@@ -62,6 +76,27 @@ void bloom_insert_str(struct bloom_filter *b, const char *s, size_t z);
  */
 void bloom_insert_hash(struct bloom_filter *b, uint32_t hash);
 
+/**
+ * Remove a string of given length from a counting filter, assuming it
+ * was previously added.  Removing an entry that was never inserted may
+ * corrupt the filter.  Has no effect on a plain filter.
+ *
+ * \param b Counting bloom filter to remove from
+ * \param s Pointer to data
+ * \param z Length of data
+ */
+void bloom_remove_str(struct bloom_filter *b, const char *s, size_t z);
+
+/**
+ * Remove a given hash value from a counting filter, assuming it was
+ * previously added.  Removing an entry that was never inserted may
+ * corrupt the filter.  Has no effect on a plain filter.
+ *
+ * \param b Counting bloom filter to remove from
+ * \param hash Value to remove
+ */
+void bloom_remove_hash(struct bloom_filter *b, uint32_t hash);
+
 /**
  * Search the filter for the given string, assuming it was added by
  * bloom_insert_str().   May return false-positives.
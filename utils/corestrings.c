@@ -21,6 +21,8 @@
  * Useful interned string tables implementation.
  */
 
+#include <stdint.h>
+
 #include <dom/dom.h>
 
 #include "utils/corestrings.h"
@@ -28,47 +30,117 @@
 #include "utils/utils.h"
 
 /* define corestrings */
-#define CORESTRING_LWC_VALUE(NAME,VALUE) lwc_string *corestring_lwc_##NAME
-#define CORESTRING_DOM_VALUE(NAME,VALUE) dom_string *corestring_dom_##NAME
-#define CORESTRING_NSURL(NAME,VALUE) nsurl *corestring_nsurl_##NAME
+#define CORESTRING_LWC_VALUE(NAME,VALUE) lwc_string *corestring_lwc_##NAME;
+#define CORESTRING_DOM_VALUE(NAME,VALUE) dom_string *corestring_dom_##NAME;
+#define CORESTRING_NSURL(NAME,VALUE) nsurl *corestring_nsurl_##NAME;
 #include "utils/corestringlist.h"
 #undef CORESTRING_LWC_VALUE
 #undef CORESTRING_DOM_VALUE
 #undef CORESTRING_NSURL
 
-/* exported interface documented in utils/corestrings.h */
-nserror corestrings_fini(void)
-{
-#define CORESTRING_LWC_VALUE(NAME,VALUE)				\
-	do {								\
-		if (corestring_lwc_##NAME != NULL) {			\
-			lwc_string_unref(corestring_lwc_##NAME);	\
-			corestring_lwc_##NAME = NULL;			\
-		}							\
-	} while (0)
-
-#define CORESTRING_DOM_VALUE(NAME,VALUE)				\
-	do {								\
-		if (corestring_dom_##NAME != NULL) {			\
-			dom_string_unref(corestring_dom_##NAME);	\
-			corestring_dom_##NAME = NULL;			\
-		}							\
-	} while (0)
-
-#define CORESTRING_NSURL(NAME,VALUE)					\
-	do {								\
-		if (corestring_nsurl_##NAME != NULL) {			\
-			nsurl_unref(corestring_nsurl_##NAME);		\
-			corestring_nsurl_##NAME = NULL;			\
-		}							\
-	} while (0)
+/**
+ * Table entry for a lwc core string.
+ */
+struct corestring_lwc_entry {
+	lwc_string **str;	/**< The exported string global */
+	const char *value;	/**< String data */
+	uint16_t value_len;	/**< Length of value, in bytes */
+};
 
+/**
+ * Table entry for a dom core string.
+ */
+struct corestring_dom_entry {
+	dom_string **str;	/**< The exported string global */
+	const char *value;	/**< String data */
+	uint16_t value_len;	/**< Length of value, in bytes */
+};
+
+/**
+ * Table entry for a core URL.
+ */
+struct corestring_nsurl_entry {
+	nsurl **url;		/**< The exported URL global */
+	const char *value;	/**< URL string data */
+};
 
+/**
+ * Compile-time generated table of the lwc core strings.
+ *
+ * Building the whole set as one read-only table keeps the string data
+ * and lengths together in memory and lets init and fini iterate
+ * instead of expanding code per string.
+ */
+static const struct corestring_lwc_entry corestring_lwc_entries[] = {
+#define CORESTRING_LWC_VALUE(NAME,VALUE) \
+	{ &corestring_lwc_##NAME, VALUE, SLEN(VALUE) },
+#define CORESTRING_DOM_VALUE(NAME,VALUE)
+#define CORESTRING_NSURL(NAME,VALUE)
 #include "utils/corestringlist.h"
+#undef CORESTRING_LWC_VALUE
+#undef CORESTRING_DOM_VALUE
+#undef CORESTRING_NSURL
+};
 
+/**
+ * Compile-time generated table of the dom core strings.
+ */
+static const struct corestring_dom_entry corestring_dom_entries[] = {
+#define CORESTRING_LWC_VALUE(NAME,VALUE)
+#define CORESTRING_DOM_VALUE(NAME,VALUE) \
+	{ &corestring_dom_##NAME, VALUE, SLEN(VALUE) },
+#define CORESTRING_NSURL(NAME,VALUE)
+#include "utils/corestringlist.h"
 #undef CORESTRING_LWC_VALUE
 #undef CORESTRING_DOM_VALUE
 #undef CORESTRING_NSURL
+};
+
+/**
+ * Compile-time generated table of the core URLs.
+ */
+static const struct corestring_nsurl_entry corestring_nsurl_entries[] = {
+#define CORESTRING_LWC_VALUE(NAME,VALUE)
+#define CORESTRING_DOM_VALUE(NAME,VALUE)
+#define CORESTRING_NSURL(NAME,VALUE) \
+	{ &corestring_nsurl_##NAME, VALUE },
+#include "utils/corestringlist.h"
+#undef CORESTRING_LWC_VALUE
+#undef CORESTRING_DOM_VALUE
+#undef CORESTRING_NSURL
+};
+
+/* exported interface documented in utils/corestrings.h */
+nserror corestrings_fini(void)
+{
+	size_t i;
+
+	for (i = 0; i < NOF_ELEMENTS(corestring_lwc_entries); i++) {
+		lwc_string **str = corestring_lwc_entries[i].str;
+
+		if (*str != NULL) {
+			lwc_string_unref(*str);
+			*str = NULL;
+		}
+	}
+
+	for (i = 0; i < NOF_ELEMENTS(corestring_dom_entries); i++) {
+		dom_string **str = corestring_dom_entries[i].str;
+
+		if (*str != NULL) {
+			dom_string_unref(*str);
+			*str = NULL;
+		}
+	}
+
+	for (i = 0; i < NOF_ELEMENTS(corestring_nsurl_entries); i++) {
+		nsurl **url = corestring_nsurl_entries[i].url;
+
+		if (*url != NULL) {
+			nsurl_unref(*url);
+			*url = NULL;
+		}
+	}
 
 	return NSERROR_OK;
 }
@@ -77,50 +149,42 @@ nserror corestrings_fini(void)
 /* exported interface documented in utils/corestrings.h */
 nserror corestrings_init(void)
 {
-	lwc_error lerror;
 	nserror error;
-	dom_exception exc;
-
-#define CORESTRING_LWC_VALUE(NAME,VALUE)				\
-	do {								\
-		lerror = lwc_intern_string(				\
-			(const char *)VALUE,				\
-			sizeof(VALUE) - 1,				\
-			&corestring_lwc_##NAME );			\
-		if ((lerror != lwc_error_ok) ||				\
-		    (corestring_lwc_##NAME == NULL)) {			\
-			error = NSERROR_NOMEM;				\
-			goto error;					\
-		}							\
-	} while(0)
-
-#define CORESTRING_DOM_VALUE(NAME,VALUE)				\
-	do {								\
-		exc = dom_string_create_interned(			\
-				(const uint8_t *)VALUE,			\
-				sizeof(VALUE) - 1,			\
-				&corestring_dom_##NAME );		\
-		if ((exc != DOM_NO_ERR) ||				\
-				(corestring_dom_##NAME == NULL)) {	\
-			error = NSERROR_NOMEM;				\
-			goto error;					\
-		}							\
-	} while(0)
-
-#define CORESTRING_NSURL(NAME,VALUE)					\
-	do {								\
-		error = nsurl_create(VALUE,				\
-				     &corestring_nsurl_##NAME);		\
-		if (error != NSERROR_OK) {				\
-			goto error;					\
-		}							\
-	} while(0)
-
-#include "utils/corestringlist.h"
-
-#undef CORESTRING_LWC_VALUE
-#undef CORESTRING_DOM_VALUE
-#undef CORESTRING_NSURL
+	size_t i;
+
+	for (i = 0; i < NOF_ELEMENTS(corestring_lwc_entries); i++) {
+		const struct corestring_lwc_entry *e = &corestring_lwc_entries[i];
+		lwc_error lerror;
+
+		lerror = lwc_intern_string(e->value, e->value_len, e->str);
+		if ((lerror != lwc_error_ok) || (*e->str == NULL)) {
+			error = NSERROR_NOMEM;
+			goto error;
+		}
+	}
+
+	for (i = 0; i < NOF_ELEMENTS(corestring_dom_entries); i++) {
+		const struct corestring_dom_entry *e = &corestring_dom_entries[i];
+		dom_exception exc;
+
+		exc = dom_string_create_interned(
+				(const uint8_t *)e->value,
+				e->value_len, e->str);
+		if ((exc != DOM_NO_ERR) || (*e->str == NULL)) {
+			error = NSERROR_NOMEM;
+			goto error;
+		}
+	}
+
+	for (i = 0; i < NOF_ELEMENTS(corestring_nsurl_entries); i++) {
+		const struct corestring_nsurl_entry *e =
+				&corestring_nsurl_entries[i];
+
+		error = nsurl_create(e->value, e->url);
+		if (error != NSERROR_OK) {
+			goto error;
+		}
+	}
 
 	return NSERROR_OK;
 
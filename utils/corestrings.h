@@ -50,11 +50,11 @@ struct dom_string;
 
 /* declare corestrings */
 #define CORESTRING_LWC_VALUE(NAME,VALUE)		\
-	extern lwc_string *corestring_lwc_##NAME
+	extern lwc_string *corestring_lwc_##NAME;
 #define CORESTRING_DOM_VALUE(NAME,VALUE)		\
-	extern struct dom_string *corestring_dom_##NAME
+	extern struct dom_string *corestring_dom_##NAME;
 #define CORESTRING_NSURL(NAME,VALUE) \
-	extern struct nsurl *corestring_nsurl_##NAME
+	extern struct nsurl *corestring_nsurl_##NAME;
 #include "utils/corestringlist.h"
 #undef CORESTRING_LWC_VALUE
 #undef CORESTRING_DOM_VALUE
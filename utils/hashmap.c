@@ -22,19 +22,33 @@
 #include "utils/hashmap.h"
 
 /**
- * The default number of buckets in the hashmaps we create.
+ * The initial capacity of the hashmaps we create.
+ *
+ * Must be a power of two, so that hashes can be reduced to slot
+ * indices by masking.
+ */
+#define DEFAULT_HASHMAP_CAPACITY (64)
+
+/**
+ * Whether an entry count overloads a table of the given capacity.
+ *
+ * We aim to keep the table at three quarters full or less.
  */
-#define DEFAULT_HASHMAP_BUCKETS (4091)
+#define HASHMAP_OVERLOADED(entries, capacity) \
+	(((entries) * 4) > ((capacity) * 3))
 
 /**
- * Hashmaps have chains of entries in buckets.
+ * Hashmap slot.
+ *
+ * Entries are stored in a flat open-addressed table using robin hood
+ * hashing; each occupied slot remembers its key's hash so that probe
+ * distances can be recomputed and keys rarely need comparing.
  */
-typedef struct hashmap_entry_s {
-	struct hashmap_entry_s **prevptr;
-	struct hashmap_entry_s *next;
+typedef struct {
 	void *key;
 	void *value;
 	uint32_t key_hash;
+	bool occupied;
 } hashmap_entry_t;
 
 /**
@@ -45,16 +59,16 @@ struct hashmap_s {
 	 * The parameters to be used for this hashmap
 	 */
 	hashmap_parameters_t *params;
-	
+
 	/**
-	 * The buckets for the hash chains
+	 * The table of entry slots
 	 */
-	hashmap_entry_t **buckets;
-	
+	hashmap_entry_t *entries;
+
 	/**
-	 * The number of buckets in this map
+	 * The number of slots in this map, always a power of two
 	 */
-	uint32_t bucket_count;
+	uint32_t capacity;
 
 	/**
 	 * The number of entries in this map
@@ -62,6 +76,125 @@ struct hashmap_s {
 	size_t entry_count;
 };
 
+/**
+ * Compute an occupied slot's distance from its preferred slot.
+ *
+ * \param hashmap The hashmap the slot belongs to
+ * \param slot The slot index
+ * \return The probe distance of the entry in that slot
+ */
+static inline uint32_t
+hashmap__probe_distance(hashmap_t *hashmap, uint32_t slot)
+{
+	uint32_t mask = hashmap->capacity - 1;
+	return (slot + hashmap->capacity -
+		(hashmap->entries[slot].key_hash & mask)) & mask;
+}
+
+/**
+ * Place an entry into the table, displacing richer entries as needed.
+ *
+ * The table must have at least one free slot.  Ownership of the key
+ * and value in \a new_entry passes to the table.
+ *
+ * \param hashmap The hashmap to place the entry into
+ * \param new_entry The entry to place, with key, value, and hash set
+ */
+static void
+hashmap__place_entry(hashmap_t *hashmap, hashmap_entry_t *new_entry)
+{
+	uint32_t mask = hashmap->capacity - 1;
+	uint32_t slot = new_entry->key_hash & mask;
+	uint32_t distance = 0;
+	hashmap_entry_t entry = *new_entry;
+
+	while (hashmap->entries[slot].occupied) {
+		uint32_t their_distance =
+			hashmap__probe_distance(hashmap, slot);
+		if (their_distance < distance) {
+			/* Rob the rich: swap with the closer-to-home
+			 * entry and continue placing that one */
+			hashmap_entry_t temp = hashmap->entries[slot];
+			hashmap->entries[slot] = entry;
+			entry = temp;
+			distance = their_distance;
+		}
+		slot = (slot + 1) & mask;
+		distance++;
+	}
+
+	entry.occupied = true;
+	hashmap->entries[slot] = entry;
+}
+
+/**
+ * Find the slot holding the given key, if present.
+ *
+ * \param hashmap The hashmap to search
+ * \param key The key to search for
+ * \param slot_out Updated to the slot index when found
+ * \return true if the key was found
+ */
+static bool
+hashmap__find_slot(hashmap_t *hashmap, void *key, uint32_t *slot_out)
+{
+	uint32_t hash = hashmap->params->key_hash(key);
+	uint32_t mask = hashmap->capacity - 1;
+	uint32_t slot = hash & mask;
+	uint32_t distance = 0;
+
+	while (hashmap->entries[slot].occupied) {
+		if (hashmap__probe_distance(hashmap, slot) < distance) {
+			/* A richer entry sits here; had our key been
+			 * inserted it would have displaced it */
+			break;
+		}
+		if (hashmap->entries[slot].key_hash == hash &&
+		    hashmap->params->key_eq(key, hashmap->entries[slot].key)) {
+			*slot_out = slot;
+			return true;
+		}
+		slot = (slot + 1) & mask;
+		distance++;
+	}
+
+	return false;
+}
+
+/**
+ * Rehash the map into a table of the given capacity.
+ *
+ * On allocation failure the map is left unchanged.
+ *
+ * \param hashmap The hashmap to rehash
+ * \param new_capacity The new slot count, a power of two
+ * \return true on success, false on allocation failure
+ */
+static bool
+hashmap__rehash(hashmap_t *hashmap, uint32_t new_capacity)
+{
+	hashmap_entry_t *old_entries = hashmap->entries;
+	uint32_t old_capacity = hashmap->capacity;
+	uint32_t slot;
+
+	hashmap->entries = calloc(new_capacity, sizeof(hashmap_entry_t));
+	if (hashmap->entries == NULL) {
+		hashmap->entries = old_entries;
+		return false;
+	}
+	hashmap->capacity = new_capacity;
+
+	for (slot = 0; slot < old_capacity; slot++) {
+		if (old_entries[slot].occupied) {
+			hashmap__place_entry(hashmap, &old_entries[slot]);
+		}
+	}
+
+	free(old_entries);
+
+	return true;
+}
+
 /* Exported function, documented in hashmap.h */
 hashmap_t *
 hashmap_create(hashmap_parameters_t *params)
@@ -72,17 +205,15 @@ hashmap_create(hashmap_parameters_t *params)
 	}
 
 	ret->params = params;
-	ret->bucket_count = DEFAULT_HASHMAP_BUCKETS;
+	ret->capacity = DEFAULT_HASHMAP_CAPACITY;
 	ret->entry_count = 0;
-	ret->buckets = malloc(ret->bucket_count * sizeof(hashmap_entry_t *));
+	ret->entries = calloc(ret->capacity, sizeof(hashmap_entry_t));
 
-	if (ret->buckets == NULL) {
+	if (ret->entries == NULL) {
 		free(ret);
 		return NULL;
 	}
 
-	memset(ret->buckets, 0, ret->bucket_count * sizeof(hashmap_entry_t *));
-
 	return ret;
 }
 
@@ -90,21 +221,18 @@ hashmap_create(hashmap_parameters_t *params)
 void
 hashmap_destroy(hashmap_t *hashmap)
 {
-	uint32_t bucket;
-	hashmap_entry_t *entry;
-
-	for (bucket = 0; bucket < hashmap->bucket_count; bucket++) {
-		for (entry = hashmap->buckets[bucket];
-		     entry != NULL;) {
-			hashmap_entry_t *next = entry->next;
-			hashmap->params->value_destroy(entry->value);
-			hashmap->params->key_destroy(entry->key);
-			free(entry);
-			entry = next;
+	uint32_t slot;
+
+	for (slot = 0; slot < hashmap->capacity; slot++) {
+		if (hashmap->entries[slot].occupied) {
+			hashmap->params->value_destroy(
+				hashmap->entries[slot].value);
+			hashmap->params->key_destroy(
+				hashmap->entries[slot].key);
 		}
 	}
 
-	free(hashmap->buckets);
+	free(hashmap->entries);
 	free(hashmap);
 }
 
@@ -112,15 +240,10 @@ hashmap_destroy(hashmap_t *hashmap)
 void *
 hashmap_lookup(hashmap_t *hashmap, void *key)
 {
-	uint32_t hash = hashmap->params->key_hash(key);
-	hashmap_entry_t *entry = hashmap->buckets[hash % hashmap->bucket_count];
+	uint32_t slot;
 
-	for(;entry != NULL; entry = entry->next) {
-		if (entry->key_hash == hash) {
-			if (hashmap->params->key_eq(key, entry->key)) {
-				return entry->value;
-			}
-		}
+	if (hashmap__find_slot(hashmap, key, &slot)) {
+		return hashmap->entries[slot].value;
 	}
 
 	return NULL;
@@ -130,118 +253,118 @@ hashmap_lookup(hashmap_t *hashmap, void *key)
 void *
 hashmap_insert(hashmap_t *hashmap, void *key)
 {
-	uint32_t hash = hashmap->params->key_hash(key);
-	uint32_t bucket = hash % hashmap->bucket_count;
-	hashmap_entry_t *entry = hashmap->buckets[bucket];
+	hashmap_entry_t entry;
+	uint32_t slot;
 	void *new_key, *new_value;
 
-	for(;entry != NULL; entry = entry->next) {
-		if (entry->key_hash == hash) {
-			if (hashmap->params->key_eq(key, entry->key)) {
-				/* This key is already here */
-				new_key = hashmap->params->key_clone(key);
-				if (new_key == NULL) {
-					/* Allocation failed */
-					return NULL;
-				}
-				new_value = hashmap->params->value_alloc(entry->key);
-				if (new_value == NULL) {
-					/* Allocation failed */
-					hashmap->params->key_destroy(new_key);
-					return NULL;
-				}
-				hashmap->params->value_destroy(entry->value);
-				hashmap->params->key_destroy(entry->key);
-				entry->value = new_value;
-				entry->key = new_key;
-				return entry->value;
-			}
+	if (hashmap__find_slot(hashmap, key, &slot)) {
+		/* This key is already here */
+		new_key = hashmap->params->key_clone(key);
+		if (new_key == NULL) {
+			/* Allocation failed */
+			return NULL;
+		}
+		new_value = hashmap->params->value_alloc(
+			hashmap->entries[slot].key);
+		if (new_value == NULL) {
+			/* Allocation failed */
+			hashmap->params->key_destroy(new_key);
+			return NULL;
 		}
+		hashmap->params->value_destroy(hashmap->entries[slot].value);
+		hashmap->params->key_destroy(hashmap->entries[slot].key);
+		hashmap->entries[slot].value = new_value;
+		hashmap->entries[slot].key = new_key;
+		return hashmap->entries[slot].value;
 	}
 
-	/* The key was not found in the map, so allocate a new entry */
-	entry = malloc(sizeof(*entry));
+	/* The key was not found in the map, so insert a new entry */
+	if (HASHMAP_OVERLOADED(hashmap->entry_count + 1, hashmap->capacity)) {
+		/* Growth failure is tolerable so long as a free slot
+		 * remains; the table just probes a little further */
+		if (!hashmap__rehash(hashmap, hashmap->capacity * 2) &&
+		    hashmap->entry_count + 1 == hashmap->capacity) {
+			return NULL;
+		}
+	}
 
-	if (entry == NULL) {
+	entry.key = hashmap->params->key_clone(key);
+	if (entry.key == NULL) {
 		return NULL;
 	}
-	
-	memset(entry, 0, sizeof(*entry));
+	entry.key_hash = hashmap->params->key_hash(key);
 
-	entry->key = hashmap->params->key_clone(key);
-	if (entry->key == NULL) {
-		goto err;
+	entry.value = hashmap->params->value_alloc(entry.key);
+	if (entry.value == NULL) {
+		hashmap->params->key_destroy(entry.key);
+		return NULL;
 	}
-	entry->key_hash = hash;
 
-	entry->value = hashmap->params->value_alloc(entry->key);
-	if (entry->value == NULL) {
-		goto err;
-	}
+	hashmap__place_entry(hashmap, &entry);
 
-	entry->prevptr = &(hashmap->buckets[bucket]);
-	entry->next = hashmap->buckets[bucket];
-	if (entry->next != NULL) {
-		entry->next->prevptr = &entry->next;
-	}
+	hashmap->entry_count++;
 
-	hashmap->buckets[bucket] = entry;
+	return entry.value;
+}
 
-	hashmap->entry_count++;
+/* Exported function, documented in hashmap.h */
+bool
+hashmap_remove(hashmap_t *hashmap, void *key)
+{
+	uint32_t mask = hashmap->capacity - 1;
+	uint32_t slot, next;
 
-	return entry->value;
+	if (!hashmap__find_slot(hashmap, key, &slot)) {
+		return false;
+	}
 
-err:
-	if (entry->value != NULL)
-		hashmap->params->value_destroy(entry->value);
-	if (entry->key != NULL)
-		hashmap->params->key_destroy(entry->key);
-	free(entry);
+	hashmap->params->value_destroy(hashmap->entries[slot].value);
+	hashmap->params->key_destroy(hashmap->entries[slot].key);
+
+	/* Shift any displaced followers back towards their preferred
+	 * slots, so no tombstones are needed */
+	next = (slot + 1) & mask;
+	while (hashmap->entries[next].occupied &&
+	       hashmap__probe_distance(hashmap, next) != 0) {
+		hashmap->entries[slot] = hashmap->entries[next];
+		slot = next;
+		next = (next + 1) & mask;
+	}
 
-	return NULL;
+	memset(&hashmap->entries[slot], 0, sizeof(hashmap_entry_t));
+	hashmap->entry_count--;
+
+	return true;
 }
 
 /* Exported function, documented in hashmap.h */
 bool
-hashmap_remove(hashmap_t *hashmap, void *key)
+hashmap_reserve(hashmap_t *hashmap, size_t entries)
 {
-	uint32_t hash = hashmap->params->key_hash(key);
-	
-	hashmap_entry_t *entry = hashmap->buckets[hash % hashmap->bucket_count];
-
-	for(;entry != NULL; entry = entry->next) {
-		if (entry->key_hash == hash) {
-			if (hashmap->params->key_eq(key, entry->key)) {
-				hashmap->params->value_destroy(entry->value);
-				hashmap->params->key_destroy(entry->key);
-				if (entry->next != NULL) {
-					entry->next->prevptr = entry->prevptr;
-				}
-				*entry->prevptr = entry->next;
-				free(entry);
-				hashmap->entry_count--;
-				return true;
-			}
-		}
+	uint32_t new_capacity = hashmap->capacity;
+
+	while (HASHMAP_OVERLOADED(entries, new_capacity)) {
+		new_capacity *= 2;
 	}
 
-	return false;
+	if (new_capacity == hashmap->capacity) {
+		return true;
+	}
+
+	return hashmap__rehash(hashmap, new_capacity);
 }
 
 /* Exported function, documented in hashmap.h */
 bool
 hashmap_iterate(hashmap_t *hashmap, hashmap_iteration_cb_t cb, void *ctx)
 {
-	for (uint32_t bucket = 0;
-	     bucket < hashmap->bucket_count;
-	     bucket++) {
-		for (hashmap_entry_t *entry = hashmap->buckets[bucket];
-		     entry != NULL;
-		     entry = entry->next) {
-			/* If the callback returns true, we early-exit */
-			if (cb(entry->key, entry->value, ctx))
-				return true;
-		}
+	for (uint32_t slot = 0; slot < hashmap->capacity; slot++) {
+		if (!hashmap->entries[slot].occupied)
+			continue;
+		/* If the callback returns true, we early-exit */
+		if (cb(hashmap->entries[slot].key,
+		       hashmap->entries[slot].value, ctx))
+			return true;
 	}
 
 	return false;
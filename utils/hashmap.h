@@ -173,6 +173,20 @@ void *hashmap_insert(hashmap_t *hashmap, void *key);
  */
 bool hashmap_remove(hashmap_t *hashmap, void *key);
 
+/**
+ * Reserve space in the hashmap for a number of entries
+ *
+ * This grows the hashmap's table, if necessary, so that at least the
+ * given number of entries can be stored without any further internal
+ * allocation.  Useful before bulk-loading a map of known size, such as
+ * when reading an index from disc.  The map never shrinks.
+ *
+ * \param hashmap The hashmap to reserve space in
+ * \param entries The number of entries to reserve space for
+ * \return true on success, false on allocation failure
+ */
+bool hashmap_reserve(hashmap_t *hashmap, size_t entries);
+
 /**
  * Iterate the hashmap
  *
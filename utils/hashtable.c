@@ -35,6 +35,15 @@
 #include <zlib.h>
 #include <errno.h>
 
+#include "utils/config.h"
+
+#ifdef WITH_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "utils/log.h"
 #include "utils/hashtable.h"
 
@@ -42,17 +51,84 @@
 struct hash_entry {
 	char *pairing;		 /**< block containing 'key\0value\0' */
 	unsigned int key_length; /**< length of key */
+	unsigned int hash;	 /**< full hash of key, kept so rehashing
+				  * need not walk the key again */
 	struct hash_entry *next; /**< next entry */
 };
 
+/** number of entries in each slab of entries */
+#define ENTRY_SLAB_SIZE 64
+
+/**
+ * Slab of hash entries.
+ *
+ * The table is write-once, so entries are carved sequentially out of
+ * slabs rather than malloc'd individually, and freed all at once when
+ * the table is destroyed.
+ */
+struct hash_slab {
+	struct hash_slab *next;	/**< next slab in the table's slab list */
+	struct hash_entry entries[ENTRY_SLAB_SIZE];
+};
+
+/** default amount of key/value string storage in each arena block */
+#define ARENA_BLOCK_SIZE 8192
+
+/**
+ * Block of key/value pairing storage.
+ *
+ * The string data follows the block header directly.
+ */
+struct hash_arena_block {
+	struct hash_arena_block *next;	/**< next block in the arena */
+	size_t size;			/**< total string storage in block */
+	size_t used;			/**< string storage already used */
+};
+
+#ifdef WITH_MMAP
+/** Index entry locating one key/value line in a mapped catalog. */
+struct hash_catalog_entry {
+	uint32_t hash;		/**< full hash of the entry's key */
+	uint32_t offset;	/**< offset of the key in the mapping */
+};
+
+/**
+ * A memory mapped lazy catalog backing a hash table.
+ *
+ * Uncompressed key/value files are mapped rather than parsed up
+ * front: attaching one builds only a compact index of key hashes and
+ * offsets, and an entry is copied into the table the first time it is
+ * looked up.  Load time and steady state memory then scale with the
+ * keys actually used rather than with the size of the file.
+ */
+struct hash_catalog {
+	char *data;		/**< the mapped file */
+	size_t size;		/**< length of the mapping */
+	struct hash_catalog_entry *index; /**< index, sorted by hash */
+	size_t count;		/**< number of index entries */
+};
+#endif
+
 struct hash_table {
 	unsigned int nchains;
+	unsigned int nentries;
 	struct hash_entry **chain;
+	struct hash_slab *slabs;	/**< entry slabs, newest first */
+	unsigned int slab_used;		/**< entries used in newest slab */
+	struct hash_arena_block *arena;	/**< pairing blocks, newest first */
+#ifdef WITH_MMAP
+	struct hash_catalog *catalog;	/**< lazy backing catalog or NULL */
+#endif
 };
 
 /** maximum length of line for file or inline add */
 #define LINE_BUFFER_SIZE 512
 
+/** Fowler Noll Vo hash offset basis */
+#define FNV_OFFSET_BASIS 0x811c9dc5
+/** Fowler Noll Vo hash prime */
+#define FNV_PRIME 0x01000193
+
 /**
  * Hash a string, returning a 32bit value.  The hash algorithm used is
  * Fowler Noll Vo - a very fast and simple hash, ideal for short strings.
@@ -64,7 +140,7 @@ struct hash_table {
  */
 static inline unsigned int hash_string_fnv(const char *datum, unsigned int *len)
 {
-	unsigned int z = 0x811c9dc5;
+	unsigned int z = FNV_OFFSET_BASIS;
 	const char *start = datum;
 	*len = 0;
 
@@ -72,7 +148,7 @@ static inline unsigned int hash_string_fnv(const char *datum, unsigned int *len)
 		return 0;
 
 	while (*datum) {
-		z *= 0x01000193;
+		z *= FNV_PRIME;
 		z ^= *datum++;
 	}
 	*len = datum - start;
@@ -81,6 +157,164 @@ static inline unsigned int hash_string_fnv(const char *datum, unsigned int *len)
 }
 
 
+/**
+ * Allocate an entry from the hash table's slabs.
+ *
+ * \param ht The hash table to allocate an entry for
+ * \return The new entry, or NULL on memory exhaustion
+ */
+static struct hash_entry *hash_alloc_entry(struct hash_table *ht)
+{
+	if ((ht->slabs == NULL) || (ht->slab_used == ENTRY_SLAB_SIZE)) {
+		struct hash_slab *slab = malloc(sizeof(*slab));
+		if (slab == NULL) {
+			return NULL;
+		}
+		slab->next = ht->slabs;
+		ht->slabs = slab;
+		ht->slab_used = 0;
+	}
+
+	return &ht->slabs->entries[ht->slab_used++];
+}
+
+
+/**
+ * Allocate pairing storage from the hash table's string arena.
+ *
+ * \param ht The hash table to allocate storage for
+ * \param length The number of bytes required
+ * \return Pointer to the storage, or NULL on memory exhaustion
+ */
+static char *hash_alloc_pairing(struct hash_table *ht, size_t length)
+{
+	struct hash_arena_block *block = ht->arena;
+	char *ret;
+
+	if ((block == NULL) || ((block->size - block->used) < length)) {
+		size_t bsize = ARENA_BLOCK_SIZE;
+		if (length > bsize) {
+			bsize = length;
+		}
+		block = malloc(sizeof(*block) + bsize);
+		if (block == NULL) {
+			return NULL;
+		}
+		block->size = bsize;
+		block->used = 0;
+		block->next = ht->arena;
+		ht->arena = block;
+	}
+
+	ret = (char *)(block + 1) + block->used;
+	block->used += length;
+
+	return ret;
+}
+
+
+/**
+ * Grow the chain array and redistribute the entries.
+ *
+ * On memory exhaustion the table is left at its current size; chains
+ * just get longer.
+ *
+ * \param ht The hash table to grow
+ */
+static void hash_grow(struct hash_table *ht)
+{
+	unsigned int new_nchains = (ht->nchains * 2) + 1;
+	struct hash_entry **new_chain;
+	struct hash_entry *e, *next;
+	unsigned int i, c;
+
+	new_chain = calloc(new_nchains, sizeof(struct hash_entry *));
+	if (new_chain == NULL) {
+		return;
+	}
+
+	for (i = 0; i < ht->nchains; i++) {
+		/* reverse the chain first, so pushing entries onto the
+		 * new chain heads preserves the precedence of repeated
+		 * keys */
+		struct hash_entry *rev = NULL;
+		for (e = ht->chain[i]; e != NULL; e = next) {
+			next = e->next;
+			e->next = rev;
+			rev = e;
+		}
+		for (e = rev; e != NULL; e = next) {
+			next = e->next;
+			c = e->hash % new_nchains;
+			e->next = new_chain[c];
+			new_chain[c] = e;
+		}
+	}
+
+	free(ht->chain);
+	ht->chain = new_chain;
+	ht->nchains = new_nchains;
+}
+
+
+/**
+ * Add a key/value pair whose hash and lengths are already known.
+ *
+ * This is the bulk-load path used when parsing Messages style data,
+ * where the key's hash is computed while scanning the line, so the
+ * strings need not be walked a second time.
+ *
+ * \param ht The hash table to add the pair to
+ * \param key The key, copied into the table's arena
+ * \param key_length Byte length of \a key
+ * \param hash The full hash of \a key
+ * \param value The value, copied into the table's arena
+ * \param value_length Byte length of \a value
+ * \return true if the add succeeded, false on memory exhaustion
+ */
+static bool
+hash_add_hashed(struct hash_table *ht,
+		const char *key, unsigned int key_length, unsigned int hash,
+		const char *value, unsigned int value_length)
+{
+	unsigned int c;
+	struct hash_entry *e;
+
+	if (ht->nentries >= (ht->nchains * 2)) {
+		hash_grow(ht);
+	}
+
+	e = hash_alloc_entry(ht);
+	if (e == NULL) {
+		NSLOG(netsurf, INFO, "Not enough memory for hash entry.");
+		return false;
+	}
+
+	e->pairing = hash_alloc_pairing(ht, key_length + value_length + 2);
+	if (e->pairing == NULL) {
+		NSLOG(netsurf, INFO,
+		      "Not enough memory for string duplication.");
+		ht->slab_used--; /* return the entry to the slab */
+		return false;
+	}
+	memcpy(e->pairing, key, key_length);
+	e->pairing[key_length] = 0;
+	memcpy(e->pairing + key_length + 1, value, value_length);
+	e->pairing[key_length + 1 + value_length] = 0;
+
+	e->key_length = key_length;
+	e->hash = hash;
+
+	c = hash % ht->nchains;
+	e->next = ht->chain[c];
+	ht->chain[c] = e;
+
+	ht->nentries++;
+
+	return true;
+}
+
+
 
 /**
  * process a line of input.
@@ -96,6 +330,7 @@ process_line(struct hash_table *hash, uint8_t *ln, int lnlen)
 	uint8_t *key;
 	uint8_t *value;
 	uint8_t *colon;
+	unsigned int z = FNV_OFFSET_BASIS;
 
 	key = ln; /* set key to start of line */
 	value = ln + lnlen; /* set value to end of line */
@@ -111,11 +346,14 @@ process_line(struct hash_table *hash, uint8_t *ln, int lnlen)
 		return NSERROR_OK;
 	}
 
-	/* find first colon as key/value separator */
+	/* find first colon as key/value separator, hashing the key as
+	 * we go so the table need not walk it again */
 	for (colon = key; colon < value; colon++) {
 		if (*colon == ':') {
 			break;
 		}
+		z *= FNV_PRIME;
+		z ^= *colon;
 	}
 	if (colon == value) {
 		/* no colon found */
@@ -125,7 +363,8 @@ process_line(struct hash_table *hash, uint8_t *ln, int lnlen)
 	*colon = 0;  /* terminate key */
 	value = colon + 1;
 
-	if (hash_add(hash, (char *)key, (char *)value) == false) {
+	if (hash_add_hashed(hash, (char *)key, colon - key, z,
+			    (char *)value, (ln + lnlen) - value) == false) {
 		NSLOG(netsurf, INFO,
 		      "Unable to add %s:%s to hash table", ln, value);
 		return NSERROR_INVALID;
@@ -250,6 +489,263 @@ hash_add_inline_gzip(struct hash_table *ht, const uint8_t *data, size_t size)
 }
 
 
+#ifdef WITH_MMAP
+/**
+ * Compare two catalog index entries for sorting.
+ *
+ * Orders by hash and then by offset so duplicate keys keep their file
+ * order and lookups can prefer the later, overriding, line.
+ *
+ * \param va The first entry
+ * \param vb The second entry
+ * \return negative, zero or positive for the usual sort semantics
+ */
+static int hash_catalog_cmp(const void *va, const void *vb)
+{
+	const struct hash_catalog_entry *a = va;
+	const struct hash_catalog_entry *b = vb;
+
+	if (a->hash != b->hash) {
+		return (a->hash < b->hash) ? -1 : 1;
+	}
+	if (a->offset != b->offset) {
+		return (a->offset < b->offset) ? -1 : 1;
+	}
+	return 0;
+}
+
+
+/**
+ * Look a key up in a table's backing catalog, materialising it.
+ *
+ * On a match the key/value pair is added to the table proper, so the
+ * catalog is only ever consulted once per key.
+ *
+ * \param ht The hash table the catalog backs
+ * \param key The key to search for
+ * \param h The full hash of \a key
+ * \param key_length The length of \a key
+ * \return The value associated with the key, or NULL if not found
+ */
+static const char *
+hash_catalog_get(struct hash_table *ht,
+		 const char *key,
+		 unsigned int h,
+		 unsigned int key_length)
+{
+	struct hash_catalog *cat = ht->catalog;
+	size_t lo, hi;
+	size_t best = SIZE_MAX;
+	const char *value;
+	const char *vend;
+
+	if (cat == NULL) {
+		return NULL;
+	}
+
+	/* lower bound of the hash in the sorted index */
+	lo = 0;
+	hi = cat->count;
+	while (lo < hi) {
+		size_t mid = lo + ((hi - lo) / 2);
+		if (cat->index[mid].hash < h) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	/* among the entries with this hash take the last line whose
+	 * key really matches, as later lines override earlier ones */
+	for (; lo < cat->count && cat->index[lo].hash == h; lo++) {
+		size_t off = cat->index[lo].offset;
+
+		if (off + key_length + 1 > cat->size) {
+			continue;
+		}
+		if ((memcmp(cat->data + off, key, key_length) == 0) &&
+		    (cat->data[off + key_length] == ':')) {
+			best = off;
+		}
+	}
+
+	if (best == SIZE_MAX) {
+		return NULL;
+	}
+
+	value = cat->data + best + key_length + 1;
+	vend = memchr(value, '\n', cat->size - (best + key_length + 1));
+	if (vend == NULL) {
+		vend = cat->data + cat->size;
+	}
+
+	if (hash_add_hashed(ht, key, key_length, h,
+			    value, vend - value) == false) {
+		return NULL;
+	}
+
+	/* hash_add_hashed inserts at the head of the key's chain */
+	return ht->chain[h % ht->nchains]->pairing + key_length + 1;
+}
+
+
+/**
+ * Map a file and attach it to a hash table as a lazy catalog.
+ *
+ * Scans the mapping once to index the key of every key/value line;
+ * nothing is copied and no table entries are created.  Keys already
+ * present in the table are materialised immediately so the catalog
+ * takes the precedence over them an eager parse would have had.
+ *
+ * \param ht The hash table to attach the catalog to
+ * \param path Path to an uncompressed key/value file
+ * \return NSERROR_OK on success else error code, leaving \a ht usable
+ */
+static nserror hash_catalog_attach(struct hash_table *ht, const char *path)
+{
+	struct hash_catalog *cat;
+	struct stat sb;
+	int fd;
+	char *data;
+	size_t alloc = 0;
+	size_t pos = 0;
+
+	if (ht->catalog != NULL) {
+		/* only one catalog per table; further files are
+		 * parsed eagerly and take precedence via the chains */
+		return NSERROR_INVALID;
+	}
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return NSERROR_NOT_FOUND;
+	}
+
+	if ((fstat(fd, &sb) < 0) ||
+	    (sb.st_size <= 0) ||
+	    ((uintmax_t)sb.st_size > UINT32_MAX)) {
+		close(fd);
+		return NSERROR_INVALID;
+	}
+
+	data = mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		return NSERROR_NOMEM;
+	}
+
+	if ((sb.st_size >= 2) &&
+	    (data[0] == (char)0x1f) && (data[1] == (char)0x8b)) {
+		/* gzip compressed; must be inflated eagerly */
+		munmap(data, sb.st_size);
+		return NSERROR_INVALID;
+	}
+
+	cat = calloc(1, sizeof(*cat));
+	if (cat == NULL) {
+		munmap(data, sb.st_size);
+		return NSERROR_NOMEM;
+	}
+	cat->data = data;
+	cat->size = sb.st_size;
+
+	/* index the key of every key/value line */
+	while (pos < cat->size) {
+		const char *nl;
+		size_t lend;
+		size_t kstart;
+		size_t colon;
+		unsigned int z = FNV_OFFSET_BASIS;
+
+		nl = memchr(data + pos, '\n', cat->size - pos);
+		lend = (nl != NULL) ? (size_t)(nl - data) : cat->size;
+
+		/* skip leading whitespace */
+		kstart = pos;
+		while ((kstart < lend) &&
+		       ((data[kstart] == ' ') || (data[kstart] == '\t'))) {
+			kstart++;
+		}
+
+		/* empty and comment lines carry no entry */
+		if ((kstart == lend) || (data[kstart] == '#')) {
+			pos = lend + 1;
+			continue;
+		}
+
+		/* find the separating colon, hashing the key */
+		for (colon = kstart; colon < lend; colon++) {
+			if (data[colon] == ':') {
+				break;
+			}
+			z *= FNV_PRIME;
+			z ^= data[colon];
+		}
+		if (colon == lend) {
+			/* no colon found; the file is malformed */
+			free(cat->index);
+			free(cat);
+			munmap(data, sb.st_size);
+			return NSERROR_INVALID;
+		}
+
+		if (cat->count == alloc) {
+			struct hash_catalog_entry *nindex;
+
+			alloc = (alloc == 0) ? 256 : (alloc * 2);
+			nindex = realloc(cat->index,
+					 alloc * sizeof(*nindex));
+			if (nindex == NULL) {
+				free(cat->index);
+				free(cat);
+				munmap(data, sb.st_size);
+				return NSERROR_NOMEM;
+			}
+			cat->index = nindex;
+		}
+
+		cat->index[cat->count].hash = z;
+		cat->index[cat->count].offset = kstart;
+		cat->count++;
+
+		pos = lend + 1;
+	}
+
+	qsort(cat->index, cat->count, sizeof(*cat->index),
+	      hash_catalog_cmp);
+
+	ht->catalog = cat;
+
+	/* materialise keys already in the table so the catalog
+	 * overrides them as an eager parse would have; the keys are
+	 * snapshotted first as materialising inserts entries and may
+	 * grow the chains under an iteration */
+	if (ht->nentries > 0) {
+		const char **keys;
+		unsigned int c, n = 0;
+		unsigned int h, key_length;
+		struct hash_entry *e;
+
+		keys = malloc(ht->nentries * sizeof(*keys));
+		if (keys != NULL) {
+			for (c = 0; c < ht->nchains; c++) {
+				for (e = ht->chain[c]; e != NULL; e = e->next) {
+					keys[n++] = e->pairing;
+				}
+			}
+			for (c = 0; c < n; c++) {
+				h = hash_string_fnv(keys[c], &key_length);
+				hash_catalog_get(ht, keys[c], h, key_length);
+			}
+			free(keys);
+		}
+	}
+
+	return NSERROR_OK;
+}
+#endif /* WITH_MMAP */
+
+
 /* exported interface documented in utils/hashtable.h */
 struct hash_table *hash_create(unsigned int chains)
 {
@@ -261,6 +757,13 @@ struct hash_table *hash_create(unsigned int chains)
 	}
 
 	r->nchains = chains;
+	r->nentries = 0;
+	r->slabs = NULL;
+	r->slab_used = 0;
+	r->arena = NULL;
+#ifdef WITH_MMAP
+	r->catalog = NULL;
+#endif
 	r->chain = calloc(chains, sizeof(struct hash_entry *));
 
 	if (r->chain == NULL) {
@@ -277,23 +780,30 @@ struct hash_table *hash_create(unsigned int chains)
 /* exported interface documented in utils/hashtable.h */
 void hash_destroy(struct hash_table *ht)
 {
-	unsigned int i;
+	struct hash_slab *slab;
+	struct hash_arena_block *block;
 
 	if (ht == NULL)
 		return;
 
-	for (i = 0; i < ht->nchains; i++) {
-		if (ht->chain[i] != NULL) {
-			struct hash_entry *e = ht->chain[i];
-			while (e) {
-				struct hash_entry *n = e->next;
-				free(e->pairing);
-				free(e);
-				e = n;
-			}
-		}
+	while ((slab = ht->slabs) != NULL) {
+		ht->slabs = slab->next;
+		free(slab);
 	}
 
+	while ((block = ht->arena) != NULL) {
+		ht->arena = block->next;
+		free(block);
+	}
+
+#ifdef WITH_MMAP
+	if (ht->catalog != NULL) {
+		munmap(ht->catalog->data, ht->catalog->size);
+		free(ht->catalog->index);
+		free(ht->catalog);
+	}
+#endif
+
 	free(ht->chain);
 	free(ht);
 }
@@ -302,36 +812,14 @@ void hash_destroy(struct hash_table *ht)
 /* exported interface documented in utils/hashtable.h */
 bool hash_add(struct hash_table *ht, const char *key, const char *value)
 {
-	unsigned int h, c, v;
-	struct hash_entry *e;
+	unsigned int h, key_length;
 
 	if (ht == NULL || key == NULL || value == NULL)
 		return false;
 
-	e = malloc(sizeof(struct hash_entry));
-	if (e == NULL) {
-		NSLOG(netsurf, INFO, "Not enough memory for hash entry.");
-		return false;
-	}
-
-	h = hash_string_fnv(key, &(e->key_length));
-	c = h % ht->nchains;
-
-	v = strlen(value) ;
-	e->pairing = malloc(v + e->key_length + 2);
-	if (e->pairing == NULL) {
-		NSLOG(netsurf, INFO,
-		      "Not enough memory for string duplication.");
-		free(e);
-		return false;
-	}
-	memcpy(e->pairing, key, e->key_length + 1);
-	memcpy(e->pairing + e->key_length + 1, value, v + 1);
-
-	e->next = ht->chain[c];
-	ht->chain[c] = e;
+	h = hash_string_fnv(key, &key_length);
 
-	return true;
+	return hash_add_hashed(ht, key, key_length, h, value, strlen(value));
 }
 
 
@@ -348,13 +836,19 @@ const char *hash_get(struct hash_table *ht, const char *key)
 	c = h % ht->nchains;
 
 	for (e = ht->chain[c]; e; e = e->next) {
-		if ((key_length == e->key_length) &&
+		if ((h == e->hash) &&
+		    (key_length == e->key_length) &&
 		    (memcmp(key, e->pairing, key_length) == 0)) {
 			return e->pairing + key_length + 1;
 		}
 	}
 
+#ifdef WITH_MMAP
+	/* not materialised; try the backing catalog */
+	return hash_catalog_get(ht, key, h, key_length);
+#else
 	return NULL;
+#endif
 }
 
 
@@ -370,6 +864,14 @@ nserror hash_add_file(struct hash_table *ht, const char *path)
 		return NSERROR_BAD_PARAMETER;
 	}
 
+#ifdef WITH_MMAP
+	/* map uncompressed files as a lazy catalog instead of
+	 * parsing; compressed files fall through to the eager path */
+	if (hash_catalog_attach(ht, path) == NSERROR_OK) {
+		return NSERROR_OK;
+	}
+#endif
+
 	fp = gzopen(path, "r");
 	if (!fp) {
 		NSLOG(netsurf, INFO,
@@ -31,13 +31,14 @@ struct hash_table;
 /**
  * Create a new hash table
  *
- * Allocate a new hash table and return a context for it.  The memory
- * consumption of a hash table is approximately 8 + (nchains * 12)
- * bytes if it is empty.
- *
- * \param chains Number of chains/buckets this hash table will have.  This
- *		  should be a prime number, and ideally a prime number just
- *		  over a power of two, for best performance and distribution.
+ * Allocate a new hash table and return a context for it.  The table
+ * grows automatically as entries are added, so the initial chain count
+ * only needs to suit the expected common case.
+ *
+ * \param chains Initial number of chains/buckets this hash table will
+ *		  have.  This should be a prime number, and ideally a prime
+ *		  number just over a power of two, for best performance and
+ *		  distribution.
  * \return struct hash_table containing the context of this hash table or NULL
  *	   if there is insufficent memory to create it and its chains.
  */
@@ -88,6 +89,11 @@ const char *hash_get(struct hash_table *ht, const char *key);
  *
  * The file may be optionally gzip compressed.
  *
+ * On platforms with mmap() an uncompressed file is not parsed up
+ * front: it is mapped and indexed, and each entry is materialised
+ * into the table the first time it is looked up.  This is invisible
+ * to callers beyond the reduced load time and memory use.
+ *
  * \param ht The hash table context to add the key/value pairs to.
  * \param path Path to file with key/value pairs in.
  * \return NSERROR_OK on success else error code
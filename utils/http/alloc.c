@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Arena allocator for parsed HTTP header structures.
+ *
+ * Every fetched resource runs the header field parsers at least once,
+ * and each parse built its items with individual mallocs that were
+ * freed again moments later once the caller had picked out the values
+ * it wanted.  Allocations that short lived and that small suit an
+ * arena: blocks are carved off a bump pointer, and because a parse
+ * always destroys everything it produced, the arena resets to empty as
+ * soon as the last outstanding block is returned.  In the steady state
+ * header parsing performs no heap allocation at all.
+ *
+ * Blocks that do not fit (unusually long values, hostile parameter
+ * lists) fall back to malloc(); http__free() tells the two cases apart
+ * by address.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "utils/http/alloc.h"
+
+/** Size of the header parsing arena, in bytes. */
+#define HTTP_ARENA_SIZE 4096
+
+/**
+ * Alignment of blocks carved from the arena.
+ *
+ * Sufficient for the pointer and integer members of the parser
+ * structures.
+ */
+#define HTTP_ARENA_ALIGN 8
+
+/** The arena backing store. */
+static uint8_t http__arena[HTTP_ARENA_SIZE];
+
+/** Bytes of the arena handed out and not yet reclaimed. */
+static size_t http__arena_used;
+
+/** Number of arena blocks outstanding. */
+static unsigned int http__arena_live;
+
+/* exported interface documented in utils/http/alloc.h */
+void *http__alloc(size_t size)
+{
+	void *block;
+
+	size = (size + (HTTP_ARENA_ALIGN - 1)) &
+			~((size_t) (HTTP_ARENA_ALIGN - 1));
+
+	if (size > HTTP_ARENA_SIZE - http__arena_used)
+		return malloc(size);
+
+	block = &http__arena[http__arena_used];
+
+	http__arena_used += size;
+	http__arena_live++;
+
+	return block;
+}
+
+/* exported interface documented in utils/http/alloc.h */
+void http__free(void *ptr)
+{
+	uint8_t *block = ptr;
+
+	if (ptr == NULL)
+		return;
+
+	if (block >= http__arena && block < &http__arena[HTTP_ARENA_SIZE]) {
+		/* individual blocks are not reclaimed; the whole arena
+		 * resets once everything from this burst of parsing
+		 * has been returned */
+		if (--http__arena_live == 0)
+			http__arena_used = 0;
+	} else {
+		free(ptr);
+	}
+}
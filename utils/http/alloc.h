@@ -0,0 +1,42 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NETSURF_UTILS_HTTP_ALLOC_H_
+#define NETSURF_UTILS_HTTP_ALLOC_H_
+
+#include <stddef.h>
+
+/**
+ * Allocate a block for a parsed header structure.
+ *
+ * Blocks come from the header parsing arena where possible and must be
+ * released with http__free().
+ *
+ * \param size  Size of block required, in bytes
+ * \return Pointer to block, or NULL on memory exhaustion
+ */
+void *http__alloc(size_t size);
+
+/**
+ * Release a block obtained from http__alloc().
+ *
+ * \param ptr  Block to release, or NULL
+ */
+void http__free(void *ptr);
+
+#endif
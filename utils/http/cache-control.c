@@ -22,6 +22,7 @@
 #include "utils/corestrings.h"
 #include "utils/http.h"
 
+#include "utils/http/alloc.h"
 #include "utils/http/generics.h"
 #include "utils/http/primitives.h"
 
@@ -33,6 +34,11 @@ struct http_cache_control {
 	bool max_age_valid;		/**< Whether max-age is valid */
 	bool no_cache;			/**< Whether caching is forbidden */
 	bool no_store;			/**< Whether persistent caching is forbidden */
+	bool immutable;			/**< Whether the response is immutable */
+	/** Stale-while-revalidate window (delta seconds) */
+	uint32_t stale_while_revalidate;
+	/** Whether stale-while-revalidate is valid */
+	bool stale_while_revalidate_valid;
 };
 
 /**
@@ -52,7 +58,7 @@ static void http_destroy_directive(http_directive *self)
 	if (self->value != NULL) {
 		lwc_string_unref(self->value);
 	}
-	free(self);
+	http__free(self);
 }
 
 static nserror http__parse_directive(const char **input,
@@ -88,7 +94,7 @@ static nserror http__parse_directive(const char **input,
 		}
 	}
 
-	directive = malloc(sizeof(*directive));
+	directive = http__alloc(sizeof(*directive));
 	if (directive == NULL) {
 		if (value != NULL) {
 			lwc_string_unref(value);
@@ -244,6 +250,9 @@ nserror http_parse_cache_control(const char *header_value,
 	bool max_age_valid = false;
 	bool no_cache = false;
 	bool no_store = false;
+	bool immutable = false;
+	uint32_t stale_while_revalidate = 0;
+	bool stale_while_revalidate_valid = false;
 	nserror error;
 
 	/* 1#cache-directive */
@@ -305,9 +314,28 @@ nserror http_parse_cache_control(const char *header_value,
 		}
 	}
 
+	/* Find immutable */
+	error = http_directive_list_find_item(directives,
+			corestring_lwc_immutable, &value_str);
+	if (error == NSERROR_OK) {
+		immutable = true;
+		if (value_str != NULL) {
+			lwc_string_unref(value_str);
+		}
+	}
+
+	/* Find stale-while-revalidate */
+	error = http_directive_list_find_item(directives,
+			corestring_lwc_stale_while_revalidate, &value_str);
+	if (error == NSERROR_OK && value_str != NULL) {
+		error = parse_max_age(value_str, &stale_while_revalidate);
+		stale_while_revalidate_valid = (error == NSERROR_OK);
+		lwc_string_unref(value_str);
+	}
+
 	http_directive_list_destroy(directives);
 
-	cc = malloc(sizeof(*cc));
+	cc = http__alloc(sizeof(*cc));
 	if (cc == NULL) {
 		return NSERROR_NOMEM;
 	}
@@ -316,6 +344,9 @@ nserror http_parse_cache_control(const char *header_value,
 	cc->max_age_valid = max_age_valid;
 	cc->no_cache = no_cache;
 	cc->no_store = no_store;
+	cc->immutable = immutable;
+	cc->stale_while_revalidate = stale_while_revalidate;
+	cc->stale_while_revalidate_valid = stale_while_revalidate_valid;
 
 	*result = cc;
 
@@ -325,7 +356,7 @@ nserror http_parse_cache_control(const char *header_value,
 /* See cache-control.h for documentation */
 void http_cache_control_destroy(http_cache_control *victim)
 {
-	free(victim);
+	http__free(victim);
 }
 
 /* See cache-control.h for documentation */
@@ -351,3 +382,21 @@ bool http_cache_control_no_store(http_cache_control *cc)
 {
 	return cc->no_store;
 }
+
+/* See cache-control.h for documentation */
+bool http_cache_control_immutable(http_cache_control *cc)
+{
+	return cc->immutable;
+}
+
+/* See cache-control.h for documentation */
+bool http_cache_control_has_stale_while_revalidate(http_cache_control *cc)
+{
+	return cc->stale_while_revalidate_valid;
+}
+
+/* See cache-control.h for documentation */
+uint32_t http_cache_control_stale_while_revalidate(http_cache_control *cc)
+{
+	return cc->stale_while_revalidate;
+}
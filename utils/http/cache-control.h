@@ -74,4 +74,28 @@ bool http_cache_control_no_cache(http_cache_control *cc);
  */
 bool http_cache_control_no_store(http_cache_control *cc);
 
+/**
+ * Get the value of a cache control's immutable flag
+ *
+ * \param cc Object to inspect
+ * \return Whether the response will not change while fresh
+ */
+bool http_cache_control_immutable(http_cache_control *cc);
+
+/**
+ * Determine if a valid stale-while-revalidate directive is present
+ *
+ * \param cc Object to inspect
+ * \return Whether stale-while-revalidate is valid
+ */
+bool http_cache_control_has_stale_while_revalidate(http_cache_control *cc);
+
+/**
+ * Get the value of a cache control's stale-while-revalidate window
+ *
+ * \param cc Object to inspect
+ * \return Stale-while-revalidate window, in delta-seconds
+ */
+uint32_t http_cache_control_stale_while_revalidate(http_cache_control *cc);
+
 #endif
@@ -21,6 +21,7 @@
 #include "utils/http.h"
 
 #include "utils/http/challenge_internal.h"
+#include "utils/http/alloc.h"
 #include "utils/http/generics.h"
 #include "utils/http/parameter_internal.h"
 #include "utils/http/primitives.h"
@@ -44,7 +45,7 @@ static void http_destroy_challenge(http_challenge *self)
 {
 	lwc_string_unref(self->scheme);
 	http_parameter_list_destroy(self->params);
-	free(self);
+	http__free(self);
 }
 
 /**
@@ -102,7 +103,7 @@ nserror http__parse_challenge(const char **input, http_challenge **challenge)
 		params = first;
 	}
 
-	result = malloc(sizeof(*result));
+	result = http__alloc(sizeof(*result));
 	if (result == NULL) {
 		http_parameter_list_destroy(params);
 		lwc_string_unref(scheme);
@@ -20,6 +20,7 @@
 
 #include "utils/http.h"
 
+#include "utils/http/alloc.h"
 #include "utils/http/generics.h"
 #include "utils/http/parameter_internal.h"
 #include "utils/http/primitives.h"
@@ -53,7 +54,7 @@ nserror http_parse_content_disposition(const char *header_value,
 		}
 	}
 
-	cd = malloc(sizeof(*cd));
+	cd = http__alloc(sizeof(*cd));
 	if (cd == NULL) {
 		http_parameter_list_destroy(params);
 		lwc_string_unref(mtype);
@@ -73,6 +74,6 @@ void http_content_disposition_destroy(http_content_disposition *victim)
 {
 	lwc_string_unref(victim->disposition_type);
 	http_parameter_list_destroy(victim->parameters);
-	free(victim);
+	http__free(victim);
 }
 
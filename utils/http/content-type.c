@@ -22,6 +22,7 @@
 
 #include "utils/http.h"
 
+#include "utils/http/alloc.h"
 #include "utils/http/generics.h"
 #include "utils/http/parameter_internal.h"
 #include "utils/http/primitives.h"
@@ -80,7 +81,7 @@ nserror http_parse_content_type(const char *header_value,
 	/* <type> + <subtype> + '/' */
 	mime_len = lwc_string_length(type) + lwc_string_length(subtype) + 1;
 
-	mime = malloc(mime_len + 1);
+	mime = http__alloc(mime_len + 1);
 	if (mime == NULL) {
 		http_parameter_list_destroy(params);
 		lwc_string_unref(subtype);
@@ -97,13 +98,13 @@ nserror http_parse_content_type(const char *header_value,
 
 	if (lwc_intern_string(mime, mime_len, &imime) != lwc_error_ok) {
 		http_parameter_list_destroy(params);
-		free(mime);
+		http__free(mime);
 		return NSERROR_NOMEM;
 	}
 
-	free(mime);
+	http__free(mime);
 
-	ct = malloc(sizeof(*ct));
+	ct = http__alloc(sizeof(*ct));
 	if (ct == NULL) {
 		lwc_string_unref(imime);
 		http_parameter_list_destroy(params);
@@ -123,6 +124,6 @@ void http_content_type_destroy(http_content_type *victim)
 {
 	lwc_string_unref(victim->media_type);
 	http_parameter_list_destroy(victim->parameters);
-	free(victim);
+	http__free(victim);
 }
 
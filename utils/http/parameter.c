@@ -21,6 +21,7 @@
 
 #include "utils/http.h"
 
+#include "utils/http/alloc.h"
 #include "utils/http/generics.h"
 #include "utils/http/parameter_internal.h"
 #include "utils/http/primitives.h"
@@ -44,7 +45,7 @@ static void http_destroy_parameter(http_parameter *self)
 {
 	lwc_string_unref(self->name);
 	lwc_string_unref(self->value);
-	free(self);
+	http__free(self);
 }
 
 /**
@@ -93,7 +94,7 @@ nserror http__parse_parameter(const char **input, http_parameter **parameter)
 		return error;
 	}
 
-	param = malloc(sizeof(*param));
+	param = http__alloc(sizeof(*param));
 	if (param == NULL) {
 		lwc_string_unref(value);
 		lwc_string_unref(name);
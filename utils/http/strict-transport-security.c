@@ -22,6 +22,7 @@
 #include "utils/corestrings.h"
 #include "utils/http.h"
 
+#include "utils/http/alloc.h"
 #include "utils/http/generics.h"
 #include "utils/http/primitives.h"
 
@@ -50,7 +51,7 @@ static void http_destroy_directive(http_directive *self)
 	if (self->value != NULL) {
 		lwc_string_unref(self->value);
 	}
-	free(self);
+	http__free(self);
 }
 
 static nserror http__parse_directive(const char **input,
@@ -86,7 +87,7 @@ static nserror http__parse_directive(const char **input,
 		}
 	}
 
-	directive = malloc(sizeof(*directive));
+	directive = http__alloc(sizeof(*directive));
 	if (directive == NULL) {
 		if (value != NULL) {
 			lwc_string_unref(value);
@@ -305,7 +306,7 @@ nserror http_parse_strict_transport_security(const char *header_value,
 	}
 	http_directive_list_destroy(directives);
 
-	sts = malloc(sizeof(*sts));
+	sts = http__alloc(sizeof(*sts));
 	if (sts == NULL) {
 		return NSERROR_NOMEM;
 	}
@@ -322,7 +323,7 @@ nserror http_parse_strict_transport_security(const char *header_value,
 void http_strict_transport_security_destroy(
 		http_strict_transport_security *victim)
 {
-	free(victim);
+	http__free(victim);
 }
 
 /* See strict-transport-security.h for documentation */
@@ -19,6 +19,7 @@
 #include <stdlib.h>
 
 #include "utils/http/challenge_internal.h"
+#include "utils/http/alloc.h"
 #include "utils/http/generics.h"
 #include "utils/http/parameter_internal.h"
 #include "utils/http/primitives.h"
@@ -53,7 +54,7 @@ nserror http_parse_www_authenticate(const char *header_value,
 		list = first;
 	}
 
-	wa = malloc(sizeof(*wa));
+	wa = http__alloc(sizeof(*wa));
 	if (wa == NULL) {
 		http_challenge_list_destroy(list);
 		return NSERROR_NOMEM;
@@ -70,6 +71,6 @@ nserror http_parse_www_authenticate(const char *header_value,
 void http_www_authenticate_destroy(http_www_authenticate *victim)
 {
 	http_challenge_list_destroy(victim->challenges);
-	free(victim);
+	http__free(victim);
 }
 
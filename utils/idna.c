@@ -708,6 +708,118 @@ static bool idna__is_ace(const char *label, size_t len)
 		}                                                              \
 	} while (0)
 
+/** Number of entries in the hostname conversion cache */
+#define IDNA_CACHE_ENTRIES 8
+
+/** Cached result of a hostname to ACE conversion */
+struct idna_cache_entry {
+	size_t host_len;	/**< Length of source hostname */
+	size_t ace_len;		/**< Length of converted hostname */
+	char host[FQDN_MAX];	/**< Source hostname */
+	char ace[FQDN_MAX];	/**< Converted hostname */
+};
+
+/**
+ * Recently converted hostnames, most recently used first.
+ *
+ * Fetch setup and urldb lookups convert the same few hostnames over
+ * and over in a session, so successful conversions are kept here and
+ * consulted before running the full UTS#46 mapping and punycode
+ * encoding.  The least recently used entry is evicted when full.
+ */
+static struct idna_cache_entry *idna__cache[IDNA_CACHE_ENTRIES];
+static int idna__cache_used;
+
+
+/**
+ * Look up a hostname in the conversion cache
+ *
+ * On a hit the entry is moved to the front of the cache and a copy of
+ * the converted hostname is returned.
+ *
+ * \param host	String containing host
+ * \param len	Length of host string
+ * \param ace_host	Updated to contain a copy of the converted string
+ * \param ace_len	Updated to the length of the converted string
+ * \return true on a cache hit, false otherwise
+ */
+static bool
+idna__cache_get(const char *host, size_t len, char **ace_host, size_t *ace_len)
+{
+	struct idna_cache_entry *e;
+	char *output;
+	int i;
+
+	for (i = 0; i < idna__cache_used; i++) {
+		e = idna__cache[i];
+		if ((e->host_len != len) ||
+		    (memcmp(e->host, host, len) != 0)) {
+			continue;
+		}
+
+		output = malloc(e->ace_len + 1);
+		if (output == NULL) {
+			return false;
+		}
+		memcpy(output, e->ace, e->ace_len + 1);
+		*ace_host = output;
+		*ace_len = e->ace_len;
+
+		if (i != 0) {
+			memmove(&idna__cache[1], &idna__cache[0],
+					i * sizeof(idna__cache[0]));
+			idna__cache[0] = e;
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+
+/**
+ * Record a hostname conversion in the cache
+ *
+ * Hostnames too long to cache are silently ignored, as is allocation
+ * failure, since the cache only ever duplicates work done elsewhere.
+ *
+ * \param host	String containing host
+ * \param len	Length of host string
+ * \param ace	Converted hostname, with terminator
+ * \param ace_len	Length of converted hostname
+ */
+static void
+idna__cache_add(const char *host, size_t len, const char *ace, size_t ace_len)
+{
+	struct idna_cache_entry *e;
+
+	if ((len >= FQDN_MAX) || (ace_len >= FQDN_MAX)) {
+		return;
+	}
+
+	if (idna__cache_used < IDNA_CACHE_ENTRIES) {
+		e = malloc(sizeof(*e));
+		if (e == NULL) {
+			return;
+		}
+		idna__cache_used++;
+	} else {
+		/* Evict the least recently used entry */
+		e = idna__cache[IDNA_CACHE_ENTRIES - 1];
+	}
+
+	memmove(&idna__cache[1], &idna__cache[0],
+			(idna__cache_used - 1) * sizeof(idna__cache[0]));
+	idna__cache[0] = e;
+
+	memcpy(e->host, host, len);
+	e->host_len = len;
+	memcpy(e->ace, ace, ace_len + 1);
+	e->ace_len = ace_len;
+}
+
+
 /* exported interface documented in idna.h */
 nserror
 idna_encode(const char *host, size_t len, char **ace_host, size_t *ace_len)
@@ -715,9 +827,15 @@ idna_encode(const char *host, size_t len, char **ace_host, size_t *ace_len)
 	nserror error;
 	int32_t *ucs4_host;
 	size_t label_len, output_len, ucs4_len, fqdn_len = 0;
+	const char *host_start = host;
+	size_t host_len = len;
 	char fqdn[FQDN_MAX];
 	char *output, *fqdn_p = fqdn;
 
+	if (idna__cache_get(host, len, ace_host, ace_len)) {
+		return NSERROR_OK;
+	}
+
 	label_len = idna__host_label_length(host, len);
 	if (label_len == 0) {
 		return NSERROR_BAD_URL;
@@ -776,6 +894,8 @@ idna_encode(const char *host, size_t len, char **ace_host, size_t *ace_len)
 	*ace_host = strdup(fqdn);
 	*ace_len = fqdn_len - 1; /* last character is NULL */
 
+	idna__cache_add(host_start, host_len, fqdn, *ace_len);
+
 	return NSERROR_OK;
 }
 
@@ -21,6 +21,7 @@
  */
 
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 #include <dom/dom.h>
 
@@ -118,6 +119,186 @@ nserror libdom_iterate_child_elements(dom_node *parent,
 	return NSERROR_OK;
 }
 
+/**
+ * Ancestors a treewalk can track before the stack moves to the heap.
+ *
+ * Real world documents rarely nest more than a few tens of elements
+ * deep, so almost every walk runs entirely from this array.
+ */
+#define LIBDOM_TREEWALK_DEPTH 32
+
+/* exported interface documented in libdom.h */
+bool libdom_treewalk(dom_node *root, libdom_treewalk_cb cb, void *ctx)
+{
+	dom_node *stack_fixed[LIBDOM_TREEWALK_DEPTH];
+	dom_node **stack = stack_fixed;
+	size_t stack_alloc = LIBDOM_TREEWALK_DEPTH;
+	size_t depth = 0;
+	dom_node *node;
+	bool res = false;
+
+	node = dom_node_ref(root);
+
+	for (;;) {
+		dom_exception exc;
+		dom_node *next = NULL;
+
+		if (cb(node, LIBDOM_TREEWALK_ENTER, ctx) == false)
+			goto abort;
+
+		exc = dom_node_get_first_child(node, &next);
+		if (exc != DOM_NO_ERR)
+			goto abort;
+
+		if (next != NULL) {
+			/* Descend.  The sole reference held on each
+			 * ancestor lives in the stack until the walk
+			 * climbs back out of it. */
+			if (depth == stack_alloc) {
+				dom_node **nstack;
+
+				if (stack == stack_fixed) {
+					nstack = malloc(2 * stack_alloc *
+							sizeof(*nstack));
+					if (nstack != NULL) {
+						memcpy(nstack, stack,
+						       stack_alloc *
+						       sizeof(*nstack));
+					}
+				} else {
+					nstack = realloc(stack,
+							 2 * stack_alloc *
+							 sizeof(*nstack));
+				}
+				if (nstack == NULL) {
+					dom_node_unref(next);
+					goto abort;
+				}
+
+				stack = nstack;
+				stack_alloc *= 2;
+			}
+
+			stack[depth++] = node;
+			node = next;
+			continue;
+		}
+
+		/* No children; leave this node, then climb until a
+		 * sibling is found to continue with. */
+		for (;;) {
+			if (cb(node, LIBDOM_TREEWALK_LEAVE, ctx) == false)
+				goto abort;
+
+			if (depth == 0) {
+				/* Left the walk root; all done. */
+				dom_node_unref(node);
+				res = true;
+				goto done;
+			}
+
+			exc = dom_node_get_next_sibling(node, &next);
+			if (exc != DOM_NO_ERR)
+				goto abort;
+
+			dom_node_unref(node);
+
+			if (next != NULL) {
+				node = next;
+				break;
+			}
+
+			node = stack[--depth];
+		}
+	}
+
+abort:
+	dom_node_unref(node);
+	while (depth > 0) {
+		dom_node_unref(stack[--depth]);
+	}
+
+done:
+	if (stack != stack_fixed) {
+		free(stack);
+	}
+
+	return res;
+}
+
+
+/**
+ * Context for a filtered element walk.
+ */
+struct libdom_treewalk_element_ctx {
+	lwc_string * const *tags;	/**< element names to match */
+	size_t tag_count;		/**< number of entries in tags */
+	libdom_treewalk_element_cb cb;	/**< the callers callback */
+	void *ctx;			/**< the callers context */
+};
+
+/**
+ * Treewalk callback dispatching matching elements to the caller.
+ *
+ * \param node The node being visited.
+ * \param event Whether the node is being entered or left.
+ * \param ctxin The filtered walk context.
+ * \return true to continue the walk or false to terminate it.
+ */
+static bool
+libdom_treewalk_element_dispatch(dom_node *node,
+				 libdom_treewalk_event event,
+				 void *ctxin)
+{
+	struct libdom_treewalk_element_ctx *ectx = ctxin;
+	dom_node_type type;
+	dom_string *name = NULL;
+	dom_exception exc;
+	size_t i;
+	bool res = true;
+
+	if (event != LIBDOM_TREEWALK_ENTER)
+		return true;
+
+	exc = dom_node_get_node_type(node, &type);
+	if (exc != DOM_NO_ERR)
+		return false;
+
+	if (type != DOM_ELEMENT_NODE)
+		return true;
+
+	exc = dom_node_get_node_name(node, &name);
+	if ((exc != DOM_NO_ERR) || (name == NULL))
+		return false;
+
+	for (i = 0; i < ectx->tag_count; i++) {
+		if (dom_string_caseless_lwc_isequal(name, ectx->tags[i])) {
+			res = ectx->cb(node, ectx->ctx);
+			break;
+		}
+	}
+
+	dom_string_unref(name);
+
+	return res;
+}
+
+/* exported interface documented in libdom.h */
+bool libdom_treewalk_elements(dom_node *root,
+		lwc_string * const *tags, size_t tag_count,
+		libdom_treewalk_element_cb cb, void *ctx)
+{
+	struct libdom_treewalk_element_ctx ectx = {
+		.tags = tags,
+		.tag_count = tag_count,
+		.cb = cb,
+		.ctx = ctx,
+	};
+
+	return libdom_treewalk(root, libdom_treewalk_element_dispatch, &ectx);
+}
+
+
 /* exported interface documented in libdom.h */
 nserror libdom_hubbub_error_to_nserror(dom_hubbub_error error)
 {
@@ -46,6 +46,67 @@ typedef nserror (*libdom_iterate_cb)(dom_node *node, void *ctx);
 nserror libdom_iterate_child_elements(dom_node *parent,
 		libdom_iterate_cb cb, void *ctx);
 
+/**
+ * Treewalk traversal events.
+ */
+typedef enum {
+	LIBDOM_TREEWALK_ENTER, /**< node visited before its children */
+	LIBDOM_TREEWALK_LEAVE  /**< node visited after its children */
+} libdom_treewalk_event;
+
+/**
+ * Callback for libdom_treewalk().
+ *
+ * \param node The node being visited.
+ * \param event Whether the node is being entered or left.
+ * \param ctx The callers context.
+ * \return true to continue the walk or false to terminate it.
+ */
+typedef bool (*libdom_treewalk_cb)(dom_node *node,
+		libdom_treewalk_event event, void *ctx);
+
+/**
+ * Walk a DOM (sub)tree iteratively, in depth first order.
+ *
+ * Every node including the root is entered before its children and
+ * left after them.  The ancestor chain is kept on an explicit stack
+ * so no parent lookups or per-step reference pairs are needed.
+ *
+ * \param root The root node to walk from.
+ * \param cb Callback called to enter and leave each node.
+ * \param ctx Context passed to \a cb.
+ * \return true if the walk completed, false on error or termination
+ *         by the callback.
+ */
+bool libdom_treewalk(dom_node *root, libdom_treewalk_cb cb, void *ctx);
+
+/**
+ * Callback for libdom_treewalk_elements().
+ *
+ * \param element The matching element.
+ * \param ctx The callers context.
+ * \return true to continue the walk or false to terminate it.
+ */
+typedef bool (*libdom_treewalk_element_cb)(dom_node *element, void *ctx);
+
+/**
+ * Walk a DOM (sub)tree visiting elements with matching names.
+ *
+ * A filtered form of libdom_treewalk() which calls back once, on
+ * entry, for each element whose name matches an entry in \a tags.
+ *
+ * \param root The root node to walk from.
+ * \param tags Array of element names to match case insensitively.
+ * \param tag_count Number of entries in \a tags.
+ * \param cb Callback called for each matching element.
+ * \param ctx Context passed to \a cb.
+ * \return true if the walk completed, false on error or termination
+ *         by the callback.
+ */
+bool libdom_treewalk_elements(dom_node *root,
+		lwc_string * const *tags, size_t tag_count,
+		libdom_treewalk_element_cb cb, void *ctx);
+
 nserror libdom_parse_file(const char *filename, const char *encoding,
 		dom_document **doc);
 
@@ -92,6 +92,35 @@ static const char *nslog_gettime(void)
 
 #ifdef WITH_NSLOG
 
+/** Size of the buffer log lines are batched in before writing */
+#define NSLOG_BUFFER_SIZE 32768
+
+/** Longest log line the buffered path will compose */
+#define NSLOG_LINE_MAX 4096
+
+/**
+ * Buffer of formatted log lines awaiting output.
+ *
+ * Writing each line to the log stream as it is generated costs a
+ * write call per NSLOG in fetch and layout hot paths when debug
+ * levels are enabled.  Lines below warning level are instead batched
+ * here and written out together when the buffer fills, a warning or
+ * worse is logged, or logging is finalised.
+ */
+static char nslog_buffer[NSLOG_BUFFER_SIZE];
+static size_t nslog_buffer_used;
+
+/**
+ * Write out any batched log lines
+ */
+static void nslog_buffer_flush(void)
+{
+	if (nslog_buffer_used > 0) {
+		fwrite(nslog_buffer, 1, nslog_buffer_used, logfile);
+		nslog_buffer_used = 0;
+	}
+}
+
 NSLOG_DEFINE_CATEGORY(netsurf, "NetSurf default logging");
 NSLOG_DEFINE_CATEGORY(llcache, "Low level cache");
 NSLOG_DEFINE_CATEGORY(fetch, "Object fetching");
@@ -109,7 +138,11 @@ netsurf_render_log(void *_ctx,
 		   const char *fmt,
 		   va_list args)
 {
-	fprintf(logfile,
+	char line[NSLOG_LINE_MAX];
+	size_t used;
+	int len;
+
+	len = snprintf(line, sizeof(line),
 		"%s [%s %.*s] %.*s:%i %.*s: ",
 		nslog_gettime(),
 		nslog_short_level_name(ctx->level),
@@ -120,11 +153,36 @@ netsurf_render_log(void *_ctx,
 		ctx->lineno,
 		ctx->funcnamelen,
 		ctx->funcname);
+	if (len < 0) {
+		return;
+	}
+	used = len;
 
-	vfprintf(logfile, fmt, args);
+	if (used < sizeof(line)) {
+		len = vsnprintf(line + used, sizeof(line) - used, fmt, args);
+		if (len > 0) {
+			used += len;
+		}
+	}
+	if (used >= sizeof(line)) {
+		/* Overlong entry; truncate it */
+		used = sizeof(line) - 1;
+	}
 
 	/* Log entries aren't newline terminated add one for clarity */
-	fputc('\n', logfile);
+	line[used++] = '\n';
+
+	if (nslog_buffer_used + used > NSLOG_BUFFER_SIZE) {
+		nslog_buffer_flush();
+	}
+	memcpy(nslog_buffer + nslog_buffer_used, line, used);
+	nslog_buffer_used += used;
+
+	/* Anything of note goes out immediately, along with the
+	 * batched lines leading up to it */
+	if (ctx->level >= NSLOG_LEVEL_WARNING) {
+		nslog_buffer_flush();
+	}
 }
 
 /* exported interface documented in utils/log.h */
@@ -301,6 +359,9 @@ nslog_finalise(void)
 	NSLOG(netsurf, INFO,
 	      "Finalising logging, please report any further messages");
 	verbose_log = true;
+#ifdef WITH_NSLOG
+	nslog_buffer_flush();
+#endif
 	if (logfile != stderr) {
 		fclose(logfile);
 		logfile = stderr;
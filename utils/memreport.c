@@ -0,0 +1,110 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Memory accounting registry implementation.
+ *
+ * A small fixed table keeps registration cheap and avoids allocating
+ * in the very module meant to account for allocations.
+ */
+
+#include <string.h>
+
+#include "utils/memreport.h"
+
+/** Maximum number of registered usage counters */
+#define MEMREPORT_MAX 16
+
+/**
+ * A registered usage counter
+ */
+struct memreport_entry {
+	const char *name; /**< subsystem name; NULL for a free slot */
+	memreport_usage_cb usage; /**< current usage callback */
+	void *pw; /**< private context for the callback */
+	size_t peak; /**< highest usage seen at any poll */
+};
+
+/** The registry of usage counters */
+static struct memreport_entry memreport_entries[MEMREPORT_MAX];
+
+
+/* exported interface documented in utils/memreport.h */
+nserror memreport_register(const char *name, memreport_usage_cb usage, void *pw)
+{
+	int idx;
+
+	for (idx = 0; idx < MEMREPORT_MAX; idx++) {
+		if (memreport_entries[idx].name == NULL) {
+			memreport_entries[idx].name = name;
+			memreport_entries[idx].usage = usage;
+			memreport_entries[idx].pw = pw;
+			memreport_entries[idx].peak = 0;
+			return NSERROR_OK;
+		}
+	}
+
+	return NSERROR_NOSPACE;
+}
+
+
+/* exported interface documented in utils/memreport.h */
+nserror memreport_unregister(const char *name)
+{
+	int idx;
+
+	for (idx = 0; idx < MEMREPORT_MAX; idx++) {
+		if ((memreport_entries[idx].name != NULL) &&
+		    (strcmp(memreport_entries[idx].name, name) == 0)) {
+			memreport_entries[idx].name = NULL;
+			return NSERROR_OK;
+		}
+	}
+
+	return NSERROR_NOT_FOUND;
+}
+
+
+/* exported interface documented in utils/memreport.h */
+nserror memreport_iterate(memreport_iterate_cb cb, void *pw)
+{
+	int idx;
+	size_t current;
+	nserror res;
+	struct memreport_entry *entry;
+
+	for (idx = 0; idx < MEMREPORT_MAX; idx++) {
+		entry = &memreport_entries[idx];
+		if (entry->name == NULL) {
+			continue;
+		}
+
+		current = entry->usage(entry->pw);
+		if (current > entry->peak) {
+			entry->peak = current;
+		}
+
+		res = cb(entry->name, current, entry->peak, pw);
+		if (res != NSERROR_OK) {
+			return res;
+		}
+	}
+
+	return NSERROR_OK;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Memory accounting registry interface.
+ *
+ * Subsystems which own a significant amount of heap (box tree talloc
+ * contexts, the image cache bitmaps, the source object cache, the
+ * javascript heaps) register a usage callback here, giving a single
+ * view of where resident memory goes which is surfaced through the
+ * about:memory page.
+ *
+ * Each registration additionally tracks the highest usage observed
+ * across polls as a watermark for capacity planning on small devices.
+ */
+
+#ifndef NETSURF_UTILS_MEMREPORT_H_
+#define NETSURF_UTILS_MEMREPORT_H_
+
+#include <stddef.h>
+
+#include "utils/errors.h"
+
+/**
+ * Type of a usage callback.
+ *
+ * Called whenever the registry is polled; must be cheap to call.
+ *
+ * \param pw The private context the callback was registered with
+ * \return The subsystem's current heap usage in bytes
+ */
+typedef size_t (*memreport_usage_cb)(void *pw);
+
+/**
+ * Type of a registry iteration callback.
+ *
+ * \param name The name the entry was registered with
+ * \param current The entry's usage in bytes at this poll
+ * \param peak The highest usage in bytes seen at any poll
+ * \param pw The private context passed to memreport_iterate()
+ * \return NSERROR_OK to continue iteration else error to terminate
+ */
+typedef nserror (*memreport_iterate_cb)(const char *name,
+					size_t current,
+					size_t peak,
+					void *pw);
+
+/**
+ * Register a memory usage counter.
+ *
+ * \param name Static name identifying the subsystem
+ * \param usage Callback returning the subsystem's current usage
+ * \param pw Private context passed to \a usage
+ * \return NSERROR_OK on success, NSERROR_NOSPACE if the registry is full
+ */
+nserror memreport_register(const char *name, memreport_usage_cb usage, void *pw);
+
+/**
+ * Remove a previously registered usage counter.
+ *
+ * \param name The name the counter was registered with
+ * \return NSERROR_OK on success, NSERROR_NOT_FOUND if not registered
+ */
+nserror memreport_unregister(const char *name);
+
+/**
+ * Poll every registered counter and iterate the results.
+ *
+ * Watermarks are updated as a side effect of the poll.
+ *
+ * \param cb Callback invoked for each registered entry
+ * \param pw Private context passed to \a cb
+ * \return NSERROR_OK on success else error from terminated iteration
+ */
+nserror memreport_iterate(memreport_iterate_cb cb, void *pw);
+
+#endif
@@ -47,6 +47,9 @@
  */
 static struct hash_table *messages_hash = NULL;
 
+/** Path to a messages file whose parse has been deferred */
+static char *messages_pending_path = NULL;
+
 
 /**
  * Create a message context
@@ -143,6 +146,32 @@ static nserror messages_load_ctx(const char *path, struct hash_table **ctx)
 }
 
 
+/**
+ * Load any messages file whose parse was deferred.
+ *
+ * Reading and hashing the messages file is put off until a message
+ * is first looked up so startup is not held behind the parse.
+ */
+static void messages_ensure(void)
+{
+	char *path;
+
+	if (messages_pending_path == NULL) {
+		return;
+	}
+
+	/* clear first so a failed load is not retried per lookup */
+	path = messages_pending_path;
+	messages_pending_path = NULL;
+
+	if (messages_load_ctx(path, &messages_hash) != NSERROR_OK) {
+		NSLOG(netsurf, INFO,
+		      "Unable to load messages file '%s'", path);
+	}
+	free(path);
+}
+
+
 /**
  * Fast lookup of a message by key.
  *
@@ -182,13 +211,27 @@ nserror messages_add_from_file(const char *path)
 
 	NSLOG(netsurf, INFO, "Loading Messages from '%s'", path);
 
-	return messages_load_ctx(path, &messages_hash);
+	if ((messages_hash != NULL) || (messages_pending_path != NULL)) {
+		/* merging into existing messages; load everything */
+		messages_ensure();
+		return messages_load_ctx(path, &messages_hash);
+	}
+
+	/* defer the parse until a message is first looked up */
+	messages_pending_path = strdup(path);
+	if (messages_pending_path == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	return NSERROR_OK;
 }
 
 
 /* exported interface documented in messages.h */
 nserror messages_add_from_inline(const uint8_t *data, size_t size)
 {
+	messages_ensure();
+
 	/* ensure the hash table is initialised */
 	if (messages_hash == NULL) {
 		messages_hash = messages_create_ctx(HASH_SIZE);
@@ -211,6 +254,8 @@ char *messages_get_buff(const char *key, ...)
 
 	assert(key != NULL);
 
+	messages_ensure();
+
 	if (messages_hash == NULL) {
 		return NULL;
 	}
@@ -240,6 +285,8 @@ char *messages_get_buff(const char *key, ...)
 /* exported function documented in utils/messages.h */
 const char *messages_get(const char *key)
 {
+	messages_ensure();
+
 	return messages_get_ctx(key, messages_hash);
 }
 
@@ -247,6 +294,8 @@ const char *messages_get(const char *key)
 /* exported function documented in utils/messages.h */
 const char *messages_get_errorcode(nserror code)
 {
+	messages_ensure();
+
 	switch (code) {
 	case NSERROR_OK:
 		/* No error */
@@ -464,4 +513,7 @@ void messages_destroy(void)
 {
 	messages_destroy_ctx(messages_hash);
 	messages_hash = NULL;
+
+	free(messages_pending_path);
+	messages_pending_path = NULL;
 }
@@ -199,6 +199,9 @@ nserror nscolour_update(void)
 			blend_colour(nscolours[NSCOLOUR_TEXT_INPUT_BG],
 			             nscolours[NSCOLOUR_TEXT_INPUT_FG]);
 
+	/* styles built from the old colours are no longer current */
+	plot_style_intern_invalidate();
+
 	return NSERROR_OK;
 }
 
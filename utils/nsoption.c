@@ -90,6 +90,110 @@ static struct nsoption_s defaults[] = {
 #undef NSOPTION_UINT
 #undef NSOPTION_COLOUR
 
+/**
+ * Option indices sorted by key.
+ *
+ * Every option table shares the key layout of \ref defaults, so one
+ * index serves them all.  It is built on first use and lets key
+ * lookups binary search instead of scanning the whole table, which
+ * choices file parsing and commandline handling did per line.
+ */
+static uint16_t option_lookup[NSOPTION_LISTEND];
+
+/** Whether \ref option_lookup has been built yet */
+static bool option_lookup_built = false;
+
+/** Maximum number of registered option change listeners */
+#define NSOPTION_MAX_LISTENERS 8
+
+/** Registered option change listeners */
+static struct {
+	nsoption_listener_t *listener;
+	void *pw;
+} option_listeners[NSOPTION_MAX_LISTENERS];
+
+
+/**
+ * Key ordering for \ref option_lookup construction
+ */
+static int option_lookup_cmp(const void *a, const void *b)
+{
+	const uint16_t *ia = a;
+	const uint16_t *ib = b;
+
+	return strcasecmp(defaults[*ia].key, defaults[*ib].key);
+}
+
+
+/**
+ * Find the index of an option from its key name
+ *
+ * \param key The key name to look up
+ * \return The option index, or -1 if the key is not known
+ */
+static int nsoption_lookup_key(const char *key)
+{
+	int lo = 0;
+	int hi = NSOPTION_LISTEND - 1;
+
+	if (option_lookup_built == false) {
+		unsigned int idx;
+
+		for (idx = 0; idx < NSOPTION_LISTEND; idx++) {
+			option_lookup[idx] = idx;
+		}
+		qsort(option_lookup,
+		      NSOPTION_LISTEND,
+		      sizeof(option_lookup[0]),
+		      option_lookup_cmp);
+		option_lookup_built = true;
+	}
+
+	while (lo <= hi) {
+		int mid = (lo + hi) / 2;
+		int cmp = strcasecmp(key, defaults[option_lookup[mid]].key);
+
+		if (cmp == 0) {
+			return option_lookup[mid];
+		} else if (cmp < 0) {
+			hi = mid - 1;
+		} else {
+			lo = mid + 1;
+		}
+	}
+
+	return -1;
+}
+
+
+/**
+ * Inform registered listeners of an option value change
+ *
+ * Changes to tables other than the global active one are of no
+ * interest to listeners and are not reported.
+ *
+ * \param opts The table the change was made to
+ * \param option_idx The option which changed
+ */
+static void
+nsoption_notify(struct nsoption_s *opts, enum nsoption_e option_idx)
+{
+	int idx;
+
+	if (opts != nsoptions) {
+		return;
+	}
+
+	for (idx = 0; idx < NSOPTION_MAX_LISTENERS; idx++) {
+		if (option_listeners[idx].listener != NULL) {
+			option_listeners[idx].listener(
+					option_listeners[idx].pw,
+					option_idx);
+		}
+	}
+}
+
+
 /**
  * Set an option value based on a string
  */
@@ -613,10 +717,10 @@ static nserror optionline(struct nsoption_s *opts, char *line, int linelen)
 		return res;
 	}
 
-	for (idx = 0; opts[idx].key != NULL; idx++) {
-		if (strcasecmp(key, opts[idx].key) == 0) {
-			strtooption(value, &opts[idx]);
-			break;
+	idx = nsoption_lookup_key(key);
+	if (idx >= 0) {
+		if (strtooption(value, &opts[idx])) {
+			nsoption_notify(opts, idx);
 		}
 	}
 
@@ -870,11 +974,15 @@ nsoption_commandline(int *pargc, char **argv, struct nsoption_s *opts)
 
 		NSLOG(netsurf, INFO, "%.*s = %s", arglen, arg, val);
 
+		/* look for a prefix match; the first matching table
+		 * entry wins, which allows abbreviated option names */
 		for (entry_loop = 0;
 		     entry_loop < NSOPTION_LISTEND;
 		     entry_loop++) {
 			if (strncmp(arg, opts[entry_loop].key, arglen) == 0) {
-				strtooption(val, opts + entry_loop);
+				if (strtooption(val, opts + entry_loop)) {
+					nsoption_notify(opts, entry_loop);
+				}
 				break;
 			}
 		}
@@ -1036,5 +1144,91 @@ nsoption_set_tbl_charp(struct nsoption_s *opts,
 		free(option->value.s);
 		option->value.s = NULL;
 	}
+
+	nsoption_notify(opts, option_idx);
+
+	return NSERROR_OK;
+}
+
+/* exported interface documented in options.h */
+nserror
+nsoption_set_tbl_bool(struct nsoption_s *opts,
+		      enum nsoption_e option_idx,
+		      bool b)
+{
+	opts[option_idx].value.b = b;
+	nsoption_notify(opts, option_idx);
+	return NSERROR_OK;
+}
+
+/* exported interface documented in options.h */
+nserror
+nsoption_set_tbl_int(struct nsoption_s *opts,
+		     enum nsoption_e option_idx,
+		     int i)
+{
+	opts[option_idx].value.i = i;
+	nsoption_notify(opts, option_idx);
+	return NSERROR_OK;
+}
+
+/* exported interface documented in options.h */
+nserror
+nsoption_set_tbl_uint(struct nsoption_s *opts,
+		      enum nsoption_e option_idx,
+		      unsigned int u)
+{
+	opts[option_idx].value.u = u;
+	nsoption_notify(opts, option_idx);
+	return NSERROR_OK;
+}
+
+/* exported interface documented in options.h */
+nserror
+nsoption_set_tbl_colour(struct nsoption_s *opts,
+			enum nsoption_e option_idx,
+			colour c)
+{
+	opts[option_idx].value.c = c;
+	nsoption_notify(opts, option_idx);
 	return NSERROR_OK;
 }
+
+/* exported interface documented in options.h */
+nserror
+nsoption_register_listener(nsoption_listener_t *listener, void *pw)
+{
+	int idx;
+
+	if (listener == NULL) {
+		return NSERROR_BAD_PARAMETER;
+	}
+
+	for (idx = 0; idx < NSOPTION_MAX_LISTENERS; idx++) {
+		if (option_listeners[idx].listener == NULL) {
+			option_listeners[idx].listener = listener;
+			option_listeners[idx].pw = pw;
+			return NSERROR_OK;
+		}
+	}
+
+	return NSERROR_NOSPACE;
+}
+
+/* exported interface documented in options.h */
+nserror
+nsoption_unregister_listener(nsoption_listener_t *listener, void *pw)
+{
+	int idx;
+
+	for (idx = 0; idx < NSOPTION_MAX_LISTENERS; idx++) {
+		if ((option_listeners[idx].listener == listener) &&
+		    (option_listeners[idx].pw == pw)) {
+			option_listeners[idx].listener = NULL;
+			option_listeners[idx].pw = NULL;
+			return NSERROR_OK;
+		}
+	}
+
+	return NSERROR_NOT_FOUND;
+}
@@ -306,19 +306,69 @@ int nsoption_snoptionf(char *string, size_t size, enum nsoption_e option, const
 #define nsoption_colour(OPTION) (nsoptions[NSOPTION_##OPTION].value.c)
 
 
+/**
+ * Option change listener callback.
+ *
+ * Called whenever an option value in the global active table is set,
+ * with the index of the option concerned.  The value may be set to
+ * the one it already held; listeners interested in actual changes
+ * must compare with their own record of the previous value.
+ */
+typedef void (nsoption_listener_t)(void *pw, enum nsoption_e option);
+
+/**
+ * Register an option change listener.
+ *
+ * Allows a consumer to read an option value once and be told when it
+ * is set instead of polling it in hot paths.
+ *
+ * @param listener The callback to register.
+ * @param pw Private context passed to the callback.
+ * @return NSERROR_OK on success, NSERROR_NOSPACE if the listener
+ *         table is full.
+ */
+nserror nsoption_register_listener(nsoption_listener_t *listener, void *pw);
+
+/**
+ * Remove a previously registered option change listener.
+ *
+ * @param listener The callback passed to registration.
+ * @param pw The context passed to registration.
+ * @return NSERROR_OK on success, NSERROR_NOT_FOUND if not registered.
+ */
+nserror nsoption_unregister_listener(nsoption_listener_t *listener, void *pw);
+
+
+/** Set a boolean option in specified table */
+nserror nsoption_set_tbl_bool(struct nsoption_s *opts, enum nsoption_e option_idx, bool b);
+
+/** Set an integer option in specified table */
+nserror nsoption_set_tbl_int(struct nsoption_s *opts, enum nsoption_e option_idx, int i);
+
+/** Set an unsigned integer option in specified table */
+nserror nsoption_set_tbl_uint(struct nsoption_s *opts, enum nsoption_e option_idx, unsigned int u);
+
+/** Set a colour option in specified table */
+nserror nsoption_set_tbl_colour(struct nsoption_s *opts, enum nsoption_e option_idx, colour c);
+
+
 /** set a boolean option in the default table */
-#define nsoption_set_bool(OPTION, VALUE) nsoptions[NSOPTION_##OPTION].value.b = VALUE
+#define nsoption_set_bool(OPTION, VALUE) \
+	nsoption_set_tbl_bool(nsoptions, NSOPTION_##OPTION, VALUE)
 
 
 /** set an integer option in the default table */
-#define nsoption_set_int(OPTION, VALUE) nsoptions[NSOPTION_##OPTION].value.i = VALUE
+#define nsoption_set_int(OPTION, VALUE) \
+	nsoption_set_tbl_int(nsoptions, NSOPTION_##OPTION, VALUE)
 
 /** set an unsigned integer option in the default table */
-#define nsoption_set_uint(OPTION, VALUE) nsoptions[NSOPTION_##OPTION].value.u = VALUE
+#define nsoption_set_uint(OPTION, VALUE) \
+	nsoption_set_tbl_uint(nsoptions, NSOPTION_##OPTION, VALUE)
 
 
 /** set a colour option in the default table */
-#define nsoption_set_colour(OPTION, VALUE) nsoptions[NSOPTION_##OPTION].value.c = VALUE
+#define nsoption_set_colour(OPTION, VALUE) \
+	nsoption_set_tbl_colour(nsoptions, NSOPTION_##OPTION, VALUE)
 
 
 /**
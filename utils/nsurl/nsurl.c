@@ -65,6 +65,109 @@
 
 
 
+/** Number of chains in the URL intern cache */
+#define NSURL_INTERN_CHAINS 2048
+
+/**
+ * Weak cache of live URL objects, chained by hash.
+ *
+ * Identical URLs are parsed over and over during box construction and
+ * fetch setup, so freshly built URL objects are looked up here and
+ * deduplicated onto one refcounted object.  Entries are removed when
+ * their last reference goes, so the cache never keeps a URL alive.
+ */
+static nsurl *nsurl__intern_cache[NSURL_INTERN_CHAINS];
+
+
+/**
+ * Hash a URL string for intern cache chain selection.
+ *
+ * The nsurl hash is derived from interned components, which a plain
+ * string lookup does not have, so the cache is chained by a separate
+ * hash over the URL string itself.  (FNV-1a.)
+ *
+ * \param s	URL string
+ * \param len	byte length of \a s
+ * \return hash value for chain selection
+ */
+static inline uint32_t nsurl__intern_hash(const char *s, size_t len)
+{
+	uint32_t z = 0x811c9dc5;
+
+	while (len > 0) {
+		z ^= (uint8_t) *s++;
+		z *= 0x01000193;
+		len--;
+	}
+
+	return z;
+}
+
+
+/* internal interface, documented in private.h */
+nsurl *nsurl__intern(nsurl *url)
+{
+	uint32_t hash = nsurl__intern_hash(url->string, url->length);
+	nsurl **chain = &nsurl__intern_cache[hash % NSURL_INTERN_CHAINS];
+	nsurl *entry;
+
+	for (entry = *chain; entry != NULL; entry = entry->intern_next) {
+		if ((entry->length == url->length) &&
+		    (memcmp(entry->string, url->string, url->length) == 0)) {
+			/* Identical URL already live; share that */
+			entry->count++;
+			nsurl__components_destroy(&url->components);
+			free(url);
+			return entry;
+		}
+	}
+
+	url->intern_prevptr = chain;
+	url->intern_next = *chain;
+	if (url->intern_next != NULL) {
+		url->intern_next->intern_prevptr = &url->intern_next;
+	}
+	*chain = url;
+
+	return url;
+}
+
+
+/* internal interface, documented in private.h */
+nsurl *nsurl__intern_lookup(const char *string, size_t length)
+{
+	uint32_t hash = nsurl__intern_hash(string, length);
+	nsurl *entry;
+
+	for (entry = nsurl__intern_cache[hash % NSURL_INTERN_CHAINS];
+			entry != NULL; entry = entry->intern_next) {
+		if ((entry->length == length) &&
+		    (memcmp(entry->string, string, length) == 0)) {
+			entry->count++;
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+
+/* internal interface, documented in private.h */
+void nsurl__intern_forget(nsurl *url)
+{
+	if (url->intern_prevptr == NULL) {
+		return;
+	}
+
+	*url->intern_prevptr = url->intern_next;
+	if (url->intern_next != NULL) {
+		url->intern_next->intern_prevptr = url->intern_prevptr;
+	}
+	url->intern_prevptr = NULL;
+	url->intern_next = NULL;
+}
+
+
 /******************************************************************************
  * NetSurf URL Public API                                                     *
  ******************************************************************************/
@@ -89,6 +192,8 @@ void nsurl_unref(nsurl *url)
 	if (--url->count > 0)
 		return;
 
+	nsurl__intern_forget(url);
+
 	/* Release lwc strings */
 	nsurl__components_destroy(&url->components);
 
@@ -516,6 +621,9 @@ nserror nsurl_defragment(const nsurl *url, nsurl **no_frag)
 	/* Give the URL a reference */
 	(*no_frag)->count = 1;
 
+	/* Share any identical live URL object */
+	*no_frag = nsurl__intern(*no_frag);
+
 	return NSERROR_OK;
 }
 
@@ -584,6 +692,9 @@ nserror nsurl_refragment(const nsurl *url, lwc_string *frag, nsurl **new_url)
 	/* Give the URL a reference */
 	(*new_url)->count = 1;
 
+	/* Share any identical live URL object */
+	*new_url = nsurl__intern(*new_url);
+
 	return NSERROR_OK;
 }
 
@@ -681,6 +792,9 @@ nserror nsurl_replace_query(const nsurl *url, const char *query,
 	/* Give the URL a reference */
 	(*new_url)->count = 1;
 
+	/* Share any identical live URL object */
+	*new_url = nsurl__intern(*new_url);
+
 	return NSERROR_OK;
 }
 
@@ -768,6 +882,9 @@ nserror nsurl_replace_scheme(const nsurl *url, lwc_string *scheme,
 	/* Give the URL a reference */
 	(*new_url)->count = 1;
 
+	/* Share any identical live URL object */
+	*new_url = nsurl__intern(*new_url);
+
 	return NSERROR_OK;
 }
 
@@ -971,6 +1088,9 @@ nserror nsurl_parent(const nsurl *url, nsurl **new_url)
 	/* Give the URL a reference */
 	(*new_url)->count = 1;
 
+	/* Share any identical live URL object */
+	*new_url = nsurl__intern(*new_url);
+
 	return NSERROR_OK;
 }
 
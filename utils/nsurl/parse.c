@@ -1377,10 +1377,108 @@ nserror nsurl_create(const char * const url_s, nsurl **url)
 	/* Give the URL a reference */
 	(*url)->count = 1;
 
+	/* Share any identical live URL object */
+	*url = nsurl__intern(*url);
+
 	return NSERROR_OK;
 }
 
 
+/** Longest joined URL string the simple join fast path will compose */
+#define NSURL_JOIN_FAST_BUFSIZE 512
+
+/**
+ * Attempt to resolve a simple relative reference against a live URL
+ *
+ * Handles the common box construction case of plain path references
+ * like "foo.png" or "/css/base.css" joined to an unchanged base: no
+ * scheme, authority, query, fragment, escaping or dot segments.  For
+ * such references the joined URL's canonical string is just the base
+ * URL's string up to its path, followed by the merged path, so it can
+ * be composed in a stack buffer and looked up in the intern cache
+ * without running the full parser or allocating at all.
+ *
+ * \param base	Base URL to resolve the reference against
+ * \param rel	Relative URL text
+ * \return Referenced joined URL object, or NULL to use the full parser
+ */
+static nsurl *nsurl__join_fast(const nsurl *base, const char *rel)
+{
+	char buff[NSURL_JOIN_FAST_BUFSIZE];
+	const char *path;
+	const char *ch;
+	size_t prefix_len;
+	size_t dir_len = 0;
+	size_t rel_len;
+	size_t i;
+
+	if (base->components.scheme == NULL ||
+	    base->components.path == NULL) {
+		return NULL;
+	}
+
+	if (rel[0] == '\0' || rel[0] == '.') {
+		/* Empty, or possible leading dot segment */
+		return NULL;
+	}
+
+	for (ch = rel; *ch != '\0'; ch++) {
+		if (!ascii_is_alphanumerical(*ch) &&
+		    *ch != '-' && *ch != '_' &&
+		    *ch != '~' && *ch != '.' && *ch != '/') {
+			/* May need escaping, or start a scheme,
+			 * authority, query or fragment section */
+			return NULL;
+		}
+		if (ch != rel && ch[-1] == '/' &&
+		    (*ch == '.' || *ch == '/')) {
+			/* Possible dot segment or authority */
+			return NULL;
+		}
+	}
+	rel_len = ch - rel;
+
+	path = lwc_string_data(base->components.path);
+
+	if (rel[0] != '/') {
+		/* Merge with the base path's directory part */
+		dir_len = lwc_string_length(base->components.path);
+		while (dir_len > 0 && path[dir_len - 1] != '/') {
+			dir_len--;
+		}
+		if (dir_len == 0) {
+			return NULL;
+		}
+		for (i = 1; i < dir_len; i++) {
+			if (path[i] == '.' && path[i - 1] == '/') {
+				/* Unnormalised base path; the parser
+				 * would remove dot segments */
+				return NULL;
+			}
+		}
+	}
+
+	/* Length of base string up to the start of its path */
+	prefix_len = base->length - lwc_string_length(base->components.path);
+	if (base->components.query != NULL) {
+		prefix_len -= 1 + lwc_string_length(base->components.query);
+	}
+	if (base->components.fragment != NULL) {
+		prefix_len -= 1 + lwc_string_length(base->components.fragment);
+	}
+
+	if (prefix_len + dir_len + rel_len >= sizeof(buff)) {
+		return NULL;
+	}
+
+	memcpy(buff, base->string, prefix_len);
+	memcpy(buff + prefix_len, path, dir_len);
+	memcpy(buff + prefix_len + dir_len, rel, rel_len);
+
+	return nsurl__intern_lookup(buff, prefix_len + dir_len + rel_len);
+}
+
+
 /* exported interface, documented in nsurl.h */
 nserror nsurl_join(const nsurl *base, const char *rel, nsurl **joined)
 {
@@ -1406,6 +1504,12 @@ nserror nsurl_join(const nsurl *base, const char *rel, nsurl **joined)
 	NSLOG(netsurf, DEEPDEBUG, "base: \"%s\", rel: \"%s\"",
 			nsurl_access(base), rel);
 
+	/* Try to reuse a live URL object for simple relative paths */
+	*joined = nsurl__join_fast(base, rel);
+	if (*joined != NULL) {
+		return NSERROR_OK;
+	}
+
 	/* Peg out the URL sections */
 	nsurl__get_string_markers(rel, &m, true);
 
@@ -1615,5 +1719,8 @@ nserror nsurl_join(const nsurl *base, const char *rel, nsurl **joined)
 	/* Give the URL a reference */
 	(*joined)->count = 1;
 
+	/* Share any identical live URL object */
+	*joined = nsurl__intern(*joined);
+
 	return NSERROR_OK;
 }
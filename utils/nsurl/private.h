@@ -60,6 +60,10 @@ struct nsurl {
 	int count;	/* Number of references to NetSurf URL object */
 	uint32_t hash;	/* Hash value for nsurl identification */
 
+	struct nsurl *intern_next;	/* Next URL in intern cache chain */
+	struct nsurl **intern_prevptr;	/* Cache chain link pointing at this
+					 * URL, or NULL if not in the cache */
+
 	size_t length;	/* Length of string */
 	char string[FLEX_ARRAY_LEN_DECL];	/* Full URL as a string */
 };
@@ -127,6 +131,40 @@ nserror nsurl__components_to_string(
  */
 void nsurl__calc_hash(nsurl *url);
 
+/**
+ * Find the canonical object for a freshly created URL
+ *
+ * If an identical URL object is already live, it gains a reference and
+ * is returned, and \a url is destroyed.  Otherwise \a url is added to
+ * the intern cache and returned unchanged.  Either way the returned
+ * object carries the reference that \a url held.  Cache entries are
+ * weak: they are removed when the last reference is released.
+ *
+ * \param url	URL object with computed hash and a single reference
+ * \return The canonical URL object for url's string
+ */
+nsurl *nsurl__intern(nsurl *url);
+
+/**
+ * Look up a live URL object by its string form
+ *
+ * If an identical URL object is live it gains a reference and is
+ * returned, allowing callers which can predict a URL's canonical
+ * string to avoid building a new object at all.
+ *
+ * \param string	Canonical URL string to look up
+ * \param length	Byte length of \a string
+ * \return Referenced URL object, or NULL if no identical URL is live
+ */
+nsurl *nsurl__intern_lookup(const char *string, size_t length);
+
+/**
+ * Remove a URL object from the intern cache, if it is present
+ *
+ * \param url	URL object which is being destroyed
+ */
+void nsurl__intern_forget(nsurl *url);
+
 
 
 
@@ -73,6 +73,8 @@
 #define TALLOC_MAGIC 0xe814ec70
 #define TALLOC_FLAG_FREE 0x01
 #define TALLOC_FLAG_LOOP 0x02
+#define TALLOC_FLAG_POOL 0x04 /* chunk is a pool context */
+#define TALLOC_FLAG_POOLMEM 0x08 /* chunk was allocated from a pool slab */
 #define TALLOC_MAGIC_REFERENCE ((const char *)1)
 
 /* by default we abort when given a bad pointer (such as when talloc_free() is called 
@@ -122,12 +124,29 @@ struct talloc_chunk {
 	const char *name;
 	size_t size;
 	unsigned flags;
+	struct talloc_chunk *pool; /* pool this chunk was served from, if any */
 };
 
 /* 16 byte alignment seems to keep everyone happy */
 #define TC_HDR_SIZE ((sizeof(struct talloc_chunk)+15)&~15)
 #define TC_PTR_FROM_CHUNK(tc) ((void *)(TC_HDR_SIZE + (char*)tc))
 
+/* bookkeeping held at the start of a pool context's data area */
+struct talloc_pool_hdr {
+	size_t size;		/* bytes available for bump allocation */
+	size_t used;		/* bytes bump allocated so far */
+	size_t object_count;	/* live chunks in the slab, plus the pool */
+	size_t alloc_count;	/* chunks ever served from the slab */
+	size_t overflow_count;	/* allocations which fell back to malloc */
+};
+
+#define TP_HDR_SIZE ((sizeof(struct talloc_pool_hdr)+15)&~15)
+
+static inline struct talloc_pool_hdr *talloc_pool_header(struct talloc_chunk *tc)
+{
+	return (struct talloc_pool_hdr *)TC_PTR_FROM_CHUNK(tc);
+}
+
 /* panic if we get a bad magic value */
 static inline struct talloc_chunk *talloc_chunk_from_ptr(const void *ptr)
 {
@@ -208,7 +227,8 @@ const char *talloc_parent_name(const void *ptr)
 */
 static inline void *__talloc(const void *context, size_t size)
 {
-	struct talloc_chunk *tc;
+	struct talloc_chunk *tc = NULL;
+	struct talloc_chunk *pool_tc = NULL;
 
 	if (unlikely(context == NULL)) {
 		context = null_context;
@@ -218,11 +238,46 @@ static inline void *__talloc(const void *context, size_t size)
 		return NULL;
 	}
 
-	tc = (struct talloc_chunk *)malloc(TC_HDR_SIZE+size);
-	if (unlikely(tc == NULL)) return NULL;
+	/* allocations within a pool hierarchy are served from the
+	   pool's slab while there is room */
+	if (likely(context != NULL)) {
+		struct talloc_chunk *ptc = talloc_chunk_from_ptr(context);
+
+		if (unlikely(ptc->flags & TALLOC_FLAG_POOL)) {
+			pool_tc = ptc;
+		} else if (unlikely(ptc->flags & TALLOC_FLAG_POOLMEM)) {
+			pool_tc = ptc->pool;
+		}
+	}
+
+	if (unlikely(pool_tc != NULL)) {
+		struct talloc_pool_hdr *pool_hdr = talloc_pool_header(pool_tc);
+		size_t chunk_size = (TC_HDR_SIZE + size + 15) & ~15;
+
+		if (chunk_size <= pool_hdr->size - pool_hdr->used) {
+			tc = (struct talloc_chunk *)
+				((char *)TC_PTR_FROM_CHUNK(pool_tc) +
+				 TP_HDR_SIZE + pool_hdr->used);
+			pool_hdr->used += chunk_size;
+			pool_hdr->object_count++;
+			pool_hdr->alloc_count++;
+		} else {
+			pool_hdr->overflow_count++;
+			pool_tc = NULL;
+		}
+	}
+
+	if (likely(tc == NULL)) {
+		tc = (struct talloc_chunk *)malloc(TC_HDR_SIZE+size);
+		if (unlikely(tc == NULL)) return NULL;
+	}
 
 	tc->size = size;
 	tc->flags = TALLOC_MAGIC;
+	if (unlikely(pool_tc != NULL)) {
+		tc->flags |= TALLOC_FLAG_POOLMEM;
+	}
+	tc->pool = pool_tc;
 	tc->destructor = NULL;
 	tc->child = NULL;
 	tc->name = NULL;
@@ -341,7 +396,102 @@ void *_talloc_reference(const void *context, const void *ptr)
 }
 
 
-/* 
+/*
+  release the storage backing a chunk.  Chunks served from a pool
+  slab only hand their space back to the slab's accounting; the slab
+  itself goes when its last occupant does.
+*/
+static void talloc_chunk_release(struct talloc_chunk *tc)
+{
+	if (unlikely(tc->flags & TALLOC_FLAG_POOLMEM)) {
+		struct talloc_pool_hdr *pool_hdr =
+				talloc_pool_header(tc->pool);
+
+		if (--pool_hdr->object_count == 0) {
+			/* the pool context was already freed; the last
+			   chunk left in the slab releases it */
+			talloc_chunk_release(tc->pool);
+		}
+		return;
+	}
+
+	free(tc);
+}
+
+/*
+  free the memory for a chunk.  Pool contexts with chunks stolen out
+  of their hierarchy still live in the slab, so releasing the slab is
+  deferred until the last of them is freed.
+*/
+static void talloc_chunk_free(struct talloc_chunk *tc)
+{
+	if (unlikely(tc->flags & TALLOC_FLAG_POOL)) {
+		struct talloc_pool_hdr *pool_hdr = talloc_pool_header(tc);
+
+		if (--pool_hdr->object_count != 0) {
+			return;
+		}
+	}
+
+	talloc_chunk_release(tc);
+}
+
+/*
+  create a pool context.  Allocations made beneath it, directly or via
+  descendants, are bump allocated from a single slab of the given size
+  while it has room, falling back to the heap when it is exhausted, so
+  building and tearing down a large hierarchy becomes a handful of
+  large heap operations.  The pool pointer is only useful as a talloc
+  context; its own data area holds the slab.
+*/
+void *talloc_pool(const void *context, size_t size)
+{
+	void *ptr;
+	struct talloc_chunk *tc;
+	struct talloc_pool_hdr *pool_hdr;
+
+	ptr = talloc_named_const(context, TP_HDR_SIZE + size, "talloc_pool");
+	if (unlikely(ptr == NULL)) {
+		return NULL;
+	}
+
+	tc = talloc_chunk_from_ptr(ptr);
+	tc->flags |= TALLOC_FLAG_POOL;
+
+	pool_hdr = talloc_pool_header(tc);
+	pool_hdr->size = size;
+	pool_hdr->used = 0;
+	pool_hdr->object_count = 1; /* the pool's own count */
+	pool_hdr->alloc_count = 0;
+	pool_hdr->overflow_count = 0;
+
+	return ptr;
+}
+
+/*
+  retrieve usage statistics for a pool context.  Returns -1 if the
+  pointer is not a pool.
+*/
+int talloc_pool_usage(const void *ptr, struct talloc_pool_stats *stats)
+{
+	struct talloc_chunk *tc = talloc_chunk_from_ptr(ptr);
+	struct talloc_pool_hdr *pool_hdr;
+
+	if (!(tc->flags & TALLOC_FLAG_POOL)) {
+		return -1;
+	}
+
+	pool_hdr = talloc_pool_header(tc);
+	stats->size = pool_hdr->size;
+	stats->used = pool_hdr->used;
+	stats->object_count = pool_hdr->object_count - 1;
+	stats->alloc_count = pool_hdr->alloc_count;
+	stats->overflow_count = pool_hdr->overflow_count;
+
+	return 0;
+}
+
+/*
    internal talloc_free call
 */
 static inline int _talloc_free(void *ptr)
@@ -423,7 +573,7 @@ static inline int _talloc_free(void *ptr)
 	}
 
 	tc->flags |= TALLOC_FLAG_FREE;
-	free(tc);
+	talloc_chunk_free(tc);
 	return 0;
 }
 
@@ -795,6 +945,12 @@ void *_talloc_realloc(const void *context, void *ptr, size_t size, const char *n
 		return NULL;
 	}
 
+	/* don't allow realloc on pool contexts; live chunks occupy
+	   their data area */
+	if (unlikely(tc->flags & TALLOC_FLAG_POOL)) {
+		return NULL;
+	}
+
 	/* by resetting magic we catch users of the old memory */
 	tc->flags |= TALLOC_FLAG_FREE;
 
@@ -805,15 +961,30 @@ void *_talloc_realloc(const void *context, void *ptr, size_t size, const char *n
 		free(tc);
 	}
 #else
-	new_ptr = realloc(tc, size + TC_HDR_SIZE);
+	if (unlikely(tc->flags & TALLOC_FLAG_POOLMEM)) {
+		/* chunks in a pool slab cannot be resized in place;
+		   move the allocation out to the heap */
+		new_ptr = malloc(size + TC_HDR_SIZE);
+		if (new_ptr) {
+			size_t copy_size = tc->size < size ? tc->size : size;
+
+			memcpy(new_ptr, tc, copy_size + TC_HDR_SIZE);
+			((struct talloc_chunk *)new_ptr)->flags &=
+					~(unsigned)TALLOC_FLAG_POOLMEM;
+			((struct talloc_chunk *)new_ptr)->pool = NULL;
+			talloc_chunk_release(tc);
+		}
+	} else {
+		new_ptr = realloc(tc, size + TC_HDR_SIZE);
+	}
 #endif
-	if (unlikely(!new_ptr)) {	
-		tc->flags &= ~TALLOC_FLAG_FREE; 
-		return NULL; 
+	if (unlikely(!new_ptr)) {
+		tc->flags &= ~TALLOC_FLAG_FREE;
+		return NULL;
 	}
 
 	tc = (struct talloc_chunk *)new_ptr;
-	tc->flags &= ~TALLOC_FLAG_FREE; 
+	tc->flags &= ~TALLOC_FLAG_FREE;
 	if (tc->parent) {
 		tc->parent->child = tc;
 	}
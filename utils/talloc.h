@@ -114,8 +114,19 @@ typedef void TALLOC_CTX;
 #define talloc_destroy(ctx) talloc_free(ctx)
 #endif
 
+/** Usage statistics for a pool context */
+struct talloc_pool_stats {
+	size_t size;		/**< Slab size in bytes */
+	size_t used;		/**< Bytes bump allocated from the slab */
+	size_t object_count;	/**< Live chunks served from the slab */
+	size_t alloc_count;	/**< Chunks ever served from the slab */
+	size_t overflow_count;	/**< Allocations which fell back to the heap */
+};
+
 /* The following definitions come from talloc.c  */
 void *_talloc(const void *context, size_t size);
+void *talloc_pool(const void *context, size_t size);
+int talloc_pool_usage(const void *ptr, struct talloc_pool_stats *stats);
 void _talloc_set_destructor(const void *ptr, int (*destructor)(void *));
 int talloc_increase_ref_count(const void *ptr);
 size_t talloc_reference_count(const void *ptr);
@@ -28,6 +28,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
 #ifdef WITH_CURL
 #include <curl/curl.h>
@@ -106,6 +107,111 @@ static const char * const months[NSC_TIME_MONTH__COUNT] = {
 };
 
 
+/**
+ * Attempt to parse a date in the fixed-width RFC 1123 layout.
+ *
+ * Virtually every Date, Expires and Last-Modified header is in the
+ * preferred "Sun, 06 Nov 1994 08:49:37 GMT" form, so that layout is
+ * decoded with direct field extraction before any of the general
+ * multi-format parsing is attempted.  Anything that does not match
+ * exactly (including trailing non-whitespace) is left to the general
+ * parser.
+ *
+ * \param[in]  str   String to parse.
+ * \param[in]  size  Length of `str`, in bytes.
+ * \param[out] time  Returns the number of seconds since 1 Jan 1970 00:00 UTC.
+ * \return NSERROR_OK on success, else NSERROR_NOT_FOUND if `str` is not
+ *         in RFC 1123 layout.
+ */
+static nserror time__parse_rfc1123(const char *str, size_t size, time_t *time)
+{
+	/* "Sun, 06 Nov 1994 08:49:37 GMT" */
+	static const size_t rfc1123_len = 29;
+	static const uint8_t digits[] = {
+		5, 6, 12, 13, 14, 15, 17, 18, 20, 21, 23, 24
+	};
+	static const uint16_t month_offsets[NSC_TIME_MONTH__COUNT] = {
+		0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
+	};
+	int day, month, year, hours, mins, secs;
+	int leap_years, total_days;
+	uint32_t i;
+
+	if (str == NULL || time == NULL || size < rfc1123_len) {
+		return NSERROR_NOT_FOUND;
+	}
+
+	if (str[3] != ',' || str[4] != ' ' || str[7] != ' ' ||
+			str[11] != ' ' || str[16] != ' ' ||
+			str[19] != ':' || str[22] != ':' ||
+			str[25] != ' ' || str[26] != 'G' ||
+			str[27] != 'M' || str[28] != 'T') {
+		return NSERROR_NOT_FOUND;
+	}
+
+	for (i = 0; i < sizeof(digits); i++) {
+		if (!ascii_is_digit(str[digits[i]])) {
+			return NSERROR_NOT_FOUND;
+		}
+	}
+
+	/* only whitespace may follow the layout */
+	for (i = rfc1123_len; i < size; i++) {
+		if (str[i] != ' ' && str[i] != '\t' &&
+				str[i] != '\r' && str[i] != '\n' &&
+				str[i] != '\0') {
+			return NSERROR_NOT_FOUND;
+		}
+	}
+
+	for (i = 0; i < NSC_TIME_WEEKDAY__COUNT; i++) {
+		if (memcmp(str, weekdays_short[i], 3) == 0) {
+			break;
+		}
+	}
+	if (i == NSC_TIME_WEEKDAY__COUNT) {
+		return NSERROR_NOT_FOUND;
+	}
+
+	for (month = 0; month < NSC_TIME_MONTH__COUNT; month++) {
+		if (memcmp(str + 8, months[month], 3) == 0) {
+			break;
+		}
+	}
+	if (month == NSC_TIME_MONTH__COUNT) {
+		return NSERROR_NOT_FOUND;
+	}
+
+	day   = (str[5]  - '0') * 10 + str[6]  - '0';
+	year  = (str[12] - '0') * 1000 + (str[13] - '0') * 100 +
+		(str[14] - '0') * 10 + str[15] - '0';
+	hours = (str[17] - '0') * 10 + str[18] - '0';
+	mins  = (str[20] - '0') * 10 + str[21] - '0';
+	secs  = (str[23] - '0') * 10 + str[24] - '0';
+
+	if (day < 1 || day > 31 || hours > 23 || mins > 59 || secs > 60) {
+		return NSERROR_NOT_FOUND;
+	}
+
+	/* leap years between the epoch and the date; the current
+	 * year's leap day only counts from March onwards */
+	leap_years = year;
+	if (month <= NSC_TIME_MONTH_FEB) {
+		leap_years--;
+	}
+	leap_years = (leap_years / 4) - (leap_years / 100) +
+			(leap_years / 400) -
+			((1969 / 4) - (1969 / 100) + (1969 / 400));
+
+	total_days = (year - 1970) * 365 + month_offsets[month] +
+			day - 1 + leap_years;
+
+	*time = ((((time_t) total_days * 24) + hours) * 60 + mins) * 60 + secs;
+
+	return NSERROR_OK;
+}
+
+
 /* exported interface documented in utils/time.h */
 const char *rfc1123_date(time_t t)
 {
@@ -890,7 +996,7 @@ static nserror time__ctx_to_time_t(
 	};
 	int year_days = (ctx->years - 1970) * 365;
 	int month_days = month_offsets[ctx->month];
-	int year = (ctx->month < NSC_TIME_MONTH_FEB) ?
+	int year = (ctx->month <= NSC_TIME_MONTH_FEB) ?
 			ctx->years - 1 : ctx->years;
 	int leap_days = time__get_leap_days(year) - time__get_leap_days(1969);
 	int total_days = year_days + month_days + ctx->day + leap_days;
@@ -979,6 +1085,10 @@ static nserror time__get_date(const char *str, time_t *time)
 /* exported function documented in utils/time.h */
 nserror nsc_strntimet(const char *str, size_t size, time_t *timep)
 {
+	if (time__parse_rfc1123(str, size, timep) == NSERROR_OK) {
+		return NSERROR_OK;
+	}
+
 	return time__get_date(str, timep);
 }
 
@@ -993,6 +1103,10 @@ nserror nsc_strntimet(const char *str, size_t size, time_t *timep)
 		return NSERROR_BAD_PARAMETER;
 	}
 
+	if (time__parse_rfc1123(str, size, timep) == NSERROR_OK) {
+		return NSERROR_OK;
+	}
+
 	result = curl_getdate(str, NULL);
 
 	if (result == -1) {
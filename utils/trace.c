@@ -0,0 +1,178 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Lightweight hot-path tracepoint implementation.
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "utils/log.h"
+#include "utils/trace.h"
+
+/** Number of ring buffer entries; must be a power of two */
+#define NSTRACE_RING_SIZE 16384
+
+/**
+ * One recorded tracepoint
+ */
+struct nstrace_entry {
+	uint64_t timestamp; /**< time the entry was recorded */
+	uintptr_t value; /**< event specific value */
+	const char *event; /**< static event name */
+	uint32_t category; /**< category the event belongs to */
+};
+
+/* exported interface documented in utils/trace.h */
+uint32_t nstrace_mask = 0;
+
+/** The ring buffer of recorded entries */
+static struct nstrace_entry *nstrace_ring = NULL;
+
+/** Total entries recorded; the next slot is this modulo the ring size */
+static uint64_t nstrace_count = 0;
+
+/**
+ * Obtain a timestamp as cheaply as possible.
+ *
+ * The processor cycle counter is used where one is directly
+ * accessible, otherwise the monotonic clock in nanoseconds.
+ */
+static inline uint64_t nstrace__now(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+	return __builtin_ia32_rdtsc();
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000) + ts.tv_nsec;
+#endif
+}
+
+
+/* exported interface documented in utils/trace.h */
+void nstrace_record(uint32_t category, const char *event, uintptr_t value)
+{
+	struct nstrace_entry *entry;
+
+	if (nstrace_ring == NULL) {
+		return;
+	}
+
+	entry = &nstrace_ring[nstrace_count & (NSTRACE_RING_SIZE - 1)];
+	entry->timestamp = nstrace__now();
+	entry->category = category;
+	entry->event = event;
+	entry->value = value;
+
+	nstrace_count++;
+}
+
+
+/* exported interface documented in utils/trace.h */
+void nstrace_set_mask(uint32_t mask)
+{
+	nstrace_mask = mask;
+}
+
+
+/* exported interface documented in utils/trace.h */
+nserror nstrace_init(void)
+{
+	const char *env;
+
+	nstrace_ring = calloc(NSTRACE_RING_SIZE, sizeof(*nstrace_ring));
+	if (nstrace_ring == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	env = getenv("NETSURF_TRACE");
+	if (env != NULL) {
+		nstrace_set_mask(strtoul(env, NULL, 0));
+	}
+
+	NSLOG(netsurf, INFO, "Tracepoints available, mask %"PRIx32,
+	      nstrace_mask);
+
+	return NSERROR_OK;
+}
+
+
+/* exported interface documented in utils/trace.h */
+void nstrace_fini(void)
+{
+	const char *env;
+	FILE *stream;
+
+	env = getenv("NETSURF_TRACE_DUMP");
+	if ((env != NULL) && (nstrace_count != 0)) {
+		stream = fopen(env, "w");
+		if (stream != NULL) {
+			nstrace_dump(stream);
+			fclose(stream);
+		} else {
+			NSLOG(netsurf, WARNING,
+			      "Unable to open trace dump file %s", env);
+		}
+	}
+
+	nstrace_mask = 0;
+	free(nstrace_ring);
+	nstrace_ring = NULL;
+	nstrace_count = 0;
+}
+
+
+/* exported interface documented in utils/trace.h */
+nserror nstrace_dump(FILE *stream)
+{
+	uint64_t idx;
+	uint64_t first;
+	struct nstrace_entry *entry;
+
+	if ((nstrace_ring == NULL) || (stream == NULL)) {
+		return NSERROR_BAD_PARAMETER;
+	}
+
+	/* oldest retained entry */
+	if (nstrace_count > NSTRACE_RING_SIZE) {
+		first = nstrace_count - NSTRACE_RING_SIZE;
+	} else {
+		first = 0;
+	}
+
+	fprintf(stream,
+		"# %"PRIu64" entries recorded, %"PRIu64" retained\n",
+		nstrace_count, nstrace_count - first);
+
+	for (idx = first; idx < nstrace_count; idx++) {
+		entry = &nstrace_ring[idx & (NSTRACE_RING_SIZE - 1)];
+		fprintf(stream,
+			"%"PRIu64" %"PRIx32" %s %"PRIuPTR"\n",
+			entry->timestamp,
+			entry->category,
+			entry->event,
+			(uintptr_t)entry->value);
+	}
+
+	return NSERROR_OK;
+}
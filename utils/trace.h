@@ -0,0 +1,136 @@
+/*
+ * Copyright 2026 NetSurf Developers
+ *
+ * This file is part of NetSurf, http://www.netsurf-browser.org/
+ *
+ * NetSurf is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * NetSurf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file
+ * Lightweight hot-path tracepoints.
+ *
+ * Tracepoints are compiled out entirely unless the build enables
+ * NETSURF_TRACE. When built in, each probe costs a single bitmask
+ * test while its category is disabled; enabled probes append a
+ * timestamped entry to a fixed ring buffer which can be dumped on
+ * demand, giving flight-recorder style diagnostics without the
+ * formatting cost of NSLOG.
+ *
+ * The categories to record are taken from the NETSURF_TRACE
+ * environment variable (a numeric bitmask) and the recorded buffer
+ * is written to the file named by NETSURF_TRACE_DUMP at exit.
+ */
+
+#ifndef NETSURF_UTILS_TRACE_H_
+#define NETSURF_UTILS_TRACE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "utils/errors.h"
+
+/**
+ * Tracepoint categories; each occupies one bit of the runtime mask.
+ */
+enum nstrace_category {
+	NSTRACE_LAYOUT = (1 << 0), /**< box tree layout */
+	NSTRACE_STYLE = (1 << 1), /**< css style selection */
+	NSTRACE_FETCH = (1 << 2), /**< fetcher data delivery */
+	NSTRACE_IMAGE = (1 << 3), /**< image cache */
+	NSTRACE_PLOT = (1 << 4), /**< plotting */
+};
+
+#ifdef WITH_NSTRACE
+
+/** Currently enabled tracepoint categories */
+extern uint32_t nstrace_mask;
+
+/**
+ * Append an entry to the trace ring buffer.
+ *
+ * Use the NSTRACE() macro rather than calling this directly so the
+ * mask test stays on the fast path.
+ *
+ * \param category The category of the tracepoint.
+ * \param event Static string naming the event; the pointer is stored,
+ *                not the contents, so it must remain valid.
+ * \param value Event specific value.
+ */
+void nstrace_record(uint32_t category, const char *event, uintptr_t value);
+
+/**
+ * Set the enabled category mask.
+ *
+ * \param mask Bitwise or of the categories to record.
+ */
+void nstrace_set_mask(uint32_t mask);
+
+/**
+ * Initialise tracing, taking the initial mask from the environment.
+ *
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+nserror nstrace_init(void);
+
+/**
+ * Finalise tracing, dumping to the environment-named file if set.
+ */
+void nstrace_fini(void);
+
+/**
+ * Write the recorded entries, oldest first, to a stream.
+ *
+ * \param stream The stream to write to.
+ * \return NSERROR_OK on success, appropriate error otherwise.
+ */
+nserror nstrace_dump(FILE *stream);
+
+/**
+ * Emit a tracepoint.
+ */
+#define NSTRACE(category, event, value)					\
+	do {								\
+		if (nstrace_mask & (category)) {			\
+			nstrace_record((category), (event),		\
+				       (uintptr_t)(value));		\
+		}							\
+	} while (0)
+
+#else
+
+#define NSTRACE(category, event, value) ((void)0)
+
+static inline void nstrace_set_mask(uint32_t mask)
+{
+	(void)mask;
+}
+
+static inline nserror nstrace_init(void)
+{
+	return NSERROR_OK;
+}
+
+static inline void nstrace_fini(void)
+{
+}
+
+static inline nserror nstrace_dump(FILE *stream)
+{
+	(void)stream;
+	return NSERROR_OK;
+}
+
+#endif
+
+#endif
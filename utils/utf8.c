@@ -44,6 +44,11 @@ uint32_t utf8_to_ucs4(const char *s_in, size_t l)
 	size_t len;
 	parserutils_error perror;
 
+	/* ASCII characters convert to their own codepoint */
+	if (l > 0 && (uint8_t) s_in[0] < 0x80) {
+		return (uint8_t) s_in[0];
+	}
+
 	perror = parserutils_charset_utf8_to_ucs4((const uint8_t *) s_in, l,
 						  &ucs4, &len);
 	if (perror != PARSERUTILS_OK)
@@ -79,14 +84,40 @@ size_t utf8_length(const char *s)
 /* exported interface documented in utils/utf8.h */
 size_t utf8_bounded_length(const char *s, size_t l)
 {
-	size_t len;
+	size_t len = 0;
+	size_t count;
 	parserutils_error perror;
 
-	perror = parserutils_charset_utf8_length((const uint8_t *) s, l, &len);
+	/* Each byte of a leading ASCII run is one character, so it can
+	 * be counted a word at a time.  Most strings this sees are pure
+	 * ASCII, and layout measures them repeatedly.
+	 */
+	while (l >= sizeof(uint32_t)) {
+		uint32_t w;
+		memcpy(&w, s, sizeof(w));
+		if (w & 0x80808080u) {
+			break;
+		}
+		s += sizeof(uint32_t);
+		l -= sizeof(uint32_t);
+		len += sizeof(uint32_t);
+	}
+	while (l > 0 && (uint8_t) *s < 0x80) {
+		s++;
+		l--;
+		len++;
+	}
+
+	if (l == 0) {
+		return len;
+	}
+
+	perror = parserutils_charset_utf8_length((const uint8_t *) s, l,
+			&count);
 	if (perror != PARSERUTILS_OK)
 		return 0;
 
-	return len;
+	return len + count;
 }
 
 /* exported interface documented in utils/utf8.h */
@@ -106,6 +137,10 @@ size_t utf8_char_byte_length(const char *s)
 	size_t len;
 	parserutils_error perror;
 
+	if ((uint8_t) s[0] < 0x80) {
+		return 1;
+	}
+
 	perror = parserutils_charset_utf8_char_byte_length((const uint8_t *) s,
 							   &len);
 	assert(perror == PARSERUTILS_OK);
@@ -119,6 +154,12 @@ size_t utf8_prev(const char *s, size_t o)
 	uint32_t prev;
 	parserutils_error perror;
 
+	/* Previous byte starting a character means it is the previous
+	 * character; selection and caret movement walk text with this. */
+	if (o > 0 && ((uint8_t) s[o - 1] & 0xc0) != 0x80) {
+		return o - 1;
+	}
+
 	perror = parserutils_charset_utf8_prev((const uint8_t *) s, o, &prev);
 	assert(perror == PARSERUTILS_OK);
 
@@ -131,6 +172,13 @@ size_t utf8_next(const char *s, size_t l, size_t o)
 	uint32_t next;
 	parserutils_error perror;
 
+	/* An ASCII character followed by a character start (or the end
+	 * of the string) advances by one byte */
+	if ((uint8_t) s[o] < 0x80 &&
+	    (o + 1 == l || ((uint8_t) s[o + 1] & 0xc0) != 0x80)) {
+		return o + 1;
+	}
+
 	perror = parserutils_charset_utf8_next((const uint8_t *) s, l, o,
 					       &next);
 	assert(perror == PARSERUTILS_OK);
@@ -206,6 +254,68 @@ nserror utf8_finalise(void)
 }
 
 
+/**
+ * Convert a Latin-1 or ASCII string directly to UTF-8
+ *
+ * Every ISO-8859-1 byte maps to the Unicode codepoint of the same
+ * value, so the conversion is a table-free expansion with no need to
+ * round-trip through iconv.  For ASCII sources bytes with the top bit
+ * set are invalid, and conversion is declined so iconv can apply its
+ * own error handling.
+ *
+ * \param string  The string to convert
+ * \param slen    Length of input string (in bytes)
+ * \param ascii_only  Decline strings containing bytes above 0x7f
+ * \param result_out  Pointer to location in which to store result.
+ * \param result_len_out Pointer to location in which to store result length.
+ * \return NSERROR_OK for no error, NSERROR_NOMEM on allocation error,
+ *         NSERROR_BAD_ENCODING if the conversion was declined
+ */
+static nserror
+utf8__from_latin1(const char *string,
+		  size_t slen,
+		  bool ascii_only,
+		  char **result_out,
+		  size_t *result_len_out)
+{
+	const uint8_t *in = (const uint8_t *) string;
+	char *result, *out;
+	size_t i;
+
+	if (ascii_only) {
+		for (i = 0; i < slen; i++) {
+			if (in[i] >= 0x80) {
+				return NSERROR_BAD_ENCODING;
+			}
+		}
+	}
+
+	/* Worst case: every byte expands to a two byte sequence */
+	result = malloc(slen * 2 + 1);
+	if (result == NULL) {
+		return NSERROR_NOMEM;
+	}
+
+	out = result;
+	for (i = 0; i < slen; i++) {
+		if (in[i] < 0x80) {
+			*out++ = in[i];
+		} else {
+			*out++ = 0xc0 | (in[i] >> 6);
+			*out++ = 0x80 | (in[i] & 0x3f);
+		}
+	}
+	*out = '\0';
+
+	*result_out = result;
+	if (result_len_out != NULL) {
+		*result_len_out = out - result;
+	}
+
+	return NSERROR_OK;
+}
+
+
 /**
  * Convert a string from one encoding to another
  *
@@ -256,6 +366,23 @@ utf8_convert(const char *string,
 		return NSERROR_OK;
 	}
 
+	/* Trivial single byte source encodings convert directly */
+	if (strcasecmp(to, "UTF-8") == 0) {
+		bool ascii_only = (strcasecmp(from, "US-ASCII") == 0) ||
+				(strcasecmp(from, "ASCII") == 0);
+
+		if (ascii_only ||
+		    strcasecmp(from, "ISO-8859-1") == 0 ||
+		    strcasecmp(from, "latin1") == 0) {
+			res = utf8__from_latin1(string, slen, ascii_only,
+					result_out, result_len_out);
+			if (res != NSERROR_BAD_ENCODING) {
+				return res;
+			}
+			/* ASCII input with high bytes; let iconv decide */
+		}
+	}
+
 	in = (char *)string;
 
 	res = get_cached_cd(from, to, &cd);